@@ -5,6 +5,8 @@ layout(location = 1) in vec3 in_normal;
 layout(location = 2) in vec2 in_texcoord;
 layout(location = 3) in vec4 in_colour;
 layout(location = 4) in vec3 in_tangent;
+// Per instance. Takes up locations 5 through 8.
+layout(location = 5) in mat4 in_model;
 
 layout(set = 0, binding = 0) uniform global_uniform_object{
     mat4 projection;
@@ -14,12 +16,6 @@ layout(set = 0, binding = 0) uniform global_uniform_object{
     int mode;
 } global_ubo;
 
-layout(push_constant) uniform push_constants{
-
-    // Only guaranteed a total size of 128 bytes.
-    mat4 model; // 64 bytes
-} u_push_constants;
-
 layout(location = 0) out int out_mode;
 
 // Data transfer object
@@ -37,15 +33,15 @@ void main(){
     out_dto.text_coord = in_texcoord;
     out_dto.colour = in_colour;
 
-    out_dto.frag_position = vec3(u_push_constants.model * vec4(in_position, 1.0));
+    out_dto.frag_position = vec3(in_model * vec4(in_position, 1.0));
     
-    mat3 m3_model = mat3(u_push_constants.model);
+    mat3 m3_model = mat3(in_model);
     out_dto.normal = normalize(m3_model * in_normal);
     out_dto.tangent = normalize(m3_model * in_tangent);
 
     out_dto.ambient = global_ubo.ambient_colour;
     out_dto.view_position = global_ubo.view_position;
-    gl_Position = global_ubo.projection * global_ubo.view * u_push_constants.model * vec4(in_position, 1.0);
+    gl_Position = global_ubo.projection * global_ubo.view * in_model * vec4(in_position, 1.0);
 
     out_mode = global_ubo.mode;
 }
\ No newline at end of file
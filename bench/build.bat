@@ -0,0 +1,19 @@
+REM Build script for benchmarks
+@ECHO OFF
+SetLocal EnableDelayedExpansion
+
+REM Get a list of all the .c files.
+SET cFilenames=
+FOR /R %%f in (*.c) do (SET cFilenames=!cFilenames! %%f)
+
+REM echo "Files: %cFilenames%"
+
+SET assembly = bench
+SET compilerFlags=-g -Wno-missing-braces
+REM -Wall -Werror -save-temps=obj -O0
+SET includeFlags=-Isrc -I../engine/src/
+SET linkerFlags=-L../bin/ -lengine.lib
+SET defines=-D_DEBUG -DTIMPORT
+
+ECHO "Building %assembly%%..."
+clang %cFilenames% %compilerFlags% -o ../bin/%assembly%.exe %defines% %includeFlags% %linkerFlags% 
\ No newline at end of file
@@ -0,0 +1,304 @@
+#include "bench_manager.h"
+
+#include <containers/darray.h>
+#include <core/logger.h>
+#include <core/clock.h>
+#include <core/tmemory.h>
+#include <core/tstring.h>
+#include <platform/filesystem.h>
+
+#define BENCH_DEFAULT_WARMUP_RUNS 1
+#define BENCH_DEFAULT_RUNS 5
+#define BENCH_DEFAULT_REGRESSION_PERCENT 10.0
+
+typedef struct bench_entry{
+    PFN_bench func;
+    char* desc;
+    u64 bytes_per_op;
+} bench_entry;
+
+/** The timings of one benchmark across its runs, all in nanoseconds per operation. */
+typedef struct bench_result{
+    const char* desc;
+    u64 operations;
+    u32 runs;
+    f64 min_ns;
+    f64 median_ns;
+    f64 p99_ns;
+    f64 mean_ns;
+    u64 bytes_per_op;
+} bench_result;
+
+typedef struct baseline_entry{
+    char* desc;
+    f64 median_ns;
+} baseline_entry;
+
+static bench_entry* benches;
+
+void bench_manager_init() {
+    benches = darray_create(bench_entry);
+}
+
+static void print_usage(){
+    TINFO("Usage: bench [--runs N] [--warmup N] [--filter TEXT] [--out FILE] [--baseline FILE] [--threshold PERCENT]");
+    TINFO("  --runs       Timed runs per benchmark (default %u).", BENCH_DEFAULT_RUNS);
+    TINFO("  --warmup     Untimed runs per benchmark before timing (default %u).", BENCH_DEFAULT_WARMUP_RUNS);
+    TINFO("  --filter     Only run benchmarks whose description contains TEXT.");
+    TINFO("  --out        Write results to FILE as tab-separated values.");
+    TINFO("  --baseline   Compare against results previously written with --out.");
+    TINFO("  --threshold  Percent slower than the baseline median that counts as a regression (default %.0f).", BENCH_DEFAULT_REGRESSION_PERCENT);
+}
+
+b8 bench_manager_parse_args(i32 argc, char** argv, bench_settings* out_settings){
+    out_settings->warmup_runs = BENCH_DEFAULT_WARMUP_RUNS;
+    out_settings->runs = BENCH_DEFAULT_RUNS;
+    out_settings->filter = 0;
+    out_settings->output_path = 0;
+    out_settings->baseline_path = 0;
+    out_settings->regression_percent = BENCH_DEFAULT_REGRESSION_PERCENT;
+
+    for(i32 i = 1; i < argc; ++i){
+        const char* value = i + 1 < argc ? argv[i + 1] : 0;
+        b8 parsed = value != 0;
+        if(strings_equal(argv[i], "--runs") && value){
+            parsed = string_to_u32((char*)value, &out_settings->runs) && out_settings->runs > 0;
+        }else if(strings_equal(argv[i], "--warmup") && value){
+            parsed = string_to_u32((char*)value, &out_settings->warmup_runs);
+        }else if(strings_equal(argv[i], "--filter") && value){
+            out_settings->filter = value;
+        }else if(strings_equal(argv[i], "--out") && value){
+            out_settings->output_path = value;
+        }else if(strings_equal(argv[i], "--baseline") && value){
+            out_settings->baseline_path = value;
+        }else if(strings_equal(argv[i], "--threshold") && value){
+            parsed = string_to_f64((char*)value, &out_settings->regression_percent);
+        }else{
+            parsed = FALSE;
+        }
+
+        if(!parsed){
+            TERROR("Unrecognized or invalid argument '%s'.", argv[i]);
+            print_usage();
+            return FALSE;
+        }
+        // Skip the value.
+        ++i;
+    }
+    return TRUE;
+}
+
+void bench_manager_register_bench(u64 (*PFN_bench)(), char* desc){
+    bench_manager_register_throughput_bench(PFN_bench, desc, 0);
+}
+
+void bench_manager_register_throughput_bench(u64 (*PFN_bench)(), char* desc, u64 bytes_per_op){
+    bench_entry e;
+    e.func = PFN_bench;
+    e.desc = desc;
+    e.bytes_per_op = bytes_per_op;
+    darray_push(benches, e);
+}
+
+static b8 contains(const char* text, const char* needle){
+    u64 needle_length = string_length(needle);
+    for(const char* c = text; *c; ++c){
+        if(strings_nequal(c, needle, needle_length)){
+            return TRUE;
+        }
+    }
+    return needle_length == 0;
+}
+
+static void sort_samples(f64* samples, u32 count){
+    // Run counts are small, so insertion sort is plenty.
+    for(u32 i = 1; i < count; ++i){
+        f64 value = samples[i];
+        u32 j = i;
+        while(j > 0 && samples[j - 1] > value){
+            samples[j] = samples[j - 1];
+            --j;
+        }
+        samples[j] = value;
+    }
+}
+
+static void run_bench(const bench_entry* entry, const bench_settings* settings, f64* samples, bench_result* out_result){
+    for(u32 i = 0; i < settings->warmup_runs; ++i){
+        entry->func();
+    }
+
+    u64 operations = 0;
+    f64 total = 0;
+    for(u32 i = 0; i < settings->runs; ++i){
+        clock bench_time;
+        clock_start(&bench_time);
+        operations = entry->func();
+        clock_update(&bench_time);
+
+        samples[i] = operations ? (bench_time.elapsed * 1000000000.0) / operations : 0;
+        total += samples[i];
+    }
+    sort_samples(samples, settings->runs);
+
+    // Nearest-rank percentiles. With only a few runs, p99 is simply the slowest.
+    u32 p99_rank = (u32)((settings->runs * 99 + 99) / 100);
+    out_result->desc = entry->desc;
+    out_result->operations = operations;
+    out_result->runs = settings->runs;
+    out_result->min_ns = samples[0];
+    out_result->median_ns = samples[settings->runs / 2];
+    out_result->p99_ns = samples[p99_rank - 1];
+    out_result->mean_ns = total / settings->runs;
+    out_result->bytes_per_op = entry->bytes_per_op;
+}
+
+static void report_result(const bench_result* result){
+    f64 mops = result->median_ns > 0 ? 1000.0 / result->median_ns : 0;
+    if(result->bytes_per_op){
+        f64 mib_per_sec = result->median_ns > 0 ? (result->bytes_per_op / (1024.0 * 1024.0)) / (result->median_ns / 1000000000.0) : 0;
+        TINFO("[BENCH] %s: %.2f ns/op median (min %.2f, p99 %.2f), %llu ops, %.3f Mops/s, %.1f MiB/s",
+              result->desc, result->median_ns, result->min_ns, result->p99_ns, result->operations, mops, mib_per_sec);
+    }else{
+        TINFO("[BENCH] %s: %.2f ns/op median (min %.2f, p99 %.2f), %llu ops, %.3f Mops/s",
+              result->desc, result->median_ns, result->min_ns, result->p99_ns, result->operations, mops);
+    }
+}
+
+static b8 write_results(const char* path, bench_result* results){
+    file_handle handle;
+    if(!filesystem_open(path, FILE_MODE_WRITE, FALSE, &handle)){
+        TERROR("Unable to open '%s' for writing benchmark results.", path);
+        return FALSE;
+    }
+
+    char line[1024];
+    b8 ok = filesystem_write_line(&handle, "name\toperations\truns\tmin_ns_per_op\tmedian_ns_per_op\tp99_ns_per_op\tmean_ns_per_op\tbytes_per_op");
+    u32 count = darray_length(results);
+    for(u32 i = 0; i < count && ok; ++i){
+        bench_result* r = &results[i];
+        string_format(line, "%s\t%llu\t%u\t%.3f\t%.3f\t%.3f\t%.3f\t%llu",
+                      r->desc, r->operations, r->runs, r->min_ns, r->median_ns, r->p99_ns, r->mean_ns, r->bytes_per_op);
+        ok = filesystem_write_line(&handle, line);
+    }
+    filesystem_close(&handle);
+
+    if(!ok){
+        TERROR("Failed to write benchmark results to '%s'.", path);
+        return FALSE;
+    }
+    TINFO("Wrote %u benchmark results to '%s'.", count, path);
+    return TRUE;
+}
+
+/** Reads a results file back. Returns a darray of entries, or 0 if the file cannot be read. */
+static baseline_entry* read_baseline(const char* path){
+    file_handle handle;
+    if(!filesystem_open(path, FILE_MODE_READ, FALSE, &handle)){
+        TERROR("Unable to open baseline '%s'.", path);
+        return 0;
+    }
+    u64 size = 0;
+    filesystem_size(&handle, &size);
+    char* text = tallocate(size + 1, MEMORY_TAG_STRING);
+    u64 read = 0;
+    filesystem_read_all_text(&handle, text, &read);
+    filesystem_close(&handle);
+
+    baseline_entry* entries = darray_create(baseline_entry);
+    char** lines = darray_create(char*);
+    u32 line_count = string_split(text, '\n', &lines, FALSE, FALSE);
+    // The first line is the header.
+    for(u32 i = 1; i < line_count; ++i){
+        char** fields = darray_create(char*);
+        u32 field_count = string_split(lines[i], '\t', &fields, FALSE, TRUE);
+        baseline_entry entry;
+        if(field_count >= 5 && string_to_f64(fields[4], &entry.median_ns)){
+            entry.desc = string_duplicate(fields[0]);
+            darray_push(entries, entry);
+        }
+        string_cleanup_split_array(fields);
+        darray_destroy(fields);
+    }
+    string_cleanup_split_array(lines);
+    darray_destroy(lines);
+    tfree(text, size + 1, MEMORY_TAG_STRING);
+    return entries;
+}
+
+static void destroy_baseline(baseline_entry* entries){
+    u32 count = darray_length(entries);
+    for(u32 i = 0; i < count; ++i){
+        tfree(entries[i].desc, string_length(entries[i].desc) + 1, MEMORY_TAG_STRING);
+    }
+    darray_destroy(entries);
+}
+
+/** Compares a result to its baseline, if there is one. Returns true if it regressed. */
+static b8 compare_to_baseline(const bench_result* result, baseline_entry* baseline, f64 regression_percent){
+    u32 count = darray_length(baseline);
+    for(u32 i = 0; i < count; ++i){
+        if(!strings_equal(baseline[i].desc, result->desc)){
+            continue;
+        }
+        if(baseline[i].median_ns <= 0){
+            return FALSE;
+        }
+        f64 change = (result->median_ns - baseline[i].median_ns) * 100.0 / baseline[i].median_ns;
+        if(change > regression_percent){
+            TWARN("[REGRESSION] %s: %.2f -> %.2f ns/op (%+.1f%%)", result->desc, baseline[i].median_ns, result->median_ns, change);
+            return TRUE;
+        }
+        TINFO("  vs baseline: %.2f -> %.2f ns/op (%+.1f%%)", baseline[i].median_ns, result->median_ns, change);
+        return FALSE;
+    }
+    TINFO("  vs baseline: not present");
+    return FALSE;
+}
+
+u32 bench_manager_run_benches(const bench_settings* settings){
+    u32 count = darray_length(benches);
+
+    baseline_entry* baseline = 0;
+    if(settings->baseline_path){
+        baseline = read_baseline(settings->baseline_path);
+    }
+
+    f64* samples = tallocate(sizeof(f64) * settings->runs, MEMORY_TAG_ARRAY);
+    bench_result* results = darray_create(bench_result);
+    u32 regressions = 0;
+
+    clock total_time;
+    clock_start(&total_time);
+
+    for(u32 i = 0; i < count; ++i){
+        if(settings->filter && !contains(benches[i].desc, settings->filter)){
+            continue;
+        }
+
+        bench_result result;
+        run_bench(&benches[i], settings, samples, &result);
+        report_result(&result);
+        darray_push(results, result);
+
+        if(baseline && compare_to_baseline(&result, baseline, settings->regression_percent)){
+            regressions++;
+        }
+    }
+
+    clock_update(&total_time);
+    clock_stop(&total_time);
+    TINFO("Ran %d benchmarks (%u warmup + %u timed runs each) in %.6f sec.", darray_length(results), settings->warmup_runs, settings->runs, total_time.elapsed);
+    if(baseline){
+        TINFO("%u regression(s) beyond %.1f%% against '%s'.", regressions, settings->regression_percent, settings->baseline_path);
+        destroy_baseline(baseline);
+    }
+
+    if(settings->output_path){
+        write_results(settings->output_path, results);
+    }
+
+    darray_destroy(results);
+    tfree(samples, sizeof(f64) * settings->runs, MEMORY_TAG_ARRAY);
+    return regressions;
+}
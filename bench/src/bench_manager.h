@@ -0,0 +1,47 @@
+#pragma once
+
+#include <defines.h>
+
+/**
+ * @brief A benchmark function. Performs its workload once and returns the number
+ * of operations it performed, which is used to report per-operation timings.
+ */
+typedef u64 (*PFN_bench)();
+
+/** @brief Controls how benchmarks are run and where their results go. */
+typedef struct bench_settings {
+    /** @brief Untimed runs of each benchmark before measuring, to warm caches and allocators. */
+    u32 warmup_runs;
+    /** @brief Timed runs of each benchmark. Statistics are taken across these. */
+    u32 runs;
+    /** @brief Only benchmarks whose description contains this are run. 0 runs all. */
+    const char* filter;
+    /** @brief If set, results are written here as tab-separated values. */
+    const char* output_path;
+    /** @brief If set, results are compared against a file written with output_path. */
+    const char* baseline_path;
+    /** @brief A median this many percent slower than the baseline counts as a regression. */
+    f64 regression_percent;
+} bench_settings;
+
+void bench_manager_init();
+
+/**
+ * @brief Fills the settings from command line arguments, starting from the defaults.
+ * Prints usage and returns false if they are not understood.
+ */
+b8 bench_manager_parse_args(i32 argc, char** argv, bench_settings* out_settings);
+
+void bench_manager_register_bench(PFN_bench, char* desc);
+
+/**
+ * @brief Registers a benchmark whose operations each process bytes_per_op bytes,
+ * so that its throughput is also reported in MiB/s.
+ */
+void bench_manager_register_throughput_bench(PFN_bench, char* desc, u64 bytes_per_op);
+
+/**
+ * @brief Runs every registered benchmark that passes the filter.
+ * @return The number of regressions against the baseline, or 0 without one.
+ */
+u32 bench_manager_run_benches(const bench_settings* settings);
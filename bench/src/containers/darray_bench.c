@@ -0,0 +1,43 @@
+#include "darray_bench.h"
+#include "../bench_manager.h"
+
+#include <defines.h>
+#include <containers/darray.h>
+
+#define BENCH_ELEMENT_COUNT 1000000
+
+typedef struct bench_element {
+    u64 id;
+    f32 values[6];
+} bench_element;
+
+u64 darray_bench_push_pop(){
+    // Starts empty so that the growth path is included.
+    bench_element* array = darray_create(bench_element);
+    bench_element e = {0};
+    for(u32 i = 0; i < BENCH_ELEMENT_COUNT; ++i){
+        e.id = i;
+        darray_push(array, e);
+    }
+    for(u32 i = 0; i < BENCH_ELEMENT_COUNT; ++i){
+        darray_pop(array, &e);
+    }
+    darray_destroy(array);
+    return BENCH_ELEMENT_COUNT * 2;
+}
+
+u64 darray_bench_reserved_push(){
+    bench_element* array = darray_reserve(bench_element, BENCH_ELEMENT_COUNT);
+    bench_element e = {0};
+    for(u32 i = 0; i < BENCH_ELEMENT_COUNT; ++i){
+        e.id = i;
+        darray_push(array, e);
+    }
+    darray_destroy(array);
+    return BENCH_ELEMENT_COUNT;
+}
+
+void darray_register_benches(){
+    bench_manager_register_throughput_bench(darray_bench_push_pop, "Darray push then pop, growing from empty", sizeof(bench_element));
+    bench_manager_register_throughput_bench(darray_bench_reserved_push, "Darray push into reserved capacity", sizeof(bench_element));
+}
@@ -0,0 +1,78 @@
+#include "freelist_bench.h"
+#include "../bench_manager.h"
+
+#include <defines.h>
+#include <containers/freelist.h>
+#include <core/logger.h>
+#include <core/tmemory.h>
+
+#define BENCH_LIST_SIZE MEBIBYTES(64)
+#define BENCH_OPERATION_COUNT 1000000
+
+typedef struct bench_block {
+    u64 offset;
+    u64 size;
+} bench_block;
+
+static u32 bench_random(u32* seed){
+    *seed = *seed * 1103515245 + 12345;
+    return *seed >> 8;
+}
+
+/**
+ * Runs a long random sequence against a freelist: each step frees a random live block
+ * and allocates a new one of random size in its place, keeping live_count blocks alive.
+ */
+static u64 run_random_churn(u32 live_count, u64 min_size, u64 max_size){
+    freelist list;
+    u64 memory_requirement = 0;
+    freelist_create(BENCH_LIST_SIZE, &memory_requirement, 0, 0);
+    void* memory = tallocate(memory_requirement, MEMORY_TAG_APPLICATION);
+    freelist_create(BENCH_LIST_SIZE, &memory_requirement, memory, &list);
+
+    bench_block* blocks = tallocate(sizeof(bench_block) * live_count, MEMORY_TAG_APPLICATION);
+    u32 seed = 42;
+    for(u32 i = 0; i < live_count; ++i){
+        blocks[i].size = min_size + (bench_random(&seed) % (max_size - min_size));
+        freelist_allocate_block(&list, blocks[i].size, &blocks[i].offset);
+    }
+
+    u64 failures = 0;
+    for(u32 i = 0; i < BENCH_OPERATION_COUNT; ++i){
+        bench_block* block = &blocks[bench_random(&seed) % live_count];
+        freelist_free_block(&list, block->size, block->offset);
+        block->size = min_size + (bench_random(&seed) % (max_size - min_size));
+        if(!freelist_allocate_block(&list, block->size, &block->offset)){
+            // Keep the slot consistent; it gets retried the next time it is picked.
+            block->size = 0;
+            failures++;
+        }
+    }
+
+    TINFO("  freelist: %llu live blocks, %llu free blocks, largest free %lluB of %lluB free, %llu failed allocations.",
+          (u64)live_count, freelist_free_block_count(&list), freelist_largest_free_block(&list), freelist_free_space(&list), failures);
+
+    tfree(blocks, sizeof(bench_block) * live_count, MEMORY_TAG_APPLICATION);
+    freelist_destroy(&list);
+    tfree(memory, memory_requirement, MEMORY_TAG_APPLICATION);
+    return (u64)live_count + (BENCH_OPERATION_COUNT * 2);
+}
+
+u64 freelist_bench_small_block_churn(){
+    return run_random_churn(1024, 16, 512);
+}
+
+u64 freelist_bench_fragmented_churn(){
+    // Many live blocks of widely varying size leave lots of holes to search and merge.
+    return run_random_churn(16384, 16, KIBIBYTES(2));
+}
+
+u64 freelist_bench_large_block_churn(){
+    return run_random_churn(256, KIBIBYTES(4), KIBIBYTES(128));
+}
+
+void freelist_register_benches(){
+    bench_manager_register_bench(freelist_bench_small_block_churn, "Freelist random alloc/free churn, 1024 small blocks");
+    bench_manager_register_bench(freelist_bench_fragmented_churn, "Freelist random alloc/free churn, 16384 mixed blocks");
+    bench_manager_register_bench(freelist_bench_large_block_churn, "Freelist random alloc/free churn, 256 large blocks");
+}
@@ -0,0 +1,143 @@
+#include "hashtable_bench.h"
+#include "../bench_manager.h"
+
+#include <defines.h>
+#include <containers/hashtable.h>
+#include <core/logger.h>
+#include <core/tstring.h>
+#include <core/tmemory.h>
+
+#define BENCH_ENTRY_COUNT 4096
+#define BENCH_LOOKUP_ROUNDS 16
+
+static char names[BENCH_ENTRY_COUNT][32];
+static b8 names_generated = FALSE;
+
+static void generate_names(){
+    if(names_generated){
+        return;
+    }
+    for(u32 i = 0; i < BENCH_ENTRY_COUNT; ++i){
+        string_format(names[i], "textures/asset_%u_diff", i);
+    }
+    names_generated = TRUE;
+}
+
+// NOTE: A copy of the previous direct-mapped table (no stored keys, no probing),
+// kept here only as a baseline to compare against.
+static u64 legacy_hash_name(const char* name, u32 element_count){
+    static const u64 multiplier = 97;
+    u64 hash = 0;
+    for(const u8* us = (const u8*)name; *us; us++){
+        hash = hash * multiplier + *us;
+    }
+    return hash % element_count;
+}
+
+static void legacy_set(void* memory, u64 element_size, u32 element_count, const char* name, void* value){
+    tcopy_memory(memory + (element_size * legacy_hash_name(name, element_count)), value, element_size);
+}
+
+static void legacy_get(void* memory, u64 element_size, u32 element_count, const char* name, void* out_value){
+    tcopy_memory(out_value, memory + (element_size * legacy_hash_name(name, element_count)), element_size);
+}
+
+u64 hashtable_bench_set_and_get_full(){
+    generate_names();
+    static u64 memory[BENCH_ENTRY_COUNT];
+    hashtable table;
+    hashtable_create(sizeof(u64), BENCH_ENTRY_COUNT, memory, FALSE, &table);
+
+    for(u64 i = 0; i < BENCH_ENTRY_COUNT; ++i){
+        hashtable_set(&table, names[i], &i);
+    }
+
+    u64 mismatches = 0;
+    for(u32 round = 0; round < BENCH_LOOKUP_ROUNDS; ++round){
+        for(u64 i = 0; i < BENCH_ENTRY_COUNT; ++i){
+            u64 value = 0;
+            hashtable_get(&table, names[i], &value);
+            mismatches += value != i;
+        }
+    }
+
+    TINFO("  hashtable: load factor %.2f, %llu wrong values.", hashtable_load_factor(&table), mismatches);
+    hashtable_destroy(&table);
+    return BENCH_ENTRY_COUNT + (BENCH_ENTRY_COUNT * BENCH_LOOKUP_ROUNDS);
+}
+
+u64 hashtable_bench_legacy_set_and_get_full(){
+    generate_names();
+    static u64 memory[BENCH_ENTRY_COUNT];
+    tzero_memory(memory, sizeof(memory));
+
+    for(u64 i = 0; i < BENCH_ENTRY_COUNT; ++i){
+        legacy_set(memory, sizeof(u64), BENCH_ENTRY_COUNT, names[i], &i);
+    }
+
+    u64 mismatches = 0;
+    for(u32 round = 0; round < BENCH_LOOKUP_ROUNDS; ++round){
+        for(u64 i = 0; i < BENCH_ENTRY_COUNT; ++i){
+            u64 value = 0;
+            legacy_get(memory, sizeof(u64), BENCH_ENTRY_COUNT, names[i], &value);
+            mismatches += value != i;
+        }
+    }
+
+    TINFO("  legacy table: %llu wrong values due to collisions.", mismatches / BENCH_LOOKUP_ROUNDS);
+    return BENCH_ENTRY_COUNT + (BENCH_ENTRY_COUNT * BENCH_LOOKUP_ROUNDS);
+}
+
+u64 hashtable_bench_missing_lookups(){
+    generate_names();
+    static u64 memory[BENCH_ENTRY_COUNT];
+    hashtable table;
+    hashtable_create(sizeof(u64), BENCH_ENTRY_COUNT, memory, FALSE, &table);
+    u64 invalid = INVALID_ID_U64;
+    hashtable_fill(&table, &invalid);
+
+    // Insert the first half, then look up only the second half.
+    for(u64 i = 0; i < BENCH_ENTRY_COUNT / 2; ++i){
+        hashtable_set(&table, names[i], &i);
+    }
+    for(u32 round = 0; round < BENCH_LOOKUP_ROUNDS; ++round){
+        for(u64 i = BENCH_ENTRY_COUNT / 2; i < BENCH_ENTRY_COUNT; ++i){
+            u64 value = 0;
+            hashtable_get(&table, names[i], &value);
+        }
+    }
+
+    hashtable_destroy(&table);
+    return (BENCH_ENTRY_COUNT / 2) + ((BENCH_ENTRY_COUNT / 2) * BENCH_LOOKUP_ROUNDS);
+}
+
+u64 hashtable_bench_remove_and_reinsert(){
+    generate_names();
+    static u64 memory[BENCH_ENTRY_COUNT];
+    hashtable table;
+    hashtable_create(sizeof(u64), BENCH_ENTRY_COUNT, memory, FALSE, &table);
+
+    for(u64 i = 0; i < BENCH_ENTRY_COUNT; ++i){
+        hashtable_set(&table, names[i], &i);
+    }
+
+    // Churn a quarter of the table repeatedly, as texture/material release and reacquire would.
+    u64 operations = BENCH_ENTRY_COUNT;
+    for(u32 round = 0; round < BENCH_LOOKUP_ROUNDS; ++round){
+        for(u64 i = 0; i < BENCH_ENTRY_COUNT; i += 4){
+            hashtable_remove(&table, names[i]);
+            hashtable_set(&table, names[i], &i);
+            operations += 2;
+        }
+    }
+
+    hashtable_destroy(&table);
+    return operations;
+}
+
+void hashtable_register_benches(){
+    bench_manager_register_bench(hashtable_bench_set_and_get_full, "Hashtable set and get at full capacity");
+    bench_manager_register_bench(hashtable_bench_legacy_set_and_get_full, "Legacy direct-mapped table set and get at full capacity");
+    bench_manager_register_bench(hashtable_bench_missing_lookups, "Hashtable lookups of missing names");
+    bench_manager_register_bench(hashtable_bench_remove_and_reinsert, "Hashtable remove and reinsert churn");
+}
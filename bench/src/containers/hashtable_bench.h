@@ -0,0 +1,3 @@
+#pragma once
+
+void hashtable_register_benches();
@@ -0,0 +1,54 @@
+#include "ring_queue_bench.h"
+#include "../bench_manager.h"
+
+#include <defines.h>
+#include <containers/ring_queue.h>
+
+#define BENCH_QUEUE_CAPACITY 1024
+#define BENCH_OPERATION_COUNT 1000000
+
+typedef struct bench_item {
+    u64 id;
+    u64 payload[3];
+} bench_item;
+
+u64 ring_queue_bench_enqueue_dequeue(){
+    ring_queue queue;
+    ring_queue_create(sizeof(bench_item), BENCH_QUEUE_CAPACITY, 0, &queue);
+
+    bench_item item = {0};
+    for(u32 i = 0; i < BENCH_OPERATION_COUNT; ++i){
+        item.id = i;
+        ring_queue_enqueue(&queue, &item);
+        ring_queue_dequeue(&queue, &item);
+    }
+
+    ring_queue_destroy(&queue);
+    return BENCH_OPERATION_COUNT * 2;
+}
+
+u64 ring_queue_bench_fill_drain(){
+    ring_queue queue;
+    ring_queue_create(sizeof(bench_item), BENCH_QUEUE_CAPACITY, 0, &queue);
+
+    // Runs the queue full and empty again so the head and tail keep wrapping.
+    bench_item item = {0};
+    u32 rounds = BENCH_OPERATION_COUNT / BENCH_QUEUE_CAPACITY;
+    for(u32 r = 0; r < rounds; ++r){
+        for(u32 i = 0; i < BENCH_QUEUE_CAPACITY; ++i){
+            item.id = i;
+            ring_queue_enqueue(&queue, &item);
+        }
+        for(u32 i = 0; i < BENCH_QUEUE_CAPACITY; ++i){
+            ring_queue_dequeue(&queue, &item);
+        }
+    }
+
+    ring_queue_destroy(&queue);
+    return (u64)rounds * BENCH_QUEUE_CAPACITY * 2;
+}
+
+void ring_queue_register_benches(){
+    bench_manager_register_throughput_bench(ring_queue_bench_enqueue_dequeue, "Ring queue enqueue/dequeue pairs", sizeof(bench_item));
+    bench_manager_register_throughput_bench(ring_queue_bench_fill_drain, "Ring queue fill and drain, 1024 capacity", sizeof(bench_item));
+}
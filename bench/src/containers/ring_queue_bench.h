@@ -0,0 +1,3 @@
+#pragma once
+
+void ring_queue_register_benches();
@@ -0,0 +1,32 @@
+#include "profiler_bench.h"
+#include "../bench_manager.h"
+
+#include <defines.h>
+#include <core/profiler.h>
+#include <core/tmemory.h>
+
+#define BENCH_ZONE_COUNT 1000000
+
+u64 profiler_bench_nested_zones(){
+    u64 requirement = 0;
+    profiler_system_initialize(&requirement, 0);
+    void* state = tallocate(requirement, MEMORY_TAG_APPLICATION);
+    profiler_system_initialize(&requirement, state);
+
+    // Pairs of nested zones, roughly the shape of a frame's instrumentation.
+    for(u32 i = 0; i < BENCH_ZONE_COUNT / 2; ++i){
+        TPROFILE_BEGIN("outer");
+        TPROFILE_BEGIN("inner");
+        TPROFILE_END();
+        TPROFILE_END();
+    }
+
+    profiler_system_shutdown(state);
+    tfree(state, requirement, MEMORY_TAG_APPLICATION);
+    return BENCH_ZONE_COUNT;
+}
+
+void profiler_register_benches(){
+    // ns/op is the cost of one zone: a begin and an end.
+    bench_manager_register_bench(profiler_bench_nested_zones, "Profiler zone begin/end");
+}
@@ -0,0 +1,89 @@
+#include "tstring_bench.h"
+#include "../bench_manager.h"
+
+#include <defines.h>
+#include <containers/darray.h>
+#include <core/tstring.h>
+
+#define BENCH_OPERATION_COUNT 200000
+
+// Lines shaped like the ones the material and shader config parsers read.
+static const char* bench_lines[] = {
+    "diffuse_colour=0.800000 0.800000 0.800000 1.000000",
+    "  shininess = 32.0  ",
+    "attribute=vec3,in_position",
+    "uniform=samp,1,diffuse_texture",
+    "renderpass=Renderpass.Builtin.World",
+};
+#define BENCH_LINE_COUNT (sizeof(bench_lines) / sizeof(bench_lines[0]))
+
+static volatile u64 sink;
+
+u64 tstring_bench_split(){
+    u64 total = 0;
+    char** parts = darray_create(char*);
+    for(u32 i = 0; i < BENCH_OPERATION_COUNT; ++i){
+        u32 count = string_split(bench_lines[i % BENCH_LINE_COUNT], ',', &parts, TRUE, FALSE);
+        total += count;
+        string_cleanup_split_array(parts);
+        darray_clear(parts);
+    }
+    darray_destroy(parts);
+    sink = total;
+    return BENCH_OPERATION_COUNT;
+}
+
+u64 tstring_bench_trim_and_parse(){
+    char line[128];
+    f32 total = 0;
+    for(u32 i = 0; i < BENCH_OPERATION_COUNT; ++i){
+        string_copy(line, "  shininess = 32.0  ");
+        char* trimmed = string_trim(line);
+        i32 equals = string_index_of(trimmed, '=');
+        f32 f = 0;
+        string_to_f32(string_trim(trimmed + equals + 1), &f);
+        total += f;
+    }
+    sink = (u64)total;
+    return BENCH_OPERATION_COUNT;
+}
+
+u64 tstring_bench_to_vec4(){
+    char line[128];
+    vec4 v;
+    f32 total = 0;
+    for(u32 i = 0; i < BENCH_OPERATION_COUNT; ++i){
+        string_copy(line, "0.800000 0.800000 0.800000 1.000000");
+        string_to_vec4(line, &v);
+        total += v.w;
+    }
+    sink = (u64)total;
+    return BENCH_OPERATION_COUNT;
+}
+
+u64 tstring_bench_format(){
+    char buffer[256];
+    u64 total = 0;
+    for(u32 i = 0; i < BENCH_OPERATION_COUNT; ++i){
+        total += string_format(buffer, "%s/%s/%s%s", "../assets", "textures", "cobblestone", ".png");
+    }
+    sink = total;
+    return BENCH_OPERATION_COUNT;
+}
+
+u64 tstring_bench_equali(){
+    u64 total = 0;
+    for(u32 i = 0; i < BENCH_OPERATION_COUNT; ++i){
+        total += strings_equali(bench_lines[i % BENCH_LINE_COUNT], "RENDERPASS=RENDERPASS.BUILTIN.WORLD");
+    }
+    sink = total;
+    return BENCH_OPERATION_COUNT;
+}
+
+void tstring_register_benches(){
+    bench_manager_register_bench(tstring_bench_split, "String split config lines on ','");
+    bench_manager_register_bench(tstring_bench_trim_and_parse, "String trim and parse a key=value f32");
+    bench_manager_register_bench(tstring_bench_to_vec4, "String to vec4");
+    bench_manager_register_bench(tstring_bench_format, "String format an asset path");
+    bench_manager_register_bench(tstring_bench_equali, "String case-insensitive compare");
+}
@@ -0,0 +1,3 @@
+#pragma once
+
+void tstring_register_benches();
@@ -0,0 +1,75 @@
+#include "bench_manager.h"
+
+#include "containers/darray_bench.h"
+#include "containers/freelist_bench.h"
+#include "containers/hashtable_bench.h"
+#include "containers/ring_queue_bench.h"
+#include "core/profiler_bench.h"
+#include "core/tstring_bench.h"
+#include "math/geometry_utils_bench.h"
+#include "math/tmath_bench.h"
+#include "memory/dynamic_allocator_bench.h"
+#include "memory/linear_allocator_bench.h"
+#include "memory/tmemory_bench.h"
+#include "renderer/draw_key_bench.h"
+#include "resources/loader_bench.h"
+#include "systems/job_system_bench.h"
+#include "systems/transform_system_bench.h"
+
+#include <core/logger.h>
+#include <core/tmemory.h>
+
+int main(int argc, char** argv){
+    bench_settings settings;
+    if(!bench_manager_parse_args(argc, argv, &settings)){
+        return 1;
+    }
+
+    // Benchmarks should measure the engine's real allocator, so stand up the memory system first.
+    memory_system_configuration memory_config = {};
+    memory_config.total_alloc_size = MEBIBYTES(256);
+    if(!memory_system_initialize(memory_config)){
+        TFATAL("Failed to initialize memory system for benchmarks.");
+        return 1;
+    }
+
+    if(!job_system_bench_startup()){
+        TFATAL("Failed to initialize job system for benchmarks.");
+        return 1;
+    }
+
+    if(!loader_bench_startup()){
+        TFATAL("Failed to initialize resource system for benchmarks.");
+        return 1;
+    }
+
+    bench_manager_init();
+
+    hashtable_register_benches();
+    freelist_register_benches();
+    darray_register_benches();
+    ring_queue_register_benches();
+    tmemory_register_benches();
+    dynamic_allocator_register_benches();
+    linear_allocator_register_benches();
+    tmath_register_benches();
+    geometry_utils_register_benches();
+    tstring_register_benches();
+    profiler_register_benches();
+    loader_register_benches();
+    job_system_register_benches();
+    transform_system_register_benches();
+    draw_key_register_benches();
+
+    TDEBUG("Starting benchmarks...");
+
+    u32 regressions = bench_manager_run_benches(&settings);
+
+    loader_bench_shutdown();
+
+    job_system_bench_shutdown();
+
+    memory_system_shutdown();
+
+    return regressions > 0 ? 2 : 0;
+}
@@ -0,0 +1,74 @@
+#include "geometry_utils_bench.h"
+#include "../bench_manager.h"
+
+#include <defines.h>
+#include <core/tmemory.h>
+#include <math/tmath.h>
+#include <math/geometry_utils.h>
+
+// A grid of quads, each with its own four vertices the way an .obj import produces them,
+// so neighbouring quads share positions that deduplication can merge.
+// Deduplication compares every vertex against those kept so far, so the grid stays small.
+#define BENCH_GRID_SIZE 32
+#define BENCH_QUAD_COUNT (BENCH_GRID_SIZE * BENCH_GRID_SIZE)
+#define BENCH_VERTEX_COUNT (BENCH_QUAD_COUNT * 4)
+#define BENCH_INDEX_COUNT (BENCH_QUAD_COUNT * 6)
+
+static void build_grid(vertex_3d* vertices, u32* indices){
+    tzero_memory(vertices, sizeof(vertex_3d) * BENCH_VERTEX_COUNT);
+    u32 v = 0;
+    u32 n = 0;
+    for(u32 y = 0; y < BENCH_GRID_SIZE; ++y){
+        for(u32 x = 0; x < BENCH_GRID_SIZE; ++x){
+            for(u32 c = 0; c < 4; ++c){
+                u32 cx = x + (c & 1);
+                u32 cy = y + (c >> 1);
+                vertices[v + c].position = vec3_create((f32)cx, 0.0f, (f32)cy);
+                vertices[v + c].normal = vec3_create(0.0f, 1.0f, 0.0f);
+                vertices[v + c].texcoord = vec2_create((f32)cx / BENCH_GRID_SIZE, (f32)cy / BENCH_GRID_SIZE);
+                vertices[v + c].colour = vec4_one();
+            }
+            indices[n++] = v + 0;
+            indices[n++] = v + 2;
+            indices[n++] = v + 1;
+            indices[n++] = v + 1;
+            indices[n++] = v + 2;
+            indices[n++] = v + 3;
+            v += 4;
+        }
+    }
+}
+
+u64 geometry_utils_bench_generate_tangents(){
+    vertex_3d* vertices = tallocate_uninitialized(sizeof(vertex_3d) * BENCH_VERTEX_COUNT, TMEMORY_DEFAULT_ALIGNMENT, MEMORY_TAG_ARRAY);
+    u32* indices = tallocate_uninitialized(sizeof(u32) * BENCH_INDEX_COUNT, TMEMORY_DEFAULT_ALIGNMENT, MEMORY_TAG_ARRAY);
+    build_grid(vertices, indices);
+
+    geometry_generate_tangents(BENCH_VERTEX_COUNT, vertices, BENCH_INDEX_COUNT, indices);
+
+    tfree(indices, sizeof(u32) * BENCH_INDEX_COUNT, MEMORY_TAG_ARRAY);
+    tfree(vertices, sizeof(vertex_3d) * BENCH_VERTEX_COUNT, MEMORY_TAG_ARRAY);
+    // One operation per triangle.
+    return BENCH_INDEX_COUNT / 3;
+}
+
+u64 geometry_utils_bench_deduplicate_vertices(){
+    vertex_3d* vertices = tallocate_uninitialized(sizeof(vertex_3d) * BENCH_VERTEX_COUNT, TMEMORY_DEFAULT_ALIGNMENT, MEMORY_TAG_ARRAY);
+    u32* indices = tallocate_uninitialized(sizeof(u32) * BENCH_INDEX_COUNT, TMEMORY_DEFAULT_ALIGNMENT, MEMORY_TAG_ARRAY);
+    build_grid(vertices, indices);
+
+    u32 unique_count = 0;
+    vertex_3d* unique_vertices = 0;
+    geometry_deduplicate_vertices(BENCH_VERTEX_COUNT, vertices, BENCH_INDEX_COUNT, indices, &unique_count, &unique_vertices);
+
+    tfree(unique_vertices, sizeof(vertex_3d) * unique_count, MEMORY_TAG_ARRAY);
+    tfree(indices, sizeof(u32) * BENCH_INDEX_COUNT, MEMORY_TAG_ARRAY);
+    tfree(vertices, sizeof(vertex_3d) * BENCH_VERTEX_COUNT, MEMORY_TAG_ARRAY);
+    // One operation per input vertex.
+    return BENCH_VERTEX_COUNT;
+}
+
+void geometry_utils_register_benches(){
+    bench_manager_register_bench(geometry_utils_bench_generate_tangents, "Geometry generate tangents, 32x32 quad grid");
+    bench_manager_register_bench(geometry_utils_bench_deduplicate_vertices, "Geometry deduplicate vertices, 32x32 quad grid");
+}
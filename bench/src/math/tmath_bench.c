@@ -0,0 +1,178 @@
+#include "tmath_bench.h"
+#include "../bench_manager.h"
+
+#include <defines.h>
+#include <core/logger.h>
+#include <math/tmath.h>
+
+#define BENCH_INPUT_COUNT 1024
+#define BENCH_OPERATION_COUNT 1000000
+
+// Inputs are built at run time and results summed into a sink, so the compiler can
+// neither fold the math away nor drop it as unused.
+static mat4 matrices[BENCH_INPUT_COUNT];
+static quat rotations[BENCH_INPUT_COUNT];
+static vec3 points[BENCH_INPUT_COUNT];
+static mat4 out_matrices[BENCH_INPUT_COUNT];
+static vec3 out_points[BENCH_INPUT_COUNT];
+static vec3 half_extents[BENCH_INPUT_COUNT];
+static u32 visible_indices[BENCH_INPUT_COUNT];
+static volatile f32 sink;
+
+static void build_inputs(){
+    u32 seed = 42;
+    for(u32 i = 0; i < BENCH_INPUT_COUNT; ++i){
+        seed = seed * 1103515245 + 12345;
+        f32 angle = (f32)((seed >> 8) % 6283) / 1000.0f;
+        vec3 axis = vec3_normalized(vec3_create(1.0f, (f32)(i % 7) - 3.0f, 0.5f));
+        rotations[i] = quat_from_axis_angle(axis, angle, TRUE);
+        matrices[i] = mat4_mul(quat_to_mat4(rotations[i]), mat4_translation(vec3_create((f32)i, 2.0f, -1.0f)));
+        points[i] = vec3_create((f32)(i % 13), (f32)(i % 5) - 2.0f, angle);
+        half_extents[i] = vec3_create(0.25f, 0.5f, (f32)(i % 3) * 0.25f);
+    }
+}
+
+u64 tmath_bench_mat4_mul(){
+    build_inputs();
+    f32 total = 0;
+    for(u32 i = 0; i < BENCH_OPERATION_COUNT; ++i){
+        mat4 m = mat4_mul(matrices[i % BENCH_INPUT_COUNT], matrices[(i + 1) % BENCH_INPUT_COUNT]);
+        total += m.data[i % 16];
+    }
+    sink = total;
+    return BENCH_OPERATION_COUNT;
+}
+
+u64 tmath_bench_mat4_inverse(){
+    build_inputs();
+    f32 total = 0;
+    for(u32 i = 0; i < BENCH_OPERATION_COUNT; ++i){
+        mat4 m = mat4_inverse(matrices[i % BENCH_INPUT_COUNT]);
+        total += m.data[i % 16];
+    }
+    sink = total;
+    return BENCH_OPERATION_COUNT;
+}
+
+u64 tmath_bench_mat4_transposed(){
+    build_inputs();
+    f32 total = 0;
+    for(u32 i = 0; i < BENCH_OPERATION_COUNT; ++i){
+        mat4 m = mat4_transposed(matrices[i % BENCH_INPUT_COUNT]);
+        total += m.data[i % 16];
+    }
+    sink = total;
+    return BENCH_OPERATION_COUNT;
+}
+
+u64 tmath_bench_vec3_transform(){
+    build_inputs();
+    f32 total = 0;
+    for(u32 i = 0; i < BENCH_OPERATION_COUNT; ++i){
+        vec3 p = vec3_transform(points[i % BENCH_INPUT_COUNT], matrices[(i >> 10) % BENCH_INPUT_COUNT]);
+        total += p.y;
+    }
+    sink = total;
+    return BENCH_OPERATION_COUNT;
+}
+
+// The batched benches count one operation per matrix or point, so they compare directly
+// with the single-call benches above.
+u64 tmath_bench_mat4_mul_batch(){
+    build_inputs();
+    f32 total = 0;
+    for(u32 i = 0; i < BENCH_OPERATION_COUNT / BENCH_INPUT_COUNT; ++i){
+        mat4_mul_batch(matrices, BENCH_INPUT_COUNT, matrices[i % BENCH_INPUT_COUNT], out_matrices);
+        total += out_matrices[i % BENCH_INPUT_COUNT].data[i % 16];
+    }
+    sink = total;
+    return (BENCH_OPERATION_COUNT / BENCH_INPUT_COUNT) * BENCH_INPUT_COUNT;
+}
+
+u64 tmath_bench_vec3_transform_batch(){
+    build_inputs();
+    f32 total = 0;
+    for(u32 i = 0; i < BENCH_OPERATION_COUNT / BENCH_INPUT_COUNT; ++i){
+        vec3_transform_batch(points, BENCH_INPUT_COUNT, matrices[i % BENCH_INPUT_COUNT], out_points);
+        total += out_points[i % BENCH_INPUT_COUNT].y;
+    }
+    sink = total;
+    return (BENCH_OPERATION_COUNT / BENCH_INPUT_COUNT) * BENCH_INPUT_COUNT;
+}
+
+/** A narrow frustum that sees roughly half of the points. */
+static frustum bench_frustum(){
+    mat4 view = mat4_inverse(mat4_translation(vec3_create(3.0f, 0.0f, 20.0f)));
+    mat4 projection = mat4_perspective(deg_to_rad(20.0f), 1.0f, 0.1f, 100.0f);
+    return frustum_from_view_projection(mat4_mul(view, projection));
+}
+
+u64 tmath_bench_frustum_intersects_aabb(){
+    build_inputs();
+    frustum f = bench_frustum();
+    u32 visible_count = 0;
+    for(u32 i = 0; i < BENCH_OPERATION_COUNT; ++i){
+        visible_count += frustum_intersects_aabb(&f, points[i % BENCH_INPUT_COUNT], half_extents[i % BENCH_INPUT_COUNT]);
+    }
+    sink = (f32)visible_count;
+    return BENCH_OPERATION_COUNT;
+}
+
+u64 tmath_bench_frustum_cull_aabbs(){
+    build_inputs();
+    frustum f = bench_frustum();
+    u32 visible_count = 0;
+    for(u32 i = 0; i < BENCH_OPERATION_COUNT / BENCH_INPUT_COUNT; ++i){
+        visible_count += frustum_cull_aabbs(&f, points, half_extents, BENCH_INPUT_COUNT, visible_indices);
+    }
+    sink = (f32)visible_count;
+    return (BENCH_OPERATION_COUNT / BENCH_INPUT_COUNT) * BENCH_INPUT_COUNT;
+}
+
+u64 tmath_bench_quat_mul(){
+    build_inputs();
+    f32 total = 0;
+    for(u32 i = 0; i < BENCH_OPERATION_COUNT; ++i){
+        quat q = quat_mul(rotations[i % BENCH_INPUT_COUNT], rotations[(i + 1) % BENCH_INPUT_COUNT]);
+        total += q.w;
+    }
+    sink = total;
+    return BENCH_OPERATION_COUNT;
+}
+
+u64 tmath_bench_quat_to_mat4(){
+    build_inputs();
+    f32 total = 0;
+    for(u32 i = 0; i < BENCH_OPERATION_COUNT; ++i){
+        mat4 m = quat_to_mat4(rotations[i % BENCH_INPUT_COUNT]);
+        total += m.data[i % 16];
+    }
+    sink = total;
+    return BENCH_OPERATION_COUNT;
+}
+
+u64 tmath_bench_quat_slerp(){
+    build_inputs();
+    f32 total = 0;
+    for(u32 i = 0; i < BENCH_OPERATION_COUNT; ++i){
+        quat q = quat_slerp(rotations[i % BENCH_INPUT_COUNT], rotations[(i + 1) % BENCH_INPUT_COUNT], (f32)(i % 100) / 100.0f);
+        total += q.w;
+    }
+    sink = total;
+    return BENCH_OPERATION_COUNT;
+}
+
+void tmath_register_benches(){
+    TINFO("Math benches use the %s kernels.", tmath_simd_name());
+    bench_manager_register_bench(tmath_bench_mat4_mul, "Math mat4_mul");
+    bench_manager_register_bench(tmath_bench_mat4_mul_batch, "Math mat4_mul_batch");
+    bench_manager_register_bench(tmath_bench_mat4_inverse, "Math mat4_inverse");
+    bench_manager_register_bench(tmath_bench_mat4_transposed, "Math mat4_transposed");
+    bench_manager_register_bench(tmath_bench_vec3_transform, "Math vec3_transform");
+    bench_manager_register_bench(tmath_bench_vec3_transform_batch, "Math vec3_transform_batch");
+    bench_manager_register_bench(tmath_bench_frustum_intersects_aabb, "Math frustum_intersects_aabb");
+    bench_manager_register_bench(tmath_bench_frustum_cull_aabbs, "Math frustum_cull_aabbs");
+    bench_manager_register_bench(tmath_bench_quat_mul, "Math quat_mul");
+    bench_manager_register_bench(tmath_bench_quat_to_mat4, "Math quat_to_mat4");
+    bench_manager_register_bench(tmath_bench_quat_slerp, "Math quat_slerp");
+}
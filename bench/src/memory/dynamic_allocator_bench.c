@@ -0,0 +1,73 @@
+#include "dynamic_allocator_bench.h"
+#include "../bench_manager.h"
+
+#include <defines.h>
+#include <memory/dynamic_allocator.h>
+#include <core/tmemory.h>
+
+#define BENCH_ALLOCATOR_SIZE MEBIBYTES(64)
+#define BENCH_OPERATION_COUNT 500000
+#define BENCH_LIVE_COUNT 4096
+
+typedef struct bench_block {
+    void* block;
+    u64 size;
+} bench_block;
+
+static u32 bench_random(u32* seed){
+    *seed = *seed * 1103515245 + 12345;
+    return *seed >> 8;
+}
+
+/**
+ * Keeps BENCH_LIVE_COUNT blocks alive in a dynamic allocator, repeatedly freeing a random
+ * one and allocating a new one of random size in its place.
+ */
+static u64 run_random_churn(u64 min_size, u64 max_size, u16 alignment){
+    dynamic_allocator allocator;
+    u64 memory_requirement = 0;
+    dynamic_allocator_create(BENCH_ALLOCATOR_SIZE, &memory_requirement, 0, 0);
+    void* memory = tallocate(memory_requirement, MEMORY_TAG_APPLICATION);
+    dynamic_allocator_create(BENCH_ALLOCATOR_SIZE, &memory_requirement, memory, &allocator);
+
+    bench_block* blocks = tallocate(sizeof(bench_block) * BENCH_LIVE_COUNT, MEMORY_TAG_APPLICATION);
+    u32 seed = 42;
+    for(u32 i = 0; i < BENCH_LIVE_COUNT; ++i){
+        blocks[i].size = min_size + (bench_random(&seed) % (max_size - min_size));
+        blocks[i].block = alignment ? dynamic_allocator_allocate_aligned(&allocator, blocks[i].size, alignment)
+                                    : dynamic_allocator_allocate(&allocator, blocks[i].size);
+    }
+
+    for(u32 i = 0; i < BENCH_OPERATION_COUNT; ++i){
+        bench_block* block = &blocks[bench_random(&seed) % BENCH_LIVE_COUNT];
+        if(block->block){
+            dynamic_allocator_free(&allocator, block->block, block->size);
+        }
+        block->size = min_size + (bench_random(&seed) % (max_size - min_size));
+        block->block = alignment ? dynamic_allocator_allocate_aligned(&allocator, block->size, alignment)
+                                 : dynamic_allocator_allocate(&allocator, block->size);
+    }
+
+    tfree(blocks, sizeof(bench_block) * BENCH_LIVE_COUNT, MEMORY_TAG_APPLICATION);
+    dynamic_allocator_destroy(&allocator);
+    tfree(memory, memory_requirement, MEMORY_TAG_APPLICATION);
+    return BENCH_LIVE_COUNT + (BENCH_OPERATION_COUNT * 2);
+}
+
+u64 dynamic_allocator_bench_small_churn(){
+    return run_random_churn(16, 512, 0);
+}
+
+u64 dynamic_allocator_bench_mixed_churn(){
+    return run_random_churn(16, KIBIBYTES(8), 0);
+}
+
+u64 dynamic_allocator_bench_aligned_churn(){
+    return run_random_churn(16, KIBIBYTES(2), 256);
+}
+
+void dynamic_allocator_register_benches(){
+    bench_manager_register_bench(dynamic_allocator_bench_small_churn, "Dynamic allocator random alloc/free churn, 4096 small blocks");
+    bench_manager_register_bench(dynamic_allocator_bench_mixed_churn, "Dynamic allocator random alloc/free churn, 4096 mixed blocks");
+    bench_manager_register_bench(dynamic_allocator_bench_aligned_churn, "Dynamic allocator random 256-byte aligned alloc/free churn");
+}
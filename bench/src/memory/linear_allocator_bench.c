@@ -0,0 +1,45 @@
+#include "linear_allocator_bench.h"
+#include "../bench_manager.h"
+
+#include <defines.h>
+#include <memory/linear_allocator.h>
+
+#define BENCH_ALLOCATOR_SIZE MEBIBYTES(16)
+#define BENCH_FRAME_COUNT 100
+
+/**
+ * Fills an allocator with blocks of the given size, then frees them all at once,
+ * the way a per-frame allocator is used.
+ */
+static u64 run_fill_and_reset(u64 block_size){
+    linear_allocator allocator;
+    linear_allocator_create(BENCH_ALLOCATOR_SIZE, 0, &allocator);
+
+    u64 operations = 0;
+    u64 blocks_per_frame = BENCH_ALLOCATOR_SIZE / block_size;
+    for(u32 frame = 0; frame < BENCH_FRAME_COUNT; ++frame){
+        for(u64 i = 0; i < blocks_per_frame; ++i){
+            void* block = linear_allocator_allocate(&allocator, block_size);
+            // Touch the block so the allocation can't be skipped.
+            *(volatile u8*)block = (u8)i;
+        }
+        linear_allocator_free_all(&allocator);
+        operations += blocks_per_frame + 1;
+    }
+
+    linear_allocator_destroy(&allocator);
+    return operations;
+}
+
+u64 linear_allocator_bench_small_blocks(){
+    return run_fill_and_reset(32);
+}
+
+u64 linear_allocator_bench_large_blocks(){
+    return run_fill_and_reset(KIBIBYTES(4));
+}
+
+void linear_allocator_register_benches(){
+    bench_manager_register_bench(linear_allocator_bench_small_blocks, "Linear allocator fill and reset, 32B blocks");
+    bench_manager_register_bench(linear_allocator_bench_large_blocks, "Linear allocator fill and reset, 4KiB blocks");
+}
@@ -0,0 +1,134 @@
+#include "tmemory_bench.h"
+#include "../bench_manager.h"
+
+#include <defines.h>
+#include <core/tmemory.h>
+#include <core/tthread.h>
+
+#define BENCH_MAX_THREADS 8
+#define BENCH_OPERATIONS_PER_THREAD 200000
+#define BENCH_LIVE_BLOCKS 64
+// Sized like a staging or pixel buffer that is overwritten in full right away.
+#define BENCH_BUFFER_SIZE MEBIBYTES(4)
+#define BENCH_BUFFER_ROUNDS 64
+
+typedef struct allocation_bench_params {
+    u64 min_size;
+    u64 size_range;
+} allocation_bench_params;
+
+static u32 allocation_bench_thread(void* params){
+    allocation_bench_params* p = params;
+    void* blocks[BENCH_LIVE_BLOCKS] = {0};
+    u64 sizes[BENCH_LIVE_BLOCKS] = {0};
+
+    // Replace one block out of a sliding window at a time, as per-frame and job
+    // allocations tend to.
+    for(u32 i = 0; i < BENCH_OPERATIONS_PER_THREAD; ++i){
+        u32 slot = i % BENCH_LIVE_BLOCKS;
+        if(blocks[slot]){
+            tfree(blocks[slot], sizes[slot], MEMORY_TAG_JOB);
+        }
+        sizes[slot] = p->min_size + (i * 2654435761u) % p->size_range;
+        blocks[slot] = tallocate(sizes[slot], MEMORY_TAG_JOB);
+    }
+    for(u32 i = 0; i < BENCH_LIVE_BLOCKS; ++i){
+        if(blocks[i]){
+            tfree(blocks[i], sizes[i], MEMORY_TAG_JOB);
+        }
+    }
+    return 1;
+}
+
+static u64 run_allocation_bench(u32 thread_count, u64 min_size, u64 size_range){
+    allocation_bench_params params = {min_size, size_range};
+    tthread threads[BENCH_MAX_THREADS];
+    for(u32 i = 0; i < thread_count; ++i){
+        tthread_create(allocation_bench_thread, &params, FALSE, &threads[i]);
+    }
+    for(u32 i = 0; i < thread_count; ++i){
+        tthread_wait(&threads[i]);
+    }
+    // Each operation is one allocation plus one free.
+    return (u64)thread_count * BENCH_OPERATIONS_PER_THREAD;
+}
+
+u64 tmemory_bench_small_1_thread(){
+    return run_allocation_bench(1, 8, 500);
+}
+
+u64 tmemory_bench_small_2_threads(){
+    return run_allocation_bench(2, 8, 500);
+}
+
+u64 tmemory_bench_small_4_threads(){
+    return run_allocation_bench(4, 8, 500);
+}
+
+u64 tmemory_bench_small_8_threads(){
+    return run_allocation_bench(8, 8, 500);
+}
+
+u64 tmemory_bench_large_1_thread(){
+    return run_allocation_bench(1, 1024, 3072);
+}
+
+u64 tmemory_bench_large_4_threads(){
+    return run_allocation_bench(4, 1024, 3072);
+}
+
+static u64 run_buffer_bench(b8 zero_memory){
+    for(u32 i = 0; i < BENCH_BUFFER_ROUNDS; ++i){
+        u8* buffer = zero_memory
+            ? tallocate_aligned(BENCH_BUFFER_SIZE, 64, MEMORY_TAG_TEXTURE)
+            : tallocate_uninitialized(BENCH_BUFFER_SIZE, 64, MEMORY_TAG_TEXTURE);
+        // Stands in for the copy or file read that fills the buffer.
+        tset_memory(buffer, (i32)i, BENCH_BUFFER_SIZE);
+        tfree(buffer, BENCH_BUFFER_SIZE, MEMORY_TAG_TEXTURE);
+    }
+    return BENCH_BUFFER_ROUNDS;
+}
+
+u64 tmemory_bench_zeroed_buffer(){
+    return run_buffer_bench(TRUE);
+}
+
+u64 tmemory_bench_uninitialized_buffer(){
+    return run_buffer_bench(FALSE);
+}
+
+static u64 run_aligned_allocation_bench(u16 alignment){
+    void* blocks[BENCH_LIVE_BLOCKS] = {0};
+    u64 sizes[BENCH_LIVE_BLOCKS] = {0};
+    for(u32 i = 0; i < BENCH_OPERATIONS_PER_THREAD; ++i){
+        u32 slot = i % BENCH_LIVE_BLOCKS;
+        if(blocks[slot]){
+            tfree(blocks[slot], sizes[slot], MEMORY_TAG_JOB);
+        }
+        sizes[slot] = 1024 + (i * 2654435761u) % 3072;
+        blocks[slot] = tallocate_aligned(sizes[slot], alignment, MEMORY_TAG_JOB);
+    }
+    for(u32 i = 0; i < BENCH_LIVE_BLOCKS; ++i){
+        if(blocks[i]){
+            tfree(blocks[i], sizes[i], MEMORY_TAG_JOB);
+        }
+    }
+    return BENCH_OPERATIONS_PER_THREAD;
+}
+
+u64 tmemory_bench_aligned_large_1_thread(){
+    return run_aligned_allocation_bench(256);
+}
+
+void tmemory_register_benches(){
+    // ns/op is wall time divided by operations across all threads, so it drops as throughput scales.
+    bench_manager_register_bench(tmemory_bench_small_1_thread, "tallocate/tfree 8-508 bytes, 1 thread");
+    bench_manager_register_bench(tmemory_bench_small_2_threads, "tallocate/tfree 8-508 bytes, 2 threads");
+    bench_manager_register_bench(tmemory_bench_small_4_threads, "tallocate/tfree 8-508 bytes, 4 threads");
+    bench_manager_register_bench(tmemory_bench_small_8_threads, "tallocate/tfree 8-508 bytes, 8 threads");
+    bench_manager_register_bench(tmemory_bench_large_1_thread, "tallocate/tfree 1-4 KiB (shared heap), 1 thread");
+    bench_manager_register_bench(tmemory_bench_large_4_threads, "tallocate/tfree 1-4 KiB (shared heap), 4 threads");
+    bench_manager_register_bench(tmemory_bench_aligned_large_1_thread, "tallocate_aligned/tfree 1-4 KiB aligned to 256, 1 thread");
+    bench_manager_register_bench(tmemory_bench_zeroed_buffer, "tallocate_aligned + fill + tfree of a 4 MiB buffer");
+    bench_manager_register_bench(tmemory_bench_uninitialized_buffer, "tallocate_uninitialized + fill + tfree of a 4 MiB buffer");
+}
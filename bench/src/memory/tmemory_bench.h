@@ -0,0 +1,3 @@
+#pragma once
+
+void tmemory_register_benches();
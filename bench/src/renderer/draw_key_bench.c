@@ -0,0 +1,74 @@
+#include "draw_key_bench.h"
+#include "../bench_manager.h"
+
+#include <defines.h>
+#include <core/tmemory.h>
+#include <renderer/draw_key.h>
+
+#define BENCH_MAX_DRAW_COUNT 200000
+
+// Keys as a scene would produce them: a few shaders, a few hundred materials, one draw in ten
+// translucent, and depths all over. Each run sorts a fresh copy of them.
+static draw_key_entry* source_entries = 0;
+static draw_key_entry* entries = 0;
+static draw_key_entry* scratch = 0;
+
+static void build_entries(){
+    if(source_entries){
+        return;
+    }
+    source_entries = tallocate(sizeof(draw_key_entry) * BENCH_MAX_DRAW_COUNT, MEMORY_TAG_ARRAY);
+    entries = tallocate(sizeof(draw_key_entry) * BENCH_MAX_DRAW_COUNT, MEMORY_TAG_ARRAY);
+    scratch = tallocate(sizeof(draw_key_entry) * BENCH_MAX_DRAW_COUNT, MEMORY_TAG_ARRAY);
+    u32 seed = 42;
+    for(u32 i = 0; i < BENCH_MAX_DRAW_COUNT; ++i){
+        seed = seed * 1103515245 + 12345;
+        u32 r = seed >> 8;
+        f32 depth = (f32)(r & 0xFFFF) / 65535.0f;
+        if(r % 10 == 0){
+            source_entries[i].key = draw_key_create_translucent(0, r % 8, (r >> 4) % 300, depth);
+        } else {
+            source_entries[i].key = draw_key_create_opaque(0, r % 8, (r >> 4) % 300, (r >> 12) % 500, depth);
+        }
+        source_entries[i].index = i;
+    }
+}
+
+static u64 sort_draws(u32 count){
+    build_entries();
+    tcopy_memory(entries, source_entries, sizeof(draw_key_entry) * count);
+    draw_keys_sort(entries, count, scratch);
+    return count;
+}
+
+u64 draw_key_bench_sort_10k(){
+    return sort_draws(10000);
+}
+
+u64 draw_key_bench_sort_50k(){
+    return sort_draws(50000);
+}
+
+u64 draw_key_bench_sort_200k(){
+    return sort_draws(200000);
+}
+
+u64 draw_key_bench_sort_200k_sorted(){
+    // The camera barely moving between frames leaves last frame's order nearly intact.
+    static b8 sorted = FALSE;
+    build_entries();
+    if(!sorted){
+        tcopy_memory(entries, source_entries, sizeof(draw_key_entry) * BENCH_MAX_DRAW_COUNT);
+        draw_keys_sort(entries, BENCH_MAX_DRAW_COUNT, scratch);
+        sorted = TRUE;
+    }
+    draw_keys_sort(entries, BENCH_MAX_DRAW_COUNT, scratch);
+    return BENCH_MAX_DRAW_COUNT;
+}
+
+void draw_key_register_benches(){
+    bench_manager_register_bench(draw_key_bench_sort_10k, "Draw key sort of 10k draws");
+    bench_manager_register_bench(draw_key_bench_sort_50k, "Draw key sort of 50k draws");
+    bench_manager_register_bench(draw_key_bench_sort_200k, "Draw key sort of 200k draws");
+    bench_manager_register_bench(draw_key_bench_sort_200k_sorted, "Draw key sort of 200k already sorted draws");
+}
@@ -0,0 +1,3 @@
+#pragma once
+
+void draw_key_register_benches();
@@ -0,0 +1,59 @@
+#include "loader_bench.h"
+#include "../bench_manager.h"
+
+#include <core/tmemory.h>
+#include <resources/resource_types.h>
+#include <systems/resource_system.h>
+
+#define BENCH_IMAGE_LOAD_COUNT 4
+#define BENCH_MESH_LOAD_COUNT 4
+
+static u64 resource_system_memory_requirement;
+static void* resource_system_state;
+
+b8 loader_bench_startup(){
+    // Same layout as the testbed, so run the bench from the bin folder.
+    resource_system_config config;
+    config.asset_base_path = "../assets";
+    config.max_loader_count = 32;
+    resource_system_initialize(&resource_system_memory_requirement, 0, config);
+    resource_system_state = tallocate(resource_system_memory_requirement, MEMORY_TAG_APPLICATION);
+    return resource_system_initialize(&resource_system_memory_requirement, resource_system_state, config);
+}
+
+void loader_bench_shutdown(){
+    resource_system_shutdown(resource_system_state);
+    tfree(resource_system_state, resource_system_memory_requirement, MEMORY_TAG_APPLICATION);
+    resource_system_state = 0;
+}
+
+u64 loader_bench_image(){
+    image_resource_params params;
+    params.flip_y = TRUE;
+    for(u32 i = 0; i < BENCH_IMAGE_LOAD_COUNT; ++i){
+        resource r;
+        if(!resource_system_load("cobblestone", RESOURCE_TYPE_IMAGE, &params, &r)){
+            return 0;
+        }
+        resource_system_unload(&r);
+    }
+    return BENCH_IMAGE_LOAD_COUNT;
+}
+
+u64 loader_bench_mesh(){
+    // Loads the binary .tsm. Importing the .obj would rewrite the .tsm next to it.
+    for(u32 i = 0; i < BENCH_MESH_LOAD_COUNT; ++i){
+        resource r;
+        if(!resource_system_load("falcon", RESOURCE_TYPE_MESH, 0, &r)){
+            return 0;
+        }
+        resource_system_unload(&r);
+    }
+    return BENCH_MESH_LOAD_COUNT;
+}
+
+void loader_register_benches(){
+    // Throughput is measured in decoded RGBA bytes.
+    bench_manager_register_throughput_bench(loader_bench_image, "Loader image, 512x512 cobblestone.png", 512 * 512 * 4);
+    bench_manager_register_bench(loader_bench_mesh, "Loader mesh, falcon.tsm");
+}
@@ -0,0 +1,11 @@
+#pragma once
+
+#include <defines.h>
+
+/** @brief Starts the resource system used by the loader benchmarks. Call before running benches. */
+b8 loader_bench_startup();
+
+/** @brief Stops the resource system started by loader_bench_startup. */
+void loader_bench_shutdown();
+
+void loader_register_benches();
@@ -0,0 +1,108 @@
+#include "job_system_bench.h"
+#include "../bench_manager.h"
+
+#include <core/logger.h>
+#include <core/tmemory.h>
+#include <core/tatomic.h>
+#include <platform/platform.h>
+#include <systems/job_system.h>
+
+#define BENCH_TINY_JOB_COUNT 100000
+#define BENCH_IDLE_JOB_COUNT 200
+#define BENCH_MAX_JOB_THREADS 15
+
+static void* job_system_state = 0;
+static u64 job_system_memory_requirement = 0;
+
+// Written by the jobs, read by the submitting thread.
+static volatile i32 jobs_completed;
+static volatile u64 latency_total_ns;
+static volatile u64 latency_max_ns;
+
+static b8 tiny_job(void* params, void* result_data){
+    f64 submit_time = *(f64*)params;
+    u64 latency_ns = (u64)((platform_get_absolute_time() - submit_time) * 1000000000.0);
+    tatomic_fetch_add_u64(&latency_total_ns, latency_ns, TATOMIC_RELAXED);
+    tatomic_max_u64(&latency_max_ns, latency_ns);
+    tatomic_fetch_add_i32(&jobs_completed, 1, TATOMIC_RELEASE);
+    return TRUE;
+}
+
+static void reset_counters(){
+    tatomic_store_i32(&jobs_completed, 0, TATOMIC_SEQ_CST);
+    tatomic_store_u64(&latency_total_ns, 0, TATOMIC_SEQ_CST);
+    tatomic_store_u64(&latency_max_ns, 0, TATOMIC_SEQ_CST);
+}
+
+static void submit_tiny_job(){
+    f64 submit_time = platform_get_absolute_time();
+    job_info job = job_create(tiny_job, 0, 0, &submit_time, sizeof(f64), 0);
+    job_system_submit(job);
+}
+
+// Yields rather than spins, so the waiting thread does not keep a job thread off the
+// core on machines with fewer cores than threads.
+static void wait_for_jobs(i32 count){
+    while(tatomic_load_i32(&jobs_completed, TATOMIC_ACQUIRE) < count){
+        platform_sleep(0);
+    }
+}
+
+b8 job_system_bench_startup(){
+    i32 thread_count = platform_get_processor_count() - 1;
+    if(thread_count < 1){
+        thread_count = 1;
+    }
+    if(thread_count > BENCH_MAX_JOB_THREADS){
+        thread_count = BENCH_MAX_JOB_THREADS;
+    }
+    u32 type_masks[BENCH_MAX_JOB_THREADS];
+    for(i32 i = 0; i < thread_count; ++i){
+        type_masks[i] = JOB_TYPE_GENERAL;
+    }
+
+    job_system_initialize(&job_system_memory_requirement, 0, 0, 0);
+    job_system_state = tallocate(job_system_memory_requirement, MEMORY_TAG_APPLICATION);
+    return job_system_initialize(&job_system_memory_requirement, job_system_state, thread_count, type_masks);
+}
+
+void job_system_bench_shutdown(){
+    job_system_shutdown(job_system_state);
+    tfree(job_system_state, job_system_memory_requirement, MEMORY_TAG_APPLICATION);
+    job_system_state = 0;
+}
+
+u64 job_system_bench_tiny_job_throughput(){
+    reset_counters();
+
+    for(i32 i = 0; i < BENCH_TINY_JOB_COUNT; ++i){
+        submit_tiny_job();
+    }
+    wait_for_jobs(BENCH_TINY_JOB_COUNT);
+
+    TINFO("  job system: submit-to-start latency under load avg %.2f us, max %.2f us.",
+        (latency_total_ns / (f64)BENCH_TINY_JOB_COUNT) / 1000.0, latency_max_ns / 1000.0);
+    return BENCH_TINY_JOB_COUNT;
+}
+
+u64 job_system_bench_idle_wakeup_latency(){
+    reset_counters();
+
+    // Give the job threads time to go to sleep before each job, so this measures
+    // how long it takes to wake one up. The time per op reported for this bench is
+    // mostly that sleep; the wakeup latency itself is what gets logged.
+    for(i32 i = 0; i < BENCH_IDLE_JOB_COUNT; ++i){
+        platform_sleep(1);
+        submit_tiny_job();
+        wait_for_jobs(i + 1);
+    }
+
+    TINFO("  job system: submit-to-start latency from idle avg %.2f us, max %.2f us.",
+        (latency_total_ns / (f64)BENCH_IDLE_JOB_COUNT) / 1000.0, latency_max_ns / 1000.0);
+    return BENCH_IDLE_JOB_COUNT;
+}
+
+void job_system_register_benches(){
+    bench_manager_register_bench(job_system_bench_tiny_job_throughput, "Job system throughput of 100k tiny jobs");
+    bench_manager_register_bench(job_system_bench_idle_wakeup_latency, "Job system wakeup of idle threads");
+}
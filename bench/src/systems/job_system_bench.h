@@ -0,0 +1,11 @@
+#pragma once
+
+#include <defines.h>
+
+/** @brief Starts the job system used by the job benchmarks. Call before running benches. */
+b8 job_system_bench_startup();
+
+/** @brief Stops the job system started by job_system_bench_startup. */
+void job_system_bench_shutdown();
+
+void job_system_register_benches();
@@ -0,0 +1,72 @@
+#include "transform_system_bench.h"
+#include "../bench_manager.h"
+
+#include <core/tmemory.h>
+#include <math/tmath.h>
+#include <systems/transform_system.h>
+
+// 20000 roots, each the top of a chain of five, so every level of the hierarchy is big
+// enough to be split across the job threads.
+#define BENCH_TRANSFORM_COUNT 100000
+#define BENCH_CHAIN_LENGTH 5
+#define BENCH_ROOT_COUNT (BENCH_TRANSFORM_COUNT / BENCH_CHAIN_LENGTH)
+
+static void* state = 0;
+static u64 memory_requirement = 0;
+static u32* handles = 0;
+
+static void build_transforms(){
+    if(state){
+        return;
+    }
+    transform_system_config config;
+    config.max_transform_count = BENCH_TRANSFORM_COUNT;
+    transform_system_initialize(&memory_requirement, 0, config);
+    state = tallocate(memory_requirement, MEMORY_TAG_APPLICATION);
+    transform_system_initialize(&memory_requirement, state, config);
+
+    handles = tallocate(sizeof(u32) * BENCH_TRANSFORM_COUNT, MEMORY_TAG_ARRAY);
+    quat rotation = quat_from_axis_angle((vec3){0, 1, 0}, 0.1f, TRUE);
+    for(u32 i = 0; i < BENCH_TRANSFORM_COUNT; ++i){
+        handles[i] = transform_system_create((vec3){(f32)(i % 100), 1.0f, (f32)(i / 100)}, rotation, vec3_one());
+        if(i % BENCH_CHAIN_LENGTH){
+            transform_system_set_parent(handles[i], handles[i - 1]);
+        }
+    }
+    transform_system_update();
+}
+
+u64 transform_system_bench_update_all_dirty(){
+    build_transforms();
+    // Moving every root moves everything.
+    for(u32 i = 0; i < BENCH_TRANSFORM_COUNT; i += BENCH_CHAIN_LENGTH){
+        transform_system_translate(handles[i], (vec3){0.0f, 0.001f, 0.0f});
+    }
+    transform_system_update();
+    return BENCH_TRANSFORM_COUNT;
+}
+
+u64 transform_system_bench_update_tenth_dirty(){
+    build_transforms();
+    // One chain in ten moves, so most of the pass is skipping clean transforms.
+    for(u32 i = 0; i < BENCH_TRANSFORM_COUNT; i += BENCH_CHAIN_LENGTH * 10){
+        transform_system_translate(handles[i], (vec3){0.0f, 0.001f, 0.0f});
+    }
+    transform_system_update();
+    return BENCH_TRANSFORM_COUNT;
+}
+
+u64 transform_system_bench_reparent(){
+    build_transforms();
+    // Swapping two chains' roots around forces the order to be rebuilt.
+    transform_system_set_parent(handles[1], INVALID_ID);
+    transform_system_set_parent(handles[1], handles[0]);
+    transform_system_update();
+    return BENCH_TRANSFORM_COUNT;
+}
+
+void transform_system_register_benches(){
+    bench_manager_register_bench(transform_system_bench_update_all_dirty, "Transform system update of 100k, all dirty");
+    bench_manager_register_bench(transform_system_bench_update_tenth_dirty, "Transform system update of 100k, a tenth dirty");
+    bench_manager_register_bench(transform_system_bench_reparent, "Transform system reparent and rebuild of 100k");
+}
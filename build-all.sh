@@ -32,6 +32,13 @@ then
 echo "Error:"$ERRORLEVEL && exit
 fi
 
+make -f Makefile.bench.linux.mak all
+ERRORLEVEL=$?
+if [ $ERRORLEVEL -ne 0 ]
+then
+echo "Error:"$ERRORLEVEL && exit
+fi
+
 make -f Makefile.tools.linux.mak all
 ERRORLEVEL=$?
 if [ $ERRORLEVEL -ne 0 ]
@@ -69,7 +69,7 @@ void* _darray_pop_at(void* array, u64 index, void* dest){
     u64 length = darray_length(array);
     u64 stride = darray_stride(array);
     if(index >= length){
-        TERROR("Index outside the bounds of this array! Length: %i, index: %index", length, index);
+        TERROR("Index outside the bounds of this array! Length: %llu, index: %llu", length, index);
         return array;
     }
 
@@ -92,7 +92,7 @@ void* _darray_insert_at(void* array, u64 index, void* value_ptr){
     u64 length = darray_length(array);
     u64 stride = darray_stride(array);
     if(index >= length) {
-        TERROR("Index outside the bounds of this array! Length: %i, index: %index", length, index);
+        TERROR("Index outside the bounds of this array! Length: %llu, index: %llu", length, index);
         return array;
     }
 
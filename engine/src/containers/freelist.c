@@ -2,35 +2,364 @@
 
 #include "core/tmemory.h"
 #include "core/logger.h"
+#include "platform/platform.h"
+
+// Free ranges are kept in segregated lists, TLSF-style: a first level per power of two,
+// each split into FREELIST_SL_COUNT linear second-level ranges. Bitmaps track which lists
+// are non-empty, so finding a range that fits takes a couple of bit scans instead of a walk.
+#define FREELIST_SL_LOG2 4
+#define FREELIST_SL_COUNT (1 << FREELIST_SL_LOG2)
+// Sizes below this all live in first level 0, one second-level list per exact size.
+#define FREELIST_SMALL_SIZE FREELIST_SL_COUNT
+#define FREELIST_FL_COUNT (64 - FREELIST_SL_LOG2 + 1)
+
+// Nodes are budgeted at one per this many bytes tracked. A list fragmented past that
+// grows its pool, so this only sizes the part that lives in the caller's block.
+#define FREELIST_BYTES_PER_NODE 1024
+#define FREELIST_MIN_NODES 20
+
+#define FREELIST_NO_NODE INVALID_ID
 
 typedef struct freelist_node
 {
     u64 offset;
     u64 size;
-    struct freelist_node* next;
+    // Links within the node's size-class list, or to the next unused node in the pool.
+    u32 next;
+    u32 previous;
 } freelist_node;
 
 typedef struct internal_state{
     u64 total_size;
     u64 max_entries;
-    freelist_node* head;
-    freelist_node*nodes;
+    u64 free_space;
+    u64 free_block_count;
+
+    freelist_node* nodes;
+    // The first unused node in the pool.
+    u32 unused_head;
+
+    // Lookups from a free range's start and end offsets to its node, used to find the
+    // neighbours to merge with when freeing. Entries hold node index + 1, so 0 is empty.
+    u32* start_map;
+    u32* end_map;
+    u32 map_mask;
+
+    // The nodes and maps once the pool has outgrown the caller's block, or 0. This comes
+    // from the platform, since the list may be the one backing tallocate.
+    void* grown_block;
+    u64 grown_block_size;
+
+    u64 first_level_bitmap;
+    u32 second_level_bitmaps[FREELIST_FL_COUNT];
+    u32 heads[FREELIST_FL_COUNT][FREELIST_SL_COUNT];
 } internal_state;
 
-freelist_node* get_node(freelist* list);
-void return_node(freelist* list, freelist_node* node);
-
-void freelist_create(u64 total_size, u64* memory_requirement, void* memory, freelist* out_list){
-    // Enough space to hold state, plus array for all nodes.
-    u64 max_entries = (total_size / (sizeof(void*) * sizeof(freelist_node))); // NOTE: This might have a remainder, but that's ok.
-
+static u64 max_entries_for(u64 total_size){
+    u64 max_entries = total_size / FREELIST_BYTES_PER_NODE;
     // Catch an edge case of having a really small amount of memory to manage, and only having a
     // super small number of entries. Always make sure we have at least a decent amount, like 20 or so.
-    if(max_entries < 20){
-        max_entries = 20;
+    if(max_entries < FREELIST_MIN_NODES){
+        max_entries = FREELIST_MIN_NODES;
+    }
+    return max_entries;
+}
+
+static u64 map_capacity_for(u64 max_entries){
+    // Keep the maps at most half full so probe sequences stay short.
+    u64 capacity = 1;
+    while(capacity < max_entries * 2){
+        capacity <<= 1;
+    }
+    return capacity;
+}
+
+static u64 memory_requirement_for(u64 total_size){
+    u64 max_entries = max_entries_for(total_size);
+    return sizeof(internal_state) + (sizeof(freelist_node) * max_entries) + (sizeof(u32) * map_capacity_for(max_entries) * 2);
+}
+
+static u32 most_significant_bit(u64 value){
+    return 63 - __builtin_clzll(value);
+}
+
+/** Gets the size-class list a free range of the given size belongs in. */
+static void mapping_insert(u64 size, u32* out_fl, u32* out_sl){
+    if(size < FREELIST_SMALL_SIZE){
+        *out_fl = 0;
+        *out_sl = (u32)size;
+    }else{
+        u32 bit = most_significant_bit(size);
+        *out_sl = (u32)(size >> (bit - FREELIST_SL_LOG2)) ^ FREELIST_SL_COUNT;
+        *out_fl = bit - FREELIST_SL_LOG2 + 1;
+    }
+}
+
+/**
+ * Gets the first size-class list whose ranges are all large enough for the given size.
+ * Rounding up means any range found there fits without walking the list.
+ */
+static b8 mapping_search(u64 size, u32* out_fl, u32* out_sl){
+    if(size >= FREELIST_SMALL_SIZE){
+        u64 rounded = size + (1ull << (most_significant_bit(size) - FREELIST_SL_LOG2)) - 1;
+        if(rounded < size){
+            return FALSE;
+        }
+        size = rounded;
+    }
+    mapping_insert(size, out_fl, out_sl);
+    return TRUE;
+}
+
+static u32 map_slot(u64 key, u32 mask){
+    return (u32)((key * 0x9E3779B97F4A7C15ull) >> 32) & mask;
+}
+
+static u64 map_key(internal_state* state, u32* map, u32 node){
+    freelist_node* n = &state->nodes[node];
+    return map == state->start_map ? n->offset : n->offset + n->size;
+}
+
+static void map_insert(internal_state* state, u32* map, u32 node){
+    u32 slot = map_slot(map_key(state, map, node), state->map_mask);
+    while(map[slot]){
+        slot = (slot + 1) & state->map_mask;
+    }
+    map[slot] = node + 1;
+}
+
+static u32 map_find(internal_state* state, u32* map, u64 key){
+    u32 slot = map_slot(key, state->map_mask);
+    while(map[slot]){
+        if(map_key(state, map, map[slot] - 1) == key){
+            return map[slot] - 1;
+        }
+        slot = (slot + 1) & state->map_mask;
+    }
+    return FREELIST_NO_NODE;
+}
+
+static void map_remove(internal_state* state, u32* map, u32 node){
+    u32 mask = state->map_mask;
+    u32 hole = map_slot(map_key(state, map, node), mask);
+    while(map[hole] != node + 1){
+        hole = (hole + 1) & mask;
+    }
+
+    // Shift later entries of the probe sequence back into the hole, so lookups never
+    // stop early at an empty slot and no tombstones are needed.
+    u32 slot = hole;
+    while(TRUE){
+        slot = (slot + 1) & mask;
+        if(!map[slot]){
+            break;
+        }
+        u32 home = map_slot(map_key(state, map, map[slot] - 1), mask);
+        if(((slot - home) & mask) >= ((slot - hole) & mask)){
+            map[hole] = map[slot];
+            hole = slot;
+        }
+    }
+    map[hole] = 0;
+}
+
+static u32 get_node(internal_state* state){
+    u32 node = state->unused_head;
+    if(node != FREELIST_NO_NODE){
+        state->unused_head = state->nodes[node].next;
+    }
+    return node;
+}
+
+static void return_node(internal_state* state, u32 node){
+    state->nodes[node].offset = INVALID_ID_U64;
+    state->nodes[node].size = 0;
+    state->nodes[node].next = state->unused_head;
+    state->unused_head = node;
+}
+
+static void insert_free_range(internal_state* state, u32 node){
+    freelist_node* n = &state->nodes[node];
+    u32 fl, sl;
+    mapping_insert(n->size, &fl, &sl);
+
+    n->previous = FREELIST_NO_NODE;
+    n->next = state->heads[fl][sl];
+    if(n->next != FREELIST_NO_NODE){
+        state->nodes[n->next].previous = node;
+    }
+    state->heads[fl][sl] = node;
+    state->first_level_bitmap |= 1ull << fl;
+    state->second_level_bitmaps[fl] |= 1u << sl;
+
+    map_insert(state, state->start_map, node);
+    map_insert(state, state->end_map, node);
+    state->free_space += n->size;
+    state->free_block_count++;
+}
+
+static void remove_free_range(internal_state* state, u32 node){
+    freelist_node* n = &state->nodes[node];
+    u32 fl, sl;
+    mapping_insert(n->size, &fl, &sl);
+
+    if(n->previous != FREELIST_NO_NODE){
+        state->nodes[n->previous].next = n->next;
+    }else{
+        state->heads[fl][sl] = n->next;
+        if(n->next == FREELIST_NO_NODE){
+            state->second_level_bitmaps[fl] &= ~(1u << sl);
+            if(!state->second_level_bitmaps[fl]){
+                state->first_level_bitmap &= ~(1ull << fl);
+            }
+        }
+    }
+    if(n->next != FREELIST_NO_NODE){
+        state->nodes[n->next].previous = n->previous;
+    }
+
+    map_remove(state, state->start_map, node);
+    map_remove(state, state->end_map, node);
+    state->free_space -= n->size;
+    state->free_block_count--;
+}
+
+/**
+ * Doubles the node pool, moving the nodes and maps to a block of their own. Node
+ * indices stay the same, so only the maps need rebuilding.
+ */
+static b8 grow_nodes(internal_state* state){
+    u64 max_entries = state->max_entries * 2;
+    u64 map_capacity = map_capacity_for(max_entries);
+    u64 size = (sizeof(freelist_node) * max_entries) + (sizeof(u32) * map_capacity * 2);
+    void* block = platform_allocate(size, FALSE);
+    if(!block){
+        return FALSE;
+    }
+    platform_zero_memory(block, size);
+
+    freelist_node* nodes = block;
+    platform_copy_memory(nodes, state->nodes, sizeof(freelist_node) * state->max_entries);
+    if(state->grown_block){
+        platform_free(state->grown_block, FALSE);
+    }
+    u64 old_max_entries = state->max_entries;
+    state->grown_block = block;
+    state->grown_block_size = size;
+    state->max_entries = max_entries;
+    state->nodes = nodes;
+    state->start_map = (void*)(nodes + max_entries);
+    state->end_map = state->start_map + map_capacity;
+    state->map_mask = (u32)(map_capacity - 1);
+
+    for(u32 fl = 0; fl < FREELIST_FL_COUNT; ++fl){
+        for(u32 sl = 0; sl < FREELIST_SL_COUNT; ++sl){
+            for(u32 node = state->heads[fl][sl]; node != FREELIST_NO_NODE; node = state->nodes[node].next){
+                map_insert(state, state->start_map, node);
+                map_insert(state, state->end_map, node);
+            }
+        }
+    }
+
+    // The pool was empty, so the new nodes are all that is unused.
+    for(u64 i = max_entries; i > old_max_entries; --i){
+        return_node(state, (u32)(i - 1));
+    }
+    return TRUE;
+}
+
+static void release_grown_nodes(internal_state* state){
+    if(state->grown_block){
+        platform_free(state->grown_block, FALSE);
+        state->grown_block = 0;
+        state->grown_block_size = 0;
+    }
+}
+
+/** Sets up the state over the given block with nothing free. */
+static void initialize_state(void* memory, u64 total_size){
+    u64 max_entries = max_entries_for(total_size);
+    u64 map_capacity = map_capacity_for(max_entries);
+
+    tzero_memory(memory, memory_requirement_for(total_size));
+    internal_state* state = memory;
+    state->total_size = total_size;
+    state->max_entries = max_entries;
+    state->nodes = (void*)(memory + sizeof(internal_state));
+    state->start_map = (void*)(state->nodes + max_entries);
+    state->end_map = state->start_map + map_capacity;
+    state->map_mask = (u32)(map_capacity - 1);
+
+    for(u32 fl = 0; fl < FREELIST_FL_COUNT; ++fl){
+        for(u32 sl = 0; sl < FREELIST_SL_COUNT; ++sl){
+            state->heads[fl][sl] = FREELIST_NO_NODE;
+        }
+    }
+
+    // Chain every node into the unused pool.
+    state->unused_head = FREELIST_NO_NODE;
+    for(u64 i = max_entries; i > 0; --i){
+        return_node(state, (u32)(i - 1));
+    }
+}
+
+/** Marks a range as free, merging it with free neighbours on either side. */
+static b8 release_range(internal_state* state, u64 size, u64 offset){
+    u32 previous = map_find(state, state->end_map, offset);
+    u32 next = map_find(state, state->start_map, offset + size);
+
+    u32 node;
+    if(previous != FREELIST_NO_NODE){
+        // Grow the previous range to cover this one.
+        node = previous;
+        remove_free_range(state, node);
+        state->nodes[node].size += size;
+    }else{
+        node = get_node(state);
+        if(node == FREELIST_NO_NODE){
+            if(!grow_nodes(state)){
+                TFATAL("Freelist is out of nodes (%llu free ranges) and could not grow; the range at offset %llu is lost.", state->free_block_count, offset);
+                return FALSE;
+            }
+            node = get_node(state);
+        }
+        state->nodes[node].offset = offset;
+        state->nodes[node].size = size;
     }
 
-    *memory_requirement = sizeof(internal_state) + (sizeof(freelist_node) * max_entries);
+    if(next != FREELIST_NO_NODE){
+        // Absorb the following range.
+        state->nodes[node].size += state->nodes[next].size;
+        remove_free_range(state, next);
+        return_node(state, next);
+    }
+
+    insert_free_range(state, node);
+    return TRUE;
+}
+
+/** Allocates size bytes from the front of a free range, returning their offset. */
+static u64 take_from_range(internal_state* state, u32 node, u64 size){
+    freelist_node* n = &state->nodes[node];
+    u64 offset = n->offset;
+
+    remove_free_range(state, node);
+    if(n->size == size){
+        // Exact match. Just return the node.
+        return_node(state, node);
+    }else{
+        // Node is larger. Deduct the memory from it and move the offset
+        // by that amount.
+        n->offset += size;
+        n->size -= size;
+        insert_free_range(state, node);
+    }
+    return offset;
+}
+
+void freelist_create(u64 total_size, u64* memory_requirement, void* memory, freelist* out_list){
+    // Enough space to hold state, plus the node pool and the lookup maps.
+    *memory_requirement = memory_requirement_for(total_size);
     if(!memory){
         return;
     }
@@ -38,79 +367,63 @@ void freelist_create(u64 total_size, u64* memory_requirement, void* memory, free
     // If the memory required is too small, should warn about it being wasteful to use.
     u64 mem_min = (sizeof(internal_state) + sizeof(freelist_node)) * 8;
     if(total_size < mem_min){
-        TWARN("Freelists are very inefficient with amounts of memory less than %iB; it is recommended to not use this structure in this case.", mem_min);
+        TWARN("Freelists are very inefficient with amounts of memory less than %lluB; it is recommended to not use this structure in this case.", mem_min);
     }
 
     out_list->memory = memory;
+    initialize_state(memory, total_size);
 
-    // The block's layout is head* first, then array of available nodes.
-    tzero_memory(out_list->memory, *memory_requirement);
-    internal_state* state = out_list->memory;
-    state->nodes = (void*)(out_list->memory + sizeof(internal_state));
-    state->max_entries = max_entries;
-    state->total_size = total_size;
-
-    state->head = &state->nodes[0];
-    state->head->offset = 0;
-    state->head->size = total_size;
-    state->head->next = 0;
-
-    // Invalidate the offset and size for all but the first node. The invalid
-    // value will be checked for when seeking a new node from the list.
-    for(u64 i = 1; i < state->max_entries; ++i){
-        state->nodes[i].offset = INVALID_ID;
-        state->nodes[i].size = INVALID_ID;
-    }
+    // Everything starts out free.
+    release_range(out_list->memory, total_size, 0);
 }
 
 void freelist_destroy(freelist* list){
     if(list && list->memory){
         // Just zero out the memory before giving it back.
         internal_state* state = list->memory;
-        tzero_memory(list->memory, sizeof(internal_state) + sizeof(freelist_node) * state->max_entries);
+        release_grown_nodes(state);
+        tzero_memory(list->memory, memory_requirement_for(state->total_size));
         list->memory = 0;
     }
 }
 
 b8 freelist_allocate_block(freelist* list, u64 size, u64* out_offset){
-    if(!list || !out_offset || !list->memory){
+    if(!list || !out_offset || !list->memory || !size){
         return FALSE;
     }
 
     internal_state* state = list->memory;
-    freelist_node* node = state->head;
-    freelist_node* previous = 0;
-    while(node){
-        if(node->size == size){
-            // Exact match. Just return the node.
-            *out_offset = node->offset;
-            freelist_node* node_to_return = 0;
-            if(previous){
-                previous->next = node->next;
-                node_to_return = node;
-            } else {
-                // This node is the head of the list. Reassing the head
-                // and return the previous head node.
-                node_to_return = state->head;
-                state->head = node->next;
+    u32 fl, sl;
+    if(mapping_search(size, &fl, &sl) && fl < FREELIST_FL_COUNT){
+        // Look for a non-empty list in this first level at or above sl, then in any larger first level.
+        u32 sl_map = state->second_level_bitmaps[fl] & (~0u << sl);
+        if(!sl_map){
+            u64 fl_map = fl + 1 < 64 ? state->first_level_bitmap & (~0ull << (fl + 1)) : 0;
+            if(fl_map){
+                fl = __builtin_ctzll(fl_map);
+                sl_map = state->second_level_bitmaps[fl];
             }
-            return_node(list, node_to_return);
-            return TRUE;
-        }else if (node->size > size){
-            // Node is larger. Deduct the memory from it and move the offset
-            // by that amount.
-            *out_offset = node->offset;
-            node->size -= size;
-            node->offset += size;
+        }
+
+        if(sl_map){
+            sl = __builtin_ctz(sl_map);
+            *out_offset = take_from_range(state, state->heads[fl][sl], size);
             return TRUE;
         }
+    }
 
-        previous = node;
-        node = node->next;
+    // Rounding up skips the list the size itself maps to, whose ranges may or may not fit.
+    // Check it before giving up, so an exactly sized range is never missed.
+    mapping_insert(size, &fl, &sl);
+    for(u32 node = state->heads[fl][sl]; node != FREELIST_NO_NODE; node = state->nodes[node].next){
+        freelist_node* n = &state->nodes[node];
+        if(n->size >= size){
+            *out_offset = take_from_range(state, node, size);
+            return TRUE;
+        }
     }
 
-    u64 free_space = freelist_free_space(list);
-    TWARN("freelist_find_block, no block with enough free space found (requested: %uB, available: %lluB)", size, free_space);
+    TWARN("freelist_find_block, no block with enough free space found (requested: %lluB, available: %lluB, largest free block: %lluB)", size, state->free_space, freelist_largest_free_block(list));
     return FALSE;
 }
 
@@ -118,77 +431,14 @@ b8 freelist_free_block(freelist* list, u64 size, u64 offset){
     if(!list || !list->memory || !size){
         return FALSE;
     }
-    
-    internal_state* state = list->memory;
-    freelist_node* node = state->head;
-    freelist_node* previous = 0;
-    if(!node){
-        // Check for the case where the entire thing is allocated.
-        // In this case a new node is needed at the head.
-        freelist_node* new_node = get_node(list);
-        new_node->offset = offset;
-        new_node->size = size;
-        new_node->next = 0;
-        state->head = new_node;
-        
-        return TRUE;
-    }else{
-        while(node){
-            if(node->offset == offset){
-                // Can just be appended to this node.
-                node->size += size;
-
-                // Check if this then connects the range between this and the next
-                // node, and if so, combine them and return the second node.
-                if(node->next && node->next->offset == node->offset + node->size){
-                    node->size += node->next->size;
-                    freelist_node* next = node->next;
-                    node->next = node->next->next;
-                    return_node(list, next);
-                }
-                return TRUE;
-            }else if(node->offset > offset){
-                // Iterated beyond the space to be freed. Need a new node.
-                freelist_node* new_node = get_node(list);
-                new_node->offset = offset;
-                new_node->size = size;
-
-                // If there is a previous node, the new node should be inserted between this and it.
-                if(previous){
-                    previous->next = new_node;
-                    new_node->next = node;
-                } else {
-                    // Otherwise, the new node becomes the head.
-                    new_node->next = node;
-                    state->head = new_node;
-                }
-
-                // Double-check next node to see if it can be joined.
-                if(new_node->next && new_node->offset + new_node->size == new_node->next->offset){
-                    new_node->size += new_node->next->size;
-                    freelist_node* rubbish = new_node->next;
-                    new_node->next = rubbish->next;
-                    return_node(list, rubbish);
-                }
-
-                // Double-check previous node to see if the new_node can be joined to it.
-                if(previous && previous->offset + previous->size == new_node->offset){
-                    previous->size += new_node->size;
-                    freelist_node* rubbish = new_node;
-                    previous->next = rubbish->next;
-                    return_node(list, rubbish);
-                }
-
-                return TRUE;
-            }
 
-            previous = node;
-            node = node->next;
-        }
+    internal_state* state = list->memory;
+    if(offset + size > state->total_size || offset + size < offset){
+        TWARN("Unable to find block to be freed. Corruption possible?");
+        return FALSE;
     }
 
-    TWARN("Unable to find block to be freed. Corruption possible?");
-    return FALSE;
+    return release_range(state, size, offset);
 }
 
 b8 freelist_resize(freelist* list, u64* memory_requirement, void* new_memory, u64 new_size, void** out_old_memory){
@@ -196,87 +446,38 @@ b8 freelist_resize(freelist* list, u64* memory_requirement, void* new_memory, u6
         return FALSE;
     }
 
-    // Enough space to hold state, plus array for all nodes.
-    u64 max_entries = (new_size / sizeof(void*)); // NOTE: This might have a remainder, but that's ok. // TODO: Maybe is necessary to calculate it the same way as the create
-    *memory_requirement = sizeof(internal_state) + (sizeof(freelist_node) * max_entries);
+    // Enough space to hold state, plus the node pool and the lookup maps.
+    *memory_requirement = memory_requirement_for(new_size);
     if(!new_memory){
         return TRUE;
     }
 
     // Assign the old memory pointer so it can be freed.
     *out_old_memory = list->memory;
-
-    // Copy over the old state to the new.
     internal_state* old_state = (internal_state*)list->memory;
-    u64 size_diff = new_size - old_state->total_size;
 
     // Setup the new memory
     list->memory = new_memory;
+    initialize_state(new_memory, new_size);
+    internal_state* state = list->memory;
 
-    // The block's layout is head* first, then array of available nodes.
-    tzero_memory(list->memory, *memory_requirement);
-
-    // Setup the new state.
-    internal_state* state = (internal_state*)list->memory;
-    state->nodes = (void*)(list->memory + sizeof(internal_state));
-    state->max_entries = max_entries;
-    state->total_size = new_size;
-
-    // Invalidate the offset and size for all but the first node. The invalid
-    // value will be checked for when seeking a new node from the list.
-    for(u64 i = 1; i < state->max_entries; ++i){
-        state->nodes[i].offset = INVALID_ID;
-        state->nodes[i].size = INVALID_ID;
-    }
-
-    state->head = &state->nodes[0];
-
-    // Copy over the nodes.
-    freelist_node* new_list_node = state->head;
-    freelist_node* old_node = old_state->head;
-    if(!old_node){
-        // If there is no head, then the entire list is allocated. In this case,
-        // the head should be set to the difference of the space now available, and
-        // at the end of the list.
-        state->head->offset = old_state->total_size;
-        state->head->size = size_diff;
-        state->head->next = 0;
-    } else {
-        // Iterate the old nodes.
-        while (old_node)
-        {
-            // Get a new node, copy the offset/size, and set next to it.
-            freelist_node* new_node = get_node(list);
-            new_node->offset = old_node->offset;
-            new_node->size = old_node->size;
-            new_node->next = 0;
-            new_list_node->next = new_node;
-            // Move to the next entry.
-            new_list_node = new_list_node->next;
-
-            if(old_node->next){
-                // If there is another node, move on.
-                old_node = old_node->next;
-            } else {
-                // Reached the end of the list.
-                // Check if it extends to the end of the block. If so,
-                // just append to the size. Otherwise, create a new node and
-                // attach to it.
-                if(old_node->offset + old_node->size == old_state->total_size){
-                    new_node->size += size_diff;
-                } else {
-                    freelist_node* new_node_end = get_node(list);
-                    new_node_end->offset = old_state->total_size;
-                    new_node_end->size = size_diff;
-                    new_node_end->next = 0;
-                    new_node->next = new_node_end;
-                }
-
-                break;
+    // Copy over the free ranges.
+    for(u32 fl = 0; fl < FREELIST_FL_COUNT; ++fl){
+        for(u32 sl = 0; sl < FREELIST_SL_COUNT; ++sl){
+            for(u32 node = old_state->heads[fl][sl]; node != FREELIST_NO_NODE; node = old_state->nodes[node].next){
+                release_range(state, old_state->nodes[node].size, old_state->nodes[node].offset);
             }
         }
     }
 
+    // The added space is free, and joins the last range if that reaches the old end.
+    if(new_size > old_state->total_size){
+        release_range(state, new_size - old_state->total_size, old_state->total_size);
+    }
+
+    // The caller frees the old block, but a grown pool belongs to the list.
+    release_grown_nodes(old_state);
+
     return TRUE;
 }
 
@@ -285,18 +486,12 @@ void freelist_clear(freelist* list){
         return;
     }
 
+    // Reset to a single range occupying the entire thing.
     internal_state* state = list->memory;
-    // Invalidate the offset and size for all but the first node. The invalid
-    // value will be checked for when seeking a new node from the list.
-    for(u64 i = 1; i < state->max_entries; ++i){
-        state->nodes[i].offset = INVALID_ID;
-        state->nodes[i].size = INVALID_ID;
-    }
-
-    // Reset the head to occupy the entire thing.
-    state->head->offset = 0;
-    state->head->size = state->total_size;
-    state->head->next = 0;
+    u64 total_size = state->total_size;
+    release_grown_nodes(state);
+    initialize_state(list->memory, total_size);
+    release_range(list->memory, total_size, 0);
 }
 
 u64 freelist_free_space(freelist* list){
@@ -304,31 +499,37 @@ u64 freelist_free_space(freelist* list){
         return 0;
     }
 
-    u64 running_total = 0;
     internal_state* state = list->memory;
-    freelist_node* node = state->head;
-    while(node){
-        running_total += node->size;
-        node = node->next;
+    return state->free_space;
+}
+
+u64 freelist_free_block_count(freelist* list){
+    if(!list || !list->memory){
+        return 0;
     }
 
-    return running_total;
+    internal_state* state = list->memory;
+    return state->free_block_count;
 }
 
-freelist_node* get_node(freelist* list){
+u64 freelist_largest_free_block(freelist* list){
+    if(!list || !list->memory){
+        return 0;
+    }
+
     internal_state* state = list->memory;
-    for(u64 i = 1; i < state->max_entries; ++i){
-        if(state->nodes[i].offset == INVALID_ID){
-            return &state->nodes[i];
-        }
+    if(!state->first_level_bitmap){
+        return 0;
     }
 
-    // Return nothing if no nodes are available.
-    return 0;
+    // The largest range is in the highest non-empty list, though not necessarily at its head.
+    u32 fl = most_significant_bit(state->first_level_bitmap);
+    u32 sl = 31 - __builtin_clz(state->second_level_bitmaps[fl]);
+    u64 largest = 0;
+    for(u32 node = state->heads[fl][sl]; node != FREELIST_NO_NODE; node = state->nodes[node].next){
+        if(state->nodes[node].size > largest){
+            largest = state->nodes[node].size;
+        }
+    }
+    return largest;
 }
-
-void return_node(freelist* list, freelist_node* node){
-    node->offset = INVALID_ID;
-    node->size = INVALID_ID;
-    node->next = 0;
-}
\ No newline at end of file
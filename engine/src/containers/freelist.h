@@ -14,7 +14,9 @@
 
  /**
   * @brief A data structure to be used alongside an allocator for dynamic memory
-  * allocation. Tracks free ranges of memory.
+  * allocation. Tracks free ranges of memory in segregated size-class lists, so
+  * allocating and freeing take constant time regardless of fragmentation.
+  * Adjacent free ranges are merged as soon as they are freed.
   */
  typedef struct freelist {
     /** @brief The internal state of the freelist. */
@@ -24,7 +26,9 @@
  /**
   * @brief Creates a new freelist or obtains the memory requirement for one. Call
   * twice; once passing 0 to memory to obtain memory requirement, and a second
-  * time passing an allocated block to memory.
+  * time passing an allocated block to memory. The block holds one separate free
+  * range per KiB of total_size (at least 20); a list fragmented past that grows
+  * into memory of its own, released by freelist_destroy.
   * 
   * @param total_size The total size in bytes that the free list should track.
   * @param memory_requirement A pointer to hold memory requirement for the free list itself.
@@ -86,11 +90,27 @@
  TAPI void freelist_clear(freelist* list);
 
  /**
-  * @brief Returns the amount of free space in this list. NOTE: Since this has
-  * to iterate the entire internal list, this can be expensive operation.
-  * Use sparingly.
+  * @brief Returns the amount of free space in this list.
   * 
   * @param list A pointer to the list to obtain from.
   * @return The amount of the free space in bytes.
   */
- TAPI u64 freelist_free_space(freelist* list);
\ No newline at end of file
+ TAPI u64 freelist_free_space(freelist* list);
+
+ /**
+  * @brief Returns the number of separate free ranges in this list. Together with
+  * freelist_largest_free_block, this gives a measure of fragmentation.
+  * 
+  * @param list A pointer to the list to obtain from.
+  * @return The number of free ranges.
+  */
+ TAPI u64 freelist_free_block_count(freelist* list);
+
+ /**
+  * @brief Returns the size of the largest free range in this list, which is the
+  * largest block that can currently be allocated.
+  * 
+  * @param list A pointer to the list to obtain from.
+  * @return The size of the largest free range in bytes.
+  */
+ TAPI u64 freelist_largest_free_block(freelist* list);
\ No newline at end of file
@@ -2,24 +2,250 @@
 
 #include "core/tmemory.h"
 #include "core/logger.h"
+#include "core/tstring.h"
 
-u64 hash_name(const char* name, u32 element_count){
-    // A multiplier to use when generating a hash. Prime to hopefully avoid collisions.
-    static const u64 multiplier = 97;
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+    #define HASHTABLE_USE_SSE2 1
+    #include <emmintrin.h>
+#else
+    #define HASHTABLE_USE_SSE2 0
+#endif
 
-    unsigned const char* us;
-    u64 hash = 0;
+// The number of control bytes inspected at once while probing.
+#define GROUP_WIDTH 16
 
-    for (us = (unsigned const char*)name; *us; us++){
-        hash = hash * multiplier + *us;
-    }
+// Control byte values. Full slots hold the low 7 bits of the hash, so their high bit is always clear.
+#define CTRL_EMPTY 0x80
+#define CTRL_DELETED 0xFE
 
-    // Mod it against the size of the table.
-    hash %= element_count;
+u64 hash_name(const char* name){
+    // 64-bit FNV-1a.
+    u64 hash = 0xcbf29ce484222325ULL;
+    for(const u8* us = (const u8*)name; *us; us++){
+        hash ^= *us;
+        hash *= 0x100000001b3ULL;
+    }
 
+    // Finalize so both the low bits (control byte) and the high bits (group index) are well mixed.
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
     return hash;
 }
 
+TINLINE u32 lowest_bit_index(u32 mask){
+#if defined(__GNUC__) || defined(__clang__)
+    return (u32)__builtin_ctz(mask);
+#else
+    u32 index = 0;
+    while(!(mask & 1)){
+        mask >>= 1;
+        index++;
+    }
+    return index;
+#endif
+}
+
+// Returns a bitmask of the slots in the group whose control byte equals value.
+TINLINE u32 group_match(const u8* group, u8 value){
+#if HASHTABLE_USE_SSE2
+    __m128i ctrl = _mm_loadu_si128((const __m128i*)group);
+    return (u32)_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8((char)value)));
+#else
+    u32 mask = 0;
+    for(u32 i = 0; i < GROUP_WIDTH; ++i){
+        if(group[i] == value){
+            mask |= 1u << i;
+        }
+    }
+    return mask;
+#endif
+}
+
+// Returns a bitmask of the slots in the group which are either empty or deleted.
+TINLINE u32 group_match_available(const u8* group){
+#if HASHTABLE_USE_SSE2
+    __m128i ctrl = _mm_loadu_si128((const __m128i*)group);
+    return (u32)_mm_movemask_epi8(ctrl);
+#else
+    u32 mask = 0;
+    for(u32 i = 0; i < GROUP_WIDTH; ++i){
+        if(group[i] & 0x80){
+            mask |= 1u << i;
+        }
+    }
+    return mask;
+#endif
+}
+
+static u32 slot_count_for(u32 capacity){
+    // Always keep at least 1/8 of the slots free so probe sequences stay short and terminate.
+    u64 min_slots = (u64)capacity + (capacity / 7) + 1;
+    u64 group_count = (min_slots + GROUP_WIDTH - 1) / GROUP_WIDTH;
+    return (u32)(group_count * GROUP_WIDTH);
+}
+
+static u64 metadata_requirement(u64 element_size, u32 capacity, u32 slot_count){
+    return (sizeof(u64) * capacity) +       // entry_hashes
+           (sizeof(char*) * capacity) +     // entry_keys
+           (sizeof(u32) * capacity) +       // entry_slots
+           (sizeof(u32) * slot_count) +     // slot_entries
+           slot_count +                     // control
+           element_size;                    // default_value
+}
+
+static void assign_metadata(hashtable* table, void* block, u64 size, u32 capacity, u32 slot_count){
+    // Layout: hashes, keys, entry slots, slot entries, control bytes, default value.
+    table->metadata = block;
+    table->metadata_size = size;
+    table->slot_count = slot_count;
+    table->entry_hashes = block;
+    table->entry_keys = (char**)(table->entry_hashes + capacity);
+    table->entry_slots = (u32*)(table->entry_keys + capacity);
+    table->slot_entries = table->entry_slots + capacity;
+    table->control = (u8*)(table->slot_entries + slot_count);
+    table->default_value = table->control + slot_count;
+}
+
+static u32 find_insert_slot(const hashtable* table, u64 hash){
+    u32 group_count = table->slot_count / GROUP_WIDTH;
+    u32 group = (u32)((hash >> 7) % group_count);
+    for(u32 probe = 0; probe < group_count; ++probe){
+        u32 base = group * GROUP_WIDTH;
+        u32 mask = group_match_available(table->control + base);
+        if(mask){
+            return base + lowest_bit_index(mask);
+        }
+        group = (group + 1) % group_count;
+    }
+
+    return INVALID_ID;
+}
+
+static u32 find_slot(const hashtable* table, const char* name, u64 hash){
+    u8 h2 = (u8)(hash & 0x7F);
+    u32 group_count = table->slot_count / GROUP_WIDTH;
+    u32 group = (u32)((hash >> 7) % group_count);
+    for(u32 probe = 0; probe < group_count; ++probe){
+        u32 base = group * GROUP_WIDTH;
+        const u8* ctrl = table->control + base;
+        u32 mask = group_match(ctrl, h2);
+        while(mask){
+            u32 slot = base + lowest_bit_index(mask);
+            u32 entry = table->slot_entries[slot];
+            if(table->entry_hashes[entry] == hash && strings_equal(table->entry_keys[entry], name)){
+                return slot;
+            }
+            mask &= mask - 1;
+        }
+
+        // An empty slot ends the probe sequence; the name was never inserted past this group.
+        if(group_match(ctrl, CTRL_EMPTY)){
+            return INVALID_ID;
+        }
+        group = (group + 1) % group_count;
+    }
+
+    return INVALID_ID;
+}
+
+static void rebuild_slots(hashtable* table){
+    tset_memory(table->control, CTRL_EMPTY, table->slot_count);
+    table->tombstone_count = 0;
+    for(u32 i = 0; i < table->entry_count; ++i){
+        u64 hash = table->entry_hashes[i];
+        u32 slot = find_insert_slot(table, hash);
+        table->control[slot] = (u8)(hash & 0x7F);
+        table->slot_entries[slot] = i;
+        table->entry_slots[i] = slot;
+    }
+}
+
+static b8 grow(hashtable* table){
+    u32 new_capacity = table->element_count * 2;
+    u32 new_slot_count = slot_count_for(new_capacity);
+    u64 new_metadata_size = metadata_requirement(table->element_size, new_capacity, new_slot_count);
+
+    void* new_memory = tallocate(table->element_size * new_capacity, MEMORY_TAG_DICT);
+    void* new_metadata = tallocate(new_metadata_size, MEMORY_TAG_DICT);
+    if(!new_memory || !new_metadata){
+        TERROR("hashtable failed to grow to %u entries.", new_capacity);
+        return FALSE;
+    }
+    tcopy_memory(new_memory, table->memory, table->element_size * table->entry_count);
+
+    // Hold onto the old arrays long enough to copy the entries across.
+    hashtable old = *table;
+    assign_metadata(table, new_metadata, new_metadata_size, new_capacity, new_slot_count);
+    tcopy_memory(table->entry_hashes, old.entry_hashes, sizeof(u64) * old.entry_count);
+    tcopy_memory(table->entry_keys, old.entry_keys, sizeof(char*) * old.entry_count);
+    tcopy_memory(table->default_value, old.default_value, table->element_size);
+
+    tfree(old.metadata, old.metadata_size, MEMORY_TAG_DICT);
+    if(old.owns_memory){
+        tfree(old.memory, old.element_size * old.element_count, MEMORY_TAG_DICT);
+    }
+
+    table->memory = new_memory;
+    table->owns_memory = TRUE;
+    table->element_count = new_capacity;
+    rebuild_slots(table);
+
+    TDEBUG("hashtable grew from %u to %u entries.", old.element_count, new_capacity);
+    return TRUE;
+}
+
+static u32 insert_entry(hashtable* table, const char* name, u64 hash){
+    if(table->entry_count == table->element_count){
+        if(!grow(table)){
+            return INVALID_ID;
+        }
+    }else if(table->entry_count + table->tombstone_count >= table->slot_count - (table->slot_count / 8)){
+        // Too many deleted slots are lengthening probe sequences. Clean them up in place.
+        rebuild_slots(table);
+    }
+
+    u32 slot = find_insert_slot(table, hash);
+    if(table->control[slot] == CTRL_DELETED){
+        table->tombstone_count--;
+    }
+
+    u32 entry = table->entry_count++;
+    table->entry_hashes[entry] = hash;
+    table->entry_keys[entry] = string_duplicate(name);
+    table->entry_slots[entry] = slot;
+    table->slot_entries[slot] = entry;
+    table->control[slot] = (u8)(hash & 0x7F);
+    return entry;
+}
+
+static void remove_slot(hashtable* table, u32 slot){
+    u32 entry = table->slot_entries[slot];
+
+    // If the group still has an empty slot, no probe sequence ever continued past it,
+    // so this slot can go straight back to empty instead of leaving a tombstone.
+    u32 base = slot - (slot % GROUP_WIDTH);
+    if(group_match(table->control + base, CTRL_EMPTY)){
+        table->control[slot] = CTRL_EMPTY;
+    }else{
+        table->control[slot] = CTRL_DELETED;
+        table->tombstone_count++;
+    }
+
+    char* key = table->entry_keys[entry];
+    tfree(key, string_length(key) + 1, MEMORY_TAG_STRING);
+
+    // Move the last entry into the hole to keep values densely packed.
+    u32 last = --table->entry_count;
+    if(entry != last){
+        tcopy_memory(table->memory + (table->element_size * entry), table->memory + (table->element_size * last), table->element_size);
+        table->entry_hashes[entry] = table->entry_hashes[last];
+        table->entry_keys[entry] = table->entry_keys[last];
+        table->entry_slots[entry] = table->entry_slots[last];
+        table->slot_entries[table->entry_slots[entry]] = entry;
+    }
+}
+
 void hashtable_create(u64 element_size, u32 element_count, void* memory, b8 is_pointer_type, hashtable* out_hashtable){
     if(!memory || !out_hashtable){
         TERROR("hashtable_create failed! Pointer to memory and out_hashtable are required.");
@@ -30,17 +256,30 @@ void hashtable_create(u64 element_size, u32 element_count, void* memory, b8 is_p
         return;
     }
 
-    // TODO: Might want to require an allocator and allocate this memory instead.
+    tzero_memory(out_hashtable, sizeof(hashtable));
     out_hashtable->memory = memory;
     out_hashtable->element_count = element_count;
     out_hashtable->element_size = element_size;
     out_hashtable->is_pointer_type = is_pointer_type;
     tzero_memory(out_hashtable->memory, element_size * element_count);
+
+    u32 slot_count = slot_count_for(element_count);
+    u64 metadata_size = metadata_requirement(element_size, element_count, slot_count);
+    assign_metadata(out_hashtable, tallocate(metadata_size, MEMORY_TAG_DICT), metadata_size, element_count, slot_count);
+    tset_memory(out_hashtable->control, CTRL_EMPTY, slot_count);
 }
 
 void hashtable_destroy(hashtable* table){
     if(table){
-        // TODO: If using allocator above, free memory here.
+        for(u32 i = 0; i < table->entry_count; ++i){
+            tfree(table->entry_keys[i], string_length(table->entry_keys[i]) + 1, MEMORY_TAG_STRING);
+        }
+        if(table->metadata){
+            tfree(table->metadata, table->metadata_size, MEMORY_TAG_DICT);
+        }
+        if(table->owns_memory){
+            tfree(table->memory, table->element_size * table->element_count, MEMORY_TAG_DICT);
+        }
         tzero_memory(table, sizeof(hashtable));
     }
 }
@@ -55,9 +294,16 @@ b8 hashtable_set(hashtable* table, const char* name, void* value){
         return FALSE;
     }
 
-    u64 hash = hash_name(name, table->element_count);
-    tcopy_memory(table->memory + (table->element_size * hash), value, table->element_size);
-    return TRUE; 
+    u64 hash = hash_name(name);
+    u32 slot = find_slot(table, name, hash);
+    u32 entry = slot != INVALID_ID ? table->slot_entries[slot] : insert_entry(table, name, hash);
+    if(entry == INVALID_ID){
+        TERROR("hashtable_set failed to insert entry '%s'.", name);
+        return FALSE;
+    }
+
+    tcopy_memory(table->memory + (table->element_size * entry), value, table->element_size);
+    return TRUE;
 }
 
 b8 hashtable_set_ptr(hashtable* table, const char* name, void** value){
@@ -70,8 +316,24 @@ b8 hashtable_set_ptr(hashtable* table, const char* name, void** value){
         return FALSE;
     }
 
-    u64 hash = hash_name(name, table->element_count);
-    ((void**)table->memory)[hash] = value ? *value : 0;
+    u64 hash = hash_name(name);
+    u32 slot = find_slot(table, name, hash);
+
+    // Setting a null pointer unsets the entry.
+    if(!value || !*value){
+        if(slot != INVALID_ID){
+            remove_slot(table, slot);
+        }
+        return TRUE;
+    }
+
+    u32 entry = slot != INVALID_ID ? table->slot_entries[slot] : insert_entry(table, name, hash);
+    if(entry == INVALID_ID){
+        TERROR("hashtable_set_ptr failed to insert entry '%s'.", name);
+        return FALSE;
+    }
+
+    ((void**)table->memory)[entry] = *value;
     return TRUE;
 }
 
@@ -85,8 +347,14 @@ b8 hashtable_get(hashtable* table, const char* name, void* out_value){
         return FALSE;
     }
 
-    u64 hash = hash_name(name, table->element_count);
-    tcopy_memory(out_value, table->memory + (table->element_size * hash), table->element_size);
+    u32 slot = find_slot(table, name, hash_name(name));
+    if(slot != INVALID_ID){
+        tcopy_memory(out_value, table->memory + (table->element_size * table->slot_entries[slot]), table->element_size);
+    }else if(table->has_default){
+        tcopy_memory(out_value, table->default_value, table->element_size);
+    }else{
+        tzero_memory(out_value, table->element_size);
+    }
     return TRUE;
 }
 
@@ -100,8 +368,8 @@ b8 hashtable_get_ptr(hashtable* table, const char* name, void** out_value){
         return FALSE;
     }
 
-    u64 hash = hash_name(name, table->element_count);
-    *out_value = ((void**)table->memory)[hash];
+    u32 slot = find_slot(table, name, hash_name(name));
+    *out_value = slot != INVALID_ID ? ((void**)table->memory)[table->slot_entries[slot]] : 0;
     return *out_value != 0;
 }
 
@@ -115,10 +383,45 @@ b8 hashtable_fill(hashtable* table, void* value){
         return FALSE;
     }
 
-    for (u32 i = 0; i < table->element_count; ++i)
+    // Existing entries take the value, and names not yet in the table will return it.
+    for (u32 i = 0; i < table->entry_count; ++i)
     {
         tcopy_memory(table->memory + (table->element_size * i), value, table->element_size);
     }
-    
+    tcopy_memory(table->default_value, value, table->element_size);
+    table->has_default = TRUE;
+
     return TRUE;
-}
\ No newline at end of file
+}
+
+b8 hashtable_contains(hashtable* table, const char* name){
+    if(!table || !name){
+        TWARN("hashtable_contains requires table and name to exist.");
+        return FALSE;
+    }
+
+    return find_slot(table, name, hash_name(name)) != INVALID_ID;
+}
+
+b8 hashtable_remove(hashtable* table, const char* name){
+    if(!table || !name){
+        TWARN("hashtable_remove requires table and name to exist.");
+        return FALSE;
+    }
+
+    u32 slot = find_slot(table, name, hash_name(name));
+    if(slot == INVALID_ID){
+        return FALSE;
+    }
+
+    remove_slot(table, slot);
+    return TRUE;
+}
+
+f32 hashtable_load_factor(const hashtable* table){
+    if(!table || !table->slot_count){
+        return 0.0f;
+    }
+
+    return (f32)table->entry_count / (f32)table->slot_count;
+}
@@ -5,25 +5,63 @@
 /**
  * @brief Represents a simple hashtable. Members of this structure
  * should to be modified outside the functions associated with it.
- * 
- * For non-pointer types, table retains a copy of the value. For 
+ *
+ * For non-pointer types, table retains a copy of the value. For
  * pointer types, make sure to use the _ptr setter and getter.
  * Table does not take ownership of pointers or associated memory
  * allocations, and should be managed externally.
+ *
+ * Internally this is an open-addressing table using SwissTable-style
+ * control bytes, probed 16 slots at a time (SSE2 when available).
+ * Each entry stores its full hash and a copy of its key, so colliding
+ * names never overwrite each other. Values live densely packed in the
+ * provided memory block, and the control/slot metadata is allocated
+ * internally. When more than element_count entries are inserted, the
+ * table grows into an internally owned value block.
  */
 typedef struct hashtable {
     u64 element_size;
+    /** @brief The number of entries the value block can currently hold. */
     u32 element_count;
     b8 is_pointer_type;
+    /** @brief The block holding the values, densely packed. */
     void* memory;
+
+    /** @brief The number of live entries currently stored. */
+    u32 entry_count;
+    /** @brief The number of deleted control slots awaiting a rehash. */
+    u32 tombstone_count;
+    /** @brief The number of control slots. Always a multiple of the probe group width. */
+    u32 slot_count;
+    /** @brief Indicates if memory was allocated by the table (after growing) and must be freed by it. */
+    b8 owns_memory;
+    /** @brief Indicates if a default value was provided through hashtable_fill. */
+    b8 has_default;
+
+    /** @brief The size of the internal metadata block in bytes. */
+    u64 metadata_size;
+    /** @brief The internal metadata block. Holds all of the arrays below. */
+    void* metadata;
+    /** @brief One control byte per slot: empty, deleted or the low 7 bits of the hash. */
+    u8* control;
+    /** @brief The entry index for each slot. */
+    u32* slot_entries;
+    /** @brief The full hash of each entry. */
+    u64* entry_hashes;
+    /** @brief A copy of the key of each entry. */
+    char** entry_keys;
+    /** @brief The slot each entry lives in. */
+    u32* entry_slots;
+    /** @brief The value returned for names not in the table. */
+    void* default_value;
 }hashtable;
 
 /**
  * @brief Creates a hashtable and stores it in out_hashtable.
- * 
+ *
  * @param element_size The size of each element in bytes.
- * @param element_count The maximum number of elements. Cannot be resized.
- * @param memory A pointer to hold a block of memory to be used. Internally allocated. Will be equal in size to element_size * element_count.
+ * @param element_count The number of elements that fit in memory. The table grows past this if needed.
+ * @param memory A pointer to hold a block of memory to be used. Must be element_size * element_count in size.
  * @param is_pointer_type Indicates if this hashtable will hold pointer types.
  * @param out_hashtable A pointer to a hashtable in which to hold relevant data.
  */
@@ -31,7 +69,7 @@ TAPI void hashtable_create(u64 element_size, u32 element_count, void* memory, b8
 
 /**
  * @brief Destroys the provided hashtable. Does not release memory for pointer types.
- * 
+ *
  * @param table A pointer to the table to be destroyed.
  */
 TAPI void hashtable_destroy(hashtable* table);
@@ -39,7 +77,7 @@ TAPI void hashtable_destroy(hashtable* table);
 /**
  * @brief Stores a copy of the data in value in the provided hastable.alignas
  * Only use for tables which were *NOT* created with is_pointer_type = TRUE.
- * 
+ *
  * @param table A pointer to the table to get from. Required.
  * @param name The name of the entry to set. Required.
  * @param value The value to be set. Required.
@@ -50,7 +88,7 @@ TAPI b8 hashtable_set(hashtable* table, const char* name, void* value);
 /**
  * @brief Stores a pointer as provided in value in the hashtable.
  * Only use for tables which were create with is_pointer_type = TRUE.
- * 
+ *
  * @param table A pointer to the table to get from. Required.
  * @param name The name of the entry to set. Required.
  * @param value A pointer value to be set. Can pass 0 to 'unset' an entry.
@@ -61,7 +99,9 @@ TAPI b8 hashtable_set_ptr(hashtable* table, const char* name, void** value);
 /**
  * @brief Obtains a copy of data present in the hashtable.
  * Only use for tables which were *NOT* created with is_pointer_type = TRUE.
- * 
+ * If the name does not exist, the value provided to hashtable_fill (or zeroes)
+ * is copied instead.
+ *
  * @param table A pointer to the table to retrieved from. Required.
  * @param name The name of the entry to retrieved. Required.
  * @param value A pointer to store the retrieved value. Required.
@@ -72,7 +112,7 @@ TAPI b8 hashtable_get(hashtable* table, const char* name, void* out_value);
 /**
  * @brief Obtains a pointer to data present in the hashtable.
  * Only use for tables which were created with is_pointer_type = TRUE.
- * 
+ *
  * @param table A pointer to the table to retrieved from. Required.
  * @param name The name of the entry to retrieved. Required.
  * @param value A pointer to score the retrieved value. Required.
@@ -84,9 +124,36 @@ TAPI b8 hashtable_get_ptr(hashtable* table, const char* name, void** out_value);
  * @brief Fills all entries in the hashtable with the given value.
  * Useful when non-existent names should return some default value.
  * Should not be used with pointer table types.
- * 
+ *
  * @param table A pointer to the table filled. Required.
  * @param value The value to be filled with. Required.
  * @return True if successful, otherwise false.
  */
-TAPI b8 hashtable_fill(hashtable* table, void* value);
\ No newline at end of file
+TAPI b8 hashtable_fill(hashtable* table, void* value);
+
+/**
+ * @brief Indicates if an entry with the given name exists in the table.
+ *
+ * @param table A pointer to the table to search. Required.
+ * @param name The name of the entry to look for. Required.
+ * @return True if the entry exists; otherwise false.
+ */
+TAPI b8 hashtable_contains(hashtable* table, const char* name);
+
+/**
+ * @brief Removes the entry with the given name, if it exists.
+ *
+ * @param table A pointer to the table to remove from. Required.
+ * @param name The name of the entry to be removed. Required.
+ * @return True if an entry was removed; otherwise false.
+ */
+TAPI b8 hashtable_remove(hashtable* table, const char* name);
+
+/**
+ * @brief Obtains the load factor of the table, which is the ratio of live
+ * entries to control slots.
+ *
+ * @param table A pointer to the table to be examined. Required.
+ * @return The load factor in the range [0, 1].
+ */
+TAPI f32 hashtable_load_factor(const hashtable* table);
@@ -0,0 +1,145 @@
+#include "mpsc_queue.h"
+
+#include "core/tmemory.h"
+#include "core/tatomic.h"
+#include "core/logger.h"
+
+static u32 round_up_power_of_two(u32 value){
+    u32 result = 1;
+    while(result < value){
+        result <<= 1;
+    }
+    return result;
+}
+
+static u32 slot_size_for(u32 stride){
+    return (sizeof(u64) + stride + 7) & ~7u;
+}
+
+u64 mpsc_queue_memory_requirement(u32 stride, u32 capacity){
+    return (u64)slot_size_for(stride) * round_up_power_of_two(capacity);
+}
+
+b8 mpsc_queue_create(u32 stride, u32 capacity, void* memory, mpsc_queue* out_queue){
+    if(!out_queue){
+        TERROR("mpsc_queue_create requires a valid pointer to hold the queue.");
+        return FALSE;
+    }
+    if(stride == 0 || capacity == 0){
+        TERROR("mpsc_queue_create requires a non-zero stride and capacity.");
+        return FALSE;
+    }
+
+    tzero_memory(out_queue, sizeof(mpsc_queue));
+    out_queue->stride = stride;
+    out_queue->capacity = round_up_power_of_two(capacity);
+    out_queue->slot_size = slot_size_for(stride);
+    u64 block_size = mpsc_queue_memory_requirement(stride, capacity);
+    if(memory){
+        out_queue->owns_memory = FALSE;
+        out_queue->block = memory;
+    }else{
+        out_queue->owns_memory = TRUE;
+        out_queue->block = tallocate(block_size, MEMORY_TAG_RING_QUEUE);
+    }
+
+    // A slot is free for the producer at position p when its sequence is p.
+    for(u32 i = 0; i < out_queue->capacity; ++i){
+        *(u64*)(out_queue->block + ((u64)i * out_queue->slot_size)) = i;
+    }
+
+    return TRUE;
+}
+
+void mpsc_queue_destroy(mpsc_queue* queue){
+    if(queue){
+        if(queue->owns_memory){
+            tfree(queue->block, mpsc_queue_memory_requirement(queue->stride, queue->capacity), MEMORY_TAG_RING_QUEUE);
+        }
+        tzero_memory(queue, sizeof(mpsc_queue));
+    }
+}
+
+b8 mpsc_queue_enqueue(mpsc_queue* queue, const void* value){
+    if(!queue || !value){
+        TERROR("mpsc_queue_enqueue requires valid pointer to queue and value.");
+        return FALSE;
+    }
+
+    void* element = mpsc_queue_reserve(queue);
+    if(!element){
+        return FALSE;
+    }
+    tcopy_memory(element, value, queue->stride);
+    mpsc_queue_commit(queue, element);
+    return TRUE;
+}
+
+void* mpsc_queue_reserve(mpsc_queue* queue){
+    u64 mask = queue->capacity - 1;
+    u64 position = tatomic_load_u64(&queue->tail, TATOMIC_RELAXED);
+    while(TRUE){
+        void* slot = queue->block + ((position & mask) * queue->slot_size);
+        u64 sequence = tatomic_load_u64((volatile u64*)slot, TATOMIC_ACQUIRE);
+        i64 difference = (i64)sequence - (i64)position;
+        if(difference == 0){
+            // The slot is free, so try to claim this position.
+            if(tatomic_compare_exchange_u64(&queue->tail, &position, position + 1, TATOMIC_RELAXED)){
+                return slot + sizeof(u64);
+            }
+            // Another producer claimed it first; position now holds the current tail.
+        }else if(difference < 0){
+            // The consumer has not freed this slot yet, so the queue is full.
+            return 0;
+        }else{
+            position = tatomic_load_u64(&queue->tail, TATOMIC_RELAXED);
+        }
+    }
+}
+
+void mpsc_queue_commit(mpsc_queue* queue, void* element){
+    // The slot's sequence still holds the claimed position, since nothing else touches
+    // a claimed slot. Publish to the consumer.
+    volatile u64* sequence = (volatile u64*)(element - sizeof(u64));
+    tatomic_store_u64(sequence, *sequence + 1, TATOMIC_RELEASE);
+}
+
+b8 mpsc_queue_dequeue(mpsc_queue* queue, void* out_value){
+    if(!queue || !out_value){
+        TERROR("mpsc_queue_dequeue requires valid pointers to queue and out_value.");
+        return FALSE;
+    }
+
+    void* element = mpsc_queue_peek(queue);
+    if(!element){
+        return FALSE;
+    }
+    tcopy_memory(out_value, element, queue->stride);
+    mpsc_queue_pop(queue);
+    return TRUE;
+}
+
+void* mpsc_queue_peek(mpsc_queue* queue){
+    u64 position = queue->head;
+    void* slot = queue->block + ((position & (queue->capacity - 1)) * queue->slot_size);
+    u64 sequence = tatomic_load_u64((volatile u64*)slot, TATOMIC_ACQUIRE);
+    if(sequence != position + 1){
+        // Empty, or the producer of this slot has not finished writing it.
+        return 0;
+    }
+    return slot + sizeof(u64);
+}
+
+void mpsc_queue_pop(mpsc_queue* queue){
+    u64 position = queue->head;
+    void* slot = queue->block + ((position & (queue->capacity - 1)) * queue->slot_size);
+    // Hand the slot back to producers for their next lap around the ring.
+    tatomic_store_u64((volatile u64*)slot, position + queue->capacity, TATOMIC_RELEASE);
+    tatomic_store_u64(&queue->head, position + 1, TATOMIC_RELEASE);
+}
+
+u32 mpsc_queue_length(mpsc_queue* queue){
+    u64 tail = tatomic_load_u64(&queue->tail, TATOMIC_RELAXED);
+    u64 head = tatomic_load_u64(&queue->head, TATOMIC_RELAXED);
+    return tail > head ? (u32)(tail - head) : 0;
+}
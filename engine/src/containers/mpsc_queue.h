@@ -0,0 +1,121 @@
+#pragma once
+#include "defines.h"
+
+/**
+ * @brief A bounded, lock-free queue that any number of threads can add to
+ * while a single thread removes from it. Does not resize dynamically.
+ * First in, first out.
+ *
+ * Each slot carries a sequence number that tells producers and the consumer
+ * whether it is free or holds a value, so no locks are needed.
+ */
+typedef struct mpsc_queue {
+    /** @brief The size of each element in bytes. */
+    u32 stride;
+    /** @brief The total number of elements available. Always a power of two. */
+    u32 capacity;
+    /** @brief The size of each slot in bytes: the sequence number plus the element, rounded up to 8 bytes. */
+    u32 slot_size;
+    /** @brief Indicates if the queue owns its memory block. */
+    b8 owns_memory;
+    /** @brief The block of memory to hold the slots. */
+    void* block;
+    /** @brief The position of the next element to be removed. Only touched by the consumer. */
+    volatile u64 head;
+    u8 head_padding[56];
+    /** @brief The position of the next element to be added. Claimed by producers. */
+    volatile u64 tail;
+    u8 tail_padding[56];
+} mpsc_queue;
+
+/**
+ * @brief Gets the memory block size needed for a queue with the given stride and capacity.
+ *
+ * @param stride The size of each element in bytes.
+ * @param capacity The total number of elements. Rounded up to a power of two.
+ * @returns The size of the memory block in bytes.
+ */
+TAPI u64 mpsc_queue_memory_requirement(u32 stride, u32 capacity);
+
+/**
+ * @brief Creates a new queue of the given capacity and stride.
+ *
+ * @param stride The size of each element in bytes.
+ * @param capacity The total number of elements to be available in the queue. Rounded up to a power of two.
+ * @param memory The memory block used to hold the data. Should be the size given by
+ * mpsc_queue_memory_requirement. If 0 is passed, a block is automatically allocated and
+ * freed upon creation/destruction.
+ * @param out_queue A pointer to hold the newly created queue.
+ * @returns True on success; otherwise false.
+ */
+TAPI b8 mpsc_queue_create(u32 stride, u32 capacity, void* memory, mpsc_queue* out_queue);
+
+/**
+ * @brief Destroys the given queue. If memory was not passed in during creation,
+ * it is freed here. No other thread may be using the queue.
+ *
+ * @param queue A pointer to the queue to destroy.
+ */
+TAPI void mpsc_queue_destroy(mpsc_queue* queue);
+
+/**
+ * @brief Adds value to queue, if space is available. Safe to call from any thread.
+ *
+ * @param queue A pointer to the queue to add data to.
+ * @param value The value to be added.
+ * @return True if success; false if the queue is full.
+ */
+TAPI b8 mpsc_queue_enqueue(mpsc_queue* queue, const void* value);
+
+/**
+ * @brief Claims the next slot so an element can be written in place, avoiding a copy
+ * of the whole stride. The element must then be published with mpsc_queue_commit;
+ * until it is, the consumer cannot get past it. Safe to call from any thread.
+ *
+ * @param queue A pointer to the queue to add data to.
+ * @return A pointer to stride bytes to write the element into, or 0 if the queue is full.
+ */
+TAPI void* mpsc_queue_reserve(mpsc_queue* queue);
+
+/**
+ * @brief Publishes an element claimed with mpsc_queue_reserve to the consumer.
+ *
+ * @param queue A pointer to the queue.
+ * @param element The pointer returned by mpsc_queue_reserve.
+ */
+TAPI void mpsc_queue_commit(mpsc_queue* queue, void* element);
+
+/**
+ * @brief Attempts to retrieve the next value from the provided queue.
+ * Must only be called from the single consuming thread.
+ *
+ * @param queue A pointer to the queue to retrieve data from.
+ * @param out_value A pointer to hold the retrieved value.
+ * @return True if success; false if the queue is empty.
+ */
+TAPI b8 mpsc_queue_dequeue(mpsc_queue* queue, void* out_value);
+
+/**
+ * @brief Gets the next element in place without removing it. Must only be called
+ * from the single consuming thread.
+ *
+ * @param queue A pointer to the queue.
+ * @return A pointer to the element, or 0 if the queue is empty.
+ */
+TAPI void* mpsc_queue_peek(mpsc_queue* queue);
+
+/**
+ * @brief Removes the element last returned by mpsc_queue_peek, handing its slot back
+ * to producers. Must only be called from the single consuming thread.
+ *
+ * @param queue A pointer to the queue.
+ */
+TAPI void mpsc_queue_pop(mpsc_queue* queue);
+
+/**
+ * @brief Gets the number of elements in the queue. Only a snapshot while producers are active.
+ *
+ * @param queue A pointer to the queue.
+ * @return The number of elements.
+ */
+TAPI u32 mpsc_queue_length(mpsc_queue* queue);
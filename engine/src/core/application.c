@@ -1,16 +1,22 @@
 #include "application.h"
 #include "game_types.h"
 #include "logger.h"
+#include "core/asserts.h"
 #include "platform/platform.h"
 #include "core/tmemory.h"
 #include "core/event.h"
 #include "core/input.h"
+#include "core/input_recorder.h"
 #include "core/clock.h"
 #include "core/tstring.h"
+#include "core/profiler.h"
+#include "core/frame_pacing.h"
 
 #include "memory/linear_allocator.h"
+#include "memory/frame_allocator.h"
 
 #include "renderer/renderer_frontend.h"
+#include "renderer/views/render_view_world.h"
 
 // Systems
 #include "systems/texture_system.h"
@@ -21,10 +27,10 @@
 #include "systems/camera_system.h"
 #include "systems/render_view_system.h"
 #include "systems/job_system.h"
+#include "systems/transform_system.h"
 
 // TODO: temp
 #include "math/tmath.h"
-#include "math/transform.h"
 #include "math/geometry_utils.h"
 #include "containers/darray.h"
 #include "resources/mesh.h"
@@ -34,11 +40,16 @@ typedef struct application_state {
     game* game_inst;
     b8 is_running;
     b8 is_suspended;
+    // When the application was last suspended and how often the main loop has woken since.
+    f64 suspended_time;
+    u64 suspended_wakeups;
     i16 width;
     i16 height;
     clock clock;
     f64 last_time;
     linear_allocator systems_allocator;
+    // Transient memory for everything built during a frame, such as render packets.
+    frame_allocator frame_allocator;
 
     u64 event_system_memory_requirement;
     void* event_system_state;
@@ -49,9 +60,18 @@ typedef struct application_state {
     u64 logging_system_memory_requirement;
     void* logging_system_state;
 
+    u64 profiler_system_memory_requirement;
+    void* profiler_system_state;
+
     u64 input_system_memory_requirement;
     void* input_system_state;
 
+    u64 input_recorder_memory_requirement;
+    void* input_recorder_state;
+
+    u64 frame_pacing_memory_requirement;
+    void* frame_pacing_state;
+
     u64 platform_system_memory_requirement;
     void* platform_system_state;
 
@@ -76,6 +96,9 @@ typedef struct application_state {
     u64 geometry_system_memory_requirement;
     void* geometry_system_state;
 
+    u64 transform_system_memory_requirement;
+    void* transform_system_state;
+
     u64 camera_system_memory_requirement;
     void* camera_system_state;
 
@@ -83,11 +106,14 @@ typedef struct application_state {
     skybox sb;
 
     mesh meshes[10];
+    // How many of meshes are in use. Not all of them are loaded yet.
+    u32 mesh_count;
     mesh* car_mesh;
     mesh* sponza_mesh;
     b8 models_loaded;
 
     mesh ui_meshes[10];
+    u32 ui_mesh_count;
     // TODO: end temp
 } application_state;
 
@@ -180,6 +206,9 @@ b8 application_create(game* game_inst){
     u64 systems_allocator_total_size = 64 * 1024 * 1024; // 64 mb
     linear_allocator_create(systems_allocator_total_size, 0, &app_state->systems_allocator);
 
+    // Per-frame transient memory, so the frame loop never has to touch the general heap.
+    u64 frame_allocator_size = 8 * 1024 * 1024; // 8 mb per frame
+    frame_allocator_create(frame_allocator_size, &app_state->frame_allocator);
 
     // Initialize other subsystems.
     event_system_initialize(&app_state->event_system_memory_requirement, 0);
@@ -194,29 +223,58 @@ b8 application_create(game* game_inst){
         return FALSE;
     }
 
+    // Profiler
+    profiler_system_initialize(&app_state->profiler_system_memory_requirement, 0);
+    app_state->profiler_system_state = linear_allocator_allocate(&app_state->systems_allocator, app_state->profiler_system_memory_requirement);
+    if(!profiler_system_initialize(&app_state->profiler_system_memory_requirement, app_state->profiler_system_state)){
+        TERROR("Failed to initialize profiler; shutting down.");
+        return FALSE;
+    }
+    profiler_set_thread_name("main");
+
     // Input
     input_system_initialize(&app_state->input_system_memory_requirement, 0);
     app_state->input_system_state = linear_allocator_allocate(&app_state->systems_allocator, app_state->input_system_memory_requirement);
     input_system_initialize(&app_state->input_system_memory_requirement, app_state->input_system_state);
 
+    // Input recorder
+    input_recorder_initialize(&app_state->input_recorder_memory_requirement, 0);
+    app_state->input_recorder_state = linear_allocator_allocate(&app_state->systems_allocator, app_state->input_recorder_memory_requirement);
+    input_recorder_initialize(&app_state->input_recorder_memory_requirement, app_state->input_recorder_state);
+
+    // Frame pacing
+    frame_pacing_config frame_pacing_sys_config;
+    frame_pacing_sys_config.target_frame_rate = game_inst->app_config.target_frame_rate;
+    frame_pacing_sys_config.spin_milliseconds = 2.0;
+    frame_pacing_sys_config.log_interval_seconds = 10.0;
+    frame_pacing_initialize(&app_state->frame_pacing_memory_requirement, 0, frame_pacing_sys_config);
+    app_state->frame_pacing_state = linear_allocator_allocate(&app_state->systems_allocator, app_state->frame_pacing_memory_requirement);
+    frame_pacing_initialize(&app_state->frame_pacing_memory_requirement, app_state->frame_pacing_state, frame_pacing_sys_config);
+
     // Register for engine-level events.
     event_register(EVENT_CODE_APPLICATION_QUIT, 0, application_on_event);
     event_register(EVENT_CODE_KEY_PRESSED, 0, application_on_key);
     event_register(EVENT_CODE_KEY_RELEASED, 0, application_on_key);
     event_register(EVENT_CODE_RESIZED, 0, application_on_resize);
+    event_register(EVENT_CODE_PROFILER_CAPTURE, 0, application_on_event);
     // TODO: temp
     event_register(EVENT_CODE_DEBUG0, 0, event_on_debug_event);
     event_register(EVENT_CODE_DEBUG1, 0, event_on_debug_event);
     // TODO: end temp
 
     // Platform
-    platform_system_startup(&app_state->platform_system_memory_requirement, 0, 0, 0, 0, 0, 0);
+    platform_system_startup(&app_state->platform_system_memory_requirement, 0, 0, 0, 0, 0, 0, FALSE);
     app_state->platform_system_state = linear_allocator_allocate(&app_state->systems_allocator, app_state->platform_system_memory_requirement);
     if(!platform_system_startup(&app_state->platform_system_memory_requirement, app_state->platform_system_state,
      game_inst->app_config.name, game_inst->app_config.start_pos_x, game_inst->app_config.start_pos_y,
-     game_inst->app_config.start_width, game_inst->app_config.start_height)){
+     game_inst->app_config.start_width, game_inst->app_config.start_height, game_inst->app_config.headless)){
         return FALSE;
     }
+    if(game_inst->app_config.headless){
+        // No window system will report a size, so take the one asked for.
+        app_state->width = game_inst->app_config.start_width;
+        app_state->height = game_inst->app_config.start_height;
+    }
 
     // Resource system
     resource_system_config resource_sys_config;
@@ -243,9 +301,10 @@ b8 application_create(game* game_inst){
     }
 
     // Renderer system startup
-    renderer_system_initialize(&app_state->renderer_system_memory_requirement, 0, 0);
+    renderer_backend_type backend_type = game_inst->app_config.headless ? RENDERER_BACKEND_TYPE_NULL : RENDERER_BACKEND_TYPE_VULKAN;
+    renderer_system_initialize(&app_state->renderer_system_memory_requirement, 0, 0, backend_type);
     app_state->renderer_system_state = linear_allocator_allocate(&app_state->systems_allocator, app_state->renderer_system_memory_requirement);
-    if(!renderer_system_initialize(&app_state->renderer_system_memory_requirement, app_state->renderer_system_state, game_inst->app_config.name)){
+    if(!renderer_system_initialize(&app_state->renderer_system_memory_requirement, app_state->renderer_system_state, game_inst->app_config.name, backend_type)){
         TFATAL("Failed to initialize renderer. Aborting aplication.");
         return FALSE;
     }
@@ -326,6 +385,16 @@ b8 application_create(game* game_inst){
         return FALSE;
     }
 
+    // Transform system.
+    transform_system_config transform_sys_config;
+    transform_sys_config.max_transform_count = 4096;
+    transform_system_initialize(&app_state->transform_system_memory_requirement, 0, transform_sys_config);
+    app_state->transform_system_state = linear_allocator_allocate(&app_state->systems_allocator, app_state->transform_system_memory_requirement);
+    if(!transform_system_initialize(&app_state->transform_system_memory_requirement, app_state->transform_system_state, transform_sys_config)){
+        TFATAL("Failed to initialize transform system. Application cannot continue.");
+        return FALSE;
+    }
+
     // Camera system.
     camera_system_config camera_sys_config;
     camera_sys_config.max_camera_count = 61;
@@ -429,7 +498,7 @@ b8 application_create(game* game_inst){
     cube_mesh->geometries = tallocate(sizeof(mesh*) * cube_mesh->geometry_count, MEMORY_TAG_ARRAY);
     geometry_config g_config = geometry_system_generate_cube_config(10.0f, 10.0f, 10.0f, 1.0f, 1.0f, "test_cube", "test_material");
     cube_mesh->geometries[0] = geometry_system_acquire_from_config(g_config, TRUE);
-    cube_mesh->transform = transform_create();
+    cube_mesh->transform_handle = transform_system_create(vec3_zero(), quat_identity(), vec3_one());
     mesh_count++;
     cube_mesh->generation = 0;
     // Clean up the allocations for the geometry config.
@@ -440,8 +509,8 @@ b8 application_create(game* game_inst){
     cube_mesh_2->geometries = tallocate(sizeof(mesh*) * cube_mesh_2->geometry_count, MEMORY_TAG_ARRAY);
     geometry_config g_config_2 = geometry_system_generate_cube_config(5.0f, 5.0f, 5.0f, 1.0f, 1.0f, "test_cube_2", "test_material");
     cube_mesh_2->geometries[0] = geometry_system_acquire_from_config(g_config_2, TRUE);
-    cube_mesh_2->transform = transform_from_position((vec3){10.0f, 0.0f, 1.0f});
-    transform_set_parent(&cube_mesh_2->transform, &cube_mesh->transform);
+    cube_mesh_2->transform_handle = transform_system_create((vec3){10.0f, 0.0f, 1.0f}, quat_identity(), vec3_one());
+    transform_system_set_parent(cube_mesh_2->transform_handle, cube_mesh->transform_handle);
     mesh_count++;
     
     // Clean up the allocations for the geometry config.
@@ -454,8 +523,8 @@ b8 application_create(game* game_inst){
     cube_mesh_3->geometries = tallocate(sizeof(mesh*) * cube_mesh_3->geometry_count, MEMORY_TAG_ARRAY);
     geometry_config g_config_3 = geometry_system_generate_cube_config(2.0f, 2.0f, 2.0f, 1.0f, 1.0f, "test_cube_3", "test_material");
     cube_mesh_3->geometries[0] = geometry_system_acquire_from_config(g_config_3, TRUE);
-    cube_mesh_3->transform = transform_from_position((vec3){5.0f, 0.0f, 1.0f});
-    transform_set_parent(&cube_mesh_3->transform, &cube_mesh_2->transform);
+    cube_mesh_3->transform_handle = transform_system_create((vec3){5.0f, 0.0f, 1.0f}, quat_identity(), vec3_one());
+    transform_system_set_parent(cube_mesh_3->transform_handle, cube_mesh_2->transform_handle);
     mesh_count++;
     cube_mesh_3->generation = 0;
     // Clean up the allocations for the geometry config.
@@ -463,12 +532,13 @@ b8 application_create(game* game_inst){
 
     // External test meshes
     app_state->car_mesh = &app_state->meshes[mesh_count];
-    app_state->car_mesh->transform = transform_from_position((vec3){15.0f, 0.0f, 1.0f});
+    app_state->car_mesh->transform_handle = transform_system_create((vec3){15.0f, 0.0f, 1.0f}, quat_identity(), vec3_one());
     mesh_count++;
 
     app_state->sponza_mesh = &app_state->meshes[mesh_count];
-    app_state->sponza_mesh->transform = transform_from_position_rotation_scale((vec3){15.0f, 0.0f, 1.0f}, quat_identity(), (vec3){0.05f, 0.05f, 0.05f});
+    app_state->sponza_mesh->transform_handle = transform_system_create((vec3){15.0f, 0.0f, 1.0f}, quat_identity(), (vec3){0.05f, 0.05f, 0.05f});
     mesh_count++;
+    app_state->mesh_count = mesh_count;
 
     // Load up some test UI geometry.
     geometry_config ui_config;
@@ -516,8 +586,9 @@ b8 application_create(game* game_inst){
     app_state->ui_meshes[0].geometry_count = 1;
     app_state->ui_meshes[0].geometries = tallocate(sizeof(geometry*), MEMORY_TAG_ARRAY);
     app_state->ui_meshes[0].geometries[0] = geometry_system_acquire_from_config(ui_config, TRUE);
-    app_state->ui_meshes[0].transform = transform_create();
+    app_state->ui_meshes[0].transform_handle = transform_system_create(vec3_zero(), quat_identity(), vec3_one());
     app_state->ui_meshes[0].generation = 0;
+    app_state->ui_mesh_count = 1;
 
 
     // TODO: end temp
@@ -536,72 +607,135 @@ b8 application_create(game* game_inst){
     return TRUE;
 }
 
+// Set to 1 to assert that no frame makes a heap allocation once the first
+// APPLICATION_STEADY_STATE_FRAME frames have passed. Off by default, since loading
+// assets at runtime legitimately allocates.
+#ifndef APPLICATION_ASSERT_NO_FRAME_ALLOCATIONS
+    #define APPLICATION_ASSERT_NO_FRAME_ALLOCATIONS 0
+#endif
+#define APPLICATION_STEADY_STATE_FRAME 300
+
+// The longest the main loop sleeps while suspended before checking on the job system.
+#define APPLICATION_SUSPENDED_WAIT_MS 50
+
 b8 application_run(){
     app_state->is_running = TRUE;
 
     clock_start(&app_state->clock);
     clock_update(&app_state->clock);
     app_state->last_time = app_state->clock.elapsed;
-    // f64 running_time = 0;
-    u8 frame_count = 0;
-    f64 target_frame_seconds = 1.0f / 60;
+    u64 frame_number = 0;
+
+    const application_config* config = &app_state->game_inst->app_config;
+    if(config->replay_path){
+        if(!input_recorder_start_replay(config->replay_path, 0)){
+            TFATAL("Failed to start replaying '%s', shutting down.", config->replay_path);
+            return FALSE;
+        }
+    }else if(config->record_path){
+        if(!input_recorder_start_recording(config->record_path)){
+            TFATAL("Failed to start recording to '%s', shutting down.", config->record_path);
+            return FALSE;
+        }
+    }
 
     TINFO(get_memory_usage_str());
 
+    // Everything up to here was startup, not a frame.
+    frame_pacing_restart_frame();
+
     while(app_state->is_running){
         if(!platform_pump_messages()){
             app_state->is_running = FALSE;
         }
 
         if(!app_state->is_suspended){
+            TPROFILE_BEGIN("frame");
+
             // Update clock and get delta time.
             clock_update(&app_state->clock);
             f64 current_time = app_state->clock.elapsed;
             f64 delta = (current_time - app_state->last_time);
-            f64 frame_start_time = platform_get_absolute_time();
+
+            // When replaying, this delivers the frame's recorded input and fixes the delta time.
+            if(!input_recorder_begin_frame(&delta)){
+                app_state->is_running = FALSE;
+                TPROFILE_END();
+                break;
+            }
+
+            // Anything allocated from the frame allocator two frames ago is released here.
+            frame_allocator_begin_frame(&app_state->frame_allocator);
+
+            // A steady state frame should make no heap allocations at all.
+#if APPLICATION_ASSERT_NO_FRAME_ALLOCATIONS
+            if(frame_number > APPLICATION_STEADY_STATE_FRAME){
+                TASSERT_MSG(get_memory_frame_alloc_count() == 0, "Heap allocation made during a steady state frame.");
+            }
+#endif
+            memory_system_begin_frame();
+            frame_number++;
+
+            frame_pacing_phase_begin(FRAME_PHASE_UPDATE);
 
             // Update the job system.
             job_system_update();
 
-            if(!app_state->game_inst->update(app_state->game_inst, (f32)delta)){
+            TPROFILE_BEGIN("game_update");
+            b8 game_result = app_state->game_inst->update(app_state->game_inst, (f32)delta);
+            TPROFILE_END();
+            if(!game_result){
                 TFATAL("Game update failed, shutting down.");
                 app_state->is_running = FALSE;
+                TPROFILE_END();
                 break;
             }
 
             // Call the game's render routine.
-            if(!app_state->game_inst->render(app_state->game_inst, (f32)delta)){
+            TPROFILE_BEGIN("game_render");
+            game_result = app_state->game_inst->render(app_state->game_inst, (f32)delta);
+            TPROFILE_END();
+            if(!game_result){
                 TFATAL("Game update failed, shutting down.");
                 app_state->is_running = FALSE;
+                TPROFILE_END();
                 break;
             }
 
            
             // Perform a small rotation on the first mesh.
             quat rotation = quat_from_axis_angle((vec3){0, 1, 0}, 0.5f * delta, FALSE);
-            transform_rotate(&app_state->meshes[0].transform, rotation);
+            transform_system_rotate(app_state->meshes[0].transform_handle, rotation);
             
             // Perform a similar rotation on the second mesh, if it exists.
-            transform_rotate(&app_state->meshes[1].transform, rotation);
+            transform_system_rotate(app_state->meshes[1].transform_handle, rotation);
 
             // Perform a similar rotation on the third mesh, if it exists.
-            transform_rotate(&app_state->meshes[2].transform, rotation);
+            transform_system_rotate(app_state->meshes[2].transform_handle, rotation);
+
+            // Everything that moved this frame has moved, so bring the world matrices up to
+            // date once for everything that reads them.
+            transform_system_update();
+            frame_pacing_phase_end(FRAME_PHASE_UPDATE);
 
             // TODO: refactor packet creation
+            frame_pacing_phase_begin(FRAME_PHASE_PACKET_BUILD);
+            TPROFILE_BEGIN("build_render_packet");
             render_packet packet = {};
             packet.delta_time = delta;
 
             // TODO: Read from frame config.
             packet.view_count = 3;
-            render_view_packet views[3];
-            tzero_memory(views, sizeof(render_view_packet) * packet.view_count);
-            packet.views = views;
+            packet.views = frame_allocator_allocate(&app_state->frame_allocator, sizeof(render_view_packet) * packet.view_count);
+            tzero_memory(packet.views, sizeof(render_view_packet) * packet.view_count);
 
             // Skybox
             skybox_packet_data skybox_data = {};
             skybox_data.sb = &app_state->sb;
-            if(!render_view_system_build_packet(render_view_system_get("skybox"), &skybox_data, &packet.views[0])){
+            if(!render_view_system_build_packet(render_view_system_get("skybox"), &app_state->frame_allocator, &skybox_data, &packet.views[0])){
                 TERROR("Failed to build packet for view 'skybox'.");
+                TPROFILE_END();
+                TPROFILE_END();
                 return FALSE;
             }
 
@@ -609,9 +743,8 @@ b8 application_run(){
             mesh_packet_data world_mesh_data = {};
 
             u32 mesh_count = 0;
-            mesh* meshes[10];
-            // TODO: flexible size array
-            for(u32 i = 0; i < 10; ++i){
+            mesh** meshes = frame_allocator_allocate(&app_state->frame_allocator, sizeof(mesh*) * app_state->mesh_count);
+            for(u32 i = 0; i < app_state->mesh_count; ++i){
                 if(app_state->meshes[i].generation != INVALID_ID_U8){
                     meshes[mesh_count] = &app_state->meshes[i];
                     mesh_count++;
@@ -621,18 +754,18 @@ b8 application_run(){
             world_mesh_data.meshes = meshes;
 
             // TODO: performs a lookup on every frame.
-            if(!render_view_system_build_packet(render_view_system_get("world_opaque"), &world_mesh_data, &packet.views[1])){
+            if(!render_view_system_build_packet(render_view_system_get("world_opaque"), &app_state->frame_allocator, &world_mesh_data, &packet.views[1])){
                 TERROR("Failed to build packet for view 'world_opaque'.");
+                TPROFILE_END();
+                TPROFILE_END();
                 return FALSE;
             }
             
             // Ui
             mesh_packet_data ui_mesh_data = {};
             u32 ui_mesh_count = 0;
-            mesh* ui_meshes[10];
-
-            // TODO: flexible size array
-            for(u32 i = 0; i < 10; ++i){
+            mesh** ui_meshes = frame_allocator_allocate(&app_state->frame_allocator, sizeof(mesh*) * app_state->ui_mesh_count);
+            for(u32 i = 0; i < app_state->ui_mesh_count; ++i){
                 if(app_state->ui_meshes[i].generation != INVALID_ID_U8){
                     ui_meshes[ui_mesh_count] = &app_state->ui_meshes[i];
                     ui_mesh_count++;
@@ -641,45 +774,104 @@ b8 application_run(){
             ui_mesh_data.mesh_count = ui_mesh_count;
             ui_mesh_data.meshes = ui_meshes;
 
-            if(!render_view_system_build_packet(render_view_system_get("ui"), &ui_mesh_data, &packet.views[2])){
+            if(!render_view_system_build_packet(render_view_system_get("ui"), &app_state->frame_allocator, &ui_mesh_data, &packet.views[2])){
                 TERROR("Failed to build packet for view 'ui'.");
+                TPROFILE_END();
+                TPROFILE_END();
                 return FALSE;
             }
 
-            renderer_draw_frame(&packet);
-
-            // Figure out how long the frame took and, if below
-            f64 frame_end_time = platform_get_absolute_time();
-            f64 frame_elapsed_time = frame_end_time - frame_start_time;
-            // running_time += frame_elapsed_time;
-            f64 remaining_seconds = target_frame_seconds - frame_elapsed_time;
+            TPROFILE_END();
+            frame_pacing_phase_end(FRAME_PHASE_PACKET_BUILD);
 
-            if(remaining_seconds > 0){
-                u64 remaining_ms = (remaining_seconds * 1000);
-
-                // If there is time left, give it back to the OS.
-                b8 limit_frames = FALSE;
-                if(remaining_ms > 0 && limit_frames){
-                    platform_sleep(remaining_ms - 1);
-                }
-
-                frame_count++;
-            }
+            frame_pacing_phase_begin(FRAME_PHASE_DRAW);
+            renderer_draw_frame(&packet);
+            frame_pacing_phase_end(FRAME_PHASE_DRAW);
 
             // NOTE: Input update/state copying should always be handled
             // after any input should be recorded: I.E. before this line.
             // As a safety, input is the last thing to be updated before
             // this frame ends.
+            frame_pacing_phase_begin(FRAME_PHASE_INPUT);
             input_update(delta);
+            frame_pacing_phase_end(FRAME_PHASE_INPUT);
         
             // Update last time
             app_state->last_time = current_time;
+
+            TPROFILE_END();
+
+            // Hold to the target frame rate, if there is one. Done outside the frame zone
+            // so that waiting does not show up as frame time in traces.
+            frame_pacing_end_frame();
+
+            u64 max_frame_count = app_state->game_inst->app_config.max_frame_count;
+            if(max_frame_count && frame_number >= max_frame_count){
+                TINFO("Ran the requested %llu frames, shutting down.", max_frame_count);
+                app_state->is_running = FALSE;
+            }
+        }else{
+            // Nothing is drawn while suspended, so instead of spinning on the pump, sleep until
+            // the window system has something for us. Waking up every so often anyway keeps job
+            // completion callbacks, and the background loads waiting on them, moving.
+            platform_wait_for_messages(APPLICATION_SUSPENDED_WAIT_MS);
+            job_system_update();
+            app_state->suspended_wakeups++;
         }
     }
 
     app_state->is_running = FALSE;
 
+    // A final summary, mostly for automated runs.
+    TINFO("Ran %llu frames.", frame_number);
+    frame_pacing_log_stats();
+    renderer_backend_stats backend_stats;
+    if(renderer_get_backend_stats(&backend_stats)){
+        TINFO("Renderer backend: %llu calls, %llu frames, %llu renderpasses, %llu draws (%llu instanced copies, %llu elements), %llu shader uses, %llu binds, %llu buffer binds, %llu uniform sets (%llu bytes), %llu bytes uploaded, %u textures, %u geometries.",
+              backend_stats.call_count, backend_stats.frame_count, backend_stats.renderpass_count, backend_stats.draw_count,
+              backend_stats.instance_count, backend_stats.element_count, backend_stats.shader_use_count, backend_stats.bind_count, backend_stats.buffer_bind_count, backend_stats.uniform_set_count,
+              backend_stats.uniform_bytes, backend_stats.bytes_uploaded, backend_stats.texture_count, backend_stats.geometry_count);
+    }
+    renderer_bind_stats frame_bind_stats, total_bind_stats;
+    if(renderer_get_bind_stats(&frame_bind_stats, &total_bind_stats)){
+        TINFO("Renderer binds on the last frame: %llu shader (%llu skipped), %llu instance (%llu skipped), %llu buffer (%llu skipped).",
+              frame_bind_stats.shader_binds, frame_bind_stats.shader_binds_skipped, frame_bind_stats.instance_binds,
+              frame_bind_stats.instance_binds_skipped, frame_bind_stats.buffer_binds, frame_bind_stats.buffer_binds_skipped);
+        TINFO("Renderer binds overall: %llu shader (%llu skipped), %llu instance (%llu skipped), %llu buffer (%llu skipped).",
+              total_bind_stats.shader_binds, total_bind_stats.shader_binds_skipped, total_bind_stats.instance_binds,
+              total_bind_stats.instance_binds_skipped, total_bind_stats.buffer_binds, total_bind_stats.buffer_binds_skipped);
+    }
+    render_view_world_stats world_stats;
+    if(render_view_world_get_stats(render_view_system_get("world_opaque"), &world_stats)){
+        TINFO("World view culling: %u of %u geometries visible on the last frame, %llu of %llu culled overall.",
+              world_stats.visible_count, world_stats.visible_count + world_stats.culled_count,
+              world_stats.total_culled_count, world_stats.total_visible_count + world_stats.total_culled_count);
+        TINFO("World view instancing: %u geometries drawn with %u draw calls on the last frame, %llu with %llu overall.",
+              world_stats.visible_count, world_stats.draw_count,
+              world_stats.total_visible_count, world_stats.total_draw_count);
+    }
+    const char* recorded_view_names[3] = {"skybox", "world_opaque", "ui"};
+    for(u32 i = 0; i < 3; ++i){
+        renderer_view_record_stats record_stats;
+        if(renderer_get_view_record_stats(render_view_system_get(recorded_view_names[i]), &record_stats) && record_stats.frame_count){
+            TINFO("View '%s' recording: %.3f ms on the last frame, %.3f ms on average over %llu frames.",
+                  recorded_view_names[i], record_stats.last_seconds * 1000.0,
+                  record_stats.total_seconds * 1000.0 / record_stats.frame_count, record_stats.frame_count);
+        }
+    }
+
+    renderer_upload_stats upload_stats;
+    if(renderer_get_upload_stats(&upload_stats) && upload_stats.upload_count){
+        TINFO("Renderer uploads: %llu uploads of %.2f MiB in %.3f ms (%.1f MiB/s) over %llu submissions; %llu stalls for %.3f ms; %llu flushes for %.3f ms; staging peak %.2f of %.2f MiB.",
+              upload_stats.upload_count, upload_stats.bytes / (1024.0 * 1024.0), upload_stats.seconds * 1000.0,
+              upload_stats.seconds > 0.0 ? upload_stats.bytes / (1024.0 * 1024.0) / upload_stats.seconds : 0.0,
+              upload_stats.submission_count, upload_stats.stall_count, upload_stats.stall_seconds * 1000.0,
+              upload_stats.flush_count, upload_stats.flush_seconds * 1000.0,
+              upload_stats.staging_peak / (1024.0 * 1024.0), upload_stats.staging_size / (1024.0 * 1024.0));
+    }
+
     event_unregister(EVENT_CODE_APPLICATION_QUIT, 0, application_on_event);
+    event_unregister(EVENT_CODE_PROFILER_CAPTURE, 0, application_on_event);
     event_unregister(EVENT_CODE_KEY_PRESSED, 0, application_on_key);
     event_unregister(EVENT_CODE_KEY_RELEASED, 0, application_on_key);
     // TODO: temp
@@ -687,11 +879,24 @@ b8 application_run(){
     // TODO: end temp
 
 
+    TINFO("Frame allocator peak usage: %llu of %llu bytes per frame.", app_state->frame_allocator.peak_used, app_state->frame_allocator.buffers[0].total_size);
+    frame_allocator_destroy(&app_state->frame_allocator);
+
     // Shuts down systems
+    frame_pacing_shutdown(app_state->frame_pacing_state);
+
+    input_recorder_shutdown(app_state->input_recorder_state);
+
     input_system_shutdown(app_state->input_system_state);
 
+    render_view_system_shutdown(app_state->renderer_view_system_state);
+
+    camera_system_shutdown(app_state->camera_system_state);
+
     geometry_system_shutdown(app_state->geometry_system_state);
 
+    transform_system_shutdown(app_state->transform_system_state);
+
     material_system_shutdown(app_state->material_system_state);
 
     texture_system_shutdown(app_state->texture_system_state);
@@ -713,16 +918,76 @@ b8 application_run(){
 
     event_system_shutdown(app_state->event_system_state);
 
+    profiler_system_shutdown(app_state->profiler_system_state);
+
+    shutdown_logging(app_state->logging_system_state);
+
+#if TMEMORY_TELEMETRY
+    memory_system_write_telemetry("memory_telemetry.json");
+#endif
     memory_system_shutdown();
 
     return TRUE;
 }
 
+b8 application_config_parse_args(application_config* config, i32 argc, char** argv){
+    b8 target_frame_rate_set = FALSE;
+    for(i32 i = 1; i < argc; ++i){
+        const char* value = i + 1 < argc ? argv[i + 1] : 0;
+        b8 parsed = TRUE;
+        if(strings_equal(argv[i], "--headless")){
+            config->headless = TRUE;
+            continue;
+        }else if(strings_equal(argv[i], "--frames") && value){
+            u32 frames = 0;
+            parsed = string_to_u32((char*)value, &frames);
+            config->max_frame_count = frames;
+        }else if(strings_equal(argv[i], "--record") && value){
+            config->record_path = value;
+        }else if(strings_equal(argv[i], "--replay") && value){
+            config->replay_path = value;
+        }else if(strings_equal(argv[i], "--target-fps") && value){
+            parsed = string_to_u32((char*)value, &config->target_frame_rate);
+            target_frame_rate_set = TRUE;
+        }else{
+            parsed = FALSE;
+        }
+
+        if(parsed && config->record_path && config->replay_path){
+            TERROR("--record and --replay cannot be used together.");
+            return FALSE;
+        }
+
+        if(!parsed){
+            TERROR("Unrecognized or invalid argument '%s'.", argv[i]);
+            TINFO("Usage: [--headless] [--frames N] [--target-fps N] [--record FILE | --replay FILE]");
+            TINFO("  --headless    Run without a window or GPU, using the null renderer.");
+            TINFO("  --frames      Shut down after N frames.");
+            TINFO("  --target-fps  Hold the main loop to N frames per second; 0 runs unlimited.");
+            TINFO("  --record      Record input to FILE, written on shutdown.");
+            TINFO("  --replay      Replay the input recorded in FILE at a fixed delta time, then shut down.");
+            return FALSE;
+        }
+        // Skip the value.
+        ++i;
+    }
+
+    if(config->headless && !target_frame_rate_set){
+        config->target_frame_rate = 0;
+    }
+    return TRUE;
+}
+
 void application_get_framebuffer_size(u32* width, u32* height){
     *width = app_state->width;
     *height = app_state->height;
 }
 
+void application_get_frame_memory_usage(u64* out_last_frame, u64* out_peak){
+    *out_last_frame = app_state->frame_allocator.last_frame_used;
+    *out_peak = app_state->frame_allocator.peak_used;
+}
+
 b8 application_on_event(u16 code, void* sender, void* listener_inst, event_context context){
     switch(code){
         case EVENT_CODE_APPLICATION_QUIT:{
@@ -730,6 +995,10 @@ b8 application_on_event(u16 code, void* sender, void* listener_inst, event_conte
             app_state->is_running = FALSE;
             return TRUE;
         }
+        case EVENT_CODE_PROFILER_CAPTURE:{
+            profiler_write_trace("profile.json");
+            return TRUE;
+        }
     }
 
     return FALSE;
@@ -779,11 +1048,17 @@ b8 application_on_resize(u16 code, void* sender, void* listener_inst, event_cont
             if(width == 0 || height == 0){
                 TINFO("Window minimized, suspending application.");
                 app_state->is_suspended = TRUE;
+                app_state->suspended_time = platform_get_absolute_time();
+                app_state->suspended_wakeups = 0;
                 return TRUE;
             }else{
                 if(app_state->is_suspended){
-                    TINFO("Window restored, resuming application.");
+                    f64 suspended_seconds = platform_get_absolute_time() - app_state->suspended_time;
+                    TINFO("Window restored after %.1f seconds, resuming application. The main loop woke %llu times while suspended.",
+                          suspended_seconds, app_state->suspended_wakeups);
                     app_state->is_suspended = FALSE;
+                    // Time spent minimized is not a frame.
+                    frame_pacing_restart_frame();
                 }
                 app_state->game_inst->on_resize(app_state->game_inst, width, height);
                 renderer_on_resized(width, height);
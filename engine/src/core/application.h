@@ -20,10 +20,47 @@ typedef struct application_config{
 
     // The application name used in windowing , if applicable.
     char* name;
+
+    // The frame rate the main loop is held to. 0 runs unlimited.
+    u32 target_frame_rate;
+
+    // Runs without a window or GPU: the platform only delivers synthetic messages queued
+    // through platform_headless.h, and the null renderer backend is used.
+    b8 headless;
+
+    // The number of frames to run before shutting down. 0 runs until closed.
+    u64 max_frame_count;
+
+    // If set, input is recorded to this file, which is written on shutdown.
+    const char* record_path;
+
+    // If set, input recorded to this file is replayed at a fixed delta time instead of
+    // taking live input, and the application shuts down when it runs out.
+    const char* replay_path;
 } application_config;
 
+/**
+ * @brief Overrides the application configuration from the command line. Understands
+ * --headless, --frames N, --target-fps N, --record FILE and --replay FILE. Running headless without --target-fps
+ * runs unlimited, since there is no display to pace to.
+ *
+ * @param config A pointer to the configuration to override.
+ * @param argc The number of arguments.
+ * @param argv The arguments, the first of which is the program name.
+ * @return True on success; false if an argument was not understood.
+ */
+TAPI b8 application_config_parse_args(application_config* config, i32 argc, char** argv);
+
 TAPI b8 application_create(struct game* game_inst);
 
 TAPI b8 application_run();
 
-void application_get_framebuffer_size(u32* width, u32* height);
\ No newline at end of file
+void application_get_framebuffer_size(u32* width, u32* height);
+
+/**
+ * @brief Gets how much of the per-frame transient allocator was used.
+ *
+ * @param out_last_frame A pointer to hold the bytes used by the most recently completed frame.
+ * @param out_peak A pointer to hold the most bytes used by any frame so far.
+ */
+TAPI void application_get_frame_memory_usage(u64* out_last_frame, u64* out_peak);
\ No newline at end of file
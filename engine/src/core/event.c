@@ -36,7 +36,7 @@ void event_system_initialize(u64* memory_requirement, void* state){
     state_ptr = state;
 }
 
-void event_system_shutdown(){
+void event_system_shutdown(void* state){
     if(state_ptr){
         // Free the events array. And objects pointed to should be destroyed on their own.
         for(u16 i = 0; i < MAX_MESSAGE_CODES; ++i){
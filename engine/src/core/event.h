@@ -25,8 +25,8 @@ typedef struct event_context{
 // Should return true if handled.
 typedef b8 (*PFN_on_event)(u16 code, void* sender, void* listener_inst, event_context data);
 
-void event_system_initialize();
-void event_system_shutdown();
+TAPI void event_system_initialize(u64* memory_requirement, void* state);
+TAPI void event_system_shutdown(void* state);
 
 /**
  * Register to listen for when events are sent with the provided code. Events with duplicate
@@ -113,6 +113,10 @@ typedef enum system_event_code {
      */
     EVENT_CODE_SET_RENDER_MODE = 0x0A,
 
+    // Writes the profiler's recorded zones out as a Chrome trace.
+    /** Context usage: none. */
+    EVENT_CODE_PROFILER_CAPTURE = 0x0B,
+
     EVENT_CODE_DEBUG0 = 0x10,
     EVENT_CODE_DEBUG1 = 0x11,
     EVENT_CODE_DEBUG2 = 0x12,
@@ -0,0 +1,238 @@
+#include "frame_pacing.h"
+
+#include "core/logger.h"
+#include "core/tmemory.h"
+#include "core/tatomic.h"
+#include "platform/platform.h"
+
+/** Everything recorded about one frame. */
+typedef struct frame_sample {
+    u64 frame_ns;
+    u64 phase_ns[FRAME_PHASE_COUNT];
+    u64 wait_ns;
+    b8 hitch;
+} frame_sample;
+
+typedef struct frame_pacing_state {
+    frame_pacing_config config;
+    // 0 when unlimited.
+    u64 target_ns;
+    // When the current frame started, which is when the previous one ended.
+    u64 frame_start_ns;
+    // When the current frame should end. Advanced by target_ns every frame so that
+    // the average rate stays on target even though individual wakeups are late.
+    u64 deadline_ns;
+    u64 phase_start_ns[FRAME_PHASE_COUNT];
+    u64 phase_ns[FRAME_PHASE_COUNT];
+
+    // A ring of the most recent frames, with running totals so the mean is always cheap.
+    frame_sample samples[FRAME_PACING_WINDOW];
+    u32 sample_count;
+    u32 next_sample;
+    u64 window_frame_ns;
+    u64 total_frames;
+
+    u64 last_log_ns;
+    // Room to sort the window's frame times without allocating.
+    u64 sorted_ns[FRAME_PACING_WINDOW];
+} frame_pacing_state;
+
+static frame_pacing_state* state_ptr;
+
+TINLINE u64 now_ns(){
+    return (u64)(platform_get_absolute_time() * 1000000000.0);
+}
+
+TINLINE f64 ns_to_ms(f64 ns){
+    return ns / 1000000.0;
+}
+
+b8 frame_pacing_initialize(u64* memory_requirement, void* state, frame_pacing_config config){
+    *memory_requirement = sizeof(frame_pacing_state);
+    if(state == 0){
+        return TRUE;
+    }
+
+    state_ptr = state;
+    tzero_memory(state_ptr, sizeof(frame_pacing_state));
+    state_ptr->config = config;
+    frame_pacing_set_target_frame_rate(config.target_frame_rate);
+    frame_pacing_restart_frame();
+    state_ptr->last_log_ns = state_ptr->frame_start_ns;
+    return TRUE;
+}
+
+void frame_pacing_shutdown(void* state){
+    state_ptr = 0;
+}
+
+void frame_pacing_set_target_frame_rate(u32 frames_per_second){
+    if(!state_ptr){
+        return;
+    }
+    state_ptr->config.target_frame_rate = frames_per_second;
+    state_ptr->target_ns = frames_per_second ? 1000000000ull / frames_per_second : 0;
+    state_ptr->deadline_ns = state_ptr->frame_start_ns + state_ptr->target_ns;
+}
+
+void frame_pacing_restart_frame(){
+    if(!state_ptr){
+        return;
+    }
+    state_ptr->frame_start_ns = now_ns();
+    state_ptr->deadline_ns = state_ptr->frame_start_ns + state_ptr->target_ns;
+    tzero_memory(state_ptr->phase_ns, sizeof(state_ptr->phase_ns));
+}
+
+void frame_pacing_phase_begin(frame_phase phase){
+    if(state_ptr){
+        state_ptr->phase_start_ns[phase] = now_ns();
+    }
+}
+
+void frame_pacing_phase_end(frame_phase phase){
+    if(state_ptr){
+        state_ptr->phase_ns[phase] += now_ns() - state_ptr->phase_start_ns[phase];
+    }
+}
+
+/** Waits until the deadline; sleeps while that is safely in the future, then spins. Returns the time afterwards. */
+static u64 wait_until(u64 deadline_ns){
+    u64 spin_ns = (u64)(state_ptr->config.spin_milliseconds * 1000000.0);
+    u64 now = now_ns();
+    while(now < deadline_ns){
+        u64 remaining = deadline_ns - now;
+        if(remaining > spin_ns + 1000000){
+            // The platform sleeps in whole milliseconds, and may overshoot by up to spin_ns.
+            platform_sleep((remaining - spin_ns) / 1000000);
+        }else{
+            tatomic_pause();
+        }
+        now = now_ns();
+    }
+    return now;
+}
+
+/** Sorts the window's frame times into sorted_ns, smallest first. */
+static void sort_window(){
+    u32 count = state_ptr->sample_count;
+    u64* sorted = state_ptr->sorted_ns;
+    for(u32 i = 0; i < count; ++i){
+        u64 value = state_ptr->samples[i].frame_ns;
+        u32 j = i;
+        while(j > 0 && sorted[j - 1] > value){
+            sorted[j] = sorted[j - 1];
+            --j;
+        }
+        sorted[j] = value;
+    }
+}
+
+/** Nearest-rank percentile of the sorted window. */
+static u64 percentile(u32 percent){
+    u32 rank = (state_ptr->sample_count * percent + 99) / 100;
+    return state_ptr->sorted_ns[rank > 0 ? rank - 1 : 0];
+}
+
+void frame_pacing_log_stats(){
+    frame_stats stats;
+    if(!frame_pacing_get_stats(&stats)){
+        return;
+    }
+    TINFO("Frame times over %u frames: mean %.2fms, p50 %.2fms, p95 %.2fms, p99 %.2fms, max %.2fms, %u hitches.",
+          stats.frame_count, stats.mean_ms, stats.p50_ms, stats.p95_ms, stats.p99_ms, stats.max_ms, stats.hitch_count);
+    TINFO("Frame phases: update %.2fms, packet build %.2fms, draw %.2fms, input %.2fms, waiting %.2fms.",
+          stats.phase_mean_ms[FRAME_PHASE_UPDATE], stats.phase_mean_ms[FRAME_PHASE_PACKET_BUILD],
+          stats.phase_mean_ms[FRAME_PHASE_DRAW], stats.phase_mean_ms[FRAME_PHASE_INPUT], stats.wait_mean_ms);
+}
+
+void frame_pacing_end_frame(){
+    if(!state_ptr){
+        return;
+    }
+
+    u64 wait_start = now_ns();
+    u64 frame_end = wait_start;
+    if(state_ptr->target_ns){
+        frame_end = wait_until(state_ptr->deadline_ns);
+    }
+
+    // What a frame is expected to take; the running mean when there is no target.
+    u64 expected_ns = state_ptr->target_ns;
+    if(!expected_ns && state_ptr->sample_count){
+        expected_ns = state_ptr->window_frame_ns / state_ptr->sample_count;
+    }
+
+    // Replace the oldest frame in the window.
+    frame_sample* sample = &state_ptr->samples[state_ptr->next_sample];
+    if(state_ptr->sample_count == FRAME_PACING_WINDOW){
+        state_ptr->window_frame_ns -= sample->frame_ns;
+    }else{
+        state_ptr->sample_count++;
+    }
+    state_ptr->next_sample = (state_ptr->next_sample + 1) % FRAME_PACING_WINDOW;
+
+    sample->frame_ns = frame_end - state_ptr->frame_start_ns;
+    sample->wait_ns = frame_end - wait_start;
+    tcopy_memory(sample->phase_ns, state_ptr->phase_ns, sizeof(sample->phase_ns));
+    sample->hitch = expected_ns && sample->frame_ns > (u64)(expected_ns * FRAME_PACING_HITCH_FACTOR);
+    state_ptr->window_frame_ns += sample->frame_ns;
+    state_ptr->total_frames++;
+
+    // Start the next frame. If this one ran so long that the next deadline has already
+    // passed, start the schedule over rather than rushing frames out to catch up.
+    state_ptr->frame_start_ns = frame_end;
+    state_ptr->deadline_ns += state_ptr->target_ns;
+    if(state_ptr->deadline_ns < frame_end){
+        state_ptr->deadline_ns = frame_end + state_ptr->target_ns;
+    }
+    tzero_memory(state_ptr->phase_ns, sizeof(state_ptr->phase_ns));
+
+    if(state_ptr->config.log_interval_seconds > 0){
+        u64 log_interval_ns = (u64)(state_ptr->config.log_interval_seconds * 1000000000.0);
+        if(frame_end - state_ptr->last_log_ns >= log_interval_ns){
+            state_ptr->last_log_ns = frame_end;
+            frame_pacing_log_stats();
+        }
+    }
+}
+
+b8 frame_pacing_get_stats(frame_stats* out_stats){
+    if(!state_ptr){
+        return FALSE;
+    }
+
+    tzero_memory(out_stats, sizeof(frame_stats));
+    out_stats->frame_count = state_ptr->sample_count;
+    out_stats->total_frames = state_ptr->total_frames;
+    if(state_ptr->sample_count == 0){
+        return TRUE;
+    }
+
+    u64 phase_total[FRAME_PHASE_COUNT] = {0};
+    u64 wait_total = 0;
+    for(u32 i = 0; i < state_ptr->sample_count; ++i){
+        frame_sample* sample = &state_ptr->samples[i];
+        for(u32 p = 0; p < FRAME_PHASE_COUNT; ++p){
+            phase_total[p] += sample->phase_ns[p];
+        }
+        wait_total += sample->wait_ns;
+        if(sample->hitch){
+            out_stats->hitch_count++;
+        }
+    }
+
+    f64 count = (f64)state_ptr->sample_count;
+    for(u32 p = 0; p < FRAME_PHASE_COUNT; ++p){
+        out_stats->phase_mean_ms[p] = ns_to_ms(phase_total[p] / count);
+    }
+    out_stats->wait_mean_ms = ns_to_ms(wait_total / count);
+    out_stats->mean_ms = ns_to_ms(state_ptr->window_frame_ns / count);
+
+    sort_window();
+    out_stats->p50_ms = ns_to_ms((f64)percentile(50));
+    out_stats->p95_ms = ns_to_ms((f64)percentile(95));
+    out_stats->p99_ms = ns_to_ms((f64)percentile(99));
+    out_stats->max_ms = ns_to_ms((f64)state_ptr->sorted_ns[state_ptr->sample_count - 1]);
+    return TRUE;
+}
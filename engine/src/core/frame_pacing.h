@@ -0,0 +1,124 @@
+/**
+ * @file frame_pacing.h
+ * @brief Frame pacing and frame-time statistics. Holds the main loop to a target frame
+ * rate by sleeping for most of the remaining time and spinning for the rest, and keeps
+ * a rolling window of frame times, split into phases, from which percentiles and hitch
+ * counts can be queried. Only the main thread should call into it.
+ */
+
+#pragma once
+
+#include "defines.h"
+
+/** @brief The number of most recent frames that statistics are taken over. */
+#define FRAME_PACING_WINDOW 600
+
+/** @brief Frames taking longer than this many times the expected frame time count as hitches. */
+#define FRAME_PACING_HITCH_FACTOR 2.0
+
+/** @brief The parts of a frame that are timed separately. */
+typedef enum frame_phase {
+    /** @brief Job system and game update and render. */
+    FRAME_PHASE_UPDATE,
+    /** @brief Building the render packet. */
+    FRAME_PHASE_PACKET_BUILD,
+    /** @brief Handing the packet to the renderer. */
+    FRAME_PHASE_DRAW,
+    /** @brief Input state update at the end of the frame. */
+    FRAME_PHASE_INPUT,
+
+    FRAME_PHASE_COUNT
+} frame_phase;
+
+typedef struct frame_pacing_config {
+    /** @brief The frame rate to hold the loop to. 0 runs unlimited. */
+    u32 target_frame_rate;
+    /**
+     * @brief How long before the deadline to stop sleeping and start spinning, in milliseconds.
+     * Should cover the platform's sleep overshoot; more is more precise but burns more CPU.
+     */
+    f64 spin_milliseconds;
+    /** @brief How often the statistics are logged, in seconds. 0 disables logging. */
+    f64 log_interval_seconds;
+} frame_pacing_config;
+
+/** @brief Statistics over the most recent FRAME_PACING_WINDOW frames. All times are in milliseconds. */
+typedef struct frame_stats {
+    /** @brief The number of frames the statistics cover. */
+    u32 frame_count;
+    /** @brief The number of frames recorded since initialization. */
+    u64 total_frames;
+    f64 mean_ms;
+    f64 p50_ms;
+    f64 p95_ms;
+    f64 p99_ms;
+    f64 max_ms;
+    /** @brief The number of frames in the window that took more than FRAME_PACING_HITCH_FACTOR times the expected frame time. */
+    u32 hitch_count;
+    /** @brief The mean time spent in each phase per frame. */
+    f64 phase_mean_ms[FRAME_PHASE_COUNT];
+    /** @brief The mean time spent waiting for the target frame rate per frame. */
+    f64 wait_mean_ms;
+} frame_stats;
+
+/**
+ * @brief Initializes frame pacing. Call twice; once with state = 0 to get the required memory size,
+ * then a second time passing allocated memory to state.
+ *
+ * @param memory_requirement A pointer to hold the required memory size of internal state.
+ * @param state 0 if just requesting memory requirement, otherwise allocated block of memory.
+ * @param config The initial configuration.
+ * @return True on success; otherwise false.
+ */
+TAPI b8 frame_pacing_initialize(u64* memory_requirement, void* state, frame_pacing_config config);
+
+/**
+ * @brief Shuts frame pacing down.
+ *
+ * @param state The block of state memory.
+ */
+TAPI void frame_pacing_shutdown(void* state);
+
+/**
+ * @brief Changes the target frame rate.
+ *
+ * @param frames_per_second The frame rate to hold the loop to. 0 runs unlimited.
+ */
+TAPI void frame_pacing_set_target_frame_rate(u32 frames_per_second);
+
+/**
+ * @brief Starts timing a new frame from now, so that time since the previous frame is not
+ * recorded. Call before the first frame and after any pause, such as being suspended.
+ */
+TAPI void frame_pacing_restart_frame();
+
+/**
+ * @brief Starts timing a phase of the current frame. A phase may be entered more than once per frame.
+ *
+ * @param phase The phase being entered.
+ */
+TAPI void frame_pacing_phase_begin(frame_phase phase);
+
+/**
+ * @brief Stops timing a phase started with frame_pacing_phase_begin.
+ *
+ * @param phase The phase being left.
+ */
+TAPI void frame_pacing_phase_end(frame_phase phase);
+
+/**
+ * @brief Ends the current frame. Waits until the target frame time has passed if there is
+ * a target, then records the frame and starts the next one.
+ */
+TAPI void frame_pacing_end_frame();
+
+/**
+ * @brief Gets statistics over the most recent frames.
+ *
+ * @param out_stats A pointer to hold the statistics.
+ * @return True on success; false if frame pacing is not initialized.
+ */
+TAPI b8 frame_pacing_get_stats(frame_stats* out_stats);
+
+/** @brief Logs the statistics over the most recent frames. */
+TAPI void frame_pacing_log_stats();
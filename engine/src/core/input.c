@@ -2,6 +2,7 @@
 #include "core/event.h"
 #include "core/tmemory.h"
 #include "core/logger.h"
+#include "core/input_recorder.h"
 
 typedef struct keyboard_state{
     b8 keys[256];
@@ -51,8 +52,10 @@ void input_update(f64 delta_time){
 }
 
 void input_process_key(keys key, b8 pressed){
+    if(!input_recorder_accept_key(key, pressed)){
+        return;
+    }
 
-    
     // Only handle this if the state actually changed.
     if(state_ptr && state_ptr->keyboard_current.keys[key] != pressed){
         // Update internal state_ptr->
@@ -85,6 +88,10 @@ void input_process_key(keys key, b8 pressed){
 }
 
 void input_process_button(buttons button, b8 pressed){
+    if(!input_recorder_accept_button(button, pressed)){
+        return;
+    }
+
     // If the state changed, fire an event.
     if(state_ptr->mouse_current.buttons[button] != pressed){
         state_ptr->mouse_current.buttons[button] = pressed;
@@ -97,6 +104,10 @@ void input_process_button(buttons button, b8 pressed){
 }
 
 void input_process_mouse_move(i16 x, i16 y){
+    if(!input_recorder_accept_mouse_move(x, y)){
+        return;
+    }
+
     // Only process if actually different
     if(state_ptr->mouse_current.x != x || state_ptr->mouse_current.y != y){
         // NOTE: Enable this if debugging.
@@ -115,6 +126,10 @@ void input_process_mouse_move(i16 x, i16 y){
 }
 
 void input_process_mouse_wheel(i8 z_delta){
+    if(!input_recorder_accept_mouse_wheel(z_delta)){
+        return;
+    }
+
     // NOTE: No internal state update.
 
     // Fire the event.
@@ -153,9 +153,9 @@ typedef enum keys{
     KEYS_MAX_KEYS
 } keys;
 
-void input_system_initialize(u64* memory_requirement, void* state);
-void input_system_shutdown(void* state);
-void input_update(f64 delta_time);
+TAPI void input_system_initialize(u64* memory_requirement, void* state);
+TAPI void input_system_shutdown(void* state);
+TAPI void input_update(f64 delta_time);
 
 // Keyboard input
 TAPI b8 input_is_key_down(keys key);
@@ -163,16 +163,16 @@ TAPI b8 input_is_key_up(keys key);
 TAPI b8 input_was_key_down(keys key);
 TAPI b8 input_was_key_up(keys key);
 
-void input_process_key(keys key, b8 pressed);
+TAPI void input_process_key(keys key, b8 pressed);
 
 // Mouse input
 TAPI b8 input_is_button_down(buttons button);
 TAPI b8 input_is_button_up(buttons button);
 TAPI b8 input_was_button_down(buttons button);
 TAPI b8 input_was_button_up(buttons button);
-TAPI void input_get_mouse_posisition(i32* x, i32* y);
+TAPI void input_get_mouse_position(i32* x, i32* y);
 TAPI void input_get_previous_mouse_position(i32* x, i32* y);
 
-void input_process_button(buttons button, b8 pressed);
-void input_process_mouse_move(i16 x, i16 y);
-void input_process_mouse_wheel(i8 z_delta);
\ No newline at end of file
+TAPI void input_process_button(buttons button, b8 pressed);
+TAPI void input_process_mouse_move(i16 x, i16 y);
+TAPI void input_process_mouse_wheel(i8 z_delta);
\ No newline at end of file
@@ -0,0 +1,284 @@
+#include "input_recorder.h"
+
+#include "core/event.h"
+#include "core/logger.h"
+#include "core/tmemory.h"
+#include "core/tstring.h"
+#include "containers/darray.h"
+#include "platform/filesystem.h"
+
+// Used when a recording is too short to have a meaningful mean frame time.
+#define INPUT_RECORDER_DEFAULT_DELTA_TIME (1.0 / 60.0)
+
+typedef struct input_recorder_state {
+    // The frame about to run, counted from when recording or replay started.
+    u32 frame;
+
+    b8 recording;
+    char* record_path;
+    // darray of everything recorded so far.
+    input_record* records;
+    f64 recorded_seconds;
+
+    b8 replaying;
+    // Set while the recorder itself is delivering input, so that it gets through.
+    b8 injecting;
+    input_record* replay_records;
+    u32 replay_record_count;
+    u32 replay_frame_count;
+    u32 replay_next;
+    f64 fixed_delta_time;
+} input_recorder_state;
+
+static input_recorder_state* state_ptr;
+
+static b8 on_resized(u16 code, void* sender, void* listener_inst, event_context context);
+
+b8 input_recorder_initialize(u64* memory_requirement, void* state){
+    *memory_requirement = sizeof(input_recorder_state);
+    if(state == 0){
+        return TRUE;
+    }
+    state_ptr = state;
+    tzero_memory(state_ptr, sizeof(input_recorder_state));
+
+    // Listen from the start, ahead of anything registered later which may handle resizes
+    // and stop them from going further, such as the application on minimize.
+    event_register(EVENT_CODE_RESIZED, state_ptr, on_resized);
+    return TRUE;
+}
+
+void input_recorder_shutdown(void* state){
+    if(state_ptr){
+        if(state_ptr->recording){
+            input_recorder_stop_recording();
+        }
+        input_recorder_stop_replay();
+        event_unregister(EVENT_CODE_RESIZED, state_ptr, on_resized);
+    }
+    state_ptr = 0;
+}
+
+b8 input_recorder_start_recording(const char* path){
+    if(!state_ptr || !path){
+        return FALSE;
+    }
+    if(state_ptr->recording || state_ptr->replaying){
+        TERROR("input_recorder_start_recording: already recording or replaying.");
+        return FALSE;
+    }
+
+    state_ptr->record_path = string_duplicate(path);
+    state_ptr->records = darray_create(input_record);
+    state_ptr->recorded_seconds = 0;
+    state_ptr->frame = 0;
+    state_ptr->recording = TRUE;
+    TINFO("Recording input to '%s'.", path);
+    return TRUE;
+}
+
+b8 input_recorder_stop_recording(){
+    if(!state_ptr || !state_ptr->recording){
+        return FALSE;
+    }
+    state_ptr->recording = FALSE;
+
+    input_recording_header header;
+    header.magic = INPUT_RECORDING_MAGIC;
+    header.version = INPUT_RECORDING_VERSION;
+    header.frame_count = state_ptr->frame;
+    header.record_count = darray_length(state_ptr->records);
+    header.duration_seconds = state_ptr->recorded_seconds;
+
+    b8 written = FALSE;
+    file_handle handle;
+    if(filesystem_open(state_ptr->record_path, FILE_MODE_WRITE, TRUE, &handle)){
+        u64 bytes_written = 0;
+        written = filesystem_write(&handle, sizeof(header), &header, &bytes_written);
+        if(written && header.record_count){
+            written = filesystem_write(&handle, sizeof(input_record) * header.record_count, state_ptr->records, &bytes_written);
+        }
+        filesystem_close(&handle);
+    }
+
+    if(written){
+        TINFO("Recorded %u frames (%u inputs, %.1f seconds) to '%s'.",
+              header.frame_count, header.record_count, header.duration_seconds, state_ptr->record_path);
+    }else{
+        TERROR("Failed to write input recording to '%s'.", state_ptr->record_path);
+    }
+
+    darray_destroy(state_ptr->records);
+    state_ptr->records = 0;
+    tfree(state_ptr->record_path, string_length(state_ptr->record_path) + 1, MEMORY_TAG_STRING);
+    state_ptr->record_path = 0;
+    return written;
+}
+
+b8 input_recorder_start_replay(const char* path, f64 fixed_delta_time){
+    if(!state_ptr || !path){
+        return FALSE;
+    }
+    if(state_ptr->recording || state_ptr->replaying){
+        TERROR("input_recorder_start_replay: already recording or replaying.");
+        return FALSE;
+    }
+
+    file_handle handle;
+    if(!filesystem_open(path, FILE_MODE_READ, TRUE, &handle)){
+        TERROR("Unable to open input recording '%s'.", path);
+        return FALSE;
+    }
+
+    input_recording_header header;
+    u64 bytes_read = 0;
+    if(!filesystem_read(&handle, sizeof(header), &header, &bytes_read) || bytes_read != sizeof(header) ||
+       header.magic != INPUT_RECORDING_MAGIC || header.version != INPUT_RECORDING_VERSION){
+        TERROR("'%s' is not an input recording this build can replay.", path);
+        filesystem_close(&handle);
+        return FALSE;
+    }
+
+    input_record* records = 0;
+    if(header.record_count){
+        u64 size = sizeof(input_record) * header.record_count;
+        records = tallocate(size, MEMORY_TAG_ARRAY);
+        if(!filesystem_read(&handle, size, records, &bytes_read) || bytes_read != size){
+            TERROR("Input recording '%s' is truncated.", path);
+            tfree(records, size, MEMORY_TAG_ARRAY);
+            filesystem_close(&handle);
+            return FALSE;
+        }
+    }
+    filesystem_close(&handle);
+
+    if(fixed_delta_time <= 0){
+        fixed_delta_time = header.frame_count && header.duration_seconds > 0
+                               ? header.duration_seconds / header.frame_count
+                               : INPUT_RECORDER_DEFAULT_DELTA_TIME;
+    }
+
+    state_ptr->replay_records = records;
+    state_ptr->replay_record_count = header.record_count;
+    state_ptr->replay_frame_count = header.frame_count;
+    state_ptr->replay_next = 0;
+    state_ptr->fixed_delta_time = fixed_delta_time;
+    state_ptr->frame = 0;
+    state_ptr->replaying = TRUE;
+    TINFO("Replaying %u frames (%u inputs) from '%s' at a fixed %.3fms per frame.",
+          header.frame_count, header.record_count, path, fixed_delta_time * 1000.0);
+    return TRUE;
+}
+
+void input_recorder_stop_replay(){
+    if(!state_ptr || !state_ptr->replaying){
+        return;
+    }
+    if(state_ptr->replay_records){
+        tfree(state_ptr->replay_records, sizeof(input_record) * state_ptr->replay_record_count, MEMORY_TAG_ARRAY);
+        state_ptr->replay_records = 0;
+    }
+    state_ptr->replaying = FALSE;
+}
+
+b8 input_recorder_is_replaying(){
+    return state_ptr && state_ptr->replaying;
+}
+
+static void deliver(const input_record* record){
+    switch(record->type){
+        case INPUT_RECORD_TYPE_KEY:
+            input_process_key((keys)record->code, record->pressed);
+            break;
+        case INPUT_RECORD_TYPE_BUTTON:
+            input_process_button((buttons)record->code, record->pressed);
+            break;
+        case INPUT_RECORD_TYPE_MOUSE_MOVE:
+            input_process_mouse_move(record->x, record->y);
+            break;
+        case INPUT_RECORD_TYPE_MOUSE_WHEEL:
+            input_process_mouse_wheel((i8)record->x);
+            break;
+        case INPUT_RECORD_TYPE_RESIZE:{
+            event_context context;
+            context.data.u16[0] = (u16)record->x;
+            context.data.u16[1] = (u16)record->y;
+            event_fire(EVENT_CODE_RESIZED, 0, context);
+        }break;
+        default:
+            TWARN("Skipping unknown input record type %u.", record->type);
+            break;
+    }
+}
+
+b8 input_recorder_begin_frame(f64* delta_time){
+    if(!state_ptr){
+        return TRUE;
+    }
+
+    if(state_ptr->replaying){
+        if(state_ptr->frame >= state_ptr->replay_frame_count){
+            TINFO("Input replay finished after %u frames.", state_ptr->frame);
+            input_recorder_stop_replay();
+            return FALSE;
+        }
+
+        state_ptr->injecting = TRUE;
+        while(state_ptr->replay_next < state_ptr->replay_record_count &&
+              state_ptr->replay_records[state_ptr->replay_next].frame <= state_ptr->frame){
+            deliver(&state_ptr->replay_records[state_ptr->replay_next]);
+            state_ptr->replay_next++;
+        }
+        state_ptr->injecting = FALSE;
+        *delta_time = state_ptr->fixed_delta_time;
+    }else if(state_ptr->recording){
+        state_ptr->recorded_seconds += *delta_time;
+    }
+
+    state_ptr->frame++;
+    return TRUE;
+}
+
+/** Records the input if recording. Returns false if it should be dropped. */
+static b8 accept(input_record_type type, u16 code, b8 pressed, i16 x, i16 y){
+    if(!state_ptr){
+        return TRUE;
+    }
+    if(state_ptr->replaying){
+        return state_ptr->injecting;
+    }
+    if(state_ptr->recording){
+        input_record record;
+        record.frame = state_ptr->frame;
+        record.type = (u8)type;
+        record.pressed = pressed;
+        record.code = code;
+        record.x = x;
+        record.y = y;
+        darray_push(state_ptr->records, record);
+    }
+    return TRUE;
+}
+
+b8 input_recorder_accept_key(keys key, b8 pressed){
+    return accept(INPUT_RECORD_TYPE_KEY, (u16)key, pressed, 0, 0);
+}
+
+b8 input_recorder_accept_button(buttons button, b8 pressed){
+    return accept(INPUT_RECORD_TYPE_BUTTON, (u16)button, pressed, 0, 0);
+}
+
+b8 input_recorder_accept_mouse_move(i16 x, i16 y){
+    return accept(INPUT_RECORD_TYPE_MOUSE_MOVE, 0, FALSE, x, y);
+}
+
+b8 input_recorder_accept_mouse_wheel(i8 z_delta){
+    return accept(INPUT_RECORD_TYPE_MOUSE_WHEEL, 0, FALSE, z_delta, 0);
+}
+
+static b8 on_resized(u16 code, void* sender, void* listener_inst, event_context context){
+    // Only kept while recording.
+    accept(INPUT_RECORD_TYPE_RESIZE, 0, FALSE, (i16)context.data.u16[0], (i16)context.data.u16[1]);
+    // Let everyone else see it too.
+    return FALSE;
+}
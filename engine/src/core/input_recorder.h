@@ -0,0 +1,122 @@
+/**
+ * @file input_recorder.h
+ * @brief Records the input the platform delivers, frame by frame, to a compact binary file,
+ * and replays it frame-accurately with a fixed delta time, so that the same run can be
+ * repeated exactly when comparing builds. Keys, mouse buttons, mouse moves, mouse wheel
+ * and window resizes are captured. While replaying, live input is ignored; live window
+ * resizes still reach the application. Only the main thread should call into it.
+ */
+
+#pragma once
+
+#include "defines.h"
+#include "core/input.h"
+
+/** @brief Identifies an input recording file. */
+#define INPUT_RECORDING_MAGIC 0x524E4954 // "TINR"
+/** @brief Bumped whenever the file layout changes. */
+#define INPUT_RECORDING_VERSION 1
+
+/** @brief The header at the start of every input recording file. */
+typedef struct input_recording_header {
+    u32 magic;
+    u32 version;
+    /** @brief The number of frames the recording covers. */
+    u32 frame_count;
+    /** @brief The number of input_records following the header. */
+    u32 record_count;
+    /** @brief The wall-clock time the recording covers, in seconds. */
+    f64 duration_seconds;
+} input_recording_header;
+
+/** @brief The kinds of input that are recorded. */
+typedef enum input_record_type {
+    INPUT_RECORD_TYPE_KEY,
+    INPUT_RECORD_TYPE_BUTTON,
+    INPUT_RECORD_TYPE_MOUSE_MOVE,
+    INPUT_RECORD_TYPE_MOUSE_WHEEL,
+    INPUT_RECORD_TYPE_RESIZE
+} input_record_type;
+
+/** @brief One recorded input, stamped with the frame it was delivered before. */
+typedef struct input_record {
+    u32 frame;
+    /** @brief An input_record_type. */
+    u8 type;
+    /** @brief For keys and buttons, whether it was pressed. */
+    u8 pressed;
+    /** @brief For keys and buttons, which one. */
+    u16 code;
+    /** @brief The mouse x position, wheel delta or new width. */
+    i16 x;
+    /** @brief The mouse y position or new height. */
+    i16 y;
+} input_record;
+
+/**
+ * @brief Initializes the input recorder. Call twice; once with state = 0 to get the required memory size,
+ * then a second time passing allocated memory to state.
+ *
+ * @param memory_requirement A pointer to hold the required memory size of internal state.
+ * @param state 0 if just requesting memory requirement, otherwise allocated block of memory.
+ * @return True on success; otherwise false.
+ */
+TAPI b8 input_recorder_initialize(u64* memory_requirement, void* state);
+
+/**
+ * @brief Shuts the input recorder down, writing out any recording in progress.
+ *
+ * @param state The block of state memory.
+ */
+TAPI void input_recorder_shutdown(void* state);
+
+/**
+ * @brief Starts recording input. It is written to the file when recording stops.
+ *
+ * @param path The path of the file to record to.
+ * @return True on success; otherwise false.
+ */
+TAPI b8 input_recorder_start_recording(const char* path);
+
+/**
+ * @brief Stops recording and writes the recording to the file given when it started.
+ *
+ * @return True if the file was written; otherwise false.
+ */
+TAPI b8 input_recorder_stop_recording();
+
+/**
+ * @brief Loads a recording and starts replaying it from the next frame.
+ *
+ * @param path The path of the recording.
+ * @param fixed_delta_time The delta time every replayed frame reports, in seconds. 0 uses
+ * the recording's mean frame time.
+ * @return True on success; otherwise false.
+ */
+TAPI b8 input_recorder_start_replay(const char* path, f64 fixed_delta_time);
+
+/** @brief Stops replaying and hands input back to the platform. */
+TAPI void input_recorder_stop_replay();
+
+/** @brief Indicates if a recording is being replayed. */
+TAPI b8 input_recorder_is_replaying();
+
+/**
+ * @brief Marks the start of a frame's update. Call once per frame, after messages have been
+ * pumped and before anything reads input. When replaying, delivers the frame's recorded input
+ * and replaces the delta time with the fixed one.
+ *
+ * @param delta_time A pointer to the frame's delta time, in seconds.
+ * @return False if a replay has run out of frames, in which case the frame should not run; otherwise true.
+ */
+TAPI b8 input_recorder_begin_frame(f64* delta_time);
+
+/*
+ * Hooks for the input system, called with everything the platform delivers. Each records the
+ * input when recording, and returns false if the input should be dropped because a recording
+ * is being replayed.
+ */
+b8 input_recorder_accept_key(keys key, b8 pressed);
+b8 input_recorder_accept_button(buttons button, b8 pressed);
+b8 input_recorder_accept_mouse_move(i16 x, i16 y);
+b8 input_recorder_accept_mouse_wheel(i8 z_delta);
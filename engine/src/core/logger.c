@@ -4,87 +4,646 @@
 #include "platform/filesystem.h"
 #include "core/tstring.h"
 #include "core/tmemory.h"
+#include "core/tatomic.h"
+#include "core/tthread.h"
+#include "core/tsemaphore.h"
+#include "containers/mpsc_queue.h"
 
-// TODO: temporary
 #include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/** @brief The size of one queued log record, including its header. */
+#define LOG_RECORD_SIZE 256
+/** @brief The number of records that can be waiting for the flush thread at once. */
+#define LOG_RECORD_CAPACITY 4096
+/** @brief The longest line the flush thread formats. Longer ones are cut short and marked. */
+#define LOG_LINE_SIZE 2048
+/** @brief The size of the buffer that log file writes are batched in. */
+#define LOG_FILE_BATCH_SIZE (64 * 1024)
+/** @brief How long the flush thread sleeps when idle before checking for records anyway. */
+#define LOG_FLUSH_INTERVAL_MS 100
+
+/**
+ * @brief A message waiting to be written. The caller only copies the format string and
+ * the raw arguments into the queue slot; formatting, console output and file writes are
+ * all left to the flush thread.
+ */
+typedef struct log_record {
+    u8 level;
+    // Set when data holds a pointer to a whole line the caller formatted itself, because
+    // its arguments did not fit. The flush thread frees it once written.
+    u8 preformatted;
+    // The format string, including its terminator, followed by the arguments in the order
+    // the format uses them. See capture_arguments.
+    char data[LOG_RECORD_SIZE - sizeof(u16)];
+} log_record;
+
+/** @brief How an argument is read from the caller's va_list and passed back to snprintf. */
+typedef enum log_argument_type {
+    LOG_ARGUMENT_NONE,
+    LOG_ARGUMENT_INT,
+    LOG_ARGUMENT_LONG,
+    LOG_ARGUMENT_LONG_LONG,
+    LOG_ARGUMENT_INTMAX,
+    LOG_ARGUMENT_SIZE,
+    LOG_ARGUMENT_PTRDIFF,
+    LOG_ARGUMENT_DOUBLE,
+    LOG_ARGUMENT_LONG_DOUBLE,
+    LOG_ARGUMENT_POINTER,
+    LOG_ARGUMENT_STRING,
+    // %n, which cannot be honoured once the caller has moved on, so it is read and ignored.
+    LOG_ARGUMENT_IGNORED
+} log_argument_type;
+
+/** @brief One conversion specification in a format string. */
+typedef struct log_conversion {
+    // Points one past the conversion character.
+    const char* end;
+    b8 width_argument;
+    b8 precision_argument;
+    // The precision when given as digits, or -1.
+    i32 precision;
+    log_argument_type type;
+} log_conversion;
 
 typedef struct logger_system_state{
     file_handle log_file_handle;
+
+    mpsc_queue records;
+    tthread flush_thread;
+    tsemaphore wake_semaphore;
+    volatile i32 running;
+    // Set while the flush thread is waiting, so callers know to wake it.
+    volatile i32 sleeping;
+
+    // Queue positions up to which records have been claimed, and written out in full.
+    volatile u64 written_position;
+    volatile u64 dropped_count;
+    // The drop count last noted in the log itself. Only touched by the flush thread.
+    u64 reported_dropped_count;
+
+    // Only touched by the flush thread.
+    u64 file_batch_length;
+    char file_batch[LOG_FILE_BATCH_SIZE];
 } logger_system_state;
 
 static logger_system_state* state_ptr;
 
+// Global rather than in the state so it also applies before the system is initialized.
+static volatile i32 runtime_log_level = LOG_LEVEL_TRACE;
+
+// Lets the flush thread write its own messages directly instead of queueing behind itself.
+static _Thread_local b8 is_flush_thread = FALSE;
+
+static const char* level_strings[6] = {"[FATAL]: ", "[ERROR]: ", "[WARN]: ", "[INFO]: ", "[DEBUG]: ", "[TRACE]: "};
+
+static void write_console(log_level level, const char* message){
+    if(level < LOG_LEVEL_WARN){
+        platform_console_write_error(message, level);
+    }else{
+        platform_console_write(message, level);
+    }
+}
+
+static void flush_file_batch(){
+    if(state_ptr->file_batch_length && state_ptr->log_file_handle.is_valid){
+        u64 written = 0;
+        if(!filesystem_write(&state_ptr->log_file_handle, state_ptr->file_batch_length, state_ptr->file_batch, &written)){
+            platform_console_write_error("ERROR writing to console.log.", LOG_LEVEL_ERROR);
+        }
+    }
+    state_ptr->file_batch_length = 0;
+}
+
 void append_to_log_file(const char* message){
     if(state_ptr && state_ptr->log_file_handle.is_valid){
-        // Since the message already contains a '\n', just write the bytes directly.
         u64 length = string_length(message);
-        u64 written = 0;
-        if(!filesystem_write(&state_ptr->log_file_handle, length, message, &written)){
-            platform_console_write_error("ERROR writing to console.log.", LOG_LEVEL_ERROR);
+        if(state_ptr->file_batch_length + length > LOG_FILE_BATCH_SIZE){
+            flush_file_batch();
+        }
+        if(length > LOG_FILE_BATCH_SIZE){
+            // Since the message already contains a '\n', just write the bytes directly.
+            u64 written = 0;
+            if(!filesystem_write(&state_ptr->log_file_handle, length, message, &written)){
+                platform_console_write_error("ERROR writing to console.log.", LOG_LEVEL_ERROR);
+            }
+            return;
+        }
+        tcopy_memory(state_ptr->file_batch + state_ptr->file_batch_length, message, length);
+        state_ptr->file_batch_length += length;
+    }
+}
+
+/**
+ * @brief Parses the conversion specification starting just after a '%', the same way
+ * printf does. Anything unrecognized comes back as LOG_ARGUMENT_NONE and is written as is.
+ */
+static void parse_conversion(const char* c, log_conversion* out){
+    tzero_memory(out, sizeof(log_conversion));
+    out->precision = -1;
+    while(*c == '-' || *c == '+' || *c == ' ' || *c == '#' || *c == '0'){
+        c++;
+    }
+    if(*c == '*'){
+        out->width_argument = TRUE;
+        c++;
+    }
+    while(*c >= '0' && *c <= '9'){
+        c++;
+    }
+    if(*c == '.'){
+        c++;
+        out->precision = 0;
+        if(*c == '*'){
+            out->precision_argument = TRUE;
+            c++;
+        }
+        while(*c >= '0' && *c <= '9'){
+            out->precision = out->precision * 10 + (*c - '0');
+            c++;
+        }
+    }
+
+    log_argument_type integer = LOG_ARGUMENT_INT;
+    b8 long_double = FALSE;
+    if(c[0] == 'h'){
+        c += c[1] == 'h' ? 2 : 1;
+    }else if(c[0] == 'l'){
+        integer = c[1] == 'l' ? LOG_ARGUMENT_LONG_LONG : LOG_ARGUMENT_LONG;
+        c += c[1] == 'l' ? 2 : 1;
+    }else if(c[0] == 'j'){
+        integer = LOG_ARGUMENT_INTMAX;
+        c++;
+    }else if(c[0] == 'z'){
+        integer = LOG_ARGUMENT_SIZE;
+        c++;
+    }else if(c[0] == 't'){
+        integer = LOG_ARGUMENT_PTRDIFF;
+        c++;
+    }else if(c[0] == 'L'){
+        long_double = TRUE;
+        c++;
+    }
+
+    switch(*c){
+        case 'd': case 'i': case 'u': case 'o': case 'x': case 'X':
+            out->type = integer;
+            break;
+        case 'c':
+            out->type = LOG_ARGUMENT_INT;
+            break;
+        case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+            out->type = long_double ? LOG_ARGUMENT_LONG_DOUBLE : LOG_ARGUMENT_DOUBLE;
+            break;
+        case 'p':
+            out->type = LOG_ARGUMENT_POINTER;
+            break;
+        case 's':
+            out->type = LOG_ARGUMENT_STRING;
+            break;
+        case 'n':
+            out->type = LOG_ARGUMENT_IGNORED;
+            break;
+        default:
+            out->type = LOG_ARGUMENT_NONE;
+            return;
+    }
+    out->end = c + 1;
+}
+
+/** @brief Appends size bytes to the record data at *offset. Returns FALSE if they do not fit. */
+TINLINE b8 record_put(log_record* record, u32* offset, const void* value, u32 size){
+    if(*offset + size > sizeof(record->data)){
+        return FALSE;
+    }
+    tcopy_memory(record->data + *offset, value, size);
+    *offset += size;
+    return TRUE;
+}
+
+/**
+ * @brief Copies the format string and every argument it uses into the record, without
+ * formatting anything. Integers are widened to 8 bytes, and strings are copied along with
+ * their length, since the caller's buffers may be gone by the time the record is written.
+ * @return FALSE if they do not all fit in the record.
+ */
+static b8 capture_arguments(log_record* record, const char* format, va_list arguments){
+    u32 offset = 0;
+    const char* c = format;
+    while(TRUE){
+        if(offset == sizeof(record->data)){
+            return FALSE;
+        }
+        char character = *c++;
+        record->data[offset++] = character;
+        if(!character){
+            break;
+        }
+    }
+
+    for(c = format; *c; ++c){
+        if(*c != '%'){
+            continue;
+        }
+        if(c[1] == '%'){
+            c++;
+            continue;
+        }
+
+        log_conversion conversion;
+        parse_conversion(c + 1, &conversion);
+        if(conversion.type == LOG_ARGUMENT_NONE){
+            continue;
+        }
+        c = conversion.end - 1;
+
+        i32 precision = conversion.precision;
+        if(conversion.width_argument){
+            i32 width = va_arg(arguments, i32);
+            if(!record_put(record, &offset, &width, sizeof(i32))){
+                return FALSE;
+            }
+        }
+        if(conversion.precision_argument){
+            precision = va_arg(arguments, i32);
+            if(!record_put(record, &offset, &precision, sizeof(i32))){
+                return FALSE;
+            }
+        }
+
+        b8 fits = TRUE;
+        switch(conversion.type){
+            case LOG_ARGUMENT_INT: { i64 value = va_arg(arguments, int); fits = record_put(record, &offset, &value, sizeof(i64)); } break;
+            case LOG_ARGUMENT_LONG: { i64 value = va_arg(arguments, long); fits = record_put(record, &offset, &value, sizeof(i64)); } break;
+            case LOG_ARGUMENT_LONG_LONG: { i64 value = va_arg(arguments, long long); fits = record_put(record, &offset, &value, sizeof(i64)); } break;
+            case LOG_ARGUMENT_INTMAX: { i64 value = va_arg(arguments, intmax_t); fits = record_put(record, &offset, &value, sizeof(i64)); } break;
+            case LOG_ARGUMENT_SIZE: { i64 value = va_arg(arguments, size_t); fits = record_put(record, &offset, &value, sizeof(i64)); } break;
+            case LOG_ARGUMENT_PTRDIFF: { i64 value = va_arg(arguments, ptrdiff_t); fits = record_put(record, &offset, &value, sizeof(i64)); } break;
+            case LOG_ARGUMENT_DOUBLE: { f64 value = va_arg(arguments, double); fits = record_put(record, &offset, &value, sizeof(f64)); } break;
+            case LOG_ARGUMENT_LONG_DOUBLE: { long double value = va_arg(arguments, long double); fits = record_put(record, &offset, &value, sizeof(long double)); } break;
+            case LOG_ARGUMENT_POINTER: { void* value = va_arg(arguments, void*); fits = record_put(record, &offset, &value, sizeof(void*)); } break;
+            case LOG_ARGUMENT_IGNORED: va_arg(arguments, void*); break;
+            case LOG_ARGUMENT_STRING: {
+                const char* value = va_arg(arguments, const char*);
+                if(!value){
+                    value = "(null)";
+                }
+                // A precision may mean the string is not terminated, so never read past it.
+                u32 length = 0;
+                while(value[length] && (precision < 0 || length < (u32)precision)){
+                    length++;
+                }
+                fits = record_put(record, &offset, &length, sizeof(u32)) && record_put(record, &offset, value, length);
+                if(fits){
+                    char terminator = 0;
+                    fits = record_put(record, &offset, &terminator, 1);
+                }
+            } break;
+            default:
+                break;
+        }
+        if(!fits){
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+/** @brief Reads back a value captured by record_put. */
+TINLINE void record_get(const log_record* record, u32* offset, void* out_value, u32 size){
+    tcopy_memory(out_value, record->data + *offset, size);
+    *offset += size;
+}
+
+/**
+ * @brief Formats a captured record into out_line as "[LEVEL]: message\n", handing each
+ * conversion to snprintf with its original specification. Overlong lines end in "...".
+ */
+static void format_record(const log_record* record, char* out_line, u32 size){
+    const char* format = record->data;
+    u32 offset = string_length(format) + 1;
+    // Leaves room for the newline and terminator.
+    u32 limit = size - 2;
+    u32 length = string_length(level_strings[record->level]);
+    tcopy_memory(out_line, level_strings[record->level], length);
+
+    for(const char* c = format; *c && length < limit; ++c){
+        if(*c != '%'){
+            out_line[length++] = *c;
+            continue;
+        }
+        if(c[1] == '%'){
+            out_line[length++] = '%';
+            c++;
+            continue;
+        }
+
+        log_conversion conversion;
+        parse_conversion(c + 1, &conversion);
+        if(conversion.type == LOG_ARGUMENT_NONE){
+            out_line[length++] = *c;
+            continue;
+        }
+
+        // Rebuilds the specification with any '*' replaced by the captured value, so
+        // snprintf only ever needs the one argument.
+        char specification[64];
+        u32 specification_length = 0;
+        for(const char* s = c; s < conversion.end && specification_length < sizeof(specification) - 16; ++s){
+            if(*s != '*'){
+                specification[specification_length++] = *s;
+                continue;
+            }
+            i32 value;
+            record_get(record, &offset, &value, sizeof(i32));
+            if(s[-1] == '.' && value < 0){
+                // A negative precision counts as none at all.
+                specification_length--;
+                continue;
+            }
+            specification_length += snprintf(specification + specification_length, 16, "%i", value);
+        }
+        specification[specification_length] = 0;
+        c = conversion.end - 1;
+
+        char* dest = out_line + length;
+        u32 remaining = limit - length + 1;
+        i32 written = 0;
+        switch(conversion.type){
+            case LOG_ARGUMENT_INT: { i64 value; record_get(record, &offset, &value, sizeof(i64)); written = snprintf(dest, remaining, specification, (int)value); } break;
+            case LOG_ARGUMENT_LONG: { i64 value; record_get(record, &offset, &value, sizeof(i64)); written = snprintf(dest, remaining, specification, (long)value); } break;
+            case LOG_ARGUMENT_LONG_LONG: { i64 value; record_get(record, &offset, &value, sizeof(i64)); written = snprintf(dest, remaining, specification, (long long)value); } break;
+            case LOG_ARGUMENT_INTMAX: { i64 value; record_get(record, &offset, &value, sizeof(i64)); written = snprintf(dest, remaining, specification, (intmax_t)value); } break;
+            case LOG_ARGUMENT_SIZE: { i64 value; record_get(record, &offset, &value, sizeof(i64)); written = snprintf(dest, remaining, specification, (size_t)value); } break;
+            case LOG_ARGUMENT_PTRDIFF: { i64 value; record_get(record, &offset, &value, sizeof(i64)); written = snprintf(dest, remaining, specification, (ptrdiff_t)value); } break;
+            case LOG_ARGUMENT_DOUBLE: { f64 value; record_get(record, &offset, &value, sizeof(f64)); written = snprintf(dest, remaining, specification, value); } break;
+            case LOG_ARGUMENT_LONG_DOUBLE: { long double value; record_get(record, &offset, &value, sizeof(long double)); written = snprintf(dest, remaining, specification, value); } break;
+            case LOG_ARGUMENT_POINTER: { void* value; record_get(record, &offset, &value, sizeof(void*)); written = snprintf(dest, remaining, specification, value); } break;
+            case LOG_ARGUMENT_STRING: {
+                u32 string_size;
+                record_get(record, &offset, &string_size, sizeof(u32));
+                written = snprintf(dest, remaining, specification, record->data + offset);
+                offset += string_size + 1;
+            } break;
+            default:
+                break;
+        }
+        if(written > 0){
+            length += written;
+        }
+    }
+
+    if(length >= limit){
+        // Mark truncated messages.
+        length = limit;
+        tcopy_memory(out_line + length - 3, "...", 3);
+    }
+    out_line[length] = '\n';
+    out_line[length + 1] = 0;
+}
+
+/** @brief Writes out everything queued so far. Only called on the flush thread. */
+static void drain_records(){
+    char line[LOG_LINE_SIZE];
+
+    log_record* record;
+    while((record = mpsc_queue_peek(&state_ptr->records))){
+        log_level level = record->level;
+        if(record->preformatted){
+            char* heap_line;
+            tcopy_memory(&heap_line, record->data, sizeof(char*));
+            mpsc_queue_pop(&state_ptr->records);
+            write_console(level, heap_line);
+            append_to_log_file(heap_line);
+            platform_free(heap_line, FALSE);
+            continue;
         }
+
+        format_record(record, line, sizeof(line));
+        mpsc_queue_pop(&state_ptr->records);
+
+        write_console(level, line);
+        append_to_log_file(line);
+    }
+
+    // Note any records that were lost since the last batch, so gaps in the log are explained.
+    u64 drops = tatomic_load_u64(&state_ptr->dropped_count, TATOMIC_RELAXED);
+    if(drops != state_ptr->reported_dropped_count){
+        state_ptr->reported_dropped_count = drops;
+        snprintf(line, sizeof(line), "%s%llu log records dropped so far; the log queue was full.\n", level_strings[LOG_LEVEL_WARN], drops);
+        write_console(LOG_LEVEL_WARN, line);
+        append_to_log_file(line);
+    }
+
+    flush_file_batch();
+    tatomic_store_u64(&state_ptr->written_position, state_ptr->records.head, TATOMIC_RELEASE);
+}
+
+static u32 log_flush_thread(void* params){
+    is_flush_thread = TRUE;
+
+    while(TRUE){
+        drain_records();
+
+        if(!tatomic_load_i32(&state_ptr->running, TATOMIC_ACQUIRE)){
+            // Catch anything queued while shutting down.
+            drain_records();
+            break;
+        }
+
+        // Announce the sleep before the final check, so a caller that queues a record
+        // after the check is guaranteed to see the flag and signal.
+        tatomic_store_i32(&state_ptr->sleeping, 1, TATOMIC_SEQ_CST);
+        if(mpsc_queue_length(&state_ptr->records) == 0 && tatomic_load_i32(&state_ptr->running, TATOMIC_ACQUIRE)){
+            tsemaphore_wait(&state_ptr->wake_semaphore, LOG_FLUSH_INTERVAL_MS);
+        }
+        tatomic_store_i32(&state_ptr->sleeping, 0, TATOMIC_RELAXED);
+    }
+
+    return 0;
+}
+
+static void wake_flush_thread(){
+    tatomic_thread_fence(TATOMIC_SEQ_CST);
+    i32 expected = 1;
+    if(tatomic_load_i32(&state_ptr->sleeping, TATOMIC_RELAXED) && tatomic_compare_exchange_i32(&state_ptr->sleeping, &expected, 0, TATOMIC_ACQ_REL)){
+        tsemaphore_signal(&state_ptr->wake_semaphore);
     }
 }
 
 b8 initialize_logging(u64* memory_requirement, void* state){
-    *memory_requirement = sizeof(logger_system_state);
+    *memory_requirement = sizeof(logger_system_state) + mpsc_queue_memory_requirement(sizeof(log_record), LOG_RECORD_CAPACITY);
     if(state == 0){
         return TRUE;
     }
 
-    state_ptr = state;
+    logger_system_state* new_state = state;
+    tzero_memory(new_state, sizeof(logger_system_state));
 
     // Create new/wipe existing log file, then open it.
-    if(!filesystem_open("console.log", FILE_MODE_WRITE, FALSE, &state_ptr->log_file_handle)){
+    if(!filesystem_open("console.log", FILE_MODE_WRITE, FALSE, &new_state->log_file_handle)){
         platform_console_write_error("ERROR: Unable to open console.log for writing.", LOG_LEVEL_ERROR);
         return FALSE;
     }
-    
+
+    if(!mpsc_queue_create(sizeof(log_record), LOG_RECORD_CAPACITY, state + sizeof(logger_system_state), &new_state->records)){
+        platform_console_write_error("ERROR: Unable to create the log record queue.", LOG_LEVEL_ERROR);
+        return FALSE;
+    }
+
+    if(!tsemaphore_create(&new_state->wake_semaphore, LOG_RECORD_CAPACITY, 0)){
+        platform_console_write_error("ERROR: Unable to create the log flush semaphore.", LOG_LEVEL_ERROR);
+        return FALSE;
+    }
+
+    // Records can be queued from here on; the flush thread picks them up once started.
+    new_state->running = 1;
+    state_ptr = new_state;
+    if(!tthread_create(log_flush_thread, 0, FALSE, &new_state->flush_thread)){
+        state_ptr = 0;
+        tsemaphore_destroy(&new_state->wake_semaphore);
+        platform_console_write_error("ERROR: Unable to start the log flush thread.", LOG_LEVEL_ERROR);
+        return FALSE;
+    }
+
     return TRUE;
 }
 
 void shutdown_logging(void* state){
-    // TODO: Cleanup logging/write queued entries
+    if(!state_ptr){
+        return;
+    }
+
+    // Let the flush thread write out everything still queued, then stop it.
+    tatomic_store_i32(&state_ptr->running, 0, TATOMIC_RELEASE);
+    tsemaphore_signal(&state_ptr->wake_semaphore);
+    tthread_wait(&state_ptr->flush_thread);
 
+    logger_system_state* old_state = state_ptr;
     state_ptr = 0;
+
+    tsemaphore_destroy(&old_state->wake_semaphore);
+    mpsc_queue_destroy(&old_state->records);
+    filesystem_close(&old_state->log_file_handle);
+}
+
+void log_level_set(log_level level){
+    tatomic_store_i32(&runtime_log_level, level, TATOMIC_RELAXED);
+}
+
+log_level log_level_get(){
+    return tatomic_load_i32(&runtime_log_level, TATOMIC_RELAXED);
+}
+
+u64 log_dropped_count(){
+    return state_ptr ? tatomic_load_u64(&state_ptr->dropped_count, TATOMIC_RELAXED) : 0;
+}
+
+void log_flush(){
+    if(!state_ptr || is_flush_thread){
+        return;
+    }
+
+    // Everything claimed up to now must be written out.
+    u64 target = tatomic_load_u64(&state_ptr->records.tail, TATOMIC_ACQUIRE);
+    while(tatomic_load_u64(&state_ptr->written_position, TATOMIC_ACQUIRE) < target && tatomic_load_i32(&state_ptr->running, TATOMIC_ACQUIRE)){
+        wake_flush_thread();
+        platform_sleep(0);
+    }
 }
 
 void log_output(log_level level, const char* message, ...){
-    // TODO: These string operations are all pretty slow. This needs to be
-    // moved to another thread eventually, along with the file writes, to
-    // avoid slowing things down while the engine is trying to run.
-    const char* level_strings[6] = {"[FATAL]: ", "[ERROR]: ", "[WARN]: ", "[INFO]: ", "[DEBUG]: ", "[TRACE]: "};
-    b8 is_error = level < LOG_LEVEL_WARN;
-
-    // Technically imposes a 32k character limit on a single log entry, this is to make it much faster that dynamic allocation, but..
-    // DONT DO THAT
-    char out_message[32000];
-    tzero_memory(out_message, sizeof(out_message));
-
-    // Format original message.
+    // Filter before doing any work at all.
+    if((i32)level > tatomic_load_i32(&runtime_log_level, TATOMIC_RELAXED)){
+        return;
+    }
+
     // NOTE: Oddly enought, MS's headers override the GCC/Clang va_list type with a "typedef char* va_list" in some
     // cases, and as result throws a strange error here. The workaround for now is to just use __built_va_list,
     // which is the type GCC/Clang's va_start expects.
     __builtin_va_list arg_ptr;
+
+    if(!state_ptr || is_flush_thread){
+        // No flush thread to hand off to, so write it out directly.
+        char out_message[LOG_LINE_SIZE];
+        i32 prefix_length = snprintf(out_message, sizeof(out_message), "%s", level_strings[level]);
+        va_start(arg_ptr, message);
+        i32 length = vsnprintf(out_message + prefix_length, sizeof(out_message) - prefix_length - 1, message, arg_ptr);
+        va_end(arg_ptr);
+        if(length < 0){
+            length = 0;
+        }
+        length += prefix_length;
+        if(length > (i32)sizeof(out_message) - 2){
+            length = sizeof(out_message) - 2;
+        }
+        out_message[length] = '\n';
+        out_message[length + 1] = 0;
+
+        write_console(level, out_message);
+        append_to_log_file(out_message);
+        return;
+    }
+
+    log_record* record = mpsc_queue_reserve(&state_ptr->records);
+    while(!record){
+        if(level > LOG_LEVEL_ERROR){
+            // Under backpressure, lose the message rather than stall the caller.
+            tatomic_fetch_add_u64(&state_ptr->dropped_count, 1, TATOMIC_RELAXED);
+            wake_flush_thread();
+            return;
+        }
+        // Errors are never dropped; wait for the flush thread to make room.
+        wake_flush_thread();
+        platform_sleep(0);
+        record = mpsc_queue_reserve(&state_ptr->records);
+    }
+
+    record->level = level;
     va_start(arg_ptr, message);
-    string_format_v(out_message, message, arg_ptr);
+    b8 captured = capture_arguments(record, message, arg_ptr);
     va_end(arg_ptr);
+    record->preformatted = !captured;
+    if(!captured){
+        // Too much to capture, so format the whole line here instead, however long it is.
+        i32 prefix_length = (i32)string_length(level_strings[level]);
+        va_start(arg_ptr, message);
+        i32 length = vsnprintf(0, 0, message, arg_ptr);
+        va_end(arg_ptr);
+        if(length < 0){
+            length = 0;
+        }
+        char* line = platform_allocate(prefix_length + length + 2, FALSE);
+        if(!line){
+            // The slot is already claimed, so it goes through as an empty message.
+            record->preformatted = FALSE;
+            tcopy_memory(record->data, "", 1);
+            mpsc_queue_commit(&state_ptr->records, record);
+            tatomic_fetch_add_u64(&state_ptr->dropped_count, 1, TATOMIC_RELAXED);
+            return;
+        }
+        tcopy_memory(line, level_strings[level], prefix_length);
+        va_start(arg_ptr, message);
+        vsnprintf(line + prefix_length, length + 1, message, arg_ptr);
+        va_end(arg_ptr);
+        line[prefix_length + length] = '\n';
+        line[prefix_length + length + 1] = 0;
+        tcopy_memory(record->data, &line, sizeof(char*));
+    }
+    mpsc_queue_commit(&state_ptr->records, record);
 
-   // Prepend log level to the message.
-   string_format(out_message, "%s%s\n", level_strings[level], out_message);
+    wake_flush_thread();
 
-    // Platform specific output. Print accordingly
-    if(is_error){
-        platform_console_write_error(out_message, level);
-    }else{
-        platform_console_write(out_message, level);
+    if(level == LOG_LEVEL_FATAL){
+        // The engine is likely about to go down; make sure this reaches the console and file.
+        log_flush();
     }
-
-    // Queue a copy to be written to the log file.
-    append_to_log_file(out_message);
 }
 
 
 // log_output is define previously in the logger.h
 void report_assertion_failure(const char* expression, const char* message, const char* file, i32 line){
     log_output(LOG_LEVEL_FATAL, "Assertion failure: %s, message: '%s', in file: %s, line: %d\n", expression, message, file, line);
-}
\ No newline at end of file
+}
@@ -30,11 +30,49 @@ typedef enum log_level{
  * @param state 0 if just requesting memory requirement, otherwise allocated block of memory.
  * @return b8 TRUE on success; otherwise FALSE.
  */
-b8 initialize_logging(u64* memory_requirement, void* state);
-void shutdown_logging(void* state);
+TAPI b8 initialize_logging(u64* memory_requirement, void* state);
 
+/**
+ * @brief Shuts the logging system down, writing out everything still queued first.
+ * 
+ * @param state The block of state memory.
+ */
+TAPI void shutdown_logging(void* state);
+
+/**
+ * @brief Logs a message. Once the logging system is initialized, the format string
+ * and its arguments are copied into a queue, and a background thread formats them and
+ * writes them to the console and log file. Strings are copied, so the caller's buffers
+ * can be reused straight away. Before the system is initialized, the message is written
+ * out directly. Messages above the runtime log level are discarded before any work is done.
+ */
 TAPI void log_output(log_level level, const char* message, ...);
 
+/**
+ * @brief Sets the most verbose level that is logged at runtime. Levels compiled
+ * out with the LOG_*_ENABLED flags stay disabled regardless.
+ * 
+ * @param level The most verbose level to log.
+ */
+TAPI void log_level_set(log_level level);
+
+/**
+ * @brief Gets the most verbose level that is logged at runtime.
+ */
+TAPI log_level log_level_get();
+
+/**
+ * @brief Blocks until every message logged so far has been written to the console
+ * and log file. Fatal messages flush automatically.
+ */
+TAPI void log_flush();
+
+/**
+ * @brief Gets the number of messages that were discarded because the log queue was full.
+ * Errors and fatal messages are never discarded; their callers wait for space instead.
+ */
+TAPI u64 log_dropped_count();
+
 
 #ifndef TFATAL
     // Logs a fatal-level message.
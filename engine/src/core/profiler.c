@@ -0,0 +1,311 @@
+#include "profiler.h"
+
+#include "core/logger.h"
+#include "core/tmemory.h"
+#include "core/tstring.h"
+#include "core/tatomic.h"
+#include "platform/platform.h"
+#include "platform/filesystem.h"
+
+// TODO: custom string lib
+#include <stdio.h>
+#include <stdarg.h>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+    #if defined(_MSC_VER)
+        #include <intrin.h>
+    #else
+        #include <x86intrin.h>
+    #endif
+    #define PROFILER_TSC 1
+#endif
+
+// The engine is always loaded along with the application, so its thread locals can live in
+// the static TLS block. Otherwise every access from the shared library calls __tls_get_addr.
+#if defined(TPLATFORM_LINUX)
+    #define PROFILER_THREAD_LOCAL _Thread_local __attribute__((tls_model("initial-exec")))
+#else
+    #define PROFILER_THREAD_LOCAL _Thread_local
+#endif
+
+#define PROFILER_EVENT_MASK (PROFILER_EVENTS_PER_THREAD - 1)
+
+/**
+ * A zone beginning (name set) or ending (name 0). Ends are matched up with their begins only
+ * when a trace is written. Written by the owning thread while traces may be read, hence the atomics.
+ */
+typedef struct profiler_event {
+    volatile u64 name;
+    volatile u64 ticks;
+} profiler_event;
+
+/** Everything one thread records. Only the owning thread writes to it. */
+typedef struct profiler_thread_buffer {
+    // Set once the owner has finished claiming the buffer.
+    volatile i32 ready;
+    char name[32];
+    // The total number of events ever written. The ring holds the last PROFILER_EVENTS_PER_THREAD.
+    volatile u64 write_count;
+    profiler_event* events;
+} profiler_thread_buffer;
+
+typedef struct profiler_state {
+    // Trace timestamps are relative to these, and the ticks are converted to nanoseconds
+    // by comparing both clocks when a trace is written.
+    u64 start_ticks;
+    u64 start_ns;
+    volatile i32 thread_count;
+    profiler_thread_buffer threads[PROFILER_MAX_THREADS];
+} profiler_state;
+
+static profiler_state* state_ptr;
+
+// Bumped on every initialize so threads notice their buffer belongs to an old profiler.
+static volatile i32 profiler_generation = 0;
+
+static PROFILER_THREAD_LOCAL profiler_thread_buffer* thread_buffer = 0;
+static PROFILER_THREAD_LOCAL i32 thread_buffer_generation = -1;
+
+TINLINE u64 now_ns(){
+    return (u64)(platform_get_absolute_time() * 1000000000.0);
+}
+
+/** The zone clock. The time stamp counter where there is one, as it is far cheaper to read than the OS clock. */
+TINLINE u64 now_ticks(){
+#if defined(PROFILER_TSC)
+    return __rdtsc();
+#else
+    return now_ns();
+#endif
+}
+
+b8 profiler_system_initialize(u64* memory_requirement, void* state){
+    *memory_requirement = sizeof(profiler_state);
+    if(state == 0){
+        return TRUE;
+    }
+
+    profiler_state* new_state = state;
+    tzero_memory(new_state, sizeof(profiler_state));
+    new_state->start_ticks = now_ticks();
+    new_state->start_ns = now_ns();
+    state_ptr = new_state;
+    tatomic_fetch_add_i32(&profiler_generation, 1, TATOMIC_RELEASE);
+    return TRUE;
+}
+
+void profiler_system_shutdown(void* state){
+    if(!state_ptr){
+        return;
+    }
+
+    i32 thread_count = tatomic_load_i32(&state_ptr->thread_count, TATOMIC_ACQUIRE);
+    if(thread_count > PROFILER_MAX_THREADS){
+        thread_count = PROFILER_MAX_THREADS;
+    }
+    for(i32 i = 0; i < thread_count; ++i){
+        profiler_thread_buffer* buffer = &state_ptr->threads[i];
+        if(buffer->events){
+            tfree(buffer->events, sizeof(profiler_event) * PROFILER_EVENTS_PER_THREAD, MEMORY_TAG_APPLICATION);
+            buffer->events = 0;
+        }
+    }
+    state_ptr = 0;
+    // So that threads stop writing to the buffers just freed.
+    tatomic_fetch_add_i32(&profiler_generation, 1, TATOMIC_RELEASE);
+}
+
+/** Claims a buffer for the calling thread, which has none for the current profiler yet. */
+static profiler_thread_buffer* claim_thread_buffer(const char* name){
+    i32 generation = tatomic_load_i32(&profiler_generation, TATOMIC_ACQUIRE);
+    thread_buffer_generation = generation;
+    thread_buffer = 0;
+    if(!state_ptr){
+        return 0;
+    }
+    i32 index = tatomic_fetch_add_i32(&state_ptr->thread_count, 1, TATOMIC_ACQ_REL);
+    if(index >= PROFILER_MAX_THREADS){
+        TWARN("Profiler is out of thread buffers; zones on this thread will not be recorded.");
+        return 0;
+    }
+
+    profiler_thread_buffer* buffer = &state_ptr->threads[index];
+    // Filled by the ring before it is ever read, so there is nothing to zero.
+    buffer->events = tallocate_uninitialized(sizeof(profiler_event) * PROFILER_EVENTS_PER_THREAD, 64, MEMORY_TAG_APPLICATION);
+    if(!buffer->events){
+        TERROR("Unable to allocate a profiler thread buffer; zones on this thread will not be recorded.");
+        return 0;
+    }
+    if(name){
+        string_ncopy(buffer->name, name, sizeof(buffer->name) - 1);
+    }else{
+        string_format(buffer->name, "thread %i", index);
+    }
+    tatomic_store_i32(&buffer->ready, 1, TATOMIC_RELEASE);
+
+    thread_buffer = buffer;
+    return thread_buffer;
+}
+
+/** Gets the calling thread's buffer, claiming one on first use. Returns 0 if there is none to be had. */
+TINLINE profiler_thread_buffer* get_thread_buffer(){
+    if(thread_buffer_generation == tatomic_load_i32(&profiler_generation, TATOMIC_RELAXED)){
+        return thread_buffer;
+    }
+    return claim_thread_buffer(0);
+}
+
+TINLINE void record_event(profiler_thread_buffer* buffer, const char* name, u64 ticks){
+    // The slot still holds an event a reader may be copying. The fence makes sure that a
+    // reader who sees any of the new values also sees write_count at least at this index.
+    u64 index = buffer->write_count;
+    tatomic_thread_fence(TATOMIC_RELEASE);
+    profiler_event* event = &buffer->events[index & PROFILER_EVENT_MASK];
+    tatomic_store_u64(&event->name, (u64)name, TATOMIC_RELAXED);
+    tatomic_store_u64(&event->ticks, ticks, TATOMIC_RELAXED);
+    tatomic_store_u64(&buffer->write_count, index + 1, TATOMIC_RELEASE);
+}
+
+void profiler_set_thread_name(const char* name){
+    i32 generation = tatomic_load_i32(&profiler_generation, TATOMIC_ACQUIRE);
+    if(state_ptr && thread_buffer_generation == generation){
+        TWARN("profiler_set_thread_name('%s') called after the thread's first zone; ignoring.", name);
+        return;
+    }
+    claim_thread_buffer(name);
+}
+
+void profiler_zone_begin(const char* name){
+    profiler_thread_buffer* buffer = get_thread_buffer();
+    if(buffer){
+        record_event(buffer, name, now_ticks());
+    }
+}
+
+void profiler_zone_end(){
+    u64 ticks = now_ticks();
+    profiler_thread_buffer* buffer = get_thread_buffer();
+    if(buffer){
+        record_event(buffer, 0, ticks);
+    }
+}
+
+/** Formats and writes a piece of the trace file. Clears *ok if anything fails to write. */
+static void write_json(file_handle* handle, b8* ok, const char* format, ...){
+    char buffer[512];
+    va_list arg_ptr;
+    va_start(arg_ptr, format);
+    i32 length = vsnprintf(buffer, sizeof(buffer), format, arg_ptr);
+    va_end(arg_ptr);
+    if(length < 0){
+        *ok = FALSE;
+        return;
+    }
+    if(length >= (i32)sizeof(buffer)){
+        length = sizeof(buffer) - 1;
+    }
+    u64 written = 0;
+    if(!filesystem_write(handle, length, buffer, &written) || written != (u64)length){
+        *ok = FALSE;
+    }
+}
+
+b8 profiler_write_trace(const char* path){
+    if(!state_ptr){
+        TWARN("profiler_write_trace called before the profiler was initialized.");
+        return FALSE;
+    }
+
+    file_handle handle;
+    if(!filesystem_open(path, FILE_MODE_WRITE, FALSE, &handle)){
+        TERROR("Unable to open '%s' for writing the profiler trace.", path);
+        return FALSE;
+    }
+
+    // Threads keep recording while this runs, so each ring is copied out first and then
+    // anything that may have been overwritten during the copy is thrown away.
+    profiler_event* snapshot = tallocate_uninitialized(sizeof(profiler_event) * PROFILER_EVENTS_PER_THREAD, 64, MEMORY_TAG_APPLICATION);
+    // The begins still waiting for their ends, while each thread's events are paired up.
+    profiler_event open_zones[PROFILER_MAX_DEPTH];
+    b8 ok = TRUE;
+    b8 first = TRUE;
+    u64 event_count = 0;
+    write_json(&handle, &ok, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [");
+
+    f64 ns_per_tick = 1.0;
+#if defined(PROFILER_TSC)
+    u64 elapsed_ticks = now_ticks() - state_ptr->start_ticks;
+    u64 elapsed_ns = now_ns() - state_ptr->start_ns;
+    if(elapsed_ticks > 0){
+        ns_per_tick = (f64)elapsed_ns / (f64)elapsed_ticks;
+    }
+#endif
+
+    i32 thread_count = tatomic_load_i32(&state_ptr->thread_count, TATOMIC_ACQUIRE);
+    if(thread_count > PROFILER_MAX_THREADS){
+        thread_count = PROFILER_MAX_THREADS;
+    }
+    for(i32 t = 0; t < thread_count; ++t){
+        profiler_thread_buffer* buffer = &state_ptr->threads[t];
+        if(!tatomic_load_i32(&buffer->ready, TATOMIC_ACQUIRE)){
+            continue;
+        }
+
+        u64 end = tatomic_load_u64(&buffer->write_count, TATOMIC_ACQUIRE);
+        u64 begin = end > PROFILER_EVENTS_PER_THREAD ? end - PROFILER_EVENTS_PER_THREAD : 0;
+        for(u64 i = begin; i < end; ++i){
+            profiler_event* source = &buffer->events[i & PROFILER_EVENT_MASK];
+            profiler_event* copy = &snapshot[i & PROFILER_EVENT_MASK];
+            copy->name = tatomic_load_u64(&source->name, TATOMIC_RELAXED);
+            copy->ticks = tatomic_load_u64(&source->ticks, TATOMIC_RELAXED);
+        }
+        tatomic_thread_fence(TATOMIC_ACQUIRE);
+        // The slot for write_count itself may be mid-write, so it is excluded too.
+        u64 latest = tatomic_load_u64(&buffer->write_count, TATOMIC_RELAXED);
+        if(latest >= PROFILER_EVENTS_PER_THREAD && latest - PROFILER_EVENTS_PER_THREAD + 1 > begin){
+            begin = latest - PROFILER_EVENTS_PER_THREAD + 1;
+        }
+
+        write_json(&handle, &ok, "%s\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 0, \"tid\": %i, \"args\": {\"name\": \"%s\"}}",
+                   first ? "" : ",", t, buffer->name);
+        first = FALSE;
+        // The events kept are the tail of a properly nested sequence, so any end that comes
+        // with nothing open belongs to a begin that was overwritten, and is skipped.
+        u32 depth = 0;
+        for(u64 i = begin; i < end; ++i){
+            profiler_event* event = &snapshot[i & PROFILER_EVENT_MASK];
+            if(event->name){
+                if(depth < PROFILER_MAX_DEPTH){
+                    open_zones[depth] = *event;
+                }
+                depth++;
+                continue;
+            }
+            if(depth == 0){
+                continue;
+            }
+            depth--;
+            if(depth >= PROFILER_MAX_DEPTH){
+                continue;
+            }
+
+            profiler_event* zone = &open_zones[depth];
+            u64 start_ns = (u64)((f64)(zone->ticks - state_ptr->start_ticks) * ns_per_tick);
+            u64 duration_ns = (u64)((f64)(event->ticks - zone->ticks) * ns_per_tick);
+            write_json(&handle, &ok, ",\n{\"name\": \"%s\", \"ph\": \"X\", \"pid\": 0, \"tid\": %i, \"ts\": %llu.%03llu, \"dur\": %llu.%03llu}",
+                       (const char*)zone->name, t, start_ns / 1000, start_ns % 1000, duration_ns / 1000, duration_ns % 1000);
+            event_count++;
+        }
+    }
+
+    write_json(&handle, &ok, "\n]}\n");
+    filesystem_close(&handle);
+    tfree(snapshot, sizeof(profiler_event) * PROFILER_EVENTS_PER_THREAD, MEMORY_TAG_APPLICATION);
+
+    if(!ok){
+        TERROR("Failed to write the profiler trace to '%s'.", path);
+        return FALSE;
+    }
+    TINFO("Wrote %llu profiler zones from %i threads to '%s'.", event_count, thread_count, path);
+    return TRUE;
+}
@@ -0,0 +1,97 @@
+/**
+ * @file profiler.h
+ * @brief A scoped-zone CPU profiler. Each thread records the zones it completes into
+ * its own ring buffer without taking any locks, and the most recent history of every
+ * thread can be written out as a Chrome trace (chrome://tracing or ui.perfetto.dev)
+ * at any time, including while the zones are still being recorded.
+ */
+
+#pragma once
+
+#include "defines.h"
+
+// Each end of a zone is just a cycle counter read and a 16 byte write to the thread's own
+// ring, so the profiler stays compiled in by default. Define TPROFILER_ENABLED as 0 to compile every zone out entirely.
+#ifndef TPROFILER_ENABLED
+    #define TPROFILER_ENABLED 1
+#endif
+
+/**
+ * @brief The number of most recent events kept per thread, two for each zone: its begin and its end.
+ * Older events are overwritten. Must be a power of two.
+ */
+#define PROFILER_EVENTS_PER_THREAD 32768
+
+/** @brief The number of threads that can record zones. Zones on any further threads are ignored. */
+#define PROFILER_MAX_THREADS 32
+
+/** @brief Zones nested deeper than this are left out of written traces, though they still have to be ended. */
+#define PROFILER_MAX_DEPTH 64
+
+/**
+ * @brief Initializes the profiler. Call twice; once with state = 0 to get the required memory size,
+ * then a second time passing allocated memory to state. The per-thread buffers are allocated
+ * separately, the first time a thread records a zone.
+ *
+ * @param memory_requirement A pointer to hold the required memory size of internal state.
+ * @param state 0 if just requesting memory requirement, otherwise allocated block of memory.
+ * @return True on success; otherwise false.
+ */
+TAPI b8 profiler_system_initialize(u64* memory_requirement, void* state);
+
+/**
+ * @brief Shuts the profiler down and frees the per-thread buffers. Every thread that recorded
+ * zones must have stopped doing so.
+ *
+ * @param state The block of state memory.
+ */
+TAPI void profiler_system_shutdown(void* state);
+
+/**
+ * @brief Names the calling thread in written traces. Must be called after the profiler is
+ * initialized and before the thread's first zone.
+ *
+ * @param name The name of the thread. Copied.
+ */
+TAPI void profiler_set_thread_name(const char* name);
+
+/**
+ * @brief Opens a zone on the calling thread. Use the TPROFILE_* macros rather than calling this directly.
+ *
+ * @param name The name of the zone. Only the pointer is kept, so it must outlive the profiler,
+ * which any string literal does. Must not be 0.
+ */
+TAPI void profiler_zone_begin(const char* name);
+
+/** @brief Closes the most recently opened zone on the calling thread. */
+TAPI void profiler_zone_end();
+
+/**
+ * @brief Writes every thread's recorded zones to the given path as Chrome trace event JSON.
+ *
+ * @param path The path of the file to write.
+ * @return True on success; otherwise false.
+ */
+TAPI b8 profiler_write_trace(const char* path);
+
+/** @brief Used by TPROFILE_SCOPE to close its zone when it goes out of scope. */
+TINLINE void profiler_scope_cleanup(const char** name){
+    profiler_zone_end();
+}
+
+#define TPROFILE_CONCAT_INNER(a, b) a##b
+#define TPROFILE_CONCAT(a, b) TPROFILE_CONCAT_INNER(a, b)
+
+#if TPROFILER_ENABLED == 1
+    /** @brief Opens a zone, which must be closed with TPROFILE_END on every path out. */
+    #define TPROFILE_BEGIN(name) profiler_zone_begin(name)
+    /** @brief Closes the zone opened by the matching TPROFILE_BEGIN. */
+    #define TPROFILE_END() profiler_zone_end()
+    /** @brief Opens a zone that closes itself at the end of the enclosing block, however it is left. */
+    #define TPROFILE_SCOPE(name) \
+        const char* TPROFILE_CONCAT(tprofile_scope_, __LINE__) __attribute__((cleanup(profiler_scope_cleanup), unused)) = (profiler_zone_begin(name), name)
+#else
+    #define TPROFILE_BEGIN(name)
+    #define TPROFILE_END()
+    #define TPROFILE_SCOPE(name)
+#endif
@@ -0,0 +1,111 @@
+/**
+ * @file tatomic.h
+ * @brief Thin wrappers around the compiler atomic builtins, used by the
+ * lock-free parts of the engine (job deques, queues, counters).
+ * The engine is built with clang on every platform, so the GCC/Clang
+ * __atomic builtins are always available.
+ */
+
+#pragma once
+
+#include "defines.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+    #include <emmintrin.h>
+#endif
+
+/** @brief Memory orderings, matching the C11 memory model. */
+typedef enum tatomic_order {
+    TATOMIC_RELAXED = __ATOMIC_RELAXED,
+    TATOMIC_ACQUIRE = __ATOMIC_ACQUIRE,
+    TATOMIC_RELEASE = __ATOMIC_RELEASE,
+    TATOMIC_ACQ_REL = __ATOMIC_ACQ_REL,
+    TATOMIC_SEQ_CST = __ATOMIC_SEQ_CST
+} tatomic_order;
+
+TINLINE i32 tatomic_load_i32(volatile i32* ptr, tatomic_order order){
+    return __atomic_load_n(ptr, order);
+}
+
+TINLINE void tatomic_store_i32(volatile i32* ptr, i32 value, tatomic_order order){
+    __atomic_store_n(ptr, value, order);
+}
+
+/** @brief Adds value to ptr, returning the previous value. */
+TINLINE i32 tatomic_fetch_add_i32(volatile i32* ptr, i32 value, tatomic_order order){
+    return __atomic_fetch_add(ptr, value, order);
+}
+
+/**
+ * @brief Sets ptr to desired if it currently holds *expected. On failure, *expected
+ * receives the current value.
+ * @return True if the exchange happened; otherwise false.
+ */
+TINLINE b8 tatomic_compare_exchange_i32(volatile i32* ptr, i32* expected, i32 desired, tatomic_order order){
+    return __atomic_compare_exchange_n(ptr, expected, desired, FALSE, order, TATOMIC_RELAXED);
+}
+
+TINLINE i64 tatomic_load_i64(volatile i64* ptr, tatomic_order order){
+    return __atomic_load_n(ptr, order);
+}
+
+TINLINE void tatomic_store_i64(volatile i64* ptr, i64 value, tatomic_order order){
+    __atomic_store_n(ptr, value, order);
+}
+
+/** @brief Adds value to ptr, returning the previous value. */
+TINLINE i64 tatomic_fetch_add_i64(volatile i64* ptr, i64 value, tatomic_order order){
+    return __atomic_fetch_add(ptr, value, order);
+}
+
+/**
+ * @brief Sets ptr to desired if it currently holds *expected. On failure, *expected
+ * receives the current value.
+ * @return True if the exchange happened; otherwise false.
+ */
+TINLINE b8 tatomic_compare_exchange_i64(volatile i64* ptr, i64* expected, i64 desired, tatomic_order order){
+    return __atomic_compare_exchange_n(ptr, expected, desired, FALSE, order, TATOMIC_RELAXED);
+}
+
+TINLINE u64 tatomic_load_u64(volatile u64* ptr, tatomic_order order){
+    return __atomic_load_n(ptr, order);
+}
+
+TINLINE void tatomic_store_u64(volatile u64* ptr, u64 value, tatomic_order order){
+    __atomic_store_n(ptr, value, order);
+}
+
+/** @brief Adds value to ptr, returning the previous value. */
+TINLINE u64 tatomic_fetch_add_u64(volatile u64* ptr, u64 value, tatomic_order order){
+    return __atomic_fetch_add(ptr, value, order);
+}
+
+/**
+ * @brief Sets ptr to desired if it currently holds *expected. On failure, *expected
+ * receives the current value.
+ * @return True if the exchange happened; otherwise false.
+ */
+TINLINE b8 tatomic_compare_exchange_u64(volatile u64* ptr, u64* expected, u64 desired, tatomic_order order){
+    return __atomic_compare_exchange_n(ptr, expected, desired, FALSE, order, TATOMIC_RELAXED);
+}
+
+/** @brief Sets ptr to the greater of its current value and value. */
+TINLINE void tatomic_max_u64(volatile u64* ptr, u64 value){
+    u64 current = __atomic_load_n(ptr, TATOMIC_RELAXED);
+    while(current < value && !__atomic_compare_exchange_n(ptr, &current, value, TRUE, TATOMIC_RELAXED, TATOMIC_RELAXED)){
+    }
+}
+
+/** @brief Issues a full memory fence with the given ordering. */
+TINLINE void tatomic_thread_fence(tatomic_order order){
+    __atomic_thread_fence(order);
+}
+
+/** @brief Hints to the CPU that the calling thread is spin-waiting. */
+TINLINE void tatomic_pause(){
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+    _mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    __asm__ __volatile__("yield");
+#endif
+}
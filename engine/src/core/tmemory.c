@@ -3,7 +3,9 @@
 #include "core/logger.h"
 #include "core/tstring.h"
 #include "core/tmutex.h"
+#include "core/tatomic.h"
 #include "platform/platform.h"
+#include "platform/filesystem.h"
 
 #include "memory/dynamic_allocator.h"
 
@@ -11,11 +13,7 @@
 // TODO: custom string lib
 #include <string.h>
 #include <stdio.h>
-struct memory_stats{
-    u64 total_allocated;
-    u64 tagged_allocations[MEMORY_TAG_MAX_TAGS];
-};
-
+#include <stdarg.h>
 static const char* memory_tag_strings[MEMORY_TAG_MAX_TAGS] = {
     "UNKNOWN            ",
     "ARRAY              ",
@@ -39,19 +37,107 @@ static const char* memory_tag_strings[MEMORY_TAG_MAX_TAGS] = {
 
 };
 
+// Small allocations are rounded up to one of these size classes (16, 32, ... 512 bytes)
+// and served from a per-thread cache, so most of them never touch allocation_mutex.
+#define MEMORY_CACHE_CLASS_COUNT 6
+#define MEMORY_CACHE_MIN_CLASS_SIZE 16
+#define MEMORY_CACHE_MAX_SIZE (MEMORY_CACHE_MIN_CLASS_SIZE << (MEMORY_CACHE_CLASS_COUNT - 1))
+// The number of blocks moved between a thread cache and the global allocator at once.
+#define MEMORY_CACHE_BATCH_SIZE 32
+// A bin holding more blocks than this hands a batch back to the global allocator.
+#define MEMORY_CACHE_MAX_BLOCKS (MEMORY_CACHE_BATCH_SIZE * 2)
+// Threads beyond this many at once share the global path, including its stats.
+// Caches of threads that have exited are handed to new threads.
+#define MEMORY_MAX_THREAD_CACHES 64
+
+/**
+ * Allocation counters owned by one thread. Only the owner writes them. Every field is
+ * a u64 count, so two sets merge word by word.
+ */
+typedef struct memory_thread_stats {
+    // These wrap below zero when a thread frees more than it allocated; the totals across threads are still exact.
+    volatile u64 total_allocated;
+    volatile u64 tagged_allocations[MEMORY_TAG_MAX_TAGS];
+    volatile u64 alloc_count;
+#if TMEMORY_TELEMETRY
+    volatile u64 tag_alloc_counts[MEMORY_TAG_MAX_TAGS];
+    volatile u64 tag_free_counts[MEMORY_TAG_MAX_TAGS];
+    volatile u64 size_histograms[MEMORY_TAG_MAX_TAGS][MEMORY_SIZE_HISTOGRAM_BUCKETS];
+#endif
+} memory_thread_stats;
+
+/** Free blocks of a single size class, linked through their first bytes. */
+typedef struct memory_cache_bin {
+    void* head;
+    u32 count;
+} memory_cache_bin;
+
+typedef struct memory_thread_cache {
+    memory_cache_bin bins[MEMORY_CACHE_CLASS_COUNT];
+    memory_thread_stats stats;
+    // Keep neighbouring caches off each other's cache lines.
+    u8 padding[64];
+} memory_thread_cache;
+
+#if TMEMORY_TELEMETRY
+// Call sites live in a fixed open-addressing table. Allocations from sites that don't fit are only counted.
+#define MEMORY_CALL_SITE_CAPACITY 2048
+
+/** Allocations made from one source location with one tag. */
+typedef struct memory_call_site {
+    // Zero for an empty slot.
+    const char* file;
+    u32 line;
+    memory_tag tag;
+    u64 alloc_count;
+    u64 total_bytes;
+} memory_call_site;
+
+typedef struct memory_telemetry {
+    // The per-tag counts live with the thread stats. Peaks need a total across threads, so they
+    // are only sampled when the stats are gathered, which happens at least once a frame.
+    // Guarded by allocation_mutex.
+    u64 peak_bytes[MEMORY_TAG_MAX_TAGS];
+    // Guards everything below.
+    tmutex call_site_mutex;
+    u32 call_site_count;
+    u64 dropped_call_site_allocs;
+    memory_call_site call_sites[MEMORY_CALL_SITE_CAPACITY];
+} memory_telemetry;
+#endif
+
 typedef struct memory_system_state {
     memory_system_configuration config;
-    struct memory_stats stats;
-    u64 alloc_count;
+    // Stats for threads without a cache of their own, plus those of exited threads. Guarded by allocation_mutex.
+    memory_thread_stats stats;
     u64 allocator_memory_requirement;
     dynamic_allocator allocator;
     void* allocator_block;
     // A mutex for allocations/frees
     tmutex allocation_mutex;
+
+    memory_thread_cache thread_caches[MEMORY_MAX_THREAD_CACHES];
+    // How many caches have ever been claimed. Guarded by allocation_mutex, along with the free list.
+    volatile i32 thread_cache_count;
+    // Caches given back by exited threads.
+    u32 free_thread_caches[MEMORY_MAX_THREAD_CACHES];
+    u32 free_thread_cache_count;
+
+    // The allocation count when memory_system_begin_frame was last called.
+    u64 frame_start_alloc_count;
+#if TMEMORY_TELEMETRY
+    memory_telemetry telemetry;
+#endif
 } memory_system_state;
 
 static memory_system_state* state_ptr;
 
+// Bumped on every initialize so threads notice their cache belongs to an old memory system.
+static volatile i32 memory_system_generation = 0;
+
+static _Thread_local memory_thread_cache* thread_cache = 0;
+static _Thread_local i32 thread_cache_generation = -1;
+
 b8 memory_system_initialize(memory_system_configuration config){
     // The amount needed by the system state.
     u64 state_memory_requirement = sizeof(memory_system_state);
@@ -70,7 +156,6 @@ b8 memory_system_initialize(memory_system_configuration config){
     // The state is in the first part of the massive block of memory.
     state_ptr = (memory_system_state*)block;
     state_ptr->config = config;
-    state_ptr->alloc_count = 0;
     state_ptr->allocator_memory_requirement = alloc_requirement;
 
     platform_zero_memory(&state_ptr->stats, sizeof(state_ptr->stats));
@@ -93,6 +178,20 @@ b8 memory_system_initialize(memory_system_configuration config){
         return FALSE;
     }
 
+    platform_zero_memory(state_ptr->thread_caches, sizeof(state_ptr->thread_caches));
+    state_ptr->thread_cache_count = 0;
+    state_ptr->free_thread_cache_count = 0;
+    state_ptr->frame_start_alloc_count = 0;
+
+#if TMEMORY_TELEMETRY
+    platform_zero_memory(&state_ptr->telemetry, sizeof(state_ptr->telemetry));
+    if(!tmutex_create(&state_ptr->telemetry.call_site_mutex)){
+        TFATAL("Unable to create call site mutex!");
+        return FALSE;
+    }
+#endif
+    tatomic_fetch_add_i32(&memory_system_generation, 1, TATOMIC_RELEASE);
+
     TDEBUG("Memory system successfully allocated %llu bytes.", config.total_alloc_size);
     return TRUE;
 }
@@ -101,6 +200,9 @@ void memory_system_shutdown(){
     if(state_ptr){
         // Destroy allocation mutex
         tmutex_destroy(&state_ptr->allocation_mutex);
+#if TMEMORY_TELEMETRY
+        tmutex_destroy(&state_ptr->telemetry.call_site_mutex);
+#endif
 
         dynamic_allocator_destroy(&state_ptr->allocator);
         // Free the entire block
@@ -109,36 +211,289 @@ void memory_system_shutdown(){
     state_ptr = 0;
 }
 
-void* tallocate(u64 size, memory_tag tag){
+/** Returns the size class index for the given size, or -1 if it is too large to be cached. */
+static i32 size_class_index(u64 size){
+    if(size > MEMORY_CACHE_MAX_SIZE){
+        return -1;
+    }
+    i32 index = 0;
+    u64 class_size = MEMORY_CACHE_MIN_CLASS_SIZE;
+    while(class_size < size){
+        class_size <<= 1;
+        index++;
+    }
+    return index;
+}
+
+/** Gets the calling thread's cache, claiming one on first use. Returns 0 if none are left. */
+static memory_thread_cache* get_thread_cache(){
+    i32 generation = tatomic_load_i32(&memory_system_generation, TATOMIC_ACQUIRE);
+    if(thread_cache_generation == generation){
+        return thread_cache;
+    }
+
+    thread_cache_generation = generation;
+    thread_cache = 0;
+    if(!tmutex_lock(&state_ptr->allocation_mutex)){
+        TERROR("Unable to obtain mutex lock for claiming a thread cache.");
+        return 0;
+    }
+    if(state_ptr->free_thread_cache_count > 0){
+        thread_cache = &state_ptr->thread_caches[state_ptr->free_thread_caches[--state_ptr->free_thread_cache_count]];
+    }else if(state_ptr->thread_cache_count < MEMORY_MAX_THREAD_CACHES){
+        thread_cache = &state_ptr->thread_caches[state_ptr->thread_cache_count];
+        tatomic_store_i32(&state_ptr->thread_cache_count, state_ptr->thread_cache_count + 1, TATOMIC_RELEASE);
+    }
+    tmutex_unlock(&state_ptr->allocation_mutex);
+    return thread_cache;
+}
+
+TINLINE void stat_add(volatile u64* stat, u64 value){
+    // Only the owning thread writes, so no read-modify-write is needed, just a tear-free store for readers.
+    tatomic_store_u64(stat, tatomic_load_u64(stat, TATOMIC_RELAXED) + value, TATOMIC_RELAXED);
+}
+
+/** Adds every count in from to into, which the caller must own. */
+static void stats_merge(memory_thread_stats* into, memory_thread_stats* from){
+    volatile u64* into_counts = (volatile u64*)into;
+    volatile u64* from_counts = (volatile u64*)from;
+    for(u64 i = 0; i < sizeof(memory_thread_stats) / sizeof(u64); ++i){
+        stat_add(&into_counts[i], tatomic_load_u64(&from_counts[i], TATOMIC_RELAXED));
+    }
+}
+
+#if TMEMORY_TELEMETRY
+/** Returns the histogram bucket for the given size, floor(log2(size)) clamped to the bucket range. */
+static u32 size_histogram_bucket(u64 size){
+    u32 bucket = 0;
+    while(size > 1 && bucket < MEMORY_SIZE_HISTOGRAM_BUCKETS - 1){
+        size >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+#endif
+
+/** Counts an allocation in the caller's own stats, or the shared stats with allocation_mutex held. */
+static void stats_record_allocate(memory_thread_stats* stats, u64 size, memory_tag tag){
+    stat_add(&stats->total_allocated, size);
+    stat_add(&stats->tagged_allocations[tag], size);
+    stat_add(&stats->alloc_count, 1);
+#if TMEMORY_TELEMETRY
+    stat_add(&stats->tag_alloc_counts[tag], 1);
+    stat_add(&stats->size_histograms[tag][size_histogram_bucket(size)], 1);
+#endif
+}
+
+/** Counts a free, with the same ownership rules as stats_record_allocate. */
+static void stats_record_free(memory_thread_stats* stats, u64 size, memory_tag tag){
+    stat_add(&stats->total_allocated, -size);
+    stat_add(&stats->tagged_allocations[tag], -size);
+#if TMEMORY_TELEMETRY
+    stat_add(&stats->tag_free_counts[tag], 1);
+#endif
+}
+
+/** Takes a batch of blocks from the global allocator under a single lock. */
+static void* refill_bin(memory_cache_bin* bin, u64 class_size){
+    if(!tmutex_lock(&state_ptr->allocation_mutex)){
+        TFATAL("Error obtaining mutex lock during allocation.");
+        return 0;
+    }
+    for(u32 i = 0; i < MEMORY_CACHE_BATCH_SIZE; ++i){
+        void* block = dynamic_allocator_allocate(&state_ptr->allocator, class_size);
+        if(!block){
+            break;
+        }
+        *(void**)block = bin->head;
+        bin->head = block;
+        bin->count++;
+    }
+    tmutex_unlock(&state_ptr->allocation_mutex);
+
+    if(!bin->head){
+        return 0;
+    }
+    void* block = bin->head;
+    bin->head = *(void**)block;
+    bin->count--;
+    return block;
+}
+
+/** Returns a batch of blocks to the global allocator under a single lock. */
+static void flush_bin(memory_cache_bin* bin, u64 class_size){
+    if(!tmutex_lock(&state_ptr->allocation_mutex)){
+        TFATAL("Unable to obtain mutex lock for free operation. Heap corruption is likely.");
+        return;
+    }
+    for(u32 i = 0; i < MEMORY_CACHE_BATCH_SIZE && bin->head; ++i){
+        void* block = bin->head;
+        bin->head = *(void**)block;
+        bin->count--;
+        dynamic_allocator_free(&state_ptr->allocator, block, class_size);
+    }
+    tmutex_unlock(&state_ptr->allocation_mutex);
+}
+
+void memory_system_thread_exit(){
+    memory_thread_cache* cache = thread_cache;
+    b8 current = state_ptr && thread_cache_generation == tatomic_load_i32(&memory_system_generation, TATOMIC_ACQUIRE);
+    thread_cache = 0;
+    thread_cache_generation = -1;
+    if(!current || !cache){
+        return;
+    }
+
+    if(!tmutex_lock(&state_ptr->allocation_mutex)){
+        TERROR("Unable to obtain mutex lock for releasing a thread cache. Its blocks are lost.");
+        return;
+    }
+    for(u32 i = 0; i < MEMORY_CACHE_CLASS_COUNT; ++i){
+        memory_cache_bin* bin = &cache->bins[i];
+        while(bin->head){
+            void* block = bin->head;
+            bin->head = *(void**)block;
+            dynamic_allocator_free(&state_ptr->allocator, block, MEMORY_CACHE_MIN_CLASS_SIZE << i);
+        }
+        bin->count = 0;
+    }
+
+    // Fold the thread's counts into the shared stats, so the slot can start over from zero.
+    stats_merge(&state_ptr->stats, &cache->stats);
+    platform_zero_memory(&cache->stats, sizeof(memory_thread_stats));
+
+    state_ptr->free_thread_caches[state_ptr->free_thread_cache_count++] = (u32)(cache - state_ptr->thread_caches);
+    tmutex_unlock(&state_ptr->allocation_mutex);
+}
+
+/** Indicates if the block came from the memory system's allocator rather than the platform. */
+static b8 owns_block(void* block){
+    return block >= state_ptr->allocator_block && block < state_ptr->allocator_block + state_ptr->allocator_memory_requirement;
+}
+
+#if TMEMORY_TELEMETRY
+static void telemetry_record_call_site(u64 size, memory_tag tag, const char* file, u32 line){
+    memory_telemetry* telemetry = &state_ptr->telemetry;
+    if(!tmutex_lock(&telemetry->call_site_mutex)){
+        TERROR("Unable to obtain mutex lock for recording an allocation call site.");
+        return;
+    }
+
+    // __FILE__ is a string literal, so sites can be told apart by pointer.
+    u64 hash = ((u64)file >> 3) * 0x9E3779B97F4A7C15ull ^ ((u64)line << 5) ^ tag;
+    u32 index = (u32)(hash ^ (hash >> 32)) & (MEMORY_CALL_SITE_CAPACITY - 1);
+    for(u32 probe = 0; probe < MEMORY_CALL_SITE_CAPACITY; ++probe){
+        memory_call_site* site = &telemetry->call_sites[index];
+        if(!site->file){
+            // Keep one slot free so lookups of new sites always terminate.
+            if(telemetry->call_site_count >= MEMORY_CALL_SITE_CAPACITY - 1){
+                break;
+            }
+            site->file = file;
+            site->line = line;
+            site->tag = tag;
+            telemetry->call_site_count++;
+        }
+        if(site->file == file && site->line == line && site->tag == tag){
+            site->alloc_count++;
+            site->total_bytes += size;
+            tmutex_unlock(&telemetry->call_site_mutex);
+            return;
+        }
+        index = (index + 1) & (MEMORY_CALL_SITE_CAPACITY - 1);
+    }
+
+    telemetry->dropped_call_site_allocs++;
+    tmutex_unlock(&telemetry->call_site_mutex);
+}
+#endif
+
+// Parenthesized so the call-site macros in tmemory.h don't expand here.
+void* (tallocate)(u64 size, memory_tag tag){
+    return tallocate_at(size, TMEMORY_DEFAULT_ALIGNMENT, TRUE, tag, 0, 0);
+}
+
+void* (tallocate_aligned)(u64 size, u16 alignment, memory_tag tag){
+    return tallocate_at(size, alignment, TRUE, tag, 0, 0);
+}
+
+void* (tallocate_uninitialized)(u64 size, u16 alignment, memory_tag tag){
+    return tallocate_at(size, alignment, FALSE, tag, 0, 0);
+}
+
+void* tallocate_at(u64 size, u16 alignment, b8 zero_memory, memory_tag tag, const char* file, u32 line){
+    if(alignment & (alignment - 1)){
+        TERROR("tallocate requires a power of two alignment, got %hu.", alignment);
+        return 0;
+    }
+
     if(tag == MEMORY_TAG_UNKNOWN){
-        TWARN("tallocate called using MEMORY_TAG_UNKNOWN. Re-class this allocation.");
+        if(file){
+            TWARN("tallocate called using MEMORY_TAG_UNKNOWN at %s:%u. Re-class this allocation.", file, line);
+        }else{
+            TWARN("tallocate called using MEMORY_TAG_UNKNOWN. Re-class this allocation.");
+        }
     }
 
     // Either allocate from the system's allocator or the OS. The latter shouldn't ever
     // really happen.
     void* block = 0;
     if(state_ptr){
-        // Make sure multithreaded requests don't trample each other.
-        if(!tmutex_lock(&state_ptr->allocation_mutex)){
-            TFATAL("Error obtaining mutex lock during allocation.");
-            return 0;
-        }
+        memory_thread_cache* cache = get_thread_cache();
+        i32 class_index = size_class_index(size);
 
-        state_ptr->stats.total_allocated += size;
-        state_ptr->stats.tagged_allocations[tag] += size;
-        state_ptr->alloc_count++;
+        if(cache){
+            stats_record_allocate(&cache->stats, size, tag);
+        }
 
-        block = dynamic_allocator_allocate(&state_ptr->allocator, size);
-        tmutex_unlock(&state_ptr->allocation_mutex);
+        // Cached blocks only carry the default alignment. Over-aligned small blocks are still
+        // exactly class sized, so tfree can cache them like any other.
+        if(cache && class_index >= 0 && size && alignment <= TMEMORY_DEFAULT_ALIGNMENT){
+            memory_cache_bin* bin = &cache->bins[class_index];
+            if(bin->head){
+                block = bin->head;
+                bin->head = *(void**)block;
+                bin->count--;
+            }else{
+                block = refill_bin(bin, MEMORY_CACHE_MIN_CLASS_SIZE << class_index);
+            }
+        }else{
+            // Make sure multithreaded requests don't trample each other.
+            if(!tmutex_lock(&state_ptr->allocation_mutex)){
+                TFATAL("Error obtaining mutex lock during allocation.");
+                return 0;
+            }
+
+            if(!cache){
+                stats_record_allocate(&state_ptr->stats, size, tag);
+            }
+
+            // Small blocks are always sized to their class, whichever path they take,
+            // so that any thread can later cache them.
+            u64 allocation_size = class_index >= 0 && size ? (u64)MEMORY_CACHE_MIN_CLASS_SIZE << class_index : size;
+            block = dynamic_allocator_allocate_aligned(&state_ptr->allocator, allocation_size, alignment);
+            tmutex_unlock(&state_ptr->allocation_mutex);
+        }
     } else {
         // If the system is not up yet, warn about it but give memory form now.
         TWARN("tallocate called before the memory system is initialized.");
-        // TODO: Memory alignment
-        block = platform_allocate(size, FALSE);
+        // The platform allocator only guarantees the default alignment, and tfree has no way to undo more.
+        if(alignment > TMEMORY_DEFAULT_ALIGNMENT){
+            TERROR("tallocate cannot align to %hu bytes before the memory system is initialized.", alignment);
+        }else{
+            block = platform_allocate(size, FALSE);
+        }
     }
 
     if(block){
-        platform_zero_memory(block, size);
+#if TMEMORY_TELEMETRY
+        if(state_ptr && file){
+            telemetry_record_call_site(size, tag, file, line);
+        }
+#endif
+        if(zero_memory){
+            platform_zero_memory(block, size);
+        }
         return block;
     }
     
@@ -152,23 +507,47 @@ void tfree(void* block, u64 size, memory_tag tag){
     }
 
     if(state_ptr){
+        memory_thread_cache* cache = get_thread_cache();
+        i32 class_index = size_class_index(size);
+
+        if(cache){
+            stats_record_free(&cache->stats, size, tag);
+        }
+
+        // Blocks allocated before the memory system started came from the platform and must go back there.
+        if(cache && class_index >= 0 && size && owns_block(block)){
+            memory_cache_bin* bin = &cache->bins[class_index];
+            *(void**)block = bin->head;
+            bin->head = block;
+            bin->count++;
+            if(bin->count > MEMORY_CACHE_MAX_BLOCKS){
+                flush_bin(bin, MEMORY_CACHE_MIN_CLASS_SIZE << class_index);
+            }
+            return;
+        }
+
         // Make sure multithreaded requests don't trample each other.
         if(!tmutex_lock(&state_ptr->allocation_mutex)){
             TFATAL("Unable to obtain mutex lock for free operation. Heap corruption is likely.");
             return;
         }
 
-        state_ptr->stats.total_allocated -= size;
-        state_ptr->stats.tagged_allocations[tag] -= size;
-        b8 result = dynamic_allocator_free(&state_ptr->allocator, block, size);
+        if(!cache){
+            stats_record_free(&state_ptr->stats, size, tag);
+        }
+        b8 owned = owns_block(block);
+        if(owned){
+            u64 allocation_size = class_index >= 0 && size ? (u64)MEMORY_CACHE_MIN_CLASS_SIZE << class_index : size;
+            if(!dynamic_allocator_free(&state_ptr->allocator, block, allocation_size)){
+                // The block is inside the heap, so the platform never handed it out. It is lost.
+                TERROR("tfree failed to return block %p (%llu bytes) to the memory system.", block, size);
+            }
+        }
 
         tmutex_unlock(&state_ptr->allocation_mutex);
 
-        // If the free failed, it's possible this is because the allocation was made
-        // before this system was started up. Since this absolutely should be an exception
-        // to the rule, try freeing it on the platform level. If this fails, some other
-        // brean of skulduggery is afoot, and we have bugger problems on our hands.
-        if(!result){
+        // Only blocks allocated before this system started up came from the platform.
+        if(!owned){
             // TODO: Memory alignment
             platform_free(block, FALSE);
         }
@@ -191,34 +570,78 @@ void* tset_memory(void* dest, i32 value, u64 size){
     return platform_set_memory(dest, value, size);
 }
 
-char* get_memory_usage_str(){
+/**
+ * Merges the shared stats with every thread's own counters. With telemetry, this is also
+ * when tag peaks are sampled; out_peak_bytes may be 0 if they are not wanted.
+ */
+static void gather_stats(memory_thread_stats* out_stats, u64* out_peak_bytes){
+    // Held throughout, so a thread exiting can't move its counts to the shared stats midway.
+    if(!tmutex_lock(&state_ptr->allocation_mutex)){
+        TERROR("Unable to obtain mutex lock for reading memory stats.");
+    }
+    platform_zero_memory(out_stats, sizeof(memory_thread_stats));
+    stats_merge(out_stats, &state_ptr->stats);
+
+    i32 cache_count = tatomic_load_i32(&state_ptr->thread_cache_count, TATOMIC_ACQUIRE);
+    for(i32 i = 0; i < cache_count; ++i){
+        stats_merge(out_stats, &state_ptr->thread_caches[i].stats);
+    }
+
+#if TMEMORY_TELEMETRY
+    u64* peaks = state_ptr->telemetry.peak_bytes;
+    for(u32 tag = 0; tag < MEMORY_TAG_MAX_TAGS; ++tag){
+        if(out_stats->tagged_allocations[tag] > peaks[tag]){
+            peaks[tag] = out_stats->tagged_allocations[tag];
+        }
+    }
+    if(out_peak_bytes){
+        tcopy_memory(out_peak_bytes, peaks, sizeof(state_ptr->telemetry.peak_bytes));
+    }
+#endif
+    tmutex_unlock(&state_ptr->allocation_mutex);
+}
+
+/** Scales a byte count to the largest fitting unit, writing the unit's name to out_unit. */
+static float scale_bytes(u64 bytes, char out_unit[4]){
     const u64 gib = 1024 * 1024 * 1024;
     const u64 mib = 1024 * 1024;
     const u64 kib = 1024;
+
+    string_ncopy(out_unit, "xiB", 4);
+    if(bytes >= gib){
+        out_unit[0] = 'G';
+        return bytes / (float)gib;
+    }else if(bytes >= mib){
+        out_unit[0] = 'M';
+        return bytes / (float)mib;
+    }else if(bytes >= kib){
+        out_unit[0] = 'K';
+        return bytes / (float)kib;
+    }
+    out_unit[0] = 'B';
+    out_unit[1] = 0;
+    return (float)bytes;
+}
+
+char* get_memory_usage_str(){
+    memory_thread_stats stats;
+    u64 peak_bytes[MEMORY_TAG_MAX_TAGS];
+    gather_stats(&stats, peak_bytes);
  
     char buffer[8000] = "System memory use (tagged): \n";
     u64 offset = strlen(buffer);
 
     for(u32 i = 0; i < MEMORY_TAG_MAX_TAGS; i++){
-        char unit[4] = "xiB";
-        float amount = 1.0f;
-
-        if(state_ptr->stats.tagged_allocations[i] >= gib){
-            unit[0] = 'G';
-            amount = state_ptr->stats.tagged_allocations[i] / (float)gib;
-        }else if(state_ptr->stats.tagged_allocations[i] >= mib){
-            unit[0] = 'M';
-            amount = state_ptr->stats.tagged_allocations[i] / (float)mib;
-        }else if(state_ptr->stats.tagged_allocations[i] >= kib){
-            unit[0] = 'K';
-            amount = state_ptr->stats.tagged_allocations[i] / (float)kib;
-        }else{
-            unit[0] = 'B';
-            unit[1] = 0;
-            amount = (float)state_ptr->stats.tagged_allocations[i];
-        }
-
-        i32 length = snprintf(buffer + offset, 8000, "  %s: %.2f%s\n", memory_tag_strings[i], amount, unit);
+        char unit[4];
+        float amount = scale_bytes(stats.tagged_allocations[i], unit);
+
+#if TMEMORY_TELEMETRY
+        char peak_unit[4];
+        float peak_amount = scale_bytes(peak_bytes[i], peak_unit);
+        i32 length = snprintf(buffer + offset, 8000 - offset, "  %s: %.2f%s (peak %.2f%s)\n", memory_tag_strings[i], amount, unit, peak_amount, peak_unit);
+#else
+        i32 length = snprintf(buffer + offset, 8000 - offset, "  %s: %.2f%s\n", memory_tag_strings[i], amount, unit);
+#endif
         offset += length;
     }
 
@@ -228,8 +651,143 @@ char* get_memory_usage_str(){
 
 u64 get_memory_alloc_count(){
    if(state_ptr){
-    return state_ptr->alloc_count;
+    memory_thread_stats stats;
+    gather_stats(&stats, 0);
+    return stats.alloc_count;
    }
    
    return 0;
-}
\ No newline at end of file
+}
+
+void memory_system_begin_frame(){
+    if(state_ptr){
+        state_ptr->frame_start_alloc_count = get_memory_alloc_count();
+    }
+}
+
+u64 get_memory_frame_alloc_count(){
+    if(state_ptr){
+        return get_memory_alloc_count() - state_ptr->frame_start_alloc_count;
+    }
+    return 0;
+}
+
+b8 get_memory_tag_stats(memory_tag tag, memory_tag_stats* out_stats){
+#if TMEMORY_TELEMETRY
+    if(!state_ptr || tag >= MEMORY_TAG_MAX_TAGS || !out_stats){
+        return FALSE;
+    }
+    memory_thread_stats stats;
+    u64 peak_bytes[MEMORY_TAG_MAX_TAGS];
+    gather_stats(&stats, peak_bytes);
+    out_stats->current_bytes = stats.tagged_allocations[tag];
+    out_stats->peak_bytes = peak_bytes[tag];
+    out_stats->alloc_count = stats.tag_alloc_counts[tag];
+    out_stats->free_count = stats.tag_free_counts[tag];
+    for(u32 i = 0; i < MEMORY_SIZE_HISTOGRAM_BUCKETS; ++i){
+        out_stats->size_histogram[i] = stats.size_histograms[tag][i];
+    }
+    return TRUE;
+#else
+    return FALSE;
+#endif
+}
+
+#if TMEMORY_TELEMETRY
+/** Formats and writes a piece of the telemetry file. Clears *ok if anything fails to write. */
+static void write_json(file_handle* handle, b8* ok, const char* format, ...){
+    char buffer[1024];
+    va_list arg_ptr;
+    va_start(arg_ptr, format);
+    i32 length = vsnprintf(buffer, sizeof(buffer), format, arg_ptr);
+    va_end(arg_ptr);
+    if(length < 0){
+        *ok = FALSE;
+        return;
+    }
+    if(length >= (i32)sizeof(buffer)){
+        length = sizeof(buffer) - 1;
+    }
+    u64 written = 0;
+    if(!filesystem_write(handle, length, buffer, &written) || written != (u64)length){
+        *ok = FALSE;
+    }
+}
+
+/** Returns the length of a tag name without the padding used for aligned printing. */
+static i32 tag_name_length(memory_tag tag){
+    i32 length = 0;
+    while(memory_tag_strings[tag][length] && memory_tag_strings[tag][length] != ' '){
+        length++;
+    }
+    return length;
+}
+#endif
+
+b8 memory_system_write_telemetry(const char* path){
+#if TMEMORY_TELEMETRY
+    if(!state_ptr){
+        return FALSE;
+    }
+
+    file_handle handle;
+    if(!filesystem_open(path, FILE_MODE_WRITE, FALSE, &handle)){
+        TERROR("Unable to open '%s' for writing memory telemetry.", path);
+        return FALSE;
+    }
+
+    memory_thread_stats stats;
+    gather_stats(&stats, 0);
+
+    b8 ok = TRUE;
+    write_json(&handle, &ok, "{\n  \"total_allocated\": %llu,\n  \"alloc_count\": %llu,\n  \"tags\": [\n", stats.total_allocated, stats.alloc_count);
+    for(u32 tag = 0; tag < MEMORY_TAG_MAX_TAGS; ++tag){
+        memory_tag_stats tag_stats;
+        get_memory_tag_stats(tag, &tag_stats);
+        write_json(&handle, &ok, "    {\"tag\": \"%.*s\", \"current_bytes\": %llu, \"peak_bytes\": %llu, \"alloc_count\": %llu, \"free_count\": %llu, \"size_histogram\": [",
+                   tag_name_length(tag), memory_tag_strings[tag], tag_stats.current_bytes, tag_stats.peak_bytes, tag_stats.alloc_count, tag_stats.free_count);
+        for(u32 i = 0; i < MEMORY_SIZE_HISTOGRAM_BUCKETS; ++i){
+            write_json(&handle, &ok, i ? ", %llu" : "%llu", tag_stats.size_histogram[i]);
+        }
+        write_json(&handle, &ok, tag + 1 < MEMORY_TAG_MAX_TAGS ? "]},\n" : "]}\n");
+    }
+
+    memory_telemetry* telemetry = &state_ptr->telemetry;
+    if(!tmutex_lock(&telemetry->call_site_mutex)){
+        TERROR("Unable to obtain mutex lock for reading allocation call sites.");
+        filesystem_close(&handle);
+        return FALSE;
+    }
+    write_json(&handle, &ok, "  ],\n  \"dropped_call_site_allocs\": %llu,\n  \"call_sites\": [", telemetry->dropped_call_site_allocs);
+    b8 first = TRUE;
+    for(u32 i = 0; i < MEMORY_CALL_SITE_CAPACITY; ++i){
+        memory_call_site* site = &telemetry->call_sites[i];
+        if(!site->file){
+            continue;
+        }
+        // Windows paths use backslashes, which would need escaping in JSON.
+        char file[512];
+        string_ncopy(file, site->file, sizeof(file) - 1);
+        file[sizeof(file) - 1] = 0;
+        for(char* c = file; *c; ++c){
+            if(*c == '\\' || *c == '"'){
+                *c = '/';
+            }
+        }
+        write_json(&handle, &ok, "%s\n    {\"file\": \"%s\", \"line\": %u, \"tag\": \"%.*s\", \"alloc_count\": %llu, \"total_bytes\": %llu}",
+                   first ? "" : ",", file, site->line, tag_name_length(site->tag), memory_tag_strings[site->tag], site->alloc_count, site->total_bytes);
+        first = FALSE;
+    }
+    tmutex_unlock(&telemetry->call_site_mutex);
+    write_json(&handle, &ok, "\n  ]\n}\n");
+
+    filesystem_close(&handle);
+    if(!ok){
+        TERROR("Failed to write memory telemetry to '%s'.", path);
+    }
+    return ok;
+#else
+    TWARN("memory_system_write_telemetry called with TMEMORY_TELEMETRY disabled.");
+    return FALSE;
+#endif
+}
@@ -27,6 +27,40 @@ typedef enum memory_tag{
     MEMORY_TAG_MAX_TAGS
 } memory_tag;
 
+// Allocation telemetry: per-tag peaks, allocation counts and size histograms.
+// The counts are kept per thread and merged when read, so an allocation only pays for a
+// couple of uncontended stores. Still compiled out of release builds.
+#ifndef TMEMORY_TELEMETRY
+    #if TRELEASE == 1
+        #define TMEMORY_TELEMETRY 0
+    #else
+        #define TMEMORY_TELEMETRY 1
+    #endif
+#endif
+
+// Call-site attribution routes the tallocate family through tallocate_at with __FILE__/__LINE__.
+// Each allocation then also takes a lock, so this is opt-in on top of telemetry.
+#ifndef TMEMORY_TRACK_CALL_SITES
+    #define TMEMORY_TRACK_CALL_SITES 0
+#endif
+
+/** @brief Size histogram buckets. Bucket n counts allocations of [2^n, 2^(n+1)) bytes; the last bucket takes everything larger. */
+#define MEMORY_SIZE_HISTOGRAM_BUCKETS 32
+
+/** @brief Telemetry gathered for one memory tag. */
+typedef struct memory_tag_stats {
+    /** @brief The bytes currently allocated with the tag. */
+    u64 current_bytes;
+    /** @brief The most bytes allocated with the tag at once, as sampled each frame and whenever stats are read. */
+    u64 peak_bytes;
+    /** @brief The number of allocations made with the tag. */
+    u64 alloc_count;
+    /** @brief The number of frees made with the tag. */
+    u64 free_count;
+    /** @brief The number of allocations per power-of-two size bucket. */
+    u64 size_histogram[MEMORY_SIZE_HISTOGRAM_BUCKETS];
+} memory_tag_stats;
+
 /** @brief The configuration for the memory system. */
 typedef struct memory_system_configuration {
     /** @brief The total memory size in bytes used by the internal allocator for this system. */
@@ -44,8 +78,52 @@ TAPI b8 memory_system_initialize(memory_system_configuration config);
  */
 TAPI void memory_system_shutdown();
 
+/**
+ * @brief Returns the calling thread's cached blocks to the shared allocator and frees its
+ * cache for another thread to use. Threads started with tthread_create call this as they
+ * finish; other threads should call it before exiting.
+ */
+TAPI void memory_system_thread_exit();
+
+/** @brief The alignment of every block from tallocate. Also the largest alignment small blocks get from the thread caches. */
+#define TMEMORY_DEFAULT_ALIGNMENT 16
+
+/**
+ * @brief Allocates a zeroed block of memory, aligned to TMEMORY_DEFAULT_ALIGNMENT.
+ * @param size The size of the block in bytes.
+ * @param tag The tag to account the allocation under.
+ * @return The block, or 0 on failure.
+ */
 TAPI void* tallocate(u64 size, memory_tag tag);
 
+/**
+ * @brief Allocates a zeroed block of memory aligned to the given boundary.
+ * The block is freed with tfree and the same size, like any other.
+ * @param size The size of the block in bytes.
+ * @param alignment The alignment in bytes. Must be a power of two.
+ * @param tag The tag to account the allocation under.
+ * @return The block, or 0 on failure.
+ */
+TAPI void* tallocate_aligned(u64 size, u16 alignment, memory_tag tag);
+
+/**
+ * @brief Allocates like tallocate_aligned, but leaves the contents undefined. For buffers
+ * that are about to be overwritten in full, where zeroing would only cost bandwidth.
+ */
+TAPI void* tallocate_uninitialized(u64 size, u16 alignment, memory_tag tag);
+
+/**
+ * @brief The allocation function behind the tallocate family. Attributes the allocation to the
+ * given source location when call-site tracking is enabled; file may be 0.
+ */
+TAPI void* tallocate_at(u64 size, u16 alignment, b8 zero_memory, memory_tag tag, const char* file, u32 line);
+
+#if TMEMORY_TRACK_CALL_SITES
+    #define tallocate(size, tag) tallocate_at(size, TMEMORY_DEFAULT_ALIGNMENT, TRUE, tag, __FILE__, __LINE__)
+    #define tallocate_aligned(size, alignment, tag) tallocate_at(size, alignment, TRUE, tag, __FILE__, __LINE__)
+    #define tallocate_uninitialized(size, alignment, tag) tallocate_at(size, alignment, FALSE, tag, __FILE__, __LINE__)
+#endif
+
 TAPI void tfree(void* block, u64 size, memory_tag tag);
 
 TAPI void* tzero_memory(void* block, u64 size);
@@ -56,4 +134,31 @@ TAPI void* tset_memory(void* dest, i32 value, u64 size);
 
 TAPI char* get_memory_usage_str();
 
-TAPI u64 get_memory_alloc_count();
\ No newline at end of file
+TAPI u64 get_memory_alloc_count();
+
+/**
+ * @brief Marks the start of a frame for get_memory_frame_alloc_count.
+ */
+TAPI void memory_system_begin_frame();
+
+/**
+ * @brief Gets the number of allocations made since memory_system_begin_frame was last called.
+ * Should be zero once the application reaches a steady state.
+ */
+TAPI u64 get_memory_frame_alloc_count();
+
+/**
+ * @brief Gets the telemetry gathered for the given tag.
+ * @param tag The tag to get stats for.
+ * @param out_stats A pointer to hold the stats.
+ * @return True on success; false if telemetry is compiled out or the memory system is not running.
+ */
+TAPI b8 get_memory_tag_stats(memory_tag tag, memory_tag_stats* out_stats);
+
+/**
+ * @brief Writes all telemetry (per-tag stats, histograms and call sites) to the given path as JSON,
+ * for comparing allocation behaviour between builds offline.
+ * @param path The path of the file to write.
+ * @return True on success; otherwise false.
+ */
+TAPI b8 memory_system_write_telemetry(const char* path);
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "defines.h"
+
+/** @brief Pass as the timeout to tsemaphore_wait to wait without a time limit. */
+#define TSEMAPHORE_WAIT_INFINITE INVALID_ID_U64
+
+/**
+ * A counting semaphore, used to put threads to sleep until another
+ * thread signals that there is something for them to do.
+ */
+typedef struct tsemaphore {
+    void *internal_data;
+} tsemaphore;
+
+/**
+ * Creates a semaphore.
+ * @param out_semaphore A pointer to hold the created semaphore.
+ * @param max_count The maximum count the semaphore can reach.
+ * @param start_count The initial count.
+ * @returns True if created successfully; otherwise false.
+ */
+b8 tsemaphore_create(tsemaphore* out_semaphore, u32 max_count, u32 start_count);
+
+/**
+ * @brief Destroys the provided semaphore.
+ *
+ * @param semaphore A pointer to the semaphore to be destroyed.
+ */
+void tsemaphore_destroy(tsemaphore* semaphore);
+
+/**
+ * Increments the semaphore count, waking one waiting thread if there is one.
+ * @param semaphore A pointer to the semaphore.
+ * @returns True if signalled successfully; otherwise false.
+ */
+b8 tsemaphore_signal(tsemaphore* semaphore);
+
+/**
+ * Waits until the semaphore count is above zero, then decrements it.
+ * @param semaphore A pointer to the semaphore.
+ * @param timeout_ms The maximum time to wait in milliseconds, or TSEMAPHORE_WAIT_INFINITE.
+ * @returns True if the semaphore was acquired; false on timeout or error.
+ */
+b8 tsemaphore_wait(tsemaphore* semaphore, u64 timeout_ms);
@@ -24,7 +24,7 @@ typedef u32 (*pfn_thread_start)(void *);
  * @param out_thread A pointer to hold the created thread, if auto_detach is false.
  * @returns true if successfully created; otherwise false.
  */
-b8 tthread_create(pfn_thread_start start_function_ptr, void *params, b8 auto_detach, tthread *out_thread);
+TAPI b8 tthread_create(pfn_thread_start start_function_ptr, void *params, b8 auto_detach, tthread *out_thread);
 
 /**
  * Destroys the given thread.
@@ -41,6 +41,12 @@ void tthread_detach(tthread *thread);
  */
 void tthread_cancel(tthread *thread);
 
+/**
+ * Blocks the calling thread until the given thread has finished its work, then
+ * releases the thread's resources. The thread must not have been detached.
+ */
+TAPI void tthread_wait(tthread *thread);
+
 /**
  * Indicates if the thread is currently active.
  * @returns True if active; otherwise false.
@@ -10,7 +10,7 @@ extern b8 create_game(game* out_game);
 /**
  * The main entry point of the application.
  */
-int main(void){
+int main(int argc, char** argv){
 
     // Request the game instance from the application.
     game game_inst;
@@ -25,6 +25,11 @@ int main(void){
         return -2;
     }
 
+    // The command line overrides the game's configuration.
+    if(!application_config_parse_args(&game_inst.app_config, argc, argv)){
+        return -3;
+    }
+
     // Initialization.
     if(!application_create(&game_inst)){
         TINFO("Application failed to create!");
@@ -10,7 +10,7 @@
  * @param index_count The number of indices.
  * @param indices An array of vertices.
  */
-void geometry_generate_normals(u32 vertex_count, vertex_3d* vertices, u32 index_count, u32* indices);
+TAPI void geometry_generate_normals(u32 vertex_count, vertex_3d* vertices, u32 index_count, u32* indices);
 
 /**
  * @brief Calculates tangents for the given vertex and index data. Modifies vertices in place.
@@ -20,7 +20,7 @@ void geometry_generate_normals(u32 vertex_count, vertex_3d* vertices, u32 index_
  * @param index_count The number of indices.
  * @param indices An array of vertices.
  */
-void geometry_generate_tangents(u32 vertex_count, vertex_3d* vertices, u32 index_count, u32* indices);
+TAPI void geometry_generate_tangents(u32 vertex_count, vertex_3d* vertices, u32 index_count, u32* indices);
 
 /**
  * @brief De-duplicates vertices, leaving only unique ones. Leaves the original vertices array intact.
@@ -34,4 +34,4 @@ void geometry_generate_tangents(u32 vertex_count, vertex_3d* vertices, u32 index
  * @param out_vertex_count A pointer to hold the final vertex count.
  * @param out_vertices A pointer to hold the array of de-duplicated vertices.
  */
-void geometry_deduplicate_vertices(u32 vertex_count, vertex_3d* vertices, u32 index_count, u32* indices, u32* out_vertex_count, vertex_3d** out_vertices);
\ No newline at end of file
+TAPI void geometry_deduplicate_vertices(u32 vertex_count, vertex_3d* vertices, u32 index_count, u32* indices, u32* out_vertex_count, vertex_3d** out_vertices);
\ No newline at end of file
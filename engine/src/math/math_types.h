@@ -91,6 +91,35 @@ typedef struct extents_3d
     vec3 max;
 } extents_3d;
 
+/**
+ * @brief Represents a plane in 3d space. A point p is on the side the normal points
+ * to when dot(normal, p) + distance > 0.
+ */
+typedef struct plane_3d {
+    /** @brief The unit normal of the plane. */
+    vec3 normal;
+    /** @brief The signed distance of the plane from the origin, along the normal. */
+    f32 distance;
+} plane_3d;
+
+/** @brief The sides of a frustum, as indices into frustum.sides. */
+typedef enum frustum_side {
+    FRUSTUM_SIDE_LEFT,
+    FRUSTUM_SIDE_RIGHT,
+    FRUSTUM_SIDE_BOTTOM,
+    FRUSTUM_SIDE_TOP,
+    FRUSTUM_SIDE_NEAR,
+    FRUSTUM_SIDE_FAR,
+    FRUSTUM_SIDE_COUNT
+} frustum_side;
+
+/**
+ * @brief Represents a view frustum as six planes whose normals point inwards.
+ */
+typedef struct frustum {
+    plane_3d sides[FRUSTUM_SIDE_COUNT];
+} frustum;
+
 
 typedef struct vertex_3d {
     vec3 position;
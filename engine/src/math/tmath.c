@@ -56,4 +56,275 @@ f32 ftrandom(){
 
 f32 ftrandom_in_range(f32 min, f32 max){
     return min + ((float)trandom() / ((f32)RAND_MAX / (max - min)));
-}
\ No newline at end of file
+}
+
+const char* tmath_simd_name(){
+#if defined(TMATH_SSE)
+    return "SSE2";
+#elif defined(TMATH_NEON)
+    return "NEON";
+#else
+    return "scalar";
+#endif
+}
+
+void vec3_transform_batch(const vec3* points, u32 count, mat4 m, vec3* out_points){
+#if defined(TMATH_SSE)
+    // The matrix rows stay in registers for the whole batch.
+    __m128 r0 = _mm_loadu_ps(&m.data[0]);
+    __m128 r1 = _mm_loadu_ps(&m.data[4]);
+    __m128 r2 = _mm_loadu_ps(&m.data[8]);
+    __m128 r3 = _mm_loadu_ps(&m.data[12]);
+    for(u32 i = 0; i < count; ++i){
+        const vec3* p = &points[i];
+        __m128 r = _mm_mul_ps(_mm_set1_ps(p->x), r0);
+        r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(p->y), r1));
+        r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(p->z), r2));
+        r = _mm_add_ps(r, r3);
+        // vec3s are packed, so only write three lanes.
+        _mm_storel_pi((__m64*)out_points[i].elements, r);
+        _mm_store_ss(&out_points[i].z, _mm_movehl_ps(r, r));
+    }
+#elif defined(TMATH_NEON)
+    float32x4_t r0 = vld1q_f32(&m.data[0]);
+    float32x4_t r1 = vld1q_f32(&m.data[4]);
+    float32x4_t r2 = vld1q_f32(&m.data[8]);
+    float32x4_t r3 = vld1q_f32(&m.data[12]);
+    for(u32 i = 0; i < count; ++i){
+        const vec3* p = &points[i];
+        float32x4_t r = vmulq_f32(vdupq_n_f32(p->x), r0);
+        r = vaddq_f32(r, vmulq_f32(vdupq_n_f32(p->y), r1));
+        r = vaddq_f32(r, vmulq_f32(vdupq_n_f32(p->z), r2));
+        r = vaddq_f32(r, r3);
+        vst1_f32(out_points[i].elements, vget_low_f32(r));
+        out_points[i].z = vgetq_lane_f32(r, 2);
+    }
+#else
+    for(u32 i = 0; i < count; ++i){
+        out_points[i] = vec3_transform(points[i], m);
+    }
+#endif
+}
+
+void mat4_mul_batch(const mat4* matrices, u32 count, mat4 matrix, mat4* out_matrices){
+#if defined(TMATH_SSE)
+    // Each row of a result only reads the same row of its input, so this works in place.
+    __m128 b0 = _mm_loadu_ps(&matrix.data[0]);
+    __m128 b1 = _mm_loadu_ps(&matrix.data[4]);
+    __m128 b2 = _mm_loadu_ps(&matrix.data[8]);
+    __m128 b3 = _mm_loadu_ps(&matrix.data[12]);
+    for(u32 i = 0; i < count; ++i){
+        const f32* a = matrices[i].data;
+        f32* o = out_matrices[i].data;
+        for(u32 row = 0; row < 16; row += 4){
+            __m128 r = _mm_mul_ps(_mm_set1_ps(a[row + 0]), b0);
+            r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(a[row + 1]), b1));
+            r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(a[row + 2]), b2));
+            r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(a[row + 3]), b3));
+            _mm_storeu_ps(&o[row], r);
+        }
+    }
+#elif defined(TMATH_NEON)
+    float32x4_t b0 = vld1q_f32(&matrix.data[0]);
+    float32x4_t b1 = vld1q_f32(&matrix.data[4]);
+    float32x4_t b2 = vld1q_f32(&matrix.data[8]);
+    float32x4_t b3 = vld1q_f32(&matrix.data[12]);
+    for(u32 i = 0; i < count; ++i){
+        const f32* a = matrices[i].data;
+        f32* o = out_matrices[i].data;
+        for(u32 row = 0; row < 16; row += 4){
+            float32x4_t r = vmulq_f32(vdupq_n_f32(a[row + 0]), b0);
+            r = vaddq_f32(r, vmulq_f32(vdupq_n_f32(a[row + 1]), b1));
+            r = vaddq_f32(r, vmulq_f32(vdupq_n_f32(a[row + 2]), b2));
+            r = vaddq_f32(r, vmulq_f32(vdupq_n_f32(a[row + 3]), b3));
+            vst1q_f32(&o[row], r);
+        }
+    }
+#else
+    for(u32 i = 0; i < count; ++i){
+        out_matrices[i] = mat4_mul(matrices[i], matrix);
+    }
+#endif
+}
+
+frustum frustum_from_view_projection(mat4 view_projection){
+    // With row vectors, clip = p * view_projection, so each clip coordinate is a column. A point
+    // is inside when -w <= x, y, z <= w, which gives a plane per side as w plus or minus a column.
+    const f32* m = view_projection.data;
+    frustum f;
+    for(u32 side = 0; side < FRUSTUM_SIDE_COUNT; ++side){
+        u32 column = side / 2;
+        f32 sign = (side % 2) ? -1.0f : 1.0f;
+        vec3 normal = {.elements = {
+            m[0 + 3] + sign * m[0 + column],
+            m[4 + 3] + sign * m[4 + column],
+            m[8 + 3] + sign * m[8 + column]}};
+        f32 distance = m[12 + 3] + sign * m[12 + column];
+        f32 inverse_length = 1.0f / vec3_length(normal);
+        f.sides[side].normal = vec3_mul_scalar(normal, inverse_length);
+        f.sides[side].distance = distance * inverse_length;
+    }
+    return f;
+}
+
+b8 frustum_intersects_sphere(const frustum* f, vec3 center, f32 radius){
+    for(u32 i = 0; i < FRUSTUM_SIDE_COUNT; ++i){
+        const plane_3d* p = &f->sides[i];
+        if(vec3_dot(p->normal, center) + p->distance < -radius){
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+b8 frustum_intersects_aabb(const frustum* f, vec3 center, vec3 half_extents){
+    for(u32 i = 0; i < FRUSTUM_SIDE_COUNT; ++i){
+        const plane_3d* p = &f->sides[i];
+        // How far the box reaches towards the plane, from its center.
+        f32 radius =
+            half_extents.x * tabs(p->normal.x) +
+            half_extents.y * tabs(p->normal.y) +
+            half_extents.z * tabs(p->normal.z);
+        if(vec3_dot(p->normal, center) + p->distance < -radius){
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+#if defined(TMATH_SSE) || defined(TMATH_NEON)
+/**
+ * @brief The planes of a frustum laid out a component per array, so that four planes can be
+ * tested against one volume at once. The six planes are padded to eight by repeating the
+ * near and far planes.
+ */
+typedef struct frustum_lanes {
+    f32 x[8];
+    f32 y[8];
+    f32 z[8];
+    f32 d[8];
+} frustum_lanes;
+
+static void frustum_lanes_create(const frustum* f, frustum_lanes* out_lanes){
+    for(u32 i = 0; i < 8; ++i){
+        const plane_3d* p = &f->sides[i < FRUSTUM_SIDE_COUNT ? i : i - 2];
+        out_lanes->x[i] = p->normal.x;
+        out_lanes->y[i] = p->normal.y;
+        out_lanes->z[i] = p->normal.z;
+        out_lanes->d[i] = p->distance;
+    }
+}
+#endif
+
+u32 frustum_cull_spheres(const frustum* f, const vec3* centers, const f32* radii, u32 count, u32* out_visible_indices){
+    u32 visible_count = 0;
+#if defined(TMATH_SSE)
+    frustum_lanes lanes;
+    frustum_lanes_create(f, &lanes);
+    __m128 x0 = _mm_loadu_ps(&lanes.x[0]), x1 = _mm_loadu_ps(&lanes.x[4]);
+    __m128 y0 = _mm_loadu_ps(&lanes.y[0]), y1 = _mm_loadu_ps(&lanes.y[4]);
+    __m128 z0 = _mm_loadu_ps(&lanes.z[0]), z1 = _mm_loadu_ps(&lanes.z[4]);
+    __m128 d0 = _mm_loadu_ps(&lanes.d[0]), d1 = _mm_loadu_ps(&lanes.d[4]);
+    __m128 zero = _mm_setzero_ps();
+    for(u32 i = 0; i < count; ++i){
+        __m128 cx = _mm_set1_ps(centers[i].x);
+        __m128 cy = _mm_set1_ps(centers[i].y);
+        __m128 cz = _mm_set1_ps(centers[i].z);
+        __m128 r = _mm_set1_ps(radii[i]);
+        __m128 s0 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x0, cx), _mm_mul_ps(y0, cy)), _mm_add_ps(_mm_mul_ps(z0, cz), d0));
+        __m128 s1 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x1, cx), _mm_mul_ps(y1, cy)), _mm_add_ps(_mm_mul_ps(z1, cz), d1));
+        __m128 outside = _mm_or_ps(_mm_cmplt_ps(_mm_add_ps(s0, r), zero), _mm_cmplt_ps(_mm_add_ps(s1, r), zero));
+        // Always write the index, and only keep it if the sphere is visible.
+        out_visible_indices[visible_count] = i;
+        visible_count += _mm_movemask_ps(outside) == 0;
+    }
+#elif defined(TMATH_NEON)
+    frustum_lanes lanes;
+    frustum_lanes_create(f, &lanes);
+    float32x4_t x0 = vld1q_f32(&lanes.x[0]), x1 = vld1q_f32(&lanes.x[4]);
+    float32x4_t y0 = vld1q_f32(&lanes.y[0]), y1 = vld1q_f32(&lanes.y[4]);
+    float32x4_t z0 = vld1q_f32(&lanes.z[0]), z1 = vld1q_f32(&lanes.z[4]);
+    float32x4_t d0 = vld1q_f32(&lanes.d[0]), d1 = vld1q_f32(&lanes.d[4]);
+    float32x4_t zero = vdupq_n_f32(0.0f);
+    for(u32 i = 0; i < count; ++i){
+        float32x4_t r = vdupq_n_f32(radii[i]);
+        float32x4_t s0 = vmlaq_n_f32(vmlaq_n_f32(vmlaq_n_f32(d0, x0, centers[i].x), y0, centers[i].y), z0, centers[i].z);
+        float32x4_t s1 = vmlaq_n_f32(vmlaq_n_f32(vmlaq_n_f32(d1, x1, centers[i].x), y1, centers[i].y), z1, centers[i].z);
+        uint32x4_t outside = vorrq_u32(vcltq_f32(vaddq_f32(s0, r), zero), vcltq_f32(vaddq_f32(s1, r), zero));
+        uint32x2_t folded = vorr_u32(vget_low_u32(outside), vget_high_u32(outside));
+        out_visible_indices[visible_count] = i;
+        visible_count += (vget_lane_u32(folded, 0) | vget_lane_u32(folded, 1)) == 0;
+    }
+#else
+    for(u32 i = 0; i < count; ++i){
+        if(frustum_intersects_sphere(f, centers[i], radii[i])){
+            out_visible_indices[visible_count++] = i;
+        }
+    }
+#endif
+    return visible_count;
+}
+
+u32 frustum_cull_aabbs(const frustum* f, const vec3* centers, const vec3* half_extents, u32 count, u32* out_visible_indices){
+    u32 visible_count = 0;
+#if defined(TMATH_SSE)
+    frustum_lanes lanes;
+    frustum_lanes_create(f, &lanes);
+    // The absolute values of the normals, for how far each box reaches towards each plane.
+    __m128 sign_mask = _mm_set1_ps(-0.0f);
+    __m128 x0 = _mm_loadu_ps(&lanes.x[0]), x1 = _mm_loadu_ps(&lanes.x[4]);
+    __m128 y0 = _mm_loadu_ps(&lanes.y[0]), y1 = _mm_loadu_ps(&lanes.y[4]);
+    __m128 z0 = _mm_loadu_ps(&lanes.z[0]), z1 = _mm_loadu_ps(&lanes.z[4]);
+    __m128 d0 = _mm_loadu_ps(&lanes.d[0]), d1 = _mm_loadu_ps(&lanes.d[4]);
+    __m128 ax0 = _mm_andnot_ps(sign_mask, x0), ax1 = _mm_andnot_ps(sign_mask, x1);
+    __m128 ay0 = _mm_andnot_ps(sign_mask, y0), ay1 = _mm_andnot_ps(sign_mask, y1);
+    __m128 az0 = _mm_andnot_ps(sign_mask, z0), az1 = _mm_andnot_ps(sign_mask, z1);
+    __m128 zero = _mm_setzero_ps();
+    for(u32 i = 0; i < count; ++i){
+        __m128 cx = _mm_set1_ps(centers[i].x);
+        __m128 cy = _mm_set1_ps(centers[i].y);
+        __m128 cz = _mm_set1_ps(centers[i].z);
+        __m128 ex = _mm_set1_ps(half_extents[i].x);
+        __m128 ey = _mm_set1_ps(half_extents[i].y);
+        __m128 ez = _mm_set1_ps(half_extents[i].z);
+        __m128 s0 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x0, cx), _mm_mul_ps(y0, cy)), _mm_add_ps(_mm_mul_ps(z0, cz), d0));
+        __m128 s1 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x1, cx), _mm_mul_ps(y1, cy)), _mm_add_ps(_mm_mul_ps(z1, cz), d1));
+        __m128 r0 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax0, ex), _mm_mul_ps(ay0, ey)), _mm_mul_ps(az0, ez));
+        __m128 r1 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax1, ex), _mm_mul_ps(ay1, ey)), _mm_mul_ps(az1, ez));
+        __m128 outside = _mm_or_ps(_mm_cmplt_ps(_mm_add_ps(s0, r0), zero), _mm_cmplt_ps(_mm_add_ps(s1, r1), zero));
+        // Always write the index, and only keep it if the box is visible.
+        out_visible_indices[visible_count] = i;
+        visible_count += _mm_movemask_ps(outside) == 0;
+    }
+#elif defined(TMATH_NEON)
+    frustum_lanes lanes;
+    frustum_lanes_create(f, &lanes);
+    float32x4_t x0 = vld1q_f32(&lanes.x[0]), x1 = vld1q_f32(&lanes.x[4]);
+    float32x4_t y0 = vld1q_f32(&lanes.y[0]), y1 = vld1q_f32(&lanes.y[4]);
+    float32x4_t z0 = vld1q_f32(&lanes.z[0]), z1 = vld1q_f32(&lanes.z[4]);
+    float32x4_t d0 = vld1q_f32(&lanes.d[0]), d1 = vld1q_f32(&lanes.d[4]);
+    float32x4_t ax0 = vabsq_f32(x0), ax1 = vabsq_f32(x1);
+    float32x4_t ay0 = vabsq_f32(y0), ay1 = vabsq_f32(y1);
+    float32x4_t az0 = vabsq_f32(z0), az1 = vabsq_f32(z1);
+    float32x4_t zero = vdupq_n_f32(0.0f);
+    for(u32 i = 0; i < count; ++i){
+        vec3 c = centers[i];
+        vec3 e = half_extents[i];
+        float32x4_t s0 = vmlaq_n_f32(vmlaq_n_f32(vmlaq_n_f32(d0, x0, c.x), y0, c.y), z0, c.z);
+        float32x4_t s1 = vmlaq_n_f32(vmlaq_n_f32(vmlaq_n_f32(d1, x1, c.x), y1, c.y), z1, c.z);
+        float32x4_t r0 = vmlaq_n_f32(vmlaq_n_f32(vmulq_n_f32(ax0, e.x), ay0, e.y), az0, e.z);
+        float32x4_t r1 = vmlaq_n_f32(vmlaq_n_f32(vmulq_n_f32(ax1, e.x), ay1, e.y), az1, e.z);
+        uint32x4_t outside = vorrq_u32(vcltq_f32(vaddq_f32(s0, r0), zero), vcltq_f32(vaddq_f32(s1, r1), zero));
+        uint32x2_t folded = vorr_u32(vget_low_u32(outside), vget_high_u32(outside));
+        out_visible_indices[visible_count] = i;
+        visible_count += (vget_lane_u32(folded, 0) | vget_lane_u32(folded, 1)) == 0;
+    }
+#else
+    for(u32 i = 0; i < count; ++i){
+        if(frustum_intersects_aabb(f, centers[i], half_extents[i])){
+            out_visible_indices[visible_count++] = i;
+        }
+    }
+#endif
+    return visible_count;
+}
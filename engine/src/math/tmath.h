@@ -5,6 +5,19 @@
 
 #include "core/tmemory.h"
 
+// The hot matrix and vector routines have SSE and NEON kernels,
+// selected at compile time from what the target supports. They produce the same results as
+// the scalar code, within rounding. Define TMATH_NO_SIMD to force the scalar paths.
+#if !defined(TMATH_NO_SIMD)
+    #if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+        #define TMATH_SSE 1
+        #include <emmintrin.h>
+    #elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+        #define TMATH_NEON 1
+        #include <arm_neon.h>
+    #endif
+#endif
+
 #define T_PI 3.14159265358979323846f
 #define T_PI_2 (2.0f * T_PI)
 #define T_HALF_PI (0.5f * T_PI)
@@ -55,6 +68,11 @@ TAPI i32 trandom_in_range(i32 min, i32 max);
 TAPI f32 ftrandom();
 TAPI f32 ftrandom_in_range(f32 min, f32 max);
 
+/**
+ * @brief Returns the name of the SIMD kernels the engine was built with, such as "SSE2" or "scalar".
+ */
+TAPI const char* tmath_simd_name();
+
 //--------------------------------------------------
 // Vector 2
 //--------------------------------------------------
@@ -542,13 +560,44 @@ TINLINE f32 vec3_distance(vec3 vector_0, vec3 vector_1){
  */
 TINLINE vec3 vec3_transform(vec3 v, mat4 m){
     vec3 out;
+#if defined(TMATH_SSE)
+    __m128 r = _mm_mul_ps(_mm_set1_ps(v.x), _mm_loadu_ps(&m.data[0]));
+    r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(v.y), _mm_loadu_ps(&m.data[4])));
+    r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(v.z), _mm_loadu_ps(&m.data[8])));
+    r = _mm_add_ps(r, _mm_loadu_ps(&m.data[12]));
+    f32 result[4];
+    _mm_storeu_ps(result, r);
+    out.x = result[0];
+    out.y = result[1];
+    out.z = result[2];
+#elif defined(TMATH_NEON)
+    float32x4_t r = vmulq_f32(vdupq_n_f32(v.x), vld1q_f32(&m.data[0]));
+    r = vaddq_f32(r, vmulq_f32(vdupq_n_f32(v.y), vld1q_f32(&m.data[4])));
+    r = vaddq_f32(r, vmulq_f32(vdupq_n_f32(v.z), vld1q_f32(&m.data[8])));
+    r = vaddq_f32(r, vld1q_f32(&m.data[12]));
+    out.x = vgetq_lane_f32(r, 0);
+    out.y = vgetq_lane_f32(r, 1);
+    out.z = vgetq_lane_f32(r, 2);
+#else
     out.x = v.x * m.data[0 + 0] + v.y * m.data[4 + 0] + v.z * m.data[8 + 0] + 1.0f * m.data[12 + 0];
     out.y = v.x * m.data[0 + 1] + v.y * m.data[4 + 1] + v.z * m.data[8 + 1] + 1.0f * m.data[12 + 1];
     out.z = v.x * m.data[0 + 2] + v.y * m.data[4 + 2] + v.z * m.data[8 + 2] + 1.0f * m.data[12 + 2];
+#endif
 
     return out;
 }
 
+/**
+ * @brief Transforms count points by m, as vec3_transform does, writing the results to
+ * out_points. out_points may be the same array as points.
+ *
+ * @param points The points to transform.
+ * @param count The number of points.
+ * @param m The matrix to transform by.
+ * @param out_points The array to hold the transformed points. Must hold count points.
+ */
+TAPI void vec3_transform_batch(const vec3* points, u32 count, mat4 m, vec3* out_points);
+
 //--------------------------------------------------
 // Vector 4
 //--------------------------------------------------
@@ -564,14 +613,10 @@ TINLINE vec3 vec3_transform(vec3 v, mat4 m){
  */
 TINLINE vec4 vec4_create(f32 x, f32 y, f32 z, f32 w){
     vec4 out_vector;
-#if defined(TUSE_SIMD)
-    out_vector.data = _mm_setr_ps(x, y, z, w);
-#else
     out_vector.x = x;
     out_vector.y = y;
     out_vector.z = z;
     out_vector.w = w;
-#endif
     return out_vector;
 }
 
@@ -597,13 +642,7 @@ TINLINE vec3 vec4_to_vec3(vec4 vector){
  * @return A new vec4.
  */
 TINLINE vec4 vec4_from_vec3(vec3 vector, f32 w){
-#if defined(TUSE_SIMD)
-    vec4 out_vector;
-    out_vector.data = _mm_set_ps(x, y, z, w);
-    return out_vector;
-#else
     return (vec4){vector.x, vector.y, vector.z, w};
-#endif
 }
 
 /**
@@ -629,9 +668,15 @@ TINLINE vec4 vec4_one(){
  */
 TINLINE vec4 vec4_add(vec4 vector_0, vec4 vector_1){
     vec4 result;
+#if defined(TMATH_SSE)
+    _mm_storeu_ps(result.elements, _mm_add_ps(_mm_loadu_ps(vector_0.elements), _mm_loadu_ps(vector_1.elements)));
+#elif defined(TMATH_NEON)
+    vst1q_f32(result.elements, vaddq_f32(vld1q_f32(vector_0.elements), vld1q_f32(vector_1.elements)));
+#else
     for(u64 i = 0; i < 4; ++i){
         result.elements[i] = vector_0.elements[i] + vector_1.elements[i];
     }
+#endif
 
     return result;
 }
@@ -645,9 +690,15 @@ TINLINE vec4 vec4_add(vec4 vector_0, vec4 vector_1){
  */
 TINLINE vec4 vec4_sub(vec4 vector_0, vec4 vector_1){
     vec4 result;
+#if defined(TMATH_SSE)
+    _mm_storeu_ps(result.elements, _mm_sub_ps(_mm_loadu_ps(vector_0.elements), _mm_loadu_ps(vector_1.elements)));
+#elif defined(TMATH_NEON)
+    vst1q_f32(result.elements, vsubq_f32(vld1q_f32(vector_0.elements), vld1q_f32(vector_1.elements)));
+#else
     for(u64 i = 0; i < 4; ++i){
         result.elements[i] = vector_0.elements[i] - vector_1.elements[i];
     }
+#endif
 
     return result;
 }
@@ -661,9 +712,15 @@ TINLINE vec4 vec4_sub(vec4 vector_0, vec4 vector_1){
  */
 TINLINE vec4 vec4_mul(vec4 vector_0, vec4 vector_1){
     vec4 result;
+#if defined(TMATH_SSE)
+    _mm_storeu_ps(result.elements, _mm_mul_ps(_mm_loadu_ps(vector_0.elements), _mm_loadu_ps(vector_1.elements)));
+#elif defined(TMATH_NEON)
+    vst1q_f32(result.elements, vmulq_f32(vld1q_f32(vector_0.elements), vld1q_f32(vector_1.elements)));
+#else
     for(u64 i = 0; i < 4; ++i){
         result.elements[i] = vector_0.elements[i] * vector_1.elements[i];
     }
+#endif
 
     return result;
 }
@@ -677,9 +734,14 @@ TINLINE vec4 vec4_mul(vec4 vector_0, vec4 vector_1){
  */
 TINLINE vec4 vec4_div(vec4 vector_0, vec4 vector_1){
     vec4 result;
+#if defined(TMATH_SSE)
+    _mm_storeu_ps(result.elements, _mm_div_ps(_mm_loadu_ps(vector_0.elements), _mm_loadu_ps(vector_1.elements)));
+#else
+    // NOTE: 32-bit NEON has no vector divide, so this stays scalar there.
     for(u64 i = 0; i < 4; ++i){
         result.elements[i] = vector_0.elements[i] / vector_1.elements[i];
     }
+#endif
 
     return result;
 }
@@ -808,12 +870,37 @@ TINLINE mat4 mat4_identity(){
  * @return The result of the matrix multiplication.
  */
 TINLINE mat4 mat4_mul(mat4 matrix_0, mat4 matrix_1){
-    mat4 out_matrix = mat4_identity();
+    mat4 out_matrix;
 
     const f32* m1_ptr = matrix_0.data;
     const f32* m2_ptr = matrix_1.data;
     f32* dst_ptr = out_matrix.data;
 
+#if defined(TMATH_SSE)
+    __m128 b0 = _mm_loadu_ps(&m2_ptr[0]);
+    __m128 b1 = _mm_loadu_ps(&m2_ptr[4]);
+    __m128 b2 = _mm_loadu_ps(&m2_ptr[8]);
+    __m128 b3 = _mm_loadu_ps(&m2_ptr[12]);
+    for(i32 i = 0; i < 16; i += 4){
+        __m128 r = _mm_mul_ps(_mm_set1_ps(m1_ptr[i + 0]), b0);
+        r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(m1_ptr[i + 1]), b1));
+        r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(m1_ptr[i + 2]), b2));
+        r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(m1_ptr[i + 3]), b3));
+        _mm_storeu_ps(&dst_ptr[i], r);
+    }
+#elif defined(TMATH_NEON)
+    float32x4_t b0 = vld1q_f32(&m2_ptr[0]);
+    float32x4_t b1 = vld1q_f32(&m2_ptr[4]);
+    float32x4_t b2 = vld1q_f32(&m2_ptr[8]);
+    float32x4_t b3 = vld1q_f32(&m2_ptr[12]);
+    for(i32 i = 0; i < 16; i += 4){
+        float32x4_t r = vmulq_f32(vdupq_n_f32(m1_ptr[i + 0]), b0);
+        r = vaddq_f32(r, vmulq_f32(vdupq_n_f32(m1_ptr[i + 1]), b1));
+        r = vaddq_f32(r, vmulq_f32(vdupq_n_f32(m1_ptr[i + 2]), b2));
+        r = vaddq_f32(r, vmulq_f32(vdupq_n_f32(m1_ptr[i + 3]), b3));
+        vst1q_f32(&dst_ptr[i], r);
+    }
+#else
     for(i32 i = 0; i < 4; ++i){
         for(i32 j = 0; j < 4; ++j){
             *dst_ptr = 
@@ -825,10 +912,83 @@ TINLINE mat4 mat4_mul(mat4 matrix_0, mat4 matrix_1){
         }
         m1_ptr += 4;
     }
+#endif
+
+    return out_matrix;
+}
+
+/**
+ * @brief Returns the result of multiplying affine and matrix, the same as mat4_mul, for an
+ * affine whose last column is (0, 0, 0, 1) - as every matrix built from a position, rotation
+ * and scale is. That column is never read, which saves a quarter of the work.
+ *
+ * @param affine The first matrix to be multiplied. Its last column is taken to be (0, 0, 0, 1).
+ * @param matrix The second matrix to be multiplied.
+ * @return The result of the matrix multiplication.
+ */
+TINLINE mat4 mat4_mul_affine(mat4 affine, mat4 matrix){
+    mat4 out_matrix;
+
+    const f32* m1_ptr = affine.data;
+    const f32* m2_ptr = matrix.data;
+    f32* dst_ptr = out_matrix.data;
+
+#if defined(TMATH_SSE)
+    __m128 b0 = _mm_loadu_ps(&m2_ptr[0]);
+    __m128 b1 = _mm_loadu_ps(&m2_ptr[4]);
+    __m128 b2 = _mm_loadu_ps(&m2_ptr[8]);
+    __m128 b3 = _mm_loadu_ps(&m2_ptr[12]);
+    for(i32 i = 0; i < 16; i += 4){
+        __m128 r = _mm_mul_ps(_mm_set1_ps(m1_ptr[i + 0]), b0);
+        r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(m1_ptr[i + 1]), b1));
+        r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(m1_ptr[i + 2]), b2));
+        if(i == 12){
+            r = _mm_add_ps(r, b3);
+        }
+        _mm_storeu_ps(&dst_ptr[i], r);
+    }
+#elif defined(TMATH_NEON)
+    float32x4_t b0 = vld1q_f32(&m2_ptr[0]);
+    float32x4_t b1 = vld1q_f32(&m2_ptr[4]);
+    float32x4_t b2 = vld1q_f32(&m2_ptr[8]);
+    float32x4_t b3 = vld1q_f32(&m2_ptr[12]);
+    for(i32 i = 0; i < 16; i += 4){
+        float32x4_t r = vmulq_f32(vdupq_n_f32(m1_ptr[i + 0]), b0);
+        r = vaddq_f32(r, vmulq_f32(vdupq_n_f32(m1_ptr[i + 1]), b1));
+        r = vaddq_f32(r, vmulq_f32(vdupq_n_f32(m1_ptr[i + 2]), b2));
+        if(i == 12){
+            r = vaddq_f32(r, b3);
+        }
+        vst1q_f32(&dst_ptr[i], r);
+    }
+#else
+    for(i32 i = 0; i < 4; ++i){
+        for(i32 j = 0; j < 4; ++j){
+            *dst_ptr = 
+                m1_ptr[0] * m2_ptr[0 + j] +
+                m1_ptr[1] * m2_ptr[4 + j] +
+                m1_ptr[2] * m2_ptr[8 + j] +
+                (i == 3 ? m2_ptr[12 + j] : 0.0f);
+            dst_ptr++;
+        }
+        m1_ptr += 4;
+    }
+#endif
 
     return out_matrix;
 }
 
+/**
+ * @brief Multiplies each of count matrices by matrix, as mat4_mul(matrices[i], matrix) does,
+ * writing the results to out_matrices. out_matrices may be the same array as matrices.
+ *
+ * @param matrices The matrices to be multiplied.
+ * @param count The number of matrices.
+ * @param matrix The matrix each is multiplied by.
+ * @param out_matrices The array to hold the results. Must hold count matrices.
+ */
+TAPI void mat4_mul_batch(const mat4* matrices, u32 count, mat4 matrix, mat4* out_matrices);
+
 /**
  * @brief Creates and returns an orthographic projection matrix. Typically used to render flat or 2D scenes.
  * 
@@ -925,7 +1085,25 @@ TINLINE mat4 mat4_look_at(vec3 position, vec3 target, vec3 up){
  * @return A transposed copy of the provided matrix.
  */
 TINLINE mat4 mat4_transposed(mat4 matrix){
-    mat4 out_matrix = mat4_identity();
+    mat4 out_matrix;
+#if defined(TMATH_SSE)
+    __m128 r0 = _mm_loadu_ps(&matrix.data[0]);
+    __m128 r1 = _mm_loadu_ps(&matrix.data[4]);
+    __m128 r2 = _mm_loadu_ps(&matrix.data[8]);
+    __m128 r3 = _mm_loadu_ps(&matrix.data[12]);
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+    _mm_storeu_ps(&out_matrix.data[0], r0);
+    _mm_storeu_ps(&out_matrix.data[4], r1);
+    _mm_storeu_ps(&out_matrix.data[8], r2);
+    _mm_storeu_ps(&out_matrix.data[12], r3);
+#elif defined(TMATH_NEON)
+    // A de-interleaving load of every fourth element is a transpose.
+    float32x4x4_t columns = vld4q_f32(matrix.data);
+    vst1q_f32(&out_matrix.data[0], columns.val[0]);
+    vst1q_f32(&out_matrix.data[4], columns.val[1]);
+    vst1q_f32(&out_matrix.data[8], columns.val[2]);
+    vst1q_f32(&out_matrix.data[12], columns.val[3]);
+#else
     out_matrix.data[0] = matrix.data[0];
     out_matrix.data[1] = matrix.data[4];
     out_matrix.data[2] = matrix.data[8];
@@ -942,6 +1120,7 @@ TINLINE mat4 mat4_transposed(mat4 matrix){
     out_matrix.data[13] = matrix.data[7];
     out_matrix.data[14] = matrix.data[11];
     out_matrix.data[15] = matrix.data[15];
+#endif
     return out_matrix;
 }
 
@@ -951,7 +1130,84 @@ TINLINE mat4 mat4_transposed(mat4 matrix){
  * @param matrix The matrix to be inverted.
  * @return A inverted copy of the provided matrix.
  */
+#if defined(TMATH_SSE)
+// Helpers for the SSE inverse below. A mask picks lanes x, y, z and w, in that order.
+#define TMATH_SHUFFLE_MASK(x, y, z, w) ((x) | ((y) << 2) | ((z) << 4) | ((w) << 6))
+#define TMATH_SWIZZLE(v, x, y, z, w) _mm_shuffle_ps(v, v, TMATH_SHUFFLE_MASK(x, y, z, w))
+#define TMATH_SHUFFLE(a, b, x, y, z, w) _mm_shuffle_ps(a, b, TMATH_SHUFFLE_MASK(x, y, z, w))
+
+// The 2x2 matrix product a * b, each stored as four lanes row by row.
+TINLINE __m128 mat2_mul_sse(__m128 a, __m128 b){
+    return _mm_add_ps(_mm_mul_ps(a, TMATH_SWIZZLE(b, 0, 3, 0, 3)),
+                      _mm_mul_ps(TMATH_SWIZZLE(a, 1, 0, 3, 2), TMATH_SWIZZLE(b, 2, 1, 2, 1)));
+}
+
+// The 2x2 matrix product adj(a) * b.
+TINLINE __m128 mat2_adj_mul_sse(__m128 a, __m128 b){
+    return _mm_sub_ps(_mm_mul_ps(TMATH_SWIZZLE(a, 3, 3, 0, 0), b),
+                      _mm_mul_ps(TMATH_SWIZZLE(a, 1, 1, 2, 2), TMATH_SWIZZLE(b, 2, 3, 0, 1)));
+}
+
+// The 2x2 matrix product a * adj(b).
+TINLINE __m128 mat2_mul_adj_sse(__m128 a, __m128 b){
+    return _mm_sub_ps(_mm_mul_ps(a, TMATH_SWIZZLE(b, 3, 0, 3, 0)),
+                      _mm_mul_ps(TMATH_SWIZZLE(a, 1, 0, 3, 2), TMATH_SWIZZLE(b, 2, 1, 2, 1)));
+}
+#endif
+
 TINLINE mat4 mat4_inverse(mat4 matrix){
+#if defined(TMATH_SSE)
+    // Blockwise inversion, treating the matrix as four 2x2 blocks:
+    // | A B |
+    // | C D |
+    __m128 r0 = _mm_loadu_ps(&matrix.data[0]);
+    __m128 r1 = _mm_loadu_ps(&matrix.data[4]);
+    __m128 r2 = _mm_loadu_ps(&matrix.data[8]);
+    __m128 r3 = _mm_loadu_ps(&matrix.data[12]);
+    __m128 a = _mm_movelh_ps(r0, r1);
+    __m128 b = _mm_movehl_ps(r1, r0);
+    __m128 c = _mm_movelh_ps(r2, r3);
+    __m128 d = _mm_movehl_ps(r3, r2);
+
+    // The determinants of the blocks, as (|A| |B| |C| |D|).
+    __m128 det_sub = _mm_sub_ps(
+        _mm_mul_ps(TMATH_SHUFFLE(r0, r2, 0, 2, 0, 2), TMATH_SHUFFLE(r1, r3, 1, 3, 1, 3)),
+        _mm_mul_ps(TMATH_SHUFFLE(r0, r2, 1, 3, 1, 3), TMATH_SHUFFLE(r1, r3, 0, 2, 0, 2)));
+    __m128 det_a = TMATH_SWIZZLE(det_sub, 0, 0, 0, 0);
+    __m128 det_b = TMATH_SWIZZLE(det_sub, 1, 1, 1, 1);
+    __m128 det_c = TMATH_SWIZZLE(det_sub, 2, 2, 2, 2);
+    __m128 det_d = TMATH_SWIZZLE(det_sub, 3, 3, 3, 3);
+
+    // The inverse is 1/|M| times the blocks X, Y, Z and W, found through their adjugates.
+    __m128 d_c = mat2_adj_mul_sse(d, c);
+    __m128 a_b = mat2_adj_mul_sse(a, b);
+    __m128 x = _mm_sub_ps(_mm_mul_ps(det_d, a), mat2_mul_sse(b, d_c));
+    __m128 w = _mm_sub_ps(_mm_mul_ps(det_a, d), mat2_mul_sse(c, a_b));
+    __m128 y = _mm_sub_ps(_mm_mul_ps(det_b, c), mat2_mul_adj_sse(d, a_b));
+    __m128 z = _mm_sub_ps(_mm_mul_ps(det_c, b), mat2_mul_adj_sse(a, d_c));
+
+    // |M| = |A||D| + |B||C| - tr(adj(A)B adj(D)C)
+    __m128 det_m = _mm_add_ps(_mm_mul_ps(det_a, det_d), _mm_mul_ps(det_b, det_c));
+    __m128 tr = _mm_mul_ps(a_b, TMATH_SWIZZLE(d_c, 0, 2, 1, 3));
+    tr = _mm_add_ps(tr, TMATH_SWIZZLE(tr, 1, 0, 3, 2));
+    tr = _mm_add_ps(tr, TMATH_SWIZZLE(tr, 2, 3, 0, 1));
+    det_m = _mm_sub_ps(det_m, tr);
+
+    // Scale, flipping signs for the adjugate.
+    __m128 r_det_m = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), det_m);
+    x = _mm_mul_ps(x, r_det_m);
+    y = _mm_mul_ps(y, r_det_m);
+    z = _mm_mul_ps(z, r_det_m);
+    w = _mm_mul_ps(w, r_det_m);
+
+    // Undo the adjugate and put the blocks back into rows.
+    mat4 out_matrix;
+    _mm_storeu_ps(&out_matrix.data[0], TMATH_SHUFFLE(x, y, 3, 1, 3, 1));
+    _mm_storeu_ps(&out_matrix.data[4], TMATH_SHUFFLE(x, y, 2, 0, 2, 0));
+    _mm_storeu_ps(&out_matrix.data[8], TMATH_SHUFFLE(z, w, 3, 1, 3, 1));
+    _mm_storeu_ps(&out_matrix.data[12], TMATH_SHUFFLE(z, w, 2, 0, 2, 0));
+    return out_matrix;
+#else
     const f32* m = matrix.data;
 
     f32 t0 = m[10] * m[15];
@@ -1007,6 +1263,7 @@ TINLINE mat4 mat4_inverse(mat4 matrix){
     o[15] = d * ((t22 * m[10] + t16 * m[2] + t21 * m[6]) - (t20 * m[6] + t23 * m[10] + t17 * m[2]));
 
     return out_matrix;
+#endif
 }
 
 TINLINE mat4 mat4_translation(vec3 position){
@@ -1374,4 +1631,88 @@ TINLINE f32 deg_to_rad(f32 degrees){
  */
 TINLINE f32 rad_to_deg(f32 radians){
     return radians * T_RAD2DEG_MULTIPLIER;
-}
\ No newline at end of file
+}
+
+//--------------------------------------------------
+// Frustum
+//--------------------------------------------------
+
+/**
+ * @brief Extracts the frustum of a view-projection matrix, such as mat4_mul(view, projection).
+ * The planes are normalized and face inwards, and are in whatever space the matrix maps from;
+ * world space for a view-projection.
+ *
+ * @param view_projection The view-projection matrix.
+ * @return The frustum.
+ */
+TAPI frustum frustum_from_view_projection(mat4 view_projection);
+
+/**
+ * @brief Indicates if a sphere is at least partly inside a frustum. Conservative: a sphere
+ * just outside a corner of the frustum may be reported as inside.
+ *
+ * @param f A pointer to the frustum.
+ * @param center The center of the sphere.
+ * @param radius The radius of the sphere.
+ * @return True if the sphere may be inside; false if it is certainly outside.
+ */
+TAPI b8 frustum_intersects_sphere(const frustum* f, vec3 center, f32 radius);
+
+/**
+ * @brief Indicates if an axis-aligned box is at least partly inside a frustum. Conservative,
+ * in the same way as frustum_intersects_sphere.
+ *
+ * @param f A pointer to the frustum.
+ * @param center The center of the box.
+ * @param half_extents Half the size of the box along each axis.
+ * @return True if the box may be inside; false if it is certainly outside.
+ */
+TAPI b8 frustum_intersects_aabb(const frustum* f, vec3 center, vec3 half_extents);
+
+/**
+ * @brief Tests count spheres against a frustum, as frustum_intersects_sphere does, and
+ * writes the indices of those that may be inside to out_visible_indices, in order.
+ *
+ * @param f A pointer to the frustum.
+ * @param centers The centers of the spheres.
+ * @param radii The radii of the spheres.
+ * @param count The number of spheres.
+ * @param out_visible_indices The array to hold the indices of the visible spheres. Must hold count indices.
+ * @return The number of visible spheres.
+ */
+TAPI u32 frustum_cull_spheres(const frustum* f, const vec3* centers, const f32* radii, u32 count, u32* out_visible_indices);
+
+/**
+ * @brief Tests count axis-aligned boxes against a frustum, as frustum_intersects_aabb does,
+ * and writes the indices of those that may be inside to out_visible_indices, in order.
+ *
+ * @param f A pointer to the frustum.
+ * @param centers The centers of the boxes.
+ * @param half_extents Half the sizes of the boxes along each axis.
+ * @param count The number of boxes.
+ * @param out_visible_indices The array to hold the indices of the visible boxes. Must hold count indices.
+ * @return The number of visible boxes.
+ */
+TAPI u32 frustum_cull_aabbs(const frustum* f, const vec3* centers, const vec3* half_extents, u32 count, u32* out_visible_indices);
+
+/**
+ * @brief Computes the world-space axis-aligned box enclosing a local-space box after
+ * transforming it by a matrix.
+ *
+ * @param extents The box in local space.
+ * @param m The matrix to transform by.
+ * @param out_center A pointer to hold the center of the enclosing box.
+ * @param out_half_extents A pointer to hold half the size of the enclosing box along each axis.
+ */
+TINLINE void extents_3d_transform(extents_3d extents, mat4 m, vec3* out_center, vec3* out_half_extents){
+    vec3 center = vec3_mul_scalar(vec3_add(extents.min, extents.max), 0.5f);
+    vec3 half = vec3_mul_scalar(vec3_sub(extents.max, extents.min), 0.5f);
+    *out_center = vec3_transform(center, m);
+    // Each world axis picks up the local half-extents through the absolute values of its column.
+    for(u32 i = 0; i < 3; ++i){
+        out_half_extents->elements[i] =
+            half.x * tabs(m.data[0 + i]) +
+            half.y * tabs(m.data[4 + i]) +
+            half.z * tabs(m.data[8 + i]);
+    }
+}
@@ -4,6 +4,11 @@
 #include "core/logger.h"
 #include "containers/freelist.h"
 
+/** Rounds a size up to the allocator's granularity, which keeps every range boundary aligned. */
+TINLINE u64 round_size(u64 size){
+    return (size + DYNAMIC_ALLOCATOR_ALIGNMENT - 1) & ~(u64)(DYNAMIC_ALLOCATOR_ALIGNMENT - 1);
+}
+
 typedef struct dynamic_allocator_state {
     u64 total_size;
     freelist list;
@@ -25,7 +30,8 @@ b8 dynamic_allocator_create(u64 total_size, u64* memory_requirement, void* memor
     // Grab the memory requirement for the free list first.
     freelist_create(total_size, &freelist_requirement, 0, 0);
 
-    *memory_requirement = freelist_requirement + sizeof(dynamic_allocator_state) + total_size;
+    // Leave room to align the start of the memory block.
+    *memory_requirement = freelist_requirement + sizeof(dynamic_allocator_state) + DYNAMIC_ALLOCATOR_ALIGNMENT + total_size;
 
     // If only obtaining requirement, boot out.
     if(!memory){
@@ -35,12 +41,14 @@ b8 dynamic_allocator_create(u64 total_size, u64* memory_requirement, void* memor
     // Memory layout:
     // state
     // freelist block
+    // (padding to DYNAMIC_ALLOCATOR_ALIGNMENT)
     // memory block
     out_allocator->memory = memory;
     dynamic_allocator_state* state = out_allocator->memory;
     state->total_size = total_size;
     state->freelist_block = (void*)(out_allocator->memory + sizeof(dynamic_allocator_state));
-    state->memory_block = (void*)(state->freelist_block + freelist_requirement);
+    u64 memory_block_address = (u64)(state->freelist_block + freelist_requirement);
+    state->memory_block = (void*)round_size(memory_block_address);
 
     // Actually create the freelist
     freelist_create(total_size, &freelist_requirement, state->freelist_block, &state->list);
@@ -66,6 +74,7 @@ b8 dynamic_allocator_destroy(dynamic_allocator* allocator){
 void* dynamic_allocator_allocate(dynamic_allocator* allocator, u64 size){
     if(allocator && size){
         dynamic_allocator_state* state = allocator->memory;
+        size = round_size(size);
         u64 offset = 0;
         // Attempt to allocate from the freelist.
         if(freelist_allocate_block(&state->list, size, &offset)){
@@ -76,7 +85,7 @@ void* dynamic_allocator_allocate(dynamic_allocator* allocator, u64 size){
             TERROR("dynamic_allocator_allocate no blocks of memory large enough to allocate from.");
             u64 available = freelist_free_space(&state->list);
             TERROR("Requested size: %llu, total space available: %llu", size, available);
-            // TODO: Report fragmentation?
+            TERROR("Largest free block: %llu, free blocks: %llu", freelist_largest_free_block(&state->list), freelist_free_block_count(&state->list));
             return 0;
         }
     }
@@ -85,6 +94,44 @@ void* dynamic_allocator_allocate(dynamic_allocator* allocator, u64 size){
     return 0;
 }
 
+void* dynamic_allocator_allocate_aligned(dynamic_allocator* allocator, u64 size, u16 alignment){
+    if(alignment & (alignment - 1)){
+        TERROR("dynamic_allocator_allocate_aligned requires a power of two alignment, got %hu.", alignment);
+        return 0;
+    }
+    if(alignment <= DYNAMIC_ALLOCATOR_ALIGNMENT){
+        return dynamic_allocator_allocate(allocator, size);
+    }
+    if(!allocator || !size){
+        TERROR("dynamic_allocator_allocate_aligned requires a valid allocator and size.");
+        return 0;
+    }
+
+    // Over-allocate by enough to reach the boundary from any granule, then return
+    // the unused head and tail so the block can be freed by its offset and size alone.
+    dynamic_allocator_state* state = allocator->memory;
+    size = round_size(size);
+    u64 padded_size = size + alignment - DYNAMIC_ALLOCATOR_ALIGNMENT;
+    u64 offset = 0;
+    if(!freelist_allocate_block(&state->list, padded_size, &offset)){
+        TERROR("dynamic_allocator_allocate_aligned no blocks of memory large enough to allocate from.");
+        TERROR("Requested size: %llu (aligned to %hu), total space available: %llu", size, alignment, freelist_free_space(&state->list));
+        TERROR("Largest free block: %llu, free blocks: %llu", freelist_largest_free_block(&state->list), freelist_free_block_count(&state->list));
+        return 0;
+    }
+
+    u64 address = (u64)(state->memory_block + offset);
+    u64 head = ((address + alignment - 1) & ~(u64)(alignment - 1)) - address;
+    u64 tail = padded_size - head - size;
+    if(head){
+        freelist_free_block(&state->list, head, offset);
+    }
+    if(tail){
+        freelist_free_block(&state->list, tail, offset + head + size);
+    }
+    return (void*)(state->memory_block + offset + head);
+}
+
 b8 dynamic_allocator_free(dynamic_allocator* allocator, void* block, u64 size){
     if(!allocator || !block || !size){
         TERROR("dynamic_allocator_free requires both a valid allocator (0x%p) and a block (0x%p) to be freed.", allocator, block);
@@ -99,7 +146,7 @@ b8 dynamic_allocator_free(dynamic_allocator* allocator, void* block, u64 size){
     }
 
     u64 offset = (block - state->memory_block);
-    if(!freelist_free_block(&state->list, size, offset)){
+    if(!freelist_free_block(&state->list, round_size(size), offset)){
         TERROR("dynamic_allocator_free failed.");
         return FALSE;
     }
@@ -12,6 +12,12 @@
 
 #include "defines.h"
 
+/**
+ * @brief Every block is aligned to, and sized in multiples of, this many bytes.
+ * Larger alignments are available through dynamic_allocator_allocate_aligned.
+ */
+#define DYNAMIC_ALLOCATOR_ALIGNMENT 16
+
 /** @brief The dynamic allocator structure. */
 typedef struct dynamic_allocator{
     /** @brief The allocated memory block for this allocator to use. */
@@ -48,6 +54,18 @@ TAPI b8 dynamic_allocator_destroy(dynamic_allocator* allocator);
  */
 TAPI void* dynamic_allocator_allocate(dynamic_allocator* allocator, u64 size);
 
+/**
+ * @brief Allocates the given amount of memory, aligned to the given boundary. The padding
+ * needed to reach the boundary is handed back to the allocator straight away, so the block
+ * is freed with dynamic_allocator_free and the same size, like any other.
+ *
+ * @param allocator A pointer to the allocator to allocate from.
+ * @param size The amount in bytes to be allocated.
+ * @param alignment The alignment in bytes. Must be a power of two.
+ * @return The allocated block of memory unless this operation fails, then 0.
+ */
+TAPI void* dynamic_allocator_allocate_aligned(dynamic_allocator* allocator, u64 size, u16 alignment);
+
 /**
  * @brief Frees the given block of memory.
  * 
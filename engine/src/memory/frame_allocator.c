@@ -0,0 +1,67 @@
+#include "frame_allocator.h"
+
+#include "core/tmemory.h"
+#include "core/logger.h"
+
+void frame_allocator_create(u64 size_per_frame, frame_allocator* out_allocator){
+    if(!out_allocator){
+        return;
+    }
+
+    tzero_memory(out_allocator, sizeof(frame_allocator));
+
+    // Back all buffers with one block; each linear allocator just borrows its part.
+    out_allocator->memory = tallocate(size_per_frame * FRAME_ALLOCATOR_BUFFER_COUNT, MEMORY_TAG_LINEAR_ALLOCATOR);
+    for(u32 i = 0; i < FRAME_ALLOCATOR_BUFFER_COUNT; ++i){
+        linear_allocator_create(size_per_frame, out_allocator->memory + (size_per_frame * i), &out_allocator->buffers[i]);
+    }
+}
+
+void frame_allocator_destroy(frame_allocator* allocator){
+    if(!allocator || !allocator->memory){
+        return;
+    }
+
+    u64 size_per_frame = allocator->buffers[0].total_size;
+    for(u32 i = 0; i < FRAME_ALLOCATOR_BUFFER_COUNT; ++i){
+        linear_allocator_destroy(&allocator->buffers[i]);
+    }
+    tfree(allocator->memory, size_per_frame * FRAME_ALLOCATOR_BUFFER_COUNT, MEMORY_TAG_LINEAR_ALLOCATOR);
+    tzero_memory(allocator, sizeof(frame_allocator));
+}
+
+void frame_allocator_begin_frame(frame_allocator* allocator){
+    if(!allocator || !allocator->memory){
+        return;
+    }
+
+    allocator->last_frame_used = allocator->buffers[allocator->current].allocated;
+    if(allocator->last_frame_used > allocator->peak_used){
+        allocator->peak_used = allocator->last_frame_used;
+    }
+
+    allocator->current = (allocator->current + 1) % FRAME_ALLOCATOR_BUFFER_COUNT;
+    linear_allocator_free_all(&allocator->buffers[allocator->current]);
+}
+
+void* frame_allocator_allocate(frame_allocator* allocator, u64 size){
+    if(!allocator || !allocator->memory){
+        TERROR("frame_allocator_allocate - provided allocator not initialized");
+        return 0;
+    }
+
+    linear_allocator* buffer = &allocator->buffers[allocator->current];
+    u64 address = (u64)(buffer->memory + buffer->allocated);
+    u64 padding = (FRAME_ALLOCATOR_ALIGNMENT - (address & (FRAME_ALLOCATOR_ALIGNMENT - 1))) & (FRAME_ALLOCATOR_ALIGNMENT - 1);
+
+    void* block = linear_allocator_allocate(buffer, padding + size);
+    return block ? block + padding : 0;
+}
+
+u64 frame_allocator_used(frame_allocator* allocator){
+    if(!allocator || !allocator->memory){
+        return 0;
+    }
+
+    return allocator->buffers[allocator->current].allocated;
+}
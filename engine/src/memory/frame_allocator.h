@@ -0,0 +1,70 @@
+#pragma once
+
+#include "defines.h"
+#include "memory/linear_allocator.h"
+
+/** @brief The number of frames' worth of transient memory kept alive at once. */
+#define FRAME_ALLOCATOR_BUFFER_COUNT 2
+
+/** @brief The alignment of every block handed out by a frame allocator. */
+#define FRAME_ALLOCATOR_ALIGNMENT 16
+
+/**
+ * @brief A double-buffered linear allocator for transient per-frame data such
+ * as render packets. Everything allocated during a frame stays valid until
+ * the frame after next begins, so data built for one frame may still be read
+ * while the next is being built. Nothing is freed individually.
+ */
+typedef struct frame_allocator {
+    /** @brief One linear allocator per buffered frame. */
+    linear_allocator buffers[FRAME_ALLOCATOR_BUFFER_COUNT];
+    /** @brief The index of the buffer the current frame allocates from. */
+    u8 current;
+    /** @brief The block both buffers live in. */
+    void* memory;
+    /** @brief The number of bytes used by the most recently completed frame. */
+    u64 last_frame_used;
+    /** @brief The most bytes used by any single frame so far. */
+    u64 peak_used;
+} frame_allocator;
+
+/**
+ * @brief Creates a frame allocator with the given capacity per frame.
+ *
+ * @param size_per_frame The number of bytes available to each frame.
+ * @param out_allocator A pointer to hold the created allocator.
+ */
+TAPI void frame_allocator_create(u64 size_per_frame, frame_allocator* out_allocator);
+
+/**
+ * @brief Destroys the provided frame allocator, releasing its memory.
+ *
+ * @param allocator A pointer to the allocator to be destroyed.
+ */
+TAPI void frame_allocator_destroy(frame_allocator* allocator);
+
+/**
+ * @brief Starts a new frame. Records the usage of the frame just completed
+ * and resets the buffer last used two frames ago, invalidating everything
+ * allocated from it.
+ *
+ * @param allocator A pointer to the allocator.
+ */
+TAPI void frame_allocator_begin_frame(frame_allocator* allocator);
+
+/**
+ * @brief Allocates a block for the current frame, aligned to FRAME_ALLOCATOR_ALIGNMENT.
+ *
+ * @param allocator A pointer to the allocator.
+ * @param size The size of the block in bytes.
+ * @return A pointer to the block, or 0 if the frame's capacity is exhausted.
+ */
+TAPI void* frame_allocator_allocate(frame_allocator* allocator, u64 size);
+
+/**
+ * @brief Gets the number of bytes allocated so far in the current frame.
+ *
+ * @param allocator A pointer to the allocator.
+ * @return The number of bytes used, including alignment padding.
+ */
+TAPI u64 frame_allocator_used(frame_allocator* allocator);
@@ -48,7 +48,8 @@ TAPI void* linear_allocator_allocate(linear_allocator* allocator, u64 size){
 
 TAPI void linear_allocator_free_all(linear_allocator* allocator){
     if(allocator && allocator->memory){
+        // Only the allocated part can have been written to.
+        tzero_memory(allocator->memory, allocator->allocated);
         allocator->allocated = 0;
-        tzero_memory(allocator->memory, allocator->total_size);
     }
 }
\ No newline at end of file
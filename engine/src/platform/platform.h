@@ -3,12 +3,37 @@
 #include "defines.h"
 
 
-b8 platform_system_startup(u64* memory_requirement, void* state, const char* application_name, i32 x, i32 y, i32 width, i32 height);
+/**
+ * @brief Starts the platform layer. Call twice; once with state = 0 to get the required memory size,
+ * then a second time passing allocated memory to state.
+ *
+ * @param memory_requirement A pointer to hold the required memory size of internal state.
+ * @param state 0 if just requesting memory requirement, otherwise allocated block of memory.
+ * @param application_name The window title.
+ * @param x The window's starting x position.
+ * @param y The window's starting y position.
+ * @param width The window's starting width.
+ * @param height The window's starting height.
+ * @param headless True to run without connecting to the window system or creating a window.
+ * Messages then come only from the platform_headless_queue_* functions.
+ * @return True on success; otherwise false.
+ */
+b8 platform_system_startup(u64* memory_requirement, void* state, const char* application_name, i32 x, i32 y, i32 width, i32 height, b8 headless);
 
 void platform_system_shutdown(void* plat_state);
 
 b8 platform_pump_messages();
 
+/**
+ * @brief Blocks the calling thread until the window system has messages waiting or the
+ * timeout passes, without using any CPU in the meantime. The messages are not processed;
+ * call platform_pump_messages afterwards. Should only be called from the main thread.
+ *
+ * @param timeout_ms The longest to wait, in milliseconds.
+ * @return True if messages are waiting; false if it timed out.
+ */
+b8 platform_wait_for_messages(u64 timeout_ms);
+
 void* platform_allocate(u64 size, b8 aligned);
 void platform_free(void* block, b8 aligned);
 void* platform_zero_memory(void* block, u64 size);
@@ -18,16 +43,15 @@ void* platform_set_memory(void* dest, i32 value, u64 size);
 void platform_console_write(const char* message, u8 color);
 void platform_console_write_error(const char* message, u8 color);
 
-f64 platform_get_absolute_time();
+TAPI f64 platform_get_absolute_time();
 
 // Sleeps on the thread for the provided ms. This blocks the main thread.
 // Should only be used for giving time back to the OS for unused update power.
-// Therefore it is not exported.
-void platform_sleep(u64 ms);
+TAPI void platform_sleep(u64 ms);
 
 /**
  * @brief Obtains the number of logical processor cores.
  *
  * @return The number of logical processor cores.
  */
-i32 platform_get_processor_count();
\ No newline at end of file
+TAPI i32 platform_get_processor_count();
\ No newline at end of file
@@ -0,0 +1,109 @@
+#include "platform_headless.h"
+
+#include "core/logger.h"
+#include "core/event.h"
+
+typedef enum headless_event_type {
+    HEADLESS_EVENT_RESIZE,
+    HEADLESS_EVENT_KEY,
+    HEADLESS_EVENT_BUTTON,
+    HEADLESS_EVENT_MOUSE_MOVE,
+    HEADLESS_EVENT_QUIT
+} headless_event_type;
+
+typedef struct headless_event {
+    headless_event_type type;
+    union {
+        struct { u16 width; u16 height; } resize;
+        struct { keys key; b8 pressed; } key;
+        struct { buttons button; b8 pressed; } button;
+        struct { i16 x; i16 y; } mouse_move;
+    };
+} headless_event;
+
+// A ring of events waiting for the next pump.
+static headless_event queued_events[PLATFORM_HEADLESS_MAX_QUEUED_EVENTS];
+static u32 queue_head = 0;
+static u32 queue_count = 0;
+
+static headless_event* push_event(headless_event_type type){
+    if(queue_count == PLATFORM_HEADLESS_MAX_QUEUED_EVENTS){
+        TWARN("Headless event queue is full; dropping event. Pump messages more often or increase PLATFORM_HEADLESS_MAX_QUEUED_EVENTS.");
+        return 0;
+    }
+    headless_event* event = &queued_events[(queue_head + queue_count) % PLATFORM_HEADLESS_MAX_QUEUED_EVENTS];
+    queue_count++;
+    event->type = type;
+    return event;
+}
+
+void platform_headless_queue_resize(u16 width, u16 height){
+    headless_event* event = push_event(HEADLESS_EVENT_RESIZE);
+    if(event){
+        event->resize.width = width;
+        event->resize.height = height;
+    }
+}
+
+void platform_headless_queue_key(keys key, b8 pressed){
+    headless_event* event = push_event(HEADLESS_EVENT_KEY);
+    if(event){
+        event->key.key = key;
+        event->key.pressed = pressed;
+    }
+}
+
+void platform_headless_queue_button(buttons button, b8 pressed){
+    headless_event* event = push_event(HEADLESS_EVENT_BUTTON);
+    if(event){
+        event->button.button = button;
+        event->button.pressed = pressed;
+    }
+}
+
+void platform_headless_queue_mouse_move(i16 x, i16 y){
+    headless_event* event = push_event(HEADLESS_EVENT_MOUSE_MOVE);
+    if(event){
+        event->mouse_move.x = x;
+        event->mouse_move.y = y;
+    }
+}
+
+void platform_headless_queue_quit(){
+    push_event(HEADLESS_EVENT_QUIT);
+}
+
+b8 platform_headless_pump(){
+    b8 quit_flagged = FALSE;
+
+    // Only what was queued before this pump is delivered; anything the handlers queue waits for the next.
+    u32 count = queue_count;
+    for(u32 i = 0; i < count; ++i){
+        headless_event event = queued_events[queue_head];
+        queue_head = (queue_head + 1) % PLATFORM_HEADLESS_MAX_QUEUED_EVENTS;
+        queue_count--;
+
+        switch(event.type){
+            case HEADLESS_EVENT_RESIZE:{
+                event_context context;
+                context.data.u16[0] = event.resize.width;
+                context.data.u16[1] = event.resize.height;
+                event_fire(EVENT_CODE_RESIZED, 0, context);
+            }break;
+            case HEADLESS_EVENT_KEY:
+                input_process_key(event.key.key, event.key.pressed);
+                break;
+            case HEADLESS_EVENT_BUTTON:
+                input_process_button(event.button.button, event.button.pressed);
+                break;
+            case HEADLESS_EVENT_MOUSE_MOVE:
+                input_process_mouse_move(event.mouse_move.x, event.mouse_move.y);
+                break;
+            case HEADLESS_EVENT_QUIT:
+                quit_flagged = TRUE;
+                break;
+        }
+    }
+
+    return !quit_flagged;
+}
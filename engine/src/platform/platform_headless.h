@@ -0,0 +1,57 @@
+/**
+ * @file platform_headless.h
+ * @brief Synthetic window events for when the platform runs without a window. Events
+ * queued here are delivered by platform_pump_messages in the order they were queued,
+ * exactly as the window system's own would be. Only the main thread should use these.
+ */
+
+#pragma once
+
+#include "defines.h"
+#include "core/input.h"
+
+/** @brief The number of synthetic events that can be waiting at once. */
+#define PLATFORM_HEADLESS_MAX_QUEUED_EVENTS 256
+
+/**
+ * @brief Queues a window resize.
+ *
+ * @param width The new width of the window in pixels.
+ * @param height The new height of the window in pixels. A width or height of 0 acts as minimizing.
+ */
+TAPI void platform_headless_queue_resize(u16 width, u16 height);
+
+/**
+ * @brief Queues a key press or release.
+ *
+ * @param key The key.
+ * @param pressed True for a press; false for a release.
+ */
+TAPI void platform_headless_queue_key(keys key, b8 pressed);
+
+/**
+ * @brief Queues a mouse button press or release.
+ *
+ * @param button The button.
+ * @param pressed True for a press; false for a release.
+ */
+TAPI void platform_headless_queue_button(buttons button, b8 pressed);
+
+/**
+ * @brief Queues a mouse move.
+ *
+ * @param x The new x position of the mouse.
+ * @param y The new y position of the mouse.
+ */
+TAPI void platform_headless_queue_mouse_move(i16 x, i16 y);
+
+/** @brief Queues a request to close the window. */
+TAPI void platform_headless_queue_quit();
+
+/**
+ * @brief Delivers every queued event. Used by the platform layers in place of the window
+ * system's message pump when running headless.
+ *
+ * @return False if a quit was delivered; otherwise true.
+ */
+TAPI b8 platform_headless_pump();
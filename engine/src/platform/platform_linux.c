@@ -8,9 +8,13 @@
 #include "core/input.h"
 #include "core/tthread.h"
 #include "core/tmutex.h"
+#include "core/tsemaphore.h"
+#include "core/tmemory.h"
 
 #include "containers/darray.h"
 
+#include "platform_headless.h"
+
 #include <xcb/xcb.h>
 #include <X11/keysym.h>
 #include <X11/XKBlib.h> // sudo apt-get install libx11-dev
@@ -25,8 +29,10 @@
 #endif
 
 #include <pthread.h>
+#include <semaphore.h>
 #include <errno.h>  // For error reporting
 #include <sys/sysinfo.h> // Processor info
+#include <poll.h>
 
 
 #include <stdlib.h>
@@ -39,6 +45,8 @@
 #include "renderer/vulkan/renderer_types.inl"
 
 typedef struct platform_state{
+    // No window system connection or window exist while headless.
+    b8 headless;
     Display* display;
     xcb_connection_t* connection;
     xcb_window_t window;
@@ -53,13 +61,18 @@ static platform_state* state_ptr;
 // Key translation
 keys translate_keycode(u32 x_keycode);
 
-TAPI b8 platform_system_startup(u64* memory_requirement, void* state, const char* application_name, i32 x, i32 y, i32 width, i32 height){
+TAPI b8 platform_system_startup(u64* memory_requirement, void* state, const char* application_name, i32 x, i32 y, i32 width, i32 height, b8 headless){
     *memory_requirement = sizeof(platform_state);
     if(state == 0){
         return TRUE;
     }
 
     state_ptr = state;
+    state_ptr->headless = headless;
+    if(headless){
+        TINFO("Platform running headless; no window will be created.");
+        return TRUE;
+    }
 
     // Connect to X
     state_ptr->display = XOpenDisplay(NULL);
@@ -186,7 +199,7 @@ TAPI b8 platform_system_startup(u64* memory_requirement, void* state, const char
 
 
 TAPI void platform_system_shutdown(void* plat_state){
-    if(state_ptr){
+    if(state_ptr && !state_ptr->headless){
         // Turn key repeats back on since this is global for the OS.
         XAutoRepeatOn(state_ptr->display);
 
@@ -200,7 +213,7 @@ void platform_get_required_extension_names(const char*** names_darray){
 
 // Surface creation for vulkan
 b8 platform_create_vulkan_surface(vulkan_context* context){
-    if(!state_ptr){
+    if(!state_ptr || state_ptr->headless){
         return FALSE;
     }
 
@@ -225,6 +238,10 @@ b8 platform_create_vulkan_surface(vulkan_context* context){
 }
 
 TAPI b8 platform_pump_messages(){
+    if(state_ptr && state_ptr->headless){
+        return platform_headless_pump();
+    }
+
     if(state_ptr){
         xcb_generic_event_t* event;
         xcb_client_message_event_t* cm;
@@ -323,6 +340,29 @@ TAPI b8 platform_pump_messages(){
     return TRUE;
 }
 
+b8 platform_wait_for_messages(u64 timeout_ms){
+    if(!state_ptr || state_ptr->headless){
+        platform_sleep(timeout_ms);
+        return FALSE;
+    }
+
+    // Anything still buffered on our side has to reach the server first, or the
+    // reply being waited for may never come.
+    xcb_flush(state_ptr->connection);
+
+    // platform_pump_messages drains XCB's own queue, so anything new has to arrive
+    // on the connection's socket.
+    struct pollfd fd;
+    fd.fd = xcb_get_file_descriptor(state_ptr->connection);
+    fd.events = POLLIN;
+    fd.revents = 0;
+    i32 result = poll(&fd, 1, (i32)timeout_ms);
+    if(result < 0 && errno != EINTR){
+        TERROR("platform_wait_for_messages: poll failed with error %i.", errno);
+    }
+    return result > 0;
+}
+
 
 void* platform_allocate(u64 size, b8 aligned){
     return malloc(size);
@@ -386,14 +426,33 @@ i32 platform_get_processor_count(){
 }
 
 // NOTE: Begin threads.
-b8 tthread_create(pfn_thread_start start_function_pt, void* params, b8 auto_detach, tthread* out_thread){
+
+/** The function a new thread runs, passed through thread_start. */
+typedef struct thread_start_params {
+    pfn_thread_start start_function_ptr;
+    void* params;
+} thread_start_params;
+
+static void* thread_start(void* data){
+    thread_start_params start = *(thread_start_params*)data;
+    platform_free(data, FALSE);
+    u32 result = start.start_function_ptr(start.params);
+    // Hand back the memory the thread kept cached before it goes away.
+    memory_system_thread_exit();
+    return (void*)(u64)result;
+}
+
+b8 tthread_create(pfn_thread_start start_function_ptr, void* params, b8 auto_detach, tthread* out_thread){
     if(!start_function_ptr){
         return FALSE;
     }
 
-    // pthread_create uses a function pointer that returns void*, so cold-cast to this type.
-    i32 result = tthread_create((pthread_t*)&out_thread->thread_id, 0, (void* (*)(void*))start_function_ptr, params);
+    thread_start_params* start = platform_allocate(sizeof(thread_start_params), FALSE);
+    start->start_function_ptr = start_function_ptr;
+    start->params = params;
+    i32 result = pthread_create((pthread_t*)&out_thread->thread_id, 0, thread_start, start);
     if(result != 0){
+        platform_free(start, FALSE);
         switch (result)
         {
         case EAGAIN:
@@ -408,7 +467,7 @@ b8 tthread_create(pfn_thread_start start_function_pt, void* params, b8 auto_deta
             break;
         }
     }
-    TDEBUG("Starting process on thread id %#x");
+    TDEBUG("Starting process on thread id %#x", out_thread->thread_id);
 
     // Only save off the handle if not auto-detaching.
     if(!auto_detach){
@@ -417,7 +476,7 @@ b8 tthread_create(pfn_thread_start start_function_pt, void* params, b8 auto_deta
     }else {
         // If immediatley detaching, make sure the operation is a success.
         result = pthread_detach(out_thread->thread_id);
-        if(!result != 0){
+        if(result != 0){
             switch(result){
                 case EINVAL:
                     TERROR("Failed to detach newly-created thread: thread is not a joinable thread.");
@@ -480,6 +539,18 @@ void tthread_cancel(tthread* thread){
     }
 }
 
+void tthread_wait(tthread* thread){
+    if(thread->internal_data){
+        i32 result = pthread_join(*(pthread_t*)thread->internal_data, 0);
+        if(result != 0){
+            TERROR("Failed to wait for thread: errno=%i", result);
+        }
+        platform_free(thread->internal_data, FALSE);
+        thread->internal_data = 0;
+        thread->thread_id = 0;
+    }
+}
+
 b8 tthread_is_active(tthread* thread){
     // TODO: Find a better way to verify this.
     return thread->internal_data != 0;
@@ -596,6 +667,80 @@ b8 tmutex_unlock(tmutex* mutex){
 }
 // NOTE: End mutexes
 
+// NOTE: Begin semaphores
+b8 tsemaphore_create(tsemaphore* out_semaphore, u32 max_count, u32 start_count){
+    if(!out_semaphore){
+        return FALSE;
+    }
+
+    // POSIX semaphores have no maximum count, so max_count is only honoured on Windows.
+    out_semaphore->internal_data = platform_allocate(sizeof(sem_t), FALSE);
+    if(sem_init((sem_t*)out_semaphore->internal_data, 0, start_count) != 0){
+        TERROR("Unable to create semaphore: errno=%i", errno);
+        platform_free(out_semaphore->internal_data, FALSE);
+        out_semaphore->internal_data = 0;
+        return FALSE;
+    }
+    return TRUE;
+}
+
+void tsemaphore_destroy(tsemaphore* semaphore){
+    if(semaphore && semaphore->internal_data){
+        sem_destroy((sem_t*)semaphore->internal_data);
+        platform_free(semaphore->internal_data, FALSE);
+        semaphore->internal_data = 0;
+    }
+}
+
+b8 tsemaphore_signal(tsemaphore* semaphore){
+    if(!semaphore || !semaphore->internal_data){
+        return FALSE;
+    }
+    if(sem_post((sem_t*)semaphore->internal_data) != 0){
+        TERROR("Unable to signal semaphore: errno=%i", errno);
+        return FALSE;
+    }
+    return TRUE;
+}
+
+b8 tsemaphore_wait(tsemaphore* semaphore, u64 timeout_ms){
+    if(!semaphore || !semaphore->internal_data){
+        return FALSE;
+    }
+
+    sem_t* sem = (sem_t*)semaphore->internal_data;
+    if(timeout_ms == TSEMAPHORE_WAIT_INFINITE){
+        // Retry if a signal handler interrupts the wait.
+        while(sem_wait(sem) != 0){
+            if(errno != EINTR){
+                TERROR("Unable to wait on semaphore: errno=%i", errno);
+                return FALSE;
+            }
+        }
+        return TRUE;
+    }
+
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_sec += timeout_ms / 1000;
+    ts.tv_nsec += (timeout_ms % 1000) * 1000 * 1000;
+    if(ts.tv_nsec >= 1000 * 1000 * 1000){
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000 * 1000 * 1000;
+    }
+    while(sem_timedwait(sem, &ts) != 0){
+        if(errno == ETIMEDOUT){
+            return FALSE;
+        }
+        if(errno != EINTR){
+            TERROR("Unable to wait on semaphore: errno=%i", errno);
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+// NOTE: End semaphores
+
 // Key translation
 keys translate_keycode(u32 x_keycode){
     switch(x_keycode){
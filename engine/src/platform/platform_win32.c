@@ -8,9 +8,13 @@
 #include "core/event.h"
 #include "core/tthread.h"
 #include "core/tmutex.h"
+#include "core/tsemaphore.h"
+#include "core/tmemory.h"
 
 #include "containers/darray.h"
 
+#include "platform_headless.h"
+
 #include <windows.h>
 #include <windowsx.h> // param input extraction
 #include <stdlib.h>
@@ -22,6 +26,8 @@
 
 
 typedef struct platform_state{
+    // No window exists while headless.
+    b8 headless;
     HINSTANCE h_instance;
     HWND hwnd;
     VkSurfaceKHR surface;
@@ -44,13 +50,19 @@ void clock_setup(){
     QueryPerformanceCounter(&start_time);
 }
 
-b8 platform_system_startup(u64* memory_requirement, void* state, const char* application_name, i32 x, i32 y, i32 width, i32 height){
+b8 platform_system_startup(u64* memory_requirement, void* state, const char* application_name, i32 x, i32 y, i32 width, i32 height, b8 headless){
     
     *memory_requirement = sizeof(platform_state);
     if(state == 0){
         return TRUE;
     }
     state_ptr = state;
+    state_ptr->headless = headless;
+    if(headless){
+        TINFO("Platform running headless; no window will be created.");
+        clock_setup();
+        return TRUE;
+    }
 
     state_ptr->h_instance = GetModuleHandleA(0);
 
@@ -137,6 +149,10 @@ void platform_system_shutdown(void* plat_state){
 }
 
 b8 platform_pump_messages(){
+    if(state_ptr && state_ptr->headless){
+        return platform_headless_pump();
+    }
+
     if(state_ptr){
         MSG message;
         while(PeekMessageA(&message, NULL, 0, 0, PM_REMOVE)){
@@ -147,6 +163,17 @@ b8 platform_pump_messages(){
     return TRUE;
 }
 
+b8 platform_wait_for_messages(u64 timeout_ms){
+    if(state_ptr && state_ptr->headless){
+        platform_sleep(timeout_ms);
+        return FALSE;
+    }
+
+    // Returns as soon as any input is queued for this thread.
+    DWORD result = MsgWaitForMultipleObjects(0, NULL, FALSE, (DWORD)timeout_ms, QS_ALLINPUT);
+    return result == WAIT_OBJECT_0;
+}
+
 void* platform_allocate(u64 size, b8 aligned){
     return malloc(size);
 }
@@ -211,22 +238,42 @@ i32 platform_get_processor_count(){
 }
 
 // NOTE: Begin threads
+
+/** The function a new thread runs, passed through thread_start. */
+typedef struct thread_start_params {
+    pfn_thread_start start_function_ptr;
+    void *params;
+} thread_start_params;
+
+static DWORD WINAPI thread_start(LPVOID data){
+    thread_start_params start = *(thread_start_params *)data;
+    platform_free(data, FALSE);
+    u32 result = start.start_function_ptr(start.params);
+    // Hand back the memory the thread kept cached before it goes away.
+    memory_system_thread_exit();
+    return result;
+}
+
 b8 tthread_create(pfn_thread_start start_function_ptr, void *params, b8 auto_detach, tthread *out_thread){
     if(!start_function_ptr){
         return FALSE;
     }
 
+    thread_start_params *start = platform_allocate(sizeof(thread_start_params), FALSE);
+    start->start_function_ptr = start_function_ptr;
+    start->params = params;
     out_thread->internal_data = CreateThread(
         0,
         0,  //Default stack size
-        (LPTHREAD_START_ROUTINE)start_function_ptr,  // function ptr
-        params, // param to pass to thread
+        thread_start,  // function ptr
+        start, // param to pass to thread
         0,
         (DWORD *)&out_thread->thread_id
     );
 
     TDEBUG("Starting process on thread id: %#x", out_thread->thread_id);
     if(!out_thread->internal_data){
+        platform_free(start, FALSE);
         return FALSE;
     }
     if(auto_detach){
@@ -262,6 +309,15 @@ void tthread_cancel(tthread *thread){
     }
 }
 
+void tthread_wait(tthread *thread){
+    if(thread && thread->internal_data){
+        WaitForSingleObject(thread->internal_data, INFINITE);
+        CloseHandle(thread->internal_data);
+        thread->internal_data = 0;
+        thread->thread_id = 0;
+    }
+}
+
 b8 tthread_is_active(tthread* thread){
     if(thread && thread->internal_data){
         DWORD exit_code = WaitForSingleObject(thread->internal_data, 0);
@@ -336,13 +392,51 @@ b8 tmutex_unlock(tmutex *mutex){
 }
 // NOTE: End mutexes
 
+// NOTE: Begin semaphores
+b8 tsemaphore_create(tsemaphore* out_semaphore, u32 max_count, u32 start_count){
+    if(!out_semaphore){
+        return FALSE;
+    }
+
+    out_semaphore->internal_data = CreateSemaphore(0, start_count, max_count, 0);
+    if(!out_semaphore->internal_data){
+        TERROR("Unable to create semaphore.");
+        return FALSE;
+    }
+    return TRUE;
+}
+
+void tsemaphore_destroy(tsemaphore* semaphore){
+    if(semaphore && semaphore->internal_data){
+        CloseHandle(semaphore->internal_data);
+        semaphore->internal_data = 0;
+    }
+}
+
+b8 tsemaphore_signal(tsemaphore* semaphore){
+    if(!semaphore || !semaphore->internal_data){
+        return FALSE;
+    }
+    // Fails if the count would exceed the maximum, which callers treat as "already signalled".
+    return ReleaseSemaphore(semaphore->internal_data, 1, 0) != 0;
+}
+
+b8 tsemaphore_wait(tsemaphore* semaphore, u64 timeout_ms){
+    if(!semaphore || !semaphore->internal_data){
+        return FALSE;
+    }
+    DWORD milliseconds = timeout_ms == TSEMAPHORE_WAIT_INFINITE ? INFINITE : (DWORD)timeout_ms;
+    return WaitForSingleObject(semaphore->internal_data, milliseconds) == WAIT_OBJECT_0;
+}
+// NOTE: End semaphores
+
 void platform_get_required_extension_names(const char*** names_darray){
     darray_push(*names_darray, &"VK_KHR_win32_surface");
 }
 
 // Surface creation for vulkan
 b8 platform_create_vulkan_surface(vulkan_context* context){
-    if(!state_ptr){
+    if(!state_ptr || state_ptr->headless){
         return FALSE;
     }
 
@@ -0,0 +1,60 @@
+#include "draw_key.h"
+
+#include "core/tmemory.h"
+
+// Eleven-bit digits cover a key in six passes rather than the eight bytes would take, which
+// measured faster even with the larger histograms.
+#define DRAW_KEY_RADIX_BITS 11
+#define DRAW_KEY_RADIX (1 << DRAW_KEY_RADIX_BITS)
+#define DRAW_KEY_DIGIT_COUNT ((64 + DRAW_KEY_RADIX_BITS - 1) / DRAW_KEY_RADIX_BITS)
+
+void draw_keys_sort(draw_key_entry* entries, u32 count, draw_key_entry* scratch){
+    if(count < 2){
+        return;
+    }
+
+    // Count every digit in one read of the keys.
+    u32 histograms[DRAW_KEY_DIGIT_COUNT][DRAW_KEY_RADIX];
+    tzero_memory(histograms, sizeof(histograms));
+    for(u32 i = 0; i < count; ++i){
+        u64 key = entries[i].key;
+        for(u32 d = 0; d < DRAW_KEY_DIGIT_COUNT; ++d){
+            histograms[d][(key >> (d * DRAW_KEY_RADIX_BITS)) & (DRAW_KEY_RADIX - 1)]++;
+        }
+    }
+
+    // Least significant digit first. Each pass is a stable scatter, so the order left by the
+    // earlier passes survives among entries with the same digit.
+    draw_key_entry* source = entries;
+    draw_key_entry* destination = scratch;
+    for(u32 d = 0; d < DRAW_KEY_DIGIT_COUNT; ++d){
+        u32* histogram = histograms[d];
+        u32 shift = d * DRAW_KEY_RADIX_BITS;
+
+        // A digit every key shares cannot change the order, so skip the pass. Unused and
+        // rarely changing fields, such as the pass, make this common.
+        if(histogram[(source[0].key >> shift) & (DRAW_KEY_RADIX - 1)] == count){
+            continue;
+        }
+
+        u32 offset = 0;
+        for(u32 b = 0; b < DRAW_KEY_RADIX; ++b){
+            u32 bucket_count = histogram[b];
+            histogram[b] = offset;
+            offset += bucket_count;
+        }
+
+        for(u32 i = 0; i < count; ++i){
+            u32 bucket = (source[i].key >> shift) & (DRAW_KEY_RADIX - 1);
+            destination[histogram[bucket]++] = source[i];
+        }
+
+        draw_key_entry* temp = source;
+        source = destination;
+        destination = temp;
+    }
+
+    if(source != entries){
+        tcopy_memory(entries, source, sizeof(draw_key_entry) * count);
+    }
+}
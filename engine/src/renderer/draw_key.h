@@ -0,0 +1,103 @@
+/**
+ * @file draw_key.h
+ * @brief 64-bit sort keys for draws, and a stable radix sort over them.
+ *
+ * A key packs everything draws are ordered by, most significant first, so that sorting the
+ * keys as plain integers gives the draw order:
+ *
+ * Opaque:      | pass:4 | 0:1 | shader:12 | material:16 | geometry:16 | depth:15 |
+ * Translucent: | pass:4 | 1:1 | inverted depth:24 | shader:12 | material:16 | 0:7 |
+ *
+ * Opaque draws are grouped by shader and material, so state changes are rare, then by geometry,
+ * so copies of the same geometry end up next to each other and can be drawn instanced, and are
+ * drawn front to back within a group. Translucent draws come after all the opaque ones in their
+ * pass and are drawn back to front. Ids wider than their field only lose grouping, never
+ * correctness.
+ */
+
+#pragma once
+
+#include "defines.h"
+
+#define DRAW_KEY_PASS_BITS 4
+#define DRAW_KEY_SHADER_BITS 12
+#define DRAW_KEY_MATERIAL_BITS 16
+#define DRAW_KEY_GEOMETRY_BITS 16
+#define DRAW_KEY_OPAQUE_DEPTH_BITS 15
+#define DRAW_KEY_TRANSLUCENT_DEPTH_BITS 24
+
+#define DRAW_KEY_PASS_SHIFT 60
+#define DRAW_KEY_TRANSLUCENT_SHIFT 59
+
+/** @brief A draw key and the index of the draw it orders. */
+typedef struct draw_key_entry {
+    u64 key;
+    u32 index;
+} draw_key_entry;
+
+/**
+ * @brief Quantizes a depth in the range [0, 1] to the given number of bits. Values outside the
+ * range are clamped.
+ */
+TINLINE u64 draw_key_quantize_depth(f32 depth, u32 bits){
+    const f32 max_value = (f32)((1u << bits) - 1);
+    if(!(depth > 0.0f)){
+        return 0;
+    }
+    if(depth >= 1.0f){
+        return (u64)max_value;
+    }
+    return (u64)(depth * max_value);
+}
+
+/**
+ * @brief Creates the key of an opaque draw.
+ *
+ * @param pass The pass the draw belongs to. Lower passes sort first.
+ * @param shader_id The identifier of the shader the draw uses.
+ * @param material_id The identifier of the material the draw uses.
+ * @param geometry_id The identifier of the geometry the draw uses.
+ * @param depth The distance of the draw from the camera, scaled to [0, 1].
+ * @return The key.
+ */
+TINLINE u64 draw_key_create_opaque(u8 pass, u32 shader_id, u32 material_id, u32 geometry_id, f32 depth){
+    return ((u64)(pass & ((1u << DRAW_KEY_PASS_BITS) - 1)) << DRAW_KEY_PASS_SHIFT) |
+           ((u64)(shader_id & ((1u << DRAW_KEY_SHADER_BITS) - 1)) << 47) |
+           ((u64)(material_id & ((1u << DRAW_KEY_MATERIAL_BITS) - 1)) << 31) |
+           ((u64)(geometry_id & ((1u << DRAW_KEY_GEOMETRY_BITS) - 1)) << 15) |
+           draw_key_quantize_depth(depth, DRAW_KEY_OPAQUE_DEPTH_BITS);
+}
+
+/**
+ * @brief Creates the key of a translucent draw.
+ *
+ * @param pass The pass the draw belongs to. Lower passes sort first.
+ * @param shader_id The identifier of the shader the draw uses.
+ * @param material_id The identifier of the material the draw uses.
+ * @param depth The distance of the draw from the camera, scaled to [0, 1].
+ * @return The key.
+ */
+TINLINE u64 draw_key_create_translucent(u8 pass, u32 shader_id, u32 material_id, f32 depth){
+    u64 inverted_depth = ((1u << DRAW_KEY_TRANSLUCENT_DEPTH_BITS) - 1) - draw_key_quantize_depth(depth, DRAW_KEY_TRANSLUCENT_DEPTH_BITS);
+    return ((u64)(pass & ((1u << DRAW_KEY_PASS_BITS) - 1)) << DRAW_KEY_PASS_SHIFT) |
+           ((u64)1 << DRAW_KEY_TRANSLUCENT_SHIFT) |
+           (inverted_depth << 35) |
+           ((u64)(shader_id & ((1u << DRAW_KEY_SHADER_BITS) - 1)) << 23) |
+           ((u64)(material_id & ((1u << DRAW_KEY_MATERIAL_BITS) - 1)) << 7);
+}
+
+/** @brief Indicates if a key is that of a translucent draw. */
+TINLINE b8 draw_key_is_translucent(u64 key){
+    return (key >> DRAW_KEY_TRANSLUCENT_SHIFT) & 1;
+}
+
+/**
+ * @brief Sorts entries by key, in ascending order. The sort is stable, so entries with equal
+ * keys keep their order. Runs in linear time whatever the order of the input, and skips
+ * the bytes of the key that every entry shares.
+ *
+ * @param entries The entries to sort. Holds the sorted entries afterwards.
+ * @param count The number of entries.
+ * @param scratch An array the sort can use, of at least count entries.
+ */
+TAPI void draw_keys_sort(draw_key_entry* entries, u32 count, draw_key_entry* scratch);
@@ -0,0 +1,471 @@
+#include "null_backend.h"
+
+#include "core/logger.h"
+#include "core/tmemory.h"
+#include "containers/hashtable.h"
+#include "systems/shader_system.h"
+
+// Matches the Vulkan backend so the frontend sees the same limits either way.
+#define NULL_MAX_REGISTERED_RENDERPASSES 31
+#define NULL_MAX_GEOMETRY_COUNT 4096
+#define NULL_MAX_INSTANCE_COUNT 1024
+// Triple buffered, like a typical swapchain.
+#define NULL_WINDOW_RENDER_TARGET_COUNT 3
+// The largest minUniformBufferOffsetAlignment in common use, so offsets are laid out as on real hardware.
+#define NULL_UBO_ALIGNMENT 256
+
+typedef struct null_geometry_data {
+    u32 id;
+    u32 vertex_count;
+    u32 index_count;
+} null_geometry_data;
+
+typedef struct null_shader {
+    b8 instance_in_use[NULL_MAX_INSTANCE_COUNT];
+} null_shader;
+
+typedef struct null_context {
+    u32 framebuffer_width;
+    u32 framebuffer_height;
+    u32 image_index;
+    void (*on_rendertarget_refresh_required)();
+
+    renderpass registered_passes[NULL_MAX_REGISTERED_RENDERPASSES];
+    void* renderpass_table_block;
+    hashtable renderpass_table;
+
+    null_geometry_data geometries[NULL_MAX_GEOMETRY_COUNT];
+
+    // Stand-ins for the swapchain images and depth buffer, which only carry a size.
+    texture window_textures[NULL_WINDOW_RENDER_TARGET_COUNT];
+    texture depth_texture;
+
+    renderer_backend_stats stats;
+} null_context;
+
+static null_context context;
+
+static void resize_window_textures(){
+    for(u32 i = 0; i < NULL_WINDOW_RENDER_TARGET_COUNT; ++i){
+        context.window_textures[i].width = context.framebuffer_width;
+        context.window_textures[i].height = context.framebuffer_height;
+        context.window_textures[i].channel_count = 4;
+        context.window_textures[i].generation++;
+    }
+    context.depth_texture.width = context.framebuffer_width;
+    context.depth_texture.height = context.framebuffer_height;
+    context.depth_texture.channel_count = 4;
+    context.depth_texture.generation++;
+}
+
+b8 null_renderer_backend_initialize(renderer_backend* backend, const renderer_backend_config* config, u8* out_window_render_target_count){
+    tzero_memory(&context, sizeof(null_context));
+    context.stats.call_count++;
+    context.on_rendertarget_refresh_required = config->on_rendertarget_refresh_required;
+
+    // Same defaults as the Vulkan backend; overridden by the first resize.
+    context.framebuffer_width = 1280;
+    context.framebuffer_height = 720;
+    resize_window_textures();
+    *out_window_render_target_count = NULL_WINDOW_RENDER_TARGET_COUNT;
+
+    for(u32 i = 0; i < NULL_MAX_REGISTERED_RENDERPASSES; ++i){
+        context.registered_passes[i].id = INVALID_ID_U16;
+    }
+
+    context.renderpass_table_block = tallocate(sizeof(u32) * NULL_MAX_REGISTERED_RENDERPASSES, MEMORY_TAG_RENDERER);
+    hashtable_create(sizeof(u32), NULL_MAX_REGISTERED_RENDERPASSES, context.renderpass_table_block, FALSE, &context.renderpass_table);
+    u32 value = INVALID_ID;
+    hashtable_fill(&context.renderpass_table, &value);
+
+    for(u32 i = 0; i < config->renderpass_count; ++i){
+        u32 id = INVALID_ID;
+        hashtable_get(&context.renderpass_table, config->pass_configs[i].name, &id);
+        if(id != INVALID_ID){
+            TERROR("Collision with renderpass named '%s'. Initialization failed.", config->pass_configs[i].name);
+            return FALSE;
+        }
+        for(u32 j = 0; j < NULL_MAX_REGISTERED_RENDERPASSES; ++j){
+            if(context.registered_passes[j].id == INVALID_ID_U16){
+                context.registered_passes[j].id = j;
+                id = j;
+                break;
+            }
+        }
+        if(id == INVALID_ID){
+            TERROR("No space was found for a new renderpass. Increase NULL_MAX_REGISTERED_RENDERPASSES. Initialization failed.");
+            return FALSE;
+        }
+
+        context.registered_passes[id].clear_flags = config->pass_configs[i].clear_flags;
+        context.registered_passes[id].clear_colour = config->pass_configs[i].clear_colour;
+        context.registered_passes[id].render_area = config->pass_configs[i].render_area;
+        null_renderer_renderpass_create(&context.registered_passes[id], 1.0f, 0, config->pass_configs[i].prev_name != 0, config->pass_configs[i].next_name != 0);
+
+        hashtable_set(&context.renderpass_table, config->pass_configs[i].name, &id);
+    }
+
+    for(u32 i = 0; i < NULL_MAX_GEOMETRY_COUNT; ++i){
+        context.geometries[i].id = INVALID_ID;
+    }
+
+    TINFO("Null renderer initialized successfully. Nothing will be drawn.");
+    return TRUE;
+}
+
+void null_renderer_backend_shutdown(renderer_backend* backend){
+    context.stats.call_count++;
+    hashtable_destroy(&context.renderpass_table);
+    tfree(context.renderpass_table_block, sizeof(u32) * NULL_MAX_REGISTERED_RENDERPASSES, MEMORY_TAG_RENDERER);
+    context.renderpass_table_block = 0;
+}
+
+void null_renderer_backend_on_resized(renderer_backend* backend, u16 width, u16 height){
+    context.stats.call_count++;
+    context.framebuffer_width = width;
+    context.framebuffer_height = height;
+    resize_window_textures();
+
+    // There is no swapchain to recreate, so the targets can be regenerated straight away.
+    if(context.on_rendertarget_refresh_required){
+        context.on_rendertarget_refresh_required();
+    }
+}
+
+b8 null_renderer_backend_begin_frame(renderer_backend* backend, f32 delta_time){
+    context.stats.call_count++;
+    context.stats.frame_count++;
+    return TRUE;
+}
+
+b8 null_renderer_backend_end_frame(renderer_backend* backend, f32 delta_time){
+    context.stats.call_count++;
+    // Cycle through the window targets as a swapchain would.
+    context.image_index = (context.image_index + 1) % NULL_WINDOW_RENDER_TARGET_COUNT;
+    return TRUE;
+}
+
+b8 null_renderer_renderpass_begin(renderpass* pass, render_target* target){
+    context.stats.call_count++;
+    context.stats.renderpass_count++;
+    return TRUE;
+}
+
+b8 null_renderer_renderpass_end(renderpass* pass){
+    context.stats.call_count++;
+    return TRUE;
+}
+
+renderpass* null_renderer_renderpass_get(const char* name){
+    context.stats.call_count++;
+    if(!name || name[0] == 0){
+        TERROR("null_renderer_renderpass_get requires a name, Nothing will be returned.");
+        return 0;
+    }
+
+    u32 id = INVALID_ID;
+    hashtable_get(&context.renderpass_table, name, &id);
+    if(id == INVALID_ID){
+        TWARN("There is no registered renderpass named '%s'.", name);
+        return 0;
+    }
+    return &context.registered_passes[id];
+}
+
+void null_renderer_draw_geometry(geometry_render_data* data, b8 bind_buffers){
+    context.stats.call_count++;
+
+    // Ignore non-uploaded geometries.
+    if(!data->geometry || data->geometry->internal_id == INVALID_ID){
+        return;
+    }
+
+    null_geometry_data* internal_data = &context.geometries[data->geometry->internal_id];
+    if(bind_buffers){
+        context.stats.buffer_bind_count++;
+    }
+    context.stats.draw_count++;
+    context.stats.element_count += internal_data->index_count ? internal_data->index_count : internal_data->vertex_count;
+}
+
+void null_renderer_draw_geometry_instanced(geometry_render_data* data, u32 instance_count, b8 bind_buffers){
+    context.stats.call_count++;
+
+    // Ignore non-uploaded geometries.
+    if(!instance_count || !data->geometry || data->geometry->internal_id == INVALID_ID){
+        return;
+    }
+
+    null_geometry_data* internal_data = &context.geometries[data->geometry->internal_id];
+    if(bind_buffers){
+        context.stats.buffer_bind_count++;
+    }
+    context.stats.draw_count++;
+    context.stats.instance_count += instance_count;
+    context.stats.element_count += (u64)(internal_data->index_count ? internal_data->index_count : internal_data->vertex_count) * instance_count;
+}
+
+void null_renderer_texture_create(const u8* pixels, texture* t){
+    context.stats.call_count++;
+    context.stats.texture_count++;
+    context.stats.bytes_uploaded += (u64)t->width * t->height * t->channel_count * (t->type == TEXTURE_TYPE_CUBE ? 6 : 1);
+    t->internal_data = 0;
+    t->generation++;
+}
+
+void null_renderer_texture_destroy(texture* t){
+    context.stats.call_count++;
+    if(context.stats.texture_count){
+        context.stats.texture_count--;
+    }
+    tzero_memory(t, sizeof(texture));
+}
+
+void null_renderer_texture_create_writeable(texture* t){
+    context.stats.call_count++;
+    context.stats.texture_count++;
+    t->internal_data = 0;
+    t->generation++;
+}
+
+void null_renderer_texture_resize(texture* t, u32 new_width, u32 new_height){
+    context.stats.call_count++;
+    if(t){
+        t->generation++;
+    }
+}
+
+void null_renderer_texture_write_data(texture* t, u32 offset, u32 size, const u8* pixels){
+    context.stats.call_count++;
+    context.stats.bytes_uploaded += size;
+    t->generation++;
+}
+
+b8 null_renderer_create_geometry(geometry* geometry, u32 vertex_size, u32 vertex_count, const void* vertices, u32 index_size, u32 index_count, const void* indices){
+    context.stats.call_count++;
+    if(!vertex_count || !vertices){
+        TERROR("null_renderer_create_geometry requires vertex data, and none was supplied. vertex_count=%d, vertices=%p", vertex_count, vertices);
+        return FALSE;
+    }
+
+    null_geometry_data* internal_data = 0;
+    if(geometry->internal_id != INVALID_ID){
+        // A re-upload keeps its slot.
+        internal_data = &context.geometries[geometry->internal_id];
+    }else{
+        for(u32 i = 0; i < NULL_MAX_GEOMETRY_COUNT; ++i){
+            if(context.geometries[i].id == INVALID_ID){
+                geometry->internal_id = i;
+                context.geometries[i].id = i;
+                internal_data = &context.geometries[i];
+                context.stats.geometry_count++;
+                break;
+            }
+        }
+    }
+
+    if(!internal_data){
+        TFATAL("null_renderer_create_geometry failed to find a free index for a new geometry upload. Adjust config to allow more.");
+        return FALSE;
+    }
+
+    internal_data->vertex_count = vertex_count;
+    internal_data->index_count = indices ? index_count : 0;
+    context.stats.bytes_uploaded += (u64)vertex_count * vertex_size + (u64)internal_data->index_count * index_size;
+    return TRUE;
+}
+
+void null_renderer_destroy_geometry(geometry* geometry){
+    context.stats.call_count++;
+    if(geometry && geometry->internal_id != INVALID_ID){
+        null_geometry_data* internal_data = &context.geometries[geometry->internal_id];
+        tzero_memory(internal_data, sizeof(null_geometry_data));
+        internal_data->id = INVALID_ID;
+        context.stats.geometry_count--;
+    }
+}
+
+b8 null_renderer_shader_create(shader* s, const shader_config* config, renderpass* pass, u8 stage_count, const char** stage_filenames, shader_stage* stages){
+    context.stats.call_count++;
+    s->internal_data = tallocate(sizeof(null_shader), MEMORY_TAG_RENDERER);
+    return TRUE;
+}
+
+void null_renderer_shader_destroy(shader* s){
+    context.stats.call_count++;
+    if(s && s->internal_data){
+        tfree(s->internal_data, sizeof(null_shader), MEMORY_TAG_RENDERER);
+        s->internal_data = 0;
+    }
+}
+
+b8 null_renderer_shader_initialize(shader* s){
+    context.stats.call_count++;
+    s->required_ubo_alignment = NULL_UBO_ALIGNMENT;
+    s->global_ubo_stride = get_aligned(s->global_ubo_size, s->required_ubo_alignment);
+    s->ubo_stride = get_aligned(s->ubo_size, s->required_ubo_alignment);
+    // Global UBO first, then the instances, as in the Vulkan backend's uniform buffer.
+    s->global_ubo_offset = 0;
+    return TRUE;
+}
+
+b8 null_renderer_shader_use(shader* s){
+    context.stats.call_count++;
+    context.stats.shader_use_count++;
+    return TRUE;
+}
+
+b8 null_renderer_shader_bind_globals(shader* s){
+    context.stats.call_count++;
+    if(!s){
+        return FALSE;
+    }
+    context.stats.bind_count++;
+    s->bound_ubo_offset = s->global_ubo_offset;
+    return TRUE;
+}
+
+b8 null_renderer_shader_bind_instance(shader* s, u32 instance_id){
+    context.stats.call_count++;
+    if(!s){
+        TERROR("null_renderer_shader_bind_instance requires a valid pointer to a shader.");
+        return FALSE;
+    }
+    context.stats.bind_count++;
+    s->bound_instance_id = instance_id;
+    s->bound_ubo_offset = s->global_ubo_stride + s->ubo_stride * instance_id;
+    return TRUE;
+}
+
+b8 null_renderer_shader_apply_globals(shader* s){
+    context.stats.call_count++;
+    return TRUE;
+}
+
+b8 null_renderer_shader_apply_instance(shader* s, b8 needs_update){
+    context.stats.call_count++;
+    return TRUE;
+}
+
+b8 null_renderer_shader_bind_instance_resources(shader* s, u32 instance_id){
+    context.stats.call_count++;
+    if(!s){
+        TERROR("null_renderer_shader_bind_instance_resources requires a valid pointer to a shader.");
+        return FALSE;
+    }
+    context.stats.bind_count++;
+    return TRUE;
+}
+
+b8 null_renderer_shader_acquire_instance_resources(shader* s, texture_map** maps, u32* out_instance_id){
+    context.stats.call_count++;
+    null_shader* internal = s->internal_data;
+    *out_instance_id = INVALID_ID;
+    for(u32 i = 0; i < NULL_MAX_INSTANCE_COUNT; ++i){
+        if(!internal->instance_in_use[i]){
+            internal->instance_in_use[i] = TRUE;
+            *out_instance_id = i;
+            return TRUE;
+        }
+    }
+
+    TERROR("null_renderer_shader_acquire_instance_resources failed to acquire new id");
+    return FALSE;
+}
+
+b8 null_renderer_shader_release_instance_resources(shader* s, u32 instance_id){
+    context.stats.call_count++;
+    null_shader* internal = s->internal_data;
+    if(instance_id >= NULL_MAX_INSTANCE_COUNT){
+        return FALSE;
+    }
+    internal->instance_in_use[instance_id] = FALSE;
+    return TRUE;
+}
+
+b8 null_renderer_set_uniform(shader* s, shader_uniform* uniform, const void* value){
+    context.stats.call_count++;
+    if(uniform->type == SHADER_UNIFORM_TYPE_SAMPLER){
+        if(uniform->scope == SHADER_SCOPE_GLOBAL){
+            s->global_texture_maps[uniform->location] = (texture_map*)value;
+        }
+    }else{
+        context.stats.uniform_set_count++;
+        context.stats.uniform_bytes += uniform->size;
+    }
+    return TRUE;
+}
+
+b8 null_renderer_texture_map_acquire_resources(texture_map* map){
+    context.stats.call_count++;
+    map->internal_data = 0;
+    return TRUE;
+}
+
+void null_renderer_texture_map_release_resources(texture_map* map){
+    context.stats.call_count++;
+    if(map){
+        map->internal_data = 0;
+    }
+}
+
+void null_renderer_renderpass_create(renderpass* out_renderpass, f32 depth, u32 stencil, b8 has_prev_pass, b8 has_next_pass){
+    context.stats.call_count++;
+    out_renderpass->internal_data = 0;
+}
+
+void null_renderer_renderpass_destroy(renderpass* pass){
+    context.stats.call_count++;
+}
+
+void null_renderer_render_target_create(u8 attachment_count, texture** attachments, renderpass* pass, u32 width, u32 height, render_target* out_target){
+    context.stats.call_count++;
+    // Take a copy of the attachments and count.
+    out_target->attachment_count = attachment_count;
+    if(!out_target->attachments){
+        out_target->attachments = tallocate(sizeof(texture*) * attachment_count, MEMORY_TAG_ARRAY);
+    }
+    tcopy_memory(out_target->attachments, attachments, sizeof(texture*) * attachment_count);
+    out_target->internal_framebuffer = 0;
+}
+
+void null_renderer_render_target_destroy(render_target* target, b8 free_internal_memory){
+    context.stats.call_count++;
+    if(target && target->attachments && free_internal_memory){
+        tfree(target->attachments, sizeof(texture*) * target->attachment_count, MEMORY_TAG_ARRAY);
+        target->attachments = 0;
+        target->attachment_count = 0;
+    }
+}
+
+texture* null_renderer_window_attachment_get(u8 index){
+    context.stats.call_count++;
+    if(index >= NULL_WINDOW_RENDER_TARGET_COUNT){
+        TFATAL("Attempting to get attachment index out of range: %d. Attachment count: %d", index, NULL_WINDOW_RENDER_TARGET_COUNT);
+        return 0;
+    }
+    return &context.window_textures[index];
+}
+
+texture* null_renderer_depth_attachment_get(){
+    context.stats.call_count++;
+    return &context.depth_texture;
+}
+
+u8 null_renderer_window_attachment_index_get(){
+    context.stats.call_count++;
+    return (u8)context.image_index;
+}
+
+b8 null_renderer_is_multithreaded(){
+    context.stats.call_count++;
+    return FALSE;
+}
+
+b8 null_renderer_get_stats(renderer_backend_stats* out_stats){
+    if(!out_stats){
+        return FALSE;
+    }
+    *out_stats = context.stats;
+    return TRUE;
+}
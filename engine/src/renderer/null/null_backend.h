@@ -0,0 +1,70 @@
+/**
+ * @file null_backend.h
+ * @brief A renderer backend that draws nothing. It keeps just enough state for the frontend
+ * and systems to run unchanged (renderpasses, render targets, shader offsets, geometry and
+ * instance ids) and counts every call made into it, so that the CPU side of the engine can
+ * be run and measured without a window or GPU.
+ */
+
+#pragma once
+
+#include "renderer/renderer_backend.h"
+#include "resources/resource_types.h"
+
+struct shader;
+struct shader_uniform;
+
+TAPI b8 null_renderer_backend_initialize(renderer_backend* backend, const renderer_backend_config* config, u8* out_window_render_target_count);
+TAPI void null_renderer_backend_shutdown(renderer_backend* backend);
+
+TAPI void null_renderer_backend_on_resized(renderer_backend* backend, u16 width, u16 height);
+
+TAPI b8 null_renderer_backend_begin_frame(renderer_backend* backend, f32 delta_time);
+TAPI b8 null_renderer_backend_end_frame(renderer_backend* backend, f32 delta_time);
+
+TAPI b8 null_renderer_renderpass_begin(renderpass* pass, render_target* target);
+TAPI b8 null_renderer_renderpass_end(renderpass* pass);
+TAPI renderpass* null_renderer_renderpass_get(const char* name);
+
+TAPI void null_renderer_draw_geometry(geometry_render_data* data, b8 bind_buffers);
+TAPI void null_renderer_draw_geometry_instanced(geometry_render_data* data, u32 instance_count, b8 bind_buffers);
+
+TAPI void null_renderer_texture_create(const u8* pixels, texture* t);
+TAPI void null_renderer_texture_destroy(texture* t);
+TAPI void null_renderer_texture_create_writeable(texture* t);
+TAPI void null_renderer_texture_resize(texture* t, u32 new_width, u32 new_height);
+TAPI void null_renderer_texture_write_data(texture* t, u32 offset, u32 size, const u8* pixels);
+
+TAPI b8 null_renderer_create_geometry(geometry* geometry, u32 vertex_size, u32 vertex_count, const void* vertices, u32 index_size, u32 index_count, const void* indices);
+TAPI void null_renderer_destroy_geometry(geometry* geometry);
+
+TAPI b8 null_renderer_shader_create(struct shader* shader, const shader_config* config, renderpass* pass, u8 stage_count, const char** stage_filenames, shader_stage* stages);
+TAPI void null_renderer_shader_destroy(struct shader* shader);
+
+TAPI b8 null_renderer_shader_initialize(struct shader* shader);
+TAPI b8 null_renderer_shader_use(struct shader* shader);
+TAPI b8 null_renderer_shader_bind_globals(struct shader* shader);
+TAPI b8 null_renderer_shader_bind_instance(struct shader* shader, u32 instance_id);
+TAPI b8 null_renderer_shader_apply_globals(struct shader* shader);
+TAPI b8 null_renderer_shader_apply_instance(struct shader* shader, b8 needs_update);
+TAPI b8 null_renderer_shader_bind_instance_resources(struct shader* shader, u32 instance_id);
+TAPI b8 null_renderer_shader_acquire_instance_resources(struct shader* shader, texture_map** maps, u32* out_instance_id);
+TAPI b8 null_renderer_shader_release_instance_resources(struct shader* shader, u32 instance_id);
+TAPI b8 null_renderer_set_uniform(struct shader* shader, struct shader_uniform* uniform, const void* value);
+
+TAPI b8 null_renderer_texture_map_acquire_resources(texture_map* map);
+TAPI void null_renderer_texture_map_release_resources(texture_map* map);
+
+TAPI void null_renderer_renderpass_create(renderpass* out_renderpass, f32 depth, u32 stencil, b8 has_prev_pass, b8 has_next_pass);
+TAPI void null_renderer_renderpass_destroy(renderpass* pass);
+
+TAPI void null_renderer_render_target_create(u8 attachment_count, texture** attachments, renderpass* pass, u32 width, u32 height, render_target* out_target);
+TAPI void null_renderer_render_target_destroy(render_target* target, b8 free_internal_memory);
+
+TAPI texture* null_renderer_window_attachment_get(u8 index);
+TAPI texture* null_renderer_depth_attachment_get();
+TAPI u8 null_renderer_window_attachment_index_get();
+
+TAPI b8 null_renderer_is_multithreaded();
+
+TAPI b8 null_renderer_get_stats(renderer_backend_stats* out_stats);
@@ -1,8 +1,11 @@
 #include "renderer_backend.h"
 #include "vulkan/vulkan_backend.h"
+#include "null/null_backend.h"
 #include "core/tmemory.h"
 
 b8 renderer_backend_create(renderer_backend_type type, renderer_backend* out_renderer_backend) {
+    // Anything a backend does not provide stays 0.
+    tzero_memory(out_renderer_backend, sizeof(renderer_backend));
 
     if(type == RENDERER_BACKEND_TYPE_VULKAN){
         out_renderer_backend->initialize = vulkan_renderer_backend_initialize;
@@ -13,6 +16,7 @@ b8 renderer_backend_create(renderer_backend_type type, renderer_backend* out_ren
         out_renderer_backend->renderpass_end = vulkan_renderer_renderpass_end;
         out_renderer_backend->resized = vulkan_renderer_backend_on_resized;
         out_renderer_backend->draw_geometry = vulkan_backend_draw_geometry;
+        out_renderer_backend->draw_geometry_instanced = vulkan_backend_draw_geometry_instanced;
         out_renderer_backend->texture_create = vulkan_backend_texture_create;
         out_renderer_backend->texture_destroy = vulkan_backend_texture_destroy;
         out_renderer_backend->texture_create_writeable = vulkan_renderer_texture_create_writeable;
@@ -33,6 +37,7 @@ b8 renderer_backend_create(renderer_backend_type type, renderer_backend* out_ren
 
         out_renderer_backend->shader_apply_globals = vulkan_renderer_shader_apply_globals;
         out_renderer_backend->shader_apply_instance = vulkan_renderer_shader_apply_instance;
+        out_renderer_backend->shader_bind_instance_resources = vulkan_renderer_shader_bind_instance_resources;
         out_renderer_backend->shader_acquire_instance_resources = vulkan_renderer_shader_acquire_instance_resources;
         out_renderer_backend->shader_release_instance_resources = vulkan_renderer_shader_release_instance_resources;
 
@@ -50,6 +55,67 @@ b8 renderer_backend_create(renderer_backend_type type, renderer_backend* out_ren
         out_renderer_backend->window_attachment_index_get = vulkan_renderer_window_attachment_index_get;
         out_renderer_backend->is_multithreaded = vulkan_renderer_is_multithreaded;
 
+        out_renderer_backend->supports_parallel_recording = vulkan_renderer_supports_parallel_recording;
+        out_renderer_backend->recording_begin = vulkan_renderer_recording_begin;
+        out_renderer_backend->recording_end = vulkan_renderer_recording_end;
+        out_renderer_backend->recordings_execute = vulkan_renderer_recordings_execute;
+        out_renderer_backend->renderpass_chunks_begin = vulkan_renderer_renderpass_chunks_begin;
+        out_renderer_backend->renderpass_chunk_begin = vulkan_renderer_renderpass_chunk_begin;
+        out_renderer_backend->renderpass_chunk_end = vulkan_renderer_renderpass_chunk_end;
+        out_renderer_backend->renderpass_chunks_end = vulkan_renderer_renderpass_chunks_end;
+
+        out_renderer_backend->get_upload_stats = vulkan_renderer_get_upload_stats;
+
+        return TRUE;
+    }
+
+    if(type == RENDERER_BACKEND_TYPE_NULL){
+        out_renderer_backend->initialize = null_renderer_backend_initialize;
+        out_renderer_backend->shutdown = null_renderer_backend_shutdown;
+        out_renderer_backend->begin_frame = null_renderer_backend_begin_frame;
+        out_renderer_backend->end_frame = null_renderer_backend_end_frame;
+        out_renderer_backend->renderpass_begin = null_renderer_renderpass_begin;
+        out_renderer_backend->renderpass_end = null_renderer_renderpass_end;
+        out_renderer_backend->resized = null_renderer_backend_on_resized;
+        out_renderer_backend->draw_geometry = null_renderer_draw_geometry;
+        out_renderer_backend->draw_geometry_instanced = null_renderer_draw_geometry_instanced;
+        out_renderer_backend->texture_create = null_renderer_texture_create;
+        out_renderer_backend->texture_destroy = null_renderer_texture_destroy;
+        out_renderer_backend->texture_create_writeable = null_renderer_texture_create_writeable;
+        out_renderer_backend->texture_resize = null_renderer_texture_resize;
+        out_renderer_backend->texture_write_data = null_renderer_texture_write_data;
+        out_renderer_backend->create_geometry = null_renderer_create_geometry;
+        out_renderer_backend->destroy_geometry = null_renderer_destroy_geometry;
+
+        out_renderer_backend->shader_create = null_renderer_shader_create;
+        out_renderer_backend->shader_destroy = null_renderer_shader_destroy;
+        out_renderer_backend->shader_set_uniform = null_renderer_set_uniform;
+        out_renderer_backend->shader_initialize = null_renderer_shader_initialize;
+        out_renderer_backend->shader_use = null_renderer_shader_use;
+        out_renderer_backend->shader_bind_globals = null_renderer_shader_bind_globals;
+        out_renderer_backend->shader_bind_instance = null_renderer_shader_bind_instance;
+
+        out_renderer_backend->shader_apply_globals = null_renderer_shader_apply_globals;
+        out_renderer_backend->shader_apply_instance = null_renderer_shader_apply_instance;
+        out_renderer_backend->shader_bind_instance_resources = null_renderer_shader_bind_instance_resources;
+        out_renderer_backend->shader_acquire_instance_resources = null_renderer_shader_acquire_instance_resources;
+        out_renderer_backend->shader_release_instance_resources = null_renderer_shader_release_instance_resources;
+
+        out_renderer_backend->texture_map_acquire_resources = null_renderer_texture_map_acquire_resources;
+        out_renderer_backend->texture_map_release_resources = null_renderer_texture_map_release_resources;
+
+        out_renderer_backend->render_target_create = null_renderer_render_target_create;
+        out_renderer_backend->render_target_destroy = null_renderer_render_target_destroy;
+
+        out_renderer_backend->renderpass_create = null_renderer_renderpass_create;
+        out_renderer_backend->renderpass_destroy = null_renderer_renderpass_destroy;
+        out_renderer_backend->renderpass_get = null_renderer_renderpass_get;
+        out_renderer_backend->window_attachment_get = null_renderer_window_attachment_get;
+        out_renderer_backend->depth_attachment_get = null_renderer_depth_attachment_get;
+        out_renderer_backend->window_attachment_index_get = null_renderer_window_attachment_index_get;
+        out_renderer_backend->is_multithreaded = null_renderer_is_multithreaded;
+        out_renderer_backend->get_stats = null_renderer_get_stats;
+
         return TRUE;
     }
 
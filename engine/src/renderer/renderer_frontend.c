@@ -4,6 +4,8 @@
 
 #include "core/logger.h"
 #include "core/tmemory.h"
+#include "core/profiler.h"
+#include "core/tatomic.h"
 
 #include "math/tmath.h"
 #include "platform/platform.h"
@@ -15,12 +17,35 @@
 #include "systems/shader_system.h"
 #include "systems/camera_system.h"
 #include "systems/render_view_system.h"
+#include "systems/job_system.h"
 
 // TODO: temporary
 #include "core/tstring.h"
 #include "core/event.h"
 // TODO: end temporary
 
+// The most views recorded in parallel in a frame. Frames with more are recorded on the main thread.
+#define RENDERER_MAX_PARALLEL_RECORDINGS 16
+// The most chunks a renderpass is split into by renderer_renderpass_record_chunked().
+#define RENDERER_MAX_RECORD_CHUNKS 32
+// The number of view ids whose recording time is kept.
+#define RENDERER_MAX_VIEW_RECORD_STATS 256
+
+// What is bound in a recording, so that binding the same again can be skipped, and the binds
+// issued and skipped in it. Each thread recording a view or a chunk of one has its own.
+typedef struct renderer_recording_state {
+    // Cleared when a renderpass begins.
+    shader* bound_shader;
+    u32 bound_instance_id;
+    geometry* bound_geometry;
+
+    renderer_bind_stats bind_stats;
+
+    // The index of the backend recording, or INVALID_ID if this is not a parallel recording of a
+    // whole view, such as that of the main thread or of a chunk.
+    u32 recording_index;
+} renderer_recording_state;
+
 typedef struct renderer_system_state {
     renderer_backend backend;
     
@@ -47,13 +72,60 @@ typedef struct renderer_system_state {
     // Only set if resizing = true. Otherwise 0.
     u8 frames_since_resize;
 
+    // The recording of the main thread. Its binds are those of the frame being drawn, since the
+    // binds of parallel recordings are added to it once they are done.
+    renderer_recording_state main_recording;
+    // The recordings of the views, when they are recorded in parallel.
+    renderer_recording_state view_recordings[RENDERER_MAX_PARALLEL_RECORDINGS];
+
+    // Binds issued and skipped in the last frame drawn, and in total.
+    renderer_bind_stats last_frame_bind_stats;
+    renderer_bind_stats total_bind_stats;
+
+    // The time spent recording each view, by view id.
+    renderer_view_record_stats view_record_stats[RENDERER_MAX_VIEW_RECORD_STATS];
 } renderer_system_state;
 
 
 // Backend render context.
 static renderer_system_state* state_ptr;
 
+// The recording the calling thread is in the middle of, or 0 for the main recording.
+static _Thread_local renderer_recording_state* current_recording = 0;
+
+// Returns the recording the calling thread records into.
+static renderer_recording_state* recording_state_get(){
+    return current_recording ? current_recording : &state_ptr->main_recording;
+}
+
+static void recording_state_reset(renderer_recording_state* recording, u32 recording_index){
+    tzero_memory(recording, sizeof(renderer_recording_state));
+    recording->bound_instance_id = INVALID_ID;
+    recording->recording_index = recording_index;
+}
+
+static void bind_stats_add(renderer_bind_stats* to, const renderer_bind_stats* from){
+    to->shader_binds += from->shader_binds;
+    to->shader_binds_skipped += from->shader_binds_skipped;
+    to->instance_binds += from->instance_binds;
+    to->instance_binds_skipped += from->instance_binds_skipped;
+    to->buffer_binds += from->buffer_binds;
+    to->buffer_binds_skipped += from->buffer_binds_skipped;
+}
+
+static void view_record_stats_add(const render_view* view, f64 seconds){
+    if(view->id >= RENDERER_MAX_VIEW_RECORD_STATS){
+        return;
+    }
+    renderer_view_record_stats* stats = &state_ptr->view_record_stats[view->id];
+    stats->last_seconds = seconds;
+    stats->total_seconds += seconds;
+    stats->frame_count++;
+}
+
 void regenerate_render_targets();
+static b8 record_views(render_packet* packet, u8 attachment_index);
+static b8 record_views_parallel(render_packet* packet, u8 attachment_index);
 
 
 #define CRITICAL_INIT(op, msg)     \
@@ -62,7 +134,7 @@ void regenerate_render_targets();
         return FALSE;               \
     }
 
-b8 renderer_system_initialize(u64* memory_requirement, void* state, const char* application_name){
+b8 renderer_system_initialize(u64* memory_requirement, void* state, const char* application_name, renderer_backend_type backend_type){
     *memory_requirement = sizeof(renderer_system_state);
     if(state == 0){
         return TRUE;
@@ -74,9 +146,9 @@ b8 renderer_system_initialize(u64* memory_requirement, void* state, const char*
     state_ptr->framebuffer_height = 720;
     state_ptr->resizing = FALSE;
     state_ptr->frames_since_resize = 0;
+    recording_state_reset(&state_ptr->main_recording, INVALID_ID);
 
-    // TODO: make this configurable
-    renderer_backend_create(RENDERER_BACKEND_TYPE_VULKAN, &state_ptr->backend);
+    CRITICAL_INIT(renderer_backend_create(backend_type, &state_ptr->backend), "Unsupported renderer backend type.");
     state_ptr->backend.frame_number = 0;
     
 
@@ -217,6 +289,7 @@ void renderer_on_resized(u16 width, u16 height){
 }
 
 b8 renderer_draw_frame(render_packet* packet){
+    TPROFILE_SCOPE("renderer_draw_frame");
     state_ptr->backend.frame_number++;
 
     // Make sure the window is not currently being resized by waiting a designated
@@ -247,17 +320,25 @@ b8 renderer_draw_frame(render_packet* packet){
     if(state_ptr->backend.begin_frame(&state_ptr->backend, packet->delta_time)){
         u8 attachment_index = state_ptr->backend.window_attachment_index_get();
 
-        // Render each view
-        for(u32 i = 0; i < packet->view_count; ++i){
-            if(!render_view_system_on_render(packet->views[i].view, &packet->views[i], state_ptr->backend.frame_number, attachment_index)){
-                TERROR("Error rendering view index %i.", i);
-                return FALSE;
-            }
+        // Record the views on the job threads when the backend can take commands from several
+        // threads at once; otherwise one after the other, here.
+        b8 parallel = state_ptr->backend.supports_parallel_recording &&
+                      state_ptr->backend.supports_parallel_recording() &&
+                      job_system_thread_slot_count() > 1 &&
+                      packet->view_count <= RENDERER_MAX_PARALLEL_RECORDINGS;
+        b8 recorded = parallel ? record_views_parallel(packet, attachment_index) : record_views(packet, attachment_index);
+        if(!recorded){
+            return FALSE;
         }
 
         // End the frame. If this fails, it is likely unrecoverable.
         b8 result = state_ptr->backend.end_frame(&state_ptr->backend, packet->delta_time);
 
+        renderer_bind_stats* frame = &state_ptr->main_recording.bind_stats;
+        bind_stats_add(&state_ptr->total_bind_stats, frame);
+        state_ptr->last_frame_bind_stats = *frame;
+        tzero_memory(frame, sizeof(renderer_bind_stats));
+
         if(!result){
             TERROR("renderer_end_frame failed. Application shutting down...");
             return FALSE;
@@ -267,6 +348,83 @@ b8 renderer_draw_frame(render_packet* packet){
     return TRUE;
 }
 
+static b8 record_views(render_packet* packet, u8 attachment_index){
+    for(u32 i = 0; i < packet->view_count; ++i){
+        render_view_packet* view_packet = &packet->views[i];
+        f64 start_time = platform_get_absolute_time();
+        if(!render_view_system_on_render(view_packet->view, view_packet, state_ptr->backend.frame_number, attachment_index)){
+            TERROR("Error rendering view index %i.", i);
+            return FALSE;
+        }
+        view_record_stats_add(view_packet->view, platform_get_absolute_time() - start_time);
+    }
+    return TRUE;
+}
+
+// The work of recording one view on a job thread.
+typedef struct view_record_job {
+    render_view_packet* packet;
+    u64 frame_number;
+    u8 attachment_index;
+    renderer_recording_state* recording;
+    f64 seconds;
+    b8 result;
+} view_record_job;
+
+static b8 view_record_job_run(void* params, void* result_data){
+    view_record_job* job = *(view_record_job**)params;
+    f64 start_time = platform_get_absolute_time();
+
+    // A thread can pick this up while it waits on jobs in the middle of another recording, so
+    // the recording it was in, and the shader in use there, are put back afterwards.
+    renderer_recording_state* previous = current_recording;
+    u32 previous_shader_id = shader_system_current_id();
+    job->result = FALSE;
+    if(state_ptr->backend.recording_begin(job->recording->recording_index)){
+        current_recording = job->recording;
+        job->result = render_view_system_on_render(job->packet->view, job->packet, job->frame_number, job->attachment_index);
+        current_recording = previous;
+        shader_system_current_id_restore(previous_shader_id);
+        job->result = state_ptr->backend.recording_end() && job->result;
+    }
+
+    job->seconds = platform_get_absolute_time() - start_time;
+    return TRUE;
+}
+
+static b8 record_views_parallel(render_packet* packet, u8 attachment_index){
+    // Each view gets a recording of its own, indexed by its place in the packet.
+    view_record_job jobs[RENDERER_MAX_PARALLEL_RECORDINGS];
+    job_info infos[RENDERER_MAX_PARALLEL_RECORDINGS];
+    for(u32 i = 0; i < packet->view_count; ++i){
+        view_record_job* job = &jobs[i];
+        job->packet = &packet->views[i];
+        job->frame_number = state_ptr->backend.frame_number;
+        job->attachment_index = attachment_index;
+        job->recording = &state_ptr->view_recordings[i];
+        recording_state_reset(job->recording, i);
+        infos[i] = job_create_priority(view_record_job_run, 0, 0, &job, sizeof(view_record_job*), 0, JOB_TYPE_GENERAL, JOB_PRIORITY_HIGH);
+    }
+    job_system_wait(job_system_submit_batch(infos, packet->view_count));
+
+    // Gather the results in view order, so that nothing depends on which thread recorded what.
+    b8 result = TRUE;
+    for(u32 i = 0; i < packet->view_count; ++i){
+        if(!jobs[i].result){
+            TERROR("Error rendering view index %i.", i);
+            result = FALSE;
+        }
+        bind_stats_add(&state_ptr->main_recording.bind_stats, &jobs[i].recording->bind_stats);
+        view_record_stats_add(packet->views[i].view, jobs[i].seconds);
+    }
+    if(!result){
+        return FALSE;
+    }
+
+    // The frame then executes the recordings, also in view order.
+    return state_ptr->backend.recordings_execute(packet->view_count);
+}
+
 void renderer_texture_create(const u8* pixels, struct texture* texture){
     state_ptr->backend.texture_create(pixels, texture);
 }
@@ -296,10 +454,39 @@ void renderer_destroy_geometry(geometry* geometry){
 }
 
 void renderer_draw_geometry(geometry_render_data* data){
-    state_ptr->backend.draw_geometry(data);
+    // Draws of the same geometry back to back share its buffers.
+    renderer_recording_state* recording = recording_state_get();
+    b8 bind_buffers = data->geometry != recording->bound_geometry;
+    if(bind_buffers){
+        recording->bind_stats.buffer_binds++;
+        recording->bound_geometry = data->geometry;
+    } else {
+        recording->bind_stats.buffer_binds_skipped++;
+    }
+    state_ptr->backend.draw_geometry(data, bind_buffers);
+}
+
+void renderer_draw_geometry_instanced(geometry_render_data* data, u32 instance_count){
+    if(!instance_count){
+        return;
+    }
+    renderer_recording_state* recording = recording_state_get();
+    b8 bind_buffers = data->geometry != recording->bound_geometry;
+    if(bind_buffers){
+        recording->bind_stats.buffer_binds++;
+        recording->bound_geometry = data->geometry;
+    } else {
+        recording->bind_stats.buffer_binds_skipped++;
+    }
+    state_ptr->backend.draw_geometry_instanced(data, instance_count, bind_buffers);
 }
 
 b8 renderer_renderpass_begin(renderpass* pass, render_target* target){
+    // Nothing is known to be bound at the start of a pass.
+    renderer_recording_state* recording = recording_state_get();
+    recording->bound_shader = 0;
+    recording->bound_instance_id = INVALID_ID;
+    recording->bound_geometry = 0;
     return state_ptr->backend.renderpass_begin(pass, target);
 }
 
@@ -307,6 +494,93 @@ b8 renderer_renderpass_end(renderpass* pass){
     return state_ptr->backend.renderpass_end(pass);
 }
 
+// What the chunks of a renderer_renderpass_record_chunked() call share.
+typedef struct record_chunked_state {
+    pfn_renderer_record_chunk fn;
+    void* user_data;
+    u32 grain;
+    u32 recording_index;
+    renderer_recording_state* chunk_recordings;
+    volatile i32 failed;
+} record_chunked_state;
+
+static void record_chunk(u32 begin, u32 end, void* user_data){
+    record_chunked_state* chunked = user_data;
+    u32 chunk_index = begin / chunked->grain;
+    if(!state_ptr->backend.renderpass_chunk_begin(chunked->recording_index, chunk_index)){
+        tatomic_store_i32(&chunked->failed, TRUE, TATOMIC_RELAXED);
+        return;
+    }
+
+    // As with views, the thread may be in the middle of another recording.
+    renderer_recording_state* previous = current_recording;
+    u32 previous_shader_id = shader_system_current_id();
+    current_recording = &chunked->chunk_recordings[chunk_index];
+    b8 result = chunked->fn(begin, end, chunked->user_data);
+    current_recording = previous;
+    shader_system_current_id_restore(previous_shader_id);
+
+    if(!state_ptr->backend.renderpass_chunk_end() || !result){
+        tatomic_store_i32(&chunked->failed, TRUE, TATOMIC_RELAXED);
+    }
+}
+
+b8 renderer_renderpass_record_chunked(u32 count, u32 grain, pfn_renderer_record_chunk fn, void* user_data){
+    if(count == 0){
+        return TRUE;
+    }
+    grain = grain ? grain : 1;
+    if((count + grain - 1) / grain > RENDERER_MAX_RECORD_CHUNKS){
+        grain = (count + RENDERER_MAX_RECORD_CHUNKS - 1) / RENDERER_MAX_RECORD_CHUNKS;
+    }
+    u32 chunk_count = (count + grain - 1) / grain;
+
+    // Only a view being recorded on a job thread can have its chunks recorded in parallel.
+    // Otherwise they are recorded in order, which draws the same, if with fewer binds.
+    renderer_recording_state* recording = recording_state_get();
+    if(recording->recording_index == INVALID_ID || chunk_count < 2){
+        for(u32 begin = 0; begin < count; begin += grain){
+            if(!fn(begin, begin + grain < count ? begin + grain : count, user_data)){
+                return FALSE;
+            }
+        }
+        return TRUE;
+    }
+
+    if(!state_ptr->backend.renderpass_chunks_begin(chunk_count)){
+        return FALSE;
+    }
+
+    renderer_recording_state chunk_recordings[RENDERER_MAX_RECORD_CHUNKS];
+    for(u32 i = 0; i < chunk_count; ++i){
+        recording_state_reset(&chunk_recordings[i], INVALID_ID);
+    }
+
+    record_chunked_state chunked;
+    chunked.fn = fn;
+    chunked.user_data = user_data;
+    chunked.grain = grain;
+    chunked.recording_index = recording->recording_index;
+    chunked.chunk_recordings = chunk_recordings;
+    chunked.failed = FALSE;
+    job_system_parallel_for(count, grain, record_chunk, &chunked);
+
+    // Gather the binds in chunk order, so they don't depend on which thread recorded what.
+    for(u32 i = 0; i < chunk_count; ++i){
+        bind_stats_add(&recording->bind_stats, &chunk_recordings[i].bind_stats);
+    }
+
+    // What follows is recorded into a new command buffer, with nothing bound.
+    recording->bound_shader = 0;
+    recording->bound_instance_id = INVALID_ID;
+    recording->bound_geometry = 0;
+    if(!state_ptr->backend.renderpass_chunks_end()){
+        return FALSE;
+    }
+
+    return !tatomic_load_i32(&chunked.failed, TATOMIC_RELAXED);
+}
+
 renderpass* renderer_renderpass_get(const char* name){
     return state_ptr->backend.renderpass_get(name);
 }
@@ -330,7 +604,19 @@ b8 renderer_shader_initialize(shader* s) {
 
 
 b8 renderer_shader_use(shader* s) {
-    return state_ptr->backend.shader_use(s);
+    renderer_recording_state* recording = recording_state_get();
+    if(s == recording->bound_shader){
+        recording->bind_stats.shader_binds_skipped++;
+        return TRUE;
+    }
+    if(!state_ptr->backend.shader_use(s)){
+        return FALSE;
+    }
+    recording->bind_stats.shader_binds++;
+    recording->bound_shader = s;
+    // A new pipeline means the instance has to be bound again.
+    recording->bound_instance_id = INVALID_ID;
+    return TRUE;
 }
 
 
@@ -354,7 +640,36 @@ b8 renderer_shader_apply_globals(shader* s) {
 
 
 b8 renderer_shader_apply_instance(shader* s, b8 needs_update) {
-    return state_ptr->backend.shader_apply_instance(s, needs_update);
+    // An instance that is already bound and hasn't changed needs nothing more.
+    renderer_recording_state* recording = recording_state_get();
+    if(!needs_update && s == recording->bound_shader && s->bound_instance_id == recording->bound_instance_id){
+        recording->bind_stats.instance_binds_skipped++;
+        return TRUE;
+    }
+    if(!state_ptr->backend.shader_apply_instance(s, needs_update)){
+        recording->bound_instance_id = INVALID_ID;
+        return FALSE;
+    }
+    recording->bind_stats.instance_binds++;
+    recording->bound_instance_id = s == recording->bound_shader ? s->bound_instance_id : INVALID_ID;
+    return TRUE;
+}
+
+
+
+b8 renderer_shader_bind_instance_resources(shader* s, u32 instance_id) {
+    renderer_recording_state* recording = recording_state_get();
+    if(s == recording->bound_shader && instance_id == recording->bound_instance_id){
+        recording->bind_stats.instance_binds_skipped++;
+        return TRUE;
+    }
+    if(!state_ptr->backend.shader_bind_instance_resources(s, instance_id)){
+        recording->bound_instance_id = INVALID_ID;
+        return FALSE;
+    }
+    recording->bind_stats.instance_binds++;
+    recording->bound_instance_id = s == recording->bound_shader ? instance_id : INVALID_ID;
+    return TRUE;
 }
 
 
@@ -403,6 +718,41 @@ b8 renderer_is_multithreaded(){
     return state_ptr->backend.is_multithreaded();
 }
 
+b8 renderer_get_backend_stats(renderer_backend_stats* out_stats){
+    if(!state_ptr || !state_ptr->backend.get_stats){
+        return FALSE;
+    }
+    return state_ptr->backend.get_stats(out_stats);
+}
+
+b8 renderer_get_upload_stats(renderer_upload_stats* out_stats){
+    if(!state_ptr || !state_ptr->backend.get_upload_stats){
+        return FALSE;
+    }
+    return state_ptr->backend.get_upload_stats(out_stats);
+}
+
+b8 renderer_get_bind_stats(renderer_bind_stats* out_frame_stats, renderer_bind_stats* out_total_stats){
+    if(!state_ptr){
+        return FALSE;
+    }
+    if(out_frame_stats){
+        *out_frame_stats = state_ptr->last_frame_bind_stats;
+    }
+    if(out_total_stats){
+        *out_total_stats = state_ptr->total_bind_stats;
+    }
+    return TRUE;
+}
+
+b8 renderer_get_view_record_stats(const render_view* view, renderer_view_record_stats* out_stats){
+    if(!state_ptr || !view || !out_stats || view->id >= RENDERER_MAX_VIEW_RECORD_STATS){
+        return FALSE;
+    }
+    *out_stats = state_ptr->view_record_stats[view->id];
+    return TRUE;
+}
+
 void regenerate_render_targets(){
     // Create render targets for each. TODO: Should be configurable.
     for(u8 i = 0; i < state_ptr->window_render_target_count; ++i){
@@ -7,7 +7,17 @@ struct static_mesh_data;
 struct shader;
 struct shader_uniform;
 
-b8 renderer_system_initialize(u64* memory_requirement, void* state, const char* application_name);
+/**
+ * @brief Initializes the renderer. Call twice; once with state = 0 to get the required memory size,
+ * then a second time passing allocated memory to state.
+ *
+ * @param memory_requirement A pointer to hold the required memory size of internal state.
+ * @param state 0 if just requesting memory requirement, otherwise allocated block of memory.
+ * @param application_name The name of the application.
+ * @param backend_type The backend to render with.
+ * @return True on success; otherwise false.
+ */
+b8 renderer_system_initialize(u64* memory_requirement, void* state, const char* application_name, renderer_backend_type backend_type);
 void renderer_system_shutdown(void* state);
 
 void renderer_on_resized(u16 width, u16 height);
@@ -58,6 +68,16 @@ void renderer_destroy_geometry(geometry* geometry);
  */
 void renderer_draw_geometry(geometry_render_data* data);
 
+/**
+ * @brief Draws several copies of the same geometry with one instanced draw. The model matrix of
+ * each is passed to the shader as a per-instance attribute rather than as a local uniform, so
+ * the bound shader must declare one. Should only be called inside a renderpass, within a frame.
+ *
+ * @param data An array of render data, one per instance. All must have the same geometry.
+ * @param instance_count The number of instances.
+ */
+void renderer_draw_geometry_instanced(geometry_render_data* data, u32 instance_count);
+
 /**
  * @brief Begins the given renderpass.
  *
@@ -75,6 +95,23 @@ b8 renderer_renderpass_begin(renderpass* pass, render_target* target);
  */
 b8 renderer_renderpass_end(renderpass* pass);
 
+/**
+ * @brief Records the draws of the current renderpass for indices 0 to count - 1 in chunks of
+ * grain, calling fn for each chunk. When the view is being recorded on a job thread, the chunks
+ * are recorded across the job threads and executed in chunk order; otherwise fn is called for
+ * each chunk in turn. Nothing bound before a chunk can be relied on within it, so fn must use its
+ * shader and bind what it draws with, and nothing it binds carries over to what follows. Shared
+ * state, such as material uniforms, must be applied before the call, since fn may be running on
+ * several threads at once. Should only be called inside a renderpass, within a frame.
+ *
+ * @param count The number of indices.
+ * @param grain The number of indices per chunk. Raised if there would be too many chunks.
+ * @param fn The function recording a chunk, from begin up to but not including end.
+ * @param user_data Data passed to each fn invocation.
+ * @return True if every chunk was recorded; otherwise false.
+ */
+b8 renderer_renderpass_record_chunked(u32 count, u32 grain, pfn_renderer_record_chunk fn, void* user_data);
+
 /**
  * @brief Obtains a pointer to the renderpass with the given name.
  *
@@ -170,6 +207,17 @@ b8 renderer_shader_apply_globals(struct shader* s);
  */
 b8 renderer_shader_apply_instance(struct shader* s, b8 needs_update);
 
+/**
+ * @brief Binds the resources of an instance that has already been applied this frame, without
+ * updating them or changing any state of the shader, so that it can be called from several
+ * recording threads at once.
+ *
+ * @param s A pointer to the shader the instance belongs to.
+ * @param instance_id The identifier of the instance to bind.
+ * @return True on success; otherwise false.
+ */
+b8 renderer_shader_bind_instance_resources(struct shader* s, u32 instance_id);
+
 
 
 /**
@@ -262,4 +310,40 @@ void renderer_renderpass_destroy(renderpass* pass);
 /**
  * @brief Indicates if the renderer is capable of multi-threading.
  */
-b8 renderer_is_multithreaded();
\ No newline at end of file
+b8 renderer_is_multithreaded();
+
+/**
+ * @brief Gets counts of the work the backend has been given since it was initialized.
+ *
+ * @param out_stats A pointer to hold the counts.
+ * @return True on success; false if the backend does not keep any.
+ */
+b8 renderer_get_backend_stats(renderer_backend_stats* out_stats);
+
+/**
+ * @brief Gets counts and times of the geometry and texture uploads the backend has made.
+ *
+ * @param out_stats A pointer to hold the counts and times.
+ * @return True on success; false if the backend does not keep any.
+ */
+b8 renderer_get_upload_stats(renderer_upload_stats* out_stats);
+
+/**
+ * @brief Gets counts of the shader, instance and buffer binds passed on to the backend, and of
+ * those skipped because the same state was still bound.
+ *
+ * @param out_frame_stats A pointer to hold the counts for the last frame drawn. Optional.
+ * @param out_total_stats A pointer to hold the counts for every frame drawn. Optional.
+ * @return True on success; otherwise false.
+ */
+b8 renderer_get_bind_stats(renderer_bind_stats* out_frame_stats, renderer_bind_stats* out_total_stats);
+
+/**
+ * @brief Gets the time spent recording the commands of the given view, whether on the main
+ * thread or a job thread.
+ *
+ * @param view A pointer to the view.
+ * @param out_stats A pointer to hold the times.
+ * @return True on success; false if the view's times are not kept.
+ */
+b8 renderer_get_view_record_stats(const render_view* view, renderer_view_record_stats* out_stats);
\ No newline at end of file
@@ -14,9 +14,105 @@ struct shader_uniform;
 typedef enum renderer_backend_type{
     RENDERER_BACKEND_TYPE_VULKAN,
     RENDERER_BACKEND_TYPE_OPENGL,
-    RENDERER_BACKEND_TYPE_DIRECTX
+    RENDERER_BACKEND_TYPE_DIRECTX,
+    /** @brief Draws nothing and needs no window or GPU; only counts what it is asked to do. */
+    RENDERER_BACKEND_TYPE_NULL
 } renderer_backend_type;
 
+/** @brief Counts of the work a renderer backend has been given since it was initialized. */
+typedef struct renderer_backend_stats {
+    /** @brief The number of calls made into the backend through any function pointer. */
+    u64 call_count;
+    /** @brief The number of frames begun. */
+    u64 frame_count;
+    /** @brief The number of renderpasses begun. */
+    u64 renderpass_count;
+    /** @brief The number of geometry draws, counting an instanced draw once. */
+    u64 draw_count;
+    /** @brief The number of instances drawn by instanced draws. */
+    u64 instance_count;
+    /** @brief The number of indices drawn, or vertices for non-indexed geometry. */
+    u64 element_count;
+    /** @brief The number of times a shader was made current. */
+    u64 shader_use_count;
+    /** @brief The number of global and instance binds. */
+    u64 bind_count;
+    /** @brief The number of non-sampler uniform values set. */
+    u64 uniform_set_count;
+    /** @brief The bytes of geometry and texture data uploaded. */
+    u64 bytes_uploaded;
+    /** @brief The bytes of uniform data set. */
+    u64 uniform_bytes;
+    /** @brief The number of textures currently created. */
+    u32 texture_count;
+    /** @brief The number of geometries currently uploaded. */
+    u32 geometry_count;
+    /** @brief The number of times vertex and index buffers were bound for a draw. */
+    u64 buffer_bind_count;
+} renderer_backend_stats;
+
+/**
+ * @brief Counts of the binds the frontend passed on to the backend, and of those it skipped
+ * because the same state was already bound.
+ */
+typedef struct renderer_bind_stats {
+    /** @brief The number of shaders (pipelines) bound. */
+    u64 shader_binds;
+    /** @brief The number of shader binds skipped. */
+    u64 shader_binds_skipped;
+    /** @brief The number of shader instances (material descriptor sets) bound. */
+    u64 instance_binds;
+    /** @brief The number of shader instance binds skipped. */
+    u64 instance_binds_skipped;
+    /** @brief The number of draws that bound their vertex and index buffers. */
+    u64 buffer_binds;
+    /** @brief The number of draws that found their buffers already bound. */
+    u64 buffer_binds_skipped;
+} renderer_bind_stats;
+
+/**
+ * @brief Counts and times of the geometry and texture data the backend has uploaded since it
+ * was initialized.
+ */
+typedef struct renderer_upload_stats {
+    /** @brief The number of uploads. */
+    u64 upload_count;
+    /** @brief The bytes uploaded. */
+    u64 bytes;
+    /** @brief The time the callers of uploads spent in them, stalls included, in seconds. */
+    f64 seconds;
+    /** @brief The number of submissions the uploads were batched into. */
+    u64 submission_count;
+    /** @brief The number of times an upload had to wait for the GPU. */
+    u64 stall_count;
+    /** @brief The time spent waiting for the GPU, in seconds. */
+    f64 stall_seconds;
+    /** @brief The number of times the backend waited for all uploads so far, such as before the first frame. */
+    u64 flush_count;
+    /** @brief The time spent in those waits, in seconds. */
+    f64 flush_seconds;
+    /** @brief The bytes of staging memory uploads go through. */
+    u64 staging_size;
+    /** @brief The most staging memory in use at once, in bytes. */
+    u64 staging_peak;
+} renderer_upload_stats;
+
+/**
+ * @brief A function recording the draws of a chunk of a renderpass, for the indices from begin
+ * up to but not including end. Returns false on failure.
+ */
+typedef b8 (*pfn_renderer_record_chunk)(u32 begin, u32 end, void* user_data);
+
+/** @brief The time spent recording the commands of a render view. */
+typedef struct renderer_view_record_stats {
+    /** @brief The time spent on the last frame drawn, in seconds. */
+    f64 last_seconds;
+    /** @brief The time spent on every frame drawn, in seconds. */
+    f64 total_seconds;
+    /** @brief The number of frames the view was recorded in. */
+    u64 frame_count;
+} renderer_view_record_stats;
+
 typedef struct geometry_render_data{
     mat4 model;
     geometry* geometry;
@@ -125,7 +221,25 @@ typedef struct renderer_backend {
     b8 (*renderpass_end)(renderpass* pass);
     renderpass* (*renderpass_get)(const char* name);
 
-    void (*draw_geometry)(geometry_render_data* data);
+    /**
+     * @brief Draws a geometry.
+     *
+     * @param data The render data of the geometry to be drawn.
+     * @param bind_buffers True to bind the geometry's vertex and index buffers first; false if
+     * they are still bound from the previous draw.
+     */
+    void (*draw_geometry)(geometry_render_data* data, b8 bind_buffers);
+
+    /**
+     * @brief Draws several copies of a geometry at once, each with its own model matrix, which
+     * the bound shader reads as a per-instance attribute.
+     *
+     * @param data An array of render data, one per instance. All must have the same geometry.
+     * @param instance_count The number of instances.
+     * @param bind_buffers True to bind the geometry's vertex and index buffers first; false if
+     * they are still bound from the previous draw.
+     */
+    void (*draw_geometry_instanced)(geometry_render_data* data, u32 instance_count, b8 bind_buffers);
 
     void (*texture_create)(const u8* pixels, struct texture* texture);
     void (*texture_destroy)(struct texture* texture);
@@ -247,6 +361,17 @@ typedef struct renderer_backend {
      */
     b8 (*shader_apply_instance)(struct shader* s, b8 needs_update);
 
+    /**
+     * @brief Binds the resources of the given instance, which must already have been applied
+     * this frame, for the draws that follow. Unlike shader_bind_instance and shader_apply_instance
+     * it touches no state shared between threads, so it can be called while recording in parallel.
+     *
+     * @param s A pointer to the shader the instance belongs to.
+     * @param instance_id The identifier of the instance to bind.
+     * @return True on success; otherwise false.
+     */
+    b8 (*shader_bind_instance_resources)(struct shader* s, u32 instance_id);
+
     /**
      * @brief Acquires internal instance-level resources and provides an instace id.
      * 
@@ -354,6 +479,90 @@ typedef struct renderer_backend {
      */
     b8 (*is_multithreaded)();
 
+    /**
+     * @brief Indicates if render views can be recorded on several threads at once, through the
+     * recording functions below. Optional; 0 if they cannot.
+     */
+    b8 (*supports_parallel_recording)();
+
+    /**
+     * @brief Starts recording on the calling thread. Renderpasses begun until recording_end()
+     * record into command buffers of their own rather than the frame's, to be executed later by
+     * recordings_execute(). Recordings can nest on a thread, such as when one thread picks up
+     * another view's job while waiting on its own.
+     *
+     * @param index The index of the recording, which sets the order it is executed in.
+     * @return True on success; otherwise false.
+     */
+    b8 (*recording_begin)(u32 index);
+
+    /**
+     * @brief Ends the recording on the calling thread started by recording_begin().
+     *
+     * @return True on success; otherwise false.
+     */
+    b8 (*recording_end)();
+
+    /**
+     * @brief Executes recordings 0 to count - 1, in index order, as part of the frame. Call on
+     * the thread that began the frame, after every recording has ended.
+     *
+     * @param count The number of recordings.
+     * @return True on success; otherwise false.
+     */
+    b8 (*recordings_execute)(u32 count);
+
+    /**
+     * @brief Splits the rest of the current renderpass of the calling thread's recording into
+     * chunk_count chunks, which can then be recorded on any thread and are executed in chunk
+     * order. Whatever the calling thread records after renderpass_chunks_end() comes after them.
+     *
+     * @param chunk_count The number of chunks.
+     * @return True on success; otherwise false.
+     */
+    b8 (*renderpass_chunks_begin)(u32 chunk_count);
+
+    /**
+     * @brief Starts recording a chunk on the calling thread. Nothing of the recording's state,
+     * such as the shader in use, carries over into a chunk.
+     *
+     * @param recording_index The index of the recording the chunks belong to.
+     * @param chunk_index The index of the chunk.
+     * @return True on success; otherwise false.
+     */
+    b8 (*renderpass_chunk_begin)(u32 recording_index, u32 chunk_index);
+
+    /**
+     * @brief Ends the chunk on the calling thread started by renderpass_chunk_begin().
+     *
+     * @return True on success; otherwise false.
+     */
+    b8 (*renderpass_chunk_end)();
+
+    /**
+     * @brief Ends the chunks started by renderpass_chunks_begin(), after they have all been
+     * recorded, and carries on with the renderpass on the calling thread.
+     *
+     * @return True on success; otherwise false.
+     */
+    b8 (*renderpass_chunks_end)();
+
+    /**
+     * @brief Gets counts of the work the backend has been given. Optional; 0 if the backend does not keep any.
+     *
+     * @param out_stats A pointer to hold the counts.
+     * @return True on success; otherwise false.
+     */
+    b8 (*get_stats)(renderer_backend_stats* out_stats);
+
+    /**
+     * @brief Gets counts and times of the uploads the backend has made. Optional; 0 if the backend does not keep any.
+     *
+     * @param out_stats A pointer to hold the counts and times.
+     * @return True on success; otherwise false.
+     */
+    b8 (*get_upload_stats)(renderer_upload_stats* out_stats);
+
 } renderer_backend;
 
 /** @brief Known render view types, which have logic associated with them. */
@@ -415,6 +624,7 @@ typedef struct render_view_config {
 } render_view_config;
 
 struct render_view_packet;
+struct frame_allocator;
 
 /**
  * @brief A render view instance, responsible for the generation
@@ -470,11 +680,12 @@ typedef struct render_view {
      * @brief Builds a render view packet using the provided view and meshes.
      *
      * @param self A pointer to the view to use.
+     * @param frame_allocator The allocator for the packet's arrays, which only need to live for the frame.
      * @param data Freeform data used to build the packet.
      * @param out_packet A pointer to hold the generated packet.
      * @return True on success; otherwise false.
      */
-    b8 (*on_build_packet)(const struct render_view* self, void* data, struct render_view_packet* out_packet);
+    b8 (*on_build_packet)(const struct render_view* self, struct frame_allocator* frame_allocator, void* data, struct render_view_packet* out_packet);
 
     /**
      * @brief Uses the given view and packet to render the contents therein.
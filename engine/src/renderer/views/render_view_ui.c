@@ -4,8 +4,8 @@
 #include "core/tmemory.h"
 #include "core/event.h"
 #include "math/tmath.h"
-#include "math/transform.h"
-#include "containers/darray.h"
+#include "systems/transform_system.h"
+#include "memory/frame_allocator.h"
 #include "systems/material_system.h"
 #include "systems/shader_system.h"
 #include "systems/camera_system.h"
@@ -68,7 +68,7 @@ void render_view_ui_on_resize(struct render_view* self, u32 width, u32 height){
     }
 }
 
-b8 render_view_ui_on_build_packet(const struct render_view* self, void* data, struct render_view_packet* out_packet){
+b8 render_view_ui_on_build_packet(const struct render_view* self, struct frame_allocator* frame_allocator, void* data, struct render_view_packet* out_packet){
     if(!self || !data || !out_packet){
         TWARN("render_view_ui_on_build_packet requires valid pointer to view, packet, and data.");
         return FALSE;
@@ -77,7 +77,16 @@ b8 render_view_ui_on_build_packet(const struct render_view* self, void* data, st
     mesh_packet_data* mesh_data = (mesh_packet_data*)data;
     render_view_ui_internal_data* internal_data = (render_view_ui_internal_data*)self->internal_data;
 
-    out_packet->geometries = darray_create(geometry_render_data);
+    u32 max_geometry_count = 0;
+    for(u32 i = 0; i < mesh_data->mesh_count; ++i){
+        max_geometry_count += mesh_data->meshes[i]->geometry_count;
+    }
+
+    out_packet->geometries = frame_allocator_allocate(frame_allocator, sizeof(geometry_render_data) * max_geometry_count);
+    if(max_geometry_count && !out_packet->geometries){
+        TERROR("render_view_ui_on_build_packet failed to allocate frame memory for %u geometries.", max_geometry_count);
+        return FALSE;
+    }
     out_packet->view = self;
 
     // Set matrices, etc.
@@ -92,8 +101,8 @@ b8 render_view_ui_on_build_packet(const struct render_view* self, void* data, st
         for(u32 j = 0; j < m->geometry_count; ++j){
             geometry_render_data render_data;
             render_data.geometry = m->geometries[j];
-            render_data.model = transform_get_world(&m->transform);
-            darray_push(out_packet->geometries, render_data);
+            render_data.model = transform_system_get_world(m->transform_handle);
+            out_packet->geometries[out_packet->geometry_count] = render_data;
             out_packet->geometry_count++;
         }
     }
@@ -3,13 +3,15 @@
 #include "core/logger.h"
 #include "core/tmemory.h"
 #include "core/event.h"
+#include "core/tatomic.h"
 #include "math/tmath.h"
-#include "math/transform.h"
-#include "containers/darray.h"
+#include "systems/transform_system.h"
+#include "memory/frame_allocator.h"
 #include "systems/material_system.h"
 #include "systems/shader_system.h"
 #include "systems/camera_system.h"
 #include "renderer/renderer_frontend.h"
+#include "renderer/draw_key.h"
 
 typedef struct render_view_world_internal_data {
     u32 shader_id;
@@ -20,27 +22,9 @@ typedef struct render_view_world_internal_data {
     camera* world_camera;
     vec4 ambient_colour;
     u32 render_mode;
+    render_view_world_stats stats;
 } render_view_world_internal_data;
 
-/** @brief A provate structure used to sort geometry by distance from the camera. */
-typedef struct geometry_distance
-{
-    /** @brief The geometry render data. */
-    geometry_render_data g;
-    /** @brief The distance from the camera */
-    f32 distance;
-} geometry_distance;
-
-/**
- * @brief A private, recursive, in-place sort function for geometry_distance structures.
- * 
- * @param arr The array of geometry_distance structures to be sorted.
- * @param low_index The low index to start the sort from (typically 0).
- * @param high_index The high index to end with (typically the array length - 1)
- * @param ascending True to sort in ascending order; otherwise descending.
- */
-static void quick_sort(geometry_distance arr[], i32 low_index, i32 high_index, b8 ascending);
-
 static b8 render_view_on_event(u16 code, void* sender, void* listener_inst, event_context context){
     render_view* self = (render_view*) listener_inst;
     if(!self){
@@ -136,7 +120,7 @@ void render_view_world_on_resize(struct render_view* self, u32 width, u32 height
     }
 }
 
-b8 render_view_world_on_build_packet(const struct render_view* self, void* data, struct render_view_packet* out_packet){
+b8 render_view_world_on_build_packet(const struct render_view* self, struct frame_allocator* frame_allocator, void* data, struct render_view_packet* out_packet){
     if(!self || !data || !out_packet){
         TWARN("render_view_world_on_build_packet requires valid pointer to view, packet, and data.");
         return FALSE;
@@ -145,7 +129,23 @@ b8 render_view_world_on_build_packet(const struct render_view* self, void* data,
     mesh_packet_data* mesh_data = (mesh_packet_data*)data;
     render_view_world_internal_data* internal_data = (render_view_world_internal_data*)self->internal_data;
 
-    out_packet->geometries = darray_create(geometry_render_data);
+    // Size the frame's arrays for every geometry of every mesh, so nothing has to grow.
+    u32 max_geometry_count = 0;
+    for(u32 i = 0; i < mesh_data->mesh_count; ++i){
+        max_geometry_count += mesh_data->meshes[i]->geometry_count;
+    }
+
+    out_packet->geometries = frame_allocator_allocate(frame_allocator, sizeof(geometry_render_data) * max_geometry_count);
+    geometry_render_data* candidates = frame_allocator_allocate(frame_allocator, sizeof(geometry_render_data) * max_geometry_count);
+    vec3* centers = frame_allocator_allocate(frame_allocator, sizeof(vec3) * max_geometry_count);
+    vec3* half_extents = frame_allocator_allocate(frame_allocator, sizeof(vec3) * max_geometry_count);
+    u32* visible_indices = frame_allocator_allocate(frame_allocator, sizeof(u32) * max_geometry_count);
+    draw_key_entry* draw_keys = frame_allocator_allocate(frame_allocator, sizeof(draw_key_entry) * max_geometry_count);
+    draw_key_entry* draw_key_scratch = frame_allocator_allocate(frame_allocator, sizeof(draw_key_entry) * max_geometry_count);
+    if(max_geometry_count && (!out_packet->geometries || !candidates || !centers || !half_extents || !visible_indices || !draw_keys || !draw_key_scratch)){
+        TERROR("render_view_world_on_build_packet failed to allocate frame memory for %u geometries.", max_geometry_count);
+        return FALSE;
+    }
     out_packet->view = self;
 
     // Set matrices, etc.
@@ -154,57 +154,131 @@ b8 render_view_world_on_build_packet(const struct render_view* self, void* data,
     out_packet->view_position = camera_position_get(internal_data->world_camera);
     out_packet->ambient_colour = internal_data->ambient_colour;
 
-    // Obtain all geometries from the current scene.
-    geometry_distance* geometry_distances = darray_create(geometry_distance);
-
+    // Gather every geometry along with its bounding box in world space. Those without extents to
+    // go by are always visible. They are gathered from the end of the arrays, apart from the rest.
+    u32 candidate_count = 0;
+    u32 always_visible_first = max_geometry_count;
     for(u32 i = 0; i < mesh_data->mesh_count; ++i){
         mesh* m = mesh_data->meshes[i];
-        mat4 model = transform_get_world(&m->transform);
+        mat4 model = transform_system_get_world(m->transform_handle);
 
         for(u32 j = 0; j < m->geometry_count; ++j){
-            // Only add meshes with _no_ transparency.
-            geometry_render_data render_data;
-            render_data.geometry = m->geometries[j];
-            render_data.model = model;
-
-            // TODO: Add something to material to check for transparency.
-            if((m->geometries[j]->material->diffuse_map.texture->flags & TEXTURE_FLAG_HAS_TRANSPARENCY) == 0){
-                // Only add meshes with _no_ transparency.
-                darray_push(out_packet->geometries, render_data);
-                out_packet->geometry_count++;
-            } else {
-                // For meshes _with_ transparency, add them to a separate list to be sorted by distance later.
-                // Get the center, extract the global position from the model matrix and add it to the center,
-                // then calculate the distance between it and the camera, and finally save it to a list to be sorted.
-                // NOTE: This isn't perfect for translucent meshes that intersect, but is enough for our purposes now.
-                vec3 center = vec3_transform(render_data.geometry->center, model);
-                f32 distance = vec3_distance(center, internal_data->world_camera->position);
-
-                geometry_distance gdist;
-                gdist.distance = tabs(distance);
-                gdist.g = render_data;
-
-                darray_push(geometry_distances, gdist);
-            }
+            geometry* g = m->geometries[j];
+            b8 always_visible = vec3_compare(g->extents.min, g->extents.max, 0.0f);
+            u32 index = always_visible ? --always_visible_first : candidate_count++;
+            candidates[index].geometry = g;
+            candidates[index].model = model;
+            extents_3d_transform(g->extents, model, &centers[index], &half_extents[index]);
         }
     }
 
-    // Sort the distances
-    u32 geometry_count = darray_length(geometry_distances);
-    quick_sort(geometry_distances, 0, geometry_count - 1, FALSE);
+    // Drop everything outside the camera's frustum. Only boxes are tested, what is always visible
+    // is added after.
+    frustum view_frustum = frustum_from_view_projection(mat4_mul(out_packet->view_matrix, out_packet->projection_matrix));
+    u32 visible_count = frustum_cull_aabbs(&view_frustum, centers, half_extents, candidate_count, visible_indices);
+    for(u32 i = always_visible_first; i < max_geometry_count; ++i){
+        visible_indices[visible_count++] = i;
+    }
+    candidate_count += max_geometry_count - always_visible_first;
+    internal_data->stats.visible_count = visible_count;
+    internal_data->stats.culled_count = candidate_count - visible_count;
+    internal_data->stats.total_visible_count += visible_count;
+    internal_data->stats.total_culled_count += candidate_count - visible_count;
+
+    // Order what is left with a key per draw. Opaque geometry is grouped by shader, material and
+    // geometry and drawn front to back, and translucent geometry after it, back to front. Copies
+    // of the same geometry end up next to each other, ready to be drawn instanced.
+    // NOTE: Distances are to the center of the bounds, which isn't perfect for translucent
+    // meshes that intersect, but is enough for our purposes now.
+    f32 inverse_far_clip = 1.0f / internal_data->far_clip;
+    for(u32 i = 0; i < visible_count; ++i){
+        u32 index = visible_indices[i];
+        geometry* g = candidates[index].geometry;
+        material* m = g->material;
+        f32 depth = vec3_distance(centers[index], out_packet->view_position) * inverse_far_clip;
+
+        // TODO: Add something to material to check for transparency.
+        if((m->diffuse_map.texture->flags & TEXTURE_FLAG_HAS_TRANSPARENCY) == 0){
+            draw_keys[i].key = draw_key_create_opaque(0, m->shader_id, m->id, g->id, depth);
+        } else {
+            draw_keys[i].key = draw_key_create_translucent(0, m->shader_id, m->id, depth);
+        }
+        draw_keys[i].index = index;
+    }
+    draw_keys_sort(draw_keys, visible_count, draw_key_scratch);
 
-    // Add the to the packet geometry.
-    for(u32 i = 0; i < geometry_count; ++i){
-        darray_push(out_packet->geometries, geometry_distances[i].g);
-        out_packet->geometry_count++;
+    for(u32 i = 0; i < visible_count; ++i){
+        out_packet->geometries[i] = candidates[draw_keys[i].index];
     }
+    out_packet->geometry_count = visible_count;
 
     return TRUE;
 }
 
+b8 render_view_world_get_stats(const struct render_view* self, render_view_world_stats* out_stats){
+    if(!self || !self->internal_data || !out_stats){
+        return FALSE;
+    }
+    *out_stats = ((render_view_world_internal_data*)self->internal_data)->stats;
+    return TRUE;
+}
+
+// The number of geometries per chunk when the draws of a world view are recorded across threads.
+// Runs of instances are cut at chunk boundaries, so this is kept large.
+#define RENDER_VIEW_WORLD_CHUNK_SIZE 1024
+
+// What the chunks of a world view's draws share.
+typedef struct render_view_world_chunk_context {
+    const struct render_view_packet* packet;
+    shader* s;
+    u64 frame_number;
+    volatile i32 draw_count;
+} render_view_world_chunk_context;
+
+static material* geometry_material_get(geometry* g){
+    return g->material ? g->material : material_system_get_default();
+}
+
+static b8 render_view_world_record_chunk(u32 begin, u32 end, void* user_data){
+    render_view_world_chunk_context* chunk = user_data;
+    const struct render_view_packet* packet = chunk->packet;
+
+    // Nothing carries into a chunk, so the shader and its globals are bound again.
+    if(!renderer_shader_use(chunk->s) || !renderer_shader_apply_globals(chunk->s)){
+        TERROR("Failed to use material shader for a chunk of draws.");
+        return FALSE;
+    }
+
+    // Draw geometries. The packet is sorted, so copies of the same geometry are next to each
+    // other and each run of them is drawn with a single instanced draw. A geometry always has
+    // the same material, so a run never spans materials either.
+    i32 draw_count = 0;
+    u32 run_length = 0;
+    for(u32 i = begin; i < end; i += run_length){
+        run_length = 1;
+        while(i + run_length < end && packet->geometries[i + run_length].geometry == packet->geometries[i].geometry){
+            run_length++;
+        }
+
+        // Materials that failed to apply this frame are skipped.
+        material* m = geometry_material_get(packet->geometries[i].geometry);
+        if(m->render_frame_number != chunk->frame_number || !material_system_bind_instance(m)){
+            continue;
+        }
+
+        // Draw every copy, each with its own model matrix.
+        renderer_draw_geometry_instanced(&packet->geometries[i], run_length);
+        draw_count++;
+    }
+
+    tatomic_fetch_add_i32(&chunk->draw_count, draw_count, TATOMIC_RELAXED);
+    return TRUE;
+}
+
 b8 render_view_world_on_render(const struct render_view* self, const struct render_view_packet* packet, u64 frame_number, u64 render_target_index){
     render_view_world_internal_data* data = self->internal_data;
     u32 shader_id = data->shader_id;
+    u32 draw_count = 0;
 
     for(u32 p = 0; p < self->renderpass_count; ++p){
         renderpass* pass = self->passes[p];
@@ -226,35 +300,36 @@ b8 render_view_world_on_render(const struct render_view* self, const struct rend
             return FALSE;
         }
 
-        // Draw geometries.
+        // Update every material that hasn't already been this frame, up front, since the draws
+        // may be recorded on several threads at once and those only bind them. Copies of the same
+        // geometry are next to each other, so only the first of each run needs checking.
         u32 count = packet->geometry_count;
         for(u32 i = 0; i < count; ++i){
-            material* m = 0;
-            if(packet->geometries[i].geometry->material){
-                m = packet->geometries[i].geometry->material;
-            }else{
-                m = material_system_get_default();
+            if(i > 0 && packet->geometries[i].geometry == packet->geometries[i - 1].geometry){
+                continue;
             }
-
-            // Update the material if it hasn't already been this frame. This keeps the
-            // same material from being updated multiple time. It still needs to be bound
-            // either way, so this checks result gets passed to the backend which either
-            // updates the internal shader bindings and binds them, or only binds them.
-            b8 needs_update = m->render_frame_number != frame_number;
-            if(!material_system_apply_instance(m, needs_update)){
+            material* m = geometry_material_get(packet->geometries[i].geometry);
+            if(m->render_frame_number == frame_number){
+                continue;
+            }
+            if(!material_system_apply_instance(m, TRUE)){
                 TWARN("Failed to apply material '%s'. Skipping draw.", m->name);
                 continue;
-            }else{
-                // Sunc the frame number
-                m->render_frame_number = frame_number;
             }
+            // Sync the frame number.
+            m->render_frame_number = frame_number;
+        }
 
-            // Apply the locals
-            material_system_apply_local(m, &packet->geometries[i].model);
-
-            // Draw it
-            renderer_draw_geometry(&packet->geometries[i]);
+        render_view_world_chunk_context chunk;
+        chunk.packet = packet;
+        chunk.s = shader_system_get_by_id(shader_id);
+        chunk.frame_number = frame_number;
+        chunk.draw_count = 0;
+        if(!renderer_renderpass_record_chunked(count, RENDER_VIEW_WORLD_CHUNK_SIZE, render_view_world_record_chunk, &chunk)){
+            TERROR("render_view_world_on_render pass index %u failed to record its draws.", p);
+            return FALSE;
         }
+        draw_count += (u32)tatomic_load_i32(&chunk.draw_count, TATOMIC_RELAXED);
 
         if(!renderer_renderpass_end(pass)){
             TERROR("render_view_world_on_render pass index %u failed to end.", p);
@@ -262,45 +337,8 @@ b8 render_view_world_on_render(const struct render_view* self, const struct rend
         }
     }
 
-    return TRUE;
-}
-
-// Quicksort for geometry_distance
-
-static void swap(geometry_distance* a, geometry_distance* b){
-    geometry_distance temp = *a;
-    *a = *b;
-    *b = temp;
-}
-
-static i32 partition(geometry_distance arr[], i32 low_index, i32 high_index, b8 ascending){
-    geometry_distance pivot = arr[high_index];
-    i32 i = (low_index - 1);
-
-    for(i32 j = low_index; j <= high_index - 1; ++j){
-        if(ascending){
-            if(arr[j].distance < pivot.distance){
-                ++i;
-                swap(&arr[i], &arr[j]);
-            }
-        } else {
-            if(arr[j].distance > pivot.distance){
-                ++i;
-                swap(&arr[i], &arr[j]);
-            }
-        }
-    }
+    data->stats.draw_count = draw_count;
+    data->stats.total_draw_count += draw_count;
 
-    swap(&arr[i + 1], &arr[high_index]);
-    return i + 1;
+    return TRUE;
 }
-
-static void quick_sort(geometry_distance arr[], i32 low_index, i32 high_index, b8 ascending){
-    if(low_index < high_index){
-        i32 partition_index = partition(arr, low_index, high_index, ascending);
-
-        // Independently sort elements before and after the partition index.
-        quick_sort(arr, low_index, partition_index - 1, ascending);
-        quick_sort(arr, partition_index + 1, high_index, ascending);
-    }
-}
\ No newline at end of file
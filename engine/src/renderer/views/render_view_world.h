@@ -4,8 +4,36 @@
 #include "defines.h"
 #include "renderer/renderer_types.inl"
 
+/**
+ * @brief How much geometry a world view's frustum culling kept and dropped, and how many draw
+ * calls what was kept took once copies of the same geometry were drawn instanced.
+ */
+typedef struct render_view_world_stats {
+    /** @brief The number of geometries kept by the last packet built. */
+    u32 visible_count;
+    /** @brief The number of geometries culled by the last packet built. */
+    u32 culled_count;
+    /** @brief The number of draw calls made for the last packet rendered. */
+    u32 draw_count;
+    /** @brief The number of geometries kept by every packet built so far. */
+    u64 total_visible_count;
+    /** @brief The number of geometries culled by every packet built so far. */
+    u64 total_culled_count;
+    /** @brief The number of draw calls made for every packet rendered so far. */
+    u64 total_draw_count;
+} render_view_world_stats;
+
 b8 render_view_world_on_create(struct render_view* self);
 void render_view_world_on_destroy(struct render_view* self);
 void render_view_world_on_resize(struct render_view* self, u32 width, u32 height);
-b8 render_view_world_on_build_packet(const struct render_view* self, void* data, struct render_view_packet* out_packet);
-b8 render_view_world_on_render(const struct render_view* self, const struct render_view_packet* packet, u64 frame_number, u64 render_target_index);
\ No newline at end of file
+b8 render_view_world_on_build_packet(const struct render_view* self, struct frame_allocator* frame_allocator, void* data, struct render_view_packet* out_packet);
+b8 render_view_world_on_render(const struct render_view* self, const struct render_view_packet* packet, u64 frame_number, u64 render_target_index);
+
+/**
+ * @brief Obtains the culling and draw call counters of a world view.
+ *
+ * @param self A pointer to the view.
+ * @param out_stats A pointer to hold the counters.
+ * @return True on success; otherwise false.
+ */
+TAPI b8 render_view_world_get_stats(const struct render_view* self, render_view_world_stats* out_stats);
@@ -9,10 +9,12 @@
 #include "vulkan_buffer.h"
 #include "vulkan_image.h"
 #include "vulkan_pipeline.h"
+#include "vulkan_staging_ring.h"
 
 #include "core/logger.h"
 #include "core/tstring.h"
 #include "core/tmemory.h"
+#include "core/tatomic.h"
 
 #include "containers/darray.h"
 
@@ -25,10 +27,40 @@
 #include "systems/material_system.h"
 #include "systems/texture_system.h"
 #include "systems/resource_system.h"
+#include "systems/job_system.h"
 
 // Static Vulkan context
 static vulkan_context context;
 
+// Max depth of recordings and chunks nested on a single thread.
+#define VULKAN_MAX_RECORDING_DEPTH 8
+
+// What a thread is recording into, between recording_begin() and recording_end() or
+// renderpass_chunk_begin() and renderpass_chunk_end().
+typedef struct vulkan_recording_frame {
+    vulkan_recording* recording;
+    // The renderpass being recorded, or 0 outside of one.
+    vulkan_recording_segment* segment;
+    // The secondary command buffer being recorded, or 0 outside of a renderpass.
+    vulkan_command_buffer* command_buffer;
+} vulkan_recording_frame;
+
+// Per thread, since recordings happen on several threads at once. A stack, since a thread waiting
+// on jobs may pick up another recording or chunk in the middle of its own.
+static _Thread_local vulkan_recording_frame recording_stack[VULKAN_MAX_RECORDING_DEPTH];
+static _Thread_local u32 recording_depth = 0;
+
+/**
+ * Returns the command buffer commands should go into on the calling thread: the secondary
+ * command buffer of the recording it is in the middle of, if any, otherwise the frame's.
+ */
+static vulkan_command_buffer* current_command_buffer(){
+    if(recording_depth > 0 && recording_stack[recording_depth - 1].command_buffer){
+        return recording_stack[recording_depth - 1].command_buffer;
+    }
+    return &context.graphics_command_buffers[context.image_index];
+}
+
 
 VKAPI_ATTR VkBool32 VKAPI_CALL vk_debug_callback(
     VkDebugUtilsMessageSeverityFlagBitsEXT message_severity,
@@ -41,39 +73,157 @@ i32 find_memory_index(u32 type_filter, u32 property_flags);
 b8 create_buffers(vulkan_context* context);
 
 void create_command_buffers(renderer_backend* backend);
+static void set_dynamic_state(vulkan_command_buffer* command_buffer);
+static void renderpass_begin_info_create(renderpass* pass, render_target* target, VkClearValue* clear_values, VkRenderPassBeginInfo* out_begin_info);
+static vulkan_command_buffer* secondary_command_buffer_begin(renderpass* pass, render_target* target);
 b8 recreate_swapchain(renderer_backend* backend);
 b8 create_module(vulkan_shader* shader, vulkan_shader_stage_config config, vulkan_shader_stage* shader_stage);
 
-b8 upload_data_range(vulkan_context* context, VkCommandPool pool, VkFence fence, VkQueue queue, vulkan_buffer* buffer, u64* out_offset, u64 size, const void* data){
+// Uploads larger than this are split, so no one upload can take up the whole staging ring.
+#define VULKAN_MAX_UPLOAD_CHUNK_SIZE (VULKAN_STAGING_RING_SIZE / 4)
+// Offsets of uploads in the staging ring are a multiple of this, or of this times three for
+// three channel textures, since copies to images must start on a texel and a multiple of 4.
+#define VULKAN_UPLOAD_ALIGNMENT 16
+
+b8 upload_data_range(vulkan_context* context, vulkan_buffer* buffer, u64* out_offset, u64 size, const void* data, u32* ready_generation, u32 generation){
     
     if(!vulkan_buffer_allocate(buffer, size, out_offset)){
         TERROR("upload_data_range failed to allocate from the given buffer!");
         return FALSE;
     }
     
-    // Create a host-visible staging buffer to upload to. Mark it as the source of the transfer.
-    VkBufferUsageFlags flags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
-    vulkan_buffer staging;
-    vulkan_buffer_create(context, size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, flags, TRUE, FALSE, &staging);
+    // Stage the data in the ring and record the copies to the device local buffer into the
+    // batch of uploads, which runs on the transfer queue alongside the frames.
+    for(u64 done = 0; done < size;){
+        u64 chunk_size = size - done < VULKAN_MAX_UPLOAD_CHUNK_SIZE ? size - done : VULKAN_MAX_UPLOAD_CHUNK_SIZE;
+        u64 staging_offset;
+        vulkan_command_buffer* command_buffer;
+        if(!vulkan_staging_ring_upload(context, &context->staging, chunk_size, VULKAN_UPLOAD_ALIGNMENT, (const u8*)data + done, &staging_offset, &command_buffer)){
+            TERROR("upload_data_range failed to stage the data!");
+            return FALSE;
+        }
 
-    // Load the data into the staging buffer.
-    vulkan_buffer_load_data(context, &staging, 0, size, 0, data);
+        VkBufferCopy copy_region;
+        copy_region.srcOffset = staging_offset;
+        copy_region.dstOffset = *out_offset + done;
+        copy_region.size = chunk_size;
+        vkCmdCopyBuffer(command_buffer->handle, context->staging.buffer.handle, buffer->handle, 1, &copy_region);
 
-    // Perform the copy from staging to the device local buffer.
-    vulkan_buffer_copy_to(context, pool, fence, queue, staging.handle,0, buffer->handle, *out_offset, size);
+        done += chunk_size;
+    }
 
-    // Clean up the staging buffer.
-    vulkan_buffer_destroy(context, &staging);
+    // The graphics queue takes the range over once the batch holding the last copy completes.
+    vulkan_staging_ring_hand_off_buffer(&context->staging, buffer->handle, *out_offset, size, ready_generation, generation);
 
     return TRUE;
 }
 
+// Queues an object to be destroyed once the frames recorded so far, and the uploads, are done with it.
+static void deferred_destruction_push(vulkan_deferred_destruction* destruction){
+    destruction->frame_count = context.frame_submitted_count + 1;
+    destruction->batch_serial = vulkan_staging_ring_latest_batch(&context.staging);
+    darray_push(context.deferred_destructions, *destruction);
+}
+
+// Destroys the queued objects nothing can be using any more, or all of them if the device is idle.
+static void deferred_destructions_process(b8 device_idle){
+    u32 count = (u32)darray_length(context.deferred_destructions);
+    u32 done = 0;
+    for(; done < count; ++done){
+        vulkan_deferred_destruction* destruction = &context.deferred_destructions[done];
+        if(!device_idle && (destruction->frame_count > context.frame_completed_count || destruction->batch_serial > context.staging.completed_serial)){
+            break;
+        }
+
+        switch(destruction->type){
+            case VULKAN_DEFERRED_DESTRUCTION_IMAGE:
+                vulkan_image_destroy(&context, &destruction->image);
+                break;
+            case VULKAN_DEFERRED_DESTRUCTION_BUFFER_RANGE:
+                vulkan_buffer_free(destruction->buffer, destruction->size, destruction->offset);
+                break;
+            case VULKAN_DEFERRED_DESTRUCTION_SAMPLER:
+                vkDestroySampler(context.device.logical_device, destruction->sampler, context.allocator);
+                break;
+        }
+    }
+
+    if(done){
+        for(u32 i = done; i < count; ++i){
+            context.deferred_destructions[i - done] = context.deferred_destructions[i];
+        }
+        darray_length_set(context.deferred_destructions, count - done);
+    }
+}
+
+// Destroys the image once nothing can be using it. The image can be created again straight away.
+static void image_destroy_deferred(vulkan_image* image){
+    vulkan_staging_ring_forget(&context.staging, &image->ready_generation);
+
+    vulkan_deferred_destruction destruction = {0};
+    destruction.type = VULKAN_DEFERRED_DESTRUCTION_IMAGE;
+    destruction.image = *image;
+    deferred_destruction_push(&destruction);
+
+    image->handle = 0;
+    image->memory = 0;
+    image->view = 0;
+}
+
 void free_data_range(vulkan_buffer* buffer, u64 offset, u64 size){
     if(buffer){
-        vulkan_buffer_free(buffer, size, offset);
+        // Frames in flight may still draw from the range, and a batch of uploads may still copy
+        // to it, so it is only handed out again once they are done.
+        vulkan_deferred_destruction destruction = {0};
+        destruction.type = VULKAN_DEFERRED_DESTRUCTION_BUFFER_RANGE;
+        destruction.buffer = buffer;
+        destruction.offset = offset;
+        destruction.size = size;
+        deferred_destruction_push(&destruction);
     }
 }
 
+// Frees a geometry's vertex data and, if it has any, its index data.
+static void geometry_range_free(const vulkan_geometry_range* range){
+    free_data_range(&context.object_vertex_buffer, range->vertex_buffer_offset, range->vertex_element_size * range->vertex_count);
+    if(range->index_element_size > 0){
+        free_data_range(&context.object_index_buffer, range->index_buffer_offset, range->index_element_size * range->index_count);
+    }
+}
+
+// Frees the data replaced by reuploads which are now ready, since the frames from here on draw the new data.
+static void geometry_previous_ranges_release(){
+    for(u32 i = 0; i < VULKAN_MAX_GEOMETRY_COUNT && context.geometry_previous_count > 0; ++i){
+        vulkan_geometry_data* data = &context.geometries[i];
+        if(data->has_previous && data->ready_generation == data->generation){
+            geometry_range_free(&data->previous);
+            data->has_previous = FALSE;
+            context.geometry_previous_count--;
+        }
+    }
+}
+
+/**
+ * Gets the data a geometry is drawn from: its latest once the graphics queue can read it, until then
+ * the data a reupload replaces. Returns false if there is nothing to draw yet.
+ */
+static b8 geometry_drawn_range(const vulkan_geometry_data* data, vulkan_geometry_range* out_range){
+    if(data->ready_generation == data->generation){
+        out_range->vertex_count = data->vertex_count;
+        out_range->vertex_element_size = data->vertex_element_size;
+        out_range->vertex_buffer_offset = data->vertex_buffer_offset;
+        out_range->index_count = data->index_count;
+        out_range->index_element_size = data->index_element_size;
+        out_range->index_buffer_offset = data->index_buffer_offset;
+        return TRUE;
+    }
+    if(data->has_previous){
+        *out_range = data->previous;
+        return TRUE;
+    }
+    return FALSE;
+}
+
 b8 vulkan_renderer_backend_initialize(renderer_backend* backend, const renderer_backend_config* config, u8* out_window_render_target_count){
     
     // Function pointers
@@ -161,6 +311,33 @@ b8 vulkan_renderer_backend_initialize(renderer_backend* backend, const renderer_
         darray_destroy(available_layers);
 
         TINFO("All required validation layers are present.");
+
+        // The layer's default checks miss hazards between queues, secondary command buffers and
+        // host writes to buffers the GPU is reading, so have it track synchronization as well
+        // where it can.
+        VkValidationFeatureEnableEXT enabled_validation_features[] = {VK_VALIDATION_FEATURE_ENABLE_SYNCHRONIZATION_VALIDATION_EXT};
+        VkValidationFeaturesEXT validation_features = {VK_STRUCTURE_TYPE_VALIDATION_FEATURES_EXT};
+        validation_features.enabledValidationFeatureCount = 1;
+        validation_features.pEnabledValidationFeatures = enabled_validation_features;
+
+        u32 layer_extension_count = 0;
+        VK_CHECK(vkEnumerateInstanceExtensionProperties("VK_LAYER_KHRONOS_validation", &layer_extension_count, 0));
+        VkExtensionProperties* layer_extensions = darray_reserve(VkExtensionProperties, layer_extension_count);
+        VK_CHECK(vkEnumerateInstanceExtensionProperties("VK_LAYER_KHRONOS_validation", &layer_extension_count, layer_extensions));
+        for(u32 i = 0; i < layer_extension_count; ++i){
+            if(strings_equal(layer_extensions[i].extensionName, VK_EXT_VALIDATION_FEATURES_EXTENSION_NAME)){
+                darray_push(required_extensions, &VK_EXT_VALIDATION_FEATURES_EXTENSION_NAME);
+                create_info.enabledExtensionCount = darray_length(required_extensions);
+                create_info.ppEnabledExtensionNames = required_extensions;
+                create_info.pNext = &validation_features;
+                TINFO("Synchronization validation enabled.");
+                break;
+            }
+        }
+        if(!create_info.pNext){
+            TWARN("The validation layer does not support %s. Synchronization validation is disabled.", VK_EXT_VALIDATION_FEATURES_EXTENSION_NAME);
+        }
+        darray_destroy(layer_extensions);
     #endif
 
     create_info.enabledLayerCount = required_validation_layer_count;
@@ -175,6 +352,10 @@ b8 vulkan_renderer_backend_initialize(renderer_backend* backend, const renderer_
     // TODO: implement multi-threading.
     context.multithreading_enabled = FALSE;
 
+    // Render views are recorded into secondary command buffers from per-thread pools, so any
+    // thread can record one.
+    context.parallel_recording_enabled = TRUE;
+
     // Debugger
     #if defined(_DEBUG)
         TDEBUG("Creating vulkan debugger...");
@@ -295,11 +476,14 @@ b8 vulkan_renderer_backend_initialize(renderer_backend* backend, const renderer_
         context.images_in_flight[i] = 0;
     }
 
+    context.deferred_destructions = darray_create(vulkan_deferred_destruction);
+
     create_buffers(&context);
 
     // Mark all geometries as invalid
     for(u32 i = 0; i < VULKAN_MAX_GEOMETRY_COUNT; ++i){
         context.geometries[i].id = INVALID_ID;
+        context.geometries[i].ready_generation = INVALID_ID;
     }
 
     TINFO("Vulkan renderer initialized successfully.");
@@ -311,11 +495,20 @@ void vulkan_renderer_backend_shutdown(renderer_backend* backend){
 
     vkDeviceWaitIdle(context.device.logical_device);
 
+    // Nothing is in flight any more, so whatever is waiting to be destroyed can go.
+    deferred_destructions_process(TRUE);
+    darray_destroy(context.deferred_destructions);
+    context.deferred_destructions = 0;
+
     // Destroy in the opposite order of creation
     
     //Destroy buffers
     vulkan_buffer_destroy(&context, &context.object_vertex_buffer);
     vulkan_buffer_destroy(&context, &context.object_index_buffer);
+    vulkan_buffer_unlock_memory(&context, &context.instance_buffer);
+    context.instance_buffer_memory = 0;
+    vulkan_buffer_destroy(&context, &context.instance_buffer);
+    vulkan_staging_ring_destroy(&context, &context.staging);
 
 
     // Sync objects
@@ -358,6 +551,17 @@ void vulkan_renderer_backend_shutdown(renderer_backend* backend){
     darray_destroy(context.graphics_command_buffers);
     context.graphics_command_buffers = 0;
 
+    // Per-thread command pools, which free their command buffers with them.
+    for(u32 f = 0; f < 2; ++f){
+        for(u32 i = 0; i < VULKAN_MAX_RECORDING_THREADS; ++i){
+            vulkan_thread_command_pool* pool = &context.thread_command_pools[f][i];
+            if(pool->handle){
+                vkDestroyCommandPool(context.device.logical_device, pool->handle, context.allocator);
+                tzero_memory(pool, sizeof(vulkan_thread_command_pool));
+            }
+        }
+    }
+
 
     // Renderpasses
     for(u32 i = 0; i < VULKAN_MAX_REGISTERED_RENDERPASSES; ++i){
@@ -441,6 +645,35 @@ b8 vulkan_renderer_backend_begin_frame(renderer_backend* backend, f32 delta_time
         return FALSE;
     }
 
+    // The GPU is done with this frame's region of the instance buffer, so it can be filled again.
+    tatomic_store_u64(&context.instance_buffer_frame_offset, 0, TATOMIC_RELAXED);
+
+    // So are all frames up to the one last submitted with this fence.
+    if(context.in_flight_fence_frames[context.current_frame] > context.frame_completed_count){
+        context.frame_completed_count = context.in_flight_fence_frames[context.current_frame];
+    }
+
+    // Send off the uploads made since the last frame, and hand back the staging space of those
+    // which have completed. Everything loaded before the first frame, the default textures
+    // among it, is waited for, so that frame has something to fall back on.
+    if(context.frame_submitted_count == 0){
+        vulkan_staging_ring_flush(&context, &context.staging);
+    } else if(!vulkan_staging_ring_submit(&context, &context.staging)){
+        return FALSE;
+    }
+    vulkan_staging_ring_retire(&context, &context.staging);
+
+    deferred_destructions_process(FALSE);
+
+    // It is also done with the secondary command buffers recorded for this frame.
+    for(u32 i = 0; i < VULKAN_MAX_RECORDING_THREADS; ++i){
+        vulkan_thread_command_pool* pool = &context.thread_command_pools[context.current_frame][i];
+        if(pool->handle && pool->used_count){
+            VK_CHECK(vkResetCommandPool(context.device.logical_device, pool->handle, 0));
+            pool->used_count = 0;
+        }
+    }
+
     // Acquire the next image from the swap chain. Pass along the semaphore that should signaled when this completes.
     // This same semaphore will later be waited on by the queue submission to ensure this image is available.
     if(!vulkan_swapchain_acquire_next_image_index(
@@ -454,11 +687,32 @@ b8 vulkan_renderer_backend_begin_frame(renderer_backend* backend, f32 delta_time
         return FALSE;
     }
 
+    // Make sure the previous frame is not using this image (i.e. its fence is being waited on). Its
+    // command buffer is recorded again below, so this cannot wait until the end of the frame: the
+    // swapchain may hand back the same image while the frame which used it is still in flight.
+    if(context.images_in_flight[context.image_index] != VK_NULL_HANDLE){ // was frame
+        VkResult result = vkWaitForFences(context.device.logical_device, 1, &context.images_in_flight[context.image_index], TRUE, UINT64_MAX);
+        if(!vulkan_result_is_success(result)){
+            TFATAL("vk_fence_wait error: %s", vulkan_result_string(result,TRUE));
+        }
+    }
+
     // Begin recording commands.
     vulkan_command_buffer* command_buffer = &context.graphics_command_buffers[context.image_index];
     vulkan_command_buffer_reset(command_buffer);
     vulkan_command_buffer_begin(command_buffer, FALSE, FALSE, FALSE);
 
+    // Take over what the uploads which have completed wrote, so this frame can draw with it.
+    vulkan_staging_ring_acquire(&context, &context.staging, command_buffer);
+    geometry_previous_ranges_release();
+
+    set_dynamic_state(command_buffer);
+
+    return TRUE;
+}
+
+// Sets the viewport and scissor, which command buffers do not inherit from each other.
+static void set_dynamic_state(vulkan_command_buffer* command_buffer){
     // Dynamic state
     VkViewport viewport;
     viewport.x = 0.0f;
@@ -477,9 +731,6 @@ b8 vulkan_renderer_backend_begin_frame(renderer_backend* backend, f32 delta_time
 
     vkCmdSetViewport(command_buffer->handle, 0, 1, &viewport);
     vkCmdSetScissor(command_buffer->handle, 0, 1, &scissor);
-
-
-    return TRUE;
 }
 
 b8 vulkan_renderer_backend_end_frame(renderer_backend* backend, f32 delta_time){
@@ -488,17 +739,14 @@ b8 vulkan_renderer_backend_end_frame(renderer_backend* backend, f32 delta_time){
 
     vulkan_command_buffer_end(command_buffer);
 
-    // Make sure the previous frame is not using this image (i.e. its fence is being waited on)
-    if(context.images_in_flight[context.image_index] != VK_NULL_HANDLE){ // was frame
-        VkResult result = vkWaitForFences(context.device.logical_device, 1, &context.images_in_flight[context.image_index], TRUE, UINT64_MAX);
-        if(!vulkan_result_is_success(result)){
-            TFATAL("vk_fence_wait error: %s", vulkan_result_string(result,TRUE));
-        }
-    }
-
     // Mark the image fence as in-use by this frame.
     context.images_in_flight[context.image_index] = context.in_flight_fences[context.current_frame];
 
+    // The uploads made during the frame go to the transfer queue. The frame does not wait for them.
+    if(!vulkan_staging_ring_submit(&context, &context.staging)){
+        return FALSE;
+    }
+
     // Reset the fence for use on the next frame
     VK_CHECK(vkResetFences(context.device.logical_device, 1, &context.in_flight_fences[context.current_frame]));
 
@@ -535,6 +783,7 @@ b8 vulkan_renderer_backend_end_frame(renderer_backend* backend, f32 delta_time){
         return FALSE;
     }
 
+    context.in_flight_fence_frames[context.current_frame] = ++context.frame_submitted_count;
     vulkan_command_buffer_update_submitted(command_buffer);
     // End queue submission
 
@@ -551,10 +800,75 @@ b8 vulkan_renderer_backend_end_frame(renderer_backend* backend, f32 delta_time){
 }
 
 b8 vulkan_renderer_renderpass_begin(renderpass* pass, render_target* target){
+    if(recording_depth > 0){
+        // Within a recording, the renderpass is only begun in the frame's command buffer when the
+        // recording is executed. Until then its commands go into secondary command buffers.
+        vulkan_recording_frame* frame = &recording_stack[recording_depth - 1];
+        vulkan_recording* recording = frame->recording;
+        if(frame->segment){
+            TERROR("vulkan_renderer_renderpass_begin called within a renderpass of a recording.");
+            return FALSE;
+        }
+        if(recording->segment_count == VULKAN_MAX_RECORDING_SEGMENTS){
+            TERROR("vulkan_renderer_renderpass_begin - A recording can begin at most %u renderpasses.", VULKAN_MAX_RECORDING_SEGMENTS);
+            return FALSE;
+        }
+
+        vulkan_command_buffer* command_buffer = secondary_command_buffer_begin(pass, target);
+        if(!command_buffer){
+            return FALSE;
+        }
+        vulkan_recording_segment* segment = &recording->segments[recording->segment_count];
+        recording->segment_count++;
+        segment->pass = pass;
+        segment->target = target;
+        segment->chunk_base = 0;
+        segment->parts[0] = command_buffer;
+        segment->part_count = 1;
+
+        frame->segment = segment;
+        frame->command_buffer = command_buffer;
+        return TRUE;
+    }
 
     vulkan_command_buffer* command_buffer = &context.graphics_command_buffers[context.image_index];
 
     // Begin the render pass.
+    VkClearValue clear_values[2];
+    VkRenderPassBeginInfo begin_info;
+    renderpass_begin_info_create(pass, target, clear_values, &begin_info);
+    vkCmdBeginRenderPass(command_buffer->handle, &begin_info, VK_SUBPASS_CONTENTS_INLINE);
+    command_buffer->state = COMMAND_BUFFER_STATE_IN_RENDER_PASS;
+
+    return TRUE;
+}
+
+b8 vulkan_renderer_renderpass_end(renderpass* pass){
+    if(recording_depth > 0){
+        vulkan_recording_frame* frame = &recording_stack[recording_depth - 1];
+        if(!frame->segment){
+            TERROR("vulkan_renderer_renderpass_end called outside of a renderpass of a recording.");
+            return FALSE;
+        }
+        if(frame->command_buffer){
+            vulkan_command_buffer_end(frame->command_buffer);
+        }
+        frame->segment = 0;
+        frame->command_buffer = 0;
+        return TRUE;
+    }
+
+    vulkan_command_buffer* command_buffer = &context.graphics_command_buffers[context.image_index];
+
+    // End the renderpass
+    vkCmdEndRenderPass(command_buffer->handle);
+    command_buffer->state = COMMAND_BUFFER_STATE_RECORDING;
+
+    return TRUE;
+}
+
+// Fills out the begin info of a renderpass. clear_values must hold 2 values, and outlive the begin info.
+static void renderpass_begin_info_create(renderpass* pass, render_target* target, VkClearValue* clear_values, VkRenderPassBeginInfo* out_begin_info){
     vulkan_renderpass* internal_data = pass->internal_data;
 
     VkRenderPassBeginInfo begin_info = {VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO};
@@ -568,7 +882,6 @@ b8 vulkan_renderer_renderpass_begin(renderpass* pass, render_target* target){
     begin_info.clearValueCount = 0;
     begin_info.pClearValues = 0;
 
-    VkClearValue clear_values[2];
     tzero_memory(clear_values, sizeof(VkClearValue) * 2);
     b8 do_clear_colour = (pass->clear_flags & RENDERPASS_CLEAR_COLOUR_BUFFER_FLAG) != 0;
     if(do_clear_colour){
@@ -590,20 +903,42 @@ b8 vulkan_renderer_renderpass_begin(renderpass* pass, render_target* target){
     }
 
     begin_info.pClearValues = begin_info.clearValueCount > 0 ? clear_values : 0;
-    vkCmdBeginRenderPass(command_buffer->handle, &begin_info, VK_SUBPASS_CONTENTS_INLINE);
-    command_buffer->state = COMMAND_BUFFER_STATE_IN_RENDER_PASS;
-
-    return TRUE;
+    *out_begin_info = begin_info;
 }
 
-b8 vulkan_renderer_renderpass_end(renderpass* pass){
-    vulkan_command_buffer* command_buffer = &context.graphics_command_buffers[context.image_index];
+// Hands out a secondary command buffer from the calling thread's pool for this frame, and begins
+// it continuing the given renderpass.
+static vulkan_command_buffer* secondary_command_buffer_begin(renderpass* pass, render_target* target){
+    u32 slot = job_system_thread_slot();
+    if(slot >= VULKAN_MAX_RECORDING_THREADS){
+        TERROR("secondary_command_buffer_begin - At most %u threads can record.", VULKAN_MAX_RECORDING_THREADS);
+        return 0;
+    }
 
-    // End the renderpass
-    vkCmdEndRenderPass(command_buffer->handle);
-    command_buffer->state = COMMAND_BUFFER_STATE_RECORDING;
+    // Only this thread ever touches its pool, so none of this needs a lock.
+    vulkan_thread_command_pool* pool = &context.thread_command_pools[context.current_frame][slot];
+    if(!pool->handle){
+        VkCommandPoolCreateInfo pool_create_info = {VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO};
+        pool_create_info.queueFamilyIndex = context.device.graphics_queue_index;
+        pool_create_info.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+        VK_CHECK(vkCreateCommandPool(context.device.logical_device, &pool_create_info, context.allocator, &pool->handle));
+    }
+    if(pool->used_count == VULKAN_MAX_THREAD_COMMAND_BUFFERS){
+        TERROR("secondary_command_buffer_begin - A thread can record at most %u command buffers per frame.", VULKAN_MAX_THREAD_COMMAND_BUFFERS);
+        return 0;
+    }
 
-    return TRUE;
+    vulkan_command_buffer* command_buffer = &pool->buffers[pool->used_count];
+    if(pool->used_count == pool->allocated_count){
+        vulkan_command_buffer_allocate(&context, pool->handle, FALSE, command_buffer);
+        pool->allocated_count++;
+    }
+    pool->used_count++;
+
+    vulkan_renderpass* internal_data = pass->internal_data;
+    vulkan_command_buffer_begin_secondary(command_buffer, internal_data->handle, target->internal_framebuffer);
+    set_dynamic_state(command_buffer);
+    return command_buffer;
 }
 
 renderpass* vulkan_renderer_renderpass_get(const char* name){
@@ -709,6 +1044,7 @@ b8 recreate_swapchain(renderer_backend* backend){
 
     // Wait for any operations to complete.
     vkDeviceWaitIdle(context.device.logical_device);
+    context.frame_completed_count = context.frame_submitted_count;
 
     // Clear these out just in case.
     for(u32 i = 0; i < context.swapchain.image_count; ++i){
@@ -785,6 +1121,29 @@ b8 create_buffers(vulkan_context* context){
         return FALSE;
     }
 
+    // Instance buffer. Written by the CPU every frame, so kept host visible and mapped.
+    context->instance_buffer_frame_size = sizeof(mat4) * VULKAN_MAX_INSTANCE_COUNT;
+    context->instance_buffer_frame_offset = 0;
+    if(!vulkan_buffer_create(
+        context,
+        context->instance_buffer_frame_size * context->swapchain.max_frames_in_flight,
+        VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        TRUE,
+        FALSE,
+        &context->instance_buffer
+    )){
+        TERROR("Error creating instance buffer.");
+        return FALSE;
+    }
+    context->instance_buffer_memory = vulkan_buffer_lock_memory(context, &context->instance_buffer, 0, VK_WHOLE_SIZE, 0);
+
+    // Staging ring, which all geometry and texture data is uploaded through.
+    if(!vulkan_staging_ring_create(context, VULKAN_STAGING_RING_SIZE, &context->staging)){
+        TERROR("Error creating staging ring.");
+        return FALSE;
+    }
+
 
     return TRUE;
 }
@@ -823,11 +1182,11 @@ void vulkan_backend_texture_create(const u8* pixels, texture* t){
 }
 
 void vulkan_backend_texture_destroy(struct texture* texture){
-    vkDeviceWaitIdle(context.device.logical_device);
-
     vulkan_image* image = (vulkan_image*)texture->internal_data;
+
     if(image){
-        vulkan_image_destroy(&context, image);
+        // Frames in flight and uploads may still use the image, so it goes once they are done.
+        image_destroy_deferred(image);
         tzero_memory(image, sizeof(vulkan_image));
 
         tfree(texture->internal_data, sizeof(vulkan_image), MEMORY_TAG_TEXTURE);
@@ -881,7 +1240,9 @@ void vulkan_renderer_texture_resize(texture* t, u32 new_width, u32 new_height){
         // Data is not preserved becasue there's no reliable way to map the old data to the new
         // since the amount of data differs.
         vulkan_image* image = (vulkan_image*)t->internal_data;
-        vulkan_image_destroy(&context, image);
+
+        // Frames in flight and uploads may still use the old image, so it goes once they are done.
+        image_destroy_deferred(image);
 
         VkFormat image_format = channel_count_to_format(t->channel_count, VK_FORMAT_R8G8B8A8_UNORM);
         //TODO: Lots of assumptions here, different texture types will require
@@ -900,57 +1261,89 @@ void vulkan_renderer_texture_resize(texture* t, u32 new_width, u32 new_height){
             image
         );
 
+        // Nothing is being uploaded to the new image.
+        image->ready_generation = image->upload_generation;
+
         t->generation++;
     }
 }
 
 void vulkan_renderer_texture_write_data(texture* t, u32 offset, u32 size, const u8* pixels){
     vulkan_image* image = (vulkan_image*)t->internal_data;
-    VkDeviceSize image_size = t->width * t->height * t->channel_count * (t->type == TEXTURE_TYPE_CUBE ? 6 : 1);
+    u32 layer_count = t->type == TEXTURE_TYPE_CUBE ? 6 : 1;
+    u64 row_size = (u64)t->width * t->channel_count;
+    u64 layer_size = row_size * t->height;
 
     VkFormat image_format = channel_count_to_format(t->channel_count, VK_FORMAT_R8G8B8A8_UNORM);
 
-    // Create a staging bugger and load data into it;
-    VkBufferUsageFlags usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
-    VkMemoryPropertyFlags memory_prop_flags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
-    vulkan_buffer staging;
-    vulkan_buffer_create(&context, image_size, usage, memory_prop_flags, TRUE, FALSE, &staging);
+    // Layers too large to stage whole are copied a chunk of rows at a time.
+    u64 alignment = t->channel_count == 3 ? VULKAN_UPLOAD_ALIGNMENT * 3 : VULKAN_UPLOAD_ALIGNMENT;
+    u32 rows_per_chunk = (u32)(VULKAN_MAX_UPLOAD_CHUNK_SIZE / row_size);
+    if(rows_per_chunk == 0){
+        TERROR("vulkan_renderer_texture_write_data: rows of %llu bytes are too large to upload.", row_size);
+        return;
+    }
+    if(rows_per_chunk > t->height){
+        rows_per_chunk = t->height;
+    }
 
-    vulkan_buffer_load_data(&context, &staging, 0, image_size, 0, pixels);
+    // Frames in flight may still be sampling data written before. Rather than wait for them, the
+    // new data goes to a new image, and the old one is destroyed once they are done.
+    if(image->upload_generation > 0){
+        image_destroy_deferred(image);
+        vulkan_image_create(
+            &context,
+            t->type,
+            t->width,
+            t->height,
+            image_format,
+            VK_IMAGE_TILING_OPTIMAL,
+            VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+            TRUE,
+            VK_IMAGE_ASPECT_COLOR_BIT,
+            image
+        );
+    }
 
-    vulkan_command_buffer temp_buffer;
-    VkCommandPool pool = context.device.graphics_command_pool;
-    VkQueue queue = context.device.graphics_queue;
-    vulkan_command_buffer_allocate_and_begin_single_use(&context, pool, &temp_buffer);
+    // The copies are recorded into the batch of uploads, which runs on the transfer queue
+    // alongside the frames. Staging the first chunk starts the batch if needed.
+    u64 staging_offset;
+    vulkan_command_buffer* command_buffer;
+    if(!vulkan_staging_ring_upload(&context, &context.staging, row_size * rows_per_chunk, alignment, pixels, &staging_offset, &command_buffer)){
+        TERROR("vulkan_renderer_texture_write_data failed to stage the data!");
+        return;
+    }
 
     // Transition the layout from whatever it is currently to optimal for recieving data.
     vulkan_image_transition_layout(
         &context,
         t->type,
-        &temp_buffer,
+        command_buffer,
         image,
         image_format,
         VK_IMAGE_LAYOUT_UNDEFINED,
         VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL
     );
 
-    // Copy the data from the buffer.
-    vulkan_image_copy_from_buffer(&context, t->type, image, staging.handle, &temp_buffer);
-
-    // Transition from optimal for data reciept to shader-read-only optimal layout.
-    vulkan_image_transition_layout(
-        &context,
-        t->type,
-        &temp_buffer,
-        image,
-        image_format,
-        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
-    );
-
-    vulkan_command_buffer_end_single_use(&context, pool, &temp_buffer, queue);
+    for(u32 layer = 0; layer < layer_count; ++layer){
+        for(u32 row = 0; row < t->height; row += rows_per_chunk){
+            u32 row_count = t->height - row < rows_per_chunk ? t->height - row : rows_per_chunk;
+            if(layer != 0 || row != 0){
+                // Staging may submit the batch if the ring is full, so carry on in whichever is current.
+                if(!vulkan_staging_ring_upload(&context, &context.staging, row_size * row_count, alignment, pixels + layer * layer_size + row * row_size, &staging_offset, &command_buffer)){
+                    TERROR("vulkan_renderer_texture_write_data failed to stage the data!");
+                    return;
+                }
+            }
+            vulkan_image_copy_from_buffer(&context, image, context.staging.buffer.handle, staging_offset, layer, row, row_count, command_buffer);
+        }
+    }
 
-    vulkan_buffer_destroy(&context, &staging);
+    // The transition to the shader-read-only optimal layout is made as the graphics queue takes
+    // the image over. Until then, the image is not ready and the default texture stands in.
+    image->upload_generation++;
+    vulkan_staging_ring_hand_off_image(&context.staging, image, layer_count);
 
     t->generation++;
 }
@@ -963,7 +1356,8 @@ b8 vulkan_renderer_create_geometry(geometry* geometry, u32 vertex_size, u32 vert
 
     // Check if this is a re-upload. If it is, need to free old data afterward.
     b8 is_reupload = geometry->internal_id != INVALID_ID;
-    vulkan_geometry_data old_range;
+    vulkan_geometry_range old_range;
+    b8 old_range_ready = FALSE;
 
     vulkan_geometry_data* internal_data = 0;
     if(is_reupload){
@@ -976,6 +1370,7 @@ b8 vulkan_renderer_create_geometry(geometry* geometry, u32 vertex_size, u32 vert
         old_range.vertex_buffer_offset = internal_data->vertex_buffer_offset;
         old_range.vertex_count = internal_data->vertex_count;
         old_range.vertex_element_size = internal_data->vertex_element_size;
+        old_range_ready = internal_data->ready_generation == internal_data->generation;
     } else {
         for(u32 i = 0; i < VULKAN_MAX_GEOMETRY_COUNT; ++i){
             if(context.geometries[i].id == INVALID_ID){
@@ -993,8 +1388,9 @@ b8 vulkan_renderer_create_geometry(geometry* geometry, u32 vertex_size, u32 vert
         return FALSE;
     }
 
-    VkCommandPool pool = context.device.graphics_command_pool;
-    VkQueue queue = context.device.graphics_queue;
+    // The geometry is drawn once the uploads of this generation are done.
+    u32 generation = internal_data->generation == INVALID_ID ? 0 : internal_data->generation + 1;
+    b8 has_indices = index_count && indices;
 
     // Vertex data.
     internal_data->vertex_count = vertex_count;
@@ -1002,13 +1398,12 @@ b8 vulkan_renderer_create_geometry(geometry* geometry, u32 vertex_size, u32 vert
     u32 total_size = vertex_count * vertex_size;
     if(!upload_data_range(
         &context,
-        pool,
-        0,
-        queue,
         &context.object_vertex_buffer,
         &internal_data->vertex_buffer_offset,
         total_size,
-        vertices
+        vertices,
+        has_indices ? 0 : &internal_data->ready_generation,
+        generation
     )){
         TERROR("vulkan_renderer_create_geometry failed to upload to the vertex buffer!");
         return FALSE;
@@ -1016,38 +1411,35 @@ b8 vulkan_renderer_create_geometry(geometry* geometry, u32 vertex_size, u32 vert
 
 
     // Index data, if applicable
-    if(index_count && indices){
+    if(has_indices){
         internal_data->index_count = index_count;
         internal_data->index_element_size = sizeof(u32);
         total_size = index_count * index_size;
         if(!upload_data_range(
             &context,
-            pool,
-            0,
-            queue,
             &context.object_index_buffer,
             &internal_data->index_buffer_offset,
             total_size,
-            indices
+            indices,
+            &internal_data->ready_generation,
+            generation
         )){
             TERROR("vulkan_renderer_create_geometry failed to upload to the index buffer!");
             return FALSE;
         }
     }
 
-    if(internal_data->generation == INVALID_ID){
-        internal_data->generation = 0;
-    } else {
-        internal_data->generation++;
-    }
+    internal_data->generation = generation;
 
     if(is_reupload){
-        // Free vertex data
-        free_data_range(&context.object_vertex_buffer, old_range.vertex_buffer_offset, old_range.vertex_element_size * old_range.vertex_count);
-
-        // Free index data, if applicable
-        if(old_range.index_element_size > 0){
-            free_data_range(&context.object_index_buffer, old_range.index_buffer_offset, old_range.index_element_size * old_range.index_count);
+        if(old_range_ready){
+            // Frames keep drawing the old data until the new data is ready, and it is freed then.
+            internal_data->previous = old_range;
+            internal_data->has_previous = TRUE;
+            context.geometry_previous_count++;
+        } else {
+            // The old data was never drawn, so it can go now. Whatever it replaced is still drawn instead.
+            geometry_range_free(&old_range);
         }
     }
 
@@ -1056,8 +1448,14 @@ b8 vulkan_renderer_create_geometry(geometry* geometry, u32 vertex_size, u32 vert
 
 void vulkan_renderer_destroy_geometry(geometry* geometry){
     if(geometry && geometry->internal_id != INVALID_ID){
-        vkDeviceWaitIdle(context.device.logical_device);
         vulkan_geometry_data* internal_data = &context.geometries[geometry->internal_id];
+        vulkan_staging_ring_forget(&context.staging, &internal_data->ready_generation);
+
+        // Free the data a reupload was to replace, if it is still held.
+        if(internal_data->has_previous){
+            geometry_range_free(&internal_data->previous);
+            context.geometry_previous_count--;
+        }
 
         // Free vertex data
         free_data_range(&context.object_vertex_buffer, internal_data->vertex_buffer_offset, internal_data->vertex_element_size * internal_data->vertex_count);
@@ -1071,38 +1469,96 @@ void vulkan_renderer_destroy_geometry(geometry* geometry){
         tzero_memory(internal_data, sizeof(vulkan_geometry_data));
         internal_data->id = INVALID_ID;
         internal_data->generation = INVALID_ID;
+        internal_data->ready_generation = INVALID_ID;
     }
 }
 
-void vulkan_backend_draw_geometry(geometry_render_data* data){
+void vulkan_backend_draw_geometry(geometry_render_data* data, b8 bind_buffers){
 
-    // Ignore non-uploaded geometries.
+    // Ignore non-uploaded geometries, and those whose first upload is still in progress.
     if(data->geometry && data->geometry->internal_id == INVALID_ID){
         return;
     }
 
-    vulkan_geometry_data* buffer_data = &context.geometries[data->geometry->internal_id];
-    vulkan_command_buffer* command_buffer = &context.graphics_command_buffers[context.image_index];
+    vulkan_geometry_range range;
+    if(!geometry_drawn_range(&context.geometries[data->geometry->internal_id], &range)){
+        return;
+    }
 
-   
+    vulkan_command_buffer* command_buffer = current_command_buffer();
 
-    // Bind vertex buffer at offest.
-    VkDeviceSize offset[1] = {buffer_data->vertex_buffer_offset};
-    vkCmdBindVertexBuffers(command_buffer->handle, 0, 1, &context.object_vertex_buffer.handle, (VkDeviceSize*)offset);
+    if(bind_buffers){
+        // Bind vertex buffer at offest.
+        VkDeviceSize offset[1] = {range.vertex_buffer_offset};
+        vkCmdBindVertexBuffers(command_buffer->handle, 0, 1, &context.object_vertex_buffer.handle, (VkDeviceSize*)offset);
 
-    // Draw indexed or non-indexed.
-    if(buffer_data->index_count > 0){
-        // Bind index buffer at offset.
-        vkCmdBindIndexBuffer(command_buffer->handle, context.object_index_buffer.handle, buffer_data->index_buffer_offset, VK_INDEX_TYPE_UINT32);
+        if(range.index_count > 0){
+            // Bind index buffer at offset.
+            vkCmdBindIndexBuffer(command_buffer->handle, context.object_index_buffer.handle, range.index_buffer_offset, VK_INDEX_TYPE_UINT32);
+        }
+    }
 
+    // Draw indexed or non-indexed.
+    if(range.index_count > 0){
         // Issue the draw.
-        vkCmdDrawIndexed(command_buffer->handle, buffer_data->index_count, 1, 0, 0, 0);
+        vkCmdDrawIndexed(command_buffer->handle, range.index_count, 1, 0, 0, 0);
     } else {
-        vkCmdDraw(command_buffer->handle, buffer_data->vertex_count, 1, 0, 0);
+        vkCmdDraw(command_buffer->handle, range.vertex_count, 1, 0, 0);
     }
 
 }
 
+void vulkan_backend_draw_geometry_instanced(geometry_render_data* data, u32 instance_count, b8 bind_buffers){
+
+    // Ignore non-uploaded geometries, and those whose first upload is still in progress.
+    if(!instance_count || (data->geometry && data->geometry->internal_id == INVALID_ID)){
+        return;
+    }
+    vulkan_geometry_range range;
+    if(!geometry_drawn_range(&context.geometries[data->geometry->internal_id], &range)){
+        return;
+    }
+
+    // Write the model matrices to this frame's region of the instance buffer. Space is claimed
+    // atomically, since views and chunks may be recorded on several threads at once.
+    u64 size = sizeof(mat4) * instance_count;
+    u64 frame_offset = tatomic_fetch_add_u64(&context.instance_buffer_frame_offset, size, TATOMIC_RELAXED);
+    if(frame_offset + size > context.instance_buffer_frame_size){
+        TERROR("vulkan_backend_draw_geometry_instanced: Out of instance buffer space for this frame (%u instances max). Skipping draw.", VULKAN_MAX_INSTANCE_COUNT);
+        return;
+    }
+    u64 instance_offset = context.current_frame * context.instance_buffer_frame_size + frame_offset;
+    mat4* instance_data = (mat4*)(context.instance_buffer_memory + instance_offset);
+    for(u32 i = 0; i < instance_count; ++i){
+        instance_data[i] = data[i].model;
+    }
+
+    vulkan_command_buffer* command_buffer = current_command_buffer();
+
+    if(bind_buffers){
+        // Bind vertex buffer at offest.
+        VkDeviceSize offset[1] = {range.vertex_buffer_offset};
+        vkCmdBindVertexBuffers(command_buffer->handle, 0, 1, &context.object_vertex_buffer.handle, (VkDeviceSize*)offset);
+
+        if(range.index_count > 0){
+            // Bind index buffer at offset.
+            vkCmdBindIndexBuffer(command_buffer->handle, context.object_index_buffer.handle, range.index_buffer_offset, VK_INDEX_TYPE_UINT32);
+        }
+    }
+
+    // The instance data moves with every draw, so it is always bound.
+    VkDeviceSize offset[1] = {instance_offset};
+    vkCmdBindVertexBuffers(command_buffer->handle, 1, 1, &context.instance_buffer.handle, (VkDeviceSize*)offset);
+
+    // Draw indexed or non-indexed.
+    if(range.index_count > 0){
+        // Issue the draw.
+        vkCmdDrawIndexed(command_buffer->handle, range.index_count, instance_count, 0, 0, 0);
+    } else {
+        vkCmdDraw(command_buffer->handle, range.vertex_count, instance_count, 0, 0);
+    }
+}
+
 // The index of the global descriptor set.
 const u32 DESC_SET_INDEX_GLOBAL = 0;
 
@@ -1375,21 +1831,38 @@ b8 vulkan_renderer_shader_initialize(shader* shader){
         types = t;
     }
 
-    // Process attributes
+    // Process attributes. Per-vertex attributes come from binding 0 and per-instance ones from
+    // binding 1, each packed in the order they were declared. Locations run across both.
     u32 attribute_count = darray_length(shader->attributes);
-    u32 offset = 0;
+    u32 vertex_offset = 0;
+    u32 instance_offset = 0;
+    s->config.attribute_count = 0;
     for(u32 i = 0; i < attribute_count; ++i){
-        // Setup the new attribute.
-        VkVertexInputAttributeDescription attribute;
-        attribute.location = i;
-        attribute.binding = 0;
-        attribute.offset = offset;
-        attribute.format = types[shader->attributes[i].type];
+        b8 per_instance = shader->attributes[i].rate == SHADER_ATTRIBUTE_RATE_INSTANCE;
+        u32* offset = per_instance ? &instance_offset : &vertex_offset;
+
+        // A mat4 takes up four locations, one per column.
+        b8 is_matrix = shader->attributes[i].type == SHADER_ATTRIB_TYPE_MATRIX_4;
+        u32 location_count = is_matrix ? 4 : 1;
+        if(s->config.attribute_count + location_count > VULKAN_SHADER_MAX_ATTRIBUTES){
+            TERROR("vulkan_shader_initialize: Shader '%s' uses more than %u attribute locations.", shader->name, VULKAN_SHADER_MAX_ATTRIBUTES);
+            return FALSE;
+        }
 
-        // Push into the config's attribute collection and add to the stride.
-        s->config.attributes[i] = attribute;
+        for(u32 l = 0; l < location_count; ++l){
+            // Setup the new attribute.
+            VkVertexInputAttributeDescription attribute;
+            attribute.location = s->config.attribute_count;
+            attribute.binding = per_instance ? 1 : 0;
+            attribute.offset = *offset;
+            attribute.format = is_matrix ? VK_FORMAT_R32G32B32A32_SFLOAT : types[shader->attributes[i].type];
 
-        offset += shader->attributes[i].size;
+            // Push into the config's attribute collection and add to the stride.
+            s->config.attributes[s->config.attribute_count] = attribute;
+            s->config.attribute_count++;
+
+            *offset += shader->attributes[i].size / location_count;
+        }
     }
 
     // Descriptor pool.
@@ -1446,7 +1919,8 @@ b8 vulkan_renderer_shader_initialize(shader* shader){
         &context,
         s->renderpass,
         shader->attribute_stride,
-        darray_length(shader->attributes),
+        shader->instance_attribute_stride,
+        s->config.attribute_count,
         s->config.attributes,
         s->config.descriptor_set_count,
         s->descriptor_set_layouts,
@@ -1527,7 +2001,7 @@ b8 vulkan_renderer_shader_initialize(shader* shader){
 
 b8 vulkan_renderer_shader_use(shader* shader){
     vulkan_shader* s = shader->internal_data;
-    vulkan_pipeline_bind(&context.graphics_command_buffers[context.image_index], VK_PIPELINE_BIND_POINT_GRAPHICS, &s->pipeline);
+    vulkan_pipeline_bind(current_command_buffer(), VK_PIPELINE_BIND_POINT_GRAPHICS, &s->pipeline);
     return TRUE;
 }
 
@@ -1557,9 +2031,15 @@ b8 vulkan_renderer_shader_bind_instance(shader* s, u32 instance_id){
 b8 vulkan_renderer_shader_apply_globals(shader* s){
     u32 image_index = context.image_index;
     vulkan_shader* internal = s->internal_data;
-    VkCommandBuffer command_buffer = context.graphics_command_buffers[image_index].handle;
+    VkCommandBuffer command_buffer = current_command_buffer()->handle;
     VkDescriptorSet global_descriptor = internal->global_descriptor_sets[image_index];
 
+    // The set always points at the same part of the uniform buffer, so only write it once.
+    if(internal->global_descriptor_set_written[image_index]){
+        vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, internal->pipeline.pipeline_layout, 0, 1, &global_descriptor, 0, 0);
+        return TRUE;
+    }
+
     // Apply UBO first
     VkDescriptorBufferInfo buffer_info;
     buffer_info.buffer = internal->uniform_buffer.handle;
@@ -1589,6 +2069,7 @@ b8 vulkan_renderer_shader_apply_globals(shader* s){
     }
 
     vkUpdateDescriptorSets(context.device.logical_device, global_set_binding_count, descriptor_writes, 0, 0);
+    internal->global_descriptor_set_written[image_index] = TRUE;
 
     // Bind the global descriptor set to be updated.
     vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, internal->pipeline.pipeline_layout, 0, 1, &global_descriptor, 0, 0);
@@ -1603,7 +2084,7 @@ b8 vulkan_renderer_shader_apply_instance(shader* s, b8 needs_update){
     }
 
     u32 image_index = context.image_index;
-    VkCommandBuffer command_buffer = context.graphics_command_buffers[image_index].handle;
+    VkCommandBuffer command_buffer = current_command_buffer()->handle;
 
     // Obain instance data.
     vulkan_shader_instance_state* object_state = &internal->instance_states[s->bound_instance_id];
@@ -1656,8 +2137,9 @@ b8 vulkan_renderer_shader_apply_instance(shader* s, b8 needs_update){
                 texture_map* map = internal->instance_states[s->bound_instance_id].instance_texture_maps[i];
                 texture* t = map->texture;
 
-                // Ensure the texture is valid.
-                if (t->generation == INVALID_ID){
+                // Ensure the texture is valid, and that its latest data has been uploaded.
+                vulkan_image* texture_image = (vulkan_image*)t->internal_data;
+                if (t->generation == INVALID_ID || (texture_image && texture_image->ready_generation != texture_image->upload_generation)){
                     switch(map->use){
                         case TEXTURE_USE_MAP_DIFFUSE:
                         t = texture_system_get_default_diffuse_texture();
@@ -1713,6 +2195,19 @@ b8 vulkan_renderer_shader_apply_instance(shader* s, b8 needs_update){
     return TRUE;
 }
 
+b8 vulkan_renderer_shader_bind_instance_resources(shader* s, u32 instance_id){
+    vulkan_shader* internal = s->internal_data;
+    if(internal->instance_uniform_count < 1 && internal->instance_uniform_sampler_count < 1){
+        TERROR("This shader does not use instances.");
+        return FALSE;
+    }
+
+    // Only binds, so the descriptor set must have been written by vulkan_renderer_shader_apply_instance already.
+    VkDescriptorSet object_descriptor_set = internal->instance_states[instance_id].descriptor_set_state.descriptor_sets[context.image_index];
+    vkCmdBindDescriptorSets(current_command_buffer()->handle, VK_PIPELINE_BIND_POINT_GRAPHICS, internal->pipeline.pipeline_layout, 1, 1, &object_descriptor_set, 0, 0);
+    return TRUE;
+}
+
 VkSamplerAddressMode convert_repeat_type(const char* axis, texture_repeat repeat){
     switch (repeat)
     {
@@ -1782,7 +2277,11 @@ b8 vulkan_renderer_texture_map_acquire_resources(texture_map* map){
 
 void vulkan_renderer_texture_map_release_resources(texture_map* map){
     if(map){
-        vkDestroySampler(context.device.logical_device, map->internal_data, context.allocator);
+        // Materials are released while frames in flight may still be sampling through the map.
+        vulkan_deferred_destruction destruction = {0};
+        destruction.type = VULKAN_DEFERRED_DESTRUCTION_SAMPLER;
+        destruction.sampler = (VkSampler)map->internal_data;
+        deferred_destruction_push(&destruction);
         map->internal_data = 0;
     }
 }
@@ -1910,7 +2409,7 @@ b8 vulkan_renderer_set_uniform(shader* s, shader_uniform* uniform, const void* v
     } else {
         if(uniform->scope == SHADER_SCOPE_LOCAL){
             // Is local, using push constants. Do this immediately.
-            VkCommandBuffer command_buffer = context.graphics_command_buffers[context.image_index].handle;
+            VkCommandBuffer command_buffer = current_command_buffer()->handle;
             vkCmdPushConstants(command_buffer, internal->pipeline.pipeline_layout, VK_SHADER_STAGE_VERTEX_BIT |VK_SHADER_STAGE_FRAGMENT_BIT, uniform->offset, uniform->size, value);
         } else {
             // Map the appropriate memory location and copy data over.
@@ -2138,4 +2637,186 @@ u8 vulkan_renderer_window_attachment_index_get(){
 
 b8 vulkan_renderer_is_multithreaded(){
     return context.multithreading_enabled;
-}
\ No newline at end of file
+}
+
+b8 vulkan_renderer_supports_parallel_recording(){
+    return context.parallel_recording_enabled && job_system_thread_slot_count() <= VULKAN_MAX_RECORDING_THREADS;
+}
+
+b8 vulkan_renderer_recording_begin(u32 index){
+    if(index >= VULKAN_MAX_RECORDINGS){
+        TERROR("vulkan_renderer_recording_begin - Recording index %u is out of range (%u max).", index, VULKAN_MAX_RECORDINGS);
+        return FALSE;
+    }
+    if(recording_depth == VULKAN_MAX_RECORDING_DEPTH){
+        TERROR("vulkan_renderer_recording_begin - Recordings nested too deeply.");
+        return FALSE;
+    }
+
+    vulkan_recording* recording = &context.recordings[index];
+    recording->segment_count = 0;
+
+    vulkan_recording_frame* frame = &recording_stack[recording_depth];
+    recording_depth++;
+    frame->recording = recording;
+    frame->segment = 0;
+    frame->command_buffer = 0;
+    return TRUE;
+}
+
+b8 vulkan_renderer_recording_end(){
+    if(recording_depth == 0){
+        TERROR("vulkan_renderer_recording_end called without a recording.");
+        return FALSE;
+    }
+
+    vulkan_recording_frame* frame = &recording_stack[recording_depth - 1];
+    b8 result = TRUE;
+    if(frame->segment){
+        TERROR("vulkan_renderer_recording_end - A renderpass was left open and has been ended.");
+        if(frame->command_buffer){
+            vulkan_command_buffer_end(frame->command_buffer);
+        }
+        result = FALSE;
+    }
+    recording_depth--;
+    return result;
+}
+
+b8 vulkan_renderer_recordings_execute(u32 count){
+    if(count > VULKAN_MAX_RECORDINGS){
+        TERROR("vulkan_renderer_recordings_execute - At most %u recordings can be executed.", VULKAN_MAX_RECORDINGS);
+        return FALSE;
+    }
+
+    // Each renderpass is begun in the frame's command buffer, in order, and its parts executed in order
+    // within it. The order is that of the indices, whichever thread recorded what and when.
+    vulkan_command_buffer* command_buffer = &context.graphics_command_buffers[context.image_index];
+    VkCommandBuffer handles[VULKAN_MAX_SEGMENT_PARTS];
+    for(u32 r = 0; r < count; ++r){
+        vulkan_recording* recording = &context.recordings[r];
+        for(u32 s = 0; s < recording->segment_count; ++s){
+            vulkan_recording_segment* segment = &recording->segments[s];
+
+            VkClearValue clear_values[2];
+            VkRenderPassBeginInfo begin_info;
+            renderpass_begin_info_create(segment->pass, segment->target, clear_values, &begin_info);
+            vkCmdBeginRenderPass(command_buffer->handle, &begin_info, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+
+            u32 handle_count = 0;
+            for(u32 p = 0; p < segment->part_count; ++p){
+                if(segment->parts[p]){
+                    handles[handle_count] = segment->parts[p]->handle;
+                    handle_count++;
+                }
+            }
+            if(handle_count > 0){
+                vkCmdExecuteCommands(command_buffer->handle, handle_count, handles);
+            }
+
+            vkCmdEndRenderPass(command_buffer->handle);
+        }
+        recording->segment_count = 0;
+    }
+
+    return TRUE;
+}
+
+b8 vulkan_renderer_renderpass_chunks_begin(u32 chunk_count){
+    vulkan_recording_frame* frame = recording_depth > 0 ? &recording_stack[recording_depth - 1] : 0;
+    if(!frame || !frame->segment){
+        TERROR("vulkan_renderer_renderpass_chunks_begin requires a renderpass begun within a recording.");
+        return FALSE;
+    }
+
+    // Leave room for the part that follows the chunks.
+    vulkan_recording_segment* segment = frame->segment;
+    if(segment->part_count + chunk_count + 1 > VULKAN_MAX_SEGMENT_PARTS){
+        TERROR("vulkan_renderer_renderpass_chunks_begin - A renderpass can be split into at most %u parts.", VULKAN_MAX_SEGMENT_PARTS);
+        return FALSE;
+    }
+
+    // What was recorded so far runs before the chunks.
+    if(frame->command_buffer){
+        vulkan_command_buffer_end(frame->command_buffer);
+        frame->command_buffer = 0;
+    }
+
+    segment->chunk_base = segment->part_count;
+    for(u32 i = 0; i < chunk_count; ++i){
+        segment->parts[segment->part_count] = 0;
+        segment->part_count++;
+    }
+    return TRUE;
+}
+
+b8 vulkan_renderer_renderpass_chunk_begin(u32 recording_index, u32 chunk_index){
+    if(recording_index >= VULKAN_MAX_RECORDINGS || context.recordings[recording_index].segment_count == 0){
+        TERROR("vulkan_renderer_renderpass_chunk_begin - Recording %u has no renderpass to record into.", recording_index);
+        return FALSE;
+    }
+    if(recording_depth == VULKAN_MAX_RECORDING_DEPTH){
+        TERROR("vulkan_renderer_renderpass_chunk_begin - Recordings nested too deeply.");
+        return FALSE;
+    }
+
+    vulkan_recording* recording = &context.recordings[recording_index];
+    vulkan_recording_segment* segment = &recording->segments[recording->segment_count - 1];
+    u32 part_index = segment->chunk_base + chunk_index;
+    if(part_index >= segment->part_count){
+        TERROR("vulkan_renderer_renderpass_chunk_begin - Chunk %u was not reserved.", chunk_index);
+        return FALSE;
+    }
+
+    vulkan_command_buffer* command_buffer = secondary_command_buffer_begin(segment->pass, segment->target);
+    if(!command_buffer){
+        return FALSE;
+    }
+    // Each chunk has a part of its own, so threads never write the same one.
+    segment->parts[part_index] = command_buffer;
+
+    vulkan_recording_frame* frame = &recording_stack[recording_depth];
+    recording_depth++;
+    frame->recording = recording;
+    frame->segment = segment;
+    frame->command_buffer = command_buffer;
+    return TRUE;
+}
+
+b8 vulkan_renderer_renderpass_chunk_end(){
+    if(recording_depth == 0 || !recording_stack[recording_depth - 1].command_buffer){
+        TERROR("vulkan_renderer_renderpass_chunk_end called without a chunk.");
+        return FALSE;
+    }
+
+    vulkan_command_buffer_end(recording_stack[recording_depth - 1].command_buffer);
+    recording_depth--;
+    return TRUE;
+}
+
+b8 vulkan_renderer_renderpass_chunks_end(){
+    vulkan_recording_frame* frame = recording_depth > 0 ? &recording_stack[recording_depth - 1] : 0;
+    if(!frame || !frame->segment || frame->command_buffer){
+        TERROR("vulkan_renderer_renderpass_chunks_end called without chunks.");
+        return FALSE;
+    }
+
+    // Whatever comes next runs after the chunks, in a part of its own.
+    vulkan_recording_segment* segment = frame->segment;
+    vulkan_command_buffer* command_buffer = secondary_command_buffer_begin(segment->pass, segment->target);
+    if(!command_buffer){
+        return FALSE;
+    }
+    segment->parts[segment->part_count] = command_buffer;
+    segment->part_count++;
+    frame->command_buffer = command_buffer;
+    return TRUE;
+}
+
+b8 vulkan_renderer_get_upload_stats(renderer_upload_stats* out_stats){
+    if(!out_stats){
+        return FALSE;
+    }
+    *out_stats = context.staging.stats;
+    return TRUE;
+}
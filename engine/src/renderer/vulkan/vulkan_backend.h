@@ -18,7 +18,8 @@ b8 vulkan_renderer_renderpass_begin(renderpass* pass, render_target* target);
 b8 vulkan_renderer_renderpass_end(renderpass* pass);
 renderpass* vulkan_renderer_renderpass_get(const char* name);
 
-void vulkan_backend_draw_geometry(geometry_render_data* data);
+void vulkan_backend_draw_geometry(geometry_render_data* data, b8 bind_buffers);
+void vulkan_backend_draw_geometry_instanced(geometry_render_data* data, u32 instance_count, b8 bind_buffers);
 
 void vulkan_backend_texture_create(const u8* pixels, texture* texture);
 void vulkan_backend_texture_destroy(struct texture* texture);
@@ -66,6 +67,7 @@ b8 vulkan_renderer_shader_bind_globals(struct shader* shader);
 b8 vulkan_renderer_shader_bind_instance(struct shader* shader, u32 instance_id);
 b8 vulkan_renderer_shader_apply_globals(struct shader* shader);
 b8 vulkan_renderer_shader_apply_instance(struct shader* shader, b8 needs_update);
+b8 vulkan_renderer_shader_bind_instance_resources(struct shader* shader, u32 instance_id);
 b8 vulkan_renderer_shader_acquire_instance_resources(struct shader* shader, texture_map** maps, u32* instance_id);
 b8 vulkan_renderer_shader_release_instance_resources(struct shader* shader, u32 instance_id);
 b8 vulkan_renderer_set_uniform(struct shader* frontend_shader, struct shader_uniform* uniform, const void* value);
@@ -83,4 +85,15 @@ texture* vulkan_renderer_window_attachment_get(u8 index);
 texture* vulkan_renderer_depth_attachment_get();
 u8 vulkan_renderer_window_attachment_index_get();
 
-b8 vulkan_renderer_is_multithreaded();
\ No newline at end of file
+b8 vulkan_renderer_is_multithreaded();
+
+b8 vulkan_renderer_supports_parallel_recording();
+b8 vulkan_renderer_recording_begin(u32 index);
+b8 vulkan_renderer_recording_end();
+b8 vulkan_renderer_recordings_execute(u32 count);
+b8 vulkan_renderer_renderpass_chunks_begin(u32 chunk_count);
+b8 vulkan_renderer_renderpass_chunk_begin(u32 recording_index, u32 chunk_index);
+b8 vulkan_renderer_renderpass_chunk_end();
+b8 vulkan_renderer_renderpass_chunks_end();
+
+b8 vulkan_renderer_get_upload_stats(renderer_upload_stats* out_stats);
\ No newline at end of file
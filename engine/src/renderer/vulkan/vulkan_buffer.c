@@ -122,7 +122,7 @@ b8 vulkan_buffer_resize(
     if(buffer->has_freelist){
         // Resize the freelist first, if used.
         u64 new_memory_requirement = 0;
-        freelist_resize(&buffer->buffer_freelist, &new_memory_requirement, 0, 0, 0);// TODO: REVISIT, maybe is necessary to pass the new_size to calculate the true memory requirement, with 0 only returns the status size
+        freelist_resize(&buffer->buffer_freelist, &new_memory_requirement, 0, new_size, 0);
         void* new_block = tallocate(new_memory_requirement, MEMORY_TAG_RENDERER);
         void* old_block = 0;
         if(!freelist_resize(&buffer->buffer_freelist, &new_memory_requirement, new_block, new_size, &old_block)){
@@ -22,6 +22,16 @@ void vulkan_command_buffer_begin(
     b8 is_simultaneous_use
 );
 
+/**
+ * Begins recording a single-use secondary command buffer that continues the given renderpass,
+ * drawing to the given framebuffer.
+ */
+void vulkan_command_buffer_begin_secondary(
+    vulkan_command_buffer* command_buffer,
+    VkRenderPass renderpass,
+    VkFramebuffer framebuffer
+);
+
 void vulkan_command_buffer_end(vulkan_command_buffer* command_buffer);
 
 void vulkan_command_buffer_update_submitted(vulkan_command_buffer* command_buffer);
@@ -144,6 +144,18 @@ b8 vulkan_device_create(vulkan_context* context){
     );
     TINFO("Graphics command pool created.");
 
+    // Create command pool for transfer queue.
+    pool_create_info.queueFamilyIndex = context->device.transfer_queue_index;
+    VK_CHECK(
+        vkCreateCommandPool(
+            context->device.logical_device,
+            &pool_create_info,
+            context->allocator,
+            &context->device.transfer_command_pool
+        )
+    );
+    TINFO("Transfer command pool created.");
+
     return TRUE;
 }
 
@@ -160,6 +172,11 @@ void vulkan_device_destroy(vulkan_context* context){
         context->device.graphics_command_pool,
         context->allocator
     );
+    vkDestroyCommandPool(
+        context->device.logical_device,
+        context->device.transfer_command_pool,
+        context->allocator
+    );
 
     // Destroy logical device.
     TINFO("Destroying logical device...");
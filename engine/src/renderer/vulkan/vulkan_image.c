@@ -118,8 +118,9 @@ void vulkan_image_transition_layout(
     VkImageMemoryBarrier barrier = {VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER};
     barrier.oldLayout = old_layout;
     barrier.newLayout = new_layout;
-    barrier.srcQueueFamilyIndex = context->device.graphics_queue_index;
-    barrier.dstQueueFamilyIndex = context->device.graphics_queue_index;
+    // Not an ownership transfer. The barrier may be recorded on the transfer queue as well.
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
     barrier.image = image->handle;
     barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
     barrier.subresourceRange.baseMipLevel = 0;
@@ -132,11 +133,11 @@ void vulkan_image_transition_layout(
 
     // Don't care about the old layout - transition to optimal layout (for the underlying implementation).
     if(old_layout == VK_IMAGE_LAYOUT_UNDEFINED && new_layout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL){
-        barrier.srcAccessMask = 0;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
         barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
 
-        // Don't care what stage the pipeline is in at the start.
-        source_stage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+        // Uploads are batched, so wait for any earlier copy, which may have been to this image.
+        source_stage = VK_PIPELINE_STAGE_TRANSFER_BIT;
 
         // Used for copying
         dest_stage = VK_PIPELINE_STAGE_TRANSFER_BIT;
@@ -168,25 +169,29 @@ void vulkan_image_transition_layout(
 
 void vulkan_image_copy_from_buffer(
     vulkan_context* context,
-    texture_type type,
     vulkan_image* image,
     VkBuffer buffer,
+    u64 buffer_offset,
+    u32 layer,
+    u32 first_row,
+    u32 row_count,
     vulkan_command_buffer* command_buffer
 ){
     // Region to copy
     VkBufferImageCopy region;
     tzero_memory(&region, sizeof(VkBufferImageCopy));
-    region.bufferOffset = 0;
+    region.bufferOffset = buffer_offset;
     region.bufferRowLength = 0;
     region.bufferImageHeight = 0;
 
     region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
     region.imageSubresource.mipLevel = 0;
-    region.imageSubresource.baseArrayLayer = 0;
-    region.imageSubresource.layerCount = type == TEXTURE_TYPE_CUBE ? 6 : 1;
+    region.imageSubresource.baseArrayLayer = layer;
+    region.imageSubresource.layerCount = 1;
 
+    region.imageOffset.y = first_row;
     region.imageExtent.width = image->width;
-    region.imageExtent.height = image->height;
+    region.imageExtent.height = row_count;
     region.imageExtent.depth = 1;
 
     vkCmdCopyBufferToImage(
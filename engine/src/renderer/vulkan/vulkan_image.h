@@ -38,16 +38,23 @@ void vulkan_image_transition_layout(
 );
 
 /**
- * Copies data in buffer to provided image.
+ * Copies rows of one layer of the provided image from a buffer, where they are tightly packed.
  * @param context The Vulkan context.
  * @param image The image to copy the buffer's data to.
  * @param buffer The buffer whose data will be copied.
+ * @param buffer_offset The offset of the first row in the buffer.
+ * @param layer The layer of the image to copy to.
+ * @param first_row The first row of the layer to copy to.
+ * @param row_count The number of rows to copy.
  */
 void vulkan_image_copy_from_buffer(
     vulkan_context* context,
-    texture_type type,
     vulkan_image* image,
     VkBuffer buffer,
+    u64 buffer_offset,
+    u32 layer,
+    u32 first_row,
+    u32 row_count,
     vulkan_command_buffer* command_buffer
 );
 
@@ -10,6 +10,7 @@ b8 vulkan_graphics_pipeline_create(
 vulkan_context* context,
     vulkan_renderpass* renderpass,
     u32 stride,
+    u32 instance_stride,
     u32 attribute_count,
     VkVertexInputAttributeDescription* attributes,
     u32 descriptor_set_layout_count,
@@ -112,15 +113,20 @@ vulkan_context* context,
     dynamic_state_create_info.pDynamicStates = dynamic_states;
 
     // Vertex input
-    VkVertexInputBindingDescription binding_description;
-    binding_description.binding = 0; // Binding index
-    binding_description.stride = stride;
-    binding_description.inputRate = VK_VERTEX_INPUT_RATE_VERTEX; // Move to next data entry for each vertex.
+    VkVertexInputBindingDescription binding_descriptions[2];
+    binding_descriptions[0].binding = 0; // Binding index
+    binding_descriptions[0].stride = stride;
+    binding_descriptions[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX; // Move to next data entry for each vertex.
+
+    // Per-instance data, only if the shader has any.
+    binding_descriptions[1].binding = 1;
+    binding_descriptions[1].stride = instance_stride;
+    binding_descriptions[1].inputRate = VK_VERTEX_INPUT_RATE_INSTANCE; // Move to next data entry for each instance.
 
     // Attributes
     VkPipelineVertexInputStateCreateInfo vertex_input_info = {VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO};
-    vertex_input_info.vertexBindingDescriptionCount = 1;
-    vertex_input_info.pVertexBindingDescriptions = &binding_description;
+    vertex_input_info.vertexBindingDescriptionCount = instance_stride > 0 ? 2 : 1;
+    vertex_input_info.pVertexBindingDescriptions = binding_descriptions;
     vertex_input_info.vertexAttributeDescriptionCount = attribute_count;
     vertex_input_info.pVertexAttributeDescriptions = attributes;
 
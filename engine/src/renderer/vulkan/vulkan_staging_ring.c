@@ -0,0 +1,503 @@
+#include "vulkan_staging_ring.h"
+
+#include "vulkan_buffer.h"
+#include "vulkan_command_buffer.h"
+#include "vulkan_utils.h"
+
+#include "core/logger.h"
+#include "core/tmemory.h"
+
+#include "containers/darray.h"
+
+#include "platform/platform.h"
+
+// Max number of barriers recorded by a single vkCmdPipelineBarrier call.
+#define VULKAN_STAGING_BARRIER_BATCH 32
+
+// Stages and accesses of the graphics queue that read what is uploaded.
+#define UPLOAD_READ_STAGES (VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT)
+#define UPLOAD_BUFFER_READ_ACCESS (VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT)
+
+static void stall_begin(f64* out_start){
+    *out_start = platform_get_absolute_time();
+}
+
+static void stall_end(vulkan_staging_ring* ring, f64 start){
+    ring->stats.stall_count++;
+    ring->stats.stall_seconds += platform_get_absolute_time() - start;
+}
+
+/**
+ * Takes size bytes at the head of the ring, at an offset which is a multiple of alignment.
+ * Wraps around to the start of the buffer if the end is too close. Returns false if there is
+ * not enough free space.
+ */
+static b8 ring_allocate(vulkan_staging_ring* ring, u64 size, u64 alignment, u64* out_offset){
+    u64 capacity = ring->buffer.total_size;
+    u64 offset = ((ring->head + alignment - 1) / alignment) * alignment;
+    u64 padding;
+    if(offset + size > capacity){
+        // The space left before the end of the buffer is skipped, and handed back with the batch.
+        offset = 0;
+        padding = capacity - ring->head;
+    } else {
+        padding = offset - ring->head;
+    }
+
+    if(ring->used + padding + size > capacity){
+        return FALSE;
+    }
+
+    ring->head = offset + size;
+    ring->used += padding + size;
+    ring->batch_size += padding + size;
+    if(ring->used > ring->stats.staging_peak){
+        ring->stats.staging_peak = ring->used;
+    }
+    *out_offset = offset;
+    return TRUE;
+}
+
+// Hands back the space of the oldest count regions.
+static void regions_release(vulkan_staging_ring* ring, u32 count){
+    u64 capacity = ring->buffer.total_size;
+    for(u32 i = 0; i < count; ++i){
+        vulkan_staging_region* region = &ring->regions[ring->region_first];
+        ring->tail = (ring->tail + region->size) % capacity;
+        ring->used -= region->size;
+        ring->completed_serial = region->batch_serial;
+        ring->region_first = (ring->region_first + 1) % VULKAN_STAGING_RING_MAX_REGIONS;
+    }
+    ring->region_count -= count;
+
+    // Start over from the beginning once everything is free, so uploads wrap less often.
+    if(ring->used == 0){
+        ring->head = 0;
+        ring->tail = 0;
+    }
+}
+
+// Waits for the oldest submitted batch and hands back its space.
+static void region_wait_oldest(vulkan_context* context, vulkan_staging_ring* ring){
+    f64 start;
+    stall_begin(&start);
+    VkFence fence = ring->regions[ring->region_first].fence;
+    VK_CHECK(vkWaitForFences(context->device.logical_device, 1, &fence, TRUE, UINT64_MAX));
+    stall_end(ring, start);
+    vulkan_staging_ring_retire(context, ring);
+}
+
+/**
+ * Submits the batch being recorded and waits for it to complete, putting the time waited in
+ * out_wait_seconds. Returns false if there was no batch to submit, or it could not be.
+ */
+static b8 batch_submit_wait(vulkan_context* context, vulkan_staging_ring* ring, f64* out_wait_seconds){
+    *out_wait_seconds = 0.0;
+    if(!ring->batch_recording){
+        return FALSE;
+    }
+
+    u32 index = ring->batch_index;
+    if(!vulkan_staging_ring_submit(context, ring)){
+        return FALSE;
+    }
+
+    f64 start = platform_get_absolute_time();
+    VK_CHECK(vkWaitForFences(context->device.logical_device, 1, &ring->batch_fences[index], TRUE, UINT64_MAX));
+    *out_wait_seconds = platform_get_absolute_time() - start;
+
+    vulkan_staging_ring_retire(context, ring);
+    return TRUE;
+}
+
+// Whether the batch being recorded can be submitted, and the next one begun, without waiting.
+static b8 batch_submit_is_free(vulkan_context* context, vulkan_staging_ring* ring){
+    if(ring->region_count == VULKAN_STAGING_RING_MAX_REGIONS){
+        return FALSE;
+    }
+    VkFence next_fence = ring->batch_fences[(ring->batch_index + 1) % VULKAN_STAGING_RING_BATCH_BUFFERS];
+    return vkGetFenceStatus(context->device.logical_device, next_fence) == VK_SUCCESS;
+}
+
+// Records the barriers gathered so far, if any.
+static void barriers_record(
+    VkCommandBuffer command_buffer,
+    VkPipelineStageFlags source_stage,
+    VkPipelineStageFlags dest_stage,
+    u32* buffer_barrier_count,
+    VkBufferMemoryBarrier* buffer_barriers,
+    u32* image_barrier_count,
+    VkImageMemoryBarrier* image_barriers
+){
+    if(*buffer_barrier_count || *image_barrier_count){
+        vkCmdPipelineBarrier(
+            command_buffer,
+            source_stage, dest_stage,
+            0,
+            0, 0,
+            *buffer_barrier_count, buffer_barriers,
+            *image_barrier_count, image_barriers
+        );
+    }
+    *buffer_barrier_count = 0;
+    *image_barrier_count = 0;
+}
+
+/**
+ * Records, into command_buffer, a barrier for each of the given hand-offs: the releasing half of
+ * the ownership transfer on the transfer queue when releasing, otherwise the acquiring half on
+ * the graphics queue, or when ownership is not transferred, the image layout transitions.
+ */
+static void handoff_barriers_record(vulkan_context* context, vulkan_staging_ring* ring, VkCommandBuffer command_buffer, u32 first, u32 count, b8 releasing){
+    VkBufferMemoryBarrier buffer_barriers[VULKAN_STAGING_BARRIER_BATCH];
+    VkImageMemoryBarrier image_barriers[VULKAN_STAGING_BARRIER_BATCH];
+    u32 buffer_barrier_count = 0;
+    u32 image_barrier_count = 0;
+
+    VkPipelineStageFlags source_stage = releasing ? VK_PIPELINE_STAGE_TRANSFER_BIT : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+    VkPipelineStageFlags dest_stage = releasing ? VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT : UPLOAD_READ_STAGES;
+    if(!ring->transfers_ownership){
+        source_stage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+        dest_stage = UPLOAD_READ_STAGES;
+    }
+    u32 source_family = ring->transfers_ownership ? (u32)context->device.transfer_queue_index : VK_QUEUE_FAMILY_IGNORED;
+    u32 dest_family = ring->transfers_ownership ? (u32)context->device.graphics_queue_index : VK_QUEUE_FAMILY_IGNORED;
+
+    for(u32 i = first; i < first + count; ++i){
+        vulkan_staging_handoff* handoff = &ring->handoffs[i];
+
+        // Without a change of owner, only images need a barrier, for their layout. Buffers are
+        // covered by a single memory barrier.
+        if(!ring->transfers_ownership && handoff->buffer){
+            continue;
+        }
+        // What was destroyed since is never read again: the graphics queue does not take it over,
+        // and may not even find it there. It lives on until the batch has completed regardless.
+        if(handoff->image && !handoff->ready_generation){
+            continue;
+        }
+
+        // The releasing half makes the writes available, the acquiring half makes them visible.
+        VkAccessFlags source_access = VK_ACCESS_TRANSFER_WRITE_BIT;
+        VkAccessFlags dest_access = handoff->buffer ? UPLOAD_BUFFER_READ_ACCESS : VK_ACCESS_SHADER_READ_BIT;
+        if(ring->transfers_ownership){
+            if(releasing){
+                dest_access = 0;
+            } else {
+                source_access = 0;
+            }
+        }
+
+        if(handoff->buffer){
+            VkBufferMemoryBarrier* barrier = &buffer_barriers[buffer_barrier_count++];
+            tzero_memory(barrier, sizeof(VkBufferMemoryBarrier));
+            barrier->sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+            barrier->srcAccessMask = source_access;
+            barrier->dstAccessMask = dest_access;
+            barrier->srcQueueFamilyIndex = source_family;
+            barrier->dstQueueFamilyIndex = dest_family;
+            barrier->buffer = handoff->buffer;
+            barrier->offset = handoff->offset;
+            barrier->size = handoff->size;
+        } else {
+            VkImageMemoryBarrier* barrier = &image_barriers[image_barrier_count++];
+            tzero_memory(barrier, sizeof(VkImageMemoryBarrier));
+            barrier->sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+            barrier->srcAccessMask = source_access;
+            barrier->dstAccessMask = dest_access;
+            barrier->oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+            barrier->newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+            barrier->srcQueueFamilyIndex = source_family;
+            barrier->dstQueueFamilyIndex = dest_family;
+            barrier->image = handoff->image;
+            barrier->subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            barrier->subresourceRange.baseMipLevel = 0;
+            barrier->subresourceRange.levelCount = 1;
+            barrier->subresourceRange.baseArrayLayer = 0;
+            barrier->subresourceRange.layerCount = handoff->layer_count;
+        }
+
+        if(buffer_barrier_count == VULKAN_STAGING_BARRIER_BATCH || image_barrier_count == VULKAN_STAGING_BARRIER_BATCH){
+            barriers_record(command_buffer, source_stage, dest_stage, &buffer_barrier_count, buffer_barriers, &image_barrier_count, image_barriers);
+        }
+    }
+    barriers_record(command_buffer, source_stage, dest_stage, &buffer_barrier_count, buffer_barriers, &image_barrier_count, image_barriers);
+}
+
+b8 vulkan_staging_ring_create(vulkan_context* context, u64 size, vulkan_staging_ring* out_ring){
+    tzero_memory(out_ring, sizeof(vulkan_staging_ring));
+
+    if(!vulkan_buffer_create(
+        context,
+        size,
+        VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        TRUE,
+        FALSE,
+        &out_ring->buffer
+    )){
+        TERROR("Error creating staging ring buffer.");
+        return FALSE;
+    }
+    out_ring->memory = vulkan_buffer_lock_memory(context, &out_ring->buffer, 0, VK_WHOLE_SIZE, 0);
+
+    // Created signalled, since no batch is using them yet.
+    VkFenceCreateInfo fence_create_info = {VK_STRUCTURE_TYPE_FENCE_CREATE_INFO};
+    fence_create_info.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+    for(u32 i = 0; i < VULKAN_STAGING_RING_BATCH_BUFFERS; ++i){
+        vulkan_command_buffer_allocate(context, context->device.transfer_command_pool, TRUE, &out_ring->batch_buffers[i]);
+        VK_CHECK(vkCreateFence(context->device.logical_device, &fence_create_info, context->allocator, &out_ring->batch_fences[i]));
+    }
+
+    out_ring->transfers_ownership = context->device.transfer_queue_index != context->device.graphics_queue_index;
+    out_ring->handoffs = darray_create(vulkan_staging_handoff);
+    out_ring->batch_serial = 1;
+    out_ring->stats.staging_size = size;
+    return TRUE;
+}
+
+void vulkan_staging_ring_destroy(vulkan_context* context, vulkan_staging_ring* ring){
+    for(u32 i = 0; i < VULKAN_STAGING_RING_BATCH_BUFFERS; ++i){
+        if(ring->batch_fences[i]){
+            vkDestroyFence(context->device.logical_device, ring->batch_fences[i], context->allocator);
+        }
+        if(ring->batch_buffers[i].handle){
+            vulkan_command_buffer_free(context, context->device.transfer_command_pool, &ring->batch_buffers[i]);
+        }
+    }
+    if(ring->handoffs){
+        darray_destroy(ring->handoffs);
+    }
+    if(ring->memory){
+        vulkan_buffer_unlock_memory(context, &ring->buffer);
+    }
+    vulkan_buffer_destroy(context, &ring->buffer);
+    tzero_memory(ring, sizeof(vulkan_staging_ring));
+}
+
+b8 vulkan_staging_ring_upload(
+    vulkan_context* context,
+    vulkan_staging_ring* ring,
+    u64 size,
+    u64 alignment,
+    const void* data,
+    u64* out_offset,
+    vulkan_command_buffer** out_command_buffer
+){
+    if(size > ring->buffer.total_size){
+        TERROR("vulkan_staging_ring_upload: %llu bytes do not fit in a staging ring of %llu bytes.", size, ring->buffer.total_size);
+        return FALSE;
+    }
+
+    f64 start = platform_get_absolute_time();
+
+    vulkan_staging_ring_retire(context, ring);
+
+    // Send a large batch off early, so the GPU copies it while the rest is staged rather than
+    // the ring filling up and everything waiting on a single batch.
+    u64 batch_limit = ring->buffer.total_size / VULKAN_STAGING_RING_BATCH_DIVISOR;
+    if(ring->batch_recording && ring->batch_size && ring->batch_size + size > batch_limit && batch_submit_is_free(context, ring)){
+        if(!vulkan_staging_ring_submit(context, ring)){
+            return FALSE;
+        }
+    }
+
+    u64 offset;
+    while(!ring_allocate(ring, size, alignment, &offset)){
+        // Full. Wait for the oldest batch in flight, or if the batch being recorded takes up
+        // the whole ring, submit it now.
+        if(ring->region_count){
+            region_wait_oldest(context, ring);
+        } else {
+            f64 wait_seconds;
+            batch_submit_wait(context, ring, &wait_seconds);
+            ring->stats.stall_count++;
+            ring->stats.stall_seconds += wait_seconds;
+        }
+    }
+
+    tcopy_memory(ring->memory + offset, data, size);
+
+    vulkan_command_buffer* command_buffer = &ring->batch_buffers[ring->batch_index];
+    if(!ring->batch_recording){
+        // The command buffer may still be in use by the batch it was last submitted with.
+        VkFence fence = ring->batch_fences[ring->batch_index];
+        if(vkGetFenceStatus(context->device.logical_device, fence) != VK_SUCCESS){
+            f64 stall_start;
+            stall_begin(&stall_start);
+            VK_CHECK(vkWaitForFences(context->device.logical_device, 1, &fence, TRUE, UINT64_MAX));
+            stall_end(ring, stall_start);
+            vulkan_staging_ring_retire(context, ring);
+        }
+
+        vulkan_command_buffer_begin(command_buffer, TRUE, FALSE, FALSE);
+        ring->batch_recording = TRUE;
+    }
+
+    ring->stats.upload_count++;
+    ring->stats.bytes += size;
+    ring->stats.seconds += platform_get_absolute_time() - start;
+
+    *out_offset = offset;
+    *out_command_buffer = command_buffer;
+    return TRUE;
+}
+
+void vulkan_staging_ring_hand_off_buffer(vulkan_staging_ring* ring, VkBuffer buffer, u64 offset, u64 size, u32* ready_generation, u32 generation){
+    vulkan_staging_handoff handoff = {0};
+    handoff.batch_serial = ring->batch_serial;
+    handoff.buffer = buffer;
+    handoff.offset = offset;
+    handoff.size = size;
+    handoff.ready_generation = ready_generation;
+    handoff.generation = generation;
+    darray_push(ring->handoffs, handoff);
+}
+
+void vulkan_staging_ring_hand_off_image(vulkan_staging_ring* ring, vulkan_image* image, u32 layer_count){
+    vulkan_staging_handoff handoff = {0};
+    handoff.batch_serial = ring->batch_serial;
+    handoff.image = image->handle;
+    handoff.layer_count = layer_count;
+    handoff.ready_generation = &image->ready_generation;
+    handoff.generation = image->upload_generation;
+    darray_push(ring->handoffs, handoff);
+}
+
+void vulkan_staging_ring_forget(vulkan_staging_ring* ring, u32* ready_generation){
+    u32 handoff_count = (u32)darray_length(ring->handoffs);
+    for(u32 i = 0; i < handoff_count; ++i){
+        if(ring->handoffs[i].ready_generation == ready_generation){
+            ring->handoffs[i].ready_generation = 0;
+        }
+    }
+}
+
+void vulkan_staging_ring_retire(vulkan_context* context, vulkan_staging_ring* ring){
+    // A fence signals only once everything submitted to the queue before it has completed, so
+    // the newest signalled region frees every region before it as well.
+    u32 retired_count = 0;
+    for(u32 i = 0; i < ring->region_count; ++i){
+        u32 index = (ring->region_first + i) % VULKAN_STAGING_RING_MAX_REGIONS;
+        if(vkGetFenceStatus(context->device.logical_device, ring->regions[index].fence) == VK_SUCCESS){
+            retired_count = i + 1;
+        }
+    }
+    if(retired_count){
+        regions_release(ring, retired_count);
+    }
+}
+
+b8 vulkan_staging_ring_submit(vulkan_context* context, vulkan_staging_ring* ring){
+    if(!ring->batch_recording){
+        return TRUE;
+    }
+
+    if(ring->region_count == VULKAN_STAGING_RING_MAX_REGIONS){
+        region_wait_oldest(context, ring);
+    }
+
+    vulkan_command_buffer* command_buffer = &ring->batch_buffers[ring->batch_index];
+    VkFence fence = ring->batch_fences[ring->batch_index];
+
+    // The hand-offs of this batch are the last ones pushed.
+    u32 handoff_count = (u32)darray_length(ring->handoffs);
+    u32 first = handoff_count;
+    while(first > 0 && ring->handoffs[first - 1].batch_serial == ring->batch_serial){
+        first--;
+    }
+
+    if(!ring->transfers_ownership){
+        // Same queue: make the writes visible to the draws of the frames submitted after the
+        // batch. The images are moved to the layout they are read in below.
+        VkMemoryBarrier barrier = {VK_STRUCTURE_TYPE_MEMORY_BARRIER};
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = UPLOAD_BUFFER_READ_ACCESS;
+        vkCmdPipelineBarrier(
+            command_buffer->handle,
+            VK_PIPELINE_STAGE_TRANSFER_BIT,
+            UPLOAD_READ_STAGES,
+            0,
+            1, &barrier,
+            0, 0,
+            0, 0
+        );
+    }
+    // Otherwise release what the batch wrote to the graphics queue, which acquires it once the
+    // batch has completed.
+    handoff_barriers_record(context, ring, command_buffer->handle, first, handoff_count - first, TRUE);
+    vulkan_command_buffer_end(command_buffer);
+
+    VK_CHECK(vkResetFences(context->device.logical_device, 1, &fence));
+
+    VkSubmitInfo submit_info = {VK_STRUCTURE_TYPE_SUBMIT_INFO};
+    submit_info.commandBufferCount = 1;
+    submit_info.pCommandBuffers = &command_buffer->handle;
+    VkResult result = vkQueueSubmit(context->device.transfer_queue, 1, &submit_info, fence);
+    if(!vulkan_result_is_success(result)){
+        TERROR("vulkan_staging_ring_submit: vkQueueSubmit failed with result: %s", vulkan_result_string(result, TRUE));
+        return FALSE;
+    }
+    vulkan_command_buffer_update_submitted(command_buffer);
+
+    u32 region_index = (ring->region_first + ring->region_count) % VULKAN_STAGING_RING_MAX_REGIONS;
+    ring->regions[region_index].size = ring->batch_size;
+    ring->regions[region_index].batch_serial = ring->batch_serial;
+    ring->regions[region_index].fence = fence;
+    ring->region_count++;
+
+    ring->batch_index = (ring->batch_index + 1) % VULKAN_STAGING_RING_BATCH_BUFFERS;
+    ring->batch_recording = FALSE;
+    ring->batch_size = 0;
+    ring->batch_serial++;
+    ring->stats.submission_count++;
+
+    return TRUE;
+}
+
+void vulkan_staging_ring_flush(vulkan_context* context, vulkan_staging_ring* ring){
+    f64 wait_seconds;
+    if(batch_submit_wait(context, ring, &wait_seconds)){
+        ring->stats.flush_count++;
+        ring->stats.flush_seconds += wait_seconds;
+    }
+}
+
+void vulkan_staging_ring_acquire(vulkan_context* context, vulkan_staging_ring* ring, vulkan_command_buffer* command_buffer){
+    // Batches on the graphics queue itself can be used by anything submitted after them, while
+    // the graphics queue may only take ownership of what another queue wrote once it is done.
+    u64 last_serial = ring->batch_serial - 1;
+    if(ring->transfers_ownership){
+        vulkan_staging_ring_retire(context, ring);
+        last_serial = ring->completed_serial;
+    }
+
+    u32 handoff_count = (u32)darray_length(ring->handoffs);
+    u32 count = 0;
+    while(count < handoff_count && ring->handoffs[count].batch_serial <= last_serial){
+        count++;
+    }
+    if(!count){
+        return;
+    }
+
+    if(ring->transfers_ownership){
+        handoff_barriers_record(context, ring, command_buffer->handle, 0, count, FALSE);
+    }
+
+    for(u32 i = 0; i < count; ++i){
+        if(ring->handoffs[i].ready_generation){
+            *ring->handoffs[i].ready_generation = ring->handoffs[i].generation;
+        }
+    }
+
+    // Drop the hand-offs done with, keeping the rest in order.
+    for(u32 i = count; i < handoff_count; ++i){
+        ring->handoffs[i - count] = ring->handoffs[i];
+    }
+    darray_length_set(ring->handoffs, handoff_count - count);
+}
+
+u64 vulkan_staging_ring_latest_batch(vulkan_staging_ring* ring){
+    return ring->batch_recording ? ring->batch_serial : ring->batch_serial - 1;
+}
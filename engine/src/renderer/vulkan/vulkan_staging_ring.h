@@ -0,0 +1,104 @@
+#pragma once
+
+#include "vulkan_types.inl"
+
+/**
+ * Creates a staging ring of the given size, mapped for its whole life, along with the command
+ * buffers its batches of uploads are recorded into on the transfer queue.
+ * @param context The Vulkan context.
+ * @param size The size of the ring in bytes.
+ * @param out_ring A pointer to hold the ring.
+ * @return True on success; otherwise false.
+ */
+b8 vulkan_staging_ring_create(vulkan_context* context, u64 size, vulkan_staging_ring* out_ring);
+
+/**
+ * Destroys the ring. The device must be idle.
+ */
+void vulkan_staging_ring_destroy(vulkan_context* context, vulkan_staging_ring* ring);
+
+/**
+ * Copies data into the ring, and begins recording a batch of uploads if one is not being
+ * recorded already, or the one being recorded has grown large enough to be submitted first.
+ * Only waits for the GPU if the ring is full. The caller then records the
+ * copy from the ring's buffer, at out_offset, to the upload's destination into out_command_buffer,
+ * and hands the destination off once it has recorded everything writing to it.
+ * @param context The Vulkan context.
+ * @param ring The ring.
+ * @param size The size of the data in bytes. Must be no larger than the ring.
+ * @param alignment The alignment of the data within the ring's buffer.
+ * @param data The data.
+ * @param out_offset A pointer to hold the offset of the data within the ring's buffer.
+ * @param out_command_buffer A pointer to hold the command buffer of the batch.
+ * @return True on success; otherwise false.
+ */
+b8 vulkan_staging_ring_upload(
+    vulkan_context* context,
+    vulkan_staging_ring* ring,
+    u64 size,
+    u64 alignment,
+    const void* data,
+    u64* out_offset,
+    vulkan_command_buffer** out_command_buffer
+);
+
+/**
+ * Hands a buffer range written by the batch being recorded over to the graphics queue, once the
+ * batch has completed.
+ * @param ring The ring.
+ * @param buffer The buffer.
+ * @param offset The offset of the range.
+ * @param size The size of the range.
+ * @param ready_generation Set to generation once the graphics queue can read the range. Optional.
+ * @param generation The generation of the data written.
+ */
+void vulkan_staging_ring_hand_off_buffer(vulkan_staging_ring* ring, VkBuffer buffer, u64 offset, u64 size, u32* ready_generation, u32 generation);
+
+/**
+ * Hands an image written by the batch being recorded, and left in the transfer destination
+ * layout, over to the graphics queue in the shader read only layout, once the batch has completed.
+ * Its ready_generation is set to its upload_generation then.
+ * @param ring The ring.
+ * @param image The image.
+ * @param layer_count The number of layers of the image.
+ */
+void vulkan_staging_ring_hand_off_image(vulkan_staging_ring* ring, vulkan_image* image, u32 layer_count);
+
+/**
+ * Stops the given ready generation from being set by hand-offs still to come, for when what
+ * it belongs to is destroyed.
+ */
+void vulkan_staging_ring_forget(vulkan_staging_ring* ring, u32* ready_generation);
+
+/**
+ * Hands back the space of every batch which has completed. Never waits.
+ */
+void vulkan_staging_ring_retire(vulkan_context* context, vulkan_staging_ring* ring);
+
+/**
+ * Ends the batch being recorded, if any, and submits it on the transfer queue. Does not wait for it.
+ * @return True on success; otherwise false.
+ */
+b8 vulkan_staging_ring_submit(vulkan_context* context, vulkan_staging_ring* ring);
+
+/**
+ * Submits the batch being recorded, if any, and waits for it to complete. The wait is counted
+ * as a flush rather than as a stall.
+ */
+void vulkan_staging_ring_flush(vulkan_context* context, vulkan_staging_ring* ring);
+
+/**
+ * Hands what completed batches wrote over to the graphics queue, recording the barriers taking
+ * ownership of it into the given command buffer, and marks it ready.
+ * @param context The Vulkan context.
+ * @param ring The ring.
+ * @param command_buffer A graphics command buffer being recorded, submitted before anything
+ * that is made ready is used.
+ */
+void vulkan_staging_ring_acquire(vulkan_context* context, vulkan_staging_ring* ring, vulkan_command_buffer* command_buffer);
+
+/**
+ * Returns the number of the latest batch holding uploads, recorded or submitted, or 0 if there
+ * has been none. What its copies read or write must live until the batch has completed.
+ */
+u64 vulkan_staging_ring_latest_batch(vulkan_staging_ring* ring);
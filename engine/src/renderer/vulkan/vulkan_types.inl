@@ -58,6 +58,7 @@ typedef struct vulkan_device{
     VkQueue transfer_queue;
 
     VkCommandPool graphics_command_pool;
+    VkCommandPool transfer_command_pool;
 
     VkPhysicalDeviceProperties properties;
     VkPhysicalDeviceFeatures features;
@@ -74,6 +75,10 @@ typedef struct vulkan_image{
     VkImageView view;
     u32 width;
     u32 height;
+    /** @brief Incremented each time data is written to the image. */
+    u32 upload_generation;
+    /** @brief The upload_generation whose data the graphics queue can use. The image is ready when they match. */
+    u32 ready_generation;
 } vulkan_image;
 
 typedef enum vulkan_render_pass_state{
@@ -152,18 +157,38 @@ typedef struct vulkan_pipeline{
 // TODO: make configurable
 #define VULKAN_MAX_GEOMETRY_COUNT 4096
 
+// Max number of instances drawn with instanced draws per frame
+// TODO: make configurable
+#define VULKAN_MAX_INSTANCE_COUNT 65536
+
 /**
  * @brief Internal buffer data for geometry.
  */
+/** @brief Where a geometry's data lives in the vertex and index buffers. */
+typedef struct vulkan_geometry_range{
+    u32 vertex_count;
+    u32 vertex_element_size;
+    u64 vertex_buffer_offset;
+    u32 index_count;
+    u32 index_element_size;
+    u64 index_buffer_offset;
+} vulkan_geometry_range;
+
 typedef struct vulkan_geometry_data{
     u32 id;
     u32 generation;
+    /** @brief The generation whose data the graphics queue can use. The geometry is ready when they match. */
+    u32 ready_generation;
     u32 vertex_count;
     u32 vertex_element_size;
     u64 vertex_buffer_offset;
     u32 index_count;
     u32 index_element_size;
     u64 index_buffer_offset;
+    /** @brief Whether previous holds the data of a reupload which is not ready yet. */
+    b8 has_previous;
+    /** @brief The data a reupload replaces. It is drawn until the reupload is ready, then freed. */
+    vulkan_geometry_range previous;
 } vulkan_geometry_data;
 
 #define VULKAN_SHADER_MAX_STAGES 8
@@ -233,6 +258,8 @@ typedef struct vulkan_shader_config{
     /** @brief Descriptor sets, max of 2. Index 0=global, 1=instance */
     vulkan_descriptor_set_config descriptor_sets[2];
 
+    /** @brief The number of attribute descriptions. A mat4 attribute takes up four. */
+    u8 attribute_count;
     /** @brief An array of attribute descriptions for this shader. */
     VkVertexInputAttributeDescription attributes[VULKAN_SHADER_MAX_ATTRIBUTES];
 
@@ -295,6 +322,12 @@ typedef struct vulkan_shader{
     VkDescriptorSetLayout descriptor_set_layouts[2];
     /** @brief Global descriptor sets, one per frame. */
     VkDescriptorSet global_descriptor_sets[3];
+    /**
+     * @brief Indicates if each global descriptor set has been written. What they point at never
+     * changes, so each is written once rather than every time it is bound, which would be
+     * unsafe while it is bound in command buffers being recorded on other threads.
+     */
+    b8 global_descriptor_set_written[3];
     /** @brief The uniform buffer used by this shader. */
     vulkan_buffer uniform_buffer;
 
@@ -320,6 +353,182 @@ typedef struct vulkan_shader{
 
 #define VULKAN_MAX_REGISTERED_RENDERPASSES 31
 
+// Max number of recordings, typically one per render view, executed per frame.
+#define VULKAN_MAX_RECORDINGS 16
+// Max number of renderpasses begun by a single recording.
+#define VULKAN_MAX_RECORDING_SEGMENTS 4
+// Max number of secondary command buffers executed within one renderpass of a recording.
+#define VULKAN_MAX_SEGMENT_PARTS 64
+// Max number of threads that can record, counting the main thread.
+#define VULKAN_MAX_RECORDING_THREADS 33
+// Max number of secondary command buffers a single thread can record per frame.
+#define VULKAN_MAX_THREAD_COMMAND_BUFFERS 128
+
+/**
+ * @brief One renderpass begun by a recording. Its commands are split into parts, each a
+ * secondary command buffer, which are executed in order inside the renderpass.
+ */
+typedef struct vulkan_recording_segment {
+    /** @brief The renderpass. */
+    renderpass* pass;
+    /** @brief The render target the renderpass is begun on. */
+    render_target* target;
+    /** @brief The number of parts. */
+    u32 part_count;
+    /** @brief The index of the first part reserved for chunks by the latest renderpass_chunks_begin(). */
+    u32 chunk_base;
+    /** @brief The parts, in execution order. A part is 0 if it was reserved but never recorded. */
+    vulkan_command_buffer* parts[VULKAN_MAX_SEGMENT_PARTS];
+} vulkan_recording_segment;
+
+/** @brief The commands of a recording, made between recording_begin() and recording_end(). */
+typedef struct vulkan_recording {
+    /** @brief The number of renderpasses begun. */
+    u32 segment_count;
+    /** @brief The renderpasses begun, in order. */
+    vulkan_recording_segment segments[VULKAN_MAX_RECORDING_SEGMENTS];
+} vulkan_recording;
+
+/**
+ * @brief A command pool owned by a single thread, and the secondary command buffers allocated
+ * from it. Reset as a whole once the frame it was used for has completed.
+ */
+typedef struct vulkan_thread_command_pool {
+    /** @brief The pool. 0 until the thread first records. */
+    VkCommandPool handle;
+    /** @brief The number of command buffers allocated from the pool. */
+    u32 allocated_count;
+    /** @brief The number of command buffers handed out this frame. */
+    u32 used_count;
+    /** @brief The command buffers. */
+    vulkan_command_buffer buffers[VULKAN_MAX_THREAD_COMMAND_BUFFERS];
+} vulkan_thread_command_pool;
+
+// Size of the staging ring uploads are copied through on their way to device local memory.
+#define VULKAN_STAGING_RING_SIZE (64 * 1024 * 1024)
+// Max number of submitted batches of uploads whose part of the staging ring may still be in use.
+#define VULKAN_STAGING_RING_MAX_REGIONS 8
+// Number of command buffers batches of uploads are recorded into, used in turn.
+#define VULKAN_STAGING_RING_BATCH_BUFFERS 3
+// A batch of uploads is submitted before the end of the frame once it would take up more than
+// the ring's size divided by this.
+#define VULKAN_STAGING_RING_BATCH_DIVISOR 4
+
+/** @brief The part of the staging ring used by a submitted batch of uploads. */
+typedef struct vulkan_staging_region {
+    /** @brief The bytes of the ring the batch used, padding included. */
+    u64 size;
+    /** @brief The number of the batch. */
+    u64 batch_serial;
+    /** @brief The fence signalled when the batch has completed. */
+    VkFence fence;
+} vulkan_staging_region;
+
+/**
+ * @brief A buffer range or image written by a batch of uploads, which is handed over to the
+ * graphics queue once the batch has completed.
+ */
+typedef struct vulkan_staging_handoff {
+    /** @brief The number of the batch that wrote it. */
+    u64 batch_serial;
+    /** @brief The buffer, or 0 if an image was written. */
+    VkBuffer buffer;
+    /** @brief The offset of the range written in the buffer. */
+    u64 offset;
+    /** @brief The size of the range written in the buffer. */
+    u64 size;
+    /** @brief The image, or 0 if a buffer was written. */
+    VkImage image;
+    /** @brief The number of layers of the image. */
+    u32 layer_count;
+    /** @brief Set to generation once the graphics queue can use what was written. Optional. */
+    u32* ready_generation;
+    /** @brief The generation of the data written. */
+    u32 generation;
+} vulkan_staging_handoff;
+
+/**
+ * @brief A host visible buffer, kept mapped, that uploads are copied into and then copied from
+ * by the GPU. Used as a ring: uploads take space at the head, and the space of a batch is
+ * handed back at the tail once the fence it was submitted with signals. The copies are recorded
+ * into a batch which is submitted on the transfer queue once per frame, or sooner if it grows
+ * large, and never waited on unless the ring is full. What a batch writes is handed over to the graphics queue, and marked
+ * ready, once it has completed.
+ */
+typedef struct vulkan_staging_ring {
+    /** @brief The buffer. */
+    vulkan_buffer buffer;
+    /** @brief The mapped memory of the buffer. */
+    u8* memory;
+    /** @brief The offset the next upload goes at, before alignment. */
+    u64 head;
+    /** @brief The offset of the oldest byte still in use. */
+    u64 tail;
+    /** @brief The bytes in use, from the tail up to the head. */
+    u64 used;
+    /** @brief The bytes used by the batch being recorded. */
+    u64 batch_size;
+    /** @brief The index of the oldest region. */
+    u32 region_first;
+    /** @brief The number of regions in use. */
+    u32 region_count;
+    /** @brief The submitted batches still using the ring, oldest first. */
+    vulkan_staging_region regions[VULKAN_STAGING_RING_MAX_REGIONS];
+    /** @brief The command buffers batches are recorded into. */
+    vulkan_command_buffer batch_buffers[VULKAN_STAGING_RING_BATCH_BUFFERS];
+    /** @brief The fence of each command buffer, signalled when its last batch has completed. */
+    VkFence batch_fences[VULKAN_STAGING_RING_BATCH_BUFFERS];
+    /** @brief The index of the command buffer the next batch is recorded into. */
+    u32 batch_index;
+    /** @brief Numbers the batches, starting at 1. The number of the one being recorded or recorded next. */
+    u64 batch_serial;
+    /** @brief Every batch up to and including this one has completed. */
+    u64 completed_serial;
+    /** @brief Indicates if a batch is being recorded. */
+    b8 batch_recording;
+    /**
+     * @brief Indicates if the transfer queue is of another family than the graphics queue, in
+     * which case what is uploaded has its ownership transferred from one to the other.
+     */
+    b8 transfers_ownership;
+    /** @brief What has been written by batches and not yet handed over, oldest first. darray. */
+    vulkan_staging_handoff* handoffs;
+    /** @brief Counts and times of the uploads made. */
+    renderer_upload_stats stats;
+} vulkan_staging_ring;
+
+/** @brief Kinds of objects whose destruction can be deferred. */
+typedef enum vulkan_deferred_destruction_type {
+    /** @brief An image, with its memory and view. */
+    VULKAN_DEFERRED_DESTRUCTION_IMAGE,
+    /** @brief A range of a buffer, freed back to its freelist. */
+    VULKAN_DEFERRED_DESTRUCTION_BUFFER_RANGE,
+    /** @brief A texture map's sampler. */
+    VULKAN_DEFERRED_DESTRUCTION_SAMPLER
+} vulkan_deferred_destruction_type;
+
+/**
+ * @brief An object which is no longer used, but may still be by frames in flight or by a batch
+ * of uploads, and so is destroyed once they have completed.
+ */
+typedef struct vulkan_deferred_destruction {
+    vulkan_deferred_destruction_type type;
+    /** @brief Destroyed once this many frames have completed. */
+    u64 frame_count;
+    /** @brief Destroyed once this batch of uploads has completed. */
+    u64 batch_serial;
+    /** @brief The image, if one. */
+    vulkan_image image;
+    /** @brief The sampler, if one. */
+    VkSampler sampler;
+    /** @brief The buffer, if a buffer range. */
+    vulkan_buffer* buffer;
+    /** @brief The offset of the buffer range. */
+    u64 offset;
+    /** @brief The size of the buffer range. */
+    u64 size;
+} vulkan_deferred_destruction;
+
 typedef struct vulkan_context{
     f32 frame_delta_time;
 
@@ -359,6 +568,21 @@ typedef struct vulkan_context{
     vulkan_buffer object_vertex_buffer;
     vulkan_buffer object_index_buffer;
 
+    /**
+     * @brief Per-instance data of instanced draws, split into one region per frame in flight so
+     * that a frame never writes over data the GPU may still be reading. Kept mapped.
+     */
+    vulkan_buffer instance_buffer;
+    /** @brief The mapped memory of the instance buffer. */
+    u8* instance_buffer_memory;
+    /** @brief The size of each frame's region of the instance buffer. */
+    u64 instance_buffer_frame_size;
+    /** @brief The bytes of the current frame's region used so far. Advanced atomically. */
+    volatile u64 instance_buffer_frame_offset;
+
+    /** @brief Geometry and texture data is uploaded through this. */
+    vulkan_staging_ring staging;
+
     // darray
     vulkan_command_buffer* graphics_command_buffers;
 
@@ -371,6 +595,16 @@ typedef struct vulkan_context{
     u32 in_flight_fence_count;
     VkFence in_flight_fences[2];
 
+    /** @brief The number of frames submitted. */
+    u64 frame_submitted_count;
+    /** @brief The number of frames known to have completed. */
+    u64 frame_completed_count;
+    /** @brief The frame_submitted_count each in flight fence was last submitted for. */
+    u64 in_flight_fence_frames[2];
+
+    /** @brief Objects waiting to be destroyed, oldest first. darray. */
+    vulkan_deferred_destruction* deferred_destructions;
+
     // Holds fences which exist and are owned elsewhere, one per frame.
     VkFence images_in_flight[3];
 
@@ -381,6 +615,8 @@ typedef struct vulkan_context{
 
     // TODO: make dynamic
     vulkan_geometry_data geometries[VULKAN_MAX_GEOMETRY_COUNT];
+    /** @brief The number of geometries which still hold the data a reupload replaces. */
+    u32 geometry_previous_count;
 
     /** @brief Render targets used for world rendering. @note One per frame. */
     render_target world_render_targets[3];
@@ -388,6 +624,15 @@ typedef struct vulkan_context{
     /** @brief Indicates if multi-threading is supported by this device. */
     b8 multithreading_enabled;
 
+    /** @brief Indicates if render views can be recorded into secondary command buffers on several threads. */
+    b8 parallel_recording_enabled;
+
+    /** @brief The recordings of the frame being drawn. */
+    vulkan_recording recordings[VULKAN_MAX_RECORDINGS];
+
+    /** @brief Command pools for secondary command buffers, per frame in flight and per thread slot. */
+    vulkan_thread_command_pool thread_command_pools[2][VULKAN_MAX_RECORDING_THREADS];
+
     i32 (*find_memory_index)(u32 type_filter, u32 property_flags);
 
     
@@ -68,7 +68,8 @@ b8 image_loader_load(struct resource_loader* self, const char* name, void* param
     i32 height;
     i32 channel_count;
 
-    u8* raw_data = tallocate(file_size, MEMORY_TAG_TEXTURE);
+    // Filled by the read below, so there is nothing to zero.
+    u8* raw_data = tallocate_uninitialized(file_size, TMEMORY_DEFAULT_ALIGNMENT, MEMORY_TAG_TEXTURE);
     if(!raw_data){
         TERROR("Unable to read file '%s'.", full_file_path);
         filesystem_close(&f);
@@ -81,11 +82,13 @@ b8 image_loader_load(struct resource_loader* self, const char* name, void* param
 
     if(!read_result){
         TERROR("Unable to read file: '%s'", full_file_path);
+        tfree(raw_data, file_size, MEMORY_TAG_TEXTURE);
         return FALSE;
     }
 
     if(bytes_read != file_size){
         TERROR("File size if %llu does not match expected: %llu", bytes_read, file_size);
+        tfree(raw_data, file_size, MEMORY_TAG_TEXTURE);
         return FALSE;
     }
 
@@ -165,13 +165,14 @@ b8 load_tsm_file(file_handle* tsm_file, geometry_config** out_geometries_darray)
         // Vertices (size/count/array)
         filesystem_read(tsm_file, sizeof(u32), &g.vertex_size, &bytes_read);
         filesystem_read(tsm_file, sizeof(u32), &g.vertex_count, &bytes_read);
-        g.vertices = tallocate(g.vertex_size * g.vertex_count, MEMORY_TAG_ARRAY);
+        // Vertex and index data are read straight into place, so neither needs zeroing.
+        g.vertices = tallocate_uninitialized(g.vertex_size * g.vertex_count, TMEMORY_DEFAULT_ALIGNMENT, MEMORY_TAG_ARRAY);
         filesystem_read(tsm_file, g.vertex_size * g.vertex_count, g.vertices, &bytes_read);
 
         // Indices (size/count/array)
         filesystem_read(tsm_file, sizeof(u32), &g.index_size, &bytes_read);
         filesystem_read(tsm_file, sizeof(u32), &g.index_count, &bytes_read);
-        g.indices = tallocate(g.index_size * g.index_count, MEMORY_TAG_ARRAY);
+        g.indices = tallocate_uninitialized(g.index_size * g.index_count, TMEMORY_DEFAULT_ALIGNMENT, MEMORY_TAG_ARRAY);
         filesystem_read(tsm_file, g.index_size * g.index_count, g.indices, &bytes_read);
 
         // Name
@@ -563,7 +564,7 @@ b8 import_obj_file(file_handle* obj_file, const char* out_tsm_filename, geometry
         g->vertex_count = new_vert_count;
 
         // Take a copy of the indices as a normal, non-darray
-        u32* indices = tallocate(sizeof(u32) * g->index_count, MEMORY_TAG_ARRAY);
+        u32* indices = tallocate_uninitialized(sizeof(u32) * g->index_count, TMEMORY_DEFAULT_ALIGNMENT, MEMORY_TAG_ARRAY);
         tcopy_memory(indices, g->indices, sizeof(u32) * g->index_count);
         // Destroy the darry
         darray_destroy(g->indices);
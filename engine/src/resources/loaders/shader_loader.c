@@ -149,8 +149,8 @@ b8 shader_loader_load(struct resource_loader* self, const char* name, void* para
             // Parse attribute.
             char** fields = darray_create(char*);
             u32 field_count = string_split(trimmed_value, ',', &fields, TRUE, TRUE);
-            if(field_count != 2){
-                TERROR("shader_loader_load: Invalid file layout. Attribute fields must be 'type,name'. Skipping.");
+            if(field_count != 2 && field_count != 3){
+                TERROR("shader_loader_load: Invalid file layout. Attribute fields must be 'type,name' or 'type,name,rate'. Skipping.");
             } else {
                 shader_attribute_config attribute;
                 // Parse field type
@@ -189,13 +189,27 @@ b8 shader_loader_load(struct resource_loader* self, const char* name, void* para
                 }else if(strings_equali(fields[0], "i32")){
                     attribute.type = SHADER_ATTRIB_TYPE_INT32;
                     attribute.size = 4;
+                }else if(strings_equali(fields[0], "mat4")){
+                    attribute.type = SHADER_ATTRIB_TYPE_MATRIX_4;
+                    attribute.size = 64;
                 }else{
-                    TERROR("shader_loader_load: Invalid file layout. attribute type must be f32, vec2, vec3, vec4, i8, i16, i32, u8, u16, or u32.");
+                    TERROR("shader_loader_load: Invalid file layout. attribute type must be f32, vec2, vec3, vec4, mat4, i8, i16, i32, u8, u16, or u32.");
                     TWARN("Defaulting to f32.");
                     attribute.type = SHADER_ATTRIB_TYPE_FLOAT32;
                     attribute.size = 4;
                 }
 
+                // Parse the optional rate.
+                attribute.rate = SHADER_ATTRIBUTE_RATE_VERTEX;
+                if(field_count == 3){
+                    if(strings_equali(fields[2], "instance")){
+                        attribute.rate = SHADER_ATTRIBUTE_RATE_INSTANCE;
+                    } else if(!strings_equali(fields[2], "vertex")){
+                        TERROR("shader_loader_load: Invalid file layout. attribute rate must be vertex or instance.");
+                        TWARN("Defaulting to vertex.");
+                    }
+                }
+
                 // Take a copy of the attribute name.
                 attribute.name_length = string_length(fields[1]);
                 attribute.name = string_duplicate(fields[1]);
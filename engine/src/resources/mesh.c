@@ -68,7 +68,7 @@ b8 mesh_load_from_resource(const char* resource_name, mesh* out_mesh){
     params.out_mesh = out_mesh;
     params.mesh_resource = (resource){};
 
-    job_info job = job_create(mesh_load_job_start, mesh_load_job_success, mesh_load_job_fail, &params, sizeof(mesh_load_params), sizeof(mesh_load_params));
+    job_info job = job_create_type(mesh_load_job_start, mesh_load_job_success, mesh_load_job_fail, &params, sizeof(mesh_load_params), sizeof(mesh_load_params), JOB_TYPE_RESOURCE_LOAD);
     job_system_submit(job);
 
     return TRUE;
@@ -173,7 +173,8 @@ typedef struct mesh {
     u8 generation;
     u16 geometry_count;
     geometry** geometries;
-    transform transform;
+    /** @brief The mesh's transform, a handle from the transform system. */
+    u32 transform_handle;
 } mesh;
 
 
@@ -239,6 +240,14 @@ typedef enum shader_scope {
     SHADER_SCOPE_LOCAL = 2
 } shader_scope;
 
+/** @brief How often an attribute advances to its next value. */
+typedef enum shader_attribute_rate {
+    /** @brief Read from the vertex buffer, once per vertex. */
+    SHADER_ATTRIBUTE_RATE_VERTEX = 0,
+    /** @brief Read from the instance buffer, once per instance of an instanced draw. */
+    SHADER_ATTRIBUTE_RATE_INSTANCE = 1
+} shader_attribute_rate;
+
 /** @brief Configuration for an attribute. */
 typedef struct shader_attribute_config {
     /** @brief The length of the name. */
@@ -249,6 +258,8 @@ typedef struct shader_attribute_config {
     u8 size;
     /** @brief The type of the attribute. */
     shader_attribute_type type;
+    /** @brief How often the attribute advances. Default is per vertex if not supplied. */
+    shader_attribute_rate rate;
 } shader_attribute_config;
 
 /** @brief Configuration for an uniform. */
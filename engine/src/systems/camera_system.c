@@ -80,6 +80,8 @@ void camera_system_shutdown(void* state){
         //  
         //  }
         // }
+
+        hashtable_destroy(&s->lookup);
     }
 
     state_ptr = 0;
@@ -112,7 +114,7 @@ camera* camera_system_acquire(const char* name){
             }
 
             // Create/register the new camera.
-            TTRACE("Creating new camera named '%s'...");
+            TTRACE("Creating new camera named '%s'...", name);
             state_ptr->cameras[id].c = camera_create();
             state_ptr->cameras[id].id = id;
 
@@ -248,6 +248,10 @@ b8 create_default_geometries(geometry_system_state* state){
         return FALSE;
     }
 
+    state->default_geometry.extents.min = (vec3){-0.5f * f, -0.5f * f, 0.0f};
+    state->default_geometry.extents.max = (vec3){0.5f * f, 0.5f * f, 0.0f};
+    state->default_geometry.center = (vec3){0.0f, 0.0f, 0.0f};
+
     // Acquire the default material.
     state->default_geometry.material = material_system_get_default();
 
@@ -334,6 +338,11 @@ geometry_config geometry_system_generate_plane_config(f32 width, f32 height, u32
     f32 seg_height = height / y_segment_count;
     f32 half_width = width * 0.5f;
     f32 half_height = height * 0.5f;
+
+    config.min_extents = (vec3){-half_width, -half_height, 0.0f};
+    config.max_extents = (vec3){half_width, half_height, 0.0f};
+    config.center = (vec3){0.0f, 0.0f, 0.0f};
+
     for(u32 y = 0; y < y_segment_count; ++y){
         for(u32 x = 0; x < x_segment_count; ++x){
             // Generate vertices
@@ -2,150 +2,570 @@
 
 #include "core/tthread.h"
 #include "core/tmutex.h"
+#include "core/tsemaphore.h"
+#include "core/tatomic.h"
 #include "core/tmemory.h"
 #include "core/logger.h"
+#include "core/tstring.h"
+#include "core/profiler.h"
 #include "containers/ring_queue.h"
+#include "containers/mpsc_queue.h"
+#include "platform/platform.h"
+
+// The number of jobs each worker deque can hold. Must be a power of two.
+#define JOB_DEQUE_CAPACITY 256
+#define JOB_DEQUE_MASK (JOB_DEQUE_CAPACITY - 1)
+
+// The number of jobs each shared injection queue can hold.
+#define JOB_INJECTION_QUEUE_CAPACITY 4096
+
+// The number of job_type and job_priority values.
+#define JOB_TYPE_COUNT 3
+#define JOB_PRIORITY_COUNT 3
+
+// How many times an idle worker looks for work before going to sleep.
+#define JOB_IDLE_SPIN_COUNT 64
+
+// The max number of job batches that can be in flight at once.
+#define MAX_JOB_COUNTERS 4096
+
+/**
+ * A bounded Chase-Lev work-stealing deque. The owning thread pushes and pops
+ * at the bottom without locking; other threads steal from the top.
+ * top and bottom live on separate cache lines so thieves and the owner do not
+ * fight over the same line.
+ */
+typedef struct job_deque {
+    volatile i64 top;
+    u8 top_padding[56];
+    volatile i64 bottom;
+    u8 bottom_padding[56];
+    job_info jobs[JOB_DEQUE_CAPACITY];
+} job_deque;
 
 typedef struct job_thread {
     u8 index;
     tthread thread;
-    job_info info;
-    // A mutex to guard access to this thread's info.
-    tmutex info_mutex;
 
     // The types of jobs this thread can handle
     u32 type_mask;
+
+    // One deque per priority, holding jobs submitted from this thread.
+    job_deque* deques;
+
+    // Signalled when there may be work for this thread.
+    tsemaphore wake_semaphore;
+    // Non-zero while the thread is asleep (or about to be) on wake_semaphore.
+    volatile i32 sleeping;
 }job_thread;
 
+/** A batch of jobs waiting on a counter, submitted when it reaches zero. */
+typedef struct job_continuation {
+    struct job_continuation* next;
+    u32 count;
+    job_info jobs[];
+} job_continuation;
+
+/** Tracks how many jobs of a batch are still to finish. */
+typedef struct job_counter {
+    volatile i32 pending;
+    // Bumped when the batch completes, which invalidates every handle to it.
+    volatile i32 generation;
+    // A spin lock guarding continuations and the generation bump.
+    volatile i32 lock;
+    job_continuation* continuations;
+} job_counter;
+
+// Result data up to this size is stored inside the result queue instead of on the heap.
+#define JOB_RESULT_INLINE_SIZE 64
+
 typedef struct job_result_entry{
-    u16 id;
     pfn_job_on_complete callback;
     u32 param_size;
+    // A heap copy of the params, used only if they do not fit in inline_params.
     void* params;
+    u8 inline_params[JOB_RESULT_INLINE_SIZE];
 }job_result_entry;
 
-// The max number of job results that can be stored at once.
-#define MAX_JOB_RESULTS 512
+/** A result that did not fit in the result queue. */
+typedef struct job_result_overflow {
+    struct job_result_overflow* next;
+    job_result_entry entry;
+} job_result_overflow;
+
+// The number of results that can wait in the result queue before spilling to the overflow list.
+#define JOB_RESULT_QUEUE_CAPACITY 1024
 
 typedef struct job_system_state{
-    b8 running;
+    volatile i32 running;
     u8 thread_count;
     job_thread job_threads[32];
 
-    ring_queue low_priority_queue;
-    ring_queue normal_priority_queue;
-    ring_queue high_priority_queue;
-
-    // Mutexes for each queue, since a job could be kick off from another job (thread).
-    tmutex low_pri_queue_mutex;
-    tmutex normal_pri_queue_mutex;
-    tmutex high_pri_queue_mutex;
-
-    job_result_entry pending_results[MAX_JOB_RESULTS];
+    // Jobs submitted from threads that cannot push them onto their own deque (the main
+    // thread, or a job thread that does not handle the job's type) land here. There is
+    // one queue per type so a job that only one thread may run never blocks the rest.
+    ring_queue injection_queues[JOB_TYPE_COUNT][JOB_PRIORITY_COUNT];
+    tmutex injection_mutexes[JOB_TYPE_COUNT][JOB_PRIORITY_COUNT];
+    // Mirrors each queue's length so workers can skip empty queues without locking.
+    volatile i32 injection_counts[JOB_TYPE_COUNT][JOB_PRIORITY_COUNT];
+
+    // Where the next wakeup search starts, so wakeups are spread across threads.
+    volatile i32 next_wake_index;
+
+    job_counter counters[MAX_JOB_COUNTERS];
+    // A stack of unused counter indices.
+    u32 free_counters[MAX_JOB_COUNTERS];
+    u32 free_counter_count;
+    tmutex counter_mutex;
+
+    // Completed jobs' callbacks, waiting to be run by job_system_update.
+    mpsc_queue result_queue;
+    // Results that arrived while result_queue was full, in the order they arrived. They are
+    // handled after what is in result_queue, which may hold newer results by then, so results
+    // are only in completion order as long as the queue does not fill up.
+    job_result_overflow* overflow_head;
+    job_result_overflow* overflow_tail;
+    volatile i32 overflow_length;
+    // A mutex for the overflow list
     tmutex result_mutex;
-    // A mutex for the result array
+
+    volatile u64 results_pending;
+    volatile u64 results_peak;
+    volatile u64 results_overflowed;
 } job_system_state;
 
 static job_system_state* state_ptr;
 
+// The job thread running on the calling thread, or 0 if the caller is not a job thread.
+static _Thread_local job_thread* current_job_thread = 0;
+
+static u32 job_type_index(job_type type){
+    switch(type){
+        case JOB_TYPE_RESOURCE_LOAD:
+            return 1;
+        case JOB_TYPE_GPU_RESOURCE:
+            return 2;
+        case JOB_TYPE_GENERAL:
+        default:
+            return 0;
+    }
+}
+
+static b8 deque_push(job_deque* deque, const job_info* info){
+    i64 bottom = tatomic_load_i64(&deque->bottom, TATOMIC_RELAXED);
+    i64 top = tatomic_load_i64(&deque->top, TATOMIC_ACQUIRE);
+    if(bottom - top >= JOB_DEQUE_CAPACITY){
+        return FALSE;
+    }
+    deque->jobs[bottom & JOB_DEQUE_MASK] = *info;
+    tatomic_store_i64(&deque->bottom, bottom + 1, TATOMIC_RELEASE);
+    return TRUE;
+}
+
+static b8 deque_pop(job_deque* deque, u32 type_mask, job_info* out_info){
+    // Leave the job in place if it is not of a type wanted. Only the owner writes the slots,
+    // so the type can be read before claiming the job.
+    i64 last = tatomic_load_i64(&deque->bottom, TATOMIC_RELAXED) - 1;
+    if(last < tatomic_load_i64(&deque->top, TATOMIC_ACQUIRE) || (deque->jobs[last & JOB_DEQUE_MASK].type & type_mask) == 0){
+        return FALSE;
+    }
+
+    i64 bottom = last;
+    tatomic_store_i64(&deque->bottom, bottom, TATOMIC_RELAXED);
+    tatomic_thread_fence(TATOMIC_SEQ_CST);
+    i64 top = tatomic_load_i64(&deque->top, TATOMIC_RELAXED);
+
+    if(top > bottom){
+        // Empty.
+        tatomic_store_i64(&deque->bottom, bottom + 1, TATOMIC_RELAXED);
+        return FALSE;
+    }
+
+    *out_info = deque->jobs[bottom & JOB_DEQUE_MASK];
+    if(top == bottom){
+        // Last job, so race any thieves for it.
+        b8 won = tatomic_compare_exchange_i64(&deque->top, &top, top + 1, TATOMIC_SEQ_CST);
+        tatomic_store_i64(&deque->bottom, bottom + 1, TATOMIC_RELAXED);
+        return won;
+    }
+    return TRUE;
+}
+
+static b8 deque_steal(job_deque* deque, u32 type_mask, job_info* out_info){
+    i64 top = tatomic_load_i64(&deque->top, TATOMIC_ACQUIRE);
+    tatomic_thread_fence(TATOMIC_SEQ_CST);
+    i64 bottom = tatomic_load_i64(&deque->bottom, TATOMIC_ACQUIRE);
+    if(top >= bottom){
+        return FALSE;
+    }
+
+    job_info info = deque->jobs[top & JOB_DEQUE_MASK];
+    // Leave jobs this thread cannot run for their owner.
+    if((info.type & type_mask) == 0){
+        return FALSE;
+    }
+    if(!tatomic_compare_exchange_i64(&deque->top, &top, top + 1, TATOMIC_SEQ_CST)){
+        return FALSE;
+    }
+    *out_info = info;
+    return TRUE;
+}
+
+static b8 injection_push(const job_info* info){
+    u32 type = job_type_index(info->type);
+    tmutex* mutex = &state_ptr->injection_mutexes[type][info->priority];
+    ring_queue* queue = &state_ptr->injection_queues[type][info->priority];
+
+    if(!tmutex_lock(mutex)){
+        TERROR("Failed to obtain lock on queue mutex!");
+    }
+    b8 pushed = FALSE;
+    if(queue->length < queue->capacity){
+        pushed = ring_queue_enqueue(queue, (void*)info);
+        tatomic_fetch_add_i32(&state_ptr->injection_counts[type][info->priority], 1, TATOMIC_SEQ_CST);
+    }
+    if(!tmutex_unlock(mutex)){
+        TERROR("Failed to release lock on queue mutex!");
+    }
+    return pushed;
+}
+
+static b8 injection_pop(u32 type, job_priority priority, job_info* out_info){
+    if(tatomic_load_i32(&state_ptr->injection_counts[type][priority], TATOMIC_SEQ_CST) <= 0){
+        return FALSE;
+    }
+
+    tmutex* mutex = &state_ptr->injection_mutexes[type][priority];
+    ring_queue* queue = &state_ptr->injection_queues[type][priority];
+    if(!tmutex_lock(mutex)){
+        TERROR("Failed to obtain lock on queue mutex!");
+    }
+    b8 popped = FALSE;
+    if(queue->length > 0){
+        popped = ring_queue_dequeue(queue, out_info);
+        tatomic_fetch_add_i32(&state_ptr->injection_counts[type][priority], -1, TATOMIC_SEQ_CST);
+    }
+    if(!tmutex_unlock(mutex)){
+        TERROR("Failed to release lock on queue mutex!");
+    }
+    return popped;
+}
+
+/**
+ * Finds the next job for the given thread, or for a thread that is not a job thread
+ * (such as the main thread helping out while it waits) if thread is 0. Priorities are
+ * exhausted from high to low; within a priority the thread's own deque comes first,
+ * then the shared injection queues for its types, then stealing from the other threads.
+ */
+static b8 acquire_job(job_thread* thread, u32 type_mask, job_info* out_info){
+    u8 thread_count = state_ptr->thread_count;
+    u8 first_victim = thread ? thread->index + 1 : 0;
+    u8 victim_count = thread ? thread_count - 1 : thread_count;
+
+    for(i32 priority = JOB_PRIORITY_HIGH; priority >= JOB_PRIORITY_LOW; --priority){
+        if(thread && deque_pop(&thread->deques[priority], type_mask, out_info)){
+            return TRUE;
+        }
+
+        for(u32 type = 0; type < JOB_TYPE_COUNT; ++type){
+            if((type_mask & (JOB_TYPE_GENERAL << type)) && injection_pop(type, priority, out_info)){
+                return TRUE;
+            }
+        }
+
+        for(u8 i = 0; i < victim_count; ++i){
+            job_thread* victim = &state_ptr->job_threads[(first_victim + i) % thread_count];
+            if(deque_steal(&victim->deques[priority], type_mask, out_info)){
+                return TRUE;
+            }
+        }
+    }
+    return FALSE;
+}
+
+/**
+ * Wakes one sleeping thread that can run jobs of the given type, if there is one.
+ * If every capable thread is awake, they will find the job before going back to sleep.
+ */
+static void wake_thread_for(job_type type){
+    // Pairs with the fence in job_thread_run, so either the sleeping thread sees the
+    // newly pushed job, or this sees the thread's sleeping flag.
+    tatomic_thread_fence(TATOMIC_SEQ_CST);
+
+    u8 thread_count = state_ptr->thread_count;
+    u32 start = (u32)tatomic_fetch_add_i32(&state_ptr->next_wake_index, 1, TATOMIC_RELAXED);
+    for(u8 i = 0; i < thread_count; ++i){
+        job_thread* thread = &state_ptr->job_threads[(start + i) % thread_count];
+        if((thread->type_mask & type) == 0 || thread == current_job_thread){
+            continue;
+        }
+        i32 expected = 1;
+        if(tatomic_compare_exchange_i32(&thread->sleeping, &expected, 0, TATOMIC_SEQ_CST)){
+            tsemaphore_signal(&thread->wake_semaphore);
+            return;
+        }
+    }
+}
+
+static void counter_lock(job_counter* counter){
+    i32 expected = 0;
+    while(!tatomic_compare_exchange_i32(&counter->lock, &expected, 1, TATOMIC_ACQUIRE)){
+        expected = 0;
+        tatomic_pause();
+    }
+}
+
+static void counter_unlock(job_counter* counter){
+    tatomic_store_i32(&counter->lock, 0, TATOMIC_RELEASE);
+}
+
+/**
+ * Runs one queued job on the calling thread, if there is one it is allowed to run.
+ * Used by threads that would otherwise sit idle waiting on other jobs.
+ */
+static b8 help_run_job();
+
+static job_handle counter_allocate(u32 pending){
+    job_handle handle;
+    while(TRUE){
+        if(!tmutex_lock(&state_ptr->counter_mutex)){
+            TERROR("Failed to obtain lock on counter mutex!");
+        }
+        b8 found = state_ptr->free_counter_count > 0;
+        if(found){
+            handle.index = state_ptr->free_counters[--state_ptr->free_counter_count];
+        }
+        if(!tmutex_unlock(&state_ptr->counter_mutex)){
+            TERROR("Failed to release lock on counter mutex!");
+        }
+        if(found){
+            break;
+        }
+
+        // Every counter is in use, so help finish some batches until one frees up.
+        if(!help_run_job()){
+            platform_sleep(0);
+        }
+    }
+
+    job_counter* counter = &state_ptr->counters[handle.index];
+    counter->continuations = 0;
+    tatomic_store_i32(&counter->pending, (i32)pending, TATOMIC_RELEASE);
+    handle.generation = (u32)tatomic_load_i32(&counter->generation, TATOMIC_ACQUIRE);
+    return handle;
+}
+
+/** Called when the last job of a batch finishes. Releases the counter and submits any follow-up jobs. */
+static void counter_complete(u32 index){
+    job_counter* counter = &state_ptr->counters[index];
+
+    counter_lock(counter);
+    job_continuation* continuation = counter->continuations;
+    counter->continuations = 0;
+    tatomic_fetch_add_i32(&counter->generation, 1, TATOMIC_RELEASE);
+    counter_unlock(counter);
+
+    if(!tmutex_lock(&state_ptr->counter_mutex)){
+        TERROR("Failed to obtain lock on counter mutex!");
+    }
+    state_ptr->free_counters[state_ptr->free_counter_count++] = index;
+    if(!tmutex_unlock(&state_ptr->counter_mutex)){
+        TERROR("Failed to release lock on counter mutex!");
+    }
+
+    while(continuation){
+        job_continuation* next = continuation->next;
+        for(u32 i = 0; i < continuation->count; ++i){
+            job_system_submit(continuation->jobs[i]);
+        }
+        tfree(continuation, sizeof(job_continuation) + sizeof(job_info) * continuation->count, MEMORY_TAG_JOB);
+        continuation = next;
+    }
+}
+
 void store_result(pfn_job_on_complete callback, u32 param_size, void* params){
     // Create the new entry.
     job_result_entry entry;
-    entry.id = INVALID_ID_U16;
     entry.param_size = param_size;
     entry.callback = callback;
-    if (entry.param_size > 0){
+    entry.params = 0;
+    if(param_size > JOB_RESULT_INLINE_SIZE){
         // Take a copy, as the job is destroyed after this.
         entry.params = tallocate(param_size, MEMORY_TAG_JOB);
         tcopy_memory(entry.params, params, param_size);
-    }else {
-        entry.params = 0;
+    }else if(param_size > 0){
+        tcopy_memory(entry.inline_params, params, param_size);
+    }
+
+    u64 pending = tatomic_fetch_add_u64(&state_ptr->results_pending, 1, TATOMIC_RELAXED) + 1;
+    tatomic_max_u64(&state_ptr->results_peak, pending);
+
+    if(mpsc_queue_enqueue(&state_ptr->result_queue, &entry)){
+        return;
     }
 
-    // Lock, find a free  space, store, unlock
+    // The queue is full, so spill to the overflow list rather than lose the result.
+    job_result_overflow* overflow = tallocate(sizeof(job_result_overflow), MEMORY_TAG_JOB);
+    overflow->entry = entry;
+    overflow->next = 0;
     if(!tmutex_lock(&state_ptr->result_mutex)){
         TERROR("Failed to obtain mutex lock for storing a result! Result storage may be corrupted.");
     }
-    for(u16 i = 0; i < MAX_JOB_RESULTS; ++i){
-        if(state_ptr->pending_results[i].id == INVALID_ID_U16){
-            state_ptr->pending_results[i] = entry;
-            state_ptr->pending_results[i].id = i;
-            break;
-        }
+    if(state_ptr->overflow_tail){
+        state_ptr->overflow_tail->next = overflow;
+    }else{
+        state_ptr->overflow_head = overflow;
     }
+    state_ptr->overflow_tail = overflow;
+    tatomic_fetch_add_i32(&state_ptr->overflow_length, 1, TATOMIC_RELEASE);
     if(!tmutex_unlock(&state_ptr->result_mutex)){
         TERROR("Failed to release mutex lock for result storage, storage may be corrupted.");
     }
+    tatomic_fetch_add_u64(&state_ptr->results_overflowed, 1, TATOMIC_RELAXED);
 }
 
-u32 job_thread_run(void* params){
-    u32 index = *(u32*)params;
-    job_thread* thread = &state_ptr->job_threads[index];
-    u64 thread_id = thread->thread.thread_id;
-    TTRACE("Starting job thread %#i (id=%#i, type=%#x).", thread->index, thread_id, thread->type_mask);
+/** Runs the callback of a stored result (if requested) and releases its data. */
+static void process_result(job_result_entry* entry, b8 run_callback){
+    void* params = entry->param_size > JOB_RESULT_INLINE_SIZE ? entry->params : entry->inline_params;
+    if(run_callback){
+        entry->callback(entry->param_size ? params : 0);
+    }
+    if(entry->params){
+        tfree(entry->params, entry->param_size, MEMORY_TAG_JOB);
+    }
+    tatomic_fetch_add_u64(&state_ptr->results_pending, (u64)-1, TATOMIC_RELAXED);
+}
 
-    // A mutex to lock info for this thread.
-    if(!tmutex_create(&thread->info_mutex)){
-        TERROR("Failed to create job thread mutex! Aborting thread.");
-        return 0;
+/**
+ * Processes every result stored so far. Only results present when this starts are processed.
+ * The queue is handled before the overflow list, so callbacks of results that overflowed may
+ * run after those of newer results.
+ */
+static void process_results(b8 run_callbacks){
+    u32 queued = mpsc_queue_length(&state_ptr->result_queue);
+    job_result_entry entry;
+    for(u32 i = 0; i < queued && mpsc_queue_dequeue(&state_ptr->result_queue, &entry); ++i){
+        process_result(&entry, run_callbacks);
     }
 
-    // Run forever, waiting for jobs.
-    while(TRUE){
-        if(!state_ptr || !state_ptr->running || !thread){
-            break;
+    if(tatomic_load_i32(&state_ptr->overflow_length, TATOMIC_ACQUIRE) > 0){
+        // Take the whole list at once so the lock is not held while callbacks run.
+        if(!tmutex_lock(&state_ptr->result_mutex)){
+            TERROR("Failed to obtain lock on result mutex!");
+        }
+        job_result_overflow* overflow = state_ptr->overflow_head;
+        state_ptr->overflow_head = 0;
+        state_ptr->overflow_tail = 0;
+        tatomic_store_i32(&state_ptr->overflow_length, 0, TATOMIC_RELEASE);
+        if(!tmutex_unlock(&state_ptr->result_mutex)){
+            TERROR("Failed to release lock on result mutex!");
         }
 
-        // Lock and grab a copy of the info
-        if(!tmutex_lock(&thread->info_mutex)){
-            TERROR("Failed to obtain lock on job thread mutex!");
+        while(overflow){
+            job_result_overflow* next = overflow->next;
+            process_result(&overflow->entry, run_callbacks);
+            tfree(overflow, sizeof(job_result_overflow), MEMORY_TAG_JOB);
+            overflow = next;
         }
-        job_info info = thread->info;
-        if(!tmutex_unlock(&thread->info_mutex)){
-            TERROR("Failed to release lock on job thread mutex!");
+    }
+}
+
+/** Releases the param and result data a job carries. */
+static void job_data_free(job_info* info){
+    if(info->param_data){
+        tfree(info->param_data, info->param_data_size, MEMORY_TAG_JOB);
+    }
+    if(info->result_data){
+        tfree(info->result_data, info->result_data_size, MEMORY_TAG_JOB);
+    }
+}
+
+static void run_job(job_info* info){
+    TPROFILE_BEGIN("job");
+    b8 result = info->entry_point(info->param_data, info->result_data);
+    TPROFILE_END();
+
+    // Store the result to be executed on the main thread later.
+    // Note that store_result takes a copy of the result_data
+    // so it does not have to be held onto by this thread any longer.
+    if(result && info->on_success){
+        store_result(info->on_success, info->result_data_size, info->result_data);
+    } else if(!result && info->on_fail){
+        store_result(info->on_fail, info->result_data_size, info->result_data);
+    }
+
+    // Clear the param data and result data.
+    job_data_free(info);
+
+    // The last job of a batch releases everything waiting on it.
+    if(info->counter_index != INVALID_ID){
+        job_counter* counter = &state_ptr->counters[info->counter_index];
+        if(tatomic_fetch_add_i32(&counter->pending, -1, TATOMIC_ACQ_REL) == 1){
+            counter_complete(info->counter_index);
         }
+    }
+}
 
-        if(info.entry_point){
-            b8 result = info.entry_point(info.param_data, info.result_data);
+static b8 help_run_job(){
+    job_thread* thread = current_job_thread;
+    // Only general jobs are picked up, even by job threads that run other types. The other
+    // types are meant to stay on their dedicated threads, and a resource load, say, would
+    // hold up whatever is waiting for far longer than the jobs it is waiting on.
+    u32 type_mask = thread ? thread->type_mask & JOB_TYPE_GENERAL : JOB_TYPE_GENERAL;
 
-            // Store the result to be executed on the main thread later.
-            // Note that store_result takes a copy of the result_data
-            // so it does not have to be held onto by this thread any longer.
-            if(result && info.on_success){
-                store_result(info.on_success, info.result_data_size, info.result_data);
-            } else if(!result && info.on_fail){
-                store_result(info.on_fail, info.result_data_size, info.result_data);
-            }
+    job_info info;
+    if(acquire_job(thread, type_mask, &info)){
+        run_job(&info);
+        return TRUE;
+    }
+    return FALSE;
+}
 
-            // Clear the param data and result data.
-            if(info.param_data){
-                tfree(info.param_data, info.param_data_size, MEMORY_TAG_JOB);
-            }
-            if(info.result_data){
-                tfree(info.result_data, info.result_data_size, MEMORY_TAG_JOB);
-            }
+u32 job_thread_run(void* params){
+    job_thread* thread = (job_thread*)params;
+    current_job_thread = thread;
+    TTRACE("Starting job thread %i (id=%llu, type=%#x).", thread->index, get_thread_id(), thread->type_mask);
 
-            // Lock and reset the thread's info object
-            if(!tmutex_lock(&thread->info_mutex)){
-                TERROR("Failed to obtain lock on job thread mutex!");
-            }
-            tzero_memory(&thread->info, sizeof(job_info));
-            if(!tmutex_unlock(&thread->info_mutex)){
-                TERROR("Failed to release lock on job thread mutex!");
-            }
+    char profiler_name[32];
+    string_format(profiler_name, "job thread %u", thread->index);
+    profiler_set_thread_name(profiler_name);
+
+    // Run until shutdown, sleeping whenever there is nothing to do.
+    u32 idle_spins = 0;
+    while(tatomic_load_i32(&state_ptr->running, TATOMIC_ACQUIRE)){
+        job_info info;
+        if(acquire_job(thread, thread->type_mask, &info)){
+            idle_spins = 0;
+            run_job(&info);
+            continue;
         }
 
-        if(state_ptr->running){
-            // TODO: Should probably find a better way to do this, such as sleeping until
-            // a request comes throught for a new job.
-            tthread_sleep(&thread->thread, 10);
-        }else {
+        // Spin briefly first, since another job often shows up right away.
+        if(idle_spins < JOB_IDLE_SPIN_COUNT){
+            idle_spins++;
+            tatomic_pause();
+            continue;
+        }
+        idle_spins = 0;
+
+        // Announce the thread is going to sleep, then look once more so that a job
+        // submitted in between is not missed.
+        tatomic_store_i32(&thread->sleeping, 1, TATOMIC_SEQ_CST);
+        tatomic_thread_fence(TATOMIC_SEQ_CST);
+        if(acquire_job(thread, thread->type_mask, &info)){
+            tatomic_store_i32(&thread->sleeping, 0, TATOMIC_SEQ_CST);
+            run_job(&info);
+            continue;
+        }
+        if(!tatomic_load_i32(&state_ptr->running, TATOMIC_ACQUIRE)){
             break;
         }
+
+        tsemaphore_wait(&thread->wake_semaphore, TSEMAPHORE_WAIT_INFINITE);
+        tatomic_store_i32(&thread->sleeping, 0, TATOMIC_SEQ_CST);
     }
 
-    // Destroy the mutex for this thread.
-    tmutex_destroy(&thread->info_mutex);
+    current_job_thread = 0;
     return 1;
 }
 
@@ -159,46 +579,58 @@ b8 job_system_initialize(u64* job_system_memory_requirement, void* state, u8 job
 
     state_ptr = state;
     state_ptr->running = TRUE;
-
-    ring_queue_create(sizeof(job_info), 1024, 0, &state_ptr->low_priority_queue);
-    ring_queue_create(sizeof(job_info), 1024, 0, &state_ptr->normal_priority_queue);
-    ring_queue_create(sizeof(job_info), 1024, 0, &state_ptr->high_priority_queue);
     state_ptr->thread_count = job_thread_count;
 
-    // Invalidate all result slots
-    for(u16 i = 0; i < MAX_JOB_RESULTS; ++i){
-        state_ptr->pending_results[i].id = INVALID_ID_U16;
+    if(!mpsc_queue_create(sizeof(job_result_entry), JOB_RESULT_QUEUE_CAPACITY, 0, &state_ptr->result_queue)){
+        TERROR("Failed to create job result queue!");
+        return FALSE;
     }
 
-    TDEBUG("Main thread id is: %#x", get_thread_id());
-    TDEBUG("Spawing %i job threads.", state_ptr->thread_count);
-
-    for(u8 i = 0; i < state_ptr->thread_count; ++i){
-        state_ptr->job_threads[i].index = i;
-        state_ptr->job_threads[i].type_mask = type_masks[i];
-        if(!tthread_create(job_thread_run, &state_ptr->job_threads[i].index, FALSE, &state_ptr->job_threads[i].thread)){
-            TFATAL("OS Error in creating job thread. Application cannot continue.");
-            return FALSE;
-        }
-        tzero_memory(&state_ptr->job_threads[i].info, sizeof(job_info));
+    // All counters start out free.
+    for(u32 i = 0; i < MAX_JOB_COUNTERS; ++i){
+        state_ptr->free_counters[i] = MAX_JOB_COUNTERS - 1 - i;
     }
+    state_ptr->free_counter_count = MAX_JOB_COUNTERS;
 
-    // Create needed mutexes
+    // Create needed queues and mutexes
     if(!tmutex_create(&state_ptr->result_mutex)){
         TERROR("Failed to create result mutex!.");
         return FALSE;
     }
-    if(!tmutex_create(&state_ptr->low_pri_queue_mutex)){
-        TERROR("Failed to create low priority queue mutex!.");
+    if(!tmutex_create(&state_ptr->counter_mutex)){
+        TERROR("Failed to create counter mutex!.");
         return FALSE;
     }
-    if(!tmutex_create(&state_ptr->normal_pri_queue_mutex)){
-        TERROR("Failed to create normal priority queue mutex!.");
-        return FALSE;
+    for(u32 type = 0; type < JOB_TYPE_COUNT; ++type){
+        for(u32 priority = 0; priority < JOB_PRIORITY_COUNT; ++priority){
+            ring_queue_create(sizeof(job_info), JOB_INJECTION_QUEUE_CAPACITY, 0, &state_ptr->injection_queues[type][priority]);
+            if(!tmutex_create(&state_ptr->injection_mutexes[type][priority])){
+                TERROR("Failed to create job queue mutex!.");
+                return FALSE;
+            }
+        }
     }
-    if(!tmutex_create(&state_ptr->high_pri_queue_mutex)){
-        TERROR("Failed to create high priority queue mutex!.");
-        return FALSE;
+
+    TDEBUG("Main thread id is: %#llx", get_thread_id());
+    TDEBUG("Spawing %i job threads.", state_ptr->thread_count);
+
+    // Set up every thread before starting any, since threads steal from each other.
+    for(u8 i = 0; i < state_ptr->thread_count; ++i){
+        job_thread* thread = &state_ptr->job_threads[i];
+        thread->index = i;
+        thread->type_mask = type_masks[i];
+        thread->deques = tallocate(sizeof(job_deque) * JOB_PRIORITY_COUNT, MEMORY_TAG_JOB);
+        if(!tsemaphore_create(&thread->wake_semaphore, 1024, 0)){
+            TERROR("Failed to create job thread semaphore!");
+            return FALSE;
+        }
+    }
+
+    for(u8 i = 0; i < state_ptr->thread_count; ++i){
+        if(!tthread_create(job_thread_run, &state_ptr->job_threads[i], FALSE, &state_ptr->job_threads[i].thread)){
+            TFATAL("OS Error in creating job thread. Application cannot continue.");
+            return FALSE;
+        }
     }
 
     return TRUE;
@@ -206,173 +638,249 @@ b8 job_system_initialize(u64* job_system_memory_requirement, void* state, u8 job
 
 void job_system_shutdown(void* state){
     if(state_ptr){
-        state_ptr->running = FALSE;
+        tatomic_store_i32(&state_ptr->running, FALSE, TATOMIC_SEQ_CST);
 
-        u64 thread_count = state_ptr->thread_count;
+        u8 thread_count = state_ptr->thread_count;
 
-        // Check for a free thread first.
+        // Wake every thread so it sees the system stopping, then wait for it to exit.
         for(u8 i = 0; i < thread_count; ++i){
-            tthread_destroy(&state_ptr->job_threads[i].thread);
+            tsemaphore_signal(&state_ptr->job_threads[i].wake_semaphore);
         }
-        ring_queue_destroy(&state_ptr->low_priority_queue);
-        ring_queue_destroy(&state_ptr->normal_priority_queue);
-        ring_queue_destroy(&state_ptr->high_priority_queue);
-
-        // Destoy mutexes
-        tmutex_destroy(&state_ptr->result_mutex);
-        tmutex_destroy(&state_ptr->low_pri_queue_mutex);
-        tmutex_destroy(&state_ptr->normal_pri_queue_mutex);
-        tmutex_destroy(&state_ptr->high_pri_queue_mutex);
-
-        state_ptr = 0;
-    }
-}
-
-void process_queue(ring_queue* queue, tmutex* queue_mutex){
-    u64 thread_count = state_ptr->thread_count;
-
-    // Check for a free thread first
-    while(queue->length > 0){
-        job_info info;
-        if(!ring_queue_peek(queue, &info)){
-            break;
+        for(u8 i = 0; i < thread_count; ++i){
+            tthread_wait(&state_ptr->job_threads[i].thread);
         }
-
-        b8 thread_found = FALSE;
+        // Only release per-thread resources once every thread has stopped stealing.
+        // Jobs still queued never run, but their data has to go.
         for(u8 i = 0; i < thread_count; ++i){
             job_thread* thread = &state_ptr->job_threads[i];
-            if((thread->type_mask & info.type) == 0){
-                continue;
+            for(u32 priority = 0; priority < JOB_PRIORITY_COUNT; ++priority){
+                job_deque* deque = &thread->deques[priority];
+                for(i64 j = deque->top; j < deque->bottom; ++j){
+                    job_data_free(&deque->jobs[j & JOB_DEQUE_MASK]);
+                }
             }
+            tsemaphore_destroy(&thread->wake_semaphore);
+            tfree(thread->deques, sizeof(job_deque) * JOB_PRIORITY_COUNT, MEMORY_TAG_JOB);
+            thread->deques = 0;
+        }
 
-            // Check that the job thread can handle the job type.
-            if(!tmutex_lock(&thread->info_mutex)){
-                TERROR("Failed to obtain lock on job thread mutex!");
+        for(u32 type = 0; type < JOB_TYPE_COUNT; ++type){
+            for(u32 priority = 0; priority < JOB_PRIORITY_COUNT; ++priority){
+                ring_queue* queue = &state_ptr->injection_queues[type][priority];
+                job_info info;
+                while(queue->length > 0 && ring_queue_dequeue(queue, &info)){
+                    job_data_free(&info);
+                }
+                ring_queue_destroy(queue);
+                tmutex_destroy(&state_ptr->injection_mutexes[type][priority]);
             }
+        }
 
-            if(!thread->info.entry_point){
-                // Make sure to remove the entry from the queue.
-                if(!tmutex_lock(queue_mutex)){
-                    TERROR("Failed to obtain lock on queue mutex!");
-                }
-                ring_queue_dequeue(queue,&info);
-                if(!tmutex_unlock(queue_mutex)){
-                    TERROR("Failed to release lock on queue mutex!");
+        // Release follow-up jobs that never got to run.
+        for(u32 i = 0; i < MAX_JOB_COUNTERS; ++i){
+            job_continuation* continuation = state_ptr->counters[i].continuations;
+            while(continuation){
+                job_continuation* next = continuation->next;
+                for(u32 j = 0; j < continuation->count; ++j){
+                    job_data_free(&continuation->jobs[j]);
                 }
-                thread->info = info;
-                TTRACE("Assigning job to thread: %u", thread->index);
-                thread_found = TRUE;
+                tfree(continuation, sizeof(job_continuation) + sizeof(job_info) * continuation->count, MEMORY_TAG_JOB);
+                continuation = next;
             }
+        }
 
-            if(!tmutex_unlock(&thread->info_mutex)){
-                TERROR("Failed to release lock on job thread mutex!");
-            }
+        // Release results that were never processed, without running their callbacks.
+        process_results(FALSE);
+        mpsc_queue_destroy(&state_ptr->result_queue);
 
-            // Break after unlocking if an available thread was found.
-            if(thread_found){
-                break;
-            }
-        }
+        // Destoy mutexes
+        tmutex_destroy(&state_ptr->result_mutex);
+        tmutex_destroy(&state_ptr->counter_mutex);
 
-        // This means all of the threads are currently handling a job,
-        // So wait until the next update and try again.
-        if(!thread_found){
-            break;
-        }
+        state_ptr = 0;
     }
 }
 
 void job_system_update(){
+    TPROFILE_SCOPE("job_system_update");
     if(!state_ptr || !state_ptr->running){
         return;
     }
 
-    process_queue(&state_ptr->high_priority_queue, &state_ptr->high_pri_queue_mutex);
-    process_queue(&state_ptr->normal_priority_queue, &state_ptr->normal_pri_queue_mutex);
-    process_queue(&state_ptr->low_priority_queue, &state_ptr->low_pri_queue_mutex);
+    // Jobs are picked up by the job threads as soon as they are submitted,
+    // so all that is left here is running the completion callbacks.
+    process_results(TRUE);
+}
 
-    // Process pending results.
-    for(u16 i = 0; i < MAX_JOB_RESULTS; ++i){
-        // Lock and take a copy, unlock
-        if(!tmutex_lock(&state_ptr->result_mutex)){
-            TERROR("Failed to obtain lock on result mutex!");
-        }
-        job_result_entry entry = state_ptr->pending_results[i];
-        if(!tmutex_unlock(&state_ptr->result_mutex)){
-            TERROR("Failed to release lock on result mutex!");
+void job_system_get_result_stats(job_result_stats* out_stats){
+    if(!out_stats){
+        return;
+    }
+    if(!state_ptr){
+        tzero_memory(out_stats, sizeof(job_result_stats));
+        return;
+    }
+    out_stats->pending_count = tatomic_load_u64(&state_ptr->results_pending, TATOMIC_RELAXED);
+    out_stats->peak_pending_count = tatomic_load_u64(&state_ptr->results_peak, TATOMIC_RELAXED);
+    out_stats->overflow_count = tatomic_load_u64(&state_ptr->results_overflowed, TATOMIC_RELAXED);
+}
+
+void job_system_submit(job_info info){
+    job_thread* thread = current_job_thread;
+
+    // Job threads push work they can run themselves onto their own deque, where
+    // it is cheapest to reach and where idle threads can steal it.
+    if(thread && (thread->type_mask & info.type) && deque_push(&thread->deques[info.priority], &info)){
+        wake_thread_for(info.type);
+        return;
+    }
+
+    while(!injection_push(&info)){
+        // The queue is full. A job thread that can run the job does it right away
+        // instead of waiting on the others, anyone else waits for space.
+        if(thread && (thread->type_mask & info.type)){
+            run_job(&info);
+            return;
         }
+        wake_thread_for(info.type);
+        platform_sleep(0);
+    }
+    wake_thread_for(info.type);
+}
 
-        if(entry.id != INVALID_ID_U16){
-            // Execute the callback.
-            entry.callback(entry.params);
+job_handle job_system_submit_batch(const job_info* jobs, u32 count){
+    job_handle none = {INVALID_ID, 0};
+    return job_system_submit_batch_after(none, jobs, count);
+}
 
-            if(entry.params){
-                tfree(entry.params, entry.param_size, MEMORY_TAG_JOB);
-            }
+job_handle job_system_submit_batch_after(job_handle dependency, const job_info* jobs, u32 count){
+    job_handle handle = {INVALID_ID, 0};
+    if(!jobs || count == 0){
+        return handle;
+    }
 
-            // Lock actual entry, invalidate and clear it
-            if(!tmutex_lock(&state_ptr->result_mutex)){
-                TERROR("Failed to obtain lock on result mutex!");
-            }
-            tzero_memory(&state_ptr->pending_results[i], sizeof(job_result_entry));
-            state_ptr->pending_results[i].id = INVALID_ID_U16;
-            if(!tmutex_unlock(&state_ptr->result_mutex)){
-                TERROR("Failed to release on result mutex!");
+    handle = counter_allocate(count);
+
+    // Park the batch on the dependency if it is still running. The dependency's lock
+    // makes this and its completion mutually exclusive, so the batch cannot be missed.
+    if(!job_system_is_complete(dependency)){
+        job_counter* counter = &state_ptr->counters[dependency.index];
+        counter_lock(counter);
+        if((u32)tatomic_load_i32(&counter->generation, TATOMIC_ACQUIRE) == dependency.generation){
+            job_continuation* continuation = tallocate(sizeof(job_continuation) + sizeof(job_info) * count, MEMORY_TAG_JOB);
+            continuation->count = count;
+            for(u32 i = 0; i < count; ++i){
+                continuation->jobs[i] = jobs[i];
+                continuation->jobs[i].counter_index = handle.index;
             }
+            continuation->next = counter->continuations;
+            counter->continuations = continuation;
+            counter_unlock(counter);
+            return handle;
         }
+        counter_unlock(counter);
+    }
+
+    for(u32 i = 0; i < count; ++i){
+        job_info info = jobs[i];
+        info.counter_index = handle.index;
+        job_system_submit(info);
     }
+    return handle;
 }
 
-void job_system_submit(job_info info){
-    u64 thread_count = state_ptr->thread_count;
-    ring_queue* queue = &state_ptr->normal_priority_queue;
-    tmutex* queue_mutex = &state_ptr->normal_pri_queue_mutex;
+b8 job_system_is_complete(job_handle handle){
+    if(!state_ptr || handle.index == INVALID_ID){
+        return TRUE;
+    }
+    return (u32)tatomic_load_i32(&state_ptr->counters[handle.index].generation, TATOMIC_ACQUIRE) != handle.generation;
+}
 
-    // If the job is high priority, try to kick it off immediately.
-    if(info.priority == JOB_PRIORITY_HIGH){
-        queue = &state_ptr->high_priority_queue;
-        queue_mutex = &state_ptr->high_pri_queue_mutex;
+void job_system_wait(job_handle handle){
+    u32 idle_spins = 0;
+    while(!job_system_is_complete(handle)){
+        if(help_run_job()){
+            idle_spins = 0;
+        }else if(idle_spins < JOB_IDLE_SPIN_COUNT){
+            idle_spins++;
+            tatomic_pause();
+        }else{
+            // The remaining jobs are running elsewhere, so give up the time slice.
+            platform_sleep(0);
+        }
+    }
+}
 
-        // Check for a free thread that supports the job type first.
-        for(u8 i = 0; i < thread_count; ++i){
-            job_thread* thread = &state_ptr->job_threads[i];
-            
-            if(state_ptr->job_threads[i].type_mask & info.type){
-                b8 found = FALSE;
-                if(!tmutex_lock(&thread->info_mutex)){
-                    TERROR("Failed to obtain lock on job thread mutex!");
-                }
-                if(!state_ptr->job_threads[i].info.entry_point){
-                    TTRACE("Job immediately submitted on thread %i", state_ptr->job_threads[i].index);
-                    state_ptr->job_threads[i].info = info;
-                    found = TRUE;
-                }
-                if(!tmutex_unlock(&thread->info_mutex)){
-                    TERROR("Failed to release lock on job thread mutex!");
-                }
-                if(found){
-                    return;
-                }
-            }
+typedef struct parallel_for_state {
+    pfn_parallel_for fn;
+    void* user_data;
+    u32 count;
+    u32 grain;
+    u32 chunk_count;
+    // The next chunk to be claimed.
+    volatile i32 next_chunk;
+} parallel_for_state;
+
+static void parallel_for_run_chunks(parallel_for_state* pf){
+    while(TRUE){
+        u32 chunk = (u32)tatomic_fetch_add_i32(&pf->next_chunk, 1, TATOMIC_RELAXED);
+        if(chunk >= pf->chunk_count){
+            return;
         }
+        u32 begin = chunk * pf->grain;
+        u32 end = begin + pf->grain < pf->count ? begin + pf->grain : pf->count;
+        pf->fn(begin, end, pf->user_data);
     }
+}
 
-    // If this point is reached, all threads are busy (if high) or it can wait a frame.
-    // Add to the queue and try again next cycle.
-    if(info.priority == JOB_PRIORITY_LOW){
-        queue = &state_ptr->low_priority_queue;
-        queue_mutex = &state_ptr->low_pri_queue_mutex;
+static b8 parallel_for_job(void* params, void* result_data){
+    parallel_for_run_chunks(*(parallel_for_state**)params);
+    return TRUE;
+}
+
+void job_system_parallel_for(u32 count, u32 grain, pfn_parallel_for fn, void* user_data){
+    if(count == 0 || !fn){
+        return;
     }
 
-    // NOTE: Locking here in case the job is submitted from another job/thread.
-    if(!tmutex_lock(queue_mutex)){
-        TERROR("Failed to obtain lock on queue mutex!");
+    parallel_for_state pf;
+    pf.fn = fn;
+    pf.user_data = user_data;
+    pf.count = count;
+    pf.grain = grain ? grain : 1;
+    pf.chunk_count = (count + pf.grain - 1) / pf.grain;
+    pf.next_chunk = 0;
+
+    // Chunks are claimed from a shared cursor rather than handed out up front, so one
+    // helper job per thread is enough and a slow thread just ends up claiming fewer.
+    u32 helper_count = state_ptr ? pf.chunk_count - 1 : 0;
+    if(state_ptr && helper_count > state_ptr->thread_count){
+        helper_count = state_ptr->thread_count;
     }
-    ring_queue_enqueue(queue, &info);
-    if(!tmutex_unlock(queue_mutex)){
-        TERROR("Failed to release lock on queue mutex!");
+    if(helper_count == 0){
+        parallel_for_run_chunks(&pf);
+        return;
     }
-    TTRACE("Job queued.");
+
+    job_info helpers[32];
+    parallel_for_state* pf_ptr = &pf;
+    for(u32 i = 0; i < helper_count; ++i){
+        helpers[i] = job_create_priority(parallel_for_job, 0, 0, &pf_ptr, sizeof(parallel_for_state*), 0, JOB_TYPE_GENERAL, JOB_PRIORITY_HIGH);
+    }
+    job_handle handle = job_system_submit_batch(helpers, helper_count);
+
+    parallel_for_run_chunks(&pf);
+
+    // Helpers hold a pointer to pf, so every one of them must finish before returning.
+    job_system_wait(handle);
+}
+
+u32 job_system_thread_slot(){
+    return current_job_thread ? current_job_thread->index + 1 : 0;
+}
+
+u32 job_system_thread_slot_count(){
+    return state_ptr ? state_ptr->thread_count + 1 : 1;
 }
 
 job_info job_create(pfn_job_start entry_point, pfn_job_on_complete on_success, pfn_job_on_complete on_fail, void* param_data, u32 param_data_size, u32 result_data_size){
@@ -390,6 +898,7 @@ job_info job_create_priority(pfn_job_start entry_point, pfn_job_on_complete on_s
     job.on_fail = on_fail;
     job.type = type;
     job.priority = priority;
+    job.counter_index = INVALID_ID;
 
     job.param_data_size = param_data_size;
     if(param_data_size){
@@ -7,6 +7,23 @@ typedef b8 (*pfn_job_start)(void*, void*);
 /** @brief A function pointer definition for completion of a job. */
 typedef void (*pfn_job_on_complete)(void*);
 
+/**
+ * @brief A function pointer definition for the body of a parallel for. Invoked with a
+ * range of indices to process, from begin up to but not including end.
+ */
+typedef void (*pfn_parallel_for)(u32 begin, u32 end, void* user_data);
+
+/**
+ * @brief A handle to a batch of submitted jobs. Can be used to wait for the batch to
+ * finish or to chain follow-up jobs onto it. Stays safe to use after the batch completes.
+ */
+typedef struct job_handle {
+    /** @brief The index of the counter tracking the batch. INVALID_ID if the handle refers to nothing. */
+    u32 index;
+    /** @brief The generation of the counter when the batch was submitted. */
+    u32 generation;
+} job_handle;
+
 /** @brief Describes a type of job */
 typedef enum job_type {
     /** 
@@ -73,8 +90,21 @@ typedef struct job_info {
 
     /** @brief The size of the data passed to the success/fail function. */
     u32 result_data_size;
+
+    /** @brief The counter of the batch this job belongs to, or INVALID_ID if none. Set by the job system. */
+    u32 counter_index;
 } job_info;
 
+/** @brief Counters describing the job results waiting for job_system_update. */
+typedef struct job_result_stats {
+    /** @brief The number of results waiting for their callbacks to be run. */
+    u64 pending_count;
+    /** @brief The highest pending_count reached since the job system started. */
+    u64 peak_pending_count;
+    /** @brief The number of results that arrived while the result queue was full and were spilled to the overflow list. */
+    u64 overflow_count;
+} job_result_stats;
+
 /**
  * @brief Initializes the job system. Call once to retrieve job_system_memory_requirement, passing 0 to state. Then 
  * call a second time with allocated state memory block.
@@ -85,24 +115,92 @@ typedef struct job_info {
  * @param type_masks A collection of type masks for each job thread. Must match max_job_thread_count.
  * @returns True if the job system started up successfully; otherwise false.
  */
-b8 job_system_initialize(u64* job_system_memory_requirement, void* state, u8 max_job_thread_count, u32 type_masks[]);
+TAPI b8 job_system_initialize(u64* job_system_memory_requirement, void* state, u8 max_job_thread_count, u32 type_masks[]);
 
 /**
  * @brief Shuts the job system down.
  */
-void job_system_shutdown(void* state);
+TAPI void job_system_shutdown(void* state);
 
 /**
- * @brief Updates the job system. Should happen once an update cycle.
+ * @brief Updates the job system, running the callbacks of completed jobs on the calling
+ * thread. Should happen once an update cycle. Job threads pick up work as soon as it is
+ * submitted, so this does not need to be called for jobs to start.
  */
-void job_system_update();
+TAPI void job_system_update();
 
 /**
- * @brief Submits the provided job to be queued for execution.
+ * @brief Gets the current job result counters.
+ * @param out_stats A pointer to hold the counters.
+ */
+TAPI void job_system_get_result_stats(job_result_stats* out_stats);
+
+/**
+ * @brief Submits the provided job to be queued for execution, waking a job thread
+ * that can run it if all of them are asleep. Can be called from any thread,
+ * including from within a running job.
  * @param info The description of the job to be executed.
  */
 TAPI void job_system_submit(job_info info);
 
+/**
+ * @brief Submits a batch of jobs and returns a handle that completes once all of them have run.
+ * As with job_system_submit, each job may only be submitted once.
+ * @param jobs An array of jobs to be executed. The array is copied, so it can be released after this call.
+ * @param count The number of jobs in the array.
+ * @returns A handle to the batch.
+ */
+TAPI job_handle job_system_submit_batch(const job_info* jobs, u32 count);
+
+/**
+ * @brief Submits a batch of jobs that will only start once the dependency has completed.
+ * If the dependency has already completed, the jobs are submitted immediately.
+ * @param dependency The handle of the batch that must complete first.
+ * @param jobs An array of jobs to be executed. The array is copied, so it can be released after this call.
+ * @param count The number of jobs in the array.
+ * @returns A handle to the new batch, which can itself be waited on or depended on.
+ */
+TAPI job_handle job_system_submit_batch_after(job_handle dependency, const job_info* jobs, u32 count);
+
+/**
+ * @brief Indicates if all jobs in the batch referred to by the handle have completed.
+ * @param handle The handle of the batch.
+ * @returns True if complete; otherwise false.
+ */
+TAPI b8 job_system_is_complete(job_handle handle);
+
+/**
+ * @brief Blocks until all jobs in the batch have completed. The calling thread runs
+ * other queued general jobs while it waits, but never resource loads or GPU jobs.
+ * @param handle The handle of the batch.
+ */
+TAPI void job_system_wait(job_handle handle);
+
+/**
+ * @brief Splits the range [0, count) into chunks of grain indices and runs fn on them
+ * across the job threads, returning once every index has been processed. The calling
+ * thread processes chunks too. Completion callbacks are not involved, so fn may write
+ * its results straight into user_data.
+ * @param count The number of indices to process.
+ * @param grain The number of indices handed to fn at a time. Pass 0 to use 1.
+ * @param fn The function to be invoked for each chunk. Must be thread-safe.
+ * @param user_data Data passed to each fn invocation.
+ */
+TAPI void job_system_parallel_for(u32 count, u32 grain, pfn_parallel_for fn, void* user_data);
+
+/**
+ * @brief Returns a small number identifying the calling thread, for indexing per-thread
+ * resources: 0 for any thread that is not a job thread, such as the main thread, and the
+ * job thread's index plus one for a job thread.
+ */
+TAPI u32 job_system_thread_slot();
+
+/**
+ * @brief Returns the number of thread slots, which is one more than the number of job
+ * threads. Every value job_system_thread_slot() returns is below it.
+ */
+TAPI u32 job_system_thread_slot_count();
+
 /**
  * @brief Creates a new job with default type (Generic) and priority (Normal).
  * @param entry_point A pointer to a function to be invoked when the job starts. Required.
@@ -21,7 +21,6 @@ typedef struct material_shader_uniform_locations{
     u16 diffuse_texture;
     u16 specular_texture;
     u16 normal_texture;
-    u16 model;
     u16 render_mode;
 
 } material_shader_uniform_locations;
@@ -98,7 +97,6 @@ b8 material_system_initialize(u64* memory_requirement, void* state, material_sys
     state_ptr->material_locations.normal_texture = INVALID_ID_U16;
     state_ptr->material_locations.ambient_colour = INVALID_ID_U16;
     state_ptr->material_locations.shininess = INVALID_ID_U16;
-    state_ptr->material_locations.model = INVALID_ID_U16;
     state_ptr->material_locations.render_mode = INVALID_ID_U16;
 
     state_ptr->ui_shader_id = INVALID_ID;
@@ -155,6 +153,8 @@ void material_system_shutdown(void* state){
 
         // Destroy the default material.
         destroy_material(&s->default_material);
+
+        hashtable_destroy(&s->registered_material_table);
     }
 
     state_ptr = 0;
@@ -236,7 +236,6 @@ material* material_system_acquire_from_config(material_config config){
                 state_ptr->material_locations.specular_texture = shader_system_uniform_index(s, "specular_texture");
                 state_ptr->material_locations.normal_texture = shader_system_uniform_index(s, "normal_texture");
                 state_ptr->material_locations.shininess = shader_system_uniform_index(s, "shininess");
-                state_ptr->material_locations.model = shader_system_uniform_index(s, "model");
                 state_ptr->material_locations.render_mode = shader_system_uniform_index(s, "mode");
             } else if(state_ptr->ui_shader_id == INVALID_ID && strings_equal(config.shader_name, BUILTIN_SHADER_NAME_UI)){
                 state_ptr->ui_shader_id = s->id;
@@ -255,9 +254,9 @@ material* material_system_acquire_from_config(material_config config){
 
             // Also use the handle as the material id.
             m->id = ref.handle;
-            TTRACE("Material '%s' does not yet exist. Created, and ref_count is now %i.", config.name, ref.reference_count);
+            TTRACE("Material '%s' does not yet exist. Created, and ref_count is now %llu.", config.name, ref.reference_count);
         }else{
-            TTRACE("Material '%s' already exists, ref_count increased to %i.", config.name, ref.reference_count)
+            TTRACE("Material '%s' already exists, ref_count increased to %llu.", config.name, ref.reference_count)
         }
 
         // Update the entry.
@@ -293,7 +292,7 @@ void material_system_release(const char* name){
             ref.auto_release = FALSE;
             TTRACE("Released material '%s'. Material unloaded because reference count = 0 and outo_release = TRUE.", name);
         }else{
-            TTRACE("Released material '%s', now has a reference count of '%s' (autor_release=%s).", name, ref.reference_count, ref.auto_release ? "TRUE" : "FALSE");
+            TTRACE("Released material '%s', now has a reference count of '%llu' (autor_release=%s).", name, ref.reference_count, ref.auto_release ? "TRUE" : "FALSE");
         }
 
         // Update the entry.
@@ -314,7 +313,7 @@ material* material_system_get_default(){
 
 #define MATERIAL_APPLY_OR_FAIL(expr)                     \
     if(!expr){                                          \
-        TERROR("Failed to apply material: %s", expr);   \
+        TERROR("Failed to apply material: %s", #expr);   \
         return FALSE;                                   \
     }
 
@@ -374,9 +373,15 @@ b8 material_system_apply_instance(material* m, b8 needs_update){
     return TRUE;
 }
 
+b8 material_system_bind_instance(material* m){
+    return renderer_shader_bind_instance_resources(shader_system_get_by_id(m->shader_id), m->internal_id);
+}
+
 b8 material_system_apply_local(material* m, const mat4* model){
     if(m->shader_id == state_ptr->material_shader_id){
-        return shader_system_uniform_set_by_index(state_ptr->material_locations.model, model);
+        // The material shader reads its model matrix per instance, so it is passed along with
+        // the draw through renderer_draw_geometry_instanced() instead.
+        return TRUE;
     } else if( m->shader_id == state_ptr->ui_shader_id){
         return shader_system_uniform_set_by_index(state_ptr->ui_locations.model, model);
     }
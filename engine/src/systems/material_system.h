@@ -42,7 +42,18 @@ b8 material_system_apply_global(u32 shader_id, u64 renderer_frame_number, const
 b8 material_system_apply_instance(material* m, b8 needs_update);
 
 /**
- * @brief Applies local-level material data (typically just model matrix).
+ * @brief Binds the instance-level resources of the given material, which must already have been
+ * applied this frame, without updating them. Unlike material_system_apply_instance() it changes
+ * no shared state, so it can be called from several recording threads at once.
+ *
+ * @param m A pointer to the material to be bound.
+ * @return True on success; otherwise false.
+ */
+b8 material_system_bind_instance(material* m);
+
+/**
+ * @brief Applies local-level material data (typically just model matrix). Does nothing for the
+ * material shader, which takes its model matrix per instance.
  * 
  * @param m A pointer to the material to be applied.
  * @param model A constant pointer to the model matrix to be applied.
@@ -4,6 +4,7 @@
 #include "core/logger.h"
 #include "core/tmemory.h"
 #include "core/tstring.h"
+#include "core/profiler.h"
 #include "renderer/renderer_frontend.h"
 
 // TODO: temporary - make factory and register instead
@@ -61,6 +62,11 @@ b8 render_view_system_initialize(u64* memory_requirement, void* state, render_vi
 }
 
 void render_view_system_shutdown(void* state){
+    render_view_system_state* s = (render_view_system_state*)state;
+    if(s){
+        hashtable_destroy(&s->lookup);
+    }
+
     state_ptr = 0;
 }
 
@@ -178,9 +184,10 @@ render_view* render_view_system_get(const char* name){
     return 0;
 }
 
-b8 render_view_system_build_packet(const render_view* view, void* data, struct render_view_packet* out_packet){
+b8 render_view_system_build_packet(const render_view* view, struct frame_allocator* frame_allocator, void* data, struct render_view_packet* out_packet){
     if(view && out_packet){
-        return view->on_build_packet(view, data, out_packet);
+        TPROFILE_SCOPE("render_view_build_packet");
+        return view->on_build_packet(view, frame_allocator, data, out_packet);
     }
 
     TERROR("render_view_system_build_packet requires valid pointers to a view and a packet.");
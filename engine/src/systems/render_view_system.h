@@ -58,11 +58,12 @@ render_view* render_view_system_get(const char* name);
  * @brief Builds a render view packet using the provided view and meshes.
  *
  * @param view A pointer to the view to use.
+ * @param frame_allocator The allocator for the packet's arrays, which only need to live for the frame.
  * @param data Freeform data used to build the packet.
  * @param out_packet A pointer to hold the generated packet.
  * @return True on success; otherwise false.
  */
-b8 render_view_system_build_packet(const render_view* view, void* data, struct render_view_packet* out_packet);
+b8 render_view_system_build_packet(const render_view* view, struct frame_allocator* frame_allocator, void* data, struct render_view_packet* out_packet);
 
 /**
  * @brief Uses the given view and packet to render the contents therein.
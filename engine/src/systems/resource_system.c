@@ -2,6 +2,7 @@
 
 #include "core/logger.h"
 #include "core/tstring.h"
+#include "core/profiler.h"
 
 //Known resource loaders.
 #include "resources/loaders/text_loader.h"
@@ -158,5 +159,6 @@ b8 load(const char* name, resource_loader* loader, void* params, resource* out_r
     }
 
     out_resource->loader_id = loader->id;
+    TPROFILE_SCOPE("resource_load");
     return loader->load(loader, name, params, out_resource);
 }
\ No newline at end of file
@@ -17,8 +17,8 @@ typedef struct resource_loader {
     void (*unload)(struct resource_loader* self, resource* resource);
 } resource_loader;
 
-b8 resource_system_initialize(u64* memory_requirement, void* state, resource_system_config config);
-void resource_system_shutdown(void* state);
+TAPI b8 resource_system_initialize(u64* memory_requirement, void* state, resource_system_config config);
+TAPI void resource_system_shutdown(void* state);
 
 TAPI b8 resource_system_register_loader(resource_loader loader);
 
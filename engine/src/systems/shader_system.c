@@ -18,8 +18,6 @@ typedef struct shader_system_state
     hashtable lookup;
     // The memory used for the lookup table.
     void* lookup_memory;
-    // The identifier for the currently bound shader.
-    u32 current_shader_id;
     // A collection of created shaders.
     shader* shaders;
 
@@ -28,6 +26,10 @@ typedef struct shader_system_state
 // A pointer to hold the internal system state.
 static shader_system_state* state_ptr = 0;
 
+// The identifier of the shader in use. Per thread, since render views can be recorded on
+// several threads at once.
+static _Thread_local u32 current_shader_id = INVALID_ID;
+
 b8 add_attribute(shader* shader, const shader_attribute_config* config);
 b8 add_sampler(shader* shader, shader_uniform_config* config);
 b8 add_uniform(shader* shader, shader_uniform_config* config);
@@ -68,7 +70,6 @@ b8 shader_system_initialize(u64* memory_requirement, void* memory, shader_system
     state_ptr->lookup_memory = (void*)(addr + struct_requirement);
     state_ptr->shaders = (void*)((u64)state_ptr->lookup_memory + hashtable_requirement);
     state_ptr->config = config;
-    state_ptr->current_shader_id = INVALID_ID;
     hashtable_create(sizeof(u32), config.max_shader_count, state_ptr->lookup_memory, FALSE, &state_ptr->lookup);
 
     // Invalidate all shader ids.
@@ -123,6 +124,7 @@ b8 shader_system_create(const shader_config* config){
     tzero_memory(out_shader->push_constant_ranges, sizeof(range) * 32);
     out_shader->bound_instance_id = INVALID_ID;
     out_shader->attribute_stride = 0;
+    out_shader->instance_attribute_stride = 0;
 
     // Setup arrays
     out_shader->global_texture_maps = darray_create(texture_map*);
@@ -230,6 +232,13 @@ void shader_destroy(shader* s){
     }
     darray_destroy(s->global_texture_maps);
 
+    // Release the uniform lookup, which owns internal metadata besides its value block.
+    hashtable_destroy(&s->uniform_lookup);
+    if(s->hashtable_block){
+        tfree(s->hashtable_block, sizeof(u16) * 1024, MEMORY_TAG_UNKNOWN);
+        s->hashtable_block = 0;
+    }
+
     // Free the name.
     if(s->name){
         u32 length = string_length(s->name);
@@ -259,19 +268,22 @@ b8 shader_system_use(const char* shader_name){
 }
 
 b8 shader_system_use_by_id(u32 shader_id){
-    // Only perform the use if the shader id is different.
-    if(state_ptr->current_shader_id != shader_id){
-        shader* next_shader = shader_system_get_by_id(shader_id);
-        state_ptr->current_shader_id = shader_id;
-        if(!renderer_shader_use(next_shader)){
-            TERROR("Failed to use shader '%s'.", next_shader->name);
-            return FALSE;
-        }
+    // Always pass this on; the renderer knows whether the shader is still bound in the current
+    // renderpass, which this can't tell across frames.
+    shader* next_shader = shader_system_get_by_id(shader_id);
+    if(!next_shader){
+        TERROR("shader_system_use_by_id called with invalid shader id %u.", shader_id);
+        return FALSE;
+    }
+    current_shader_id = shader_id;
+    if(!renderer_shader_use(next_shader)){
+        TERROR("Failed to use shader '%s'.", next_shader->name);
+        return FALSE;
+    }
 
-        if(!renderer_shader_bind_globals(next_shader)){
-            TERROR("Failed to bind globals for shader '%s'.", next_shader->name);
-            return FALSE;
-        }
+    if(!renderer_shader_bind_globals(next_shader)){
+        TERROR("Failed to bind globals for shader '%s'.", next_shader->name);
+        return FALSE;
     }
 
     return TRUE;
@@ -293,11 +305,11 @@ u16 shader_system_uniform_index(shader* s, const char* uniform_name){
 }
 
 b8 shader_system_uniform_set(const char* uniform_name, const void* value){
-    if(state_ptr->current_shader_id == INVALID_ID){
+    if(current_shader_id == INVALID_ID){
         TERROR("shader_system_uniform_set called without a shader in use.");
         return FALSE;
     }
-    shader* s = &state_ptr->shaders[state_ptr->current_shader_id];
+    shader* s = &state_ptr->shaders[current_shader_id];
     u16 index = shader_system_uniform_index(s, uniform_name);
     return shader_system_uniform_set_by_index(index, value);
 }
@@ -307,7 +319,7 @@ b8 shader_system_sampler_set(const char* sampler_name, const texture* t){
 }
 
 b8 shader_system_uniform_set_by_index(u16 index, const void* value){
-    shader* shader = &state_ptr->shaders[state_ptr->current_shader_id];
+    shader* shader = &state_ptr->shaders[current_shader_id];
     shader_uniform* uniform = &shader->uniforms[index];
     if(shader->bound_scope != uniform->scope){
         if(uniform->scope == SHADER_SCOPE_GLOBAL){
@@ -328,15 +340,23 @@ b8 shader_system_sampler_set_by_index(u16 index, const texture* t){
 }
 
 b8 shader_system_apply_global(){
-    return renderer_shader_apply_globals(&state_ptr->shaders[state_ptr->current_shader_id]);
+    return renderer_shader_apply_globals(&state_ptr->shaders[current_shader_id]);
 }
 
 b8 shader_system_apply_instance(b8 needs_update){
-    return renderer_shader_apply_instance(&state_ptr->shaders[state_ptr->current_shader_id], needs_update);
+    return renderer_shader_apply_instance(&state_ptr->shaders[current_shader_id], needs_update);
+}
+
+u32 shader_system_current_id(){
+    return current_shader_id;
+}
+
+void shader_system_current_id_restore(u32 shader_id){
+    current_shader_id = shader_id;
 }
 
 b8 shader_system_bind_instance(u32 instance_id){
-    shader* s = &state_ptr->shaders[state_ptr->current_shader_id];
+    shader* s = &state_ptr->shaders[current_shader_id];
     s->bound_instance_id = instance_id;
     return renderer_shader_bind_instance(s, instance_id);
 }
@@ -366,19 +386,28 @@ b8 add_attribute(shader* shader, const shader_attribute_config* config){
         case SHADER_ATTRIB_TYPE_FLOAT32_4:
             size = 16;
             break;
+        case SHADER_ATTRIB_TYPE_MATRIX_4:
+            size = 64;
+            break;
         default:
-            TERROR("Unrecognized type %d, defaulting to size of 4. This probably is not what is desired.");
+            TERROR("Unrecognized type %d, defaulting to size of 4. This probably is not what is desired.", config->type);
             size = 4;
             break;
     }
 
-    shader->attribute_stride += size;
+    // Per-vertex and per-instance attributes are read from separate buffers, so each kind gets its own stride.
+    if(config->rate == SHADER_ATTRIBUTE_RATE_INSTANCE){
+        shader->instance_attribute_stride += size;
+    } else {
+        shader->attribute_stride += size;
+    }
 
     // Create/push the attribute.
     shader_attribute attrib = {};
     attrib.name = string_duplicate(config->name);
     attrib.size = size;
     attrib.type = config->type;
+    attrib.rate = config->rate;
     darray_push(shader->attributes, attrib);
 
     return TRUE;
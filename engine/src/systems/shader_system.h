@@ -73,6 +73,8 @@ typedef struct shader_attribute {
     shader_attribute_type type;
     /** @brief The attribute size in bytes. */
     u32 size;
+    /** @brief How often the attribute advances. */
+    shader_attribute_rate rate;
 } shader_attribute;
 
 /**
@@ -147,8 +149,10 @@ typedef struct shader {
     u8 push_constant_range_count;
     /** @brief An array of push constant ranges. */
     range push_constant_ranges[32];
-    /** @brief The size of all attributes combined, a.k.a. the size of a vertex. */
+    /** @brief The size of all per-vertex attributes combined, a.k.a. the size of a vertex. */
     u16 attribute_stride;
+    /** @brief The size of all per-instance attributes combined. 0 if the shader has none. */
+    u16 instance_attribute_stride;
 
     /** @brief Used to ensure the shader's globals are only updated once per frame. */
     u64 render_frame_number;
@@ -224,6 +228,21 @@ TAPI b8 shader_system_use(const char* shader_name);
  */
 TAPI b8 shader_system_use_by_id(u32 shader_id);
 
+/**
+ * @brief Gets the identifier of the shader in use on the calling thread.
+ *
+ * @return The identifier of the shader, or INVALID_ID if none is in use.
+ */
+TAPI u32 shader_system_current_id();
+
+/**
+ * @brief Sets the shader in use on the calling thread without binding anything, to put
+ * it back after a nested recording on the same thread used other shaders.
+ *
+ * @param shader_id The identifier returned by shader_system_current_id.
+ */
+TAPI void shader_system_current_id_restore(u32 shader_id);
+
 /**
  * @brief Returns the uniform index for a uniform with the given name, if found.
  * 
@@ -109,6 +109,8 @@ void texture_system_shutdown(void* state){
 
         destroy_default_textures(state_ptr);
 
+        hashtable_destroy(&state_ptr->registered_texture_table);
+
         state_ptr = 0;
     }
 }
@@ -416,7 +418,8 @@ b8 load_cube_textures(const char* name, const char texture_names[6][TEXTURE_NAME
             image_size = t->width * t->height * t->channel_count;
             // NOTE: no need for transparency in cube maps, so not checking for it.
 
-            pixels = tallocate(sizeof(u8) * image_size * 6, MEMORY_TAG_ARRAY);
+            // Every face is copied in below, so there is nothing to zero.
+            pixels = tallocate_uninitialized(sizeof(u8) * image_size * 6, TMEMORY_DEFAULT_ALIGNMENT, MEMORY_TAG_ARRAY);
         } else{
             // Verify all textures are the same size.
             if(t->width != resource_data->width || t->height != resource_data->height || t->channel_count != resource_data->channel_count){
@@ -530,7 +533,7 @@ b8 load_texture(const char* texture_name, texture* t){
     params.current_generation = t->generation;
     params.temp_texture = (texture){};
 
-    job_info job = job_create(texture_load_job_start, texture_load_job_success, texture_load_job_fail, & params, sizeof(texture_load_params), sizeof(texture_load_params));
+    job_info job = job_create_type(texture_load_job_start, texture_load_job_success, texture_load_job_fail, & params, sizeof(texture_load_params), sizeof(texture_load_params), JOB_TYPE_RESOURCE_LOAD);
     job_system_submit(job);
     return TRUE;
 }
@@ -592,7 +595,7 @@ b8 process_texture_reference(const char* name, texture_type type, i8 reference_d
                     ref.auto_release = FALSE;
                     TTRACE("Released texture '%s'. Texture unloaded because reference count=0 and auto_release=TRUE.", name_copy);
                 } else {
-                    TTRACE("Release texture '%s', now has a reference count of '%i' (auto_release=%s).", name_copy, ref.reference_count, ref.auto_release ? "true" : "false");
+                    TTRACE("Release texture '%s', now has a reference count of '%llu' (auto_release=%s).", name_copy, ref.reference_count, ref.auto_release ? "true" : "false");
                 }
 
             }else{
@@ -645,12 +648,12 @@ b8 process_texture_reference(const char* name, texture_type type, i8 reference_d
                             }
                             t->id = ref.handle;
                         }
-                        TTRACE("Texture '%s' does not yet exist. Created, and ref_count is now %i.", name, ref.reference_count);
+                        TTRACE("Texture '%s' does not yet exist. Created, and ref_count is now %llu.", name, ref.reference_count);
                     }
 
                 } else {
                     *out_texture_id = ref.handle;
-                    TTRACE("Texture '%s' already exists, ref_count increased to %i.", name, ref.reference_count);
+                    TTRACE("Texture '%s' already exists, ref_count increased to %llu.", name, ref.reference_count);
                 }
             }
 
@@ -0,0 +1,460 @@
+#include "transform_system.h"
+
+#include "core/logger.h"
+#include "core/profiler.h"
+#include "core/tmemory.h"
+#include "math/tmath.h"
+#include "systems/job_system.h"
+
+// Levels of the hierarchy with fewer transforms than this are updated on the calling
+// thread; larger ones are split into chunks of this many across the job threads.
+#define TRANSFORM_SYSTEM_PARALLEL_GRAIN 4096
+
+typedef struct transform_system_state {
+    transform_system_config config;
+
+    // The number of slots in use, including destroyed transforms not yet compacted away.
+    u32 count;
+    // The number of transforms that exist.
+    u32 alive_count;
+
+    // Per slot, ordered so that every parent comes before its children. Slots are grouped
+    // by depth in the hierarchy once the order has been rebuilt.
+    vec3* positions;
+    quat* rotations;
+    vec3* scales;
+    mat4* locals;
+    mat4* worlds;
+    // The slot of the parent, or INVALID_ID.
+    u32* parents;
+    // Set when the local matrix needs recomputing.
+    b8* dirty;
+    // Set during an update when the world matrix changed, so that children follow.
+    b8* world_dirty;
+    // The handle of the transform in each slot, or INVALID_ID if it was destroyed.
+    u32* slot_handles;
+
+    // Per handle, the slot it refers to, or INVALID_ID if it is free.
+    u32* handle_slots;
+    u32* free_handles;
+    u32 free_handle_count;
+
+    // The end of each depth level's slots. Level d starts where level d - 1 ends.
+    u32* level_ends;
+    u32 level_count;
+
+    // Set when the order has to be rebuilt before the next update: a parent changed, a
+    // transform was destroyed, or one was added below the top level.
+    b8 needs_rebuild;
+    // Set when anything has been marked dirty since the last update.
+    b8 any_dirty;
+
+    // Scratch space for rebuilding the order.
+    u32* scratch_depths;
+    u32* scratch_slots;
+    void* scratch;
+} transform_system_state;
+
+static transform_system_state* state_ptr;
+
+// Lays the arrays out after the state, each aligned for SIMD loads.
+static u64 layout_arrays(transform_system_state* state, u32 capacity){
+    u64 offset = get_aligned(sizeof(transform_system_state), 16);
+#define TRANSFORM_ARRAY(field, element_size)                                        \
+    if(state){ state->field = (void*)((u8*)state + offset); }                       \
+    offset = get_aligned(offset + (u64)(element_size) * capacity, 16);
+
+    TRANSFORM_ARRAY(positions, sizeof(vec3));
+    TRANSFORM_ARRAY(rotations, sizeof(quat));
+    TRANSFORM_ARRAY(scales, sizeof(vec3));
+    TRANSFORM_ARRAY(locals, sizeof(mat4));
+    TRANSFORM_ARRAY(worlds, sizeof(mat4));
+    TRANSFORM_ARRAY(parents, sizeof(u32));
+    TRANSFORM_ARRAY(dirty, sizeof(b8));
+    TRANSFORM_ARRAY(world_dirty, sizeof(b8));
+    TRANSFORM_ARRAY(slot_handles, sizeof(u32));
+    TRANSFORM_ARRAY(handle_slots, sizeof(u32));
+    TRANSFORM_ARRAY(free_handles, sizeof(u32));
+    TRANSFORM_ARRAY(level_ends, sizeof(u32));
+    TRANSFORM_ARRAY(scratch_depths, sizeof(u32));
+    TRANSFORM_ARRAY(scratch_slots, sizeof(u32));
+    // Big enough for a copy of any one of the arrays above.
+    TRANSFORM_ARRAY(scratch, sizeof(mat4));
+#undef TRANSFORM_ARRAY
+    return offset;
+}
+
+b8 transform_system_initialize(u64* memory_requirement, void* state, transform_system_config config){
+    if(config.max_transform_count == 0){
+        TFATAL("transform_system_initialize - config.max_transform_count must be > 0.");
+        return FALSE;
+    }
+
+    *memory_requirement = layout_arrays(0, config.max_transform_count);
+    if(!state){
+        return TRUE;
+    }
+
+    state_ptr = state;
+    tzero_memory(state_ptr, sizeof(transform_system_state));
+    state_ptr->config = config;
+    layout_arrays(state_ptr, config.max_transform_count);
+
+    // Hand out low handles first.
+    for(u32 i = 0; i < config.max_transform_count; ++i){
+        state_ptr->handle_slots[i] = INVALID_ID;
+        state_ptr->free_handles[i] = config.max_transform_count - 1 - i;
+    }
+    state_ptr->free_handle_count = config.max_transform_count;
+    return TRUE;
+}
+
+void transform_system_shutdown(void* state){
+    state_ptr = 0;
+}
+
+/**
+ * Rebuilds the order of the slots: destroyed transforms are dropped, and the rest are
+ * grouped by depth, so that every level only depends on the ones before it. Stable, so
+ * transforms keep their relative order within a level.
+ */
+static void rebuild_order(){
+    transform_system_state* s = state_ptr;
+    u32* depths = s->scratch_depths;
+    u32* stack = s->scratch_slots;
+
+    // Children of destroyed transforms become roots.
+    for(u32 i = 0; i < s->count; ++i){
+        depths[i] = INVALID_ID;
+        u32 parent = s->parents[i];
+        if(parent != INVALID_ID && s->slot_handles[parent] == INVALID_ID){
+            s->parents[i] = INVALID_ID;
+            s->dirty[i] = TRUE;
+            s->any_dirty = TRUE;
+        }
+    }
+
+    // Find the depth of every transform, walking up until one is known.
+    u32 max_depth = 0;
+    for(u32 i = 0; i < s->count; ++i){
+        if(s->slot_handles[i] == INVALID_ID){
+            continue;
+        }
+        u32 length = 0;
+        u32 current = i;
+        while(current != INVALID_ID && depths[current] == INVALID_ID){
+            stack[length++] = current;
+            current = s->parents[current];
+        }
+        u32 depth = current == INVALID_ID ? 0 : depths[current] + 1;
+        while(length){
+            depths[stack[--length]] = depth++;
+        }
+        if(depths[i] > max_depth){
+            max_depth = depths[i];
+        }
+    }
+
+    // Counting sort by depth. After assigning, level_ends[d] is where level d ends.
+    u32* level_ends = s->level_ends;
+    for(u32 d = 0; d <= max_depth; ++d){
+        level_ends[d] = 0;
+    }
+    for(u32 i = 0; i < s->count; ++i){
+        if(s->slot_handles[i] != INVALID_ID && depths[i] < max_depth){
+            level_ends[depths[i] + 1]++;
+        }
+    }
+    for(u32 d = 1; d <= max_depth; ++d){
+        level_ends[d] += level_ends[d - 1];
+    }
+    u32* new_slots = stack;
+    for(u32 i = 0; i < s->count; ++i){
+        new_slots[i] = s->slot_handles[i] == INVALID_ID ? INVALID_ID : level_ends[depths[i]]++;
+    }
+    s->level_count = s->alive_count ? max_depth + 1 : 0;
+
+    // Parents refer to old slots, so map them before moving anything.
+    for(u32 i = 0; i < s->count; ++i){
+        if(s->parents[i] != INVALID_ID){
+            s->parents[i] = new_slots[s->parents[i]];
+        }
+    }
+
+    // Move everything to its new slot by way of the scratch space.
+#define TRANSFORM_PERMUTE(field, type)                              \
+    for(u32 i = 0; i < s->count; ++i){                              \
+        if(new_slots[i] != INVALID_ID){                             \
+            ((type*)s->scratch)[new_slots[i]] = s->field[i];        \
+        }                                                           \
+    }                                                               \
+    tcopy_memory(s->field, s->scratch, sizeof(type) * s->alive_count);
+
+    TRANSFORM_PERMUTE(positions, vec3);
+    TRANSFORM_PERMUTE(rotations, quat);
+    TRANSFORM_PERMUTE(scales, vec3);
+    TRANSFORM_PERMUTE(locals, mat4);
+    TRANSFORM_PERMUTE(worlds, mat4);
+    TRANSFORM_PERMUTE(parents, u32);
+    TRANSFORM_PERMUTE(dirty, b8);
+    TRANSFORM_PERMUTE(slot_handles, u32);
+#undef TRANSFORM_PERMUTE
+
+    s->count = s->alive_count;
+    for(u32 i = 0; i < s->count; ++i){
+        s->handle_slots[s->slot_handles[i]] = i;
+    }
+    s->needs_rebuild = FALSE;
+}
+
+TINLINE b8 get_slot(u32 handle, u32* out_slot){
+    if(!state_ptr || handle >= state_ptr->config.max_transform_count || state_ptr->handle_slots[handle] == INVALID_ID){
+        TWARN("Invalid transform handle %u.", handle);
+        return FALSE;
+    }
+    *out_slot = state_ptr->handle_slots[handle];
+    return TRUE;
+}
+
+u32 transform_system_create(vec3 position, quat rotation, vec3 scale){
+    if(!state_ptr){
+        return INVALID_ID;
+    }
+    // Destroyed transforms still hold their slots until the order is rebuilt.
+    if(state_ptr->count == state_ptr->config.max_transform_count && state_ptr->alive_count < state_ptr->count){
+        rebuild_order();
+    }
+    if(state_ptr->count == state_ptr->config.max_transform_count){
+        TERROR("transform_system_create - all %u transforms are in use. Increase max_transform_count.", state_ptr->config.max_transform_count);
+        return INVALID_ID;
+    }
+
+    u32 handle = state_ptr->free_handles[--state_ptr->free_handle_count];
+    u32 slot = state_ptr->count++;
+    state_ptr->alive_count++;
+    state_ptr->handle_slots[handle] = slot;
+    state_ptr->slot_handles[slot] = handle;
+    state_ptr->positions[slot] = position;
+    state_ptr->rotations[slot] = rotation;
+    state_ptr->scales[slot] = scale;
+    state_ptr->locals[slot] = mat4_identity();
+    state_ptr->worlds[slot] = mat4_identity();
+    state_ptr->parents[slot] = INVALID_ID;
+    state_ptr->dirty[slot] = TRUE;
+    state_ptr->any_dirty = TRUE;
+
+    // A new root just extends the top level, as long as there is nothing below it.
+    if(state_ptr->level_count <= 1 && !state_ptr->needs_rebuild){
+        state_ptr->level_count = 1;
+        state_ptr->level_ends[0] = state_ptr->count;
+    }else{
+        state_ptr->needs_rebuild = TRUE;
+    }
+    return handle;
+}
+
+void transform_system_destroy(u32 handle){
+    u32 slot;
+    if(!get_slot(handle, &slot)){
+        return;
+    }
+    state_ptr->slot_handles[slot] = INVALID_ID;
+    state_ptr->handle_slots[handle] = INVALID_ID;
+    state_ptr->free_handles[state_ptr->free_handle_count++] = handle;
+    state_ptr->alive_count--;
+    state_ptr->needs_rebuild = TRUE;
+}
+
+b8 transform_system_set_parent(u32 handle, u32 parent_handle){
+    u32 slot;
+    if(!get_slot(handle, &slot)){
+        return FALSE;
+    }
+    u32 parent_slot = INVALID_ID;
+    if(parent_handle != INVALID_ID){
+        if(!get_slot(parent_handle, &parent_slot)){
+            return FALSE;
+        }
+        for(u32 ancestor = parent_slot; ancestor != INVALID_ID; ancestor = state_ptr->parents[ancestor]){
+            if(ancestor == slot){
+                TERROR("transform_system_set_parent - transform %u cannot be parented to its own descendant %u.", handle, parent_handle);
+                return FALSE;
+            }
+        }
+    }
+
+    if(state_ptr->parents[slot] != parent_slot){
+        state_ptr->parents[slot] = parent_slot;
+        state_ptr->dirty[slot] = TRUE;
+        state_ptr->any_dirty = TRUE;
+        state_ptr->needs_rebuild = TRUE;
+    }
+    return TRUE;
+}
+
+u32 transform_system_get_parent(u32 handle){
+    u32 slot;
+    if(!get_slot(handle, &slot) || state_ptr->parents[slot] == INVALID_ID){
+        return INVALID_ID;
+    }
+    return state_ptr->slot_handles[state_ptr->parents[slot]];
+}
+
+TINLINE void mark_dirty(u32 slot){
+    state_ptr->dirty[slot] = TRUE;
+    state_ptr->any_dirty = TRUE;
+}
+
+vec3 transform_system_get_position(u32 handle){
+    u32 slot;
+    return get_slot(handle, &slot) ? state_ptr->positions[slot] : vec3_zero();
+}
+
+void transform_system_set_position(u32 handle, vec3 position){
+    u32 slot;
+    if(get_slot(handle, &slot)){
+        state_ptr->positions[slot] = position;
+        mark_dirty(slot);
+    }
+}
+
+void transform_system_translate(u32 handle, vec3 translation){
+    u32 slot;
+    if(get_slot(handle, &slot)){
+        state_ptr->positions[slot] = vec3_add(state_ptr->positions[slot], translation);
+        mark_dirty(slot);
+    }
+}
+
+quat transform_system_get_rotation(u32 handle){
+    u32 slot;
+    return get_slot(handle, &slot) ? state_ptr->rotations[slot] : quat_identity();
+}
+
+void transform_system_set_rotation(u32 handle, quat rotation){
+    u32 slot;
+    if(get_slot(handle, &slot)){
+        state_ptr->rotations[slot] = rotation;
+        mark_dirty(slot);
+    }
+}
+
+void transform_system_rotate(u32 handle, quat rotation){
+    u32 slot;
+    if(get_slot(handle, &slot)){
+        state_ptr->rotations[slot] = quat_mul(state_ptr->rotations[slot], rotation);
+        mark_dirty(slot);
+    }
+}
+
+vec3 transform_system_get_scale(u32 handle){
+    u32 slot;
+    return get_slot(handle, &slot) ? state_ptr->scales[slot] : vec3_one();
+}
+
+void transform_system_set_scale(u32 handle, vec3 scale){
+    u32 slot;
+    if(get_slot(handle, &slot)){
+        state_ptr->scales[slot] = scale;
+        mark_dirty(slot);
+    }
+}
+
+void transform_system_scale(u32 handle, vec3 scale){
+    u32 slot;
+    if(get_slot(handle, &slot)){
+        state_ptr->scales[slot] = vec3_mul(state_ptr->scales[slot], scale);
+        mark_dirty(slot);
+    }
+}
+
+mat4 transform_system_get_local(u32 handle){
+    u32 slot;
+    return get_slot(handle, &slot) ? state_ptr->locals[slot] : mat4_identity();
+}
+
+mat4 transform_system_get_world(u32 handle){
+    u32 slot;
+    return get_slot(handle, &slot) ? state_ptr->worlds[slot] : mat4_identity();
+}
+
+u32 transform_system_count(){
+    return state_ptr ? state_ptr->alive_count : 0;
+}
+
+/**
+ * Updates the slots [begin, end) of one level. user_data points at the slot the level
+ * starts at. Only reads the worlds of earlier levels, so a level can be split up freely.
+ */
+static void update_range(u32 begin, u32 end, void* user_data){
+    transform_system_state* s = state_ptr;
+    u32 level_start = *(u32*)user_data;
+    for(u32 i = level_start + begin; i < level_start + end; ++i){
+        u32 parent = s->parents[i];
+        b8 changed = s->dirty[i] || (parent != INVALID_ID && s->world_dirty[parent]);
+        s->world_dirty[i] = changed;
+        if(!changed){
+            continue;
+        }
+
+        if(s->dirty[i]){
+            // The same as scale * rotation * translation (see transform_get_local), written
+            // out: the rotation rows are scaled and the translation is the bottom row.
+            // Builds it directly rather than through quat_to_mat4, which would set up an
+            // identity and divide by the length four times.
+            quat q = s->rotations[i];
+            vec3 scale = s->scales[i];
+            vec3 position = s->positions[i];
+            f32 inv = 1.0f / tsqrt(q.x * q.x + q.y * q.y + q.z * q.z + q.w * q.w);
+            f32 x = q.x * inv, y = q.y * inv, z = q.z * inv, w = q.w * inv;
+            mat4 m;
+            m.data[0] = (1.0f - 2.0f * (y * y + z * z)) * scale.x;
+            m.data[1] = 2.0f * (x * y - z * w) * scale.x;
+            m.data[2] = 2.0f * (x * z + y * w) * scale.x;
+            m.data[3] = 0.0f;
+            m.data[4] = 2.0f * (x * y + z * w) * scale.y;
+            m.data[5] = (1.0f - 2.0f * (x * x + z * z)) * scale.y;
+            m.data[6] = 2.0f * (y * z - x * w) * scale.y;
+            m.data[7] = 0.0f;
+            m.data[8] = 2.0f * (x * z - y * w) * scale.z;
+            m.data[9] = 2.0f * (y * z + x * w) * scale.z;
+            m.data[10] = (1.0f - 2.0f * (x * x + y * y)) * scale.z;
+            m.data[11] = 0.0f;
+            m.data[12] = position.x;
+            m.data[13] = position.y;
+            m.data[14] = position.z;
+            m.data[15] = 1.0f;
+            s->locals[i] = m;
+            s->dirty[i] = FALSE;
+        }
+
+        s->worlds[i] = parent == INVALID_ID ? s->locals[i] : mat4_mul_affine(s->locals[i], s->worlds[parent]);
+    }
+}
+
+void transform_system_update(){
+    if(!state_ptr){
+        return;
+    }
+    TPROFILE_SCOPE("transform_system_update");
+
+    if(state_ptr->needs_rebuild){
+        rebuild_order();
+    }
+    if(!state_ptr->any_dirty){
+        return;
+    }
+
+    u32 level_start = 0;
+    for(u32 level = 0; level < state_ptr->level_count; ++level){
+        u32 level_end = state_ptr->level_ends[level];
+        u32 level_size = level_end - level_start;
+        if(level_size > TRANSFORM_SYSTEM_PARALLEL_GRAIN){
+            job_system_parallel_for(level_size, TRANSFORM_SYSTEM_PARALLEL_GRAIN, update_range, &level_start);
+        }else{
+            update_range(0, level_size, &level_start);
+        }
+        level_start = level_end;
+    }
+    state_ptr->any_dirty = FALSE;
+}
@@ -0,0 +1,102 @@
+/**
+ * @file transform_system.h
+ * @brief Owns every transform in the world, stored as structure-of-arrays and referred to
+ * by handle. Setting a position, rotation, scale or parent only marks the transform dirty;
+ * transform_system_update() then brings every dirty transform and everything below it up to
+ * date in one pass, ordered so that parents are always done before their children. Levels
+ * of the hierarchy that are large enough are split across the job threads.
+ *
+ * Local and world matrices are those of the last update, so read them after it has run for
+ * the frame. Only the main thread should call into it.
+ */
+
+#pragma once
+
+#include "defines.h"
+#include "math/math_types.h"
+
+typedef struct transform_system_config {
+    /** @brief The maximum number of transforms that can exist at once. */
+    u32 max_transform_count;
+} transform_system_config;
+
+/**
+ * @brief Initializes the transform system. Call twice; once with state = 0 to get the required memory size,
+ * then a second time passing allocated memory to state.
+ *
+ * @param memory_requirement A pointer to hold the required memory size of internal state.
+ * @param state 0 if just requesting memory requirement, otherwise allocated block of memory.
+ * @param config The configuration for the system.
+ * @return True on success; otherwise false.
+ */
+TAPI b8 transform_system_initialize(u64* memory_requirement, void* state, transform_system_config config);
+
+/**
+ * @brief Shuts the transform system down.
+ *
+ * @param state The block of state memory.
+ */
+TAPI void transform_system_shutdown(void* state);
+
+/**
+ * @brief Creates a transform with no parent.
+ *
+ * @param position The position.
+ * @param rotation The rotation.
+ * @param scale The scale.
+ * @return A handle to the new transform, or INVALID_ID if there is no room for it.
+ */
+TAPI u32 transform_system_create(vec3 position, quat rotation, vec3 scale);
+
+/**
+ * @brief Destroys a transform. Its children are left without a parent.
+ *
+ * @param handle The transform to destroy.
+ */
+TAPI void transform_system_destroy(u32 handle);
+
+/**
+ * @brief Sets the parent of a transform. Fails if this would make the transform its own ancestor.
+ *
+ * @param handle The transform whose parent to set.
+ * @param parent_handle The new parent, or INVALID_ID to detach it.
+ * @return True on success; otherwise false.
+ */
+TAPI b8 transform_system_set_parent(u32 handle, u32 parent_handle);
+
+/**
+ * @brief Returns the parent of a transform, or INVALID_ID if it has none.
+ */
+TAPI u32 transform_system_get_parent(u32 handle);
+
+TAPI vec3 transform_system_get_position(u32 handle);
+TAPI void transform_system_set_position(u32 handle, vec3 position);
+TAPI void transform_system_translate(u32 handle, vec3 translation);
+
+TAPI quat transform_system_get_rotation(u32 handle);
+TAPI void transform_system_set_rotation(u32 handle, quat rotation);
+TAPI void transform_system_rotate(u32 handle, quat rotation);
+
+TAPI vec3 transform_system_get_scale(u32 handle);
+TAPI void transform_system_set_scale(u32 handle, vec3 scale);
+TAPI void transform_system_scale(u32 handle, vec3 scale);
+
+/**
+ * @brief Returns the local matrix of a transform as of the last update.
+ */
+TAPI mat4 transform_system_get_local(u32 handle);
+
+/**
+ * @brief Returns the world matrix of a transform as of the last update.
+ */
+TAPI mat4 transform_system_get_world(u32 handle);
+
+/**
+ * @brief Recomputes the local and world matrices of every dirty transform, and the world
+ * matrices of everything below them. Call once per frame, after the frame's changes and
+ * before anything reads the matrices.
+ */
+TAPI void transform_system_update();
+
+/** @brief Returns the number of transforms that exist. */
+TAPI u32 transform_system_count();
@@ -14,6 +14,11 @@ b8 create_game(game* out_game){
     out_game->app_config.start_width = 1280;
     out_game->app_config.start_height = 720;
     out_game->app_config.name = "Taller Engine Testbed";
+    out_game->app_config.target_frame_rate = 60;
+    out_game->app_config.headless = FALSE;
+    out_game->app_config.max_frame_count = 0;
+    out_game->app_config.record_path = 0;
+    out_game->app_config.replay_path = 0;
     out_game->initialize = game_initialize;
     out_game->update = game_update;
     out_game->render = game_render;
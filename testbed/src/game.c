@@ -4,6 +4,7 @@
 #include <core/input.h>
 #include <core/tmemory.h>
 #include <core/event.h>
+#include <core/application.h>
 
 #include <math/tmath.h>
 #include <renderer/renderer_types.inl>
@@ -26,6 +27,9 @@ b8 game_update(game* game_inst, f32 delta_time){
     alloc_count = get_memory_alloc_count();
     if(input_is_key_up('M') && input_was_key_down('M')){
         TDEBUG("Allocations: %llu (%llu this frame)", alloc_count, alloc_count - prev_alloc_count);
+        u64 frame_memory_used, frame_memory_peak;
+        application_get_frame_memory_usage(&frame_memory_used, &frame_memory_peak);
+        TDEBUG("Frame memory: %lluB last frame (peak %lluB)", frame_memory_used, frame_memory_peak);
     }
     
     // TODO: temporary
@@ -110,6 +114,12 @@ b8 game_update(game* game_inst, f32 delta_time){
         event_fire(EVENT_CODE_SET_RENDER_MODE, game_inst, data);
     }
 
+    // Capture the profiler's recent history to profile.json.
+    if(input_is_key_up('P') && input_was_key_down('P')){
+        event_context context = {};
+        event_fire(EVENT_CODE_PROFILER_CAPTURE, game_inst, context);
+    }
+
     // Bind a key to lead up some data.
     if(input_is_key_up('L') && input_was_key_down('L')){
         event_context context = {};
@@ -288,10 +288,191 @@ u8 freelist_should_allocate_to_full_and_fail_to_allocate_more(){
     return TRUE;
 }
 
+u8 freelist_should_coalesce_random_frees_back_to_one_block(){
+    freelist list;
+
+    u64 memory_requirement = 0;
+    u64 total_size = MEBIBYTES(1);
+    freelist_create(total_size, &memory_requirement, 0, 0);
+    void* block = tallocate(memory_requirement, MEMORY_TAG_APPLICATION);
+    freelist_create(total_size, &memory_requirement, block, &list);
+
+    // Fill the list with blocks of varying sizes.
+    const u32 count = 512;
+    u64 offsets[512];
+    u64 sizes[512];
+    u64 allocated = 0;
+    u32 seed = 1234;
+    for(u32 i = 0; i < count; ++i){
+        seed = seed * 1103515245 + 12345;
+        sizes[i] = 16 + ((seed >> 16) % 480);
+        b8 result = freelist_allocate_block(&list, sizes[i], &offsets[i]);
+        expect_to_be_true(result);
+        allocated += sizes[i];
+    }
+    expect_should_be(total_size - allocated, freelist_free_space(&list));
+
+    // Free them in a shuffled order. Every free should merge with whatever neighbours are already free.
+    u32 order[512];
+    for(u32 i = 0; i < count; ++i){
+        order[i] = i;
+    }
+    for(u32 i = count - 1; i > 0; --i){
+        seed = seed * 1103515245 + 12345;
+        u32 j = (seed >> 16) % (i + 1);
+        u32 temp = order[i];
+        order[i] = order[j];
+        order[j] = temp;
+    }
+    for(u32 i = 0; i < count; ++i){
+        b8 result = freelist_free_block(&list, sizes[order[i]], offsets[order[i]]);
+        expect_to_be_true(result);
+    }
+
+    // Everything should have merged back into a single block.
+    expect_should_be(total_size, freelist_free_space(&list));
+    expect_should_be(1, freelist_free_block_count(&list));
+    expect_should_be(total_size, freelist_largest_free_block(&list));
+
+    freelist_destroy(&list);
+    tfree(block, memory_requirement, MEMORY_TAG_APPLICATION);
+
+    return TRUE;
+}
+
+u8 freelist_should_report_fragmentation(){
+    freelist list;
+
+    u64 memory_requirement = 0;
+    u64 total_size = 512;
+    freelist_create(total_size, &memory_requirement, 0, 0);
+    void* block = tallocate(memory_requirement, MEMORY_TAG_APPLICATION);
+    freelist_create(total_size, &memory_requirement, block, &list);
+
+    // Allocate 8 blocks of 64, filling the list.
+    u64 offsets[8];
+    for(u32 i = 0; i < 8; ++i){
+        expect_to_be_true(freelist_allocate_block(&list, 64, &offsets[i]));
+    }
+    expect_should_be(0, freelist_free_block_count(&list));
+    expect_should_be(0, freelist_largest_free_block(&list));
+
+    // Free every other block, leaving 4 separate holes.
+    for(u32 i = 0; i < 8; i += 2){
+        expect_to_be_true(freelist_free_block(&list, 64, offsets[i]));
+    }
+    expect_should_be(256, freelist_free_space(&list));
+    expect_should_be(4, freelist_free_block_count(&list));
+    expect_should_be(64, freelist_largest_free_block(&list));
+
+    // Even with 256 bytes free, there is no room for 128 contiguous bytes.
+    u64 offset = INVALID_ID;
+    TDEBUG("The following warning message is intentional.");
+    expect_to_be_false(freelist_allocate_block(&list, 128, &offset));
+
+    // Freeing the block between the first two holes joins all three.
+    expect_to_be_true(freelist_free_block(&list, 64, offsets[1]));
+    expect_should_be(3, freelist_free_block_count(&list));
+    expect_should_be(192, freelist_largest_free_block(&list));
+    expect_to_be_true(freelist_allocate_block(&list, 128, &offset));
+    expect_should_be(offsets[0], offset);
+
+    freelist_destroy(&list);
+    tfree(block, memory_requirement, MEMORY_TAG_APPLICATION);
+
+    return TRUE;
+}
+
+u8 freelist_should_resize_and_keep_free_ranges(){
+    freelist list;
+
+    u64 memory_requirement = 0;
+    u64 total_size = 512;
+    freelist_create(total_size, &memory_requirement, 0, 0);
+    void* block = tallocate(memory_requirement, MEMORY_TAG_APPLICATION);
+    freelist_create(total_size, &memory_requirement, block, &list);
+
+    // Leave a hole at the front, with the rest of the list used.
+    u64 offset_a = INVALID_ID;
+    u64 offset_b = INVALID_ID;
+    expect_to_be_true(freelist_allocate_block(&list, 64, &offset_a));
+    expect_to_be_true(freelist_allocate_block(&list, 448, &offset_b));
+    expect_to_be_true(freelist_free_block(&list, 64, offset_a));
+
+    // Query the requirement for the new size, then resize into a new block.
+    u64 new_size = 1024;
+    u64 new_memory_requirement = 0;
+    expect_to_be_true(freelist_resize(&list, &new_memory_requirement, 0, new_size, 0));
+    void* new_block = tallocate(new_memory_requirement, MEMORY_TAG_APPLICATION);
+    void* old_block = 0;
+    expect_to_be_true(freelist_resize(&list, &new_memory_requirement, new_block, new_size, &old_block));
+    expect_should_be(block, old_block);
+    tfree(old_block, memory_requirement, MEMORY_TAG_APPLICATION);
+
+    // The old hole and the new space are free, but not contiguous.
+    expect_should_be(64 + 512, freelist_free_space(&list));
+    expect_should_be(2, freelist_free_block_count(&list));
+    expect_should_be(512, freelist_largest_free_block(&list));
+
+    // Freeing the used block joins everything back together.
+    expect_to_be_true(freelist_free_block(&list, 448, offset_b));
+    expect_should_be(1, freelist_free_block_count(&list));
+    expect_should_be(new_size, freelist_largest_free_block(&list));
+
+    freelist_destroy(&list);
+    tfree(new_block, new_memory_requirement, MEMORY_TAG_APPLICATION);
+
+    return TRUE;
+}
+
+u8 freelist_should_grow_nodes_when_fragmented(){
+    freelist list;
+
+    // 64 KiB only budgets 64 nodes, far fewer than the holes made below.
+    u64 memory_requirement = 0;
+    u64 total_size = KIBIBYTES(64);
+    freelist_create(total_size, &memory_requirement, 0, 0);
+    void* block = tallocate(memory_requirement, MEMORY_TAG_APPLICATION);
+    freelist_create(total_size, &memory_requirement, block, &list);
+
+    const u32 count = KIBIBYTES(64) / 16;
+    u64* offsets = tallocate(sizeof(u64) * count, MEMORY_TAG_APPLICATION);
+    for(u32 i = 0; i < count; ++i){
+        expect_to_be_true(freelist_allocate_block(&list, 16, &offsets[i]));
+    }
+
+    // Every other block leaves a separate hole, so none of these frees can merge.
+    for(u32 i = 0; i < count; i += 2){
+        expect_to_be_true(freelist_free_block(&list, 16, offsets[i]));
+    }
+    expect_should_be(count / 2, freelist_free_block_count(&list));
+    expect_should_be(total_size / 2, freelist_free_space(&list));
+
+    // The holes are still usable, and filling them back in merges everything.
+    u64 offset = INVALID_ID;
+    expect_to_be_true(freelist_allocate_block(&list, 16, &offset));
+    expect_to_be_true(freelist_free_block(&list, 16, offset));
+    for(u32 i = 1; i < count; i += 2){
+        expect_to_be_true(freelist_free_block(&list, 16, offsets[i]));
+    }
+    expect_should_be(1, freelist_free_block_count(&list));
+    expect_should_be(total_size, freelist_largest_free_block(&list));
+
+    tfree(offsets, sizeof(u64) * count, MEMORY_TAG_APPLICATION);
+    freelist_destroy(&list);
+    tfree(block, memory_requirement, MEMORY_TAG_APPLICATION);
+
+    return TRUE;
+}
+
 void freelist_register_tests(){
     test_manager_register_test(freelist_should_create_and_destroy, "Freelist should create and destroy");
     test_manager_register_test(freelist_should_allocate_one_and_free_one, "Freelist allocate and free one");
     test_manager_register_test(freelist_should_allocate_one_and_free_multi, "Freelist allocate and free multiple entries.");
     test_manager_register_test(freelist_should_allocate_one_and_free_multi_varying_sizes, "Freelist allocate and free multiple entries of varying sizes.");
     test_manager_register_test(freelist_should_allocate_to_full_and_fail_to_allocate_more, "Freelist allocate to full and fail when trying to allocate more.");
+    test_manager_register_test(freelist_should_coalesce_random_frees_back_to_one_block, "Freelist should coalesce random frees back into one block.");
+    test_manager_register_test(freelist_should_report_fragmentation, "Freelist should report free block count and largest free block.");
+    test_manager_register_test(freelist_should_resize_and_keep_free_ranges, "Freelist should resize and keep existing free ranges.");
+    test_manager_register_test(freelist_should_grow_nodes_when_fragmented, "Freelist should grow its nodes rather than lose ranges when fragmented.");
 }
\ No newline at end of file
@@ -4,6 +4,7 @@
 
 #include <defines.h>
 #include <containers/hashtable.h>
+#include <core/tstring.h>
 
 u8 hashtable_should_create_and_destroy(){
     hashtable table;
@@ -318,6 +319,159 @@ u8 hashtable_should_set_get_and_update_ptr_successfully(){
     return TRUE;
 }
 
+u8 hashtable_should_keep_many_entries_without_collisions(){
+    hashtable table;
+    u64 element_size = sizeof(u64);
+    u64 element_count = 1024;
+    u64 memory[1024];
+
+    hashtable_create(element_size, element_count, memory, FALSE, &table);
+
+    // Fill the table completely. Every name must keep its own value.
+    char name[32];
+    for(u64 i = 0; i < element_count; ++i){
+        string_format(name, "texture_%llu", i);
+        expect_to_be_true(hashtable_set(&table, name, &i));
+    }
+    expect_should_be(element_count, table.entry_count);
+
+    for(u64 i = 0; i < element_count; ++i){
+        string_format(name, "texture_%llu", i);
+        u64 value = INVALID_ID_U64;
+        hashtable_get(&table, name, &value);
+        expect_should_be(i, value);
+        expect_to_be_true(hashtable_contains(&table, name));
+    }
+
+    // The load factor should stay below 1 even with a full value block.
+    f32 load_factor = hashtable_load_factor(&table);
+    expect_to_be_true(load_factor > 0.8f && load_factor < 1.0f);
+
+    hashtable_destroy(&table);
+    expect_should_be(0, table.memory);
+
+    return TRUE;
+}
+
+u8 hashtable_should_remove_and_reinsert(){
+    hashtable table;
+    u64 element_size = sizeof(u64);
+    u64 element_count = 64;
+    u64 memory[64];
+
+    hashtable_create(element_size, element_count, memory, FALSE, &table);
+
+    char name[32];
+    for(u64 i = 0; i < element_count; ++i){
+        string_format(name, "material_%llu", i);
+        hashtable_set(&table, name, &i);
+    }
+
+    // Remove every other entry.
+    for(u64 i = 0; i < element_count; i += 2){
+        string_format(name, "material_%llu", i);
+        expect_to_be_true(hashtable_remove(&table, name));
+    }
+    expect_should_be(element_count / 2, table.entry_count);
+
+    // Removing twice should fail.
+    expect_to_be_false(hashtable_remove(&table, "material_0"));
+
+    // Remaining entries should be intact, removed ones gone.
+    for(u64 i = 0; i < element_count; ++i){
+        string_format(name, "material_%llu", i);
+        b8 exists = hashtable_contains(&table, name);
+        if(i % 2 == 0){
+            expect_to_be_false(exists);
+        } else {
+            expect_to_be_true(exists);
+            u64 value = 0;
+            hashtable_get(&table, name, &value);
+            expect_should_be(i, value);
+        }
+    }
+
+    // Reinsert many times over to churn through deleted slots.
+    for(u32 round = 0; round < 8; ++round){
+        for(u64 i = 0; i < element_count; i += 2){
+            string_format(name, "material_%llu", i);
+            u64 value = i + round;
+            hashtable_set(&table, name, &value);
+        }
+        for(u64 i = 0; i < element_count; i += 2){
+            string_format(name, "material_%llu", i);
+            u64 value = 0;
+            hashtable_get(&table, name, &value);
+            expect_should_be(i + round, value);
+            hashtable_remove(&table, name);
+        }
+    }
+    expect_should_be(element_count / 2, table.entry_count);
+    // Never grew, so the caller's block is still in use.
+    expect_to_be_false(table.owns_memory);
+
+    hashtable_destroy(&table);
+
+    return TRUE;
+}
+
+u8 hashtable_should_grow_when_full(){
+    hashtable table;
+    u64 element_size = sizeof(u32);
+    u64 element_count = 4;
+    u32 memory[4];
+
+    hashtable_create(element_size, element_count, memory, FALSE, &table);
+    u32 invalid = INVALID_ID;
+    hashtable_fill(&table, &invalid);
+
+    char name[32];
+    for(u32 i = 0; i < 100; ++i){
+        string_format(name, "shader_%u", i);
+        expect_to_be_true(hashtable_set(&table, name, &i));
+    }
+    expect_should_be(100, table.entry_count);
+    expect_to_be_true(table.element_count >= 100);
+    expect_to_be_true(table.owns_memory);
+
+    for(u32 i = 0; i < 100; ++i){
+        string_format(name, "shader_%u", i);
+        u32 value = INVALID_ID;
+        hashtable_get(&table, name, &value);
+        expect_should_be(i, value);
+    }
+
+    // The fill value should survive growing.
+    u32 value = 0;
+    hashtable_get(&table, "not_there", &value);
+    expect_should_be(INVALID_ID, value);
+
+    hashtable_destroy(&table);
+    expect_should_be(0, table.memory);
+
+    return TRUE;
+}
+
+u8 hashtable_should_return_fill_value_for_nonexistant(){
+    hashtable table;
+    u64 element_size = sizeof(u32);
+    u64 element_count = 3;
+    u32 memory[3];
+
+    hashtable_create(element_size, element_count, memory, FALSE, &table);
+    u32 invalid = INVALID_ID;
+    hashtable_fill(&table, &invalid);
+
+    u32 value = 0;
+    expect_to_be_true(hashtable_get(&table, "test1", &value));
+    expect_should_be(INVALID_ID, value);
+    expect_to_be_false(hashtable_contains(&table, "test1"));
+
+    hashtable_destroy(&table);
+
+    return TRUE;
+}
+
 void hashtable_register_tests(){
     test_manager_register_test(hashtable_should_create_and_destroy, "Hashtable should create and destroy");
     test_manager_register_test(hashtable_should_set_and_get_successfully, "Hashtable should set and get");
@@ -328,4 +482,8 @@ void hashtable_register_tests(){
     test_manager_register_test(hashtable_try_call_non_ptr_on_ptr_table, "Hashtable try call non-pointer functions on pointer type table");
     test_manager_register_test(hashtable_try_call_ptr_on_non_ptr_table, "Hashtable try call pointer functions on non-pointer type table");
     test_manager_register_test(hashtable_should_set_get_and_update_ptr_successfully, "Hashtable should get pointer, update and get again successfully");
+    test_manager_register_test(hashtable_should_keep_many_entries_without_collisions, "Hashtable should keep many entries without collisions");
+    test_manager_register_test(hashtable_should_remove_and_reinsert, "Hashtable should remove and reinsert entries");
+    test_manager_register_test(hashtable_should_grow_when_full, "Hashtable should grow when full");
+    test_manager_register_test(hashtable_should_return_fill_value_for_nonexistant, "Hashtable should return fill value for non-existent entry");
 }
\ No newline at end of file
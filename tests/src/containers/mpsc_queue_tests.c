@@ -0,0 +1,123 @@
+#include "mpsc_queue_tests.h"
+#include "../test_manager.h"
+#include "../expect.h"
+
+#include <defines.h>
+#include <containers/mpsc_queue.h>
+#include <core/tthread.h>
+#include <platform/platform.h>
+
+#define PRODUCER_COUNT 4
+#define VALUES_PER_PRODUCER 20000
+
+typedef struct producer_params {
+    mpsc_queue* queue;
+    u32 producer_index;
+} producer_params;
+
+static u32 producer_run(void* params){
+    producer_params* p = params;
+    for(u32 i = 0; i < VALUES_PER_PRODUCER; ++i){
+        u64 value = ((u64)p->producer_index << 32) | i;
+        while(!mpsc_queue_enqueue(p->queue, &value)){
+            // Full, let the consumer catch up.
+            platform_sleep(0);
+        }
+    }
+    return 1;
+}
+
+u8 mpsc_queue_should_enqueue_and_dequeue_in_order(){
+    mpsc_queue queue;
+    expect_to_be_true(mpsc_queue_create(sizeof(u64), 5, 0, &queue));
+    // Capacity is rounded up to a power of two.
+    expect_should_be(8, queue.capacity);
+
+    // Go around the ring a few times.
+    for(u64 round = 0; round < 4; ++round){
+        for(u64 i = 0; i < 6; ++i){
+            u64 value = round * 100 + i;
+            expect_to_be_true(mpsc_queue_enqueue(&queue, &value));
+        }
+        expect_should_be(6, mpsc_queue_length(&queue));
+        for(u64 i = 0; i < 6; ++i){
+            u64 value = 0;
+            expect_to_be_true(mpsc_queue_dequeue(&queue, &value));
+            expect_should_be(round * 100 + i, value);
+        }
+    }
+
+    u64 value = 0;
+    expect_to_be_false(mpsc_queue_dequeue(&queue, &value));
+
+    mpsc_queue_destroy(&queue);
+    expect_should_be(0, queue.block);
+    return TRUE;
+}
+
+u8 mpsc_queue_should_refuse_when_full(){
+    mpsc_queue queue;
+    mpsc_queue_create(sizeof(u32), 4, 0, &queue);
+
+    for(u32 i = 0; i < 4; ++i){
+        expect_to_be_true(mpsc_queue_enqueue(&queue, &i));
+    }
+    u32 extra = 99;
+    expect_to_be_false(mpsc_queue_enqueue(&queue, &extra));
+
+    // Freeing one slot makes room again.
+    u32 value = 0;
+    expect_to_be_true(mpsc_queue_dequeue(&queue, &value));
+    expect_should_be(0, value);
+    expect_to_be_true(mpsc_queue_enqueue(&queue, &extra));
+
+    mpsc_queue_destroy(&queue);
+    return TRUE;
+}
+
+u8 mpsc_queue_should_keep_every_value_from_many_producers(){
+    mpsc_queue queue;
+    mpsc_queue_create(sizeof(u64), 256, 0, &queue);
+
+    producer_params params[PRODUCER_COUNT];
+    tthread threads[PRODUCER_COUNT];
+    for(u32 i = 0; i < PRODUCER_COUNT; ++i){
+        params[i].queue = &queue;
+        params[i].producer_index = i;
+        expect_to_be_true(tthread_create(producer_run, &params[i], FALSE, &threads[i]));
+    }
+
+    // Each producer's values must arrive in the order it sent them.
+    u32 next_expected[PRODUCER_COUNT] = {0};
+    u32 received = 0;
+    b8 in_order = TRUE;
+    while(received < PRODUCER_COUNT * VALUES_PER_PRODUCER){
+        u64 value;
+        if(mpsc_queue_dequeue(&queue, &value)){
+            u32 producer = (u32)(value >> 32);
+            u32 index = (u32)value;
+            in_order = in_order && producer < PRODUCER_COUNT && next_expected[producer] == index;
+            if(producer < PRODUCER_COUNT){
+                next_expected[producer] = index + 1;
+            }
+            received++;
+        }
+    }
+
+    for(u32 i = 0; i < PRODUCER_COUNT; ++i){
+        tthread_wait(&threads[i]);
+    }
+
+    expect_to_be_true(in_order);
+    u64 value;
+    expect_to_be_false(mpsc_queue_dequeue(&queue, &value));
+
+    mpsc_queue_destroy(&queue);
+    return TRUE;
+}
+
+void mpsc_queue_register_tests(){
+    test_manager_register_test(mpsc_queue_should_enqueue_and_dequeue_in_order, "MPSC queue should enqueue and dequeue in order");
+    test_manager_register_test(mpsc_queue_should_refuse_when_full, "MPSC queue should refuse values when full");
+    test_manager_register_test(mpsc_queue_should_keep_every_value_from_many_producers, "MPSC queue should keep every value from many producers");
+}
@@ -0,0 +1,136 @@
+#include "frame_pacing_tests.h"
+#include "../test_manager.h"
+#include "../expect.h"
+
+#include <defines.h>
+#include <core/frame_pacing.h>
+#include <core/tmemory.h>
+#include <platform/platform.h>
+
+static void start_frame_pacing(u32 target_frame_rate, void** out_state, u64* out_size){
+    memory_system_configuration memory_config = {};
+    memory_config.total_alloc_size = MEBIBYTES(16);
+    memory_system_initialize(memory_config);
+
+    frame_pacing_config config = {};
+    config.target_frame_rate = target_frame_rate;
+    config.spin_milliseconds = 2.0;
+    frame_pacing_initialize(out_size, 0, config);
+    *out_state = tallocate(*out_size, MEMORY_TAG_APPLICATION);
+    frame_pacing_initialize(out_size, *out_state, config);
+}
+
+static void stop_frame_pacing(void* state, u64 size){
+    frame_pacing_shutdown(state);
+    tfree(state, size, MEMORY_TAG_APPLICATION);
+    memory_system_shutdown();
+}
+
+u8 frame_pacing_should_hold_the_target_frame_rate(){
+    void* state;
+    u64 size;
+    start_frame_pacing(100, &state, &size);
+
+    for(u32 i = 0; i < 20; ++i){
+        frame_pacing_end_frame();
+    }
+
+    frame_stats stats;
+    expect_to_be_true(frame_pacing_get_stats(&stats));
+    expect_should_be(20, stats.frame_count);
+    // Frames never end early. Late wakeups are made up on the following frames, so the
+    // mean stays close to the target even on a busy machine.
+    expect_to_be_true(stats.p50_ms >= 9.9);
+    expect_to_be_true(stats.mean_ms >= 9.9 && stats.mean_ms < 12.0);
+    expect_to_be_true(stats.wait_mean_ms > 9.0);
+
+    stop_frame_pacing(state, size);
+    return TRUE;
+}
+
+u8 frame_pacing_should_time_each_phase(){
+    void* state;
+    u64 size;
+    start_frame_pacing(0, &state, &size);
+
+    for(u32 i = 0; i < 4; ++i){
+        frame_pacing_phase_begin(FRAME_PHASE_UPDATE);
+        platform_sleep(2);
+        frame_pacing_phase_end(FRAME_PHASE_UPDATE);
+        frame_pacing_phase_begin(FRAME_PHASE_DRAW);
+        platform_sleep(1);
+        frame_pacing_phase_end(FRAME_PHASE_DRAW);
+        // A phase entered twice in a frame accumulates.
+        frame_pacing_phase_begin(FRAME_PHASE_DRAW);
+        platform_sleep(1);
+        frame_pacing_phase_end(FRAME_PHASE_DRAW);
+        frame_pacing_end_frame();
+    }
+
+    frame_stats stats;
+    expect_to_be_true(frame_pacing_get_stats(&stats));
+    expect_should_be(4, stats.frame_count);
+    expect_to_be_true(stats.phase_mean_ms[FRAME_PHASE_UPDATE] >= 2.0);
+    expect_to_be_true(stats.phase_mean_ms[FRAME_PHASE_DRAW] >= 2.0);
+    expect_to_be_true(stats.phase_mean_ms[FRAME_PHASE_INPUT] == 0.0);
+    expect_to_be_true(stats.wait_mean_ms < 1.0);
+    expect_to_be_true(stats.mean_ms >= 4.0);
+
+    stop_frame_pacing(state, size);
+    return TRUE;
+}
+
+u8 frame_pacing_should_count_hitches(){
+    void* state;
+    u64 size;
+    start_frame_pacing(100, &state, &size);
+
+    for(u32 i = 0; i < 5; ++i){
+        frame_pacing_end_frame();
+    }
+    // Well over twice the 10ms target.
+    platform_sleep(40);
+    frame_pacing_end_frame();
+    for(u32 i = 0; i < 5; ++i){
+        frame_pacing_end_frame();
+    }
+
+    frame_stats stats;
+    expect_to_be_true(frame_pacing_get_stats(&stats));
+    expect_should_be(11, stats.frame_count);
+    expect_should_be(1, stats.hitch_count);
+    expect_to_be_true(stats.max_ms >= 40.0);
+    // The long frame is the slowest; the rest are on target.
+    expect_to_be_true(stats.p50_ms < 15.0);
+
+    stop_frame_pacing(state, size);
+    return TRUE;
+}
+
+u8 frame_pacing_should_keep_a_rolling_window(){
+    void* state;
+    u64 size;
+    start_frame_pacing(0, &state, &size);
+
+    for(u32 i = 0; i < FRAME_PACING_WINDOW + 10; ++i){
+        frame_pacing_end_frame();
+    }
+
+    frame_stats stats;
+    expect_to_be_true(frame_pacing_get_stats(&stats));
+    expect_should_be(FRAME_PACING_WINDOW, stats.frame_count);
+    expect_should_be(FRAME_PACING_WINDOW + 10, stats.total_frames);
+    expect_to_be_true(stats.p50_ms <= stats.p95_ms);
+    expect_to_be_true(stats.p95_ms <= stats.p99_ms);
+    expect_to_be_true(stats.p99_ms <= stats.max_ms);
+
+    stop_frame_pacing(state, size);
+    return TRUE;
+}
+
+void frame_pacing_register_tests(){
+    test_manager_register_test(frame_pacing_should_hold_the_target_frame_rate, "Frame pacing should hold the target frame rate");
+    test_manager_register_test(frame_pacing_should_time_each_phase, "Frame pacing should time each phase");
+    test_manager_register_test(frame_pacing_should_count_hitches, "Frame pacing should count hitches");
+    test_manager_register_test(frame_pacing_should_keep_a_rolling_window, "Frame pacing should keep a rolling window");
+}
@@ -0,0 +1,3 @@
+#pragma once
+
+void frame_pacing_register_tests();
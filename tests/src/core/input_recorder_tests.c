@@ -0,0 +1,238 @@
+#include "input_recorder_tests.h"
+#include "../test_manager.h"
+#include "../expect.h"
+
+#include <defines.h>
+#include <core/event.h>
+#include <core/input.h>
+#include <core/input_recorder.h>
+#include <core/tmemory.h>
+#include <platform/filesystem.h>
+
+#define RECORDING_PATH "input_recorder_test.tinr"
+
+typedef struct recorder_test_state {
+    void* event_state;
+    u64 event_size;
+    void* input_state;
+    u64 input_size;
+    void* recorder_state;
+    u64 recorder_size;
+} recorder_test_state;
+
+static void start_systems(recorder_test_state* out_state){
+    memory_system_configuration memory_config = {};
+    memory_config.total_alloc_size = MEBIBYTES(16);
+    memory_system_initialize(memory_config);
+
+    event_system_initialize(&out_state->event_size, 0);
+    out_state->event_state = tallocate(out_state->event_size, MEMORY_TAG_APPLICATION);
+    event_system_initialize(&out_state->event_size, out_state->event_state);
+
+    input_system_initialize(&out_state->input_size, 0);
+    out_state->input_state = tallocate(out_state->input_size, MEMORY_TAG_APPLICATION);
+    input_system_initialize(&out_state->input_size, out_state->input_state);
+
+    input_recorder_initialize(&out_state->recorder_size, 0);
+    out_state->recorder_state = tallocate(out_state->recorder_size, MEMORY_TAG_APPLICATION);
+    input_recorder_initialize(&out_state->recorder_size, out_state->recorder_state);
+}
+
+static void stop_systems(recorder_test_state* state){
+    input_recorder_shutdown(state->recorder_state);
+    tfree(state->recorder_state, state->recorder_size, MEMORY_TAG_APPLICATION);
+    input_system_shutdown(state->input_state);
+    tfree(state->input_state, state->input_size, MEMORY_TAG_APPLICATION);
+    event_system_shutdown(state->event_state);
+    tfree(state->event_state, state->event_size, MEMORY_TAG_APPLICATION);
+    memory_system_shutdown();
+}
+
+static u16 resized_width;
+static u16 resized_height;
+
+static b8 on_resized(u16 code, void* sender, void* listener_inst, event_context context){
+    resized_width = context.data.u16[0];
+    resized_height = context.data.u16[1];
+    return FALSE;
+}
+
+/** Records three frames of input: A pressed with a mouse move, a resize, then A released. */
+static void record_three_frames(){
+    f64 delta = 0.02;
+    input_recorder_start_recording(RECORDING_PATH);
+
+    // Frame 0. The platform delivers input before the frame begins.
+    input_process_key(KEY_A, TRUE);
+    input_process_mouse_move(30, 40);
+    input_recorder_begin_frame(&delta);
+    input_update(delta);
+
+    // Frame 1.
+    event_context context;
+    context.data.u16[0] = 1024;
+    context.data.u16[1] = 768;
+    event_fire(EVENT_CODE_RESIZED, 0, context);
+    input_recorder_begin_frame(&delta);
+    input_update(delta);
+
+    // Frame 2.
+    input_process_key(KEY_A, FALSE);
+    input_recorder_begin_frame(&delta);
+    input_update(delta);
+
+    input_recorder_stop_recording();
+}
+
+u8 input_recorder_should_write_header_and_records(){
+    recorder_test_state state;
+    start_systems(&state);
+    record_three_frames();
+
+    file_handle handle;
+    expect_to_be_true(filesystem_open(RECORDING_PATH, FILE_MODE_READ, TRUE, &handle));
+    input_recording_header header;
+    u64 read = 0;
+    expect_to_be_true(filesystem_read(&handle, sizeof(header), &header, &read));
+    u64 size = 0;
+    filesystem_size(&handle, &size);
+    filesystem_close(&handle);
+
+    expect_should_be(INPUT_RECORDING_MAGIC, header.magic);
+    expect_should_be(INPUT_RECORDING_VERSION, header.version);
+    expect_should_be(3, header.frame_count);
+    expect_should_be(4, header.record_count);
+    expect_float_to_be(0.06, header.duration_seconds);
+    expect_should_be(sizeof(input_recording_header) + sizeof(input_record) * 4, size);
+
+    stop_systems(&state);
+    return TRUE;
+}
+
+u8 input_recorder_should_replay_frame_accurately(){
+    recorder_test_state state;
+    start_systems(&state);
+    record_three_frames();
+
+    // Start from a clean slate.
+    stop_systems(&state);
+    start_systems(&state);
+    event_register(EVENT_CODE_RESIZED, 0, on_resized);
+    resized_width = 0;
+    resized_height = 0;
+
+    expect_to_be_true(input_recorder_start_replay(RECORDING_PATH, 0));
+    expect_to_be_true(input_recorder_is_replaying());
+
+    // Frame 0: the key goes down and the mouse moves. The delta is the recording's mean.
+    f64 delta = 1.0;
+    expect_to_be_true(input_recorder_begin_frame(&delta));
+    expect_float_to_be(0.02, delta);
+    expect_to_be_true(input_is_key_down(KEY_A));
+    i32 x, y;
+    input_get_mouse_position(&x, &y);
+    expect_should_be(30, x);
+    expect_should_be(40, y);
+    expect_should_be(0, resized_width);
+    input_update(delta);
+
+    // Frame 1: only the resize.
+    expect_to_be_true(input_recorder_begin_frame(&delta));
+    expect_should_be(1024, resized_width);
+    expect_should_be(768, resized_height);
+    expect_to_be_true(input_is_key_down(KEY_A));
+    input_update(delta);
+
+    // Frame 2: the key comes back up.
+    expect_to_be_true(input_recorder_begin_frame(&delta));
+    expect_to_be_false(input_is_key_down(KEY_A));
+    input_update(delta);
+
+    // Then the recording has run out.
+    expect_to_be_false(input_recorder_begin_frame(&delta));
+    expect_to_be_false(input_recorder_is_replaying());
+
+    event_unregister(EVENT_CODE_RESIZED, 0, on_resized);
+    stop_systems(&state);
+    return TRUE;
+}
+
+u8 input_recorder_should_ignore_live_input_while_replaying(){
+    recorder_test_state state;
+    start_systems(&state);
+    record_three_frames();
+
+    expect_to_be_true(input_recorder_start_replay(RECORDING_PATH, 0.5));
+    f64 delta = 0;
+    expect_to_be_true(input_recorder_begin_frame(&delta));
+    expect_float_to_be(0.5, delta);
+
+    // Live input is dropped; only the recording drives input state.
+    input_process_key(KEY_B, TRUE);
+    input_process_mouse_move(1, 2);
+    expect_to_be_false(input_is_key_down(KEY_B));
+    i32 x, y;
+    input_get_mouse_position(&x, &y);
+    expect_should_be(30, x);
+
+    // Once replay is stopped, live input gets through again.
+    input_recorder_stop_replay();
+    input_process_key(KEY_B, TRUE);
+    expect_to_be_true(input_is_key_down(KEY_B));
+
+    stop_systems(&state);
+    return TRUE;
+}
+
+// Handles resizes the way the application does on minimize, so no one after it sees them.
+static b8 on_resized_handled(u16 code, void* sender, void* listener_inst, event_context context){
+    return TRUE;
+}
+
+u8 input_recorder_should_record_resizes_handled_by_others(){
+    recorder_test_state state;
+    start_systems(&state);
+    event_register(EVENT_CODE_RESIZED, 0, on_resized_handled);
+    record_three_frames();
+    event_unregister(EVENT_CODE_RESIZED, 0, on_resized_handled);
+
+    file_handle handle;
+    expect_to_be_true(filesystem_open(RECORDING_PATH, FILE_MODE_READ, TRUE, &handle));
+    input_recording_header header;
+    u64 read = 0;
+    expect_to_be_true(filesystem_read(&handle, sizeof(header), &header, &read));
+    filesystem_close(&handle);
+
+    // The resize is among the records.
+    expect_should_be(4, header.record_count);
+
+    stop_systems(&state);
+    return TRUE;
+}
+
+u8 input_recorder_should_reject_invalid_files(){
+    recorder_test_state state;
+    start_systems(&state);
+
+    expect_to_be_false(input_recorder_start_replay("input_recorder_missing.tinr", 0));
+
+    file_handle handle;
+    filesystem_open(RECORDING_PATH, FILE_MODE_WRITE, TRUE, &handle);
+    u64 written = 0;
+    const char junk[] = "not an input recording at all";
+    filesystem_write(&handle, sizeof(junk), junk, &written);
+    filesystem_close(&handle);
+    expect_to_be_false(input_recorder_start_replay(RECORDING_PATH, 0));
+    expect_to_be_false(input_recorder_is_replaying());
+
+    stop_systems(&state);
+    return TRUE;
+}
+
+void input_recorder_register_tests(){
+    test_manager_register_test(input_recorder_should_write_header_and_records, "Input recorder should write a header and every input.");
+    test_manager_register_test(input_recorder_should_replay_frame_accurately, "Input recorder should replay input on the frames it was recorded.");
+    test_manager_register_test(input_recorder_should_ignore_live_input_while_replaying, "Input recorder should ignore live input while replaying.");
+    test_manager_register_test(input_recorder_should_record_resizes_handled_by_others, "Input recorder should record resizes that other listeners handle.");
+    test_manager_register_test(input_recorder_should_reject_invalid_files, "Input recorder should reject files that are not recordings.");
+}
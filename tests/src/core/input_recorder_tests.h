@@ -0,0 +1,3 @@
+#pragma once
+
+void input_recorder_register_tests();
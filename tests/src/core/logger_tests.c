@@ -0,0 +1,169 @@
+#include "logger_tests.h"
+#include "../test_manager.h"
+#include "../expect.h"
+
+#include <defines.h>
+#include <core/logger.h>
+#include <core/tmemory.h>
+#include <core/tstring.h>
+#include <core/tthread.h>
+#include <platform/filesystem.h>
+
+#define LOGGER_TEST_THREAD_COUNT 4
+#define LOGGER_TEST_MESSAGES_PER_THREAD 200
+
+static u32 count_occurrences(const char* text, const char* needle){
+    u32 count = 0;
+    u64 needle_length = string_length(needle);
+    for(const char* c = text; *c; ++c){
+        if(strings_nequal(c, needle, needle_length)){
+            count++;
+        }
+    }
+    return count;
+}
+
+/** Gets the offset of the first occurrence of needle in text, or -1. */
+static i64 find_offset(const char* text, const char* needle){
+    u64 needle_length = string_length(needle);
+    for(const char* c = text; *c; ++c){
+        if(strings_nequal(c, needle, needle_length)){
+            return c - text;
+        }
+    }
+    return -1;
+}
+
+/** Reads console.log back after the logging system has been shut down. */
+static char* read_log_file(u64* out_size){
+    file_handle handle;
+    if(!filesystem_open("console.log", FILE_MODE_READ, FALSE, &handle)){
+        return 0;
+    }
+    filesystem_size(&handle, out_size);
+    char* text = tallocate(*out_size + 1, MEMORY_TAG_STRING);
+    u64 read = 0;
+    filesystem_read_all_text(&handle, text, &read);
+    text[read] = 0;
+    filesystem_close(&handle);
+    return text;
+}
+
+static u32 log_from_thread(void* params){
+    u32 index = *(u32*)params;
+    for(u32 i = 0; i < LOGGER_TEST_MESSAGES_PER_THREAD; ++i){
+        // Errors are never dropped, so all of these must reach the file.
+        TERROR("logger test thread %u message %u", index, i);
+    }
+    return 0;
+}
+
+u8 logger_should_write_all_messages_from_many_threads(){
+    u64 memory_requirement = 0;
+    initialize_logging(&memory_requirement, 0);
+    void* state = tallocate(memory_requirement, MEMORY_TAG_APPLICATION);
+    expect_to_be_true(initialize_logging(&memory_requirement, state));
+
+    TDEBUG("Note: The following errors are intentionally caused by this test.");
+    tthread threads[LOGGER_TEST_THREAD_COUNT];
+    u32 indices[LOGGER_TEST_THREAD_COUNT];
+    for(u32 i = 0; i < LOGGER_TEST_THREAD_COUNT; ++i){
+        indices[i] = i;
+        tthread_create(log_from_thread, &indices[i], FALSE, &threads[i]);
+    }
+    for(u32 i = 0; i < LOGGER_TEST_THREAD_COUNT; ++i){
+        tthread_wait(&threads[i]);
+    }
+
+    shutdown_logging(state);
+    tfree(state, memory_requirement, MEMORY_TAG_APPLICATION);
+
+    u64 size = 0;
+    char* text = read_log_file(&size);
+    expect_should_not_be(0, text);
+    expect_should_be(LOGGER_TEST_THREAD_COUNT * LOGGER_TEST_MESSAGES_PER_THREAD, count_occurrences(text, "[ERROR]: logger test thread"));
+    // Messages from one thread stay in order.
+    char first[64];
+    char last[64];
+    string_format(first, "thread 0 message 0\n");
+    string_format(last, "thread 0 message %u\n", LOGGER_TEST_MESSAGES_PER_THREAD - 1);
+    i64 first_offset = find_offset(text, first);
+    expect_to_be_true(first_offset >= 0);
+    expect_to_be_true(first_offset < find_offset(text, last));
+    tfree(text, size + 1, MEMORY_TAG_STRING);
+
+    return TRUE;
+}
+
+u8 logger_should_filter_by_runtime_level(){
+    u64 memory_requirement = 0;
+    initialize_logging(&memory_requirement, 0);
+    void* state = tallocate(memory_requirement, MEMORY_TAG_APPLICATION);
+    expect_to_be_true(initialize_logging(&memory_requirement, state));
+
+    log_level previous_level = log_level_get();
+    log_level_set(LOG_LEVEL_INFO);
+    TINFO("logger filter test kept");
+    TDEBUG("logger filter test discarded");
+    TTRACE("logger filter test discarded");
+    log_level_set(previous_level);
+
+    log_flush();
+    expect_should_be(0, log_dropped_count());
+
+    shutdown_logging(state);
+    tfree(state, memory_requirement, MEMORY_TAG_APPLICATION);
+
+    u64 size = 0;
+    char* text = read_log_file(&size);
+    expect_should_not_be(0, text);
+    expect_should_be(1, count_occurrences(text, "logger filter test kept"));
+    expect_should_be(0, count_occurrences(text, "logger filter test discarded"));
+    tfree(text, size + 1, MEMORY_TAG_STRING);
+
+    return TRUE;
+}
+
+u8 logger_should_format_captured_arguments_like_printf(){
+    u64 memory_requirement = 0;
+    initialize_logging(&memory_requirement, 0);
+    void* state = tallocate(memory_requirement, MEMORY_TAG_APPLICATION);
+    expect_to_be_true(initialize_logging(&memory_requirement, state));
+
+    // Formatting happens later, on the flush thread, so the string must have been copied.
+    char name[32];
+    string_ncopy(name, "captured", sizeof(name));
+    TINFO("logger format test: %s|%-10s|%.*s|%d|%5.2f|%llu|%#x|%hu|%c|%*d|%%|%p|%s",
+          name, "left", 3, "abcdef", -42, 3.14159, 18446744073709551615ULL, 255, (u16)65535, 'z', 6, 7, (void*)0x1234, (const char*)0);
+    string_ncopy(name, "overwritten", sizeof(name));
+
+    // Too long to capture in one record, so it is formatted by the caller instead.
+    char long_string[1024];
+    for(u32 i = 0; i < sizeof(long_string) - 1; ++i){
+        long_string[i] = 'a' + (i % 26);
+    }
+    long_string[sizeof(long_string) - 1] = 0;
+    TINFO("logger long test %u %s end", 1u, long_string);
+
+    shutdown_logging(state);
+    tfree(state, memory_requirement, MEMORY_TAG_APPLICATION);
+
+    char expected[256];
+    string_format(expected, "[INFO]: logger format test: %s|%-10s|%.*s|%d|%5.2f|%llu|%#x|%hu|%c|%*d|%%|%p|%s\n",
+                  "captured", "left", 3, "abcdef", -42, 3.14159, 18446744073709551615ULL, 255, (u16)65535, 'z', 6, 7, (void*)0x1234, "(null)");
+    u64 size = 0;
+    char* text = read_log_file(&size);
+    expect_should_not_be(0, text);
+    expect_should_be(1, count_occurrences(text, expected));
+    expect_should_be(1, count_occurrences(text, long_string));
+    expect_should_be(1, count_occurrences(text, "logger long test 1 abc"));
+    tfree(text, size + 1, MEMORY_TAG_STRING);
+
+    return TRUE;
+}
+
+void logger_register_tests(){
+    test_manager_register_test(logger_should_write_all_messages_from_many_threads, "Logger should write every error from many threads, in order per thread");
+    test_manager_register_test(logger_should_format_captured_arguments_like_printf, "Logger should format captured arguments on the flush thread like printf");
+    test_manager_register_test(logger_should_filter_by_runtime_level, "Logger should filter messages by runtime level before queueing them");
+}
@@ -0,0 +1,183 @@
+#include "profiler_tests.h"
+#include "../test_manager.h"
+#include "../expect.h"
+
+#include <defines.h>
+#include <core/profiler.h>
+#include <core/tmemory.h>
+#include <core/tstring.h>
+#include <core/tthread.h>
+#include <core/tatomic.h>
+#include <platform/filesystem.h>
+
+#define PROFILER_TEST_TRACE_PATH "profiler_test_trace.json"
+
+static u32 count_occurrences(const char* text, const char* needle){
+    u32 count = 0;
+    u64 needle_length = string_length(needle);
+    for(const char* c = text; *c; ++c){
+        if(strings_nequal(c, needle, needle_length)){
+            count++;
+        }
+    }
+    return count;
+}
+
+static char* read_trace(u64* out_size){
+    file_handle handle;
+    if(!filesystem_open(PROFILER_TEST_TRACE_PATH, FILE_MODE_READ, FALSE, &handle)){
+        return 0;
+    }
+    filesystem_size(&handle, out_size);
+    char* text = tallocate(*out_size + 1, MEMORY_TAG_STRING);
+    u64 read = 0;
+    filesystem_read_all_text(&handle, text, &read);
+    filesystem_close(&handle);
+    return text;
+}
+
+static void start_profiler(void** out_state, u64* out_size){
+    memory_system_configuration config = {};
+    config.total_alloc_size = MEBIBYTES(16);
+    memory_system_initialize(config);
+
+    profiler_system_initialize(out_size, 0);
+    *out_state = tallocate(*out_size, MEMORY_TAG_APPLICATION);
+    profiler_system_initialize(out_size, *out_state);
+}
+
+static void stop_profiler(void* state, u64 size){
+    profiler_system_shutdown(state);
+    tfree(state, size, MEMORY_TAG_APPLICATION);
+    memory_system_shutdown();
+}
+
+static u32 record_worker_zones(void* params){
+    profiler_set_thread_name("worker");
+    for(u32 i = 0; i < 10; ++i){
+        TPROFILE_SCOPE("worker_zone");
+    }
+    return 1;
+}
+
+u8 profiler_should_write_nested_zones_from_each_thread(){
+    if(!TPROFILER_ENABLED){
+        return BYPASS;
+    }
+    void* state;
+    u64 size;
+    start_profiler(&state, &size);
+    profiler_set_thread_name("test main");
+
+    TPROFILE_BEGIN("outer");
+    for(u32 i = 0; i < 3; ++i){
+        TPROFILE_SCOPE("inner");
+    }
+    TPROFILE_END();
+
+    tthread worker;
+    expect_to_be_true(tthread_create(record_worker_zones, 0, FALSE, &worker));
+    tthread_wait(&worker);
+
+    expect_to_be_true(profiler_write_trace(PROFILER_TEST_TRACE_PATH));
+    u64 trace_size = 0;
+    char* trace = read_trace(&trace_size);
+    expect_should_not_be(0, trace);
+
+    expect_should_be(1, count_occurrences(trace, "\"args\": {\"name\": \"test main\"}"));
+    expect_should_be(1, count_occurrences(trace, "\"args\": {\"name\": \"worker\"}"));
+    expect_should_be(1, count_occurrences(trace, "{\"name\": \"outer\", \"ph\": \"X\", \"pid\": 0, \"tid\": 0"));
+    expect_should_be(3, count_occurrences(trace, "{\"name\": \"inner\", \"ph\": \"X\", \"pid\": 0, \"tid\": 0"));
+    expect_should_be(10, count_occurrences(trace, "{\"name\": \"worker_zone\", \"ph\": \"X\", \"pid\": 0, \"tid\": 1"));
+    expect_should_be(14, count_occurrences(trace, "\"ph\": \"X\""));
+
+    tfree(trace, trace_size + 1, MEMORY_TAG_STRING);
+    stop_profiler(state, size);
+    return TRUE;
+}
+
+u8 profiler_should_keep_only_the_latest_zones(){
+    if(!TPROFILER_ENABLED){
+        return BYPASS;
+    }
+    void* state;
+    u64 size;
+    start_profiler(&state, &size);
+
+    for(u32 i = 0; i < PROFILER_EVENTS_PER_THREAD / 2; ++i){
+        TPROFILE_SCOPE("old");
+    }
+    for(u32 i = 0; i < 100; ++i){
+        TPROFILE_SCOPE("new");
+    }
+
+    // Zones nested too deeply are skipped without unbalancing the ones around them.
+    for(u32 i = 0; i < PROFILER_MAX_DEPTH + 8; ++i){
+        TPROFILE_BEGIN("deep");
+    }
+    for(u32 i = 0; i < PROFILER_MAX_DEPTH + 8; ++i){
+        TPROFILE_END();
+    }
+
+    expect_to_be_true(profiler_write_trace(PROFILER_TEST_TRACE_PATH));
+    u64 trace_size = 0;
+    char* trace = read_trace(&trace_size);
+    expect_should_not_be(0, trace);
+
+    expect_should_be(100, count_occurrences(trace, "\"name\": \"new\""));
+    expect_should_be(PROFILER_MAX_DEPTH, count_occurrences(trace, "\"name\": \"deep\""));
+    // Once the ring has wrapped, its oldest slot is left out, since it could be mid-write. That
+    // slot is the begin of an old zone, whose end is then skipped too.
+    u32 newer_events = 2 * (100 + PROFILER_MAX_DEPTH + 8);
+    expect_should_be((PROFILER_EVENTS_PER_THREAD - newer_events) / 2 - 1, count_occurrences(trace, "\"name\": \"old\""));
+
+    tfree(trace, trace_size + 1, MEMORY_TAG_STRING);
+    stop_profiler(state, size);
+    return TRUE;
+}
+
+static volatile i32 worker_running;
+
+static u32 record_zones_until_stopped(void* params){
+    profiler_set_thread_name("busy worker");
+    while(tatomic_load_i32(&worker_running, TATOMIC_ACQUIRE)){
+        TPROFILE_SCOPE("busy");
+    }
+    return 1;
+}
+
+u8 profiler_should_write_while_zones_are_recorded(){
+    if(!TPROFILER_ENABLED){
+        return BYPASS;
+    }
+    void* state;
+    u64 size;
+    start_profiler(&state, &size);
+
+    tatomic_store_i32(&worker_running, 1, TATOMIC_RELEASE);
+    tthread worker;
+    expect_to_be_true(tthread_create(record_zones_until_stopped, 0, FALSE, &worker));
+
+    // Every capture taken mid-recording is still well formed and bounded by the ring.
+    for(u32 i = 0; i < 4; ++i){
+        expect_to_be_true(profiler_write_trace(PROFILER_TEST_TRACE_PATH));
+        u64 trace_size = 0;
+        char* trace = read_trace(&trace_size);
+        expect_should_not_be(0, trace);
+        expect_to_be_true(count_occurrences(trace, "\"name\": \"busy\"") <= PROFILER_EVENTS_PER_THREAD / 2);
+        expect_should_be(0, count_occurrences(trace, "\"name\": \"(null)\""));
+        expect_to_be_true(strings_equal(trace + trace_size - 4, "\n]}\n"));
+        tfree(trace, trace_size + 1, MEMORY_TAG_STRING);
+    }
+
+    tatomic_store_i32(&worker_running, 0, TATOMIC_RELEASE);
+    tthread_wait(&worker);
+    stop_profiler(state, size);
+    return TRUE;
+}
+
+void profiler_register_tests(){
+    test_manager_register_test(profiler_should_write_nested_zones_from_each_thread, "Profiler should write nested zones from each thread");
+    test_manager_register_test(profiler_should_keep_only_the_latest_zones, "Profiler should keep only the latest zones");
+    test_manager_register_test(profiler_should_write_while_zones_are_recorded, "Profiler should write a trace while zones are being recorded");
+}
@@ -2,9 +2,27 @@
 
 #include "memory/linear_allocator_tests.h"
 #include "memory/dynamic_allocator_tests.h"
+#include "memory/frame_allocator_tests.h"
+#include "memory/tmemory_tests.h"
+
+#include "core/logger_tests.h"
+#include "core/profiler_tests.h"
+#include "core/frame_pacing_tests.h"
+#include "core/input_recorder_tests.h"
 
 #include "containers/hashtable_tests.h"
 #include "containers/freelist_tests.h"
+#include "containers/mpsc_queue_tests.h"
+
+#include "systems/job_system_tests.h"
+#include "systems/transform_system_tests.h"
+
+#include "math/tmath_tests.h"
+
+#include "platform/platform_headless_tests.h"
+
+#include "renderer/null_backend_tests.h"
+#include "renderer/draw_key_tests.h"
 
 #include <core/logger.h>
 
@@ -15,8 +33,21 @@ int main(){
     //TODO: add test registrations here.
     linear_allocator_register_tests();
     dynamic_allocator_register_tests();
+    frame_allocator_register_tests();
+    tmemory_register_tests();
+    logger_register_tests();
+    profiler_register_tests();
+    frame_pacing_register_tests();
+    input_recorder_register_tests();
     hashtable_register_tests();
     freelist_register_tests();
+    mpsc_queue_register_tests();
+    job_system_register_tests();
+    transform_system_register_tests();
+    tmath_register_tests();
+    platform_headless_register_tests();
+    null_backend_register_tests();
+    draw_key_register_tests();
 
     TDEBUG("Starting tests...");
 
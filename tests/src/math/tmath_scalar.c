@@ -0,0 +1,36 @@
+#define TMATH_NO_SIMD
+#include <math/tmath.h>
+
+#include "tmath_scalar.h"
+
+mat4 scalar_mat4_mul(mat4 matrix_0, mat4 matrix_1){
+    return mat4_mul(matrix_0, matrix_1);
+}
+
+mat4 scalar_mat4_transposed(mat4 matrix){
+    return mat4_transposed(matrix);
+}
+
+mat4 scalar_mat4_inverse(mat4 matrix){
+    return mat4_inverse(matrix);
+}
+
+vec3 scalar_vec3_transform(vec3 v, mat4 m){
+    return vec3_transform(v, m);
+}
+
+vec4 scalar_vec4_add(vec4 vector_0, vec4 vector_1){
+    return vec4_add(vector_0, vector_1);
+}
+
+vec4 scalar_vec4_sub(vec4 vector_0, vec4 vector_1){
+    return vec4_sub(vector_0, vector_1);
+}
+
+vec4 scalar_vec4_mul(vec4 vector_0, vec4 vector_1){
+    return vec4_mul(vector_0, vector_1);
+}
+
+vec4 scalar_vec4_div(vec4 vector_0, vec4 vector_1){
+    return vec4_div(vector_0, vector_1);
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <math/math_types.h>
+
+/*
+ * The scalar versions of the tmath routines that have SIMD kernels, compiled with
+ * TMATH_NO_SIMD so that the SIMD results can be checked against them.
+ */
+mat4 scalar_mat4_mul(mat4 matrix_0, mat4 matrix_1);
+mat4 scalar_mat4_transposed(mat4 matrix);
+mat4 scalar_mat4_inverse(mat4 matrix);
+vec3 scalar_vec3_transform(vec3 v, mat4 m);
+vec4 scalar_vec4_add(vec4 vector_0, vec4 vector_1);
+vec4 scalar_vec4_sub(vec4 vector_0, vec4 vector_1);
+vec4 scalar_vec4_mul(vec4 vector_0, vec4 vector_1);
+vec4 scalar_vec4_div(vec4 vector_0, vec4 vector_1);
@@ -0,0 +1,292 @@
+#include "tmath_tests.h"
+#include "tmath_scalar.h"
+#include "../test_manager.h"
+#include "../expect.h"
+
+#include <defines.h>
+#include <math/tmath.h>
+
+#define INPUT_COUNT 256
+
+// Results are allowed to differ from the scalar code by a few units in the last place,
+// in case the compiler contracts the scalar code into fused multiply-adds.
+#define MAX_ULPS 4
+
+static u32 seed;
+
+static f32 next_f32(f32 min, f32 max){
+    seed = seed * 1103515245 + 12345;
+    return min + (max - min) * (f32)((seed >> 8) & 0xFFFF) / 65535.0f;
+}
+
+static vec3 next_vec3(f32 min, f32 max){
+    return vec3_create(next_f32(min, max), next_f32(min, max), next_f32(min, max));
+}
+
+static vec4 next_vec4(f32 min, f32 max){
+    return vec4_create(next_f32(min, max), next_f32(min, max), next_f32(min, max), next_f32(min, max));
+}
+
+static quat next_rotation(){
+    vec3 axis = vec3_normalized(next_vec3(-1.0f, 1.0f));
+    return quat_from_axis_angle(axis, next_f32(0.0f, T_PI_2), TRUE);
+}
+
+/** A matrix like the ones transforms produce: scaled, rotated and translated. */
+static mat4 next_transform_matrix(){
+    mat4 m = mat4_mul(quat_to_mat4(next_rotation()), mat4_translation(next_vec3(-100.0f, 100.0f)));
+    return mat4_mul(mat4_scale(next_vec3(0.5f, 2.0f)), m);
+}
+
+static mat4 next_matrix(){
+    mat4 m;
+    for(u32 i = 0; i < 16; ++i){
+        m.data[i] = next_f32(-10.0f, 10.0f);
+    }
+    return m;
+}
+
+static b8 within_ulps(f32 a, f32 b){
+    if(a == b || tabs(a - b) < 1e-6f){
+        return TRUE;
+    }
+    union { f32 f; i32 i; } ua = {a}, ub = {b};
+    if((ua.i < 0) != (ub.i < 0)){
+        return FALSE;
+    }
+    i32 difference = ua.i - ub.i;
+    return (difference < 0 ? -difference : difference) <= MAX_ULPS;
+}
+
+static b8 floats_match(const f32* expected, const f32* actual, u32 count){
+    for(u32 i = 0; i < count; ++i){
+        if(!within_ulps(expected[i], actual[i])){
+            TERROR("--> Element %u: expected %.9g, but got %.9g.", i, expected[i], actual[i]);
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+u8 tmath_mat4_mul_should_match_scalar(){
+    seed = 1;
+    for(u32 i = 0; i < INPUT_COUNT; ++i){
+        mat4 a = next_matrix();
+        mat4 b = next_matrix();
+        mat4 expected = scalar_mat4_mul(a, b);
+        mat4 actual = mat4_mul(a, b);
+        expect_to_be_true(floats_match(expected.data, actual.data, 16));
+    }
+    return TRUE;
+}
+
+u8 tmath_mat4_mul_affine_should_match_scalar(){
+    seed = 8;
+    for(u32 i = 0; i < INPUT_COUNT; ++i){
+        mat4 a = next_transform_matrix();
+        mat4 b = next_matrix();
+        mat4 expected = scalar_mat4_mul(a, b);
+        mat4 actual = mat4_mul_affine(a, b);
+        expect_to_be_true(floats_match(expected.data, actual.data, 16));
+    }
+    return TRUE;
+}
+
+u8 tmath_mat4_transposed_should_match_scalar(){
+    seed = 2;
+    for(u32 i = 0; i < INPUT_COUNT; ++i){
+        mat4 m = next_matrix();
+        mat4 expected = scalar_mat4_transposed(m);
+        mat4 actual = mat4_transposed(m);
+        for(u32 j = 0; j < 16; ++j){
+            // Only moves values around, so must be exact.
+            expect_to_be_true(expected.data[j] == actual.data[j]);
+        }
+    }
+    return TRUE;
+}
+
+u8 tmath_mat4_inverse_should_match_scalar(){
+    seed = 3;
+    mat4 identity = mat4_identity();
+    for(u32 i = 0; i < INPUT_COUNT; ++i){
+        mat4 m = next_transform_matrix();
+        mat4 expected = scalar_mat4_inverse(m);
+        mat4 actual = mat4_inverse(m);
+        // The SIMD inverse takes a different route to the same answer, so allow for rounding.
+        for(u32 j = 0; j < 16; ++j){
+            f32 tolerance = 1e-4f * (1.0f + tabs(expected.data[j]));
+            if(tabs(expected.data[j] - actual.data[j]) > tolerance){
+                TERROR("--> Element %u: expected %.9g, but got %.9g.", j, expected.data[j], actual.data[j]);
+                return FALSE;
+            }
+        }
+
+        mat4 product = mat4_mul(m, actual);
+        for(u32 j = 0; j < 16; ++j){
+            expect_to_be_true(tabs(identity.data[j] - product.data[j]) < 1e-3f);
+        }
+    }
+
+    // A general matrix, not just a rigid transform.
+    mat4 general = {{2, 0, 1, 3, 1, 4, 0, 2, 0, 1, 5, 1, 3, 2, 1, 6}};
+    mat4 product = mat4_mul(general, mat4_inverse(general));
+    for(u32 j = 0; j < 16; ++j){
+        expect_to_be_true(tabs(identity.data[j] - product.data[j]) < 1e-4f);
+    }
+    return TRUE;
+}
+
+u8 tmath_vec_ops_should_match_scalar(){
+    seed = 4;
+    for(u32 i = 0; i < INPUT_COUNT; ++i){
+        mat4 m = next_transform_matrix();
+        vec3 p = next_vec3(-50.0f, 50.0f);
+        vec3 expected_point = scalar_vec3_transform(p, m);
+        vec3 actual_point = vec3_transform(p, m);
+        expect_to_be_true(floats_match(expected_point.elements, actual_point.elements, 3));
+
+        vec4 a = next_vec4(-10.0f, 10.0f);
+        vec4 b = next_vec4(0.5f, 10.0f);
+        vec4 expected = scalar_vec4_add(a, b);
+        vec4 actual = vec4_add(a, b);
+        expect_to_be_true(floats_match(expected.elements, actual.elements, 4));
+        expected = scalar_vec4_sub(a, b);
+        actual = vec4_sub(a, b);
+        expect_to_be_true(floats_match(expected.elements, actual.elements, 4));
+        expected = scalar_vec4_mul(a, b);
+        actual = vec4_mul(a, b);
+        expect_to_be_true(floats_match(expected.elements, actual.elements, 4));
+        expected = scalar_vec4_div(a, b);
+        actual = vec4_div(a, b);
+        expect_to_be_true(floats_match(expected.elements, actual.elements, 4));
+    }
+    return TRUE;
+}
+
+u8 tmath_batches_should_match_single_calls(){
+    seed = 6;
+    mat4 matrices[INPUT_COUNT];
+    mat4 out_matrices[INPUT_COUNT];
+    vec3 points[INPUT_COUNT];
+    vec3 out_points[INPUT_COUNT];
+    for(u32 i = 0; i < INPUT_COUNT; ++i){
+        matrices[i] = next_transform_matrix();
+        points[i] = next_vec3(-50.0f, 50.0f);
+    }
+    mat4 parent = next_transform_matrix();
+
+    mat4_mul_batch(matrices, INPUT_COUNT, parent, out_matrices);
+    vec3_transform_batch(points, INPUT_COUNT, parent, out_points);
+    for(u32 i = 0; i < INPUT_COUNT; ++i){
+        mat4 expected = scalar_mat4_mul(matrices[i], parent);
+        expect_to_be_true(floats_match(expected.data, out_matrices[i].data, 16));
+        vec3 expected_point = scalar_vec3_transform(points[i], parent);
+        expect_to_be_true(floats_match(expected_point.elements, out_points[i].elements, 3));
+    }
+
+    // In place gives the same answers.
+    mat4_mul_batch(matrices, INPUT_COUNT, parent, matrices);
+    vec3_transform_batch(points, INPUT_COUNT, parent, points);
+    for(u32 i = 0; i < INPUT_COUNT; ++i){
+        expect_to_be_true(floats_match(out_matrices[i].data, matrices[i].data, 16));
+        expect_to_be_true(floats_match(out_points[i].elements, points[i].elements, 3));
+    }
+
+    // An empty batch touches nothing.
+    mat4_mul_batch(0, 0, parent, 0);
+    vec3_transform_batch(0, 0, parent, 0);
+    return TRUE;
+}
+
+u8 tmath_frustum_should_contain_what_the_camera_sees(){
+    // A camera at z = 10 looking down -z, with a 90 degree field of view.
+    mat4 view = mat4_inverse(mat4_translation((vec3){0.0f, 0.0f, 10.0f}));
+    mat4 projection = mat4_perspective(deg_to_rad(90.0f), 1.0f, 0.1f, 100.0f);
+    frustum f = frustum_from_view_projection(mat4_mul(view, projection));
+
+    // The planes come out normalized.
+    for(u32 i = 0; i < FRUSTUM_SIDE_COUNT; ++i){
+        expect_float_to_be(1.0f, vec3_length(f.sides[i].normal));
+    }
+
+    expect_to_be_true(frustum_intersects_sphere(&f, vec3_zero(), 0.5f));
+    expect_to_be_true(frustum_intersects_sphere(&f, (vec3){9.0f, 0.0f, 0.0f}, 0.1f));
+    // Behind, past the far plane, in front of the near plane, and off to each side.
+    expect_to_be_false(frustum_intersects_sphere(&f, (vec3){0.0f, 0.0f, 20.0f}, 1.0f));
+    expect_to_be_false(frustum_intersects_sphere(&f, (vec3){0.0f, 0.0f, -100.0f}, 1.0f));
+    expect_to_be_false(frustum_intersects_sphere(&f, (vec3){0.0f, 0.0f, 9.95f}, 0.01f));
+    expect_to_be_false(frustum_intersects_sphere(&f, (vec3){12.0f, 0.0f, 0.0f}, 1.0f));
+    expect_to_be_false(frustum_intersects_sphere(&f, (vec3){-12.0f, 0.0f, 0.0f}, 1.0f));
+    expect_to_be_false(frustum_intersects_sphere(&f, (vec3){0.0f, 12.0f, 0.0f}, 1.0f));
+    expect_to_be_false(frustum_intersects_sphere(&f, (vec3){0.0f, -12.0f, 0.0f}, 1.0f));
+
+    // Boxes straddling a plane are kept, whichever side their center is on.
+    expect_to_be_true(frustum_intersects_aabb(&f, (vec3){11.0f, 0.0f, 0.0f}, (vec3){1.5f, 1.0f, 0.1f}));
+    expect_to_be_false(frustum_intersects_aabb(&f, (vec3){11.0f, 0.0f, 0.0f}, (vec3){0.5f, 1.0f, 0.1f}));
+
+    // A box transformed into world space is enclosed by the result.
+    extents_3d extents = {{-1.0f, -2.0f, -3.0f}, {1.0f, 2.0f, 3.0f}};
+    mat4 model = mat4_mul(mat4_euler_z(T_HALF_PI), mat4_translation((vec3){5.0f, 0.0f, 0.0f}));
+    vec3 center, half_extents;
+    extents_3d_transform(extents, model, &center, &half_extents);
+    expect_float_to_be(5.0f, center.x);
+    expect_float_to_be(0.0f, center.y);
+    expect_float_to_be(2.0f, half_extents.x);
+    expect_float_to_be(1.0f, half_extents.y);
+    expect_float_to_be(3.0f, half_extents.z);
+    return TRUE;
+}
+
+u8 tmath_frustum_batches_should_match_single_calls(){
+    seed = 7;
+    vec3 centers[INPUT_COUNT];
+    vec3 half_extents[INPUT_COUNT];
+    f32 radii[INPUT_COUNT];
+    u32 visible_indices[INPUT_COUNT];
+    for(u32 i = 0; i < INPUT_COUNT; ++i){
+        centers[i] = next_vec3(-60.0f, 60.0f);
+        half_extents[i] = next_vec3(0.0f, 5.0f);
+        radii[i] = next_f32(0.0f, 5.0f);
+    }
+    mat4 view = mat4_inverse(next_transform_matrix());
+    mat4 projection = mat4_perspective(deg_to_rad(60.0f), 16.0f / 9.0f, 0.1f, 80.0f);
+    frustum f = frustum_from_view_projection(mat4_mul(view, projection));
+
+    u32 visible_count = frustum_cull_aabbs(&f, centers, half_extents, INPUT_COUNT, visible_indices);
+    u32 expected_count = 0;
+    for(u32 i = 0; i < INPUT_COUNT; ++i){
+        if(frustum_intersects_aabb(&f, centers[i], half_extents[i])){
+            expect_should_be(i, visible_indices[expected_count]);
+            expected_count++;
+        }
+    }
+    expect_should_be(expected_count, visible_count);
+    // Some of each, or the test proves little.
+    expect_to_be_true(visible_count > 0 && visible_count < INPUT_COUNT);
+
+    visible_count = frustum_cull_spheres(&f, centers, radii, INPUT_COUNT, visible_indices);
+    expected_count = 0;
+    for(u32 i = 0; i < INPUT_COUNT; ++i){
+        if(frustum_intersects_sphere(&f, centers[i], radii[i])){
+            expect_should_be(i, visible_indices[expected_count]);
+            expected_count++;
+        }
+    }
+    expect_should_be(expected_count, visible_count);
+
+    // An empty batch touches nothing.
+    expect_should_be(0, frustum_cull_aabbs(&f, 0, 0, 0, 0));
+    return TRUE;
+}
+
+void tmath_register_tests(){
+    test_manager_register_test(tmath_mat4_mul_should_match_scalar, "Math mat4_mul should match the scalar version.");
+    test_manager_register_test(tmath_mat4_mul_affine_should_match_scalar, "Math mat4_mul_affine should match the scalar version on affine matrices.");
+    test_manager_register_test(tmath_mat4_transposed_should_match_scalar, "Math mat4_transposed should match the scalar version exactly.");
+    test_manager_register_test(tmath_mat4_inverse_should_match_scalar, "Math mat4_inverse should match the scalar version and invert.");
+    test_manager_register_test(tmath_vec_ops_should_match_scalar, "Math vec3_transform and vec4 operations should match the scalar versions.");
+    test_manager_register_test(tmath_batches_should_match_single_calls, "Math batched transforms should match single calls, in place too.");
+    test_manager_register_test(tmath_frustum_should_contain_what_the_camera_sees, "Math frustum should contain what the camera sees and nothing else.");
+    test_manager_register_test(tmath_frustum_batches_should_match_single_calls, "Math batched frustum culling should match single tests.");
+}
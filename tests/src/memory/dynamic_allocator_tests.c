@@ -352,10 +352,56 @@ u8 dynamic_allocator_multi_allocation_most_space_request_too_big() {
 
 
 
+u8 dynamic_allocator_aligned_allocation_returns_padding() {
+    dynamic_allocator alloc;
+    u64 memory_requirement = 0;
+    b8 result = dynamic_allocator_create(4096, &memory_requirement, 0, 0);
+    expect_to_be_true(result);
+
+    void* memory = tallocate(memory_requirement, MEMORY_TAG_APPLICATION);
+    result = dynamic_allocator_create(4096, &memory_requirement, memory, &alloc);
+    expect_to_be_true(result);
+
+    // Every block gets the default alignment, whatever its size.
+    void* small = dynamic_allocator_allocate(&alloc, 24);
+    expect_should_not_be(0, small);
+    expect_should_be(0, (u64)small % DYNAMIC_ALLOCATOR_ALIGNMENT);
+    expect_should_be(4096 - 32, dynamic_allocator_free_space(&alloc));
+
+    // The padding in front of and behind an aligned block goes straight back to the allocator,
+    // so only the block itself is counted as used.
+    void* aligned = dynamic_allocator_allocate_aligned(&alloc, 100, 256);
+    expect_should_not_be(0, aligned);
+    expect_should_be(0, (u64)aligned % 256);
+    expect_should_be(4096 - 32 - 112, dynamic_allocator_free_space(&alloc));
+
+    void* page = dynamic_allocator_allocate_aligned(&alloc, 1024, 1024);
+    expect_should_not_be(0, page);
+    expect_should_be(0, (u64)page % 1024);
+
+    // Aligned blocks are freed by size like any other, and everything coalesces back.
+    expect_to_be_true(dynamic_allocator_free(&alloc, aligned, 100));
+    expect_to_be_true(dynamic_allocator_free(&alloc, small, 24));
+    expect_to_be_true(dynamic_allocator_free(&alloc, page, 1024));
+    expect_should_be(4096, dynamic_allocator_free_space(&alloc));
+
+    void* whole = dynamic_allocator_allocate(&alloc, 4096);
+    expect_should_not_be(0, whole);
+    dynamic_allocator_free(&alloc, whole, 4096);
+
+    TDEBUG("Note: The following error is intentionally caused by this test.");
+    expect_should_be(0, dynamic_allocator_allocate_aligned(&alloc, 64, 48));
+
+    dynamic_allocator_destroy(&alloc);
+    tfree(memory, memory_requirement, MEMORY_TAG_APPLICATION);
+    return TRUE;
+}
+
 void dynamic_allocator_register_tests() {
     test_manager_register_test(dynamic_allocator_should_create_and_destroy, "Dynamic allocator should create and destroy");
     test_manager_register_test(dynamic_allocator_single_allocation_all_space, "Dynamic allocator single alloc for all space");
     test_manager_register_test(dynamic_allocator_multi_allocation_all_space, "Dynamic allocator multi alloc for all space");
     test_manager_register_test(dynamic_allocator_multi_allocation_over_allocate, "Dynamic allocator try over allocate");
     test_manager_register_test(dynamic_allocator_multi_allocation_most_space_request_too_big, "Dynamic allocator should try to over allocate with not enough space, but not 0 space remaining.");
+    test_manager_register_test(dynamic_allocator_aligned_allocation_returns_padding, "Dynamic allocator aligned alloc should return its padding");
 }
\ No newline at end of file
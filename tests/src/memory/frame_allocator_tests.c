@@ -0,0 +1,114 @@
+#include "frame_allocator_tests.h"
+#include "../test_manager.h"
+#include "../expect.h"
+
+#include <defines.h>
+#include <memory/frame_allocator.h>
+
+u8 frame_allocator_should_create_and_destroy(){
+    frame_allocator alloc;
+    frame_allocator_create(1024, &alloc);
+
+    expect_should_not_be(0, alloc.memory);
+    expect_should_be(0, frame_allocator_used(&alloc));
+    for(u32 i = 0; i < FRAME_ALLOCATOR_BUFFER_COUNT; ++i){
+        expect_should_be(1024, alloc.buffers[i].total_size);
+    }
+
+    frame_allocator_destroy(&alloc);
+
+    expect_should_be(0, alloc.memory);
+
+    return TRUE;
+}
+
+u8 frame_allocator_should_align_allocations(){
+    frame_allocator alloc;
+    frame_allocator_create(1024, &alloc);
+
+    // Odd sizes should still leave every block aligned.
+    for(u32 i = 0; i < 8; ++i){
+        void* block = frame_allocator_allocate(&alloc, 3 + i);
+        expect_should_not_be(0, block);
+        expect_should_be(0, (u64)block % FRAME_ALLOCATOR_ALIGNMENT);
+    }
+
+    frame_allocator_destroy(&alloc);
+
+    return TRUE;
+}
+
+u8 frame_allocator_should_keep_previous_frame_until_reused(){
+    frame_allocator alloc;
+    frame_allocator_create(1024, &alloc);
+
+    frame_allocator_begin_frame(&alloc);
+    u64* first = frame_allocator_allocate(&alloc, sizeof(u64));
+    *first = 42;
+
+    // The next frame allocates from the other buffer, leaving the first frame's data intact.
+    frame_allocator_begin_frame(&alloc);
+    u64* second = frame_allocator_allocate(&alloc, sizeof(u64));
+    *second = 7;
+    expect_should_not_be(first, second);
+    expect_should_be(42, *first);
+
+    // Two frames later, the first buffer is reset and reused.
+    frame_allocator_begin_frame(&alloc);
+    u64* third = frame_allocator_allocate(&alloc, sizeof(u64));
+    expect_should_be(first, third);
+    expect_should_be(0, *third);
+    expect_should_be(7, *second);
+
+    frame_allocator_destroy(&alloc);
+
+    return TRUE;
+}
+
+u8 frame_allocator_should_track_frame_and_peak_usage(){
+    frame_allocator alloc;
+    frame_allocator_create(1024, &alloc);
+
+    frame_allocator_begin_frame(&alloc);
+    frame_allocator_allocate(&alloc, 256);
+    expect_should_be(256, frame_allocator_used(&alloc));
+
+    frame_allocator_begin_frame(&alloc);
+    expect_should_be(256, alloc.last_frame_used);
+    expect_should_be(256, alloc.peak_used);
+    expect_should_be(0, frame_allocator_used(&alloc));
+    frame_allocator_allocate(&alloc, 64);
+
+    frame_allocator_begin_frame(&alloc);
+    expect_should_be(64, alloc.last_frame_used);
+    expect_should_be(256, alloc.peak_used);
+
+    frame_allocator_destroy(&alloc);
+
+    return TRUE;
+}
+
+u8 frame_allocator_should_fail_when_frame_is_full(){
+    frame_allocator alloc;
+    frame_allocator_create(64, &alloc);
+
+    expect_should_not_be(0, frame_allocator_allocate(&alloc, 64));
+    TDEBUG("Note: The following error is intentionally caused by this test.");
+    expect_should_be(0, frame_allocator_allocate(&alloc, 16));
+
+    // A new frame has its own capacity again.
+    frame_allocator_begin_frame(&alloc);
+    expect_should_not_be(0, frame_allocator_allocate(&alloc, 64));
+
+    frame_allocator_destroy(&alloc);
+
+    return TRUE;
+}
+
+void frame_allocator_register_tests(){
+    test_manager_register_test(frame_allocator_should_create_and_destroy, "Frame allocator should create and destroy");
+    test_manager_register_test(frame_allocator_should_align_allocations, "Frame allocator should align allocations");
+    test_manager_register_test(frame_allocator_should_keep_previous_frame_until_reused, "Frame allocator should keep the previous frame's data until its buffer is reused");
+    test_manager_register_test(frame_allocator_should_track_frame_and_peak_usage, "Frame allocator should track last frame and peak usage");
+    test_manager_register_test(frame_allocator_should_fail_when_frame_is_full, "Frame allocator should fail when the frame is full");
+}
@@ -0,0 +1,272 @@
+#include "tmemory_tests.h"
+
+#include "../test_manager.h"
+#include "../expect.h"
+
+#include <defines.h>
+#include <core/tmemory.h>
+#include <core/tthread.h>
+#include <platform/filesystem.h>
+
+#include <string.h>
+
+#define THREAD_COUNT 4
+#define ALLOCATIONS_PER_THREAD 2000
+
+static b8 start_memory_system(){
+    memory_system_configuration config = {};
+    config.total_alloc_size = MEBIBYTES(16);
+    return memory_system_initialize(config);
+}
+
+u8 tmemory_should_reuse_freed_small_blocks(){
+    expect_to_be_true(start_memory_system());
+    u64 starting_count = get_memory_alloc_count();
+
+    u8* block = tallocate(40, MEMORY_TAG_ARRAY);
+    expect_should_not_be(0, block);
+    tset_memory(block, 0xAB, 40);
+    tfree(block, 40, MEMORY_TAG_ARRAY);
+
+    // A block from the same size class comes straight back out of the thread's cache, zeroed.
+    u8* reused = tallocate(33, MEMORY_TAG_ARRAY);
+    expect_should_be(block, reused);
+    for(u32 i = 0; i < 33; ++i){
+        expect_should_be(0, reused[i]);
+    }
+    tfree(reused, 33, MEMORY_TAG_ARRAY);
+
+    // Large blocks still go through the shared allocator.
+    void* large = tallocate(KIBIBYTES(4), MEMORY_TAG_ARRAY);
+    expect_should_not_be(0, large);
+    tfree(large, KIBIBYTES(4), MEMORY_TAG_ARRAY);
+
+    expect_should_be(starting_count + 3, get_memory_alloc_count());
+
+    memory_system_shutdown();
+    return TRUE;
+}
+
+static void free_blocks(void** blocks, u32 count){
+    for(u32 i = 0; i < count; ++i){
+        tfree(blocks[i], *(u64*)blocks[i], MEMORY_TAG_JOB);
+    }
+}
+
+static u32 allocate_and_free(void* params){
+    // Keep a window of live blocks of mixed sizes, some cached and some not.
+    void* blocks[64];
+    u32 live = 0;
+    for(u32 i = 0; i < ALLOCATIONS_PER_THREAD; ++i){
+        u64 size = 8 + (i * 37) % 700;
+        blocks[live] = tallocate(size, MEMORY_TAG_JOB);
+        *(u64*)blocks[live] = size;
+        if(++live == 64){
+            free_blocks(blocks, live);
+            live = 0;
+        }
+    }
+    free_blocks(blocks, live);
+    return 1;
+}
+
+u8 tmemory_should_count_allocations_across_threads(){
+    expect_to_be_true(start_memory_system());
+    u64 starting_count = get_memory_alloc_count();
+
+    tthread threads[THREAD_COUNT];
+    for(u32 i = 0; i < THREAD_COUNT; ++i){
+        expect_to_be_true(tthread_create(allocate_and_free, 0, FALSE, &threads[i]));
+    }
+    for(u32 i = 0; i < THREAD_COUNT; ++i){
+        tthread_wait(&threads[i]);
+    }
+
+    // Per-thread counters are merged when read.
+    expect_should_be(starting_count + THREAD_COUNT * ALLOCATIONS_PER_THREAD, get_memory_alloc_count());
+
+    // Blocks freed by another thread can be allocated again here.
+    void* block = tallocate(100, MEMORY_TAG_JOB);
+    expect_should_not_be(0, block);
+    tfree(block, 100, MEMORY_TAG_JOB);
+
+    memory_system_shutdown();
+    return TRUE;
+}
+
+// Enough to need every cache twice over, if exited threads kept theirs.
+#define SHORT_LIVED_THREAD_COUNT 128
+#define SHORT_LIVED_BLOCK_COUNT 64
+
+static u32 allocate_and_exit(void* params){
+    // Freed blocks stay in the thread's cache until it exits.
+    void* blocks[SHORT_LIVED_BLOCK_COUNT];
+    for(u32 i = 0; i < SHORT_LIVED_BLOCK_COUNT; ++i){
+        blocks[i] = tallocate(512, MEMORY_TAG_JOB);
+    }
+    for(u32 i = 0; i < SHORT_LIVED_BLOCK_COUNT; ++i){
+        tfree(blocks[i], 512, MEMORY_TAG_JOB);
+    }
+    return 1;
+}
+
+u8 tmemory_should_reclaim_caches_of_exited_threads(){
+    expect_to_be_true(start_memory_system());
+    u64 starting_count = get_memory_alloc_count();
+
+    for(u32 i = 0; i < SHORT_LIVED_THREAD_COUNT; ++i){
+        tthread thread;
+        expect_to_be_true(tthread_create(allocate_and_exit, 0, FALSE, &thread));
+        tthread_wait(&thread);
+    }
+
+    // Counts made on a thread outlive its cache.
+    expect_should_be(starting_count + SHORT_LIVED_THREAD_COUNT * SHORT_LIVED_BLOCK_COUNT, get_memory_alloc_count());
+
+    // Had the cached blocks been stranded, 2 MiB of the 16 would still be in use.
+    void* large = tallocate(MEBIBYTES(15), MEMORY_TAG_JOB);
+    expect_should_not_be(0, large);
+    tfree(large, MEBIBYTES(15), MEMORY_TAG_JOB);
+
+    memory_system_shutdown();
+    return TRUE;
+}
+
+u8 tmemory_should_align_and_optionally_skip_zeroing(){
+    expect_to_be_true(start_memory_system());
+
+    // Sizes on both sides of the thread cache limit.
+    u64 sizes[] = {24, 200, 3000, 70000};
+    for(u32 i = 0; i < 4; ++i){
+        u8* block = tallocate(sizes[i], MEMORY_TAG_ARRAY);
+        expect_should_be(0, (u64)block % TMEMORY_DEFAULT_ALIGNMENT);
+
+        u8* aligned = tallocate_aligned(sizes[i], 256, MEMORY_TAG_ARRAY);
+        expect_should_not_be(0, aligned);
+        expect_should_be(0, (u64)aligned % 256);
+        expect_should_be(0, aligned[0]);
+        expect_should_be(0, aligned[sizes[i] - 1]);
+
+        tfree(aligned, sizes[i], MEMORY_TAG_ARRAY);
+        tfree(block, sizes[i], MEMORY_TAG_ARRAY);
+    }
+
+    // An uninitialized block keeps whatever was there. The cache hands back the block just freed.
+    u8* block = tallocate(64, MEMORY_TAG_ARRAY);
+    tset_memory(block, 0xCD, 64);
+    tfree(block, 64, MEMORY_TAG_ARRAY);
+    u8* reused = tallocate_uninitialized(64, TMEMORY_DEFAULT_ALIGNMENT, MEMORY_TAG_ARRAY);
+    expect_should_be(block, reused);
+    expect_should_be(0xCD, reused[63]);
+    tfree(reused, 64, MEMORY_TAG_ARRAY);
+
+    TDEBUG("Note: The following error is intentionally caused by this test.");
+    expect_should_be(0, tallocate_aligned(64, 24, MEMORY_TAG_ARRAY));
+
+    memory_system_shutdown();
+    return TRUE;
+}
+
+u8 tmemory_should_count_frame_allocations(){
+    expect_to_be_true(start_memory_system());
+
+    memory_system_begin_frame();
+    expect_should_be(0, get_memory_frame_alloc_count());
+
+    void* a = tallocate(64, MEMORY_TAG_GAME);
+    void* b = tallocate(KIBIBYTES(2), MEMORY_TAG_GAME);
+    expect_should_be(2, get_memory_frame_alloc_count());
+    tfree(a, 64, MEMORY_TAG_GAME);
+    tfree(b, KIBIBYTES(2), MEMORY_TAG_GAME);
+
+    // Frees don't count, and a new frame starts from zero.
+    expect_should_be(2, get_memory_frame_alloc_count());
+    memory_system_begin_frame();
+    expect_should_be(0, get_memory_frame_alloc_count());
+
+    memory_system_shutdown();
+    return TRUE;
+}
+
+u8 tmemory_should_track_tag_peaks_and_histograms(){
+#if TMEMORY_TELEMETRY
+    expect_to_be_true(start_memory_system());
+
+    void* blocks[3];
+    for(u32 i = 0; i < 3; ++i){
+        blocks[i] = tallocate(100, MEMORY_TAG_SCENE);
+    }
+    void* large = tallocate(KIBIBYTES(8), MEMORY_TAG_SCENE);
+    // Peaks are sampled, here by starting a frame at the high point.
+    memory_system_begin_frame();
+    tfree(large, KIBIBYTES(8), MEMORY_TAG_SCENE);
+    tfree(blocks[0], 100, MEMORY_TAG_SCENE);
+
+    memory_tag_stats stats;
+    expect_to_be_true(get_memory_tag_stats(MEMORY_TAG_SCENE, &stats));
+    expect_should_be(200, stats.current_bytes);
+    expect_should_be(300 + KIBIBYTES(8), stats.peak_bytes);
+    expect_should_be(4, stats.alloc_count);
+    expect_should_be(2, stats.free_count);
+    // 100 bytes falls in [64, 128), 8 KiB in [8 KiB, 16 KiB).
+    expect_should_be(3, stats.size_histogram[6]);
+    expect_should_be(1, stats.size_histogram[13]);
+
+    tfree(blocks[1], 100, MEMORY_TAG_SCENE);
+    tfree(blocks[2], 100, MEMORY_TAG_SCENE);
+    expect_to_be_true(get_memory_tag_stats(MEMORY_TAG_SCENE, &stats));
+    expect_should_be(0, stats.current_bytes);
+    expect_should_be(300 + KIBIBYTES(8), stats.peak_bytes);
+
+    memory_system_shutdown();
+    return TRUE;
+#else
+    return BYPASS;
+#endif
+}
+
+u8 tmemory_should_write_telemetry_with_call_sites(){
+#if TMEMORY_TELEMETRY
+    expect_to_be_true(start_memory_system());
+
+    const char* file = "tmemory_tests_site.c";
+    for(u32 i = 0; i < 5; ++i){
+        void* block = tallocate_at(48, TMEMORY_DEFAULT_ALIGNMENT, TRUE, MEMORY_TAG_ENTITY, file, 42);
+        // A frame starting while the block is live samples the peak.
+        memory_system_begin_frame();
+        tfree(block, 48, MEMORY_TAG_ENTITY);
+    }
+
+    const char* path = "memory_telemetry_test.json";
+    expect_to_be_true(memory_system_write_telemetry(path));
+
+    file_handle handle;
+    expect_to_be_true(filesystem_open(path, FILE_MODE_READ, FALSE, &handle));
+    u64 size = 0;
+    expect_to_be_true(filesystem_size(&handle, &size));
+    char* text = tallocate(size + 1, MEMORY_TAG_STRING);
+    u64 read = 0;
+    expect_to_be_true(filesystem_read_all_text(&handle, text, &read));
+    filesystem_close(&handle);
+
+    expect_should_be('{', text[0]);
+    expect_should_not_be(0, strstr(text, "\"tag\": \"ENTITY\", \"current_bytes\": 0, \"peak_bytes\": 48, \"alloc_count\": 5, \"free_count\": 5"));
+    expect_should_not_be(0, strstr(text, "{\"file\": \"tmemory_tests_site.c\", \"line\": 42, \"tag\": \"ENTITY\", \"alloc_count\": 5, \"total_bytes\": 240}"));
+
+    tfree(text, size + 1, MEMORY_TAG_STRING);
+    memory_system_shutdown();
+    return TRUE;
+#else
+    return BYPASS;
+#endif
+}
+
+void tmemory_register_tests(){
+    test_manager_register_test(tmemory_should_reuse_freed_small_blocks, "Memory system should reuse freed small blocks");
+    test_manager_register_test(tmemory_should_count_allocations_across_threads, "Memory system should count allocations across threads");
+    test_manager_register_test(tmemory_should_reclaim_caches_of_exited_threads, "Memory system should reclaim the caches of exited threads");
+    test_manager_register_test(tmemory_should_align_and_optionally_skip_zeroing, "Memory system should align blocks and optionally skip zeroing");
+    test_manager_register_test(tmemory_should_count_frame_allocations, "Memory system should count allocations per frame");
+    test_manager_register_test(tmemory_should_track_tag_peaks_and_histograms, "Memory system should track per-tag peaks and size histograms");
+    test_manager_register_test(tmemory_should_write_telemetry_with_call_sites, "Memory system should write telemetry with call sites as JSON");
+}
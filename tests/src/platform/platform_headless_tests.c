@@ -0,0 +1,120 @@
+#include "platform_headless_tests.h"
+#include "../test_manager.h"
+#include "../expect.h"
+
+#include <defines.h>
+#include <core/event.h>
+#include <core/input.h>
+#include <core/tmemory.h>
+#include <platform/platform_headless.h>
+
+typedef struct headless_test_state {
+    void* event_state;
+    u64 event_size;
+    void* input_state;
+    u64 input_size;
+} headless_test_state;
+
+static void start_systems(headless_test_state* out_state){
+    memory_system_configuration memory_config = {};
+    memory_config.total_alloc_size = MEBIBYTES(16);
+    memory_system_initialize(memory_config);
+
+    event_system_initialize(&out_state->event_size, 0);
+    out_state->event_state = tallocate(out_state->event_size, MEMORY_TAG_APPLICATION);
+    event_system_initialize(&out_state->event_size, out_state->event_state);
+
+    input_system_initialize(&out_state->input_size, 0);
+    out_state->input_state = tallocate(out_state->input_size, MEMORY_TAG_APPLICATION);
+    input_system_initialize(&out_state->input_size, out_state->input_state);
+}
+
+static void stop_systems(headless_test_state* state){
+    input_system_shutdown(state->input_state);
+    tfree(state->input_state, state->input_size, MEMORY_TAG_APPLICATION);
+    event_system_shutdown(state->event_state);
+    tfree(state->event_state, state->event_size, MEMORY_TAG_APPLICATION);
+    memory_system_shutdown();
+}
+
+static u16 resized_width;
+static u16 resized_height;
+
+static b8 on_resized(u16 code, void* sender, void* listener_inst, event_context context){
+    resized_width = context.data.u16[0];
+    resized_height = context.data.u16[1];
+    return FALSE;
+}
+
+u8 platform_headless_should_deliver_queued_input(){
+    headless_test_state state;
+    start_systems(&state);
+
+    platform_headless_queue_key(KEY_A, TRUE);
+    platform_headless_queue_button(BUTTON_LEFT, TRUE);
+    platform_headless_queue_mouse_move(10, 20);
+
+    // Nothing is delivered until the pump.
+    expect_to_be_false(input_is_key_down(KEY_A));
+    expect_to_be_true(platform_headless_pump());
+    expect_to_be_true(input_is_key_down(KEY_A));
+    expect_to_be_true(input_is_button_down(BUTTON_LEFT));
+    i32 x, y;
+    input_get_mouse_position(&x, &y);
+    expect_should_be(10, x);
+    expect_should_be(20, y);
+
+    // Releases arrive in order on the next pump.
+    platform_headless_queue_key(KEY_A, FALSE);
+    expect_to_be_true(platform_headless_pump());
+    expect_to_be_false(input_is_key_down(KEY_A));
+
+    stop_systems(&state);
+    return TRUE;
+}
+
+u8 platform_headless_should_fire_resize_and_quit(){
+    headless_test_state state;
+    start_systems(&state);
+    event_register(EVENT_CODE_RESIZED, 0, on_resized);
+    resized_width = 0;
+    resized_height = 0;
+
+    platform_headless_queue_resize(800, 600);
+    platform_headless_queue_quit();
+    expect_to_be_false(platform_headless_pump());
+    expect_should_be(800, resized_width);
+    expect_should_be(600, resized_height);
+
+    // The queue is empty afterwards.
+    expect_to_be_true(platform_headless_pump());
+
+    event_unregister(EVENT_CODE_RESIZED, 0, on_resized);
+    stop_systems(&state);
+    return TRUE;
+}
+
+u8 platform_headless_should_drop_events_when_full(){
+    headless_test_state state;
+    start_systems(&state);
+
+    for(i16 i = 0; i < PLATFORM_HEADLESS_MAX_QUEUED_EVENTS; ++i){
+        platform_headless_queue_mouse_move(i, 0);
+    }
+    // One more than fits is dropped with a warning.
+    platform_headless_queue_mouse_move(-1, 0);
+    expect_to_be_true(platform_headless_pump());
+
+    i32 x, y;
+    input_get_mouse_position(&x, &y);
+    expect_should_be(PLATFORM_HEADLESS_MAX_QUEUED_EVENTS - 1, x);
+
+    stop_systems(&state);
+    return TRUE;
+}
+
+void platform_headless_register_tests(){
+    test_manager_register_test(platform_headless_should_deliver_queued_input, "Headless platform should deliver queued input when pumped.");
+    test_manager_register_test(platform_headless_should_fire_resize_and_quit, "Headless platform should fire resizes and report quits.");
+    test_manager_register_test(platform_headless_should_drop_events_when_full, "Headless platform should drop events once the queue is full.");
+}
@@ -0,0 +1,3 @@
+#pragma once
+
+void platform_headless_register_tests();
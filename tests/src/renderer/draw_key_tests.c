@@ -0,0 +1,116 @@
+#include "draw_key_tests.h"
+#include "../test_manager.h"
+#include "../expect.h"
+
+#include <defines.h>
+#include <core/tmemory.h>
+#include <renderer/draw_key.h>
+
+#define ENTRY_COUNT 5000
+
+static draw_key_entry entries[ENTRY_COUNT];
+static draw_key_entry expected[ENTRY_COUNT];
+static draw_key_entry scratch[ENTRY_COUNT];
+
+static u32 seed;
+
+static u32 next_u32(){
+    seed = seed * 1103515245 + 12345;
+    return seed >> 8;
+}
+
+/** A plain stable insertion sort to check against. */
+static void reference_sort(draw_key_entry* items, u32 count){
+    for(u32 i = 1; i < count; ++i){
+        draw_key_entry item = items[i];
+        u32 j = i;
+        while(j > 0 && items[j - 1].key > item.key){
+            items[j] = items[j - 1];
+            --j;
+        }
+        items[j] = item;
+    }
+}
+
+static b8 sort_matches_reference(u32 count){
+    tcopy_memory(expected, entries, sizeof(draw_key_entry) * count);
+    reference_sort(expected, count);
+    draw_keys_sort(entries, count, scratch);
+    for(u32 i = 0; i < count; ++i){
+        if(entries[i].key != expected[i].key || entries[i].index != expected[i].index){
+            TERROR("--> Entry %u differs from the reference sort.", i);
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+u8 draw_key_sort_should_be_stable_and_ordered(){
+    seed = 11;
+    // Few distinct keys spread across every byte, so there are many ties to keep in order.
+    for(u32 i = 0; i < ENTRY_COUNT; ++i){
+        u64 k = next_u32() % 64;
+        entries[i].key = (k << 58) | (k << 33) | (k << 9) | (k % 3);
+        entries[i].index = i;
+    }
+    expect_to_be_true(sort_matches_reference(ENTRY_COUNT));
+
+    // Sorting what is already sorted changes nothing.
+    expect_to_be_true(sort_matches_reference(ENTRY_COUNT));
+
+    // Reversed input.
+    for(u32 i = 0; i < ENTRY_COUNT; ++i){
+        entries[i].key = ((u64)(ENTRY_COUNT - i) << 32) | next_u32();
+        entries[i].index = i;
+    }
+    expect_to_be_true(sort_matches_reference(ENTRY_COUNT));
+
+    // Keys that are all the same skip every pass and keep their order.
+    for(u32 i = 0; i < ENTRY_COUNT; ++i){
+        entries[i].key = 0x1234;
+        entries[i].index = i;
+    }
+    expect_to_be_true(sort_matches_reference(ENTRY_COUNT));
+
+    // Tiny and empty inputs.
+    entries[0].key = 2;
+    entries[1].key = 1;
+    expect_to_be_true(sort_matches_reference(2));
+    draw_keys_sort(entries, 0, scratch);
+    return TRUE;
+}
+
+u8 draw_key_should_order_draws(){
+    // Opaque: by shader, then material, then geometry, then front to back.
+    u64 near_a = draw_key_create_opaque(0, 1, 5, 7, 0.1f);
+    u64 far_a = draw_key_create_opaque(0, 1, 5, 7, 0.9f);
+    u64 other_geometry = draw_key_create_opaque(0, 1, 5, 8, 0.0f);
+    u64 near_b = draw_key_create_opaque(0, 1, 6, 0, 0.05f);
+    u64 other_shader = draw_key_create_opaque(0, 2, 0, 0, 0.0f);
+    expect_to_be_true(near_a < far_a);
+    expect_to_be_true(far_a < other_geometry);
+    expect_to_be_true(other_geometry < near_b);
+    expect_to_be_true(near_b < other_shader);
+
+    // Translucent: after every opaque draw in the pass, back to front whatever the state.
+    u64 far_t = draw_key_create_translucent(0, 3, 1, 0.9f);
+    u64 near_t = draw_key_create_translucent(0, 0, 0, 0.1f);
+    expect_to_be_true(other_shader < far_t);
+    expect_to_be_true(far_t < near_t);
+    expect_to_be_true(draw_key_is_translucent(far_t));
+    expect_to_be_false(draw_key_is_translucent(far_a));
+
+    // Passes come before everything else.
+    expect_to_be_true(near_t < draw_key_create_opaque(1, 0, 0, 0, 0.0f));
+
+    // Depths outside [0, 1] are clamped rather than spilling into other fields.
+    expect_to_be_true(draw_key_create_opaque(0, 1, 5, 7, 2.0f) < other_geometry);
+    expect_to_be_true(draw_key_create_opaque(0, 1, 5, 7, -1.0f) == draw_key_create_opaque(0, 1, 5, 7, 0.0f));
+    expect_to_be_true(draw_key_create_translucent(0, 0, 0, 5.0f) == draw_key_create_translucent(0, 0, 0, 1.0f));
+    return TRUE;
+}
+
+void draw_key_register_tests(){
+    test_manager_register_test(draw_key_sort_should_be_stable_and_ordered, "Draw key sort should be stable and ordered.");
+    test_manager_register_test(draw_key_should_order_draws, "Draw keys should order opaque draws by state, geometry and depth and translucent draws back to front.");
+}
@@ -0,0 +1,168 @@
+#include "null_backend_tests.h"
+#include "../test_manager.h"
+#include "../expect.h"
+
+#include <defines.h>
+#include <core/tmemory.h>
+#include <renderer/null/null_backend.h>
+#include <systems/shader_system.h>
+
+static u32 refresh_count;
+
+static void on_refresh_required(){
+    refresh_count++;
+}
+
+static b8 start_backend(renderer_backend* backend, u8* out_target_count){
+    memory_system_configuration memory_config = {};
+    memory_config.total_alloc_size = MEBIBYTES(16);
+    memory_system_initialize(memory_config);
+
+    renderpass_config pass_configs[2] = {};
+    pass_configs[0].name = "Renderpass.Test.World";
+    pass_configs[0].next_name = "Renderpass.Test.UI";
+    pass_configs[0].clear_flags = RENDERPASS_CLEAR_COLOUR_BUFFER_FLAG;
+    pass_configs[1].name = "Renderpass.Test.UI";
+    pass_configs[1].prev_name = "Renderpass.Test.World";
+
+    renderer_backend_config config = {};
+    config.application_name = "null backend tests";
+    config.renderpass_count = 2;
+    config.pass_configs = pass_configs;
+    config.on_rendertarget_refresh_required = on_refresh_required;
+    refresh_count = 0;
+    return null_renderer_backend_initialize(backend, &config, out_target_count);
+}
+
+static void stop_backend(renderer_backend* backend){
+    null_renderer_backend_shutdown(backend);
+    memory_system_shutdown();
+}
+
+u8 null_backend_should_register_renderpasses_and_targets(){
+    renderer_backend backend = {};
+    u8 target_count = 0;
+    expect_to_be_true(start_backend(&backend, &target_count));
+    expect_should_be(3, target_count);
+
+    renderpass* world = null_renderer_renderpass_get("Renderpass.Test.World");
+    expect_should_not_be(0, world);
+    expect_should_be(RENDERPASS_CLEAR_COLOUR_BUFFER_FLAG, world->clear_flags);
+    expect_should_not_be(0, null_renderer_renderpass_get("Renderpass.Test.UI"));
+    expect_should_be(0, null_renderer_renderpass_get("Renderpass.Test.Missing"));
+
+    // Targets keep a copy of their attachments until destroyed.
+    texture* attachments[2] = {null_renderer_window_attachment_get(0), null_renderer_depth_attachment_get()};
+    expect_should_be(1280, attachments[0]->width);
+    render_target target = {};
+    null_renderer_render_target_create(2, attachments, world, 1280, 720, &target);
+    expect_should_be(2, target.attachment_count);
+    expect_should_be(attachments[1], target.attachments[1]);
+    null_renderer_render_target_destroy(&target, TRUE);
+    expect_should_be(0, target.attachments);
+
+    // A resize updates the window attachments and asks for the targets to be regenerated.
+    null_renderer_backend_on_resized(&backend, 800, 600);
+    expect_should_be(1, refresh_count);
+    expect_should_be(800, null_renderer_window_attachment_get(2)->width);
+    expect_should_be(600, null_renderer_depth_attachment_get()->height);
+
+    stop_backend(&backend);
+    return TRUE;
+}
+
+u8 null_backend_should_count_uploads_and_draws(){
+    renderer_backend backend = {};
+    u8 target_count = 0;
+    expect_to_be_true(start_backend(&backend, &target_count));
+
+    f32 vertices[4 * 8] = {0};
+    u32 indices[6] = {0, 1, 2, 2, 3, 0};
+    geometry g = {};
+    g.internal_id = INVALID_ID;
+    expect_to_be_true(null_renderer_create_geometry(&g, sizeof(f32) * 8, 4, vertices, sizeof(u32), 6, indices));
+    expect_should_not_be(INVALID_ID, g.internal_id);
+
+    expect_to_be_true(null_renderer_backend_begin_frame(&backend, 0.016f));
+    geometry_render_data data = {};
+    data.geometry = &g;
+    null_renderer_draw_geometry(&data, TRUE);
+    null_renderer_draw_geometry(&data, FALSE);
+    // Three copies in a single draw.
+    geometry_render_data instances[3] = {data, data, data};
+    null_renderer_draw_geometry_instanced(instances, 3, FALSE);
+    expect_to_be_true(null_renderer_backend_end_frame(&backend, 0.016f));
+    expect_should_be(1, null_renderer_window_attachment_index_get());
+
+    renderer_backend_stats stats;
+    expect_to_be_true(null_renderer_get_stats(&stats));
+    expect_should_be(1, stats.frame_count);
+    expect_should_be(3, stats.draw_count);
+    expect_should_be(3, stats.instance_count);
+    expect_should_be(30, stats.element_count);
+    expect_should_be(1, stats.buffer_bind_count);
+    expect_should_be(sizeof(vertices) + sizeof(indices), stats.bytes_uploaded);
+    expect_should_be(1, stats.geometry_count);
+
+    null_renderer_destroy_geometry(&g);
+    expect_to_be_true(null_renderer_get_stats(&stats));
+    expect_should_be(0, stats.geometry_count);
+
+    stop_backend(&backend);
+    return TRUE;
+}
+
+u8 null_backend_should_lay_out_shader_uniforms(){
+    renderer_backend backend = {};
+    u8 target_count = 0;
+    expect_to_be_true(start_backend(&backend, &target_count));
+
+    shader s = {};
+    s.global_ubo_size = 100;
+    s.ubo_size = 40;
+    expect_to_be_true(null_renderer_shader_create(&s, 0, 0, 0, 0, 0));
+    expect_to_be_true(null_renderer_shader_initialize(&s));
+    expect_should_be(256, s.global_ubo_stride);
+    expect_should_be(256, s.ubo_stride);
+
+    u32 first = INVALID_ID;
+    u32 second = INVALID_ID;
+    expect_to_be_true(null_renderer_shader_acquire_instance_resources(&s, 0, &first));
+    expect_to_be_true(null_renderer_shader_acquire_instance_resources(&s, 0, &second));
+    expect_should_be(0, first);
+    expect_should_be(1, second);
+
+    // Instances follow the globals, one stride apart.
+    expect_to_be_true(null_renderer_shader_bind_instance(&s, second));
+    expect_should_be(512, s.bound_ubo_offset);
+    expect_to_be_true(null_renderer_shader_bind_globals(&s));
+    expect_should_be(0, s.bound_ubo_offset);
+
+    // Binding an instance's resources alone leaves the shader's bound instance alone, since
+    // it may be happening on several threads at once.
+    renderer_backend_stats stats = {};
+    expect_to_be_true(null_renderer_get_stats(&stats));
+    u64 bind_count = stats.bind_count;
+    expect_to_be_true(null_renderer_shader_bind_instance_resources(&s, first));
+    expect_should_be(second, s.bound_instance_id);
+    expect_should_be(0, s.bound_ubo_offset);
+    expect_to_be_true(null_renderer_get_stats(&stats));
+    expect_should_be(bind_count + 1, stats.bind_count);
+
+    // Released ids are handed out again.
+    expect_to_be_true(null_renderer_shader_release_instance_resources(&s, first));
+    expect_to_be_true(null_renderer_shader_acquire_instance_resources(&s, 0, &first));
+    expect_should_be(0, first);
+
+    null_renderer_shader_destroy(&s);
+    expect_should_be(0, s.internal_data);
+
+    stop_backend(&backend);
+    return TRUE;
+}
+
+void null_backend_register_tests(){
+    test_manager_register_test(null_backend_should_register_renderpasses_and_targets, "Null backend should register renderpasses and create render targets.");
+    test_manager_register_test(null_backend_should_count_uploads_and_draws, "Null backend should count uploads and draws.");
+    test_manager_register_test(null_backend_should_lay_out_shader_uniforms, "Null backend should lay out shader uniforms like a real device.");
+}
@@ -0,0 +1,306 @@
+#include "job_system_tests.h"
+#include "../test_manager.h"
+#include "../expect.h"
+
+#include <defines.h>
+#include <core/tmemory.h>
+#include <core/tatomic.h>
+#include <systems/job_system.h>
+
+#define TEST_JOB_THREAD_COUNT 3
+
+static void* state;
+static u64 memory_requirement;
+
+static volatile i32 counter;
+static volatile i32 order_violations;
+static u32 callbacks_run;
+static u64 callback_sum;
+
+static void start_job_system(){
+    u32 type_masks[TEST_JOB_THREAD_COUNT] = {JOB_TYPE_GENERAL, JOB_TYPE_GENERAL, JOB_TYPE_GENERAL | JOB_TYPE_RESOURCE_LOAD};
+    job_system_initialize(&memory_requirement, 0, 0, 0);
+    state = tallocate(memory_requirement, MEMORY_TAG_APPLICATION);
+    job_system_initialize(&memory_requirement, state, TEST_JOB_THREAD_COUNT, type_masks);
+    tatomic_store_i32(&counter, 0, TATOMIC_SEQ_CST);
+    tatomic_store_i32(&order_violations, 0, TATOMIC_SEQ_CST);
+}
+
+static void stop_job_system(){
+    job_system_shutdown(state);
+    tfree(state, memory_requirement, MEMORY_TAG_APPLICATION);
+    state = 0;
+}
+
+static b8 increment_job(void* params, void* result_data){
+    tatomic_fetch_add_i32(&counter, 1, TATOMIC_SEQ_CST);
+    return TRUE;
+}
+
+static b8 follow_up_job(void* params, void* result_data){
+    // Every job of the first batch must have finished before this starts.
+    if(tatomic_load_i32(&counter, TATOMIC_SEQ_CST) != *(i32*)params){
+        tatomic_fetch_add_i32(&order_violations, 1, TATOMIC_SEQ_CST);
+    }
+    return TRUE;
+}
+
+// Odd jobs return results too large to be stored inline, so they go through the heap.
+static u32 result_count_for(u64 value){
+    return value % 2 ? 16 : 2;
+}
+
+static b8 result_job(void* params, void* result_data){
+    u64 value = *(u64*)params;
+    u64* results = result_data;
+    results[0] = value;
+    results[result_count_for(value) - 1] = value;
+    return TRUE;
+}
+
+static void on_result(void* params){
+    u64* results = params;
+    callbacks_run++;
+    callback_sum += results[0] + results[result_count_for(results[0]) - 1];
+}
+
+static void square_range(u32 begin, u32 end, void* user_data){
+    u32* values = user_data;
+    for(u32 i = begin; i < end; ++i){
+        values[i] = values[i] * values[i] + 1;
+    }
+}
+
+u8 job_system_should_wait_for_batch(){
+    start_job_system();
+
+    job_info jobs[64];
+    for(u32 i = 0; i < 64; ++i){
+        jobs[i] = job_create(increment_job, 0, 0, 0, 0, 0);
+    }
+    job_handle handle = job_system_submit_batch(jobs, 64);
+    job_system_wait(handle);
+
+    expect_to_be_true(job_system_is_complete(handle));
+    expect_should_be(64, tatomic_load_i32(&counter, TATOMIC_SEQ_CST));
+
+    stop_job_system();
+    return TRUE;
+}
+
+u8 job_system_should_run_follow_up_after_dependency(){
+    start_job_system();
+
+    job_info jobs[32];
+    for(u32 i = 0; i < 32; ++i){
+        jobs[i] = job_create(increment_job, 0, 0, 0, 0, 0);
+    }
+    job_handle first = job_system_submit_batch(jobs, 32);
+
+    i32 expected_count = 32;
+    job_info follow_ups[4];
+    for(u32 i = 0; i < 4; ++i){
+        follow_ups[i] = job_create_type(follow_up_job, 0, 0, &expected_count, sizeof(i32), 0, i % 2 ? JOB_TYPE_RESOURCE_LOAD : JOB_TYPE_GENERAL);
+    }
+    job_handle second = job_system_submit_batch_after(first, follow_ups, 4);
+    job_system_wait(second);
+
+    expect_to_be_true(job_system_is_complete(first));
+    expect_should_be(0, tatomic_load_i32(&order_violations, TATOMIC_SEQ_CST));
+
+    // Depending on a batch that has already completed submits right away.
+    job_info late_follow_up = job_create(follow_up_job, 0, 0, &expected_count, sizeof(i32), 0);
+    job_handle third = job_system_submit_batch_after(first, &late_follow_up, 1);
+    job_system_wait(third);
+    expect_should_be(0, tatomic_load_i32(&order_violations, TATOMIC_SEQ_CST));
+
+    stop_job_system();
+    return TRUE;
+}
+
+u8 job_system_parallel_for_should_visit_each_index_once(){
+    start_job_system();
+
+    u32 values[1000];
+    for(u32 i = 0; i < 1000; ++i){
+        values[i] = i;
+    }
+    job_system_parallel_for(1000, 7, square_range, values);
+
+    for(u32 i = 0; i < 1000; ++i){
+        expect_should_be(i * i + 1, values[i]);
+    }
+
+    // A grain of zero is treated as one.
+    job_system_parallel_for(10, 0, square_range, values);
+    expect_should_be(5, values[1]);
+
+    stop_job_system();
+    return TRUE;
+}
+
+static void record_thread_slot(u32 begin, u32 end, void* user_data){
+    u32* slots = user_data;
+    for(u32 i = begin; i < end; ++i){
+        slots[i] = job_system_thread_slot();
+    }
+}
+
+u8 job_system_should_give_each_thread_its_own_slot(){
+    // Without a job system there is only the one slot.
+    expect_should_be(1, job_system_thread_slot_count());
+    expect_should_be(0, job_system_thread_slot());
+
+    start_job_system();
+    expect_should_be(TEST_JOB_THREAD_COUNT + 1, job_system_thread_slot_count());
+    expect_should_be(0, job_system_thread_slot());
+
+    u32 slots[256];
+    job_system_parallel_for(256, 1, record_thread_slot, slots);
+    for(u32 i = 0; i < 256; ++i){
+        expect_to_be_true(slots[i] < TEST_JOB_THREAD_COUNT + 1);
+    }
+
+    stop_job_system();
+    return TRUE;
+}
+
+// Per thread slot, whether the thread is waiting on a batch.
+static volatile i32 slot_waiting[TEST_JOB_THREAD_COUNT + 1];
+
+// Slow enough that the other threads are still busy with their chunks when the caller runs out.
+static void spin_range(u32 begin, u32 end, void* user_data){
+    for(u32 i = begin; i < end; ++i){
+        for(u32 j = 0; j < 20000; ++j){
+            tatomic_pause();
+        }
+        tatomic_fetch_add_i32(&counter, 1, TATOMIC_SEQ_CST);
+    }
+}
+
+static b8 load_job(void* params, void* result_data){
+    // Picked up by a thread while it waits on a batch.
+    if(tatomic_load_i32(&slot_waiting[job_system_thread_slot()], TATOMIC_SEQ_CST)){
+        tatomic_fetch_add_i32(&order_violations, 1, TATOMIC_SEQ_CST);
+    }
+    return TRUE;
+}
+
+static b8 waiting_job(void* params, void* result_data){
+    // The load is queued where this thread would find it first, were it allowed to run it.
+    job_info load = job_create_type(load_job, 0, 0, 0, 0, 0, JOB_TYPE_RESOURCE_LOAD);
+    **(job_handle**)params = job_system_submit_batch(&load, 1);
+
+    u32 slot = job_system_thread_slot();
+    tatomic_store_i32(&slot_waiting[slot], 1, TATOMIC_SEQ_CST);
+    job_system_parallel_for(256, 1, spin_range, 0);
+    tatomic_store_i32(&slot_waiting[slot], 0, TATOMIC_SEQ_CST);
+    return TRUE;
+}
+
+u8 job_system_waits_should_only_help_with_general_jobs(){
+    start_job_system();
+
+    job_handle load_handles[16];
+    job_info waiters[16];
+    for(u32 i = 0; i < 16; ++i){
+        job_handle* load_handle = &load_handles[i];
+        // Only the thread that runs loads runs these, so it is the one waiting.
+        waiters[i] = job_create_type(waiting_job, 0, 0, &load_handle, sizeof(job_handle*), 0, JOB_TYPE_RESOURCE_LOAD);
+    }
+    job_system_wait(job_system_submit_batch(waiters, 16));
+    for(u32 i = 0; i < 16; ++i){
+        job_system_wait(load_handles[i]);
+    }
+
+    expect_should_be(16 * 256, tatomic_load_i32(&counter, TATOMIC_SEQ_CST));
+    expect_should_be(0, tatomic_load_i32(&order_violations, TATOMIC_SEQ_CST));
+
+    stop_job_system();
+    return TRUE;
+}
+
+u8 job_system_should_keep_results_when_queue_overflows(){
+    start_job_system();
+    callbacks_run = 0;
+    callback_sum = 0;
+
+    // More results than the result queue holds, all completing before any are processed.
+    const u32 job_count = 3000;
+    job_info* jobs = tallocate(sizeof(job_info) * job_count, MEMORY_TAG_JOB);
+    u64 expected_sum = 0;
+    for(u64 i = 0; i < job_count; ++i){
+        jobs[i] = job_create(result_job, on_result, 0, &i, sizeof(u64), sizeof(u64) * result_count_for(i));
+        expected_sum += i * 2;
+    }
+    job_system_wait(job_system_submit_batch(jobs, job_count));
+    tfree(jobs, sizeof(job_info) * job_count, MEMORY_TAG_JOB);
+
+    job_result_stats stats;
+    job_system_get_result_stats(&stats);
+    expect_should_be(job_count, stats.pending_count);
+    expect_to_be_true(stats.overflow_count > 0);
+
+    job_system_update();
+    expect_should_be(job_count, callbacks_run);
+    expect_should_be(expected_sum, callback_sum);
+
+    job_system_get_result_stats(&stats);
+    expect_should_be(0, stats.pending_count);
+    expect_should_be(job_count, stats.peak_pending_count);
+
+    stop_job_system();
+    return TRUE;
+}
+
+static b8 never_run_job(void* params, void* result_data){
+    return TRUE;
+}
+
+u8 job_system_shutdown_should_free_queued_job_data(){
+#if TMEMORY_TELEMETRY
+    memory_system_configuration config = {};
+    config.total_alloc_size = MEBIBYTES(16);
+    expect_to_be_true(memory_system_initialize(config));
+    memory_tag_stats before;
+    expect_to_be_true(get_memory_tag_stats(MEMORY_TAG_JOB, &before));
+
+    start_job_system();
+
+    // No thread runs GPU jobs, so these stay in the injection queue, and the
+    // follow-up batch stays parked on them, until shutdown.
+    u64 value = 7;
+    job_info gpu_jobs[8];
+    for(u32 i = 0; i < 8; ++i){
+        gpu_jobs[i] = job_create_type(never_run_job, 0, 0, &value, sizeof(u64), 600, JOB_TYPE_GPU_RESOURCE);
+    }
+    job_handle gpu_handle = job_system_submit_batch(gpu_jobs, 8);
+    job_info follow_ups[4];
+    for(u32 i = 0; i < 4; ++i){
+        follow_ups[i] = job_create(never_run_job, 0, 0, &value, sizeof(u64), 40);
+    }
+    job_system_submit_batch_after(gpu_handle, follow_ups, 4);
+    expect_to_be_false(job_system_is_complete(gpu_handle));
+
+    stop_job_system();
+
+    memory_tag_stats after;
+    expect_to_be_true(get_memory_tag_stats(MEMORY_TAG_JOB, &after));
+    expect_should_be(before.current_bytes, after.current_bytes);
+
+    memory_system_shutdown();
+    return TRUE;
+#else
+    return BYPASS;
+#endif
+}
+
+void job_system_register_tests(){
+    test_manager_register_test(job_system_should_wait_for_batch, "Job system should wait for a batch of jobs");
+    test_manager_register_test(job_system_should_run_follow_up_after_dependency, "Job system should run follow-up jobs after their dependency");
+    test_manager_register_test(job_system_should_keep_results_when_queue_overflows, "Job system should keep results when the result queue overflows");
+    test_manager_register_test(job_system_parallel_for_should_visit_each_index_once, "Job system parallel for should visit each index once");
+    test_manager_register_test(job_system_should_give_each_thread_its_own_slot, "Job system should give each thread its own slot");
+    test_manager_register_test(job_system_waits_should_only_help_with_general_jobs, "Job system waits should only help with general jobs");
+    test_manager_register_test(job_system_shutdown_should_free_queued_job_data, "Job system shutdown should free the data of jobs that never ran");
+}
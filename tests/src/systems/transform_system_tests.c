@@ -0,0 +1,237 @@
+#include "transform_system_tests.h"
+#include "../test_manager.h"
+#include "../expect.h"
+
+#include <defines.h>
+#include <core/tmemory.h>
+#include <math/tmath.h>
+#include <math/transform.h>
+#include <systems/job_system.h>
+#include <systems/transform_system.h>
+
+#define TEST_JOB_THREAD_COUNT 3
+
+typedef struct transform_test_state {
+    void* state;
+    u64 size;
+    void* job_state;
+    u64 job_size;
+} transform_test_state;
+
+static void start_transform_system(u32 max_transform_count, b8 with_jobs, transform_test_state* out_state){
+    memory_system_configuration memory_config = {};
+    memory_config.total_alloc_size = MEBIBYTES(64);
+    memory_system_initialize(memory_config);
+
+    out_state->job_state = 0;
+    if(with_jobs){
+        u32 type_masks[TEST_JOB_THREAD_COUNT] = {JOB_TYPE_GENERAL, JOB_TYPE_GENERAL, JOB_TYPE_GENERAL};
+        job_system_initialize(&out_state->job_size, 0, 0, 0);
+        out_state->job_state = tallocate(out_state->job_size, MEMORY_TAG_APPLICATION);
+        job_system_initialize(&out_state->job_size, out_state->job_state, TEST_JOB_THREAD_COUNT, type_masks);
+    }
+
+    transform_system_config config;
+    config.max_transform_count = max_transform_count;
+    transform_system_initialize(&out_state->size, 0, config);
+    out_state->state = tallocate(out_state->size, MEMORY_TAG_APPLICATION);
+    transform_system_initialize(&out_state->size, out_state->state, config);
+}
+
+static void stop_transform_system(transform_test_state* state){
+    transform_system_shutdown(state->state);
+    tfree(state->state, state->size, MEMORY_TAG_APPLICATION);
+    if(state->job_state){
+        job_system_shutdown(state->job_state);
+        tfree(state->job_state, state->job_size, MEMORY_TAG_APPLICATION);
+    }
+    memory_system_shutdown();
+}
+
+static b8 matrices_match(mat4 expected, mat4 actual){
+    for(u32 i = 0; i < 16; ++i){
+        if(tabs(expected.data[i] - actual.data[i]) > 0.0001f * (1.0f + tabs(expected.data[i]))){
+            TERROR("--> Element %u: expected %f, but got %f.", i, expected.data[i], actual.data[i]);
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+u8 transform_system_should_match_transform_hierarchy(){
+    transform_test_state state;
+    start_transform_system(16, FALSE, &state);
+
+    quat spin = quat_from_axis_angle((vec3){0, 1, 0}, 0.3f, TRUE);
+    vec3 scale = (vec3){2.0f, 1.0f, 0.5f};
+
+    // The same three-level hierarchy, both ways.
+    transform a = transform_from_position_rotation_scale((vec3){1, 2, 3}, spin, scale);
+    transform b = transform_from_position((vec3){10, 0, 1});
+    transform c = transform_from_position_rotation((vec3){5, 0, 1}, spin);
+    transform_set_parent(&b, &a);
+    transform_set_parent(&c, &b);
+
+    u32 ha = transform_system_create((vec3){1, 2, 3}, spin, scale);
+    u32 hb = transform_system_create((vec3){10, 0, 1}, quat_identity(), vec3_one());
+    u32 hc = transform_system_create((vec3){5, 0, 1}, spin, vec3_one());
+    expect_to_be_true(transform_system_set_parent(hb, ha));
+    expect_to_be_true(transform_system_set_parent(hc, hb));
+    expect_should_be(hb, transform_system_get_parent(hc));
+    expect_should_be(INVALID_ID, transform_system_get_parent(ha));
+
+    transform_system_update();
+    expect_to_be_true(matrices_match(transform_get_local(&a), transform_system_get_local(ha)));
+    expect_to_be_true(matrices_match(transform_get_world(&a), transform_system_get_world(ha)));
+    expect_to_be_true(matrices_match(transform_get_world(&b), transform_system_get_world(hb)));
+    expect_to_be_true(matrices_match(transform_get_world(&c), transform_system_get_world(hc)));
+
+    // Moving the root moves everything below it.
+    transform_rotate(&a, spin);
+    transform_system_rotate(ha, spin);
+    transform_system_update();
+    expect_to_be_true(matrices_match(transform_get_world(&b), transform_system_get_world(hb)));
+    expect_to_be_true(matrices_match(transform_get_world(&c), transform_system_get_world(hc)));
+
+    stop_transform_system(&state);
+    return TRUE;
+}
+
+u8 transform_system_should_update_only_after_update(){
+    transform_test_state state;
+    start_transform_system(16, FALSE, &state);
+
+    u32 parent = transform_system_create(vec3_zero(), quat_identity(), vec3_one());
+    u32 child = transform_system_create((vec3){1, 0, 0}, quat_identity(), vec3_one());
+    transform_system_set_parent(child, parent);
+    transform_system_update();
+    expect_float_to_be(1.0f, transform_system_get_world(child).data[12]);
+
+    // Matrices are those of the last update until the next one.
+    transform_system_set_position(parent, (vec3){5, 0, 0});
+    expect_float_to_be(1.0f, transform_system_get_world(child).data[12]);
+    expect_float_to_be(5.0f, transform_system_get_position(parent).x);
+    transform_system_update();
+    expect_float_to_be(6.0f, transform_system_get_world(child).data[12]);
+
+    // Moving the child leaves the parent alone.
+    transform_system_translate(child, (vec3){0, 2, 0});
+    transform_system_update();
+    expect_float_to_be(5.0f, transform_system_get_world(parent).data[12]);
+    expect_float_to_be(0.0f, transform_system_get_world(parent).data[13]);
+    expect_float_to_be(2.0f, transform_system_get_world(child).data[13]);
+
+    stop_transform_system(&state);
+    return TRUE;
+}
+
+u8 transform_system_should_order_parents_created_after_children(){
+    transform_test_state state;
+    start_transform_system(16, FALSE, &state);
+
+    // Created deepest first, so the hierarchy runs against creation order.
+    u32 grandchild = transform_system_create((vec3){0, 0, 1}, quat_identity(), vec3_one());
+    u32 child = transform_system_create((vec3){0, 1, 0}, quat_identity(), vec3_one());
+    u32 root = transform_system_create((vec3){1, 0, 0}, quat_identity(), (vec3){2, 2, 2});
+    expect_to_be_true(transform_system_set_parent(grandchild, child));
+    expect_to_be_true(transform_system_set_parent(child, root));
+    transform_system_update();
+
+    mat4 world = transform_system_get_world(grandchild);
+    expect_float_to_be(1.0f, world.data[12]);
+    expect_float_to_be(2.0f, world.data[13]);
+    expect_float_to_be(2.0f, world.data[14]);
+
+    // Re-parenting to a detached transform and back again.
+    expect_to_be_true(transform_system_set_parent(child, INVALID_ID));
+    transform_system_update();
+    expect_float_to_be(1.0f, transform_system_get_world(grandchild).data[13]);
+    expect_float_to_be(0.0f, transform_system_get_world(grandchild).data[12]);
+
+    // A transform cannot become its own ancestor.
+    expect_to_be_true(transform_system_set_parent(child, root));
+    TDEBUG("Note: The following errors are intentionally caused by this test.");
+    expect_to_be_false(transform_system_set_parent(root, grandchild));
+    expect_to_be_false(transform_system_set_parent(root, root));
+
+    stop_transform_system(&state);
+    return TRUE;
+}
+
+u8 transform_system_should_destroy_and_reuse_handles(){
+    transform_test_state state;
+    start_transform_system(4, FALSE, &state);
+
+    u32 handles[4];
+    for(u32 i = 0; i < 4; ++i){
+        handles[i] = transform_system_create((vec3){(f32)i, 0, 0}, quat_identity(), vec3_one());
+        expect_should_not_be(INVALID_ID, handles[i]);
+    }
+    expect_to_be_true(transform_system_set_parent(handles[3], handles[1]));
+    transform_system_update();
+    expect_float_to_be(4.0f, transform_system_get_world(handles[3]).data[12]);
+
+    // Full.
+    TDEBUG("Note: The following error is intentionally caused by this test.");
+    expect_should_be(INVALID_ID, transform_system_create(vec3_zero(), quat_identity(), vec3_one()));
+
+    // Destroying the parent leaves its child as a root.
+    transform_system_destroy(handles[1]);
+    expect_should_be(3, transform_system_count());
+    transform_system_update();
+    expect_should_be(INVALID_ID, transform_system_get_parent(handles[3]));
+    expect_float_to_be(3.0f, transform_system_get_world(handles[3]).data[12]);
+
+    // The slot and handle come back.
+    u32 reused = transform_system_create((vec3){7, 0, 0}, quat_identity(), vec3_one());
+    expect_should_be(handles[1], reused);
+    transform_system_update();
+    expect_float_to_be(7.0f, transform_system_get_world(reused).data[12]);
+    expect_float_to_be(0.0f, transform_system_get_world(handles[0]).data[12]);
+    expect_float_to_be(2.0f, transform_system_get_world(handles[2]).data[12]);
+
+    stop_transform_system(&state);
+    return TRUE;
+}
+
+u8 transform_system_should_update_large_levels_across_jobs(){
+    const u32 root_count = 20000;
+    transform_test_state state;
+    start_transform_system(root_count * 2, TRUE, &state);
+
+    // Many roots, each with one child, so both levels are split across the job threads.
+    u32* roots = tallocate(sizeof(u32) * root_count, MEMORY_TAG_ARRAY);
+    u32* children = tallocate(sizeof(u32) * root_count, MEMORY_TAG_ARRAY);
+    for(u32 i = 0; i < root_count; ++i){
+        roots[i] = transform_system_create((vec3){(f32)i, 0, 0}, quat_identity(), vec3_one());
+    }
+    for(u32 i = 0; i < root_count; ++i){
+        children[i] = transform_system_create((vec3){0, 1, 0}, quat_identity(), vec3_one());
+        transform_system_set_parent(children[i], roots[i]);
+    }
+    transform_system_update();
+
+    for(u32 i = 0; i < root_count; ++i){
+        mat4 world = transform_system_get_world(children[i]);
+        expect_float_to_be((f32)i, world.data[12]);
+        expect_float_to_be(1.0f, world.data[13]);
+    }
+
+    transform_system_translate(roots[123], (vec3){0, 0, 5});
+    transform_system_update();
+    expect_float_to_be(5.0f, transform_system_get_world(children[123]).data[14]);
+    expect_float_to_be(0.0f, transform_system_get_world(children[124]).data[14]);
+
+    tfree(roots, sizeof(u32) * root_count, MEMORY_TAG_ARRAY);
+    tfree(children, sizeof(u32) * root_count, MEMORY_TAG_ARRAY);
+    stop_transform_system(&state);
+    return TRUE;
+}
+
+void transform_system_register_tests(){
+    test_manager_register_test(transform_system_should_match_transform_hierarchy, "Transform system should match the matrices of a transform hierarchy.");
+    test_manager_register_test(transform_system_should_update_only_after_update, "Transform system matrices should change only on update.");
+    test_manager_register_test(transform_system_should_order_parents_created_after_children, "Transform system should handle parents created after their children.");
+    test_manager_register_test(transform_system_should_destroy_and_reuse_handles, "Transform system should destroy transforms and reuse their handles.");
+    test_manager_register_test(transform_system_should_update_large_levels_across_jobs, "Transform system should update large levels across the job threads.");
+}